@@ -150,7 +150,17 @@ static void update_gptp(struct net_if *iface, struct net_pkt *pkt,
 	struct gptp_hdr *hdr;
 	int ret;
 
+#if defined(CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK_SOFT)
+	struct eth_context *ctx = net_if_get_device(iface)->driver_data;
+
+	if (!ctx->ptp_clock) {
+		return;
+	}
+
+	ret = ptp_clock_get(ctx->ptp_clock, &timestamp);
+#else
 	ret = eth_clock_gettime(&timestamp);
+#endif
 	if (ret < 0) {
 		return;
 	}
@@ -198,6 +208,24 @@ static int eth_send(struct device *dev, struct net_pkt *pkt)
 	return ret < 0 ? ret : 0;
 }
 
+#if NET_TX_BURST_SIZE > 1
+static int eth_send_burst(struct device *dev, struct net_pkt **pkts, int count)
+{
+	int i;
+
+	/* The TAP device takes one frame per write, but the frames are
+	 * written back to back.
+	 */
+	for (i = 0; i < count; i++) {
+		if (eth_send(dev, pkts[i]) < 0) {
+			break;
+		}
+	}
+
+	return i;
+}
+#endif /* NET_TX_BURST_SIZE > 1 */
+
 static int eth_init(struct device *dev)
 {
 	ARG_UNUSED(dev);
@@ -316,17 +344,17 @@ static struct net_pkt *prepare_non_vlan_pkt(struct eth_context *ctx,
 	return pkt;
 }
 
-static int read_data(struct eth_context *ctx, int fd)
+static struct net_pkt *read_pkt(struct eth_context *ctx, int fd,
+				struct net_if **iface)
 {
 	u16_t vlan_tag = NET_VLAN_TAG_UNSPEC;
-	struct net_if *iface;
 	struct net_pkt *pkt = NULL;
 	int status;
 	int count;
 
 	count = eth_read_data(fd, ctx->recv, sizeof(ctx->recv));
 	if (count <= 0) {
-		return 0;
+		return NULL;
 	}
 
 #if defined(CONFIG_NET_VLAN)
@@ -336,12 +364,12 @@ static int read_data(struct eth_context *ctx, int fd)
 		if (ntohs(hdr->type) == NET_ETH_PTYPE_VLAN) {
 			pkt = prepare_vlan_pkt(ctx, count, &vlan_tag, &status);
 			if (!pkt) {
-				return status;
+				return NULL;
 			}
 		} else {
 			pkt = prepare_non_vlan_pkt(ctx, count, &status);
 			if (!pkt) {
-				return status;
+				return NULL;
 			}
 
 			net_pkt_set_vlan_tci(pkt, 0);
@@ -351,20 +379,58 @@ static int read_data(struct eth_context *ctx, int fd)
 	{
 		pkt = prepare_non_vlan_pkt(ctx, count, &status);
 		if (!pkt) {
-			return status;
+			return NULL;
 		}
 	}
 #endif
 
-	iface = get_iface(ctx, vlan_tag);
+	*iface = get_iface(ctx, vlan_tag);
 
-	update_gptp(iface, pkt, false);
+	update_gptp(*iface, pkt, false);
 
-	if (net_recv_data(iface, pkt) < 0) {
-		net_pkt_unref(pkt);
+	return pkt;
+}
+
+static void recv_pkts(struct net_if *iface, struct net_pkt **pkts, int count)
+{
+	int i;
+
+	if (net_recv_data_burst(iface, pkts, count) < 0) {
+		for (i = 0; i < count; i++) {
+			net_pkt_unref(pkts[i]);
+		}
 	}
+}
 
-	return 0;
+/* Read the frames waiting in the host, up to NET_RX_BURST_SIZE of them,
+ * and hand them to the stack in bursts of frames of the same interface.
+ */
+static void read_data(struct eth_context *ctx, int fd)
+{
+	struct net_pkt *pkts[NET_RX_BURST_SIZE];
+	struct net_if *iface, *burst_iface = NULL;
+	struct net_pkt *pkt;
+	int count = 0;
+	int read = 0;
+
+	do {
+		pkt = read_pkt(ctx, fd, &iface);
+		if (!pkt) {
+			break;
+		}
+
+		if (count && iface != burst_iface) {
+			recv_pkts(burst_iface, pkts, count);
+			count = 0;
+		}
+
+		burst_iface = iface;
+		pkts[count++] = pkt;
+	} while (++read < NET_RX_BURST_SIZE && !eth_wait_data(fd));
+
+	if (count) {
+		recv_pkts(burst_iface, pkts, count);
+	}
 }
 
 static void eth_rx(struct eth_context *ctx)
@@ -383,7 +449,7 @@ static void eth_rx(struct eth_context *ctx)
 			}
 		}
 
-		k_sleep(K_MSEC(50));
+		k_sleep(K_MSEC(CONFIG_ETH_NATIVE_POSIX_RX_POLL_INTERVAL));
 	}
 }
 
@@ -441,6 +507,13 @@ static void eth_iface_init(struct net_if *iface)
 	net_if_set_link_addr(iface, ll_addr->addr, ll_addr->len,
 			     NET_LINK_ETHERNET);
 
+#if defined(CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK_SOFT)
+	ctx->ptp_clock = device_get_binding(CONFIG_PTP_CLOCK_SOFT_NAME);
+	if (!ctx->ptp_clock) {
+		LOG_ERR("Cannot find %s", CONFIG_PTP_CLOCK_SOFT_NAME);
+	}
+#endif
+
 	ctx->if_name = ETH_NATIVE_POSIX_DRV_NAME;
 
 	ctx->dev_fd = eth_iface_create(ctx->if_name, false);
@@ -571,6 +644,9 @@ static const struct ethernet_api eth_if_api = {
 	.start = eth_start_device,
 	.stop = eth_stop_device,
 	.send = eth_send,
+#if NET_TX_BURST_SIZE > 1
+	.send_burst = eth_send_burst,
+#endif
 
 #if defined(CONFIG_NET_VLAN)
 	.vlan_setup = vlan_setup,
@@ -588,7 +664,8 @@ ETH_NET_DEVICE_INIT(eth_native_posix, ETH_NATIVE_POSIX_DRV_NAME,
 		    CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &eth_if_api,
 		    NET_ETH_MTU);
 
-#if defined(CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK)
+#if defined(CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK) && \
+	!defined(CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK_SOFT)
 struct ptp_context {
 	struct eth_context *eth_context;
 };
@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * IEEE 802.15.4 radio simulator for native posix board. Several Zephyr
+ * processes running on the same host share a simulated 2.4 GHz medium:
+ * a frame is received by the nodes listening on its channel once it has
+ * been on air for its whole duration, unless another frame was sent on
+ * the same channel meanwhile, in which case both are lost.
+ */
+
+#define LOG_MODULE_NAME ieee802154_native_posix
+#define LOG_LEVEL CONFIG_IEEE802154_DRIVER_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#include <errno.h>
+#include <sys/types.h>
+
+#include <kernel.h>
+#include <device.h>
+#include <init.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+
+#include <misc/byteorder.h>
+#include <net/ieee802154_radio.h>
+
+#include "cmdline.h"
+#include "soc.h"
+#include "native_rtc.h"
+
+#include "ieee802154_native_posix_priv.h"
+
+#define MAX_FRAME_LEN		125 /* Without FCS */
+
+/* Frames on air, or received but not handed to the stack yet */
+#define AIR_SIZE		8
+
+/* O-QPSK at 250 kbit/s: 32 us per byte, with a 6 bytes PHY header and
+ * a 2 bytes FCS.
+ */
+#define BYTE_DURATION_US	32
+#define PHY_OVERHEAD		(6 + 2)
+
+#define FCF_DST_ADDR_MODE(_fcf)	(((_fcf) >> 10) & 0x3)
+#define ADDR_MODE_NONE		0x0
+#define ADDR_MODE_SHORT		0x2
+#define ADDR_MODE_EXTENDED	0x3
+
+#define PAN_ID_OFFSET		3
+#define DEST_ADDR_OFFSET	5
+
+#define PAN_ID_SIZE		2
+#define SHORT_ADDRESS_SIZE	2
+#define EXTENDED_ADDRESS_SIZE	8
+
+static const u8_t broadcast_addr[SHORT_ADDRESS_SIZE] = { 0xff, 0xff };
+
+struct sim_frame {
+	struct sim_medium_hdr hdr;
+	u8_t psdu[MAX_FRAME_LEN];
+	bool used;
+	bool collided;
+};
+
+struct sim_context {
+	struct net_if *iface;
+	u8_t mac_addr[EXTENDED_ADDRESS_SIZE];
+
+	u8_t pan_id[PAN_ID_SIZE];
+	u8_t short_addr[SHORT_ADDRESS_SIZE];
+	u8_t ext_addr[EXTENDED_ADDRESS_SIZE];
+	u16_t channel;
+
+	int fd;
+	bool started;
+
+	/* Our own last transmission, during which nothing is received */
+	u64_t tx_start;
+	u64_t tx_end;
+
+	struct k_mutex air_lock;
+	struct sim_frame air[AIR_SIZE];
+
+	u8_t buf[sizeof(struct sim_medium_hdr) + MAX_FRAME_LEN];
+};
+
+static u32_t node_id;
+
+static struct sim_context sim_context_data = {
+	.fd = -1,
+};
+
+NET_STACK_DEFINE(RX_ZSIM, sim_rx_stack,
+		 CONFIG_ARCH_POSIX_RECOMMENDED_STACK_SIZE,
+		 CONFIG_ARCH_POSIX_RECOMMENDED_STACK_SIZE);
+static struct k_thread rx_thread_data;
+
+static inline u64_t medium_time(void)
+{
+	return native_rtc_gettime_us(RTC_CLOCK_PSEUDOHOSTREALTIME);
+}
+
+static inline u64_t frame_end(struct sim_medium_hdr *hdr)
+{
+	return hdr->start + (PHY_OVERHEAD + hdr->len) * BYTE_DURATION_US;
+}
+
+static inline bool frames_overlap(struct sim_medium_hdr *hdr,
+				  u64_t start, u64_t end)
+{
+	return hdr->start < end && start < frame_end(hdr);
+}
+
+static bool frame_is_for_me(struct sim_context *ctx, u8_t *psdu, u16_t len)
+{
+	u8_t *dst = psdu + DEST_ADDR_OFFSET;
+
+	if (len < PAN_ID_OFFSET) {
+		return false;
+	}
+
+	switch (FCF_DST_ADDR_MODE(sys_get_le16(psdu))) {
+	case ADDR_MODE_NONE:
+		/* ACK and beacon frames */
+		return true;
+	case ADDR_MODE_SHORT:
+		if (len < DEST_ADDR_OFFSET + SHORT_ADDRESS_SIZE ||
+		    (memcmp(dst, broadcast_addr, SHORT_ADDRESS_SIZE) &&
+		     memcmp(dst, ctx->short_addr, SHORT_ADDRESS_SIZE))) {
+			return false;
+		}
+		break;
+	case ADDR_MODE_EXTENDED:
+		if (len < DEST_ADDR_OFFSET + EXTENDED_ADDRESS_SIZE ||
+		    memcmp(dst, ctx->ext_addr, EXTENDED_ADDRESS_SIZE)) {
+			return false;
+		}
+		break;
+	default:
+		return false;
+	}
+
+	return !memcmp(psdu + PAN_ID_OFFSET, ctx->pan_id, PAN_ID_SIZE) ||
+		!memcmp(psdu + PAN_ID_OFFSET, broadcast_addr, PAN_ID_SIZE);
+}
+
+/* Read the frames sent on the medium since the last call, and mark the
+ * ones overlapping another frame on the same channel as collided.
+ */
+static void medium_listen(struct sim_context *ctx)
+{
+	struct sim_medium_hdr *hdr = (struct sim_medium_hdr *)ctx->buf;
+	struct sim_frame *frame;
+	bool collided;
+	ssize_t len;
+	int i;
+
+	k_mutex_lock(&ctx->air_lock, K_FOREVER);
+
+	while (!sim_medium_wait_data(ctx->fd)) {
+		len = sim_medium_read(ctx->fd, ctx->buf, sizeof(ctx->buf));
+		if (len < (ssize_t)sizeof(*hdr) ||
+		    len != sizeof(*hdr) + hdr->len) {
+			continue;
+		}
+
+		/* Not listening on that channel, or sending meanwhile */
+		if (!ctx->started || hdr->channel != ctx->channel ||
+		    frames_overlap(hdr, ctx->tx_start, ctx->tx_end)) {
+			continue;
+		}
+
+		frame = NULL;
+		collided = false;
+
+		for (i = 0; i < AIR_SIZE; i++) {
+			if (!ctx->air[i].used) {
+				if (!frame) {
+					frame = &ctx->air[i];
+				}
+
+				continue;
+			}
+
+			if (ctx->air[i].hdr.channel == hdr->channel &&
+			    frames_overlap(&ctx->air[i].hdr, hdr->start,
+					   frame_end(hdr))) {
+				ctx->air[i].collided = true;
+				collided = true;
+			}
+		}
+
+		if (!frame) {
+			LOG_DBG("Too many frames on air, dropping one");
+			continue;
+		}
+
+		frame->hdr = *hdr;
+		frame->collided = collided;
+		memcpy(frame->psdu, hdr + 1, hdr->len);
+		frame->used = true;
+	}
+
+	k_mutex_unlock(&ctx->air_lock);
+}
+
+/* Hand the frames which are not on air anymore to the stack */
+static void medium_deliver(struct sim_context *ctx)
+{
+	struct net_pkt *pkts[AIR_SIZE];
+	u64_t now = medium_time();
+	struct sim_frame *frame;
+	struct net_pkt *pkt;
+	int count = 0;
+	int i;
+
+	k_mutex_lock(&ctx->air_lock, K_FOREVER);
+
+	for (i = 0; i < AIR_SIZE; i++) {
+		frame = &ctx->air[i];
+
+		if (!frame->used || frame_end(&frame->hdr) > now) {
+			continue;
+		}
+
+		frame->used = false;
+
+		if (frame->collided) {
+			LOG_DBG("Frame from node %u collided", frame->hdr.node);
+			continue;
+		}
+
+		if (!frame_is_for_me(ctx, frame->psdu, frame->hdr.len)) {
+			continue;
+		}
+
+		pkt = net_pkt_rx_alloc_with_buffer(ctx->iface, frame->hdr.len,
+						   AF_UNSPEC, 0, K_NO_WAIT);
+		if (!pkt) {
+			LOG_DBG("No pkt available");
+			continue;
+		}
+
+		if (net_pkt_write(pkt, frame->psdu, frame->hdr.len)) {
+			net_pkt_unref(pkt);
+			continue;
+		}
+
+		net_pkt_cursor_init(pkt);
+		net_pkt_set_ieee802154_lqi(pkt, 0xff);
+
+		pkts[count++] = pkt;
+	}
+
+	k_mutex_unlock(&ctx->air_lock);
+
+	for (i = 0; i < count; i++) {
+		if (ieee802154_radio_handle_ack(ctx->iface, pkts[i]) ==
+		    NET_OK) {
+			LOG_DBG("ACK packet handled");
+			net_pkt_unref(pkts[i]);
+			continue;
+		}
+
+		if (net_recv_data(ctx->iface, pkts[i]) < 0) {
+			LOG_DBG("Packet dropped by NET stack");
+			net_pkt_unref(pkts[i]);
+		}
+	}
+}
+
+static void sim_rx(struct sim_context *ctx)
+{
+	LOG_DBG("Starting IEEE 802.15.4 simulator RX thread");
+
+	while (1) {
+		if (ctx->started) {
+			medium_listen(ctx);
+			medium_deliver(ctx);
+		}
+
+		k_sleep(K_MSEC(1));
+	}
+}
+
+static enum ieee802154_hw_caps sim_get_capabilities(struct device *dev)
+{
+	return IEEE802154_HW_FCS |
+		IEEE802154_HW_2_4_GHZ |
+		IEEE802154_HW_FILTER;
+}
+
+static int sim_cca(struct device *dev)
+{
+	struct sim_context *ctx = dev->driver_data;
+	u64_t now = medium_time();
+	int ret = 0;
+	int i;
+
+	if (!ctx->started) {
+		return -EIO;
+	}
+
+	medium_listen(ctx);
+
+	k_mutex_lock(&ctx->air_lock, K_FOREVER);
+
+	for (i = 0; i < AIR_SIZE; i++) {
+		if (ctx->air[i].used && frame_end(&ctx->air[i].hdr) > now) {
+			ret = -EBUSY;
+			break;
+		}
+	}
+
+	k_mutex_unlock(&ctx->air_lock);
+
+	return ret;
+}
+
+static int sim_set_channel(struct device *dev, u16_t channel)
+{
+	struct sim_context *ctx = dev->driver_data;
+
+	if (channel < 11 || channel > 26) {
+		return -EINVAL;
+	}
+
+	ctx->channel = channel;
+
+	return 0;
+}
+
+static int sim_filter(struct device *dev,
+		      bool set,
+		      enum ieee802154_filter_type type,
+		      const struct ieee802154_filter *filter)
+{
+	struct sim_context *ctx = dev->driver_data;
+
+	LOG_DBG("Applying filter %u", type);
+
+	if (!set) {
+		return -ENOTSUP;
+	}
+
+	if (type == IEEE802154_FILTER_TYPE_IEEE_ADDR) {
+		memcpy(ctx->ext_addr, filter->ieee_addr, EXTENDED_ADDRESS_SIZE);
+	} else if (type == IEEE802154_FILTER_TYPE_SHORT_ADDR) {
+		sys_put_le16(filter->short_addr, ctx->short_addr);
+	} else if (type == IEEE802154_FILTER_TYPE_PAN_ID) {
+		sys_put_le16(filter->pan_id, ctx->pan_id);
+	} else {
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+static int sim_set_txpower(struct device *dev, s16_t dbm)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(dbm);
+
+	return 0;
+}
+
+static int sim_tx(struct device *dev,
+		  struct net_pkt *pkt,
+		  struct net_buf *frag)
+{
+	struct sim_context *ctx = dev->driver_data;
+	struct sim_medium_hdr hdr;
+	u8_t buf[sizeof(hdr) + MAX_FRAME_LEN];
+
+	LOG_DBG("%p (%u)", frag, frag->len);
+
+	if (!ctx->started) {
+		return -EIO;
+	}
+
+	if (frag->len > MAX_FRAME_LEN) {
+		return -EMSGSIZE;
+	}
+
+	hdr.start = medium_time();
+	hdr.node = node_id;
+	hdr.channel = ctx->channel;
+	hdr.len = frag->len;
+
+	memcpy(buf, &hdr, sizeof(hdr));
+	memcpy(buf + sizeof(hdr), frag->data, frag->len);
+
+	if (sim_medium_send(ctx->fd, IEEE802154_NATIVE_POSIX_MEDIUM, node_id,
+			    buf, sizeof(hdr) + frag->len) < 0) {
+		return -EIO;
+	}
+
+	ctx->tx_start = hdr.start;
+	ctx->tx_end = frame_end(&hdr);
+
+	/* The radio is busy until the frame is fully sent */
+	k_busy_wait((u32_t)(ctx->tx_end - ctx->tx_start));
+
+	return 0;
+}
+
+static int sim_start(struct device *dev)
+{
+	struct sim_context *ctx = dev->driver_data;
+
+	if (ctx->started) {
+		return -EALREADY;
+	}
+
+	ctx->started = true;
+
+	return 0;
+}
+
+static int sim_stop(struct device *dev)
+{
+	struct sim_context *ctx = dev->driver_data;
+
+	if (!ctx->started) {
+		return -EALREADY;
+	}
+
+	ctx->started = false;
+
+	return 0;
+}
+
+static int sim_init(struct device *dev)
+{
+	struct sim_context *ctx = dev->driver_data;
+
+	k_mutex_init(&ctx->air_lock);
+
+	if (!node_id) {
+		node_id = sim_medium_default_node();
+	}
+
+	ctx->fd = sim_medium_open(IEEE802154_NATIVE_POSIX_MEDIUM, node_id);
+	if (ctx->fd < 0) {
+		LOG_ERR("Cannot join medium %s (%d)",
+			IEEE802154_NATIVE_POSIX_MEDIUM, ctx->fd);
+		return ctx->fd;
+	}
+
+	k_thread_create(&rx_thread_data, sim_rx_stack,
+			K_THREAD_STACK_SIZEOF(sim_rx_stack),
+			(k_thread_entry_t)sim_rx,
+			ctx, NULL, NULL, K_PRIO_COOP(14),
+			0, K_NO_WAIT);
+
+	return 0;
+}
+
+static void sim_iface_init(struct net_if *iface)
+{
+	struct device *dev = net_if_get_device(iface);
+	struct sim_context *ctx = dev->driver_data;
+
+	/* 00-00-5E-EF-10-xx-xx-xx Documentation RFC 7042, the last bytes
+	 * being the node id.
+	 */
+	ctx->mac_addr[0] = 0x00;
+	ctx->mac_addr[1] = 0x00;
+	ctx->mac_addr[2] = 0x5E;
+	ctx->mac_addr[3] = 0xEF;
+	ctx->mac_addr[4] = 0x10;
+	ctx->mac_addr[5] = (u8_t)(node_id >> 16);
+	ctx->mac_addr[6] = (u8_t)(node_id >> 8);
+	ctx->mac_addr[7] = (u8_t)node_id;
+
+	net_if_set_link_addr(iface, ctx->mac_addr, sizeof(ctx->mac_addr),
+			     NET_LINK_IEEE802154);
+
+	ctx->iface = iface;
+
+	ieee802154_init(iface);
+
+	LOG_INF("Node %u on medium %s", node_id,
+		IEEE802154_NATIVE_POSIX_MEDIUM);
+}
+
+static struct ieee802154_radio_api sim_radio_api = {
+	.iface_api.init		= sim_iface_init,
+
+	.get_capabilities	= sim_get_capabilities,
+	.cca			= sim_cca,
+	.set_channel		= sim_set_channel,
+	.filter			= sim_filter,
+	.set_txpower		= sim_set_txpower,
+	.tx			= sim_tx,
+	.start			= sim_start,
+	.stop			= sim_stop,
+};
+
+NET_DEVICE_INIT(ieee802154_native_posix, IEEE802154_NATIVE_POSIX_DRV_NAME,
+		sim_init, &sim_context_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&sim_radio_api, IEEE802154_L2,
+		NET_L2_GET_CTX_TYPE(IEEE802154_L2), MAX_FRAME_LEN);
+
+static void sim_options(void)
+{
+	static struct args_struct_t sim_options[] = {
+		{ .manual = false,
+		  .is_mandatory = false,
+		  .is_switch = false,
+		  .option = "ieee802154_node",
+		  .name = "id",
+		  .type = 'u',
+		  .dest = (void *)&node_id,
+		  .call_when_found = NULL,
+		  .descript = "Node id on the simulated IEEE 802.15.4 medium, "
+			      "also the last bytes of its MAC address "
+			      "(default: process id)" },
+		ARG_TABLE_ENDMARKER
+	};
+
+	native_add_command_line_opts(sim_options);
+}
+
+static void sim_cleanup(void)
+{
+	if (sim_context_data.fd >= 0) {
+		sim_medium_close(sim_context_data.fd,
+				 IEEE802154_NATIVE_POSIX_MEDIUM, node_id);
+	}
+}
+
+NATIVE_TASK(sim_options, PRE_BOOT_1, 10);
+NATIVE_TASK(sim_cleanup, ON_EXIT, 10);
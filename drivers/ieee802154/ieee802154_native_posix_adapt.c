@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * Routines accessing the simulated medium on the host. Those are placed in
+ * separate file because there is naming conflicts between host and zephyr
+ * network stacks.
+ *
+ * The medium is a directory holding one Unix datagram socket per node,
+ * named after the node id. A frame is sent to every socket but the one of
+ * the sender.
+ */
+
+/* Host include files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/un.h>
+
+/* Zephyr include files. Be very careful here and only include minimum
+ * things needed.
+ */
+#define LOG_MODULE_NAME ieee802154_native_posix_adapt
+#define LOG_LEVEL CONFIG_IEEE802154_DRIVER_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#include <zephyr/types.h>
+
+#include "ieee802154_native_posix_priv.h"
+
+static int node_addr(struct sockaddr_un *addr, const char *dir,
+		     const char *name)
+{
+	int len;
+
+	(void)memset(addr, 0, sizeof(*addr));
+	addr->sun_family = AF_UNIX;
+
+	len = snprintf(addr->sun_path, sizeof(addr->sun_path), "%s/%s",
+		       dir, name);
+	if (len < 0 || len >= sizeof(addr->sun_path)) {
+		return -ENAMETOOLONG;
+	}
+
+	return 0;
+}
+
+int sim_medium_open(const char *dir, u32_t node)
+{
+	struct sockaddr_un addr;
+	char name[11];
+	int fd, ret;
+
+	if (mkdir(dir, 0777) < 0 && errno != EEXIST) {
+		return -errno;
+	}
+
+	snprintf(name, sizeof(name), "%u", node);
+
+	ret = node_addr(&addr, dir, name);
+	if (ret < 0) {
+		return ret;
+	}
+
+	fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		return -errno;
+	}
+
+	/* Left over by a previous run of the same node */
+	unlink(addr.sun_path);
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    fcntl(fd, F_SETFL, O_NONBLOCK) < 0) {
+		ret = -errno;
+		close(fd);
+		return ret;
+	}
+
+	return fd;
+}
+
+void sim_medium_close(int fd, const char *dir, u32_t node)
+{
+	struct sockaddr_un addr;
+	char name[11];
+
+	close(fd);
+
+	snprintf(name, sizeof(name), "%u", node);
+
+	if (!node_addr(&addr, dir, name)) {
+		unlink(addr.sun_path);
+	}
+}
+
+int sim_medium_wait_data(int fd)
+{
+	struct timeval timeout;
+	fd_set rset;
+	int ret;
+
+	FD_ZERO(&rset);
+
+	FD_SET(fd, &rset);
+
+	timeout.tv_sec = 0;
+	timeout.tv_usec = 0;
+
+	ret = select(fd + 1, &rset, NULL, NULL, &timeout);
+	if (ret < 0 && errno != EINTR) {
+		return -errno;
+	} else if (ret > 0) {
+		if (FD_ISSET(fd, &rset)) {
+			return 0;
+		}
+	}
+
+	return -EAGAIN;
+}
+
+ssize_t sim_medium_read(int fd, void *buf, size_t buf_len)
+{
+	return recv(fd, buf, buf_len, 0);
+}
+
+int sim_medium_send(int fd, const char *dir, u32_t node,
+		    const void *buf, size_t buf_len)
+{
+	struct sockaddr_un addr;
+	struct dirent *entry;
+	char name[11];
+	DIR *medium;
+
+	medium = opendir(dir);
+	if (!medium) {
+		return -errno;
+	}
+
+	snprintf(name, sizeof(name), "%u", node);
+
+	while ((entry = readdir(medium)) != NULL) {
+		if (entry->d_name[0] == '.' || !strcmp(entry->d_name, name) ||
+		    node_addr(&addr, dir, entry->d_name)) {
+			continue;
+		}
+
+		if (sendto(fd, buf, buf_len, 0, (struct sockaddr *)&addr,
+			   sizeof(addr)) < 0 && errno == ECONNREFUSED) {
+			/* Nobody is listening anymore, the node is gone */
+			unlink(addr.sun_path);
+		}
+	}
+
+	closedir(medium);
+
+	return 0;
+}
+
+u32_t sim_medium_default_node(void)
+{
+	return getpid() & 0xffffff;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Private functions for native posix IEEE 802.15.4 radio simulator.
+ */
+
+#ifndef ZEPHYR_DRIVERS_IEEE802154_IEEE802154_NATIVE_POSIX_PRIV_H_
+#define ZEPHYR_DRIVERS_IEEE802154_IEEE802154_NATIVE_POSIX_PRIV_H_
+
+#define IEEE802154_NATIVE_POSIX_DRV_NAME CONFIG_IEEE802154_NATIVE_POSIX_DRV_NAME
+#define IEEE802154_NATIVE_POSIX_MEDIUM CONFIG_IEEE802154_NATIVE_POSIX_MEDIUM
+
+/* Header of the datagrams exchanged on the simulated medium, followed by
+ * the frame itself.
+ */
+struct sim_medium_hdr {
+	/* Host time the frame starts being sent, in microseconds */
+	u64_t start;
+	/* Node sending the frame */
+	u32_t node;
+	u16_t channel;
+	/* Length of the frame, without FCS */
+	u16_t len;
+};
+
+int sim_medium_open(const char *dir, u32_t node);
+void sim_medium_close(int fd, const char *dir, u32_t node);
+int sim_medium_wait_data(int fd);
+ssize_t sim_medium_read(int fd, void *buf, size_t buf_len);
+int sim_medium_send(int fd, const char *dir, u32_t node,
+		    const void *buf, size_t buf_len);
+u32_t sim_medium_default_node(void);
+
+#endif /* ZEPHYR_DRIVERS_IEEE802154_IEEE802154_NATIVE_POSIX_PRIV_H_ */
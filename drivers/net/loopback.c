@@ -38,46 +38,61 @@ static void loopback_init(struct net_if *iface)
 			     NET_LINK_DUMMY);
 }
 
-static int loopback_send(struct device *dev, struct net_pkt *pkt)
+static struct net_pkt *loopback_clone(struct net_pkt *pkt, int *res)
 {
 	struct net_pkt *cloned;
-	int res;
-
-	ARG_UNUSED(dev);
 
 	if (!pkt->frags) {
 		LOG_ERR("No data to send");
-		return -ENODATA;
+		*res = -ENODATA;
+		return NULL;
+	}
+
+	/* We should simulate normal driver meaning that if the packet is
+	 * properly sent (which is always in this driver), then the packet
+	 * must be dropped. This is very much needed for TCP packets where
+	 * the packet is reference counted in various stages of sending.
+	 */
+	cloned = net_pkt_clone(pkt, K_MSEC(100));
+	if (!cloned) {
+		*res = -ENOMEM;
+		return NULL;
 	}
 
 	/* We need to swap the IP addresses because otherwise
-	 * the packet will be dropped.
+	 * the packet will be dropped. This is done on the clone, so
+	 * that the packet is left untouched if it has to be sent
+	 * again, e.g. after a failed burst.
 	 */
 
-	if (net_pkt_family(pkt) == AF_INET6) {
+	if (net_pkt_family(cloned) == AF_INET6) {
 		struct in6_addr addr;
 
-		net_ipaddr_copy(&addr, &NET_IPV6_HDR(pkt)->src);
-		net_ipaddr_copy(&NET_IPV6_HDR(pkt)->src,
-				&NET_IPV6_HDR(pkt)->dst);
-		net_ipaddr_copy(&NET_IPV6_HDR(pkt)->dst, &addr);
+		net_ipaddr_copy(&addr, &NET_IPV6_HDR(cloned)->src);
+		net_ipaddr_copy(&NET_IPV6_HDR(cloned)->src,
+				&NET_IPV6_HDR(cloned)->dst);
+		net_ipaddr_copy(&NET_IPV6_HDR(cloned)->dst, &addr);
 	} else {
 		struct in_addr addr;
 
-		net_ipaddr_copy(&addr, &NET_IPV4_HDR(pkt)->src);
-		net_ipaddr_copy(&NET_IPV4_HDR(pkt)->src,
-				&NET_IPV4_HDR(pkt)->dst);
-		net_ipaddr_copy(&NET_IPV4_HDR(pkt)->dst, &addr);
+		net_ipaddr_copy(&addr, &NET_IPV4_HDR(cloned)->src);
+		net_ipaddr_copy(&NET_IPV4_HDR(cloned)->src,
+				&NET_IPV4_HDR(cloned)->dst);
+		net_ipaddr_copy(&NET_IPV4_HDR(cloned)->dst, &addr);
 	}
 
-	/* We should simulate normal driver meaning that if the packet is
-	 * properly sent (which is always in this driver), then the packet
-	 * must be dropped. This is very much needed for TCP packets where
-	 * the packet is reference counted in various stages of sending.
-	 */
-	cloned = net_pkt_clone(pkt, K_MSEC(100));
+	return cloned;
+}
+
+static int loopback_send(struct device *dev, struct net_pkt *pkt)
+{
+	struct net_pkt *cloned;
+	int res;
+
+	ARG_UNUSED(dev);
+
+	cloned = loopback_clone(pkt, &res);
 	if (!cloned) {
-		res = -ENOMEM;
 		goto out;
 	}
 
@@ -93,10 +108,50 @@ out:
 	return res;
 }
 
+#if NET_TX_BURST_SIZE > 1
+static int loopback_send_burst(struct device *dev, struct net_pkt **pkts,
+			       int count)
+{
+	struct net_pkt *cloned[NET_TX_BURST_SIZE];
+	int i, res;
+
+	ARG_UNUSED(dev);
+
+	for (i = 0; i < count; i++) {
+		cloned[i] = loopback_clone(pkts[i], &res);
+		if (!cloned[i]) {
+			break;
+		}
+	}
+
+	count = i;
+
+	/* The whole burst is queued at once to the receiving threads */
+	if (count && net_recv_data_burst(net_pkt_iface(cloned[0]), cloned,
+					 count) < 0) {
+		LOG_ERR("Data receive failed.");
+
+		for (i = 0; i < count; i++) {
+			net_pkt_unref(cloned[i]);
+		}
+
+		count = 0;
+	}
+
+	/* Let the receiving thread run now */
+	k_yield();
+
+	return count;
+}
+#endif /* NET_TX_BURST_SIZE > 1 */
+
 static struct dummy_api loopback_api = {
 	.iface_api.init = loopback_init,
 
 	.send = loopback_send,
+#if NET_TX_BURST_SIZE > 1
+	.send_burst = loopback_send_burst,
+#endif
 };
 
 NET_DEVICE_INIT(loopback, "lo",
@@ -0,0 +1,961 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * Socket offloading to the host on native_posix. The socket calls are
+ * mapped to non-blocking sockets of the host, so that the application uses
+ * the network stack of the host instead of the Zephyr one.
+ *
+ * Blocking host calls would stop the whole simulation, so a thread polls
+ * the epoll instance watching all the host sockets and wakes up the threads
+ * waiting for an event on one of them.
+ */
+
+#define LOG_MODULE_NAME net_sock_native_posix
+#define LOG_LEVEL CONFIG_NET_NATIVE_POSIX_SOCKETS_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#include <kernel.h>
+#include <init.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <spinlock.h>
+#include <misc/slist.h>
+#include <net/socket_offload.h>
+
+#include "sockets_native_posix_priv.h"
+
+#define MAX_SOCKETS CONFIG_NET_NATIVE_POSIX_SOCKETS_MAX
+#define MAX_EVENTS 16
+#define MAX_ADDRINFO 4
+
+struct host_socket {
+	/* Host file descriptor, -1 when the socket is closed. The entry is
+	 * free once there are no more waiters either.
+	 */
+	int fd;
+
+	/* Set with fcntl(), the host socket is always non-blocking */
+	bool nonblock;
+
+	/* Threads waiting for an event on the socket */
+	sys_slist_t waiters;
+};
+
+struct waiter {
+	sys_snode_t node;
+	struct k_sem *sem;
+};
+
+/* An addrinfo result allocated together with its address */
+struct addrinfo_entry {
+	struct addrinfo ai;
+	struct sockaddr addr;
+};
+
+/* A thread waiting for a single socket */
+struct wait {
+	struct waiter waiter;
+	struct k_sem sem;
+};
+
+static struct host_socket sockets[MAX_SOCKETS];
+
+/* Protects the socket table and the lists of waiters */
+static struct k_spinlock lock;
+
+static K_THREAD_STACK_DEFINE(poll_stack,
+			     CONFIG_ARCH_POSIX_RECOMMENDED_STACK_SIZE);
+static struct k_thread poll_thread_data;
+
+static const int errnos[HOST_ERRNO_COUNT] = {
+	[HOST_EIO] = EIO,
+	[HOST_EAGAIN] = EAGAIN,
+	[HOST_EINTR] = EINTR,
+	[HOST_EBADF] = EBADF,
+	[HOST_EINVAL] = EINVAL,
+	[HOST_ENOMEM] = ENOMEM,
+	[HOST_EMFILE] = EMFILE,
+	[HOST_EACCES] = EACCES,
+	[HOST_EPIPE] = EPIPE,
+	[HOST_EMSGSIZE] = EMSGSIZE,
+	[HOST_EOPNOTSUPP] = EOPNOTSUPP,
+	[HOST_EPROTONOSUPPORT] = EPROTONOSUPPORT,
+	[HOST_EAFNOSUPPORT] = EAFNOSUPPORT,
+	[HOST_EADDRINUSE] = EADDRINUSE,
+	[HOST_EADDRNOTAVAIL] = EADDRNOTAVAIL,
+	[HOST_ENETUNREACH] = ENETUNREACH,
+	[HOST_EHOSTUNREACH] = EHOSTUNREACH,
+	[HOST_ECONNABORTED] = ECONNABORTED,
+	[HOST_ECONNRESET] = ECONNRESET,
+	[HOST_ECONNREFUSED] = ECONNREFUSED,
+	[HOST_ENOBUFS] = ENOBUFS,
+	[HOST_EISCONN] = EISCONN,
+	[HOST_ENOTCONN] = ENOTCONN,
+	[HOST_ETIMEDOUT] = ETIMEDOUT,
+	[HOST_EINPROGRESS] = EINPROGRESS,
+	[HOST_EALREADY] = EALREADY,
+	[HOST_EDESTADDRREQ] = EDESTADDRREQ,
+	[HOST_ENOPROTOOPT] = ENOPROTOOPT,
+};
+
+static int set_errno(int err)
+{
+	errno = err;
+
+	return -1;
+}
+
+/* Result of a failed host call */
+static int host_error(int ret)
+{
+	if (-ret <= 0 || -ret >= HOST_ERRNO_COUNT) {
+		return set_errno(EIO);
+	}
+
+	return set_errno(errnos[-ret]);
+}
+
+static struct host_socket *get_socket(int sd)
+{
+	if (sd < 0 || sd >= MAX_SOCKETS || sockets[sd].fd < 0) {
+		return NULL;
+	}
+
+	return &sockets[sd];
+}
+
+/* Take ownership of the host socket, closing it on failure.
+ *
+ * The entry of a closed socket is not reused while threads blocked on it
+ * have not noticed the close yet, as they would otherwise go on with the
+ * host socket of the new entry.
+ */
+static int socket_alloc(int fd)
+{
+	k_spinlock_key_t key;
+	int sd, ret;
+
+	key = k_spin_lock(&lock);
+
+	for (sd = 0; sd < MAX_SOCKETS; sd++) {
+		if (sockets[sd].fd < 0 &&
+		    sys_slist_is_empty(&sockets[sd].waiters)) {
+			sockets[sd].fd = fd;
+			sockets[sd].nonblock = false;
+			break;
+		}
+	}
+
+	k_spin_unlock(&lock, key);
+
+	if (sd == MAX_SOCKETS) {
+		host_sock_close(fd);
+		return set_errno(ENFILE);
+	}
+
+	ret = host_sock_watch(fd, sd);
+	if (ret < 0) {
+		sockets[sd].fd = -1;
+		host_sock_close(fd);
+		return host_error(ret);
+	}
+
+	return sd;
+}
+
+static void waiter_add(struct host_socket *sock, struct waiter *waiter,
+		       struct k_sem *sem)
+{
+	k_spinlock_key_t key;
+
+	waiter->sem = sem;
+
+	key = k_spin_lock(&lock);
+	sys_slist_append(&sock->waiters, &waiter->node);
+	k_spin_unlock(&lock, key);
+}
+
+static void waiter_remove(struct host_socket *sock, struct waiter *waiter)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+	sys_slist_find_and_remove(&sock->waiters, &waiter->node);
+	k_spin_unlock(&lock, key);
+}
+
+/* Called with the lock held */
+static void wake_waiters(struct host_socket *sock)
+{
+	struct waiter *waiter;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&sock->waiters, waiter, node) {
+		k_sem_give(waiter->sem);
+	}
+}
+
+/* The waiter is registered before trying the operation, so that an event
+ * happening in between is not missed.
+ */
+static void wait_start(struct wait *wait, struct host_socket *sock)
+{
+	k_sem_init(&wait->sem, 0, 1);
+	waiter_add(sock, &wait->waiter, &wait->sem);
+}
+
+static void wait_end(struct wait *wait, struct host_socket *sock)
+{
+	waiter_remove(sock, &wait->waiter);
+}
+
+static int to_host_addr(const struct sockaddr *addr, socklen_t addrlen,
+			struct host_sockaddr *host)
+{
+	(void)memset(host, 0, sizeof(*host));
+
+	switch (addr->sa_family) {
+	case AF_INET:
+		if (addrlen < sizeof(struct sockaddr_in)) {
+			return -EINVAL;
+		}
+
+		host->family = HOST_AF_INET;
+		host->port = net_sin(addr)->sin_port;
+		memcpy(host->addr, &net_sin(addr)->sin_addr,
+		       sizeof(struct in_addr));
+		break;
+	case AF_INET6:
+		if (addrlen < sizeof(struct sockaddr_in6)) {
+			return -EINVAL;
+		}
+
+		host->family = HOST_AF_INET6;
+		host->port = net_sin6(addr)->sin6_port;
+		host->scope_id = net_sin6(addr)->sin6_scope_id;
+		memcpy(host->addr, &net_sin6(addr)->sin6_addr,
+		       sizeof(struct in6_addr));
+		break;
+	default:
+		return -EAFNOSUPPORT;
+	}
+
+	return 0;
+}
+
+/* The address is truncated to the given length, which is then set to the
+ * actual length of the address.
+ */
+static void from_host_addr(const struct host_sockaddr *host,
+			   struct sockaddr *addr, socklen_t *addrlen)
+{
+	struct sockaddr sa;
+	socklen_t len;
+
+	(void)memset(&sa, 0, sizeof(sa));
+
+	if (host->family == HOST_AF_INET) {
+		net_sin(&sa)->sin_family = AF_INET;
+		net_sin(&sa)->sin_port = host->port;
+		memcpy(&net_sin(&sa)->sin_addr, host->addr,
+		       sizeof(struct in_addr));
+		len = sizeof(struct sockaddr_in);
+	} else {
+		net_sin6(&sa)->sin6_family = AF_INET6;
+		net_sin6(&sa)->sin6_port = host->port;
+		net_sin6(&sa)->sin6_scope_id = host->scope_id;
+		memcpy(&net_sin6(&sa)->sin6_addr, host->addr,
+		       sizeof(struct in6_addr));
+		len = sizeof(struct sockaddr_in6);
+	}
+
+	memcpy(addr, &sa, MIN(*addrlen, len));
+	*addrlen = len;
+}
+
+static int offload_socket(int family, int type, int proto)
+{
+	int ret;
+
+	switch (family) {
+	case AF_INET:
+		family = HOST_AF_INET;
+		break;
+	case AF_INET6:
+		family = HOST_AF_INET6;
+		break;
+	default:
+		return set_errno(EAFNOSUPPORT);
+	}
+
+	switch (type) {
+	case SOCK_STREAM:
+		type = HOST_SOCK_STREAM;
+		break;
+	case SOCK_DGRAM:
+		type = HOST_SOCK_DGRAM;
+		break;
+	default:
+		return set_errno(EPROTONOSUPPORT);
+	}
+
+	switch (proto) {
+	case 0:
+		break;
+	case IPPROTO_TCP:
+		proto = HOST_IPPROTO_TCP;
+		break;
+	case IPPROTO_UDP:
+		proto = HOST_IPPROTO_UDP;
+		break;
+	default:
+		return set_errno(EPROTONOSUPPORT);
+	}
+
+	ret = host_sock_socket(family, type, proto);
+	if (ret < 0) {
+		return host_error(ret);
+	}
+
+	return socket_alloc(ret);
+}
+
+static int offload_close(int sd)
+{
+	struct host_socket *sock;
+	k_spinlock_key_t key;
+	int fd, ret;
+
+	key = k_spin_lock(&lock);
+
+	sock = get_socket(sd);
+	if (!sock) {
+		k_spin_unlock(&lock, key);
+		return set_errno(EBADF);
+	}
+
+	/* Blocked callers fail with EBADF once woken up */
+	fd = sock->fd;
+	sock->fd = -1;
+	wake_waiters(sock);
+
+	k_spin_unlock(&lock, key);
+
+	ret = host_sock_close(fd);
+	if (ret < 0) {
+		return host_error(ret);
+	}
+
+	return 0;
+}
+
+static int offload_accept(int sd, struct sockaddr *addr, socklen_t *addrlen)
+{
+	struct host_socket *sock = get_socket(sd);
+	struct host_sockaddr host;
+	struct wait wait;
+	int ret;
+
+	if (!sock) {
+		return set_errno(EBADF);
+	}
+
+	wait_start(&wait, sock);
+
+	do {
+		ret = host_sock_accept(sock->fd, &host);
+	} while (ret == -HOST_EAGAIN && !sock->nonblock &&
+		 !k_sem_take(&wait.sem, K_FOREVER));
+
+	wait_end(&wait, sock);
+
+	if (ret < 0) {
+		return host_error(ret);
+	}
+
+	if (addr && addrlen) {
+		from_host_addr(&host, addr, addrlen);
+	}
+
+	return socket_alloc(ret);
+}
+
+static int offload_bind(int sd, const struct sockaddr *addr,
+			socklen_t addrlen)
+{
+	struct host_socket *sock = get_socket(sd);
+	struct host_sockaddr host;
+	int ret;
+
+	if (!sock) {
+		return set_errno(EBADF);
+	}
+
+	ret = to_host_addr(addr, addrlen, &host);
+	if (ret < 0) {
+		return set_errno(-ret);
+	}
+
+	ret = host_sock_bind(sock->fd, &host);
+	if (ret < 0) {
+		return host_error(ret);
+	}
+
+	return 0;
+}
+
+static int offload_listen(int sd, int backlog)
+{
+	struct host_socket *sock = get_socket(sd);
+	int ret;
+
+	if (!sock) {
+		return set_errno(EBADF);
+	}
+
+	ret = host_sock_listen(sock->fd, backlog);
+	if (ret < 0) {
+		return host_error(ret);
+	}
+
+	return 0;
+}
+
+static int offload_connect(int sd, const struct sockaddr *addr,
+			   socklen_t addrlen)
+{
+	struct host_socket *sock = get_socket(sd);
+	struct host_sockaddr host;
+	struct wait wait;
+	int ret, err;
+
+	if (!sock) {
+		return set_errno(EBADF);
+	}
+
+	ret = to_host_addr(addr, addrlen, &host);
+	if (ret < 0) {
+		return set_errno(-ret);
+	}
+
+	wait_start(&wait, sock);
+
+	ret = host_sock_connect(sock->fd, &host);
+	if (ret == -HOST_EINPROGRESS && !sock->nonblock) {
+		/* The host socket becomes writable once connected */
+		do {
+			ret = host_sock_poll(sock->fd);
+		} while (ret >= 0 && !(ret & (HOST_POLLOUT | HOST_POLLERR |
+					      HOST_POLLHUP)) &&
+			 !k_sem_take(&wait.sem, K_FOREVER));
+
+		if (ret >= 0) {
+			ret = host_sock_getsockopt(sock->fd, HOST_SO_ERROR,
+						   &err);
+			if (ret == 0) {
+				ret = -err;
+			}
+		}
+	}
+
+	wait_end(&wait, sock);
+
+	if (ret < 0) {
+		return host_error(ret);
+	}
+
+	return 0;
+}
+
+static int poll_events(struct host_socket *sock)
+{
+	int events = 0;
+	int ret;
+
+	ret = host_sock_poll(sock->fd);
+	if (ret < 0) {
+		return ZSOCK_POLLERR;
+	}
+
+	if (ret & HOST_POLLIN) {
+		events |= ZSOCK_POLLIN;
+	}
+
+	if (ret & HOST_POLLOUT) {
+		events |= ZSOCK_POLLOUT;
+	}
+
+	if (ret & HOST_POLLERR) {
+		events |= ZSOCK_POLLERR;
+	}
+
+	if (ret & HOST_POLLHUP) {
+		events |= ZSOCK_POLLHUP;
+	}
+
+	return events;
+}
+
+static int offload_poll(struct pollfd *fds, int nfds, int timeout)
+{
+	struct waiter waiters[CONFIG_NET_SOCKETS_POLL_MAX];
+	struct host_socket *sock;
+	struct k_sem sem;
+	s64_t end = k_uptime_get() + timeout;
+	s32_t wait;
+	int ret, i;
+
+	if (nfds > ARRAY_SIZE(waiters)) {
+		return set_errno(EINVAL);
+	}
+
+	k_sem_init(&sem, 0, 1);
+
+	for (i = 0; i < nfds; i++) {
+		sock = get_socket(fds[i].fd);
+		if (sock) {
+			waiter_add(sock, &waiters[i], &sem);
+		}
+	}
+
+	while (true) {
+		ret = 0;
+
+		for (i = 0; i < nfds; i++) {
+			fds[i].revents = 0;
+
+			if (fds[i].fd < 0) {
+				continue;
+			}
+
+			sock = get_socket(fds[i].fd);
+			if (!sock) {
+				fds[i].revents = ZSOCK_POLLNVAL;
+			} else {
+				fds[i].revents = poll_events(sock) &
+					(fds[i].events | ZSOCK_POLLERR |
+					 ZSOCK_POLLHUP);
+			}
+
+			if (fds[i].revents) {
+				ret++;
+			}
+		}
+
+		if (ret || timeout == 0) {
+			break;
+		}
+
+		if (timeout < 0) {
+			wait = K_FOREVER;
+		} else {
+			wait = end - k_uptime_get();
+			if (wait <= 0) {
+				break;
+			}
+		}
+
+		k_sem_take(&sem, wait);
+	}
+
+	for (i = 0; i < nfds; i++) {
+		if (fds[i].fd >= 0 && fds[i].fd < MAX_SOCKETS) {
+			waiter_remove(&sockets[fds[i].fd], &waiters[i]);
+		}
+	}
+
+	return ret;
+}
+
+static int to_host_sockopt(int level, int optname)
+{
+	switch (level) {
+	case SOL_SOCKET:
+		switch (optname) {
+		case SO_REUSEADDR:
+			return HOST_SO_REUSEADDR;
+		case SO_ERROR:
+			return HOST_SO_ERROR;
+		case SO_SNDBUF:
+			return HOST_SO_SNDBUF;
+		case SO_RCVBUF:
+			return HOST_SO_RCVBUF;
+		}
+		break;
+	case IPPROTO_TCP:
+		if (optname == TCP_NODELAY) {
+			return HOST_TCP_NODELAY;
+		}
+		break;
+	case IPPROTO_IPV6:
+		if (optname == IPV6_V6ONLY) {
+			return HOST_IPV6_V6ONLY;
+		}
+		break;
+	}
+
+	return -ENOPROTOOPT;
+}
+
+static int offload_setsockopt(int sd, int level, int optname,
+			      const void *optval, socklen_t optlen)
+{
+	struct host_socket *sock = get_socket(sd);
+	int ret;
+
+	if (!sock) {
+		return set_errno(EBADF);
+	}
+
+	optname = to_host_sockopt(level, optname);
+	if (optname < 0) {
+		return set_errno(-optname);
+	}
+
+	if (!optval || optlen < sizeof(int)) {
+		return set_errno(EINVAL);
+	}
+
+	ret = host_sock_setsockopt(sock->fd, optname, *(const int *)optval);
+	if (ret < 0) {
+		return host_error(ret);
+	}
+
+	return 0;
+}
+
+static int offload_getsockopt(int sd, int level, int optname, void *optval,
+			      socklen_t *optlen)
+{
+	struct host_socket *sock = get_socket(sd);
+	int host_optname;
+	int value, ret;
+
+	if (!sock) {
+		return set_errno(EBADF);
+	}
+
+	host_optname = to_host_sockopt(level, optname);
+	if (host_optname < 0) {
+		return set_errno(-host_optname);
+	}
+
+	if (!optval || !optlen || *optlen < sizeof(int)) {
+		return set_errno(EINVAL);
+	}
+
+	ret = host_sock_getsockopt(sock->fd, host_optname, &value);
+	if (ret < 0) {
+		return host_error(ret);
+	}
+
+	if (host_optname == HOST_SO_ERROR && value > 0 &&
+	    value < HOST_ERRNO_COUNT) {
+		value = errnos[value];
+	}
+
+	*(int *)optval = value;
+	*optlen = sizeof(int);
+
+	return 0;
+}
+
+static ssize_t offload_recvfrom(int sd, void *buf, short int len,
+				short int flags, struct sockaddr *from,
+				socklen_t *fromlen)
+{
+	struct host_socket *sock = get_socket(sd);
+	struct host_sockaddr host;
+	struct wait wait;
+	bool nonblock;
+	int ret;
+
+	if (!sock) {
+		return set_errno(EBADF);
+	}
+
+	nonblock = sock->nonblock || (flags & ZSOCK_MSG_DONTWAIT);
+	host.family = 0;
+
+	wait_start(&wait, sock);
+
+	do {
+		ret = host_sock_recvfrom(sock->fd, buf, len,
+					 (flags & ZSOCK_MSG_PEEK) ?
+					 HOST_MSG_PEEK : 0, &host);
+	} while (ret == -HOST_EAGAIN && !nonblock &&
+		 !k_sem_take(&wait.sem, K_FOREVER));
+
+	wait_end(&wait, sock);
+
+	if (ret < 0) {
+		return host_error(ret);
+	}
+
+	if (from && fromlen) {
+		if (host.family) {
+			from_host_addr(&host, from, fromlen);
+		} else {
+			*fromlen = 0;
+		}
+	}
+
+	return ret;
+}
+
+static ssize_t offload_recv(int sd, void *buf, size_t max_len, int flags)
+{
+	return offload_recvfrom(sd, buf, MIN(max_len, SHRT_MAX), flags,
+				NULL, NULL);
+}
+
+static ssize_t offload_sendto(int sd, const void *buf, size_t len,
+			      int flags, const struct sockaddr *to,
+			      socklen_t tolen)
+{
+	struct host_socket *sock = get_socket(sd);
+	struct host_sockaddr host;
+	struct wait wait;
+	bool nonblock;
+	int ret;
+
+	if (!sock) {
+		return set_errno(EBADF);
+	}
+
+	if (to) {
+		ret = to_host_addr(to, tolen, &host);
+		if (ret < 0) {
+			return set_errno(-ret);
+		}
+	}
+
+	nonblock = sock->nonblock || (flags & ZSOCK_MSG_DONTWAIT);
+
+	wait_start(&wait, sock);
+
+	do {
+		ret = host_sock_sendto(sock->fd, buf, len, to ? &host : NULL);
+	} while (ret == -HOST_EAGAIN && !nonblock &&
+		 !k_sem_take(&wait.sem, K_FOREVER));
+
+	wait_end(&wait, sock);
+
+	if (ret < 0) {
+		return host_error(ret);
+	}
+
+	return ret;
+}
+
+static ssize_t offload_send(int sd, const void *buf, size_t len, int flags)
+{
+	return offload_sendto(sd, buf, len, flags, NULL, 0);
+}
+
+static void offload_freeaddrinfo(struct addrinfo *res)
+{
+	struct addrinfo *next;
+
+	/* Each result is freed with its address, see addrinfo_entry */
+	while (res) {
+		next = res->ai_next;
+		free(res);
+		res = next;
+	}
+}
+
+static int offload_getaddrinfo(const char *node, const char *service,
+			       const struct addrinfo *hints,
+			       struct addrinfo **res)
+{
+	struct host_addrinfo results[MAX_ADDRINFO];
+	struct addrinfo_entry *entry;
+	struct addrinfo **next = res;
+	int family = 0, socktype = 0;
+	bool passive = false;
+	int count, i;
+
+	if (hints) {
+		switch (hints->ai_family) {
+		case AF_UNSPEC:
+			break;
+		case AF_INET:
+			family = HOST_AF_INET;
+			break;
+		case AF_INET6:
+			family = HOST_AF_INET6;
+			break;
+		default:
+			return DNS_EAI_FAMILY;
+		}
+
+		if (hints->ai_socktype == SOCK_STREAM) {
+			socktype = HOST_SOCK_STREAM;
+		} else if (hints->ai_socktype == SOCK_DGRAM) {
+			socktype = HOST_SOCK_DGRAM;
+		}
+
+		passive = (hints->ai_flags & AI_PASSIVE) != 0;
+	}
+
+	count = host_sock_getaddrinfo(node, service, family, socktype,
+				      passive, results, ARRAY_SIZE(results));
+	switch (count) {
+	case 0:
+		return EAI_NONAME;
+	case -HOST_EINVAL:
+		return EAI_SERVICE;
+	case -HOST_EAGAIN:
+		return EAI_AGAIN;
+	case -HOST_ENOMEM:
+		return EAI_MEMORY;
+	}
+
+	if (count < 0) {
+		return EAI_FAIL;
+	}
+
+	*res = NULL;
+
+	for (i = 0; i < count; i++) {
+		entry = calloc(1, sizeof(*entry));
+		if (!entry) {
+			offload_freeaddrinfo(*res);
+			*res = NULL;
+			return EAI_MEMORY;
+		}
+
+		entry->ai.ai_family = results[i].addr.family == HOST_AF_INET ?
+				      AF_INET : AF_INET6;
+		entry->ai.ai_socktype =
+			results[i].socktype == HOST_SOCK_DGRAM ?
+			SOCK_DGRAM : SOCK_STREAM;
+		entry->ai.ai_protocol = results[i].proto == HOST_IPPROTO_UDP ?
+					IPPROTO_UDP : IPPROTO_TCP;
+		entry->ai.ai_addr = &entry->addr;
+		entry->ai.ai_addrlen = sizeof(entry->addr);
+		from_host_addr(&results[i].addr, entry->ai.ai_addr,
+			       &entry->ai.ai_addrlen);
+
+		*next = &entry->ai;
+		next = &entry->ai.ai_next;
+	}
+
+	return 0;
+}
+
+static int offload_fcntl(int sd, int cmd, va_list args)
+{
+	struct host_socket *sock = get_socket(sd);
+
+	if (!sock) {
+		return set_errno(EBADF);
+	}
+
+	switch (cmd) {
+	case F_GETFL:
+		return sock->nonblock ? O_NONBLOCK : 0;
+	case F_SETFL:
+		sock->nonblock = (va_arg(args, int) & O_NONBLOCK) != 0;
+		return 0;
+	}
+
+	return set_errno(EINVAL);
+}
+
+static const struct socket_offload native_posix_socket_ops = {
+	.socket = offload_socket,
+	.close = offload_close,
+	.accept = offload_accept,
+	.bind = offload_bind,
+	.listen = offload_listen,
+	.connect = offload_connect,
+	.poll = offload_poll,
+	.setsockopt = offload_setsockopt,
+	.getsockopt = offload_getsockopt,
+	.recv = offload_recv,
+	.recvfrom = offload_recvfrom,
+	.send = offload_send,
+	.sendto = offload_sendto,
+	.getaddrinfo = offload_getaddrinfo,
+	.freeaddrinfo = offload_freeaddrinfo,
+	.fcntl = offload_fcntl,
+};
+
+/* Wake up the waiters of the sockets with new events. The host is polled
+ * without blocking, and only when there is nothing else to run.
+ */
+static void poll_thread(void)
+{
+	int ids[MAX_EVENTS];
+	k_spinlock_key_t key;
+	int count, i;
+
+	while (true) {
+		count = host_sock_wait(ids, ARRAY_SIZE(ids));
+		if (count < 0) {
+			LOG_ERR("Cannot poll host sockets (%d)", count);
+			count = 0;
+		}
+
+		key = k_spin_lock(&lock);
+
+		for (i = 0; i < count; i++) {
+			if (ids[i] >= 0 && ids[i] < MAX_SOCKETS &&
+			    sockets[ids[i]].fd >= 0) {
+				wake_waiters(&sockets[ids[i]]);
+			}
+		}
+
+		k_spin_unlock(&lock, key);
+
+		/* More events may be pending */
+		if (count == ARRAY_SIZE(ids)) {
+			k_yield();
+			continue;
+		}
+
+		k_sleep(K_MSEC(CONFIG_NET_NATIVE_POSIX_SOCKETS_POLL_INTERVAL));
+	}
+}
+
+static int sockets_native_posix_init(struct device *dev)
+{
+	int ret, i;
+
+	ARG_UNUSED(dev);
+
+	for (i = 0; i < MAX_SOCKETS; i++) {
+		sockets[i].fd = -1;
+		sys_slist_init(&sockets[i].waiters);
+	}
+
+	ret = host_sock_init();
+	if (ret < 0) {
+		LOG_ERR("Cannot initialize host sockets (%d)", ret);
+		return -EIO;
+	}
+
+	socket_offload_register(&native_posix_socket_ops);
+
+	k_thread_create(&poll_thread_data, poll_stack,
+			K_THREAD_STACK_SIZEOF(poll_stack),
+			(k_thread_entry_t)poll_thread,
+			NULL, NULL, NULL, K_PRIO_COOP(14), 0, K_NO_WAIT);
+
+	return 0;
+}
+
+SYS_INIT(sockets_native_posix_init, POST_KERNEL,
+	 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -0,0 +1,526 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * Host side of the native posix socket offloading. Those are placed in
+ * separate file because there is naming conflicts between host and zephyr
+ * network stacks.
+ *
+ * All the host sockets are non-blocking and watched by a single epoll
+ * instance, the Zephyr side emulates the blocking calls.
+ */
+
+/* For accept4() and EAI_NODATA */
+#define _GNU_SOURCE
+
+/* Host include files */
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "posix_trace.h"
+
+/* Zephyr include files. Be very careful here and only include minimum
+ * things needed.
+ */
+#include <zephyr/types.h>
+
+#include "sockets_native_posix_priv.h"
+
+static int epoll_fd = -1;
+
+static const int host_errnos[HOST_ERRNO_COUNT] = {
+	[HOST_EIO] = EIO,
+	[HOST_EAGAIN] = EAGAIN,
+	[HOST_EINTR] = EINTR,
+	[HOST_EBADF] = EBADF,
+	[HOST_EINVAL] = EINVAL,
+	[HOST_ENOMEM] = ENOMEM,
+	[HOST_EMFILE] = EMFILE,
+	[HOST_EACCES] = EACCES,
+	[HOST_EPIPE] = EPIPE,
+	[HOST_EMSGSIZE] = EMSGSIZE,
+	[HOST_EOPNOTSUPP] = EOPNOTSUPP,
+	[HOST_EPROTONOSUPPORT] = EPROTONOSUPPORT,
+	[HOST_EAFNOSUPPORT] = EAFNOSUPPORT,
+	[HOST_EADDRINUSE] = EADDRINUSE,
+	[HOST_EADDRNOTAVAIL] = EADDRNOTAVAIL,
+	[HOST_ENETUNREACH] = ENETUNREACH,
+	[HOST_EHOSTUNREACH] = EHOSTUNREACH,
+	[HOST_ECONNABORTED] = ECONNABORTED,
+	[HOST_ECONNRESET] = ECONNRESET,
+	[HOST_ECONNREFUSED] = ECONNREFUSED,
+	[HOST_ENOBUFS] = ENOBUFS,
+	[HOST_EISCONN] = EISCONN,
+	[HOST_ENOTCONN] = ENOTCONN,
+	[HOST_ETIMEDOUT] = ETIMEDOUT,
+	[HOST_EINPROGRESS] = EINPROGRESS,
+	[HOST_EALREADY] = EALREADY,
+	[HOST_EDESTADDRREQ] = EDESTADDRREQ,
+	[HOST_ENOPROTOOPT] = ENOPROTOOPT,
+};
+
+static int to_host_errno(int err)
+{
+	int i;
+
+	if (err == EWOULDBLOCK) {
+		return HOST_EAGAIN;
+	}
+
+	for (i = HOST_EIO; i < HOST_ERRNO_COUNT; i++) {
+		if (host_errnos[i] == err) {
+			return i;
+		}
+	}
+
+	return HOST_EIO;
+}
+
+/* Result of a failed host call */
+static int host_error(void)
+{
+	return -to_host_errno(errno);
+}
+
+static int to_family(int family)
+{
+	switch (family) {
+	case HOST_AF_INET:
+		return AF_INET;
+	case HOST_AF_INET6:
+		return AF_INET6;
+	}
+
+	return -1;
+}
+
+static socklen_t to_sockaddr(const struct host_sockaddr *addr,
+			     struct sockaddr_storage *ss)
+{
+	struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)ss;
+	struct sockaddr_in *sin = (struct sockaddr_in *)ss;
+
+	memset(ss, 0, sizeof(*ss));
+
+	if (addr->family == HOST_AF_INET) {
+		sin->sin_family = AF_INET;
+		sin->sin_port = addr->port;
+		memcpy(&sin->sin_addr, addr->addr, sizeof(sin->sin_addr));
+
+		return sizeof(*sin);
+	}
+
+	sin6->sin6_family = AF_INET6;
+	sin6->sin6_port = addr->port;
+	sin6->sin6_scope_id = addr->scope_id;
+	memcpy(&sin6->sin6_addr, addr->addr, sizeof(sin6->sin6_addr));
+
+	return sizeof(*sin6);
+}
+
+static int from_sockaddr(const struct sockaddr *sa, struct host_sockaddr *addr)
+{
+	const struct sockaddr_in6 *sin6 = (const struct sockaddr_in6 *)sa;
+	const struct sockaddr_in *sin = (const struct sockaddr_in *)sa;
+
+	memset(addr, 0, sizeof(*addr));
+
+	switch (sa->sa_family) {
+	case AF_INET:
+		addr->family = HOST_AF_INET;
+		addr->port = sin->sin_port;
+		memcpy(addr->addr, &sin->sin_addr, sizeof(sin->sin_addr));
+		break;
+	case AF_INET6:
+		addr->family = HOST_AF_INET6;
+		addr->port = sin6->sin6_port;
+		addr->scope_id = sin6->sin6_scope_id;
+		memcpy(addr->addr, &sin6->sin6_addr, sizeof(sin6->sin6_addr));
+		break;
+	default:
+		return -HOST_EAFNOSUPPORT;
+	}
+
+	return 0;
+}
+
+int host_sock_init(void)
+{
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd < 0) {
+		posix_print_warning("Cannot create epoll instance (%d)\n",
+				    errno);
+		return host_error();
+	}
+
+	return 0;
+}
+
+/* Collect the identifiers of the sockets that had an event since the last
+ * call, without blocking.
+ */
+int host_sock_wait(int *ids, int max_ids)
+{
+	struct epoll_event events[16];
+	int ret, i;
+
+	if (max_ids > (int)(sizeof(events) / sizeof(events[0]))) {
+		max_ids = sizeof(events) / sizeof(events[0]);
+	}
+
+	do {
+		ret = epoll_wait(epoll_fd, events, max_ids, 0);
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret < 0) {
+		return host_error();
+	}
+
+	for (i = 0; i < ret; i++) {
+		ids[i] = events[i].data.u32;
+	}
+
+	return ret;
+}
+
+int host_sock_socket(int family, int type, int proto)
+{
+	int ret;
+
+	family = to_family(family);
+	if (family < 0) {
+		return -HOST_EAFNOSUPPORT;
+	}
+
+	switch (type) {
+	case HOST_SOCK_STREAM:
+		type = SOCK_STREAM;
+		break;
+	case HOST_SOCK_DGRAM:
+		type = SOCK_DGRAM;
+		break;
+	default:
+		return -HOST_EPROTONOSUPPORT;
+	}
+
+	switch (proto) {
+	case 0:
+		break;
+	case HOST_IPPROTO_TCP:
+		proto = IPPROTO_TCP;
+		break;
+	case HOST_IPPROTO_UDP:
+		proto = IPPROTO_UDP;
+		break;
+	default:
+		return -HOST_EPROTONOSUPPORT;
+	}
+
+	ret = socket(family, type | SOCK_NONBLOCK | SOCK_CLOEXEC, proto);
+	if (ret < 0) {
+		return host_error();
+	}
+
+	return ret;
+}
+
+/* Report the events of the socket to host_sock_wait() under the given
+ * identifier. Edge triggered, so that a socket is only reported again once
+ * its state changes.
+ */
+int host_sock_watch(int fd, int id)
+{
+	struct epoll_event event = {
+		.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+		.data.u32 = id,
+	};
+
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+		return host_error();
+	}
+
+	return 0;
+}
+
+int host_sock_close(int fd)
+{
+	/* Closing the socket also removes it from the epoll instance */
+	if (close(fd) < 0) {
+		return host_error();
+	}
+
+	return 0;
+}
+
+int host_sock_bind(int fd, const struct host_sockaddr *addr)
+{
+	struct sockaddr_storage ss;
+
+	if (bind(fd, (struct sockaddr *)&ss, to_sockaddr(addr, &ss)) < 0) {
+		return host_error();
+	}
+
+	return 0;
+}
+
+int host_sock_connect(int fd, const struct host_sockaddr *addr)
+{
+	struct sockaddr_storage ss;
+
+	if (connect(fd, (struct sockaddr *)&ss, to_sockaddr(addr, &ss)) < 0) {
+		return host_error();
+	}
+
+	return 0;
+}
+
+int host_sock_listen(int fd, int backlog)
+{
+	if (listen(fd, backlog) < 0) {
+		return host_error();
+	}
+
+	return 0;
+}
+
+int host_sock_accept(int fd, struct host_sockaddr *addr)
+{
+	struct sockaddr_storage ss;
+	socklen_t len = sizeof(ss);
+	int ret;
+
+	ret = accept4(fd, (struct sockaddr *)&ss, &len,
+		      SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (ret < 0) {
+		return host_error();
+	}
+
+	if (addr) {
+		from_sockaddr((struct sockaddr *)&ss, addr);
+	}
+
+	return ret;
+}
+
+int host_sock_sendto(int fd, const void *buf, size_t len,
+		     const struct host_sockaddr *addr)
+{
+	struct sockaddr_storage ss;
+	socklen_t ss_len = 0;
+	ssize_t ret;
+
+	if (addr) {
+		ss_len = to_sockaddr(addr, &ss);
+	}
+
+	/* A reset connection must not raise SIGPIPE in the whole process */
+	ret = sendto(fd, buf, len, MSG_NOSIGNAL,
+		     addr ? (struct sockaddr *)&ss : NULL, ss_len);
+	if (ret < 0) {
+		return host_error();
+	}
+
+	return ret;
+}
+
+int host_sock_recvfrom(int fd, void *buf, size_t len, int flags,
+		       struct host_sockaddr *addr)
+{
+	struct sockaddr_storage ss;
+	socklen_t ss_len = sizeof(ss);
+	ssize_t ret;
+
+	ret = recvfrom(fd, buf, len, (flags & HOST_MSG_PEEK) ? MSG_PEEK : 0,
+		       (struct sockaddr *)&ss, &ss_len);
+	if (ret < 0) {
+		return host_error();
+	}
+
+	/* Not set for connected stream sockets */
+	if (addr && ss_len > 0) {
+		from_sockaddr((struct sockaddr *)&ss, addr);
+	}
+
+	return ret;
+}
+
+static int to_sockopt(int optname, int *level)
+{
+	switch (optname) {
+	case HOST_SO_REUSEADDR:
+		*level = SOL_SOCKET;
+		return SO_REUSEADDR;
+	case HOST_SO_ERROR:
+		*level = SOL_SOCKET;
+		return SO_ERROR;
+	case HOST_SO_SNDBUF:
+		*level = SOL_SOCKET;
+		return SO_SNDBUF;
+	case HOST_SO_RCVBUF:
+		*level = SOL_SOCKET;
+		return SO_RCVBUF;
+	case HOST_TCP_NODELAY:
+		*level = IPPROTO_TCP;
+		return TCP_NODELAY;
+	case HOST_IPV6_V6ONLY:
+		*level = IPPROTO_IPV6;
+		return IPV6_V6ONLY;
+	}
+
+	return -1;
+}
+
+int host_sock_setsockopt(int fd, int optname, int value)
+{
+	int level;
+
+	optname = to_sockopt(optname, &level);
+	if (optname < 0) {
+		return -HOST_ENOPROTOOPT;
+	}
+
+	if (setsockopt(fd, level, optname, &value, sizeof(value)) < 0) {
+		return host_error();
+	}
+
+	return 0;
+}
+
+int host_sock_getsockopt(int fd, int optname, int *value)
+{
+	socklen_t len = sizeof(*value);
+	int host_optname;
+	int level;
+
+	host_optname = to_sockopt(optname, &level);
+	if (host_optname < 0) {
+		return -HOST_ENOPROTOOPT;
+	}
+
+	if (getsockopt(fd, level, host_optname, value, &len) < 0) {
+		return host_error();
+	}
+
+	if (optname == HOST_SO_ERROR && *value) {
+		*value = to_host_errno(*value);
+	}
+
+	return 0;
+}
+
+/* Current events of the socket, HOST_POLL* flags */
+int host_sock_poll(int fd)
+{
+	struct pollfd pfd = {
+		.fd = fd,
+		.events = POLLIN | POLLOUT,
+	};
+	int events = 0;
+	int ret;
+
+	do {
+		ret = poll(&pfd, 1, 0);
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret < 0) {
+		return host_error();
+	}
+
+	if (pfd.revents & POLLIN) {
+		events |= HOST_POLLIN;
+	}
+
+	if (pfd.revents & POLLOUT) {
+		events |= HOST_POLLOUT;
+	}
+
+	if (pfd.revents & (POLLERR | POLLNVAL)) {
+		events |= HOST_POLLERR;
+	}
+
+	if (pfd.revents & POLLHUP) {
+		events |= HOST_POLLHUP;
+	}
+
+	return events;
+}
+
+/* Resolve the name with the host resolver, which blocks the whole process
+ * while waiting for a DNS reply. Returns the number of results, 0 if the
+ * name is unknown and -HOST_EINVAL for an unknown service.
+ */
+int host_sock_getaddrinfo(const char *node, const char *service,
+			  int family, int socktype, bool passive,
+			  struct host_addrinfo *res, int max_res)
+{
+	struct addrinfo hints, *ai, *cur;
+	int count = 0;
+	int ret;
+
+	memset(&hints, 0, sizeof(hints));
+
+	if (family) {
+		hints.ai_family = to_family(family);
+		if (hints.ai_family < 0) {
+			return -HOST_EAFNOSUPPORT;
+		}
+	}
+
+	if (socktype == HOST_SOCK_STREAM) {
+		hints.ai_socktype = SOCK_STREAM;
+	} else if (socktype == HOST_SOCK_DGRAM) {
+		hints.ai_socktype = SOCK_DGRAM;
+	}
+
+	if (passive) {
+		hints.ai_flags = AI_PASSIVE;
+	}
+
+	ret = getaddrinfo(node, service, &hints, &ai);
+	switch (ret) {
+	case 0:
+		break;
+	case EAI_NONAME:
+	case EAI_NODATA:
+		return 0;
+	case EAI_SERVICE:
+		return -HOST_EINVAL;
+	case EAI_AGAIN:
+		return -HOST_EAGAIN;
+	case EAI_MEMORY:
+		return -HOST_ENOMEM;
+	default:
+		return -HOST_EIO;
+	}
+
+	for (cur = ai; cur && count < max_res; cur = cur->ai_next) {
+		if (from_sockaddr(cur->ai_addr, &res[count].addr) < 0) {
+			continue;
+		}
+
+		res[count].socktype = cur->ai_socktype == SOCK_DGRAM ?
+				      HOST_SOCK_DGRAM : HOST_SOCK_STREAM;
+		res[count].proto = cur->ai_protocol == IPPROTO_UDP ?
+				   HOST_IPPROTO_UDP : HOST_IPPROTO_TCP;
+		count++;
+	}
+
+	freeaddrinfo(ai);
+
+	return count;
+}
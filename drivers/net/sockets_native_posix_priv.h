@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Private functions for native posix socket offloading.
+ *
+ * The constants and structures here are shared by the Zephyr and the host
+ * side of the driver, so they cannot use the definitions of either network
+ * stack. Both sides translate their own values to and from these.
+ */
+
+#ifndef ZEPHYR_DRIVERS_NET_SOCKETS_NATIVE_POSIX_PRIV_H_
+#define ZEPHYR_DRIVERS_NET_SOCKETS_NATIVE_POSIX_PRIV_H_
+
+/* Address families */
+#define HOST_AF_INET 1
+#define HOST_AF_INET6 2
+
+/* Socket types */
+#define HOST_SOCK_STREAM 1
+#define HOST_SOCK_DGRAM 2
+
+/* Protocols */
+#define HOST_IPPROTO_TCP 6
+#define HOST_IPPROTO_UDP 17
+
+/* Message flags */
+#define HOST_MSG_PEEK 0x01
+
+/* Socket options */
+#define HOST_SO_REUSEADDR 1
+#define HOST_SO_ERROR 2
+#define HOST_SO_SNDBUF 3
+#define HOST_SO_RCVBUF 4
+#define HOST_TCP_NODELAY 5
+#define HOST_IPV6_V6ONLY 6
+
+/* Poll events */
+#define HOST_POLLIN 0x01
+#define HOST_POLLOUT 0x02
+#define HOST_POLLERR 0x04
+#define HOST_POLLHUP 0x08
+
+/* Error codes, returned negated by the host functions. Host error codes
+ * not listed here are reported as HOST_EIO.
+ */
+enum host_errno {
+	HOST_EIO = 1,
+	HOST_EAGAIN,
+	HOST_EINTR,
+	HOST_EBADF,
+	HOST_EINVAL,
+	HOST_ENOMEM,
+	HOST_EMFILE,
+	HOST_EACCES,
+	HOST_EPIPE,
+	HOST_EMSGSIZE,
+	HOST_EOPNOTSUPP,
+	HOST_EPROTONOSUPPORT,
+	HOST_EAFNOSUPPORT,
+	HOST_EADDRINUSE,
+	HOST_EADDRNOTAVAIL,
+	HOST_ENETUNREACH,
+	HOST_EHOSTUNREACH,
+	HOST_ECONNABORTED,
+	HOST_ECONNRESET,
+	HOST_ECONNREFUSED,
+	HOST_ENOBUFS,
+	HOST_EISCONN,
+	HOST_ENOTCONN,
+	HOST_ETIMEDOUT,
+	HOST_EINPROGRESS,
+	HOST_EALREADY,
+	HOST_EDESTADDRREQ,
+	HOST_ENOPROTOOPT,
+
+	HOST_ERRNO_COUNT
+};
+
+/* Socket address, port and address in network byte order */
+struct host_sockaddr {
+	int family;
+	u16_t port;
+	u8_t addr[16];
+	u32_t scope_id;
+};
+
+/* One result of host_sock_getaddrinfo() */
+struct host_addrinfo {
+	int socktype;
+	int proto;
+	struct host_sockaddr addr;
+};
+
+int host_sock_init(void);
+int host_sock_wait(int *ids, int max_ids);
+int host_sock_socket(int family, int type, int proto);
+int host_sock_watch(int fd, int id);
+int host_sock_close(int fd);
+int host_sock_bind(int fd, const struct host_sockaddr *addr);
+int host_sock_connect(int fd, const struct host_sockaddr *addr);
+int host_sock_listen(int fd, int backlog);
+int host_sock_accept(int fd, struct host_sockaddr *addr);
+int host_sock_sendto(int fd, const void *buf, size_t len,
+		     const struct host_sockaddr *addr);
+int host_sock_recvfrom(int fd, void *buf, size_t len, int flags,
+		       struct host_sockaddr *addr);
+int host_sock_setsockopt(int fd, int optname, int value);
+int host_sock_getsockopt(int fd, int optname, int *value);
+int host_sock_poll(int fd);
+int host_sock_getaddrinfo(const char *node, const char *service,
+			  int family, int socktype, bool passive,
+			  struct host_addrinfo *res, int max_res);
+
+#endif /* ZEPHYR_DRIVERS_NET_SOCKETS_NATIVE_POSIX_PRIV_H_ */
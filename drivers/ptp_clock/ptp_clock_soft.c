@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2019 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * Software PTP clock. Its time is derived from the kernel cycle counter,
+ * scaled by a frequency adjustment so that it can be synchronized to a
+ * gPTP grandmaster without a hardware clock.
+ */
+
+#include <kernel.h>
+#include <device.h>
+#include <spinlock.h>
+#include <errno.h>
+#include <ptp_clock.h>
+
+struct ptp_soft_data {
+	struct k_spinlock lock;
+
+	/* Keeps the cycle count from wrapping between two updates */
+	struct k_timer timer;
+
+	/* Time of the clock in nanoseconds at the last update */
+	u64_t time;
+
+	/* Cycle count at the last update */
+	u32_t cycles;
+
+	/* Remainders of the conversions, carried to the next update so
+	 * that the clock does not drift by rounding.
+	 */
+	u32_t cycles_rem;
+	s64_t adj_rem;
+
+	/* Frequency adjustment in parts per billion */
+	s32_t ppb;
+};
+
+static struct ptp_soft_data ptp_soft_0_data;
+
+/* Called with the lock held */
+static void ptp_soft_update(struct ptp_soft_data *data)
+{
+	u32_t hz = sys_clock_hw_cycles_per_sec();
+	u32_t now = k_cycle_get_32();
+	u64_t ns;
+	s64_t adj;
+
+	ns = (u64_t)(now - data->cycles) * NSEC_PER_SEC + data->cycles_rem;
+
+	data->cycles = now;
+	data->cycles_rem = ns % hz;
+
+	ns /= hz;
+
+	adj = (s64_t)ns * data->ppb + data->adj_rem;
+	data->adj_rem = adj % NSEC_PER_SEC;
+
+	data->time += ns + adj / NSEC_PER_SEC;
+}
+
+static void ptp_soft_timer(struct k_timer *timer)
+{
+	struct ptp_soft_data *data =
+		CONTAINER_OF(timer, struct ptp_soft_data, timer);
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&data->lock);
+	ptp_soft_update(data);
+	k_spin_unlock(&data->lock, key);
+}
+
+static int ptp_clock_soft_set(struct device *dev, struct net_ptp_time *tm)
+{
+	struct ptp_soft_data *data = dev->driver_data;
+	k_spinlock_key_t key;
+
+	if (tm->nanosecond >= NSEC_PER_SEC) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&data->lock);
+
+	ptp_soft_update(data);
+	data->time = tm->second * NSEC_PER_SEC + tm->nanosecond;
+
+	k_spin_unlock(&data->lock, key);
+
+	return 0;
+}
+
+static int ptp_clock_soft_get(struct device *dev, struct net_ptp_time *tm)
+{
+	struct ptp_soft_data *data = dev->driver_data;
+	k_spinlock_key_t key;
+	u64_t time;
+
+	key = k_spin_lock(&data->lock);
+
+	ptp_soft_update(data);
+	time = data->time;
+
+	k_spin_unlock(&data->lock, key);
+
+	tm->second = time / NSEC_PER_SEC;
+	tm->nanosecond = time % NSEC_PER_SEC;
+
+	return 0;
+}
+
+static int ptp_clock_soft_adjust(struct device *dev, int increment)
+{
+	struct ptp_soft_data *data = dev->driver_data;
+	k_spinlock_key_t key;
+	int ret = 0;
+
+	key = k_spin_lock(&data->lock);
+
+	ptp_soft_update(data);
+
+	if (increment < 0 && data->time < (u64_t)-(s64_t)increment) {
+		ret = -EINVAL;
+	} else {
+		data->time += increment;
+	}
+
+	k_spin_unlock(&data->lock, key);
+
+	return ret;
+}
+
+static int ptp_clock_soft_rate_adjust(struct device *dev, float ratio)
+{
+	struct ptp_soft_data *data = dev->driver_data;
+	k_spinlock_key_t key;
+	double ppb;
+	int ret = 0;
+
+	/* No change needed. */
+	if (ratio == 1.0f) {
+		return 0;
+	}
+
+	key = k_spin_lock(&data->lock);
+
+	/* The ratio is relative to the current frequency */
+	ppb = ((double)NSEC_PER_SEC + data->ppb) * ratio - NSEC_PER_SEC;
+
+	if (ppb > CONFIG_PTP_CLOCK_SOFT_MAX_PPB ||
+	    ppb < -CONFIG_PTP_CLOCK_SOFT_MAX_PPB) {
+		ret = -EINVAL;
+	} else {
+		ptp_soft_update(data);
+		data->ppb = (s32_t)ppb;
+	}
+
+	k_spin_unlock(&data->lock, key);
+
+	return ret;
+}
+
+static const struct ptp_clock_driver_api api = {
+	.set = ptp_clock_soft_set,
+	.get = ptp_clock_soft_get,
+	.adjust = ptp_clock_soft_adjust,
+	.rate_adjust = ptp_clock_soft_rate_adjust,
+};
+
+static int ptp_clock_soft_init(struct device *dev)
+{
+	struct ptp_soft_data *data = dev->driver_data;
+	u64_t period;
+
+	/* Update at least four times per wrap of the cycle counter, and
+	 * every second to bound the frequency adjustment computation.
+	 */
+	period = (u64_t)UINT32_MAX * MSEC_PER_SEC /
+		 sys_clock_hw_cycles_per_sec() / 4U;
+	period = MAX(MIN(period, MSEC_PER_SEC), 1);
+
+	ptp_soft_update(data);
+
+	k_timer_init(&data->timer, ptp_soft_timer, NULL);
+	k_timer_start(&data->timer, period, period);
+
+	return 0;
+}
+
+DEVICE_AND_API_INIT(ptp_clock_soft_0, CONFIG_PTP_CLOCK_SOFT_NAME,
+		    ptp_clock_soft_init, &ptp_soft_0_data, NULL, POST_KERNEL,
+		    CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &api);
@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_CBOR_H_
+#define ZEPHYR_INCLUDE_CBOR_H_
+
+/**
+ * @defgroup cbor CBOR
+ * @ingroup structured_data
+ * @{
+ */
+
+#include <json.h>
+#include <net/buf.h>
+#include <stddef.h>
+#include <zephyr/types.h>
+#include <sys/types.h>
+
+/**
+ * @brief Reader of CBOR (RFC 7049) encoded data
+ *
+ * The reader decodes one data item at a time, without copying: strings
+ * are returned as pointers into the input buffer. Only definite length
+ * strings are supported.
+ *
+ * On error, the reader is left on the item which could not be read.
+ */
+struct cbor_reader {
+	const u8_t *pos;
+	const u8_t *end;
+};
+
+/**
+ * @brief Number of elements or pairs of an indefinite length array or map
+ *
+ * Such a container ends with a break, see cbor_read_break() and
+ * cbor_encode_break().
+ */
+#define CBOR_INDEFINITE_LEN SIZE_MAX
+
+/**
+ * @brief Initializes a CBOR reader
+ *
+ * @param reader Reader to initialize
+ * @param data CBOR-encoded data, which must remain valid while the reader,
+ * or any string returned by it, is in use
+ * @param len Length of the CBOR-encoded data
+ */
+void cbor_reader_init(struct cbor_reader *reader, const u8_t *data,
+		      size_t len);
+
+/**
+ * @brief Reads an integer
+ *
+ * @param reader Reader
+ * @param value Decoded value
+ *
+ * @return 0 on success, -ERANGE if the integer does not fit in a s32_t,
+ * -EINVAL if the next item is not an integer or is truncated.
+ */
+int cbor_read_int(struct cbor_reader *reader, s32_t *value);
+
+/**
+ * @brief Reads an integer of up to 64 bits
+ *
+ * @param reader Reader
+ * @param value Decoded value
+ *
+ * @return 0 on success, -ERANGE if the integer does not fit in a s64_t,
+ * -EINVAL if the next item is not an integer or is truncated.
+ */
+int cbor_read_int64(struct cbor_reader *reader, s64_t *value);
+
+/**
+ * @brief Reads a boolean
+ *
+ * @param reader Reader
+ * @param value Decoded value
+ *
+ * @return 0 on success, -EINVAL if the next item is not a boolean.
+ */
+int cbor_read_bool(struct cbor_reader *reader, bool *value);
+
+/**
+ * @brief Reads a floating-point number
+ *
+ * The value is not converted, so that no floating-point support is
+ * needed: it is returned as its IEEE 754 half, single or double
+ * precision representation.
+ *
+ * @param reader Reader
+ * @param bits Set to the representation in the input buffer, in network
+ * byte order
+ * @param len Set to the length of the representation: 2, 4 or 8
+ *
+ * @return 0 on success, -EINVAL if the next item is not a floating-point
+ * number or is truncated.
+ */
+int cbor_read_float(struct cbor_reader *reader, const u8_t **bits,
+		    size_t *len);
+
+/**
+ * @brief Reads a text string
+ *
+ * @param reader Reader
+ * @param text Set to the first character of the string in the input
+ * buffer. The string is not NUL-terminated.
+ * @param len Set to the length of the string
+ *
+ * @return 0 on success, -EINVAL if the next item is not a text string or
+ * is truncated, -ENOTSUP if the string has an indefinite length.
+ */
+int cbor_read_text(struct cbor_reader *reader, const char **text,
+		   size_t *len);
+
+/**
+ * @brief Reads a byte string
+ *
+ * @param reader Reader
+ * @param bytes Set to the first byte of the string in the input buffer
+ * @param len Set to the length of the string
+ *
+ * @return 0 on success, -EINVAL if the next item is not a byte string or
+ * is truncated, -ENOTSUP if the string has an indefinite length.
+ */
+int cbor_read_bytes(struct cbor_reader *reader, const u8_t **bytes,
+		    size_t *len);
+
+/**
+ * @brief Reads the start of an array
+ *
+ * The elements of the array are the next @a count items, or the items up
+ * to a break if @a count is CBOR_INDEFINITE_LEN.
+ *
+ * @param reader Reader
+ * @param count Set to the number of elements
+ *
+ * @return 0 on success, -EINVAL if the next item is not an array or is
+ * truncated.
+ */
+int cbor_read_array(struct cbor_reader *reader, size_t *count);
+
+/**
+ * @brief Reads the start of a map
+ *
+ * The key and value of each pair are the next 2 * @a count items, or the
+ * items up to a break if @a count is CBOR_INDEFINITE_LEN.
+ *
+ * @param reader Reader
+ * @param count Set to the number of pairs
+ *
+ * @return 0 on success, -EINVAL if the next item is not a map or is
+ * truncated.
+ */
+int cbor_read_map(struct cbor_reader *reader, size_t *count);
+
+/**
+ * @brief Reads the break ending an indefinite length array or map
+ *
+ * @param reader Reader
+ *
+ * @return 0 on success, -EINVAL if the next item is not a break.
+ */
+int cbor_read_break(struct cbor_reader *reader);
+
+/**
+ * @brief Skips the next item, along with its elements or pairs
+ *
+ * @param reader Reader
+ *
+ * @return 0 on success, -EINVAL if the item is truncated, -ENOTSUP if it
+ * contains an item of indefinite length.
+ */
+int cbor_skip(struct cbor_reader *reader);
+
+/**
+ * @brief Parses a CBOR-encoded map into a struct, as described by the
+ * same descriptors as json_obj_parse()
+ *
+ * Map keys are the field names, and the values are decoded according to
+ * the field types: JSON_TOK_NUMBER fields hold integers, JSON_TOK_STRING
+ * fields text strings, JSON_TOK_TRUE and JSON_TOK_FALSE fields booleans,
+ * JSON_TOK_OBJECT_START fields maps and JSON_TOK_LIST_START fields arrays.
+ * Pairs with an unknown key are skipped.
+ *
+ * Arrays and maps of indefinite length are not supported.
+ *
+ * Like json_obj_parse(), strings are not copied: each one is moved onto
+ * its header in @a payload, to make room for a NUL terminator, and the
+ * field points into @a payload.
+ *
+ * @param payload Pointer to the CBOR-encoded map
+ * @param len Length of the CBOR-encoded map
+ * @param descr Pointer to the descriptor array
+ * @param descr_len Number of elements in the descriptor array. Must be less
+ * than 31 due to implementation detail reasons (if more fields are
+ * necessary, use two descriptors)
+ * @param val Pointer to the struct to hold the decoded values
+ *
+ * @return < 0 if error, bitmap of decoded fields on success (bit 0
+ * is set if first field in the descriptor has been properly decoded, etc).
+ */
+int cbor_obj_parse(u8_t *payload, size_t len,
+		   const struct json_obj_descr *descr, size_t descr_len,
+		   void *val);
+
+/**
+ * @brief Encodes an integer
+ *
+ * The encoders of single items below send their output through a
+ * callback, like cbor_obj_encode().
+ *
+ * @param value Value to encode
+ * @param append_bytes Function to append bytes to the output
+ * @param data Data pointer to be passed to the append_bytes callback
+ *
+ * @return 0 on success, or the error returned by @a append_bytes.
+ */
+int cbor_encode_int(s64_t value, json_append_bytes_t append_bytes,
+		    void *data);
+
+/**
+ * @brief Encodes a boolean
+ *
+ * @param value Value to encode
+ * @param append_bytes Function to append bytes to the output
+ * @param data Data pointer to be passed to the append_bytes callback
+ *
+ * @return 0 on success, or the error returned by @a append_bytes.
+ */
+int cbor_encode_bool(bool value, json_append_bytes_t append_bytes,
+		     void *data);
+
+/**
+ * @brief Encodes a floating-point number
+ *
+ * @param bits IEEE 754 half, single or double precision representation
+ * of the value, in network byte order
+ * @param len Length of the representation: 2, 4 or 8
+ * @param append_bytes Function to append bytes to the output
+ * @param data Data pointer to be passed to the append_bytes callback
+ *
+ * @return 0 on success, -EINVAL if @a len is invalid, or the error returned
+ * by @a append_bytes.
+ */
+int cbor_encode_float(const u8_t *bits, size_t len,
+		      json_append_bytes_t append_bytes, void *data);
+
+/**
+ * @brief Encodes a text string
+ *
+ * @param text String to encode, which does not need to be NUL-terminated
+ * @param len Length of the string
+ * @param append_bytes Function to append bytes to the output
+ * @param data Data pointer to be passed to the append_bytes callback
+ *
+ * @return 0 on success, or the error returned by @a append_bytes.
+ */
+int cbor_encode_text(const char *text, size_t len,
+		     json_append_bytes_t append_bytes, void *data);
+
+/**
+ * @brief Encodes a byte string
+ *
+ * @param bytes Bytes to encode
+ * @param len Number of bytes
+ * @param append_bytes Function to append bytes to the output
+ * @param data Data pointer to be passed to the append_bytes callback
+ *
+ * @return 0 on success, or the error returned by @a append_bytes.
+ */
+int cbor_encode_bytes(const u8_t *bytes, size_t len,
+		      json_append_bytes_t append_bytes, void *data);
+
+/**
+ * @brief Encodes the start of an array
+ *
+ * The elements are to be encoded next, followed by a break with
+ * cbor_encode_break() if @a count is CBOR_INDEFINITE_LEN.
+ *
+ * @param count Number of elements, or CBOR_INDEFINITE_LEN
+ * @param append_bytes Function to append bytes to the output
+ * @param data Data pointer to be passed to the append_bytes callback
+ *
+ * @return 0 on success, or the error returned by @a append_bytes.
+ */
+int cbor_encode_array(size_t count, json_append_bytes_t append_bytes,
+		      void *data);
+
+/**
+ * @brief Encodes the start of a map
+ *
+ * The keys and values are to be encoded next, followed by a break with
+ * cbor_encode_break() if @a count is CBOR_INDEFINITE_LEN.
+ *
+ * @param count Number of pairs, or CBOR_INDEFINITE_LEN
+ * @param append_bytes Function to append bytes to the output
+ * @param data Data pointer to be passed to the append_bytes callback
+ *
+ * @return 0 on success, or the error returned by @a append_bytes.
+ */
+int cbor_encode_map(size_t count, json_append_bytes_t append_bytes,
+		    void *data);
+
+/**
+ * @brief Encodes the break ending an indefinite length array or map
+ *
+ * @param append_bytes Function to append bytes to the output
+ * @param data Data pointer to be passed to the append_bytes callback
+ *
+ * @return 0 on success, or the error returned by @a append_bytes.
+ */
+int cbor_encode_break(json_append_bytes_t append_bytes, void *data);
+
+/**
+ * @brief Encodes an object in CBOR, as described by the same descriptors
+ * as json_obj_encode()
+ *
+ * The output is sent through a callback, so it can be streamed as it is
+ * produced.
+ *
+ * @param descr Pointer to the descriptor array
+ * @param descr_len Number of elements in the descriptor array
+ * @param val Struct holding the values
+ * @param append_bytes Function to append bytes to the output
+ * @param data Data pointer to be passed to the append_bytes callback
+ * function.
+ *
+ * @return 0 if object has been successfully encoded. A negative value
+ * indicates an error.
+ */
+int cbor_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
+		    const void *val, json_append_bytes_t append_bytes,
+		    void *data);
+
+/**
+ * @brief Encodes an object in CBOR into a contiguous buffer
+ *
+ * @param descr Pointer to the descriptor array
+ * @param descr_len Number of elements in the descriptor array
+ * @param val Struct holding the values
+ * @param buffer Buffer to store the encoded object
+ * @param buf_size Size of buffer, in bytes
+ *
+ * @return Length of the encoded object, or a negative value on error
+ * (-ENOMEM if the buffer is too small).
+ */
+ssize_t cbor_obj_encode_buf(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val,
+			    u8_t *buffer, size_t buf_size);
+
+/**
+ * @brief Calculates the CBOR-encoded length of an object
+ *
+ * @param descr Pointer to the descriptor array
+ * @param descr_len Number of elements in the descriptor array
+ * @param val Struct holding the values
+ *
+ * @return Encoded length, or a negative value on error.
+ */
+ssize_t cbor_calc_encoded_len(const struct json_obj_descr *descr,
+			      size_t descr_len, const void *val);
+
+/**
+ * @brief Encodes an object in CBOR at the end of a net_buf chain
+ *
+ * Fragments are added to the chain as needed, using the same allocator as
+ * net_buf_append_bytes().
+ *
+ * @param descr Pointer to the descriptor array
+ * @param descr_len Number of elements in the descriptor array
+ * @param val Struct holding the values
+ * @param buf Network buffer the object is appended to
+ * @param timeout Time to wait for each allocated fragment
+ * @param allocate_cb Function allocating a new fragment
+ * @param user_data Data pointer to be passed to the allocate_cb callback
+ *
+ * @return 0 if object has been successfully encoded, -ENOMEM if a fragment
+ * could not be allocated, or another negative value on error. The object
+ * may have been partly appended on error.
+ */
+int cbor_obj_encode_net_buf(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val,
+			    struct net_buf *buf, s32_t timeout,
+			    net_buf_allocator_cb allocate_cb, void *user_data);
+
+/**
+ * @}
+ */
+#endif /* ZEPHYR_INCLUDE_CBOR_H_ */
@@ -632,6 +632,193 @@ int json_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
 		    const void *val, json_append_bytes_t append_bytes,
 		    void *data);
 
+/** Maximum nesting of objects and arrays in streamed JSON documents */
+#define JSON_MAX_DEPTH 32
+
+/**
+ * @brief Token of a streamed JSON document
+ *
+ * Keys and string values are in their escaped form, as they appear in
+ * the JSON document, without the quotes. Neither are NUL-terminated.
+ */
+struct json_token {
+	/** One of JSON_TOK_OBJECT_START, JSON_TOK_OBJECT_END,
+	 * JSON_TOK_LIST_START, JSON_TOK_LIST_END, JSON_TOK_STRING,
+	 * JSON_TOK_NUMBER, JSON_TOK_TRUE, JSON_TOK_FALSE or JSON_TOK_NULL.
+	 */
+	enum json_tokens type;
+
+	/** Number of objects and arrays the token is nested in */
+	int depth;
+
+	/** Key of an object member, NULL for array elements and for the
+	 * end tokens.
+	 */
+	const char *key;
+	size_t key_len;
+
+	/** Text of a string or number value, empty for the other tokens */
+	const char *value;
+	size_t value_len;
+};
+
+/**
+ * @brief Function pointer type to receive the tokens of a JSON document
+ *
+ * @param token Token, only valid during the call
+ * @param data User-provided pointer
+ *
+ * @return 0 to continue parsing, or a negative number to stop, which is
+ * then returned by json_parser_feed().
+ */
+typedef int (*json_token_cb_t)(const struct json_token *token, void *data);
+
+/**
+ * @brief Incremental JSON parser
+ *
+ * The fields are private, use json_parser_init() to set it up.
+ */
+struct json_parser {
+	json_token_cb_t token_cb;
+	void *data;
+
+	/* Key of the current value, followed by the value itself */
+	char *buf;
+	size_t buf_size;
+	size_t key_len;
+	size_t len;
+
+	/* Bit n is set when the container at depth n is an object */
+	u32_t objects;
+
+	u8_t depth;
+	u8_t state;
+	bool has_key;
+
+	/* Progress within a string, number or literal token */
+	u8_t lex;
+	u8_t lex_type;
+	u8_t lex_pos;
+};
+
+/**
+ * @brief Initializes an incremental JSON parser
+ *
+ * The parser accepts the document in chunks of any size, and reports its
+ * tokens through a callback as soon as they are complete. Only the current
+ * key and value are kept, so memory use does not depend on the size of the
+ * document. For instance, the fragments of a network buffer are parsed
+ * with:
+ *
+ *     json_parser_init(&parser, buf, sizeof(buf), token_cb, &ctx);
+ *
+ *     for (frag = pkt->frags; frag; frag = frag->frags) {
+ *         ret = json_parser_feed(&parser, frag->data, frag->len);
+ *         if (ret < 0) {
+ *             return ret;
+ *         }
+ *     }
+ *
+ *     ret = json_parser_finish(&parser);
+ *
+ * The same liberties as json_obj_parse() are taken: strings are not
+ * unescaped and UTF-8 is not validated.
+ *
+ * @param parser Parser to initialize
+ *
+ * @param buf Buffer holding the current key and value, its size limits
+ * their total length
+ *
+ * @param buf_size Size of the buffer
+ *
+ * @param token_cb Function called for each token
+ *
+ * @param data Data pointer to be passed to the token_cb callback
+ */
+void json_parser_init(struct json_parser *parser, char *buf, size_t buf_size,
+		      json_token_cb_t token_cb, void *data);
+
+/**
+ * @brief Parses the next chunk of a JSON document
+ *
+ * @param parser Parser
+ *
+ * @param chunk Next bytes of the document
+ *
+ * @param len Number of bytes in chunk
+ *
+ * @return 0 on success, -EINVAL if the document is invalid, -ENOMEM if a
+ * key and its value do not fit in the buffer, -ENOSPC if the document is
+ * nested deeper than JSON_MAX_DEPTH, or the error returned by the
+ * callback. The parser cannot be used anymore after an error.
+ */
+int json_parser_feed(struct json_parser *parser, const char *chunk,
+		     size_t len);
+
+/**
+ * @brief Checks that the whole document has been parsed
+ *
+ * Completes a number ending the document, which cannot be reported before
+ * knowing that no more digits follow.
+ *
+ * @param parser Parser
+ *
+ * @return 0 if the document is complete, a negative value otherwise
+ */
+int json_parser_finish(struct json_parser *parser);
+
+/**
+ * @brief Incremental JSON encoder
+ *
+ * The fields are private, use json_encoder_init() to set it up.
+ */
+struct json_encoder {
+	json_append_bytes_t append_bytes;
+	void *data;
+
+	/* Bit n is set when the container at depth n is an object */
+	u32_t objects;
+
+	/* Bit n is set once the container at depth n has a member */
+	u32_t members;
+
+	u8_t depth;
+};
+
+/**
+ * @brief Initializes an incremental JSON encoder
+ *
+ * The encoder writes a document token by token, adding the separators.
+ * Its tokens are the ones reported by the parser, so that a document can
+ * be filtered or rewritten while streaming it.
+ *
+ * @param encoder Encoder to initialize
+ *
+ * @param append_bytes Function to append bytes to the output
+ *
+ * @param data Data pointer to be passed to the append_bytes callback
+ * function.
+ */
+void json_encoder_init(struct json_encoder *encoder,
+		       json_append_bytes_t append_bytes, void *data);
+
+/**
+ * @brief Encodes the next token of a JSON document
+ *
+ * Members of an object need a key. Keys and string values must already be
+ * escaped, see json_escape(). The depth of the token is not used.
+ *
+ * @param encoder Encoder
+ *
+ * @param token Token to encode
+ *
+ * @return 0 if the token has been encoded, -EINVAL if it does not fit in
+ * the document structure, -ENOSPC if the document is nested deeper than
+ * JSON_MAX_DEPTH, or the error returned by the append_bytes callback.
+ */
+int json_encoder_token(struct json_encoder *encoder,
+		       const struct json_token *token);
+
 /**
  * @}
  */
@@ -0,0 +1,299 @@
+/** @file
+ * @brief Network packet capture support
+ *
+ * Capture the packets sent and received by network interfaces, and
+ * stream them out in pcapng format.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_CAPTURE_H_
+#define ZEPHYR_INCLUDE_NET_CAPTURE_H_
+
+/**
+ * @brief Network packet capture
+ * @defgroup net_capture Network packet capture
+ * @ingroup networking
+ * @{
+ */
+
+#include <zephyr/types.h>
+#include <net/net_ip.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Direction of a captured packet */
+enum net_capture_dir {
+	/** Packet received by the interface */
+	NET_CAPTURE_RX = 1,
+	/** Packet sent by the interface */
+	NET_CAPTURE_TX = 2,
+};
+
+/** @cond INTERNAL_HIDDEN */
+
+#if defined(CONFIG_NET_CAPTURE)
+#define NET_CAPTURE_FILTER_MAX_INSNS CONFIG_NET_CAPTURE_FILTER_MAX_INSNS
+#else
+#define NET_CAPTURE_FILTER_MAX_INSNS 1
+#endif
+
+struct net_capture_insn {
+	u8_t op;
+	u8_t dir;
+	sa_family_t family;
+	union {
+		struct in6_addr in6_addr;
+		struct in_addr in_addr;
+		u16_t value;
+	};
+};
+
+/** @endcond */
+
+/**
+ * @brief Compiled capture filter
+ *
+ * A filter is compiled from an expression with a subset of the tcpdump
+ * syntax, see net_capture_filter_compile(). It is evaluated on the
+ * headers of each packet before it is queued, so that the packets not
+ * matching it cost nothing more.
+ */
+struct net_capture_filter {
+	/** @cond INTERNAL_HIDDEN */
+	struct net_capture_insn insns[NET_CAPTURE_FILTER_MAX_INSNS];
+	u8_t count;
+	/** @endcond */
+};
+
+/** Capture statistics of a network interface */
+struct net_capture_stats {
+	/** Packets queued for output */
+	u32_t captured;
+	/** Packets not matching the filter */
+	u32_t filtered;
+	/** Packets lost as the ring or the copy buffers were full */
+	u32_t dropped;
+};
+
+/**
+ * @brief Output of the captured packets.
+ *
+ * The backend receives a pcapng stream: a section header, then the
+ * description of the captured interfaces and their packets. The
+ * functions are only called from the capture thread.
+ */
+struct net_capture_backend {
+	/** Prepare the output, called before the first write */
+	int (*open)(void);
+
+	/** Write data, returns 0 if ok, <0 if error */
+	int (*write)(const void *data, size_t len);
+};
+
+#if defined(CONFIG_NET_CAPTURE)
+
+/**
+ * @brief Compile a capture filter expression.
+ *
+ * The expression combines the following primitives with "and" ("&&"),
+ * "or" ("||"), "not" ("!") and parentheses, two primitives next to each
+ * other being combined with "and":
+ *
+ * - "ip", "ip6", "arp": network protocol
+ * - "tcp", "udp", "icmp", "icmp6": transport protocol
+ * - "[src|dst] host <address>": IPv4 or IPv6 address
+ * - "[src|dst] port <port>": TCP or UDP port
+ * - "less <length>", "greater <length>": packet length
+ *
+ * For example "udp and not port 53" or "ip6 host 2001:db8::1".
+ *
+ * @param expr Filter expression, an empty one matching all packets
+ * @param filter Compiled filter
+ *
+ * @return 0 if ok, -EINVAL if the expression is invalid, -ENOMEM if it is
+ * too long for CONFIG_NET_CAPTURE_FILTER_MAX_INSNS.
+ */
+int net_capture_filter_compile(const char *expr,
+			       struct net_capture_filter *filter);
+
+/**
+ * @brief Check if a frame matches a capture filter.
+ *
+ * @param filter Compiled filter
+ * @param iface Network interface the frame is captured on, giving its
+ * link layer
+ * @param buf First fragment of the frame
+ * @param len Length of the frame
+ *
+ * @return True if the frame matches
+ */
+bool net_capture_filter_match(const struct net_capture_filter *filter,
+			      struct net_if *iface, struct net_buf *buf,
+			      size_t len);
+
+/**
+ * @brief Start capturing the packets of a network interface.
+ *
+ * The captured packets are queued to a ring buffer by reference, and
+ * written out in pcapng format by the capture thread. The data of the
+ * packets is not copied, except on IEEE 802.15.4 interfaces where the
+ * 6LoWPAN adaptation rewrites the frames in place.
+ *
+ * @param iface Network interface
+ * @param filter Compiled filter, or NULL to capture all packets
+ *
+ * @return 0 if ok, -EALREADY if the interface is already captured,
+ * -ENOMEM if CONFIG_NET_CAPTURE_IFACE_COUNT interfaces are already
+ * captured, -ENOTSUP if the link layer is not supported.
+ */
+int net_capture_enable(struct net_if *iface,
+		       const struct net_capture_filter *filter);
+
+/**
+ * @brief Stop capturing the packets of a network interface.
+ *
+ * The packets already captured are written out before returning.
+ *
+ * @param iface Network interface
+ *
+ * @return 0 if ok, -EALREADY if the interface is not captured.
+ */
+int net_capture_disable(struct net_if *iface);
+
+/**
+ * @brief Check if the packets of a network interface are captured.
+ *
+ * @param iface Network interface
+ *
+ * @return True if captured
+ */
+static inline bool net_capture_is_enabled(struct net_if *iface)
+{
+	return net_if_flag_is_set(iface, NET_IF_CAPTURE);
+}
+
+/**
+ * @brief Get the capture statistics of a network interface.
+ *
+ * @param iface Network interface
+ * @param stats Statistics
+ *
+ * @return 0 if ok, -ENOENT if the interface is not captured.
+ */
+int net_capture_get_stats(struct net_if *iface,
+			  struct net_capture_stats *stats);
+
+/**
+ * @brief Set the output of the captured packets.
+ *
+ * This replaces the backend selected in Kconfig. It has to be called
+ * before enabling the capture of an interface.
+ *
+ * @param backend Backend
+ */
+void net_capture_set_backend(const struct net_capture_backend *backend);
+
+/**
+ * @brief Write out the packets captured so far.
+ *
+ * The capture thread does this periodically, see
+ * CONFIG_NET_CAPTURE_FLUSH_PERIOD.
+ */
+void net_capture_flush(void);
+
+/** @cond INTERNAL_HIDDEN */
+
+void net_capture_buf(struct net_if *iface, struct net_buf *buf, size_t len,
+		     enum net_capture_dir dir);
+
+/** @endcond */
+
+/**
+ * @brief Capture a packet, called by the network stack.
+ *
+ * @param iface Network interface
+ * @param pkt Packet, starting with the link layer header
+ * @param dir Direction of the packet
+ */
+static inline void net_capture_pkt(struct net_if *iface, struct net_pkt *pkt,
+				   enum net_capture_dir dir)
+{
+	if (net_capture_is_enabled(iface)) {
+		net_capture_buf(iface, pkt->buffer, net_pkt_get_len(pkt), dir);
+	}
+}
+
+/**
+ * @brief Capture a frame held by a single fragment, called by the link
+ * layers sending a packet over several frames.
+ *
+ * @param iface Network interface
+ * @param frag Fragment holding the frame
+ * @param dir Direction of the frame
+ */
+static inline void net_capture_frag(struct net_if *iface,
+				    struct net_buf *frag,
+				    enum net_capture_dir dir)
+{
+	if (net_capture_is_enabled(iface)) {
+		net_capture_buf(iface, frag, frag->len, dir);
+	}
+}
+
+#else
+
+static inline int net_capture_filter_compile(const char *expr,
+					     struct net_capture_filter *filter)
+{
+	ARG_UNUSED(expr);
+	ARG_UNUSED(filter);
+
+	return -ENOTSUP;
+}
+
+static inline int net_capture_enable(struct net_if *iface,
+				     const struct net_capture_filter *filter)
+{
+	ARG_UNUSED(iface);
+	ARG_UNUSED(filter);
+
+	return -ENOTSUP;
+}
+
+static inline int net_capture_disable(struct net_if *iface)
+{
+	ARG_UNUSED(iface);
+
+	return -ENOTSUP;
+}
+
+static inline bool net_capture_is_enabled(struct net_if *iface)
+{
+	ARG_UNUSED(iface);
+
+	return false;
+}
+
+#define net_capture_pkt(...)
+#define net_capture_frag(...)
+
+#endif /* CONFIG_NET_CAPTURE */
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_CAPTURE_H_ */
@@ -196,6 +196,25 @@ struct coap_observer {
 	u8_t tkl;
 };
 
+/** @cond INTERNAL_HIDDEN */
+
+#if defined(CONFIG_COAP_OPTION_INDEX_SIZE)
+#define COAP_OPTION_INDEX_SIZE CONFIG_COAP_OPTION_INDEX_SIZE
+#else
+#define COAP_OPTION_INDEX_SIZE 0
+#endif
+
+/**
+ * @brief Location of an option in a CoAP packet.
+ */
+struct coap_option_ref {
+	u16_t num; /* Option number */
+	u16_t offset; /* Offset of the option value in the packet */
+	u16_t len; /* Length of the option value */
+};
+
+/** @endcond */
+
 /**
  * @brief Representation of a CoAP Packet.
  */
@@ -206,6 +225,12 @@ struct coap_packet {
 	u8_t hdr_len; /* CoAP header length */
 	u16_t opt_len; /* Total options length (delta + len + value) */
 	u16_t delta; /* Used for delta calculation in CoAP packet */
+#if COAP_OPTION_INDEX_SIZE > 0
+	/* Options of the packet, in the order they appear in it */
+	struct coap_option_ref opt_index[COAP_OPTION_INDEX_SIZE];
+	u8_t opt_count; /* Number of options in the index */
+	bool opt_indexed; /* Are all the options of the packet indexed */
+#endif
 };
 
 struct coap_option {
@@ -466,6 +491,80 @@ int coap_handle_request(struct coap_packet *cpkt,
 			u8_t opt_num,
 			struct sockaddr *addr, socklen_t addr_len);
 
+/**
+ * @brief Node of a CoAP resource router.
+ *
+ * There is a node for each distinct path prefix of the resources. The
+ * children of a node are stored next to each other and sorted, so
+ * that the path segments of a request are found by binary search.
+ */
+struct coap_router_node {
+	/** Path of a resource having the prefix of this node */
+	const char * const *path;
+	/** Resource whose path ends at this node, if any */
+	struct coap_resource *resource;
+	/** Index of the first child node */
+	u16_t first_child;
+	/** Number of child nodes */
+	u16_t child_count;
+	/** Length of the last path segment of this node */
+	u16_t len;
+	/** Number of path segments of this node, 0 for the root */
+	u8_t depth;
+};
+
+/**
+ * @brief Prefix tree of the paths of a set of CoAP resources.
+ */
+struct coap_router {
+	/** Nodes of the tree, the first one is the root */
+	struct coap_router_node *nodes;
+	/** Number of nodes in use */
+	u16_t node_count;
+};
+
+/**
+ * @brief Build a router for a set of resources.
+ *
+ * The resources and their paths must not change while the router is
+ * in use.
+ *
+ * @param router Router to initialize
+ * @param resources Array of known resources, terminated by a resource
+ * with a NULL path
+ * @param nodes Array of nodes for the router. At most one more than the
+ * total number of path segments of the resources is needed.
+ * @param max_nodes Number of elements in the nodes array
+ *
+ * @return 0 in case of success, -ENOMEM if there are not enough nodes,
+ * -EINVAL if the arguments are invalid.
+ */
+int coap_router_init(struct coap_router *router,
+		     struct coap_resource *resources,
+		     struct coap_router_node *nodes, u16_t max_nodes);
+
+/**
+ * @brief When a request is received, call the appropriate method of
+ * the resource found by a router.
+ *
+ * This behaves as coap_handle_request(), but finds the resource in time
+ * that does not depend on the number of resources.
+ *
+ * @param router Router of the known resources
+ * @param cpkt Packet received
+ * @param options Parsed options from coap_packet_parse()
+ * @param opt_num Number of options
+ * @param addr Peer address
+ * @param addr_len Peer address length
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int coap_router_handle_request(struct coap_router *router,
+			       struct coap_packet *cpkt,
+			       struct coap_option *options,
+			       u8_t opt_num,
+			       struct sockaddr *addr, socklen_t addr_len);
+
 /**
  * Represents the size of each block that will be transferred using
  * block-wise transfers [RFC7959]:
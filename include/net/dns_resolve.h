@@ -157,6 +157,40 @@ typedef void (*dns_resolve_cb_t)(enum dns_resolve_status status,
 				 struct dns_addrinfo *info,
 				 void *user_data);
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/**
+ * Cached answer to a DNS query.
+ */
+struct dns_cache_entry {
+	/** Queried name, empty if the entry is not in use */
+	char name[CONFIG_DNS_RESOLVER_CACHE_NAME_LEN + 1];
+
+	/** Resolved addresses */
+	union {
+		struct in_addr in_addr;
+		struct in6_addr in6_addr;
+	} addr[CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS];
+
+	/** Uptime in milliseconds when the entry expires */
+	u32_t expiry;
+
+	/** Uptime in milliseconds when the entry was last used */
+	u32_t last_used;
+
+	/** Query type */
+	enum dns_query_type type;
+
+	/** Number of resolved addresses, 0 if the name did not resolve */
+	u8_t count;
+};
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
+/**
+ * DNS id given to the caller of dns_resolve_name() when the answer was
+ * found from the cache. Pending queries never get this id.
+ */
+#define DNS_RESOLVE_ID_CACHED 0
+
 /**
  * DNS resolve context structure.
  */
@@ -208,8 +242,29 @@ struct dns_resolve_context {
 
 		/** DNS id of this query */
 		u16_t id;
+
+		/** DNS id of the message whose answer this query waits for.
+		 * Differs from the id if an identical query was already
+		 * pending when this one was made.
+		 */
+		u16_t msg_id;
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+		/** Copy of the query string, empty if it is too long to be
+		 * cached.
+		 */
+		char name[CONFIG_DNS_RESOLVER_CACHE_NAME_LEN + 1];
+#endif
 	} queries[CONFIG_DNS_NUM_CONCUR_QUERIES];
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	/** Answers received by this context */
+	struct dns_cache_entry cache[CONFIG_DNS_RESOLVER_CACHE_ENTRIES];
+
+	/** Protects the cache */
+	struct k_mutex cache_lock;
+#endif
+
 	/** Is this context in use */
 	bool is_used;
 };
@@ -286,7 +341,9 @@ int dns_resolve_cancel(struct dns_resolve_context *ctx,
  * @param type What kind of data the caller wants to get.
  * @param dns_id DNS id is returned to the caller. This is needed if one
  * wishes to cancel the query. This can be set to NULL if there is no need
- * to cancel the query.
+ * to cancel the query. If the answer is found from the cache, the callback
+ * has already been called when this function returns and the id is
+ * DNS_RESOLVE_ID_CACHED, there is then nothing to cancel.
  * @param cb Callback to call after the resolving has finished or timeout
  * has happened.
  * @param user_data The user data.
@@ -374,6 +431,37 @@ static inline int dns_cancel_addr_info(u16_t dns_id)
 	return dns_resolve_cancel(dns_resolve_get_default(), dns_id);
 }
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/**
+ * @typedef dns_cache_cb_t
+ * @brief Callback used while iterating over the DNS cache.
+ *
+ * @param entry Cache entry
+ * @param user_data A valid pointer on some user data or NULL
+ */
+typedef void (*dns_cache_cb_t)(struct dns_cache_entry *entry,
+			       void *user_data);
+
+/**
+ * @brief Go through all the valid entries of the DNS cache of a context.
+ *
+ * @param ctx DNS context
+ * @param cb Callback to call for each entry.
+ * @param user_data User specified data or NULL.
+ *
+ * @return Number of entries.
+ */
+int dns_resolve_cache_foreach(struct dns_resolve_context *ctx,
+			      dns_cache_cb_t cb, void *user_data);
+
+/**
+ * @brief Remove all the entries from the DNS cache of a context.
+ *
+ * @param ctx DNS context
+ */
+void dns_resolve_cache_flush(struct dns_resolve_context *ctx);
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
 /**
  * @}
  */
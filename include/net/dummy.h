@@ -31,6 +31,13 @@ struct dummy_api {
 
 	/** Send a network packet */
 	int (*send)(struct device *dev, struct net_pkt *pkt);
+
+	/** Optionally send several network packets at once, in order.
+	 * Returns the number of packets sent from the start of the array.
+	 * The packets not sent are then given to send() one by one.
+	 */
+	int (*send_burst)(struct device *dev, struct net_pkt **pkts,
+			  int count);
 };
 
 #ifdef __cplusplus
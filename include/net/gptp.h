@@ -332,6 +332,76 @@ void gptp_clk_src_time_invoke(struct gptp_clk_src_time_invoke_params *arg);
  */
 struct gptp_hdr *gptp_get_hdr(struct net_pkt *pkt);
 
+/**
+ * @brief State of the clock servo.
+ */
+enum gptp_servo_state {
+	/** Measuring the frequency offset from the grandmaster. */
+	GPTP_SERVO_UNLOCKED,
+
+	/** The clock was just set to the grandmaster time. */
+	GPTP_SERVO_JUMP,
+
+	/** The clock frequency is controlled to track the grandmaster. */
+	GPTP_SERVO_LOCKED,
+};
+
+/**
+ * @brief Statistics of the clock servo.
+ */
+struct gptp_servo_stats {
+	/** Current state. */
+	enum gptp_servo_state state;
+
+	/** Offset of the local clock from the grandmaster at the last Sync,
+	 *  in nanoseconds.
+	 */
+	s64_t offset;
+
+	/** Root mean square of the offset over the last
+	 *  GPTP_SERVO_STATS_WINDOW Sync messages, in nanoseconds. This is
+	 *  the achieved accuracy.
+	 */
+	u32_t offset_rms;
+
+	/** Max absolute offset over the same Sync messages, in
+	 *  nanoseconds.
+	 */
+	u32_t offset_max;
+
+	/** Mean propagation delay of the link to the neighbor, in
+	 *  nanoseconds.
+	 */
+	u32_t path_delay;
+
+	/** Frequency adjustment of the local clock, in parts per billion. */
+	s32_t freq;
+
+	/** Number of Sync messages processed since the servo was reset. */
+	u32_t samples;
+};
+
+/** Number of Sync messages the offset statistics are computed over. */
+#define GPTP_SERVO_STATS_WINDOW 16
+
+/**
+ * @brief Get the statistics of the clock servo.
+ *
+ * @param stats Where to store the statistics.
+ *
+ * @return 0 if ok, -ENOTSUP if CONFIG_NET_GPTP_SERVO_PI is not set.
+ */
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+int gptp_servo_get_stats(struct gptp_servo_stats *stats);
+#else
+static inline int gptp_servo_get_stats(struct gptp_servo_stats *stats)
+{
+	ARG_UNUSED(stats);
+
+	return -ENOTSUP;
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
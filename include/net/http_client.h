@@ -0,0 +1,226 @@
+/** @file
+ * @brief HTTP client API
+ *
+ * An API for applications to send HTTP/1.1 requests over a connected
+ * socket and to receive the responses as a stream.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_HTTP_CLIENT_H_
+#define ZEPHYR_INCLUDE_NET_HTTP_CLIENT_H_
+
+/**
+ * @brief HTTP client API
+ * @defgroup http_client HTTP client API
+ * @ingroup networking
+ * @{
+ */
+
+#include <stdbool.h>
+#include <zephyr/types.h>
+#include <net/http_parser.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct http_request;
+struct http_client_conn;
+
+/**
+ * @typedef http_response_cb_t
+ * @brief Callback used when the headers of a response have been received.
+ *
+ * @param conn Connection the response was received on.
+ * @param req Request the response answers.
+ * @param status HTTP status code of the response.
+ */
+typedef void (*http_response_cb_t)(struct http_client_conn *conn,
+				   struct http_request *req, u16_t status);
+
+/**
+ * @typedef http_body_cb_t
+ * @brief Callback used when a part of the body of a response has been
+ * received.
+ *
+ * @details The data points to the receive buffer of the connection and
+ * is only valid during the callback. A chunked body is given without the
+ * chunk framing.
+ *
+ * @param conn Connection the response was received on.
+ * @param req Request the response answers.
+ * @param data Part of the body.
+ * @param len Length of the part.
+ * @param final True if the response is complete, data may then be NULL.
+ */
+typedef void (*http_body_cb_t)(struct http_client_conn *conn,
+			       struct http_request *req,
+			       const u8_t *data, size_t len, bool final);
+
+/**
+ * @typedef http_payload_cb_t
+ * @brief Callback used to get the payload of a request sent in chunks.
+ *
+ * @param conn Connection the request is sent on.
+ * @param req Request being sent.
+ * @param data Set to the next part of the payload.
+ *
+ * @return Length of the part, 0 at the end of the payload or a negative
+ * error code.
+ */
+typedef int (*http_payload_cb_t)(struct http_client_conn *conn,
+				 struct http_request *req, const u8_t **data);
+
+/** HTTP request */
+struct http_request {
+	/** HTTP method */
+	enum http_method method;
+
+	/** Path and query of the requested resource */
+	const char *url;
+
+	/** Value of the Host header */
+	const char *host;
+
+	/** Additional header lines, each ending with CRLF, or NULL */
+	const char *headers;
+
+	/** Value of the Content-Type header, or NULL */
+	const char *content_type;
+
+	/** Payload sent with a Content-Length header */
+	const u8_t *payload;
+
+	/** Length of the payload */
+	size_t payload_len;
+
+	/** If set, the payload is sent in chunks returned by this callback */
+	http_payload_cb_t payload_cb;
+
+	/** Called when the headers of the response have been received */
+	http_response_cb_t response_cb;
+
+	/** Called for the body of the response */
+	http_body_cb_t body_cb;
+
+	/** User data available in the callbacks */
+	void *user_data;
+
+	/** HTTP status code of the response, set by the client */
+	u16_t status;
+};
+
+/** HTTP client connection */
+struct http_client_conn {
+	/** Connected socket */
+	int sock;
+
+	/** Buffer the responses are received in */
+	u8_t *buf;
+
+	/** Size of the buffer */
+	size_t buf_len;
+
+	/** Response parser */
+	struct http_parser parser;
+
+	/** Requests sent and waiting for their response, oldest first */
+	struct http_request *pending[CONFIG_HTTP_CLIENT_MAX_PIPELINE];
+
+	/** Number of requests waiting for their response */
+	u8_t pending_count;
+
+	/** Index of the oldest request waiting for its response */
+	u8_t pending_head;
+
+	/** Set once the server announced it closes the connection */
+	bool closing;
+};
+
+/**
+ * @brief Initialize a client connection.
+ *
+ * @details The connection can be used for any number of requests, as long
+ * as the server keeps it open.
+ *
+ * @param conn Connection to initialize.
+ * @param sock Socket connected to the server, TLS sockets can be used.
+ * @param buf Buffer used to receive the responses.
+ * @param buf_len Size of the buffer.
+ */
+void http_client_init(struct http_client_conn *conn, int sock,
+		      u8_t *buf, size_t buf_len);
+
+/**
+ * @brief Send a request without waiting for the response.
+ *
+ * @details Up to CONFIG_HTTP_CLIENT_MAX_PIPELINE requests can
+ * be pipelined, their responses are handled by
+ * http_client_process() in the order of the requests. The request
+ * must stay valid until its response is complete.
+ *
+ * @param conn Connection to send the request on.
+ * @param req Request to send.
+ *
+ * @return 0 if the request was sent, -EAGAIN if too many requests are
+ * pending, -ENOTCONN if the server closes the connection or another
+ * negative error code.
+ */
+int http_client_send(struct http_client_conn *conn, struct http_request *req);
+
+/**
+ * @brief Receive and handle the responses to the pending requests.
+ *
+ * @details Waits for data from the server, at most for the timeout, and
+ * passes what is received to the callbacks of the requests.
+ *
+ * @param conn Connection to receive on.
+ * @param timeout Timeout in milliseconds, K_FOREVER to wait forever.
+ *
+ * @return Number of responses completed, -EAGAIN on timeout, -ENOTCONN
+ * if the connection was closed with responses pending or another negative
+ * error code.
+ */
+int http_client_process(struct http_client_conn *conn, s32_t timeout);
+
+/**
+ * @brief Send a request and wait for its response.
+ *
+ * @details The responses to previously pipelined requests are handled
+ * first.
+ *
+ * @param conn Connection to send the request on.
+ * @param req Request to send.
+ * @param timeout Timeout in milliseconds for each part of the response.
+ *
+ * @return HTTP status code of the response or a negative error code.
+ */
+int http_client_request(struct http_client_conn *conn,
+			struct http_request *req, s32_t timeout);
+
+/**
+ * @brief Check whether the connection can be used for new requests.
+ *
+ * @param conn Connection to check.
+ *
+ * @return True if the server did not announce it closes the connection.
+ */
+static inline bool http_client_is_reusable(struct http_client_conn *conn)
+{
+	return !conn->closing;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_HTTP_CLIENT_H_ */
@@ -0,0 +1,260 @@
+/** @file
+ * @brief HTTP server API
+ *
+ * An API for applications to serve resources over HTTP/1.1.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_HTTP_SERVER_H_
+#define ZEPHYR_INCLUDE_NET_HTTP_SERVER_H_
+
+/**
+ * @brief HTTP server API
+ * @defgroup http_server HTTP server API
+ * @ingroup networking
+ * @{
+ */
+
+#include <stdbool.h>
+#include <zephyr/types.h>
+#include <net/socket.h>
+#include <net/http_parser.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct http_server_conn;
+
+/** Events of a request given to the resource serving it */
+enum http_server_event {
+	/** The request line and the headers have been received */
+	HTTP_SERVER_REQUEST,
+	/** A part of the request body has been received */
+	HTTP_SERVER_BODY,
+	/** The request is complete, the response must be sent */
+	HTTP_SERVER_COMPLETE,
+	/** The connection was closed before the request was complete */
+	HTTP_SERVER_ABORT,
+};
+
+/**
+ * @typedef http_server_cb_t
+ * @brief Callback serving the requests of a resource.
+ *
+ * @details The body data points to the receive buffer of the connection
+ * and is only valid during the callback. A chunked body is given without
+ * the chunk framing. The response can be sent at any event, at the latest
+ * on HTTP_SERVER_COMPLETE. If no response was sent then, the server
+ * answers with status 500.
+ *
+ * @param conn Connection the request was received on.
+ * @param evt Event of the request.
+ * @param data Part of the body for HTTP_SERVER_BODY, NULL otherwise.
+ * @param len Length of the part.
+ *
+ * @return 0 to continue, a negative value to close the connection.
+ */
+typedef int (*http_server_cb_t)(struct http_server_conn *conn,
+				enum http_server_event evt,
+				const u8_t *data, size_t len);
+
+/** Resource served by the HTTP server */
+struct http_server_resource {
+	/** Path of the resource */
+	const char *path;
+
+	/** Callback serving the requests */
+	http_server_cb_t cb;
+
+	/** Whether the paths starting with the path are served as well */
+	bool prefix;
+
+	/** User data of the resource */
+	void *user_data;
+};
+
+/** Connection of a client to the HTTP server */
+struct http_server_conn {
+	/** Socket of the connection, -1 if the slot is unused */
+	int sock;
+
+	/** Request parser */
+	struct http_parser parser;
+
+	/** Resource serving the current request, NULL if none */
+	const struct http_server_resource *resource;
+
+	/** Path and query of the current request */
+	char url[CONFIG_HTTP_SERVER_MAX_URL_LEN];
+
+	/** Length of the URL */
+	u16_t url_len;
+
+	/** Method of the current request */
+	enum http_method method;
+
+	/** Per request data of the resource, cleared for every request */
+	void *user_data;
+
+	/** Uptime of the last activity on the connection */
+	s64_t last_activity;
+
+	/** Whether the response to the current request was started */
+	bool responding : 1;
+
+	/** Whether the response is sent in chunks */
+	bool chunked : 1;
+
+	/** Whether the connection is closed after the response */
+	bool closing : 1;
+
+	/** Buffer the requests are received in */
+	u8_t buf[CONFIG_HTTP_SERVER_RECV_BUF_SIZE];
+};
+
+/** HTTP server */
+struct http_server {
+	/** Listening socket */
+	int sock;
+
+	/** Resources served */
+	const struct http_server_resource *resources;
+
+	/** Number of resources */
+	size_t resource_count;
+
+	/** Connections of clients */
+	struct http_server_conn conns[CONFIG_HTTP_SERVER_MAX_CONNECTIONS];
+
+	/** Set to stop http_server_run() */
+	bool stop;
+};
+
+/**
+ * @brief Start listening for HTTP connections.
+ *
+ * @param server Server to initialize.
+ * @param addr Address to listen on.
+ * @param addrlen Length of the address.
+ * @param resources Resources to serve, they must stay valid.
+ * @param resource_count Number of resources.
+ *
+ * @return 0 on success, a negative error code otherwise.
+ */
+int http_server_init(struct http_server *server, const struct sockaddr *addr,
+		     socklen_t addrlen,
+		     const struct http_server_resource *resources,
+		     size_t resource_count);
+
+/**
+ * @brief Accept connections and serve the requests that arrive within a
+ * timeout.
+ *
+ * @param server Server to run.
+ * @param timeout Time to wait for activity, in milliseconds.
+ *
+ * @return 0 on success or timeout, a negative error code otherwise.
+ */
+int http_server_poll(struct http_server *server, s32_t timeout);
+
+/**
+ * @brief Serve requests until http_server_stop() is called, then close
+ * all the connections.
+ *
+ * @param server Server to run.
+ *
+ * @return 0 once stopped, a negative error code otherwise.
+ */
+int http_server_run(struct http_server *server);
+
+/**
+ * @brief Stop a server running in another thread.
+ *
+ * @details The server stops within a second.
+ *
+ * @param server Server to stop.
+ */
+static inline void http_server_stop(struct http_server *server)
+{
+	server->stop = true;
+}
+
+/**
+ * @brief Get the resource serving a request.
+ *
+ * @param conn Connection of the request.
+ *
+ * @return Resource serving the request.
+ */
+static inline const struct http_server_resource *
+http_server_resource(struct http_server_conn *conn)
+{
+	return conn->resource;
+}
+
+/**
+ * @brief Send a complete response.
+ *
+ * @param conn Connection of the request.
+ * @param status HTTP status code.
+ * @param content_type Value of the Content-Type header, or NULL.
+ * @param body Body of the response.
+ * @param len Length of the body.
+ *
+ * @return 0 on success, a negative error code otherwise.
+ */
+int http_server_respond(struct http_server_conn *conn, u16_t status,
+			const char *content_type, const u8_t *body,
+			size_t len);
+
+/**
+ * @brief Start a response whose body is sent in parts.
+ *
+ * @details The body is sent in chunks to HTTP/1.1 clients. HTTP/1.0
+ * clients get a body ending with the connection.
+ *
+ * @param conn Connection of the request.
+ * @param status HTTP status code.
+ * @param content_type Value of the Content-Type header, or NULL.
+ *
+ * @return 0 on success, a negative error code otherwise.
+ */
+int http_server_respond_begin(struct http_server_conn *conn, u16_t status,
+			      const char *content_type);
+
+/**
+ * @brief Send a part of the body of a response.
+ *
+ * @param conn Connection of the request.
+ * @param data Part of the body.
+ * @param len Length of the part, 0 is ignored.
+ *
+ * @return 0 on success, a negative error code otherwise.
+ */
+int http_server_respond_write(struct http_server_conn *conn,
+			      const u8_t *data, size_t len);
+
+/**
+ * @brief End a response whose body was sent in parts.
+ *
+ * @param conn Connection of the request.
+ *
+ * @return 0 on success, a negative error code otherwise.
+ */
+int http_server_respond_end(struct http_server_conn *conn);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_HTTP_SERVER_H_ */
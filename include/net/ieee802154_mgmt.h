@@ -56,6 +56,9 @@ enum net_request_ieee802154_cmd {
 	NET_REQUEST_IEEE802154_CMD_SET_TX_POWER,
 	NET_REQUEST_IEEE802154_CMD_SET_SECURITY_SETTINGS,
 	NET_REQUEST_IEEE802154_CMD_GET_SECURITY_SETTINGS,
+	NET_REQUEST_IEEE802154_CMD_TSCH_START,
+	NET_REQUEST_IEEE802154_CMD_TSCH_ADD_CELL,
+	NET_REQUEST_IEEE802154_CMD_TSCH_DEL_CELL,
 };
 
 
@@ -162,6 +165,25 @@ NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_IEEE802154_GET_SECURITY_SETTINGS);
 
 #endif /* CONFIG_NET_L2_IEEE802154_SECURITY */
 
+#ifdef CONFIG_NET_L2_IEEE802154_RADIO_TSCH
+
+#define NET_REQUEST_IEEE802154_TSCH_START				\
+	(_NET_IEEE802154_BASE | NET_REQUEST_IEEE802154_CMD_TSCH_START)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_IEEE802154_TSCH_START);
+
+#define NET_REQUEST_IEEE802154_TSCH_ADD_CELL				\
+	(_NET_IEEE802154_BASE | NET_REQUEST_IEEE802154_CMD_TSCH_ADD_CELL)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_IEEE802154_TSCH_ADD_CELL);
+
+#define NET_REQUEST_IEEE802154_TSCH_DEL_CELL				\
+	(_NET_IEEE802154_BASE | NET_REQUEST_IEEE802154_CMD_TSCH_DEL_CELL)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_IEEE802154_TSCH_DEL_CELL);
+
+#endif /* CONFIG_NET_L2_IEEE802154_RADIO_TSCH */
+
 enum net_event_ieee802154_cmd {
 	NET_EVENT_IEEE802154_CMD_SCAN_RESULT = 1,
 };
@@ -222,6 +244,36 @@ struct ieee802154_security_params {
 	u8_t _unused	: 3;
 };
 
+/**
+ * @brief TSCH cell options
+ */
+enum ieee802154_tsch_cell_option {
+	/** Frames can be sent in the cell */
+	IEEE802154_TSCH_CELL_TX		= BIT(0),
+	/** The radio listens in the cell */
+	IEEE802154_TSCH_CELL_RX		= BIT(1),
+	/** The cell is shared with other senders, which contend for it */
+	IEEE802154_TSCH_CELL_SHARED	= BIT(2),
+};
+
+/**
+ * @brief TSCH cell
+ *
+ * Used to add or remove a cell of the TSCH schedule
+ */
+struct ieee802154_tsch_cell {
+	/** Link address of the neighbor, all zeros for any neighbor */
+	u8_t addr[IEEE802154_MAX_ADDR_LENGTH];
+
+	/** Timeslot of the cell in the slotframe */
+	u16_t slot_offset;
+	/** Offset added to the ASN to pick the channel of the cell */
+	u16_t channel_offset;
+
+	/** Options of the cell, see enum ieee802154_tsch_cell_option */
+	u8_t options;
+};
+
 #ifdef __cplusplus
 }
 #endif
@@ -770,6 +770,71 @@ int lwm2m_engine_set_res_data(char *pathstr, void *data_ptr, u16_t data_len,
 int lwm2m_engine_get_res_data(char *pathstr, void **data_ptr, u16_t *data_len,
 			      u8_t *data_flags);
 
+struct lwm2m_engine_obj_inst;
+struct lwm2m_engine_obj_field;
+struct lwm2m_engine_res_inst;
+
+/**
+ * @brief Resolved LwM2M resource path
+ *
+ * A path handle refers to a resource without the path string having to be
+ * parsed and the resource looked up each time it is accessed. The
+ * handle stays usable when object instances are created and deleted, the
+ * resource is then looked up again on the next access.
+ *
+ * The members are private to the LwM2M engine.
+ */
+struct lwm2m_path_handle {
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_engine_obj_field *obj_field;
+	struct lwm2m_engine_res_inst *res;
+	u32_t generation;
+	u16_t obj_id;
+	u16_t obj_inst_id;
+	u16_t res_id;
+};
+
+/**
+ * @brief Initialize a path handle
+ *
+ * @param[in] pathstr LwM2M resource path string
+ *            (obj/obj-instance/resource)
+ * @param[out] handle Path handle to initialize
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_path_handle_init(char *pathstr,
+				  struct lwm2m_path_handle *handle);
+
+/**
+ * @brief Set resource value using a path handle
+ *
+ * This behaves as the lwm2m_engine_set_*() functions. The value must be
+ * of the type of the resource, for instance a u32_t for a U32 resource.
+ *
+ * @param[in] handle Path handle of the resource
+ * @param[in] value Pointer to the value
+ * @param[in] len Length of the value
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_set_by_handle(struct lwm2m_path_handle *handle,
+			       void *value, u16_t len);
+
+/**
+ * @brief Get resource value using a path handle
+ *
+ * This behaves as the lwm2m_engine_get_*() functions.
+ *
+ * @param[in] handle Path handle of the resource
+ * @param[out] buf Buffer to copy data into
+ * @param[in] buflen Length of buffer
+ *
+ * @return 0 for success or negative in case of error.
+ */
+int lwm2m_engine_get_by_handle(struct lwm2m_path_handle *handle,
+			       void *buf, u16_t buflen);
+
 /**
  * @brief Start the LwM2M engine
  *
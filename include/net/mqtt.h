@@ -402,6 +402,18 @@ struct mqtt_transport {
 	};
 };
 
+/** @brief QoS 1 or QoS 2 message published and not acknowledged yet. */
+struct mqtt_inflight {
+	/** Message published. Its topic and payload are not copied. */
+	struct mqtt_publish_param param;
+
+	/** Wall clock value (in milliseconds) of the last transmission. */
+	u32_t timestamp;
+
+	/** Type of the packet awaited from the broker, 0 if unused. */
+	u8_t awaiting;
+};
+
 /** @brief MQTT internal state. */
 struct mqtt_internal {
 	/** Internal. Mutex to protect access to the client instance. */
@@ -420,6 +432,11 @@ struct mqtt_internal {
 
 	/** Internal. Remaining payload length to read. */
 	u32_t remaining_payload;
+
+#if defined(CONFIG_MQTT_INFLIGHT)
+	/** Internal. Messages waiting for their acknowledgment. */
+	struct mqtt_inflight inflight[CONFIG_MQTT_INFLIGHT_WINDOW];
+#endif /* CONFIG_MQTT_INFLIGHT */
 };
 
 /**
@@ -530,11 +547,41 @@ int mqtt_connect(struct mqtt_client *client);
  * @param[in] param Parameters to be used for the publish message.
  *                  Shall not be NULL.
  *
+ * @note With CONFIG_MQTT_INFLIGHT, the topic and payload of a QoS 1 or
+ *       QoS 2 message shall stay valid until the message is acknowledged
+ *       with @ref MQTT_EVT_PUBACK or @ref MQTT_EVT_PUBCOMP. Publishing
+ *       fails with -EAGAIN while the in-flight window is full.
+ *
  * @return 0 or a negative error code (errno.h) indicating reason of failure.
  */
 int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param);
 
+/**
+ * @brief API to publish several messages at once.
+ *
+ * The messages are packed together in the transmit buffer, so that they
+ * are sent with as few transport writes as possible. A payload which
+ * does not fit in the transmit buffer is sent directly from the memory
+ * of the caller.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ * @param[in] params Array of parameters of the publish messages.
+ *                   Shall not be NULL.
+ * @param[in] count Number of messages in the array.
+ *
+ * @note With CONFIG_MQTT_INFLIGHT, the topic and payload of a QoS 1 or
+ *       QoS 2 message shall stay valid until the message is acknowledged
+ *       with @ref MQTT_EVT_PUBACK or @ref MQTT_EVT_PUBCOMP.
+ *
+ * @return Number of messages published, less than count if the in-flight
+ *         window got full, or a negative error code (errno.h) indicating
+ *         reason of failure. -EAGAIN if the in-flight window is full.
+ */
+int mqtt_publish_batch(struct mqtt_client *client,
+		       const struct mqtt_publish_param *params, size_t count);
+
 /**
  * @brief API used by client to send acknowledgment on receiving QoS1 publish
  *        message. Should be called on reception of @ref MQTT_EVT_PUBLISH with
@@ -26,6 +26,7 @@
 #include <net/net_ip.h>
 #include <net/net_if.h>
 #include <net/net_stats.h>
+#include <net/net_pkt_quota.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -105,6 +106,22 @@ typedef void (*net_context_send_cb_t)(struct net_context *context,
 				      int status,
 				      void *user_data);
 
+/**
+ * @typedef net_context_writable_cb_t
+ * @brief Network context writable callback.
+ *
+ * @details The writable callback is called when a context, on which
+ * sending may have failed with -EAGAIN, can accept data again. For TCP
+ * this happens when the peer acknowledges queued data, and with
+ * CONFIG_NET_PKT_QUOTA when the packets charged to a full send quota are
+ * freed. The callback can be called from the RX thread with the context
+ * locked, or from the thread or interrupt freeing a packet, so it must
+ * not block nor send data itself.
+ *
+ * @param context The context that can send again.
+ */
+typedef void (*net_context_writable_cb_t)(struct net_context *context);
+
 /**
  * @typedef net_tcp_accept_cb_t
  * @brief Accept callback
@@ -234,6 +251,11 @@ struct net_context {
 	 */
 	net_context_connect_cb_t connect_cb;
 
+	/** Writable callback to be called when the context can accept
+	 * data again after sending was refused.
+	 */
+	net_context_writable_cb_t writable_cb;
+
 #if defined(CONFIG_NET_CONTEXT_NET_PKT_POOL)
 	/** Get TX net_buf pool for this context.
 	 */
@@ -244,6 +266,18 @@ struct net_context {
 	net_pkt_get_pool_func_t data_pool;
 #endif /* CONFIG_NET_CONTEXT_NET_PKT_POOL */
 
+#if defined(CONFIG_NET_PKT_QUOTA)
+	/** Memory used by the packets sent via this context, and not
+	 * freed yet.
+	 */
+	struct net_pkt_quota tx_quota;
+
+	/** Memory used by the packets received by this context, and not
+	 * read yet.
+	 */
+	struct net_pkt_quota rx_quota;
+#endif /* CONFIG_NET_PKT_QUOTA */
+
 #if defined(CONFIG_NET_TCP)
 	/** TCP connection information */
 	struct net_tcp *tcp;
@@ -263,10 +297,18 @@ struct net_context {
 		struct k_fifo accept_q;
 	};
 
+	/** Raised when the socket can accept data again */
+	struct k_poll_signal tx_signal;
+
 #if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
 	/** TLS context information */
 	struct tls_context *tls;
 #endif /* CONFIG_NET_SOCKETS_SOCKOPT_TLS */
+
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+	/** epoll interest set entries watching this socket */
+	sys_slist_t epoll_items;
+#endif /* CONFIG_NET_SOCKETS_EPOLL */
 #endif /* CONFIG_NET_SOCKETS */
 
 #if defined(CONFIG_NET_OFFLOAD)
@@ -806,7 +848,8 @@ int net_context_accept(struct net_context *context,
  * are K_FOREVER, K_NO_WAIT, >0.
  * @param user_data Caller-supplied user data.
  *
- * @return 0 if ok, < 0 if error
+ * @return 0 if ok, -EAGAIN if the context cannot accept more data for
+ * now, < 0 if other error
  */
 int net_context_send(struct net_context *context,
 		     const void *buf,
@@ -851,6 +894,34 @@ int net_context_sendto(struct net_context *context,
 		       s32_t timeout,
 		       void *user_data);
 
+/**
+ * @brief Check if a network context can accept data to send.
+ *
+ * @details A TCP context stops accepting data when
+ * CONFIG_NET_TCP_SEND_QUEUE_SIZE bytes wait to be acknowledged by the
+ * peer, and any context stops when its send quota is full (see
+ * CONFIG_NET_PKT_QUOTA). net_context_send() then fails with -EAGAIN. The
+ * writable callback tells when to check again.
+ *
+ * @param context The network context to use.
+ *
+ * @return True if data can be sent, false otherwise.
+ */
+bool net_context_is_writable(struct net_context *context);
+
+/**
+ * @brief Set the callback called when a network context can accept data
+ * again.
+ *
+ * @param context The network context to use.
+ * @param cb Caller-supplied callback function, or NULL.
+ */
+static inline void net_context_set_writable_cb(struct net_context *context,
+					       net_context_writable_cb_t cb)
+{
+	context->writable_cb = cb;
+}
+
 /**
  * @brief Receive network data from a peer specified by context.
  *
@@ -918,6 +989,8 @@ int net_context_update_recv_wnd(struct net_context *context,
 enum net_context_option {
 	NET_OPT_PRIORITY	= 1,
 	NET_OPT_TIMESTAMP	= 2,
+	NET_OPT_SNDBUF		= 3,
+	NET_OPT_RCVBUF		= 4,
 };
 
 /**
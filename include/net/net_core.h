@@ -86,6 +86,23 @@ enum net_verdict {
  */
 int net_recv_data(struct net_if *iface, struct net_pkt *pkt);
 
+/**
+ * @brief Called by network device driver when a burst of network packets
+ * has been received. This is the same as calling net_recv_data() for each
+ * packet, but the packets are queued for processing all at once when
+ * CONFIG_NET_RX_BURST_SIZE is larger than 1.
+ *
+ * @param iface Network interface where the packets were received.
+ * @param pkts Network packets, in the order they were received.
+ * @param count Number of packets.
+ *
+ * @return 0 if ok, <0 if error. On error, none of the packets was taken
+ * over. Packets without data are dropped. The content of the pkts array
+ * is changed in any case.
+ */
+int net_recv_data_burst(struct net_if *iface, struct net_pkt **pkts,
+			int count);
+
 /**
  * @brief Send data to network.
  *
@@ -223,6 +240,25 @@ void net_analyze_stack(const char *name, const char *stack, size_t size);
 #define NET_TC_COUNT 1
 #endif /* CONFIG_NET_TC_TX_COUNT && CONFIG_NET_TC_RX_COUNT */
 
+/* Number of Rx threads (flow queues) serving each Rx traffic class */
+#if defined(CONFIG_NET_RX_FLOW_QUEUES)
+#define NET_RX_FLOW_QUEUE_COUNT CONFIG_NET_RX_FLOW_QUEUES
+#else
+#define NET_RX_FLOW_QUEUE_COUNT 1
+#endif
+
+/* Number of bands of the strict priority queueing discipline */
+#define NET_QDISC_PRIO_BANDS 3
+
+/* Max number of packets handled at once by the Tx and Rx threads */
+#if defined(CONFIG_NET_TX_BURST_SIZE) && defined(CONFIG_NET_RX_BURST_SIZE)
+#define NET_TX_BURST_SIZE CONFIG_NET_TX_BURST_SIZE
+#define NET_RX_BURST_SIZE CONFIG_NET_RX_BURST_SIZE
+#else
+#define NET_TX_BURST_SIZE 1
+#define NET_RX_BURST_SIZE 1
+#endif
+
 /* @endcond */
 
 /**
@@ -28,6 +28,7 @@
 #include <net/net_ip.h>
 #include <net/net_l2.h>
 #include <net/net_stats.h>
+#include <net/net_pkt_quota.h>
 #include <net/net_timeout.h>
 
 #if defined(CONFIG_NET_DHCPV4)
@@ -187,6 +188,14 @@ enum net_if_flag {
 	 */
 	NET_IF_NO_AUTO_START,
 
+	/** The packets of the interface are captured */
+	NET_IF_CAPTURE,
+
+	/** The packets sent by the interface go through a queueing
+	 * discipline
+	 */
+	NET_IF_QDISC,
+
 /** @cond INTERNAL_HIDDEN */
 	/* Total number of flags - must be at the end of the enum */
 	NET_IF_NUM_FLAGS
@@ -396,6 +405,14 @@ struct net_traffic_class {
 
 	/** Traffic class value */
 	int tc;
+
+#if NET_TX_BURST_SIZE > 1 || NET_RX_BURST_SIZE > 1
+	/** Packets waiting to be processed in bursts */
+	struct k_fifo fifo;
+
+	/** Work item processing a burst of the waiting packets */
+	struct k_work burst_work;
+#endif
 };
 
 /**
@@ -458,6 +475,11 @@ struct net_if {
 
 	/** Network interface instance configuration */
 	struct net_if_config config;
+
+#if defined(CONFIG_NET_PKT_QUOTA)
+	/** Packet data memory used by this network interface */
+	struct net_pkt_quota mem_quota;
+#endif /* CONFIG_NET_PKT_QUOTA */
 } __net_if_align;
 
 /**
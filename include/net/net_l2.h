@@ -59,6 +59,14 @@ struct net_l2 {
 	 */
 	int (*send)(struct net_if *iface, struct net_pkt *pkt);
 
+	/**
+	 * Optional function sending several packets at once, in order.
+	 * The result for each packet, as it would have been returned by
+	 * send(), is stored in status.
+	 */
+	void (*send_burst)(struct net_if *iface, struct net_pkt **pkts,
+			   int *status, int count);
+
 	/**
 	 * This function is used to enable/disable traffic over a network
 	 * interface. The function returns <0 if error and >=0 if no error.
@@ -119,6 +127,17 @@ NET_L2_DECLARE_PUBLIC(CANBUS_L2);
 		.get_flags = (_get_flags_fn),				\
 	}
 
+#define NET_L2_BURST_INIT(_name, _recv_fn, _send_fn, _send_burst_fn,	\
+			  _enable_fn, _get_flags_fn)			\
+	const struct net_l2 (NET_L2_GET_NAME(_name)) __used		\
+	__attribute__((__section__(".net_l2.init"))) = {		\
+		.recv = (_recv_fn),					\
+		.send = (_send_fn),					\
+		.send_burst = (_send_burst_fn),				\
+		.enable = (_enable_fn),					\
+		.get_flags = (_get_flags_fn),				\
+	}
+
 #define NET_L2_GET_DATA(name, sfx) (__net_l2_data_##name##sfx)
 
 #define NET_L2_DATA_INIT(name, sfx, ctx_type)				\
@@ -69,6 +69,11 @@ struct net_pkt {
 		 * the same memory area.
 		 */
 		intptr_t sock_recv_fifo;
+		/** Link in the list of packets waiting for a Tx or Rx thread,
+		 * used instead of the k_work when packets are handled in
+		 * bursts.
+		 */
+		sys_snode_t burst_node;
 	};
 
 	/** Slab pointer from where it belongs to */
@@ -99,6 +104,22 @@ struct net_pkt {
 	/** Timestamp if available. */
 	struct net_ptp_time timestamp;
 #endif
+
+#if defined(CONFIG_NET_PKT_QUOTA)
+	/* Memory quotas of the network interface and of the network
+	 * context the packet data is charged to, and charged bytes.
+	 */
+	struct net_pkt_quota *iface_quota;
+	struct net_pkt_quota *ctx_quota;
+	u32_t iface_charged;
+	u32_t ctx_charged;
+#endif
+
+#if defined(CONFIG_NET_QDISC)
+	/* Cycle count when queued by the queueing discipline */
+	u32_t qdisc_time;
+#endif
+
 	/** Reference counter */
 	atomic_t atomic_ref;
 
@@ -136,6 +157,12 @@ struct net_pkt {
 				 */
 	u8_t family     : 3;	/* IPv4 vs IPv6 */
 
+	u8_t ip_reassembled : 1; /* Packet was reassembled from IP
+				  * fragments. Used only if
+				  * defined(CONFIG_NET_IPV4_FRAGMENT) or
+				  * defined(CONFIG_NET_IPV6_FRAGMENT)
+				  */
+
 	union {
 		u8_t ipv4_auto_arp_msg : 1; /* Is this pkt IPv4 autoconf ARP
 					     * message. Used only if
@@ -159,7 +186,7 @@ struct net_pkt {
 		u8_t ipv4_ttl;
 	};
 
-#if NET_TC_COUNT > 1
+#if NET_TC_COUNT > 1 || defined(CONFIG_NET_QDISC)
 	/** Network packet priority, can be left out in which case packet
 	 * is not prioritised.
 	 */
@@ -341,6 +368,26 @@ static inline bool net_pkt_forwarding(struct net_pkt *pkt)
 }
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT) || defined(CONFIG_NET_IPV6_FRAGMENT)
+static inline bool net_pkt_ip_reassembled(struct net_pkt *pkt)
+{
+	return pkt->ip_reassembled;
+}
+
+static inline void net_pkt_set_ip_reassembled(struct net_pkt *pkt,
+					      bool reassembled)
+{
+	pkt->ip_reassembled = reassembled;
+}
+#else
+static inline bool net_pkt_ip_reassembled(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return false;
+}
+#endif
+
 #if defined(CONFIG_NET_IPV4)
 static inline u8_t net_pkt_ipv4_ttl(struct net_pkt *pkt)
 {
@@ -568,7 +615,7 @@ static inline void net_pkt_set_ipv6_fragment_id(struct net_pkt *pkt,
 }
 #endif /* CONFIG_NET_IPV6_FRAGMENT */
 
-#if NET_TC_COUNT > 1
+#if NET_TC_COUNT > 1 || defined(CONFIG_NET_QDISC)
 static inline u8_t net_pkt_priority(struct net_pkt *pkt)
 {
 	return pkt->priority;
@@ -579,7 +626,7 @@ static inline void net_pkt_set_priority(struct net_pkt *pkt,
 {
 	pkt->priority = priority;
 }
-#else /* NET_TC_COUNT == 1 */
+#else /* NET_TC_COUNT == 1 && !CONFIG_NET_QDISC */
 static inline u8_t net_pkt_priority(struct net_pkt *pkt)
 {
 	return 0;
@@ -587,7 +634,7 @@ static inline u8_t net_pkt_priority(struct net_pkt *pkt)
 
 #define net_pkt_set_priority(...)
 
-#endif /* NET_TC_COUNT > 1 */
+#endif /* NET_TC_COUNT > 1 || CONFIG_NET_QDISC */
 
 #if defined(CONFIG_NET_VLAN)
 static inline u16_t net_pkt_vlan_tag(struct net_pkt *pkt)
@@ -1120,6 +1167,51 @@ void net_pkt_get_info(struct k_mem_slab **rx,
 		      struct net_buf_pool **rx_data,
 		      struct net_buf_pool **tx_data);
 
+/**
+ * @brief Statistics of a predefined DATA pool.
+ */
+struct net_pkt_pool_stats {
+	/** DATA pool */
+	struct net_buf_pool *pool;
+
+	/** Size of the buffers, 0 if it varies */
+	u16_t data_size;
+
+	/** Highest number of buffers used at the same time */
+	u16_t max_used;
+
+	/** Number of buffers allocated */
+	u32_t allocs;
+
+	/** Number of times the pool was found empty */
+	u32_t empty;
+
+	/** Is this a TX DATA pool */
+	bool tx;
+};
+
+/**
+ * @typedef net_pkt_pool_stats_cb_t
+ * @brief Callback used while iterating over the DATA pool statistics
+ *
+ * @param stats Statistics of a DATA pool
+ * @param user_data A valid pointer to user data or NULL
+ */
+typedef void (*net_pkt_pool_stats_cb_t)(struct net_pkt_pool_stats *stats,
+					void *user_data);
+
+/**
+ * @brief Go through the statistics of the predefined DATA pools, from the
+ * smallest to the biggest buffers when there are several size classes.
+ *
+ * @details The number of free buffers is kept in the pool itself.
+ * Only available if CONFIG_NET_PKT_POOL_STATS is enabled.
+ *
+ * @param cb User supplied callback function to call.
+ * @param user_data User specified data.
+ */
+void net_pkt_pool_stats_foreach(net_pkt_pool_stats_cb_t cb, void *user_data);
+
 /** @cond INTERNAL_HIDDEN */
 
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Network packet memory quotas
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_NET_PKT_QUOTA_H_
+#define ZEPHYR_INCLUDE_NET_NET_PKT_QUOTA_H_
+
+#include <zephyr/types.h>
+#include <kernel.h>
+#include <atomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Network packet memory quotas
+ * @defgroup net_pkt_quota Network Packet Memory Quotas
+ * @ingroup networking
+ * @{
+ */
+
+/**
+ * @brief Memory quota of a network context or of a network interface.
+ *
+ * The data buffers of a packet are charged to the quotas of its network
+ * context and network interface when they are allocated, and released
+ * when the packet is freed.
+ */
+struct net_pkt_quota {
+	/** Bytes of packet data currently charged */
+	atomic_t used;
+
+	/** Maximum bytes of packet data, 0 if there is no limit */
+	u32_t limit;
+
+	/** Highest number of bytes charged at the same time */
+	atomic_t max_used;
+
+	/** Number of allocations refused because of the limit */
+	atomic_t exceeded;
+
+	/** Set when an allocation was refused, until memory is released */
+	atomic_t full;
+
+	/** Given when memory is released, to wake up a waiting sender */
+	struct k_sem released;
+};
+
+/**
+ * @brief Initialize a memory quota.
+ *
+ * @param quota Quota to initialize
+ * @param limit Maximum bytes of packet data, 0 for no limit
+ */
+static inline void net_pkt_quota_init(struct net_pkt_quota *quota,
+				      u32_t limit)
+{
+	atomic_set(&quota->used, 0);
+	quota->limit = limit;
+	atomic_clear(&quota->max_used);
+	atomic_clear(&quota->exceeded);
+	atomic_clear(&quota->full);
+
+	k_sem_init(&quota->released, 0, 1);
+}
+
+/**
+ * @brief Change the limit of a memory quota.
+ *
+ * @details The packets already charged are not affected.
+ *
+ * @param quota Quota
+ * @param limit Maximum bytes of packet data, 0 for no limit
+ */
+static inline void net_pkt_quota_set_limit(struct net_pkt_quota *quota,
+					   u32_t limit)
+{
+	quota->limit = limit;
+
+	/* The limit may have been raised */
+	atomic_clear(&quota->full);
+	k_sem_give(&quota->released);
+}
+
+/**
+ * @brief Get the number of bytes currently charged to a memory quota.
+ *
+ * @param quota Quota
+ *
+ * @return Bytes of packet data
+ */
+static inline u32_t net_pkt_quota_used(struct net_pkt_quota *quota)
+{
+	return (u32_t)atomic_get(&quota->used);
+}
+
+/**
+ * @brief Check if the last allocation charged to a memory quota was
+ * refused, and no memory has been released since.
+ *
+ * @param quota Quota
+ *
+ * @return True if the quota is full, false otherwise
+ */
+static inline bool net_pkt_quota_is_full(struct net_pkt_quota *quota)
+{
+	return atomic_get(&quota->full) != 0;
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_NET_NET_PKT_QUOTA_H_ */
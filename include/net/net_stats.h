@@ -218,6 +218,39 @@ struct net_stats_tc {
 	} recv[NET_TC_RX_COUNT];
 };
 
+/**
+ * @brief Rx flow queue statistics
+ */
+struct net_stats_rx_queue {
+	/** Number of packets dispatched to this flow queue. */
+	net_stats_t pkts;
+
+	/** Number of bytes dispatched to this flow queue. */
+	net_stats_t bytes;
+};
+
+/**
+ * @brief Queueing discipline statistics, per priority band
+ */
+struct net_stats_qdisc {
+	/** Number of packets sent. */
+	net_stats_t pkts;
+
+	/** Number of bytes sent. */
+	net_stats_t bytes;
+
+	/** Number of packets dropped, because the queue was full or
+	 * by CoDel.
+	 */
+	net_stats_t dropped;
+
+	/** Average queue delay of the packets sent, in microseconds. */
+	net_stats_t delay_avg;
+
+	/** Max queue delay of the packets sent, in microseconds. */
+	net_stats_t delay_max;
+};
+
 /**
  * @brief All network statistics in one struct.
  */
@@ -273,6 +306,18 @@ struct net_stats {
 	/** Traffic class statistics */
 	struct net_stats_tc tc;
 #endif
+
+#if NET_RX_FLOW_QUEUE_COUNT > 1
+	/** Rx flow queue statistics */
+	struct net_stats_rx_queue rx_queue[NET_RX_FLOW_QUEUE_COUNT];
+#endif
+
+#if defined(CONFIG_NET_QDISC)
+	/** Queueing discipline statistics, band 0 only unless the strict
+	 * priority queueing discipline is used.
+	 */
+	struct net_stats_qdisc qdisc[NET_QDISC_PRIO_BANDS];
+#endif
 };
 
 /**
@@ -384,6 +429,7 @@ enum net_request_stats_cmd {
 	NET_REQUEST_STATS_CMD_GET_UDP,
 	NET_REQUEST_STATS_CMD_GET_TCP,
 	NET_REQUEST_STATS_CMD_GET_ETHERNET,
+	NET_REQUEST_STATS_CMD_GET_QDISC,
 };
 
 #define NET_REQUEST_STATS_GET_ALL				\
@@ -455,6 +501,13 @@ NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_TCP);
 NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_ETHERNET);
 #endif /* CONFIG_NET_STATISTICS_ETHERNET */
 
+#if defined(CONFIG_NET_QDISC)
+#define NET_REQUEST_STATS_GET_QDISC				\
+	(_NET_STATS_BASE | NET_REQUEST_STATS_CMD_GET_QDISC)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_STATS_GET_QDISC);
+#endif /* CONFIG_NET_QDISC */
+
 #endif /* CONFIG_NET_STATISTICS_USER_API */
 
 /**
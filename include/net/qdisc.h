@@ -0,0 +1,166 @@
+/** @file
+ * @brief Network queueing disciplines
+ *
+ * Shape and schedule the packets sent by a network interface.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_QDISC_H_
+#define ZEPHYR_INCLUDE_NET_QDISC_H_
+
+/**
+ * @brief Network queueing disciplines
+ * @defgroup net_qdisc Network queueing disciplines
+ * @ingroup networking
+ * @{
+ */
+
+#include <zephyr/types.h>
+#include <net/net_if.h>
+#include <net/net_mgmt.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Queueing discipline types */
+enum net_qdisc_type {
+	/** No queueing discipline, the packets go through the Tx traffic
+	 * classes.
+	 */
+	NET_QDISC_NONE = 0,
+
+	/** Single FIFO queue, shaped by a token bucket. */
+	NET_QDISC_TBF,
+
+	/** NET_QDISC_PRIO_BANDS strict priority bands. Packets of priority
+	 * NET_PRIORITY_NC, NET_PRIORITY_IC and NET_PRIORITY_VO go to band
+	 * 0, those of priority NET_PRIORITY_BK to band 2 and the others to
+	 * band 1. A band is only served when the bands before it are empty.
+	 */
+	NET_QDISC_PRIO,
+
+	/** Flows served in turn by deficit round robin, each of them
+	 * managed by CoDel so that their queue delay stays close to the
+	 * target. See RFC 8290.
+	 */
+	NET_QDISC_FQ_CODEL,
+};
+
+/** Configuration of the queueing discipline of a network interface */
+struct net_qdisc_config {
+	/** Type of the queueing discipline */
+	enum net_qdisc_type type;
+
+	/** Rate the packets are sent at, in bytes per second. Any type of
+	 * queueing discipline can be shaped, 0 meaning as fast as the
+	 * interface can send. Required for NET_QDISC_TBF.
+	 */
+	u32_t rate;
+
+	/** Size of the token bucket in bytes, that is the largest burst
+	 * of packets sent at the interface speed. It cannot be smaller
+	 * than the MTU of the interface. If 0, the larger of the MTU and
+	 * of the bytes sent in 10 ms at the rate.
+	 */
+	u32_t burst;
+
+	/** Max number of packets queued. When reached, the packet is
+	 * dropped, or with NET_QDISC_FQ_CODEL the oldest packet of the
+	 * largest flow. If 0, CONFIG_NET_QDISC_LIMIT.
+	 */
+	u16_t limit;
+
+	/** NET_QDISC_FQ_CODEL bytes a flow can send in turn. If 0, the
+	 * MTU of the interface.
+	 */
+	u16_t quantum;
+
+	/** NET_QDISC_FQ_CODEL acceptable queue delay in microseconds.
+	 * If 0, 5 ms.
+	 */
+	u32_t target;
+
+	/** NET_QDISC_FQ_CODEL time the queue delay must stay above the
+	 * target before packets are dropped, in microseconds. If 0, 100 ms.
+	 */
+	u32_t interval;
+};
+
+/**
+ * @brief Set the queueing discipline of a network interface
+ *
+ * @details The packets queued by the previous queueing discipline, if
+ * any, are dropped. The packets sent by an interface with a queueing
+ * discipline go through it instead of the Tx traffic classes, and are
+ * all sent by the Tx thread of the highest traffic class. Their queue
+ * delay and drops are accounted in the net_stats of the interface.
+ *
+ * @param iface Network interface
+ * @param config Configuration, the parameters left to 0 being set to
+ * their default value. Type NET_QDISC_NONE removes the queueing
+ * discipline.
+ *
+ * @return 0 if ok, -EINVAL if the configuration is not valid, -ENOMEM if
+ * CONFIG_NET_QDISC_IFACE_COUNT interfaces already have a queueing
+ * discipline.
+ */
+int net_qdisc_set(struct net_if *iface,
+		  const struct net_qdisc_config *config);
+
+/**
+ * @brief Get the queueing discipline of a network interface
+ *
+ * @param iface Network interface
+ * @param config Set to the configuration, with the default values, or
+ * to type NET_QDISC_NONE if the interface has no queueing discipline.
+ *
+ * @return 0 if ok, <0 if error.
+ */
+int net_qdisc_get(struct net_if *iface, struct net_qdisc_config *config);
+
+/** @cond INTERNAL_HIDDEN */
+
+#define _NET_QDISC_LAYER	NET_MGMT_LAYER_L2
+#define _NET_QDISC_CODE		0x102
+#define _NET_QDISC_BASE		(NET_MGMT_IFACE_BIT |			\
+				 NET_MGMT_LAYER(_NET_QDISC_LAYER) |	\
+				 NET_MGMT_LAYER_CODE(_NET_QDISC_CODE))
+
+enum net_request_qdisc_cmd {
+	NET_REQUEST_QDISC_CMD_SET = 1,
+	NET_REQUEST_QDISC_CMD_GET,
+};
+
+/** @endcond */
+
+/** net_mgmt() request calling net_qdisc_set(), with a
+ * struct net_qdisc_config.
+ */
+#define NET_REQUEST_QDISC_SET					\
+	(_NET_QDISC_BASE | NET_REQUEST_QDISC_CMD_SET)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_QDISC_SET);
+
+/** net_mgmt() request calling net_qdisc_get(), with a
+ * struct net_qdisc_config.
+ */
+#define NET_REQUEST_QDISC_GET					\
+	(_NET_QDISC_BASE | NET_REQUEST_QDISC_CMD_GET)
+
+NET_MGMT_DEFINE_REQUEST_HANDLER(NET_REQUEST_QDISC_GET);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_QDISC_H_ */
@@ -26,6 +26,7 @@
 #include <net/net_ip.h>
 #include <net/dns_resolve.h>
 #include <net/socket_select.h>
+#include <net/socket_epoll.h>
 #include <stdlib.h>
 
 #ifdef __cplusplus
@@ -119,6 +120,31 @@ struct zsock_pollfd {
  *    - 1 - server
  */
 #define TLS_DTLS_ROLE 6
+/** Socket option to enable TLS session resumption on a socket. It accepts
+ *  and returns an integer:
+ *    - 0 - disabled
+ *    - 1 - enabled
+ *
+ *  Requires CONFIG_NET_SOCKETS_TLS_SESSION_CACHE. Clients try to resume the
+ *  session cached for the peer address and hostname, servers resume the
+ *  sessions of clients connecting again. Disabled by default.
+ */
+#define TLS_SESSION_CACHE 7
+/** Write-only socket option to remove all the sessions cached by clients.
+ *  The option value is ignored.
+ */
+#define TLS_SESSION_CACHE_PURGE 8
+/** Socket option to let a DTLS server socket serve several peers at once,
+ *  with a DTLS session each. It accepts and returns an integer:
+ *    - 0 - disabled
+ *    - 1 - enabled
+ *
+ *  Requires CONFIG_NET_SOCKETS_DTLS_MULTI_PEER, and must be set before the
+ *  first recvfrom(). recvfrom() then returns the address of the peer the
+ *  data comes from, and sendto() sends to the peer given as destination,
+ *  or to the last peer data was received from. Disabled by default.
+ */
+#define TLS_DTLS_MULTI_PEER 9
 
 /** @} */
 
@@ -740,6 +766,11 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 /** sockopt: Don't support IPv4 access (ignored, for compatibility) */
 #define IPV6_V6ONLY 26
 
+/** sockopt: Memory limit of the sent data pending in the stack */
+#define SO_SNDBUF 7
+/** sockopt: Memory limit of the received data pending in the stack */
+#define SO_RCVBUF 8
+
 /** sockopt: Socket priority */
 #define SO_PRIORITY 12
 
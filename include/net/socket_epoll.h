@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2019 Linaro Limited
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_
+#define ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_
+
+/**
+ * @brief BSD Sockets compatible API
+ * @defgroup bsd_sockets BSD Sockets compatible API
+ * @ingroup networking
+ * @{
+ */
+
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ZSOCK_EPOLL* values are compatible with Linux */
+/** zsock_epoll: Socket is readable */
+#define ZSOCK_EPOLLIN 0x001
+/** zsock_epoll: Compatibility value, ignored */
+#define ZSOCK_EPOLLPRI 0x002
+/** zsock_epoll: Socket is writable */
+#define ZSOCK_EPOLLOUT 0x004
+/** zsock_epoll: Error condition (output value only) */
+#define ZSOCK_EPOLLERR 0x008
+/** zsock_epoll: Peer closed connection (output value only) */
+#define ZSOCK_EPOLLHUP 0x010
+/** zsock_epoll: Disable socket after one event is reported */
+#define ZSOCK_EPOLLONESHOT (1U << 30)
+/** zsock_epoll: Report socket only on readiness change (edge-triggered) */
+#define ZSOCK_EPOLLET (1U << 31)
+
+/** zsock_epoll_ctl: Add socket to the interest set */
+#define ZSOCK_EPOLL_CTL_ADD 1
+/** zsock_epoll_ctl: Remove socket from the interest set */
+#define ZSOCK_EPOLL_CTL_DEL 2
+/** zsock_epoll_ctl: Change events monitored for the socket */
+#define ZSOCK_EPOLL_CTL_MOD 3
+
+typedef union zsock_epoll_data {
+	void *ptr;
+	int fd;
+	u32_t u32;
+} zsock_epoll_data_t;
+
+struct zsock_epoll_event {
+	u32_t events;
+	zsock_epoll_data_t data;
+};
+
+/**
+ * @brief Create persistent interest set for socket events
+ *
+ * @details
+ * @rst
+ * Allocates a new event notification instance and returns a file
+ * descriptor referring to it, see Linux ``man 2 epoll_create``.
+ * Unlike :c:func:`zsock_poll()`, the set of monitored sockets is kept
+ * between the calls, and sockets are put on a ready list by the network
+ * stack as soon as data or connections arrive, so waiting costs are
+ * proportional to the number of ready sockets rather than to the number
+ * of monitored ones. The instance is released with :c:func:`zsock_close()`.
+ * This function is also exposed as ``epoll_create()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param size Ignored, must be greater than zero.
+ *
+ * @return File descriptor of the new instance, or -1 with errno set.
+ */
+int zsock_epoll_create(int size);
+
+/**
+ * @brief Add, modify or remove a socket in the interest set
+ *
+ * @details
+ * @rst
+ * See Linux ``man 2 epoll_ctl`` for the description of operations.
+ * Level-triggered (default), edge-triggered (``ZSOCK_EPOLLET``) and
+ * one-shot (``ZSOCK_EPOLLONESHOT``) modes are supported.
+ * Only sockets can be monitored, other descriptors fail with ``EPERM``.
+ * This function is also exposed as ``epoll_ctl()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param epfd Descriptor returned by zsock_epoll_create().
+ * @param op ZSOCK_EPOLL_CTL_ADD, ZSOCK_EPOLL_CTL_MOD or ZSOCK_EPOLL_CTL_DEL.
+ * @param fd Socket to operate on.
+ * @param event Requested events and user data, ignored for
+ *        ZSOCK_EPOLL_CTL_DEL.
+ *
+ * @return 0 on success, -1 with errno set otherwise.
+ */
+int zsock_epoll_ctl(int epfd, int op, int fd, struct zsock_epoll_event *event);
+
+/**
+ * @brief Wait for events on the interest set
+ *
+ * @details
+ * @rst
+ * See Linux ``man 2 epoll_wait`` for normative description.
+ * This function is also exposed as ``epoll_wait()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @param epfd Descriptor returned by zsock_epoll_create().
+ * @param events Array to store ready events in.
+ * @param maxevents Size of the events array.
+ * @param timeout Timeout in milliseconds, -1 to wait forever.
+ *
+ * @return Number of ready events stored, 0 on timeout, or -1 with errno set.
+ */
+int zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+		     int maxevents, int timeout);
+
+#ifdef CONFIG_NET_SOCKETS_POSIX_NAMES
+
+#define epoll_event zsock_epoll_event
+#define epoll_data_t zsock_epoll_data_t
+
+#define EPOLLIN ZSOCK_EPOLLIN
+#define EPOLLPRI ZSOCK_EPOLLPRI
+#define EPOLLOUT ZSOCK_EPOLLOUT
+#define EPOLLERR ZSOCK_EPOLLERR
+#define EPOLLHUP ZSOCK_EPOLLHUP
+#define EPOLLONESHOT ZSOCK_EPOLLONESHOT
+#define EPOLLET ZSOCK_EPOLLET
+
+#define EPOLL_CTL_ADD ZSOCK_EPOLL_CTL_ADD
+#define EPOLL_CTL_DEL ZSOCK_EPOLL_CTL_DEL
+#define EPOLL_CTL_MOD ZSOCK_EPOLL_CTL_MOD
+
+static inline int epoll_create(int size)
+{
+	return zsock_epoll_create(size);
+}
+
+static inline int epoll_ctl(int epfd, int op, int fd,
+			    struct zsock_epoll_event *event)
+{
+	return zsock_epoll_ctl(epfd, op, fd, event);
+}
+
+static inline int epoll_wait(int epfd, struct zsock_epoll_event *events,
+			     int maxevents, int timeout)
+{
+	return zsock_epoll_wait(epfd, events, maxevents, timeout);
+}
+
+#endif /* CONFIG_NET_SOCKETS_POSIX_NAMES */
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_ */
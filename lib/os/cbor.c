@@ -0,0 +1,844 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <misc/byteorder.h>
+#include <misc/util.h>
+#include <stdbool.h>
+#include <string.h>
+#include <zephyr/types.h>
+
+#include "cbor.h"
+#include "json_descr.h"
+
+#define CBOR_MAJOR_UINT 0
+#define CBOR_MAJOR_NINT 1
+#define CBOR_MAJOR_BYTES 2
+#define CBOR_MAJOR_TEXT 3
+#define CBOR_MAJOR_ARRAY 4
+#define CBOR_MAJOR_MAP 5
+#define CBOR_MAJOR_TAG 6
+#define CBOR_MAJOR_SIMPLE 7
+
+#define CBOR_INFO_UINT8 24
+#define CBOR_INFO_UINT64 27
+#define CBOR_INFO_INDEFINITE 31
+
+#define CBOR_FALSE 20
+#define CBOR_TRUE 21
+#define CBOR_FLOAT16 25
+#define CBOR_FLOAT64 27
+
+#define CBOR_BREAK 0xff
+
+void cbor_reader_init(struct cbor_reader *reader, const u8_t *data,
+		      size_t len)
+{
+	reader->pos = data;
+	reader->end = data + len;
+}
+
+static size_t remaining(const struct cbor_reader *reader)
+{
+	return reader->end - reader->pos;
+}
+
+static int read_head(struct cbor_reader *reader, u8_t *major, u64_t *arg)
+{
+	const u8_t *pos = reader->pos;
+	size_t len;
+	u8_t info;
+
+	if (pos == reader->end) {
+		return -EINVAL;
+	}
+
+	*major = *pos >> 5;
+	info = *pos++ & 0x1f;
+
+	if (info < CBOR_INFO_UINT8) {
+		*arg = info;
+		reader->pos = pos;
+
+		return 0;
+	}
+
+	if (info == CBOR_INFO_INDEFINITE) {
+		return -ENOTSUP;
+	}
+
+	if (info > CBOR_INFO_UINT64) {
+		return -EINVAL;
+	}
+
+	len = 1 << (info - CBOR_INFO_UINT8);
+	if (len > (size_t)(reader->end - pos)) {
+		return -EINVAL;
+	}
+
+	for (*arg = 0U; len; len--) {
+		*arg = (*arg << 8) | *pos++;
+	}
+
+	reader->pos = pos;
+
+	return 0;
+}
+
+/* Only moves the reader past the head if it has the expected major type */
+static int read_expected(struct cbor_reader *reader, u8_t major, u64_t *arg)
+{
+	struct cbor_reader head = *reader;
+	u8_t head_major;
+	int ret;
+
+	ret = read_head(&head, &head_major, arg);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (head_major != major) {
+		return -EINVAL;
+	}
+
+	*reader = head;
+
+	return 0;
+}
+
+int cbor_read_int64(struct cbor_reader *reader, s64_t *value)
+{
+	struct cbor_reader head = *reader;
+	u8_t major;
+	u64_t arg;
+	int ret;
+
+	ret = read_head(&head, &major, &arg);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (major != CBOR_MAJOR_UINT && major != CBOR_MAJOR_NINT) {
+		return -EINVAL;
+	}
+
+	if (arg > INT64_MAX) {
+		return -ERANGE;
+	}
+
+	/* Negative integers are encoded as -1 - n */
+	*value = major == CBOR_MAJOR_UINT ? (s64_t)arg : -1 - (s64_t)arg;
+	*reader = head;
+
+	return 0;
+}
+
+int cbor_read_int(struct cbor_reader *reader, s32_t *value)
+{
+	struct cbor_reader head = *reader;
+	s64_t value64;
+	int ret;
+
+	ret = cbor_read_int64(&head, &value64);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (value64 < INT32_MIN || value64 > INT32_MAX) {
+		return -ERANGE;
+	}
+
+	*value = (s32_t)value64;
+	*reader = head;
+
+	return 0;
+}
+
+int cbor_read_bool(struct cbor_reader *reader, bool *value)
+{
+	struct cbor_reader head = *reader;
+	u64_t arg;
+	int ret;
+
+	ret = read_expected(&head, CBOR_MAJOR_SIMPLE, &arg);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (arg != CBOR_FALSE && arg != CBOR_TRUE) {
+		return -EINVAL;
+	}
+
+	*value = arg == CBOR_TRUE;
+	*reader = head;
+
+	return 0;
+}
+
+int cbor_read_float(struct cbor_reader *reader, const u8_t **bits,
+		    size_t *len)
+{
+	struct cbor_reader head = *reader;
+	u64_t arg;
+	u8_t info;
+	int ret;
+
+	ret = read_expected(&head, CBOR_MAJOR_SIMPLE, &arg);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* The value is the argument of the head, left in network order */
+	info = *reader->pos & 0x1f;
+	if (info < CBOR_FLOAT16 || info > CBOR_FLOAT64) {
+		return -EINVAL;
+	}
+
+	*bits = reader->pos + 1;
+	*len = head.pos - *bits;
+	*reader = head;
+
+	return 0;
+}
+
+static int read_string(struct cbor_reader *reader, u8_t major,
+		       const u8_t **str, size_t *len)
+{
+	struct cbor_reader head = *reader;
+	u64_t arg;
+	int ret;
+
+	ret = read_expected(&head, major, &arg);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (arg > remaining(&head)) {
+		return -EINVAL;
+	}
+
+	*str = head.pos;
+	*len = (size_t)arg;
+	reader->pos = head.pos + arg;
+
+	return 0;
+}
+
+int cbor_read_text(struct cbor_reader *reader, const char **text,
+		   size_t *len)
+{
+	return read_string(reader, CBOR_MAJOR_TEXT, (const u8_t **)text, len);
+}
+
+int cbor_read_bytes(struct cbor_reader *reader, const u8_t **bytes,
+		    size_t *len)
+{
+	return read_string(reader, CBOR_MAJOR_BYTES, bytes, len);
+}
+
+static int read_container(struct cbor_reader *reader, u8_t major,
+			  size_t items_per_element, size_t *count)
+{
+	struct cbor_reader head = *reader;
+	u64_t arg;
+	int ret;
+
+	if (head.pos < head.end &&
+	    *head.pos == (major << 5 | CBOR_INFO_INDEFINITE)) {
+		reader->pos++;
+		*count = CBOR_INDEFINITE_LEN;
+
+		return 0;
+	}
+
+	ret = read_expected(&head, major, &arg);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* Each item takes at least one byte, so a truncated container is
+	 * caught before looping on its elements.
+	 */
+	if (arg > remaining(&head) / items_per_element) {
+		return -EINVAL;
+	}
+
+	*count = (size_t)arg;
+	*reader = head;
+
+	return 0;
+}
+
+int cbor_read_array(struct cbor_reader *reader, size_t *count)
+{
+	return read_container(reader, CBOR_MAJOR_ARRAY, 1, count);
+}
+
+int cbor_read_map(struct cbor_reader *reader, size_t *count)
+{
+	return read_container(reader, CBOR_MAJOR_MAP, 2, count);
+}
+
+int cbor_read_break(struct cbor_reader *reader)
+{
+	if (reader->pos == reader->end || *reader->pos != CBOR_BREAK) {
+		return -EINVAL;
+	}
+
+	reader->pos++;
+
+	return 0;
+}
+
+int cbor_skip(struct cbor_reader *reader)
+{
+	struct cbor_reader item = *reader;
+	size_t pending = 1;
+	u8_t major;
+	u64_t arg;
+	int ret;
+
+	/* Nested items are counted rather than recursed into, so that the
+	 * stack use does not depend on the input.
+	 */
+	while (pending) {
+		ret = read_head(&item, &major, &arg);
+		if (ret < 0) {
+			return ret;
+		}
+
+		pending--;
+
+		switch (major) {
+		case CBOR_MAJOR_BYTES:
+		case CBOR_MAJOR_TEXT:
+			if (arg > remaining(&item)) {
+				return -EINVAL;
+			}
+
+			item.pos += arg;
+			break;
+		case CBOR_MAJOR_ARRAY:
+		case CBOR_MAJOR_MAP:
+			if (arg > remaining(&item)) {
+				return -EINVAL;
+			}
+
+			pending += major == CBOR_MAJOR_MAP ? 2 * arg : arg;
+			break;
+		case CBOR_MAJOR_TAG:
+			pending++;
+			break;
+		default:
+			break;
+		}
+
+		if (pending > remaining(&item)) {
+			return -EINVAL;
+		}
+	}
+
+	*reader = item;
+
+	return 0;
+}
+
+static int obj_parse(struct cbor_reader *reader,
+		     const struct json_obj_descr *descr, size_t descr_len,
+		     void *val);
+static int arr_parse(struct cbor_reader *reader,
+		     const struct json_obj_descr *elem_descr,
+		     size_t max_elements, void *field, void *val);
+
+static int decode_string(struct cbor_reader *reader, char **field)
+{
+	/* The caller of cbor_obj_parse() handed over a writable payload */
+	char *head = (char *)reader->pos;
+	const char *text;
+	size_t len;
+	int ret;
+
+	ret = cbor_read_text(reader, &text, &len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* The head takes at least one byte, which leaves room for the NUL
+	 * terminator without touching the next item.
+	 */
+	memmove(head, text, len);
+	head[len] = '\0';
+	*field = head;
+
+	return 0;
+}
+
+static int decode_value(struct cbor_reader *reader,
+			const struct json_obj_descr *descr,
+			void *field, void *val)
+{
+	switch (descr->type) {
+	case JSON_TOK_OBJECT_START:
+		return obj_parse(reader, descr->object.sub_descr,
+				 descr->object.sub_descr_len, field);
+	case JSON_TOK_LIST_START:
+		return arr_parse(reader, descr->array.element_descr,
+				 descr->array.n_elements, field, val);
+	case JSON_TOK_FALSE:
+	case JSON_TOK_TRUE:
+		return cbor_read_bool(reader, field);
+	case JSON_TOK_NUMBER:
+		return cbor_read_int(reader, field);
+	case JSON_TOK_STRING:
+		return decode_string(reader, field);
+	default:
+		return -EINVAL;
+	}
+}
+
+static int arr_parse(struct cbor_reader *reader,
+		     const struct json_obj_descr *elem_descr,
+		     size_t max_elements, void *field, void *val)
+{
+	ptrdiff_t elem_size = get_elem_size(elem_descr);
+	size_t *elements = (size_t *)((char *)val + elem_descr->offset);
+	size_t count;
+	int ret;
+
+	assert(elem_size > 0);
+
+	*elements = 0;
+
+	ret = cbor_read_array(reader, &count);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (count == CBOR_INDEFINITE_LEN) {
+		return -ENOTSUP;
+	}
+
+	if (count > max_elements) {
+		return -ENOSPC;
+	}
+
+	while (count--) {
+		ret = decode_value(reader, elem_descr, field, val);
+		if (ret < 0) {
+			return ret;
+		}
+
+		(*elements)++;
+		field = (char *)field + elem_size;
+	}
+
+	return 0;
+}
+
+static int obj_parse(struct cbor_reader *reader,
+		     const struct json_obj_descr *descr, size_t descr_len,
+		     void *val)
+{
+	s32_t decoded_fields = 0;
+	size_t expected = 0;
+	size_t pairs, i, n;
+	const char *key;
+	size_t key_len;
+	int ret;
+
+	ret = cbor_read_map(reader, &pairs);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (pairs == CBOR_INDEFINITE_LEN) {
+		return -ENOTSUP;
+	}
+
+	while (pairs--) {
+		ret = cbor_read_text(reader, &key, &key_len);
+		if (ret < 0) {
+			return ret;
+		}
+
+		/* Start looking right after the last field that matched, as
+		 * json_obj_parse() does.
+		 */
+		for (n = 0; n < descr_len; n++) {
+			i = expected + n;
+			if (i >= descr_len) {
+				i -= descr_len;
+			}
+
+			if (key_len == descr[i].field_name_len &&
+			    !memcmp(key, descr[i].field_name, key_len)) {
+				break;
+			}
+		}
+
+		if (n == descr_len || (decoded_fields & (1 << i))) {
+			ret = cbor_skip(reader);
+			if (ret < 0) {
+				return ret;
+			}
+
+			continue;
+		}
+
+		ret = decode_value(reader, &descr[i],
+				   (char *)val + descr[i].offset, val);
+		if (ret < 0) {
+			return ret;
+		}
+
+		decoded_fields |= 1 << i;
+		expected = i + 1;
+	}
+
+	return decoded_fields;
+}
+
+int cbor_obj_parse(u8_t *payload, size_t len,
+		   const struct json_obj_descr *descr, size_t descr_len,
+		   void *val)
+{
+	struct cbor_reader reader;
+
+	assert(descr_len < (sizeof(s32_t) * CHAR_BIT - 1));
+
+	cbor_reader_init(&reader, payload, len);
+
+	return obj_parse(&reader, descr, descr_len, val);
+}
+
+static int head_encode(u8_t major, u64_t arg,
+		       json_append_bytes_t append_bytes, void *data)
+{
+	u8_t head[9];
+	size_t len, i;
+
+	if (arg < CBOR_INFO_UINT8) {
+		head[0] = (major << 5) | arg;
+		len = 1;
+	} else if (arg <= UINT8_MAX) {
+		head[0] = (major << 5) | CBOR_INFO_UINT8;
+		len = 2;
+	} else if (arg <= UINT16_MAX) {
+		head[0] = (major << 5) | (CBOR_INFO_UINT8 + 1);
+		len = 3;
+	} else if (arg <= UINT32_MAX) {
+		head[0] = (major << 5) | (CBOR_INFO_UINT8 + 2);
+		len = 5;
+	} else {
+		head[0] = (major << 5) | CBOR_INFO_UINT64;
+		len = 9;
+	}
+
+	/* The argument follows in network byte order */
+	for (i = len - 1; i > 0; i--) {
+		head[i] = arg;
+		arg >>= 8;
+	}
+
+	return append_bytes((const char *)head, len, data);
+}
+
+int cbor_encode_int(s64_t value, json_append_bytes_t append_bytes,
+		    void *data)
+{
+	if (value < 0) {
+		return head_encode(CBOR_MAJOR_NINT, (u64_t)(-1 - value),
+				   append_bytes, data);
+	}
+
+	return head_encode(CBOR_MAJOR_UINT, value, append_bytes, data);
+}
+
+int cbor_encode_bool(bool value, json_append_bytes_t append_bytes,
+		     void *data)
+{
+	return head_encode(CBOR_MAJOR_SIMPLE, value ? CBOR_TRUE : CBOR_FALSE,
+			   append_bytes, data);
+}
+
+int cbor_encode_float(const u8_t *bits, size_t len,
+		      json_append_bytes_t append_bytes, void *data)
+{
+	u8_t head;
+	int ret;
+
+	switch (len) {
+	case 2:
+		head = (CBOR_MAJOR_SIMPLE << 5) | CBOR_FLOAT16;
+		break;
+	case 4:
+		head = (CBOR_MAJOR_SIMPLE << 5) | (CBOR_FLOAT16 + 1);
+		break;
+	case 8:
+		head = (CBOR_MAJOR_SIMPLE << 5) | CBOR_FLOAT64;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	ret = append_bytes((const char *)&head, sizeof(head), data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return append_bytes((const char *)bits, len, data);
+}
+
+static int string_encode(u8_t major, const char *str, size_t len,
+			 json_append_bytes_t append_bytes, void *data)
+{
+	int ret;
+
+	ret = head_encode(major, len, append_bytes, data);
+	if (ret < 0 || len == 0) {
+		return ret;
+	}
+
+	return append_bytes(str, len, data);
+}
+
+int cbor_encode_text(const char *text, size_t len,
+		     json_append_bytes_t append_bytes, void *data)
+{
+	return string_encode(CBOR_MAJOR_TEXT, text, len, append_bytes, data);
+}
+
+int cbor_encode_bytes(const u8_t *bytes, size_t len,
+		      json_append_bytes_t append_bytes, void *data)
+{
+	return string_encode(CBOR_MAJOR_BYTES, (const char *)bytes, len,
+			     append_bytes, data);
+}
+
+static int container_encode(u8_t major, size_t count,
+			    json_append_bytes_t append_bytes, void *data)
+{
+	u8_t head = (major << 5) | CBOR_INFO_INDEFINITE;
+
+	if (count == CBOR_INDEFINITE_LEN) {
+		return append_bytes((const char *)&head, sizeof(head), data);
+	}
+
+	return head_encode(major, count, append_bytes, data);
+}
+
+int cbor_encode_array(size_t count, json_append_bytes_t append_bytes,
+		      void *data)
+{
+	return container_encode(CBOR_MAJOR_ARRAY, count, append_bytes, data);
+}
+
+int cbor_encode_map(size_t count, json_append_bytes_t append_bytes,
+		    void *data)
+{
+	return container_encode(CBOR_MAJOR_MAP, count, append_bytes, data);
+}
+
+int cbor_encode_break(json_append_bytes_t append_bytes, void *data)
+{
+	u8_t brk = CBOR_BREAK;
+
+	return append_bytes((const char *)&brk, sizeof(brk), data);
+}
+
+static int encode(const struct json_obj_descr *descr, const void *val,
+		  json_append_bytes_t append_bytes, void *data);
+
+static int arr_encode(const struct json_obj_descr *elem_descr,
+		      const void *field, const void *val,
+		      json_append_bytes_t append_bytes, void *data)
+{
+	ptrdiff_t elem_size = get_elem_size(elem_descr);
+	/* See arr_encode() in json.c: the offset of the element descriptor
+	 * is the one of the field holding the number of elements.
+	 */
+	size_t n_elem = *(size_t *)((char *)val + elem_descr->offset);
+	size_t i;
+	int ret;
+
+	ret = cbor_encode_array(n_elem, append_bytes, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (i = 0; i < n_elem; i++) {
+		ret = encode(elem_descr, (char *)field - elem_descr->offset,
+			     append_bytes, data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		field = (char *)field + elem_size;
+	}
+
+	return 0;
+}
+
+static int encode(const struct json_obj_descr *descr, const void *val,
+		  json_append_bytes_t append_bytes, void *data)
+{
+	void *ptr = (char *)val + descr->offset;
+
+	switch (descr->type) {
+	case JSON_TOK_FALSE:
+	case JSON_TOK_TRUE:
+		return cbor_encode_bool(*(bool *)ptr, append_bytes, data);
+	case JSON_TOK_STRING: {
+		const char *str = *(const char **)ptr;
+
+		return cbor_encode_text(str, strlen(str), append_bytes, data);
+	}
+	case JSON_TOK_LIST_START:
+		return arr_encode(descr->array.element_descr, ptr,
+				  val, append_bytes, data);
+	case JSON_TOK_OBJECT_START:
+		return cbor_obj_encode(descr->object.sub_descr,
+				       descr->object.sub_descr_len,
+				       ptr, append_bytes, data);
+	case JSON_TOK_NUMBER:
+		return cbor_encode_int(*(s32_t *)ptr, append_bytes, data);
+	default:
+		return -EINVAL;
+	}
+}
+
+int cbor_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
+		    const void *val, json_append_bytes_t append_bytes,
+		    void *data)
+{
+	size_t i;
+	int ret;
+
+	ret = cbor_encode_map(descr_len, append_bytes, data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (i = 0; i < descr_len; i++) {
+		ret = cbor_encode_text(descr[i].field_name,
+				       descr[i].field_name_len, append_bytes,
+				       data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = encode(&descr[i], val, append_bytes, data);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+struct appender {
+	u8_t *buffer;
+	size_t used;
+	size_t size;
+};
+
+static int append_bytes_to_buf(const char *bytes, size_t len, void *data)
+{
+	struct appender *appender = data;
+
+	if (len > appender->size - appender->used) {
+		return -ENOMEM;
+	}
+
+	memcpy(appender->buffer + appender->used, bytes, len);
+	appender->used += len;
+
+	return 0;
+}
+
+ssize_t cbor_obj_encode_buf(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val,
+			    u8_t *buffer, size_t buf_size)
+{
+	struct appender appender = { .buffer = buffer, .size = buf_size };
+	int ret;
+
+	ret = cbor_obj_encode(descr, descr_len, val, append_bytes_to_buf,
+			      &appender);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return appender.used;
+}
+
+static int measure_bytes(const char *bytes, size_t len, void *data)
+{
+	ssize_t *total = data;
+
+	*total += (ssize_t)len;
+
+	ARG_UNUSED(bytes);
+
+	return 0;
+}
+
+ssize_t cbor_calc_encoded_len(const struct json_obj_descr *descr,
+			      size_t descr_len, const void *val)
+{
+	ssize_t total = 0;
+	int ret;
+
+	ret = cbor_obj_encode(descr, descr_len, val, measure_bytes, &total);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return total;
+}
+
+#if defined(CONFIG_NET_BUF)
+struct net_buf_appender {
+	struct net_buf *buf;
+	s32_t timeout;
+	net_buf_allocator_cb allocate_cb;
+	void *user_data;
+};
+
+static int append_bytes_to_net_buf(const char *bytes, size_t len,
+				   void *data)
+{
+	struct net_buf_appender *appender = data;
+	size_t added;
+
+	added = net_buf_append_bytes(appender->buf, len, bytes,
+				     appender->timeout, appender->allocate_cb,
+				     appender->user_data);
+	if (added < len) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+int cbor_obj_encode_net_buf(const struct json_obj_descr *descr,
+			    size_t descr_len, const void *val,
+			    struct net_buf *buf, s32_t timeout,
+			    net_buf_allocator_cb allocate_cb, void *user_data)
+{
+	struct net_buf_appender appender = {
+		.buf = buf,
+		.timeout = timeout,
+		.allocate_cb = allocate_cb,
+		.user_data = user_data,
+	};
+
+	return cbor_obj_encode(descr, descr_len, val, append_bytes_to_net_buf,
+			       &appender);
+}
+#endif /* CONFIG_NET_BUF */
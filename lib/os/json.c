@@ -16,6 +16,7 @@
 #include <zephyr/types.h>
 
 #include "json.h"
+#include "json_descr.h"
 
 struct token {
 	enum json_tokens type;
@@ -474,35 +475,6 @@ static int decode_value(struct json_obj *obj,
 	}
 }
 
-static ptrdiff_t get_elem_size(const struct json_obj_descr *descr)
-{
-	switch (descr->type) {
-	case JSON_TOK_NUMBER:
-		return sizeof(s32_t);
-	case JSON_TOK_STRING:
-		return sizeof(char *);
-	case JSON_TOK_TRUE:
-	case JSON_TOK_FALSE:
-		return sizeof(bool);
-	case JSON_TOK_LIST_START:
-		return descr->array.n_elements * get_elem_size(descr->array.element_descr);
-	case JSON_TOK_OBJECT_START: {
-		ptrdiff_t total = 0;
-		size_t i;
-
-		for (i = 0; i < descr->object.sub_descr_len; i++) {
-			ptrdiff_t s = get_elem_size(&descr->object.sub_descr[i]);
-
-			total += ROUND_UP(s, 1 << descr->align_shift);
-		}
-
-		return total;
-	}
-	default:
-		return -EINVAL;
-	}
-}
-
 static int arr_parse(struct json_obj *obj,
 		     const struct json_obj_descr *elem_descr,
 		     size_t max_elements, void *field, void *val)
@@ -541,7 +513,8 @@ static int obj_parse(struct json_obj *obj, const struct json_obj_descr *descr,
 {
 	struct json_obj_key_value kv;
 	s32_t decoded_fields = 0;
-	size_t i;
+	size_t expected = 0;
+	size_t i, n;
 	int ret;
 
 	while (!obj_next(obj, &kv)) {
@@ -549,8 +522,20 @@ static int obj_parse(struct json_obj *obj, const struct json_obj_descr *descr,
 			return decoded_fields;
 		}
 
-		for (i = 0; i < descr_len; i++) {
-			void *decode_field = (char *)val + descr[i].offset;
+		/* Documents usually list the fields in the order of the
+		 * descriptors, so start looking for the key right after the
+		 * last field that matched: this makes the search constant
+		 * time for such documents.
+		 */
+		for (n = 0; n < descr_len; n++) {
+			void *decode_field;
+
+			i = expected + n;
+			if (i >= descr_len) {
+				i -= descr_len;
+			}
+
+			decode_field = (char *)val + descr[i].offset;
 
 			/* Field has been decoded already, skip */
 			if (decoded_fields & (1 << i)) {
@@ -575,6 +560,7 @@ static int obj_parse(struct json_obj *obj, const struct json_obj_descr *descr,
 			}
 
 			decoded_fields |= 1<<i;
+			expected = i + 1;
 			break;
 		}
 	}
@@ -625,21 +611,35 @@ static int json_escape_internal(const char *str,
 				json_append_bytes_t append_bytes,
 				void *data)
 {
+	const char *run = str;
 	const char *cur;
 	int ret = 0;
 
+	/* Append the characters which need no escaping in runs, rather than
+	 * one at a time.
+	 */
 	for (cur = str; ret == 0 && *cur; cur++) {
 		char escaped = escape_as(*cur);
 
 		if (escaped) {
 			char bytes[2] = { '\\', escaped };
 
+			if (cur > run) {
+				ret = append_bytes(run, cur - run, data);
+				if (ret < 0) {
+					return ret;
+				}
+			}
+
 			ret = append_bytes(bytes, 2, data);
-		} else {
-			ret = append_bytes(cur, 1, data);
+			run = cur + 1;
 		}
 	}
 
+	if (ret == 0 && cur > run) {
+		ret = append_bytes(run, cur - run, data);
+	}
+
 	return ret;
 }
 
@@ -919,3 +919,612 @@ ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
 
 	return total;
 }
+
+enum parser_state {
+	PARSE_VALUE,
+	PARSE_FIRST_VALUE,
+	PARSE_KEY,
+	PARSE_FIRST_KEY,
+	PARSE_COLON,
+	PARSE_NEXT,
+	PARSE_DONE,
+	PARSE_ERROR,
+};
+
+enum parser_lex {
+	LEX_NONE,
+	LEX_STRING,
+	LEX_ESCAPE,
+	LEX_UNICODE,
+	LEX_LITERAL,
+	LEX_NUMBER,
+};
+
+/* Position within a number, -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+enum parser_number {
+	NUM_SIGN,
+	NUM_ZERO,
+	NUM_INT,
+	NUM_FRAC_START,
+	NUM_FRAC,
+	NUM_EXP_START,
+	NUM_EXP_SIGN,
+	NUM_EXP,
+};
+
+void json_parser_init(struct json_parser *parser, char *buf, size_t buf_size,
+		      json_token_cb_t token_cb, void *data)
+{
+	(void)memset(parser, 0, sizeof(*parser));
+
+	parser->token_cb = token_cb;
+	parser->data = data;
+	parser->buf = buf;
+	parser->buf_size = buf_size;
+	parser->state = PARSE_VALUE;
+	parser->lex = LEX_NONE;
+}
+
+static bool parser_in_object(struct json_parser *parser)
+{
+	return parser->depth && (parser->objects & BIT(parser->depth - 1));
+}
+
+static int parser_append(struct json_parser *parser, const char *bytes,
+			 size_t len)
+{
+	if (len > parser->buf_size - parser->len) {
+		return -ENOMEM;
+	}
+
+	memcpy(parser->buf + parser->len, bytes, len);
+	parser->len += len;
+
+	return 0;
+}
+
+static int parser_report(struct json_parser *parser, enum json_tokens type)
+{
+	struct json_token token = {
+		.type = type,
+		.depth = parser->depth,
+		.value = parser->buf + parser->key_len,
+		.value_len = parser->len - parser->key_len,
+	};
+
+	if (parser->has_key) {
+		token.key = parser->buf;
+		token.key_len = parser->key_len;
+	}
+
+	parser->has_key = false;
+	parser->key_len = 0;
+	parser->len = 0;
+
+	return parser->token_cb(&token, parser->data);
+}
+
+static int parser_value(struct json_parser *parser, enum json_tokens type)
+{
+	parser->state = parser->depth ? PARSE_NEXT : PARSE_DONE;
+
+	return parser_report(parser, type);
+}
+
+static int parser_open(struct json_parser *parser, char chr)
+{
+	bool object = chr == JSON_TOK_OBJECT_START;
+	int ret;
+
+	if (parser->depth == JSON_MAX_DEPTH) {
+		return -ENOSPC;
+	}
+
+	ret = parser_report(parser, (enum json_tokens)chr);
+	if (ret < 0) {
+		return ret;
+	}
+
+	WRITE_BIT(parser->objects, parser->depth, object);
+	parser->depth++;
+	parser->state = object ? PARSE_FIRST_KEY : PARSE_FIRST_VALUE;
+
+	return 0;
+}
+
+static int parser_close(struct json_parser *parser, char chr)
+{
+	if ((chr == JSON_TOK_OBJECT_END) != parser_in_object(parser)) {
+		return -EINVAL;
+	}
+
+	parser->depth--;
+
+	return parser_value(parser, (enum json_tokens)chr);
+}
+
+static int parser_string_end(struct json_parser *parser)
+{
+	if (parser->state == PARSE_KEY || parser->state == PARSE_FIRST_KEY) {
+		parser->key_len = parser->len;
+		parser->has_key = true;
+		parser->state = PARSE_COLON;
+
+		return 0;
+	}
+
+	return parser_value(parser, JSON_TOK_STRING);
+}
+
+static int parser_number_end(struct json_parser *parser)
+{
+	parser->lex = LEX_NONE;
+
+	switch (parser->lex_pos) {
+	case NUM_ZERO:
+	case NUM_INT:
+	case NUM_FRAC:
+	case NUM_EXP:
+		return parser_value(parser, JSON_TOK_NUMBER);
+	default:
+		/* "-", "1." or "1e" */
+		return -EINVAL;
+	}
+}
+
+static int parser_start_value(struct json_parser *parser, char chr)
+{
+	switch (chr) {
+	case '{':
+	case '[':
+		return parser_open(parser, chr);
+	case '"':
+		parser->lex = LEX_STRING;
+		return 0;
+	case 't':
+	case 'f':
+	case 'n':
+		parser->lex = LEX_LITERAL;
+		parser->lex_type = chr;
+		parser->lex_pos = 1U;
+		return 0;
+	case '-':
+		parser->lex_pos = NUM_SIGN;
+		break;
+	case '0':
+		parser->lex_pos = NUM_ZERO;
+		break;
+	default:
+		if (!isdigit((unsigned char)chr)) {
+			return -EINVAL;
+		}
+
+		parser->lex_pos = NUM_INT;
+	}
+
+	parser->lex = LEX_NUMBER;
+
+	return parser_append(parser, &chr, 1);
+}
+
+static int parser_structure(struct json_parser *parser, char chr)
+{
+	if (isspace((unsigned char)chr)) {
+		return 0;
+	}
+
+	switch (parser->state) {
+	case PARSE_FIRST_VALUE:
+		if (chr == JSON_TOK_LIST_END) {
+			return parser_close(parser, chr);
+		}
+
+		/* fallthrough */
+	case PARSE_VALUE:
+		return parser_start_value(parser, chr);
+	case PARSE_FIRST_KEY:
+		if (chr == JSON_TOK_OBJECT_END) {
+			return parser_close(parser, chr);
+		}
+
+		/* fallthrough */
+	case PARSE_KEY:
+		if (chr != '"') {
+			return -EINVAL;
+		}
+
+		parser->lex = LEX_STRING;
+		return 0;
+	case PARSE_COLON:
+		if (chr != JSON_TOK_COLON) {
+			return -EINVAL;
+		}
+
+		parser->state = PARSE_VALUE;
+		return 0;
+	case PARSE_NEXT:
+		if (chr == JSON_TOK_COMMA) {
+			parser->state = parser_in_object(parser) ?
+					PARSE_KEY : PARSE_VALUE;
+			return 0;
+		}
+
+		if (chr == JSON_TOK_OBJECT_END || chr == JSON_TOK_LIST_END) {
+			return parser_close(parser, chr);
+		}
+
+		return -EINVAL;
+	default:
+		return -EINVAL;
+	}
+}
+
+static int parser_string(struct json_parser *parser, const char **chunk,
+			 const char *end)
+{
+	const char *run = *chunk;
+	const char *cur = run;
+	int ret;
+
+	while (cur < end && *cur != '"' && *cur != '\\') {
+		cur++;
+	}
+
+	ret = parser_append(parser, run, cur - run);
+	if (ret < 0 || cur == end) {
+		*chunk = end;
+		return ret;
+	}
+
+	*chunk = cur + 1;
+
+	if (*cur == '\\') {
+		parser->lex = LEX_ESCAPE;
+		return parser_append(parser, cur, 1);
+	}
+
+	parser->lex = LEX_NONE;
+
+	return parser_string_end(parser);
+}
+
+static int parser_escape(struct json_parser *parser, char chr)
+{
+	switch (chr) {
+	case '"':
+	case '\\':
+	case '/':
+	case 'b':
+	case 'f':
+	case 'n':
+	case 'r':
+	case 't':
+		parser->lex = LEX_STRING;
+		break;
+	case 'u':
+		parser->lex = LEX_UNICODE;
+		parser->lex_pos = 0U;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return parser_append(parser, &chr, 1);
+}
+
+static int parser_unicode(struct json_parser *parser, char chr)
+{
+	if (!isxdigit((unsigned char)chr)) {
+		return -EINVAL;
+	}
+
+	if (++parser->lex_pos == 4U) {
+		parser->lex = LEX_STRING;
+	}
+
+	return parser_append(parser, &chr, 1);
+}
+
+static int parser_literal(struct json_parser *parser, char chr)
+{
+	const char *literal;
+
+	switch (parser->lex_type) {
+	case JSON_TOK_TRUE:
+		literal = "true";
+		break;
+	case JSON_TOK_FALSE:
+		literal = "false";
+		break;
+	default:
+		literal = "null";
+		break;
+	}
+
+	if (chr != literal[parser->lex_pos]) {
+		return -EINVAL;
+	}
+
+	if (literal[++parser->lex_pos] != '\0') {
+		return 0;
+	}
+
+	parser->lex = LEX_NONE;
+
+	return parser_value(parser, (enum json_tokens)parser->lex_type);
+}
+
+static bool number_char(char chr)
+{
+	return isdigit((unsigned char)chr) || chr == '.' || chr == 'e' ||
+	       chr == 'E' || chr == '+' || chr == '-';
+}
+
+static int parser_number(struct json_parser *parser, char chr)
+{
+	bool digit = isdigit((unsigned char)chr);
+	bool exp = chr == 'e' || chr == 'E';
+
+	switch (parser->lex_pos) {
+	case NUM_SIGN:
+		if (!digit) {
+			return -EINVAL;
+		}
+
+		parser->lex_pos = chr == '0' ? NUM_ZERO : NUM_INT;
+		break;
+	case NUM_INT:
+		if (digit) {
+			break;
+		}
+
+		/* fallthrough */
+	case NUM_ZERO:
+		/* No other digit may follow a leading zero */
+		if (chr == '.') {
+			parser->lex_pos = NUM_FRAC_START;
+		} else if (exp) {
+			parser->lex_pos = NUM_EXP_START;
+		} else {
+			return -EINVAL;
+		}
+
+		break;
+	case NUM_FRAC:
+		if (exp) {
+			parser->lex_pos = NUM_EXP_START;
+			break;
+		}
+
+		/* fallthrough */
+	case NUM_FRAC_START:
+		if (!digit) {
+			return -EINVAL;
+		}
+
+		parser->lex_pos = NUM_FRAC;
+		break;
+	case NUM_EXP_START:
+		if (chr == '+' || chr == '-') {
+			parser->lex_pos = NUM_EXP_SIGN;
+			break;
+		}
+
+		/* fallthrough */
+	case NUM_EXP_SIGN:
+	case NUM_EXP:
+		if (!digit) {
+			return -EINVAL;
+		}
+
+		parser->lex_pos = NUM_EXP;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return parser_append(parser, &chr, 1);
+}
+
+int json_parser_feed(struct json_parser *parser, const char *chunk,
+		     size_t len)
+{
+	const char *end = chunk + len;
+	int ret = 0;
+
+	if (parser->state == PARSE_ERROR) {
+		return -EINVAL;
+	}
+
+	while (chunk < end) {
+		switch (parser->lex) {
+		case LEX_STRING:
+			ret = parser_string(parser, &chunk, end);
+			break;
+		case LEX_ESCAPE:
+			ret = parser_escape(parser, *chunk++);
+			break;
+		case LEX_UNICODE:
+			ret = parser_unicode(parser, *chunk++);
+			break;
+		case LEX_LITERAL:
+			ret = parser_literal(parser, *chunk++);
+			break;
+		case LEX_NUMBER:
+			/* The character ending a number belongs to the
+			 * structure, so it is left for the next iteration.
+			 */
+			if (number_char(*chunk)) {
+				ret = parser_number(parser, *chunk++);
+			} else {
+				ret = parser_number_end(parser);
+			}
+			break;
+		default:
+			ret = parser_structure(parser, *chunk++);
+			break;
+		}
+
+		if (ret < 0) {
+			parser->state = PARSE_ERROR;
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+int json_parser_finish(struct json_parser *parser)
+{
+	int ret;
+
+	if (parser->state != PARSE_ERROR && parser->lex == LEX_NUMBER) {
+		ret = parser_number_end(parser);
+		if (ret < 0) {
+			parser->state = PARSE_ERROR;
+			return ret;
+		}
+	}
+
+	if (parser->state != PARSE_DONE || parser->lex != LEX_NONE) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+void json_encoder_init(struct json_encoder *encoder,
+		       json_append_bytes_t append_bytes, void *data)
+{
+	(void)memset(encoder, 0, sizeof(*encoder));
+
+	encoder->append_bytes = append_bytes;
+	encoder->data = data;
+}
+
+static int encoder_close(struct json_encoder *encoder, char chr)
+{
+	bool object;
+
+	if (!encoder->depth) {
+		return -EINVAL;
+	}
+
+	object = encoder->objects & BIT(encoder->depth - 1);
+	if ((chr == JSON_TOK_OBJECT_END) != object) {
+		return -EINVAL;
+	}
+
+	encoder->depth--;
+
+	return encoder->append_bytes(&chr, 1, encoder->data);
+}
+
+static int encoder_key(struct json_encoder *encoder,
+		       const struct json_token *token)
+{
+	bool object = false;
+	int ret;
+
+	if (encoder->depth) {
+		u32_t bit = BIT(encoder->depth - 1);
+
+		object = encoder->objects & bit;
+
+		if (encoder->members & bit) {
+			ret = encoder->append_bytes(",", 1, encoder->data);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		encoder->members |= bit;
+	}
+
+	if (!object) {
+		return 0;
+	}
+
+	if (!token->key) {
+		return -EINVAL;
+	}
+
+	ret = encoder->append_bytes("\"", 1, encoder->data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = encoder->append_bytes(token->key, token->key_len,
+				    encoder->data);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return encoder->append_bytes("\":", 2, encoder->data);
+}
+
+int json_encoder_token(struct json_encoder *encoder,
+		       const struct json_token *token)
+{
+	char chr = (char)token->type;
+	int ret;
+
+	switch (token->type) {
+	case JSON_TOK_OBJECT_END:
+	case JSON_TOK_LIST_END:
+		return encoder_close(encoder, chr);
+	case JSON_TOK_OBJECT_START:
+	case JSON_TOK_LIST_START:
+		if (encoder->depth == JSON_MAX_DEPTH) {
+			return -ENOSPC;
+		}
+
+		break;
+	case JSON_TOK_STRING:
+	case JSON_TOK_NUMBER:
+	case JSON_TOK_TRUE:
+	case JSON_TOK_FALSE:
+	case JSON_TOK_NULL:
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	ret = encoder_key(encoder, token);
+	if (ret < 0) {
+		return ret;
+	}
+
+	switch (token->type) {
+	case JSON_TOK_OBJECT_START:
+	case JSON_TOK_LIST_START:
+		WRITE_BIT(encoder->objects, encoder->depth,
+			  token->type == JSON_TOK_OBJECT_START);
+		WRITE_BIT(encoder->members, encoder->depth, false);
+		encoder->depth++;
+
+		return encoder->append_bytes(&chr, 1, encoder->data);
+	case JSON_TOK_STRING:
+		ret = encoder->append_bytes("\"", 1, encoder->data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = encoder->append_bytes(token->value, token->value_len,
+					    encoder->data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		return encoder->append_bytes("\"", 1, encoder->data);
+	case JSON_TOK_NUMBER:
+		return encoder->append_bytes(token->value, token->value_len,
+					     encoder->data);
+	case JSON_TOK_TRUE:
+		return encoder->append_bytes("true", 4, encoder->data);
+	case JSON_TOK_FALSE:
+		return encoder->append_bytes("false", 5, encoder->data);
+	default:
+		return encoder->append_bytes("null", 4, encoder->data);
+	}
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Descriptor helpers shared by the JSON and CBOR libraries */
+
+#ifndef ZEPHYR_LIB_OS_JSON_DESCR_H_
+#define ZEPHYR_LIB_OS_JSON_DESCR_H_
+
+#include <errno.h>
+#include <json.h>
+#include <misc/util.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <zephyr/types.h>
+
+/* Size taken in the decoded struct by a field of the given descriptor */
+static inline ptrdiff_t get_elem_size(const struct json_obj_descr *descr)
+{
+	switch (descr->type) {
+	case JSON_TOK_NUMBER:
+		return sizeof(s32_t);
+	case JSON_TOK_STRING:
+		return sizeof(char *);
+	case JSON_TOK_TRUE:
+	case JSON_TOK_FALSE:
+		return sizeof(bool);
+	case JSON_TOK_LIST_START:
+		return descr->array.n_elements *
+		       get_elem_size(descr->array.element_descr);
+	case JSON_TOK_OBJECT_START: {
+		ptrdiff_t total = 0;
+		size_t i;
+
+		for (i = 0; i < descr->object.sub_descr_len; i++) {
+			ptrdiff_t s = get_elem_size(&descr->object.sub_descr[i]);
+
+			total += ROUND_UP(s, 1 << descr->align_shift);
+		}
+
+		return total;
+	}
+	default:
+		return -EINVAL;
+	}
+}
+
+#endif /* ZEPHYR_LIB_OS_JSON_DESCR_H_ */
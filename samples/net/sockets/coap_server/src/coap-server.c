@@ -39,6 +39,9 @@ LOG_MODULE_REGISTER(net_coap_server_sample, LOG_LEVEL_DBG);
 
 #define NUM_PENDINGS 3
 
+/* One node per path segment of the resources, plus the root */
+#define NUM_ROUTER_NODES 16
+
 /* block option helper */
 #define GET_BLOCK_NUM(v)        ((v) >> 4)
 #define GET_BLOCK_SIZE(v)       (((v) & 0x7))
@@ -1295,6 +1298,9 @@ static struct coap_resource resources[] = {
 	{ },
 };
 
+static struct coap_router_node router_nodes[NUM_ROUTER_NODES];
+static struct coap_router router;
+
 static struct coap_resource *find_resouce_by_observer(
 		struct coap_resource *resources, struct coap_observer *o)
 {
@@ -1370,8 +1376,8 @@ not_found:
 	}
 
 end:
-	r = coap_handle_request(&request, resources, options, opt_num,
-				client_addr, client_addr_len);
+	r = coap_router_handle_request(&router, &request, options, opt_num,
+				       client_addr, client_addr_len);
 	if (r < 0) {
 		LOG_WRN("No handler for such request (%d)\n", r);
 	}
@@ -1415,6 +1421,13 @@ void main(void)
 	}
 #endif
 
+	r = coap_router_init(&router, resources, router_nodes,
+			     NUM_ROUTER_NODES);
+	if (r < 0) {
+		LOG_ERR("Cannot build the resource router (%d)", r);
+		goto quit;
+	}
+
 	r = start_coap_server();
 	if (r < 0) {
 		goto quit;
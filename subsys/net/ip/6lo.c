@@ -84,6 +84,255 @@ static inline bool net_6lo_maddr_48_bit_compressible(struct in6_addr *addr)
 		 (addr->s6_addr[10] == 0x00));
 }
 
+#if CONFIG_NET_6LO_FLOW_CACHE_SIZE > 0
+/* Longest IPHC header before the UDP checksum: IPHC, CID, TF, NH, HLIM,
+ * inlined source and destination addresses, UDP NHC and inlined ports.
+ */
+#define NET_6LO_FLOW_IPHC_MAX_LEN (2 + 1 + 4 + 1 + 1 + 16 + 16 + 1 + 4)
+
+/* A flow maps the IPv6 and UDP headers of a packet, without the lengths
+ * and the UDP checksum, to their IPHC header without the UDP checksum.
+ * The mapping also depends on the interface (contexts) and on the link
+ * layer addresses (fully elided addresses).
+ */
+struct net_6lo_flow {
+	struct net_if *iface;
+	struct net_ipv6_hdr ipv6;
+	struct net_udp_hdr udp;
+	u8_t lladdr_src[NET_LINK_ADDR_MAX_LENGTH];
+	u8_t lladdr_dst[NET_LINK_ADDR_MAX_LENGTH];
+	u8_t lladdr_src_len;
+	u8_t lladdr_dst_len;
+	u8_t iphc[NET_6LO_FLOW_IPHC_MAX_LEN];
+	u8_t iphc_len;
+	u8_t is_used		: 1;
+	u8_t is_udp		: 1;
+	u8_t chksum_elided	: 1;
+	u8_t unused		: 5;
+};
+
+struct net_6lo_flow_cache {
+	struct net_6lo_flow flows[CONFIG_NET_6LO_FLOW_CACHE_SIZE];
+
+	/* Flow replaced next when the cache is full */
+	u8_t next;
+};
+
+/* Sent flows are looked up by their headers and received flows by their
+ * IPHC header.
+ */
+static struct net_6lo_flow_cache tx_flows;
+static struct net_6lo_flow_cache rx_flows;
+
+static K_MUTEX_DEFINE(flow_lock);
+
+static inline bool flow_lladdr_match(const u8_t *addr, u8_t len,
+				     struct net_linkaddr *lladdr)
+{
+	if (!lladdr->addr) {
+		return len == 0U;
+	}
+
+	return lladdr->len == len && !memcmp(addr, lladdr->addr, len);
+}
+
+static inline bool flow_match(struct net_6lo_flow *flow,
+			      struct net_pkt *pkt)
+{
+	return flow->is_used && flow->iface == net_pkt_iface(pkt) &&
+		flow_lladdr_match(flow->lladdr_src, flow->lladdr_src_len,
+				  net_pkt_lladdr_src(pkt)) &&
+		flow_lladdr_match(flow->lladdr_dst, flow->lladdr_dst_len,
+				  net_pkt_lladdr_dst(pkt));
+}
+
+static inline bool flow_hdr_match(struct net_6lo_flow *flow,
+				  struct net_ipv6_hdr *ipv6,
+				  struct net_udp_hdr *udp)
+{
+	/* Compare the fields most likely to differ first */
+	if (!net_ipv6_addr_cmp(&flow->ipv6.dst, &ipv6->dst) ||
+	    !net_ipv6_addr_cmp(&flow->ipv6.src, &ipv6->src) ||
+	    flow->ipv6.nexthdr != ipv6->nexthdr ||
+	    flow->ipv6.hop_limit != ipv6->hop_limit ||
+	    memcmp(&flow->ipv6, ipv6, offsetof(struct net_ipv6_hdr, len))) {
+		return false;
+	}
+
+	if (!udp) {
+		return !flow->is_udp;
+	}
+
+	return flow->is_udp && flow->udp.src_port == udp->src_port &&
+		flow->udp.dst_port == udp->dst_port;
+}
+
+/* Copy the IPHC header of a sent flow, returns its length or 0 if the
+ * flow is not cached.
+ */
+static u8_t flow_compress(struct net_pkt *pkt, struct net_ipv6_hdr *ipv6,
+			  struct net_udp_hdr *udp, struct net_buf *frag)
+{
+	struct net_6lo_flow *flow;
+	u8_t offset = 0U;
+	int i;
+
+	k_mutex_lock(&flow_lock, K_FOREVER);
+
+	for (i = 0; i < CONFIG_NET_6LO_FLOW_CACHE_SIZE; i++) {
+		flow = &tx_flows.flows[i];
+
+		if (!flow_match(flow, pkt) || !flow_hdr_match(flow, ipv6, udp)) {
+			continue;
+		}
+
+		memcpy(IPHC, flow->iphc, flow->iphc_len);
+		offset = flow->iphc_len;
+		break;
+	}
+
+	k_mutex_unlock(&flow_lock);
+
+	if (offset && udp) {
+		/* The checksum is all that differs in the UDP NHC */
+		memcpy(&IPHC[offset], &udp->chksum, 2);
+		offset += 2U;
+	}
+
+	return offset;
+}
+
+/* Copy the IPv6 and UDP headers of a received flow into frag, if it is
+ * given, returns the length of the IPHC header without the UDP checksum
+ * or 0 if the flow is not cached.
+ */
+static u8_t flow_uncompress(struct net_pkt *pkt, struct net_buf *frag,
+			    bool *is_udp, bool *chksum_elided)
+{
+	struct net_6lo_flow *flow;
+	u8_t offset = 0U;
+	int i;
+
+	k_mutex_lock(&flow_lock, K_FOREVER);
+
+	for (i = 0; i < CONFIG_NET_6LO_FLOW_CACHE_SIZE; i++) {
+		flow = &rx_flows.flows[i];
+
+		/* IPHC headers are self-delimiting, a packet starting with
+		 * the IPHC header of a flow belongs to it.
+		 */
+		if (!flow_match(flow, pkt) ||
+		    pkt->frags->len < flow->iphc_len ||
+		    memcmp(CIPHC, flow->iphc, flow->iphc_len)) {
+			continue;
+		}
+
+		if (frag) {
+			memcpy(net_buf_add(frag, NET_IPV6H_LEN), &flow->ipv6,
+			       NET_IPV6H_LEN);
+
+			if (flow->is_udp) {
+				memcpy(net_buf_add(frag, NET_UDPH_LEN),
+				       &flow->udp, NET_UDPH_LEN);
+			}
+		}
+
+		*is_udp = flow->is_udp;
+		*chksum_elided = flow->chksum_elided;
+		offset = flow->iphc_len;
+		break;
+	}
+
+	k_mutex_unlock(&flow_lock);
+
+	return offset;
+}
+
+static struct net_6lo_flow *flow_alloc(struct net_6lo_flow_cache *cache)
+{
+	struct net_6lo_flow *flow;
+	int i;
+
+	for (i = 0; i < CONFIG_NET_6LO_FLOW_CACHE_SIZE; i++) {
+		if (!cache->flows[i].is_used) {
+			return &cache->flows[i];
+		}
+	}
+
+	flow = &cache->flows[cache->next];
+	cache->next = (cache->next + 1) % CONFIG_NET_6LO_FLOW_CACHE_SIZE;
+
+	return flow;
+}
+
+static inline u8_t flow_lladdr_set(u8_t *addr, struct net_linkaddr *lladdr)
+{
+	if (!lladdr->addr) {
+		return 0U;
+	}
+
+	memcpy(addr, lladdr->addr, lladdr->len);
+
+	return lladdr->len;
+}
+
+static void flow_add(struct net_6lo_flow_cache *cache, struct net_pkt *pkt,
+		     struct net_ipv6_hdr *ipv6, struct net_udp_hdr *udp,
+		     u8_t *iphc, u8_t iphc_len, bool chksum_elided)
+{
+	struct net_linkaddr *src = net_pkt_lladdr_src(pkt);
+	struct net_linkaddr *dst = net_pkt_lladdr_dst(pkt);
+	struct net_6lo_flow *flow;
+
+	if (iphc_len > NET_6LO_FLOW_IPHC_MAX_LEN ||
+	    (src->addr && src->len > NET_LINK_ADDR_MAX_LENGTH) ||
+	    (dst->addr && dst->len > NET_LINK_ADDR_MAX_LENGTH)) {
+		return;
+	}
+
+	k_mutex_lock(&flow_lock, K_FOREVER);
+
+	flow = flow_alloc(cache);
+
+	flow->iface = net_pkt_iface(pkt);
+	flow->lladdr_src_len = flow_lladdr_set(flow->lladdr_src, src);
+	flow->lladdr_dst_len = flow_lladdr_set(flow->lladdr_dst, dst);
+
+	memcpy(&flow->ipv6, ipv6, NET_IPV6H_LEN);
+	flow->ipv6.len = 0U;
+
+	if (udp) {
+		memcpy(&flow->udp, udp, NET_UDPH_LEN);
+		flow->udp.len = 0U;
+		flow->udp.chksum = 0U;
+	}
+
+	memcpy(flow->iphc, iphc, iphc_len);
+	flow->iphc_len = iphc_len;
+
+	flow->is_udp = !!udp;
+	flow->chksum_elided = chksum_elided;
+	flow->is_used = true;
+
+	k_mutex_unlock(&flow_lock);
+}
+
+static void flow_flush(void)
+{
+	k_mutex_lock(&flow_lock, K_FOREVER);
+
+	(void)memset(&tx_flows, 0, sizeof(tx_flows));
+	(void)memset(&rx_flows, 0, sizeof(rx_flows));
+
+	k_mutex_unlock(&flow_lock);
+}
+#else
+#define flow_compress(...) 0U
+#define flow_uncompress(...) 0U
+#define flow_add(...)
+#define flow_flush(...)
+#endif
+
 #if defined(CONFIG_NET_6LO_CONTEXT)
 /* RFC 6775, 4.2, 5.4.2, 5.4.3 and 7.2*/
 static inline void set_6lo_context(struct net_if *iface, u8_t index,
@@ -107,6 +356,9 @@ void net_6lo_set_context(struct net_if *iface,
 	int unused = -1;
 	u8_t i;
 
+	/* The cached flows may have been compressed with the old contexts */
+	flow_flush();
+
 	/* If the context information already exists, update or remove
 	 * as per data.
 	 */
@@ -674,34 +926,16 @@ static inline bool is_src_and_dst_addr_ctx_based(struct net_ipv6_hdr *ipv6,
  * | 0 | 1 | 1 |  TF   |NH | HLIM  |CID|SAC|  SAM  | M |DAC|  DAM  |
  * +---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+---+
  */
-static inline int compress_IPHC_header(struct net_pkt *pkt)
+static inline u8_t compress_IPHC_fields(struct net_pkt *pkt,
+					struct net_ipv6_hdr *ipv6,
+					struct net_udp_hdr *udp,
+					struct net_buf *frag)
 {
 #if defined(CONFIG_NET_6LO_CONTEXT)
 	struct net_6lo_context *src = NULL;
 	struct net_6lo_context *dst = NULL;
 #endif
-	struct net_ipv6_hdr *ipv6 = NET_IPV6_HDR(pkt);
 	u8_t offset = 0U;
-	struct net_buf *frag;
-	u8_t compressed;
-
-	if (pkt->frags->len < NET_IPV6H_LEN) {
-		NET_ERR("Invalid length %d, min %d",
-			pkt->frags->len, NET_IPV6H_LEN);
-		return -EINVAL;
-	}
-
-	if (ipv6->nexthdr == IPPROTO_UDP &&
-	    pkt->frags->len < NET_IPV6UDPH_LEN) {
-		NET_ERR("Invalid length %d, min %d",
-			pkt->frags->len, NET_IPV6UDPH_LEN);
-		return -EINVAL;
-	}
-
-	frag = net_pkt_get_frag(pkt, K_FOREVER);
-	if (!frag) {
-		return -ENOBUFS;
-	}
 
 	IPHC[offset++] = NET_6LO_DISPATCH_IPHC;
 	IPHC[offset++] = 0;
@@ -728,8 +962,7 @@ static inline int compress_IPHC_header(struct net_pkt *pkt)
 	offset = compress_sa(ipv6, pkt, frag, offset);
 #endif
 	if (!offset) {
-		net_pkt_frag_unref(frag);
-		return -EFAULT;
+		return 0;
 	}
 
 	/* Destination Address Compression */
@@ -738,38 +971,72 @@ static inline int compress_IPHC_header(struct net_pkt *pkt)
 #else
 	offset = compress_da(ipv6, pkt, frag, offset);
 #endif
-
 	if (!offset) {
-		net_pkt_frag_unref(frag);
-		return -EFAULT;
+		return 0;
 	}
 
-	compressed = NET_IPV6H_LEN;
-
-	if (ipv6->nexthdr != IPPROTO_UDP) {
+	if (!udp) {
 		NET_DBG("next header is not UDP (%u)", ipv6->nexthdr);
-		goto end;
+		return offset;
 	}
 
 	/* UDP header compression */
-	if (IS_ENABLED(CONFIG_NET_UDP)) {
-		struct net_udp_hdr hdr, *udp;
+	IPHC[offset] = NET_6LO_NHC_UDP_BARE;
+
+	return compress_nh_udp(udp, frag, offset);
+}
+
+static inline int compress_IPHC_header(struct net_pkt *pkt)
+{
+	struct net_ipv6_hdr *ipv6 = NET_IPV6_HDR(pkt);
+	struct net_udp_hdr hdr, *udp = NULL;
+	struct net_buf *frag;
+	u8_t compressed;
+	u8_t offset;
+
+	if (pkt->frags->len < NET_IPV6H_LEN) {
+		NET_ERR("Invalid length %d, min %d",
+			pkt->frags->len, NET_IPV6H_LEN);
+		return -EINVAL;
+	}
+
+	if (ipv6->nexthdr == IPPROTO_UDP &&
+	    pkt->frags->len < NET_IPV6UDPH_LEN) {
+		NET_ERR("Invalid length %d, min %d",
+			pkt->frags->len, NET_IPV6UDPH_LEN);
+		return -EINVAL;
+	}
+
+	compressed = NET_IPV6H_LEN;
 
+	if (IS_ENABLED(CONFIG_NET_UDP) && ipv6->nexthdr == IPPROTO_UDP) {
 		udp = net_udp_get_hdr(pkt, &hdr);
 		if (!udp) {
 			NET_ERR("could not get UDP header");
 			return -EINVAL;
 		}
 
-		IPHC[offset] = NET_6LO_NHC_UDP_BARE;
-		offset = compress_nh_udp(udp, frag, offset);
-
 		compressed += NET_UDPH_LEN;
+	}
 
-		net_udp_set_hdr(pkt, udp);
+	frag = net_pkt_get_frag(pkt, K_FOREVER);
+	if (!frag) {
+		return -ENOBUFS;
+	}
+
+	offset = flow_compress(pkt, ipv6, udp, frag);
+	if (!offset) {
+		offset = compress_IPHC_fields(pkt, ipv6, udp, frag);
+		if (!offset) {
+			net_pkt_frag_unref(frag);
+			return -EFAULT;
+		}
+
+		/* Later packets of the flow only need their UDP checksum */
+		flow_add(&tx_flows, pkt, ipv6, udp, IPHC,
+			 udp ? offset - 2U : offset, false);
 	}
 
-end:
 	net_buf_add(frag, offset);
 
 	/* Copy the rest of the data to compressed fragment */
@@ -1316,10 +1583,13 @@ static bool uncompress_IPHC_header(struct net_pkt *pkt,
 				   bool dry_run, int *diff)
 {
 	struct net_udp_hdr *udp = NULL;
-	u8_t offset = 2U;
+	u8_t offset;
 	u8_t chksum = 0U;
 	struct net_buf *frag = NULL;
 	struct net_ipv6_hdr *ipv6;
+	bool cached = false;
+	bool is_udp = false;
+	bool elided = false;
 	u16_t len;
 #if defined(CONFIG_NET_6LO_CONTEXT)
 	struct net_6lo_context *src = NULL;
@@ -1330,16 +1600,6 @@ static bool uncompress_IPHC_header(struct net_pkt *pkt,
 		return false;
 	}
 
-	if (CIPHC[1] & NET_6LO_IPHC_CID_1) {
-#if defined(CONFIG_NET_6LO_CONTEXT)
-		uncompress_cid(pkt, &src, &dst);
-		offset++;
-#else
-		NET_WARN("Context based uncompression not enabled");
-		return false;
-#endif
-	}
-
 	if (!dry_run) {
 		frag = net_pkt_get_frag(pkt, NET_6LO_RX_PKT_TIMEOUT);
 		if (!frag) {
@@ -1354,6 +1614,50 @@ static bool uncompress_IPHC_header(struct net_pkt *pkt,
 		ipv6 = (struct net_ipv6_hdr *)(pkt->buffer->data);
 	}
 
+	/* Packets of a known flow only need their UDP checksum */
+	offset = flow_uncompress(pkt, frag, &is_udp, &elided);
+	if (offset) {
+		cached = true;
+
+		if (!dry_run) {
+			net_pkt_set_ip_hdr_len(pkt, NET_IPV6H_LEN);
+		} else {
+			*diff = is_udp ? NET_IPV6UDPH_LEN : NET_IPV6H_LEN;
+		}
+
+		if (!is_udp) {
+			goto end;
+		}
+
+		if (!dry_run) {
+			udp = (struct net_udp_hdr *)(frag->data +
+						     NET_IPV6H_LEN);
+		}
+
+		chksum = elided;
+		if (!chksum) {
+			if (!dry_run) {
+				memcpy(&udp->chksum, &CIPHC[offset], 2);
+			}
+
+			offset += 2U;
+		}
+
+		goto end;
+	}
+
+	offset = 2U;
+
+	if (CIPHC[1] & NET_6LO_IPHC_CID_1) {
+#if defined(CONFIG_NET_6LO_CONTEXT)
+		uncompress_cid(pkt, &src, &dst);
+		offset++;
+#else
+		NET_WARN("Context based uncompression not enabled");
+		goto fail;
+#endif
+	}
+
 	/* Version is always 6 */
 	if (!dry_run) {
 		ipv6->vtc = 0x60;
@@ -1484,6 +1788,11 @@ end:
 		return true;
 	}
 
+	if (!cached) {
+		flow_add(&rx_flows, pkt, ipv6, udp, CIPHC,
+			 (udp && !chksum) ? offset - 2U : offset, chksum != 0U);
+	}
+
 	/* Move the data to beginning, no need for headers now */
 	NET_DBG("Removing %u bytes of compressed hdr", offset);
 	memmove(pkt->frags->data, pkt->frags->data + offset,
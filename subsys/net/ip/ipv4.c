@@ -197,6 +197,16 @@ enum net_verdict net_ipv4_input(struct net_pkt *pkt)
 		log_strdup(net_sprint_ipv4_addr(&hdr->src)),
 		log_strdup(net_sprint_ipv4_addr(&hdr->dst)));
 
+	if ((hdr->offset[0] << 8 | hdr->offset[1]) &
+	    (NET_IPV4_MORE_FRAG_MASK | NET_IPV4_FRAGH_OFFSET_MASK)) {
+		if (IS_ENABLED(CONFIG_NET_IPV4_FRAGMENT)) {
+			return net_ipv4_handle_fragment_hdr(pkt, hdr);
+		}
+
+		NET_DBG("DROP: fragmented packet");
+		goto drop;
+	}
+
 	switch (hdr->proto) {
 	case IPPROTO_ICMP:
 		verdict = net_icmpv4_input(pkt, hdr);
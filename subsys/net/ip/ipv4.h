@@ -20,8 +20,15 @@
 #include <net/net_if.h>
 #include <net/net_context.h>
 
+#include "reassembly.h"
+
 #define NET_IPV4_IHL_MASK 0x0F
 
+/* Flags and fragment offset field of the IPv4 header */
+#define NET_IPV4_DO_NOT_FRAG_MASK  0x4000
+#define NET_IPV4_MORE_FRAG_MASK    0x2000
+#define NET_IPV4_FRAGH_OFFSET_MASK 0x1fff
+
 /**
  * @brief Create IPv4 packet in provided net_pkt.
  *
@@ -48,4 +55,67 @@ int net_ipv4_create(struct net_pkt *pkt,
  */
 int net_ipv4_finalize(struct net_pkt *pkt, u8_t next_header_proto);
 
+/**
+ * @typedef net_ipv4_frag_cb_t
+ * @brief Callback used while iterating over pending IPv4 fragments.
+ *
+ * @param reass IPv4 fragment reassembly struct
+ * @param user_data A valid pointer on some user data or NULL
+ */
+typedef net_reass_cb_t net_ipv4_frag_cb_t;
+
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+/**
+ * @brief Handles IPv4 fragmented packets.
+ *
+ * @param pkt Network head packet.
+ * @param hdr The IPv4 header of the current packet
+ *
+ * @return Return verdict about the packet
+ */
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr);
+
+/**
+ * @brief Fragment the packet if it is larger than the MTU of the
+ * network interface. The fragments are sent separately and the
+ * original packet is released.
+ *
+ * @param pkt Network packet
+ *
+ * @return NET_OK if the packet can be sent as is, NET_CONTINUE if it
+ * was fragmented and NET_DROP on error.
+ */
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt);
+
+/**
+ * @brief Go through all the currently pending IPv4 fragments.
+ *
+ * @param cb Callback to call for each pending IPv4 fragment.
+ * @param user_data User specified data or NULL.
+ */
+void net_ipv4_frag_foreach(net_ipv4_frag_cb_t cb, void *user_data);
+
+void net_ipv4_frag_init(void);
+#else
+static inline
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(hdr);
+
+	return NET_DROP;
+}
+
+static inline enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return NET_OK;
+}
+
+#define net_ipv4_frag_init(...)
+#endif /* CONFIG_NET_IPV4_FRAGMENT */
+
 #endif /* __IPV4_H */
@@ -0,0 +1,290 @@
+/** @file
+ * @brief IPv4 Fragment related functions
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_ipv4, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <errno.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_stats.h>
+#include <net/net_context.h>
+#include "net_private.h"
+#include "ipv4.h"
+#include "reassembly.h"
+#include "net_stats.h"
+
+#define IPV4_REASSEMBLY_TIMEOUT K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT)
+
+#define BUF_ALLOC_TIMEOUT K_MSEC(100)
+
+NET_REASS_TABLE_DEFINE(reassembly, CONFIG_NET_IPV4_FRAGMENT_MAX_COUNT,
+		       IPV4_REASSEMBLY_TIMEOUT);
+
+static u16_t ipv4_frag_field(struct net_ipv4_hdr *hdr)
+{
+	return hdr->offset[0] << 8 | hdr->offset[1];
+}
+
+static void ipv4_set_frag_field(struct net_ipv4_hdr *hdr, u16_t value)
+{
+	hdr->offset[0] = value >> 8;
+	hdr->offset[1] = value;
+}
+
+static void reassemble_packet(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+
+	/* The payload of the other fragments is already linked to the
+	 * first one, only its header needs to be fixed.
+	 */
+	net_pkt_cursor_init(pkt);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!hdr) {
+		goto error;
+	}
+
+	hdr->len = htons(net_pkt_get_len(pkt));
+	ipv4_set_frag_field(hdr, 0U);
+
+	/* The header is verified again when the packet is fed back */
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+
+	net_pkt_set_data(pkt, &ipv4_access);
+
+	net_pkt_set_ip_reassembled(pkt, true);
+
+	NET_DBG("New pkt %p IPv4 len is %zd bytes", pkt,
+		net_pkt_get_len(pkt));
+
+	/* Use the queue when feeding the packet back into the IP stack,
+	 * see the IPv6 reassembly for the details.
+	 */
+	if (net_recv_data(net_pkt_iface(pkt), pkt) >= 0) {
+		return;
+	}
+error:
+	net_pkt_unref(pkt);
+}
+
+void net_ipv4_frag_foreach(net_ipv4_frag_cb_t cb, void *user_data)
+{
+	net_reass_foreach(&reassembly, cb, user_data);
+}
+
+void net_ipv4_frag_init(void)
+{
+	net_reass_init(&reassembly);
+}
+
+enum net_verdict net_ipv4_handle_fragment_hdr(struct net_pkt *pkt,
+					      struct net_ipv4_hdr *hdr)
+{
+	u16_t flag = ipv4_frag_field(hdr);
+	u8_t hdr_len = net_pkt_ip_hdr_len(pkt);
+	struct net_pkt *reassembled;
+	struct net_addr src, dst;
+	u32_t id;
+	int ret;
+
+	if ((flag & NET_IPV4_MORE_FRAG_MASK) &&
+	    (net_pkt_get_len(pkt) - hdr_len) % 8) {
+		NET_DBG("DROP: fragment length not multiple of 8");
+		goto drop;
+	}
+
+	src.family = AF_INET;
+	net_ipaddr_copy(&src.in_addr, &hdr->src);
+	dst.family = AF_INET;
+	net_ipaddr_copy(&dst.in_addr, &hdr->dst);
+
+	/* The fragments are identified also by the protocol (RFC 791) */
+	id = (u32_t)hdr->proto << 16 | hdr->id[0] << 8 | hdr->id[1];
+
+	ret = net_reass_add(&reassembly, pkt, id, &src, &dst, hdr_len,
+			    (flag & NET_IPV4_FRAGH_OFFSET_MASK) * 8U,
+			    flag & NET_IPV4_MORE_FRAG_MASK, &reassembled);
+	if (ret < 0) {
+		NET_DBG("Cannot add pkt %p to reassembly of id 0x%x (%d)",
+			pkt, id, ret);
+		goto drop;
+	}
+
+	if (reassembled) {
+		/* The last missing fragment received */
+		reassemble_packet(reassembled);
+	}
+
+	return NET_OK;
+
+drop:
+	net_stats_update_ipv4_drop(net_pkt_iface(pkt));
+	return NET_DROP;
+}
+
+static int send_ipv4_fragment(struct net_pkt *pkt, u16_t hdr_len,
+			      u16_t fit_len, u16_t frag_offset, bool final)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	struct net_ipv4_hdr *hdr;
+	struct net_pkt *frag_pkt;
+	int ret = -ENOBUFS;
+
+	frag_pkt = net_pkt_alloc_with_buffer(net_pkt_iface(pkt),
+					     hdr_len - NET_IPV4H_LEN + fit_len,
+					     AF_INET, 0, BUF_ALLOC_TIMEOUT);
+	if (!frag_pkt) {
+		return -ENOMEM;
+	}
+
+	/* The header, options included, is copied to every fragment
+	 * followed by the payload part of this fragment.
+	 */
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_copy(frag_pkt, pkt, hdr_len) ||
+	    net_pkt_skip(pkt, frag_offset) ||
+	    net_pkt_copy(frag_pkt, pkt, fit_len)) {
+		goto fail;
+	}
+
+	net_pkt_cursor_init(frag_pkt);
+	net_pkt_set_overwrite(frag_pkt, true);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(frag_pkt, &ipv4_access);
+	if (!hdr) {
+		goto fail;
+	}
+
+	hdr->len = htons(hdr_len + fit_len);
+	ipv4_set_frag_field(hdr, (final ? 0 : NET_IPV4_MORE_FRAG_MASK) |
+			    frag_offset / 8U);
+
+	net_pkt_set_ip_hdr_len(frag_pkt, hdr_len);
+	net_pkt_set_ipv4_ttl(frag_pkt, net_pkt_ipv4_ttl(pkt));
+
+	hdr->chksum = 0U;
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(frag_pkt))) {
+		hdr->chksum = net_calc_chksum_ipv4(frag_pkt);
+	}
+
+	net_pkt_set_data(frag_pkt, &ipv4_access);
+
+	ret = net_send_data(frag_pkt);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	/* Let this packet to be sent and hopefully it will release
+	 * the memory that can be utilized for next sent IPv4 fragment.
+	 */
+	k_yield();
+
+	return 0;
+
+fail:
+	NET_DBG("Cannot send fragment (%d)", ret);
+	net_pkt_unref(frag_pkt);
+
+	return ret;
+}
+
+static int ipv4_send_fragmented_pkt(struct net_pkt *pkt, u16_t mtu)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+	u16_t hdr_len = net_pkt_ip_hdr_len(pkt);
+	struct net_ipv4_hdr *hdr;
+	u16_t frag_offset = 0U;
+	u16_t fit_len;
+	size_t length;
+	u16_t id;
+	int ret;
+
+	/* The payload of all but the last fragment must be a multiple
+	 * of 8 bytes.
+	 */
+	if (mtu <= hdr_len + 8) {
+		return -EINVAL;
+	}
+
+	fit_len = (mtu - hdr_len) & ~7;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ipv4_access);
+	if (!hdr) {
+		return -ENOBUFS;
+	}
+
+	if (ipv4_frag_field(hdr) & NET_IPV4_DO_NOT_FRAG_MASK) {
+		return -EMSGSIZE;
+	}
+
+	id = sys_rand32_get();
+	hdr->id[0] = id >> 8;
+	hdr->id[1] = id;
+
+	net_pkt_set_data(pkt, &ipv4_access);
+
+	length = net_pkt_get_len(pkt) - hdr_len;
+	while (length) {
+		bool final = false;
+
+		if (fit_len >= length) {
+			final = true;
+			fit_len = length;
+		}
+
+		ret = send_ipv4_fragment(pkt, hdr_len, fit_len, frag_offset,
+					 final);
+		if (ret < 0) {
+			return ret;
+		}
+
+		length -= fit_len;
+		frag_offset += fit_len;
+	}
+
+	return 0;
+}
+
+enum net_verdict net_ipv4_prepare_for_send(struct net_pkt *pkt)
+{
+	u16_t mtu = net_if_get_mtu(net_pkt_iface(pkt));
+	int ret;
+
+	if (!mtu || net_pkt_get_len(pkt) <= mtu) {
+		return NET_OK;
+	}
+
+	ret = ipv4_send_fragmented_pkt(pkt, mtu);
+	if (ret < 0) {
+		NET_DBG("Cannot fragment IPv4 pkt (%d)", ret);
+		return NET_DROP;
+	}
+
+	/* We "fake" the sending of the packet here so that
+	 * tcp.c:tcp_retry_expired() will increase the ref count when
+	 * re-sending the packet, see the IPv6 fragmentation.
+	 */
+	if (IS_ENABLED(CONFIG_NET_TCP)) {
+		net_pkt_set_sent(pkt, true);
+	}
+
+	/* The fragments have been sent separately to the network */
+	net_pkt_unref(pkt);
+
+	return NET_CONTINUE;
+}
@@ -479,8 +479,12 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback)
 
 		case NET_IPV6_NEXTHDR_FRAG:
 			if (IS_ENABLED(CONFIG_NET_IPV6_FRAGMENT)) {
+				/* The next header field of the fragment
+				 * header has already been read.
+				 */
 				net_pkt_set_ipv6_fragment_start(
-					pkt, net_pkt_get_current_offset(pkt));
+					pkt,
+					net_pkt_get_current_offset(pkt) - 1);
 				return net_ipv6_handle_fragment_hdr(pkt, hdr,
 								    nexthdr);
 			}
@@ -561,6 +565,7 @@ bad_hdr:
 void net_ipv6_init(void)
 {
 	net_ipv6_nbr_init();
+	net_ipv6_frag_init();
 
 #if defined(CONFIG_NET_IPV6_MLD)
 	net_ipv6_mld_init();
@@ -22,6 +22,8 @@
 
 #include "icmpv6.h"
 #include "nbr.h"
+#include "nbr_hash.h"
+#include "reassembly.h"
 
 #define NET_IPV6_ND_HOP_LIMIT 255
 #define NET_IPV6_ND_INFINITE_LIFETIME 0xFFFFFFFF
@@ -107,11 +109,11 @@ struct net_ipv6_nbr_data {
 	/** Is the neighbor a router */
 	bool is_router;
 
-#if defined(CONFIG_NET_IPV6_NBR_CACHE) || defined(CONFIG_NET_IPV6_ND)
-	/** Stale counter used to removed oldest nbr in STALE state,
-	 *  when table is full.
+#if defined(CONFIG_NET_IPV6_NBR_CACHE)
+	/** Link in the neighbor cache index, also used to remove the
+	 *  least recently used nbr in STALE state when table is full.
 	 */
-	u32_t stale_counter;
+	struct net_nbr_hash_node hash;
 #endif
 };
 
@@ -359,35 +361,6 @@ static inline void net_ipv6_nbr_set_reachable_timer(struct net_if *iface,
 }
 #endif
 
-/* We do not have to accept larger than 1500 byte IPv6 packet (RFC 2460 ch 5).
- * This means that we should receive everything within first two fragments.
- * The first one being 1280 bytes and the second one 220 bytes.
- */
-#if !defined(NET_IPV6_FRAGMENTS_MAX_PKT)
-#define NET_IPV6_FRAGMENTS_MAX_PKT 2
-#endif
-
-/** Store pending IPv6 fragment information that is needed for reassembly. */
-struct net_ipv6_reassembly {
-	/** IPv6 source address of the fragment */
-	struct in6_addr src;
-
-	/** IPv6 destination address of the fragment */
-	struct in6_addr dst;
-
-	/**
-	 * Timeout for cancelling the reassembly. The timer is used
-	 * also to detect if this reassembly slot is used or not.
-	 */
-	struct k_delayed_work timer;
-
-	/** Pointers to pending fragments */
-	struct net_pkt *pkt[NET_IPV6_FRAGMENTS_MAX_PKT];
-
-	/** IPv6 fragment identification */
-	u32_t id;
-};
-
 /**
  * @typedef net_ipv6_frag_cb_t
  * @brief Callback used while iterating over pending IPv6 fragments.
@@ -395,8 +368,7 @@ struct net_ipv6_reassembly {
  * @param reass IPv6 fragment reassembly struct
  * @param user_data A valid pointer on some user data or NULL
  */
-typedef void (*net_ipv6_frag_cb_t)(struct net_ipv6_reassembly *reass,
-				   void *user_data);
+typedef net_reass_cb_t net_ipv6_frag_cb_t;
 
 /**
  * @brief Go through all the currently pending IPv6 fragments.
@@ -447,6 +419,12 @@ enum net_verdict net_ipv6_handle_fragment_hdr(struct net_pkt *pkt,
 }
 #endif /* CONFIG_NET_IPV6_FRAGMENT */
 
+#if defined(CONFIG_NET_IPV6_FRAGMENT)
+void net_ipv6_frag_init(void);
+#else
+#define net_ipv6_frag_init(...)
+#endif
+
 #if defined(CONFIG_NET_IPV6)
 void net_ipv6_init(void);
 void net_ipv6_nbr_init(void);
@@ -53,15 +53,14 @@ LOG_MODULE_DECLARE(net_ipv6, CONFIG_NET_IPV6_LOG_LEVEL);
 #define MIN_IPV6_MTU NET_IPV6_MTU
 #define MAX_IPV6_MTU 0xffff
 
-#if defined(CONFIG_NET_IPV6_NBR_CACHE) || defined(CONFIG_NET_IPV6_ND)
-/* Global stale counter, whenever ipv6 neighbor enters into
- * stale state, stale counter is incremented by one.
- * When network stack tries to add new neighbor and if table
- * is full, oldest (oldest stale counter) neighbor in stale
- * state will be removed from the table and new entry will be
+#if defined(CONFIG_NET_IPV6_NBR_CACHE)
+/* Neighbors are indexed by IPv6 address. The index also keeps them
+ * in least recently used order: when network stack tries to add new
+ * neighbor and if table is full, the least recently used neighbor in
+ * stale state will be removed from the table and new entry will be
  * added.
  */
-static u32_t stale_counter;
+NET_NBR_HASH_DEFINE(nbr_index, CONFIG_NET_IPV6_MAX_NEIGHBORS);
 
 static struct k_sem nbr_lock;
 #endif
@@ -150,43 +149,6 @@ static void ipv6_nbr_set_state(struct net_nbr *nbr,
 		net_ipv6_nbr_state2str(new_state));
 
 	net_ipv6_nbr_data(nbr)->state = new_state;
-
-	if (net_ipv6_nbr_data(nbr)->state == NET_IPV6_NBR_STATE_STALE) {
-		if (stale_counter + 1 != UINT32_MAX) {
-			net_ipv6_nbr_data(nbr)->stale_counter = stale_counter++;
-		} else {
-			/* Global stale counter reached UINT32_MAX, reset it and
-			 * respective neighbors stale counter too.
-			 */
-			struct net_nbr *n = NULL;
-			struct net_ipv6_nbr_data *data = NULL;
-			int i;
-
-			k_sem_take(&nbr_lock, K_FOREVER);
-
-			stale_counter = 0U;
-
-			for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-				n = get_nbr(i);
-				if (!n || !n->ref) {
-					continue;
-				}
-
-				data = net_ipv6_nbr_data(nbr);
-				if (!data) {
-					continue;
-				}
-
-				if (data->state != NET_IPV6_NBR_STATE_STALE) {
-					continue;
-				}
-
-				data->stale_counter = stale_counter++;
-			}
-
-			k_sem_give(&nbr_lock);
-		}
-	}
 }
 
 struct iface_cb_data {
@@ -255,28 +217,41 @@ void nbr_print(void)
 #define nbr_print(...)
 #endif
 
+static inline struct net_nbr *nbr_from_data(struct net_ipv6_nbr_data *data)
+{
+	return CONTAINER_OF((u8_t *)data, struct net_nbr, __nbr);
+}
+
 static struct net_nbr *nbr_lookup(struct net_nbr_table *table,
 				  struct net_if *iface,
 				  struct in6_addr *addr)
 {
-	int i;
+	u32_t hash = net_hash_fnv1a(NET_HASH_FNV1A_INIT, addr,
+				    sizeof(struct in6_addr));
+	struct net_nbr_hash_node *node;
+	struct net_ipv6_nbr_data *data;
+	struct net_nbr *nbr;
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-		struct net_nbr *nbr = get_nbr(i);
+	k_sem_take(&nbr_lock, K_FOREVER);
 
-		if (!nbr->ref) {
-			continue;
-		}
+	NET_NBR_HASH_FOR_EACH(&nbr_index, hash, node) {
+		data = CONTAINER_OF(node, struct net_ipv6_nbr_data, hash);
+		nbr = nbr_from_data(data);
 
 		if (iface && nbr->iface != iface) {
 			continue;
 		}
 
-		if (net_ipv6_addr_cmp(&net_ipv6_nbr_data(nbr)->addr, addr)) {
+		if (net_ipv6_addr_cmp(&data->addr, addr)) {
+			net_nbr_hash_touch(&nbr_index, node);
+			k_sem_give(&nbr_lock);
+
 			return nbr;
 		}
 	}
 
+	k_sem_give(&nbr_lock);
+
 	return NULL;
 }
 
@@ -431,6 +406,12 @@ static struct net_nbr *nbr_new(struct net_if *iface,
 
 	nbr_init(nbr, iface, addr, is_router, state);
 
+	k_sem_take(&nbr_lock, K_FOREVER);
+	net_nbr_hash_add(&nbr_index, &net_ipv6_nbr_data(nbr)->hash,
+			 net_hash_fnv1a(NET_HASH_FNV1A_INIT, addr,
+					sizeof(struct in6_addr)));
+	k_sem_give(&nbr_lock);
+
 	NET_DBG("nbr %p iface %p state %d IPv6 %s",
 		nbr, iface, state,
 		log_strdup(net_sprint_ipv6_addr(addr)));
@@ -496,51 +477,34 @@ static void dbg_update_neighbor_lladdr_raw(u8_t *new_lladdr,
 
 static void ipv6_nd_remove_old_stale_nbr(void)
 {
-	struct net_nbr *nbr = NULL;
-	struct net_ipv6_nbr_data *data = NULL;
-	int nbr_idx = -1;
-	u32_t oldest;
-	int i;
+	struct net_nbr_hash_node *node;
+	struct net_ipv6_nbr_data *data;
+	struct net_if *iface = NULL;
+	struct in6_addr addr;
 
 	k_sem_take(&nbr_lock, K_FOREVER);
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-		nbr = get_nbr(i);
-		if (!nbr || !nbr->ref) {
-			continue;
-		}
-
-		data = net_ipv6_nbr_data(nbr);
-		if (!data || data->is_router ||
+	/* Neighbors in use keep moving to the front of the LRU list,
+	 * so the walk from its back normally stops after a few entries.
+	 */
+	for (node = net_nbr_hash_oldest(&nbr_index); node;
+	     node = net_nbr_hash_older(&nbr_index, node)) {
+		data = CONTAINER_OF(node, struct net_ipv6_nbr_data, hash);
+		if (data->is_router ||
 		    data->state != NET_IPV6_NBR_STATE_STALE) {
 			continue;
 		}
 
-		if (nbr_idx == -1) {
-			nbr_idx = i;
-			oldest = data->stale_counter;
-			continue;
-		}
-
-		if (oldest == MIN(oldest, data->stale_counter)) {
-			continue;
-		}
-
-		nbr_idx = i;
-		oldest = data->stale_counter;
+		iface = nbr_from_data(data)->iface;
+		net_ipaddr_copy(&addr, &data->addr);
+		break;
 	}
 
-	if (nbr_idx != -1) {
-		nbr = get_nbr(nbr_idx);
-		if (!nbr) {
-			return;
-		}
+	k_sem_give(&nbr_lock);
 
-		net_ipv6_nbr_rm(nbr->iface,
-				&net_ipv6_nbr_data(nbr)->addr);
+	if (node) {
+		net_ipv6_nbr_rm(iface, &addr);
 	}
-
-	k_sem_give(&nbr_lock);
 }
 
 static struct net_nbr *add_nbr(struct net_if *iface,
@@ -647,7 +611,9 @@ void net_neighbor_data_remove(struct net_nbr *nbr)
 {
 	NET_DBG("Neighbor %p removed", nbr);
 
-	return;
+	k_sem_take(&nbr_lock, K_FOREVER);
+	net_nbr_hash_remove(&nbr_index, &net_ipv6_nbr_data(nbr)->hash);
+	k_sem_give(&nbr_lock);
 }
 
 void net_neighbor_table_clear(struct net_nbr_table *table)
@@ -2470,11 +2436,12 @@ void net_ipv6_nbr_init(void)
 	net_icmpv6_register_handler(&ns_input_handler);
 	net_icmpv6_register_handler(&na_input_handler);
 	k_delayed_work_init(&ipv6_ns_reply_timer, ipv6_ns_reply_timeout);
+	k_sem_init(&nbr_lock, 1, UINT_MAX);
+	net_nbr_hash_init(&nbr_index);
 #endif
 #if defined(CONFIG_NET_IPV6_ND)
 	net_icmpv6_register_handler(&ra_input_handler);
 	k_delayed_work_init(&ipv6_nd_reachable_timer,
 			    ipv6_nd_reachable_timeout);
-	k_sem_init(&nbr_lock, 1, UINT_MAX);
 #endif
 }
@@ -0,0 +1,375 @@
+/** @file
+ * @brief Longest prefix match table
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_lpm, CONFIG_NET_ROUTE_LOG_LEVEL);
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/types.h>
+#include <kernel.h>
+#include <misc/util.h>
+#include <net/net_core.h>
+
+#include "net_private.h"
+
+#include "lpm.h"
+
+static inline int key_bit(const u8_t *key, u8_t bit)
+{
+	return (key[bit / 8] >> (7 - (bit % 8))) & 1;
+}
+
+/* Number of leading bits, up to max, that a and b have in common */
+static u8_t common_len(const u8_t *a, const u8_t *b, u8_t max)
+{
+	u8_t len = 0U;
+	u8_t diff;
+
+	while (len < max) {
+		diff = a[len / 8] ^ b[len / 8];
+		if (diff == 0U) {
+			len += 8U;
+			continue;
+		}
+
+		while (!(diff & 0x80)) {
+			diff <<= 1;
+			len++;
+		}
+
+		break;
+	}
+
+	return MIN(len, max);
+}
+
+static inline bool prefix_match(const u8_t *key, struct net_lpm_node *node)
+{
+	return common_len(key, node->prefix, node->prefix_len) ==
+		node->prefix_len;
+}
+
+static void cache_flush(struct net_lpm *lpm)
+{
+	int i;
+
+	for (i = 0; i < lpm->cache_size; i++) {
+		lpm->cache[i].valid = false;
+	}
+}
+
+static struct net_lpm_cache *cache_slot(struct net_lpm *lpm, const u8_t *key,
+					const void *ctx)
+{
+	u32_t hash = NET_HASH_FNV1A_INIT ^ (u32_t)(uintptr_t)ctx;
+
+	hash = net_hash_fnv1a(hash, key, lpm->key_len);
+
+	return &lpm->cache[hash % lpm->cache_size];
+}
+
+static struct net_lpm_node *node_alloc(struct net_lpm *lpm, const u8_t *prefix,
+				       u8_t prefix_len)
+{
+	struct net_lpm_node *node = lpm->free_nodes;
+	u8_t bytes = (prefix_len + 7) / 8;
+
+	if (!node) {
+		return NULL;
+	}
+
+	lpm->free_nodes = node->child[0];
+
+	(void)memset(node, 0, sizeof(*node));
+
+	memcpy(node->prefix, prefix, bytes);
+	if (prefix_len % 8) {
+		node->prefix[bytes - 1] &= 0xff << (8 - (prefix_len % 8));
+	}
+
+	node->prefix_len = prefix_len;
+	sys_slist_init(&node->entries);
+
+	return node;
+}
+
+static void node_free(struct net_lpm *lpm, struct net_lpm_node *node)
+{
+	node->parent = NULL;
+	node->child[1] = NULL;
+	node->child[0] = lpm->free_nodes;
+	lpm->free_nodes = node;
+}
+
+/* Make new take the place of old in the trie */
+static void node_replace(struct net_lpm *lpm, struct net_lpm_node *old,
+			 struct net_lpm_node *new)
+{
+	struct net_lpm_node *parent = old->parent;
+
+	if (!parent) {
+		lpm->root = new;
+	} else if (parent->child[0] == old) {
+		parent->child[0] = new;
+	} else {
+		parent->child[1] = new;
+	}
+
+	if (new) {
+		new->parent = parent;
+	}
+}
+
+static struct net_lpm_entry *node_entry(struct net_lpm *lpm,
+					struct net_lpm_node *node,
+					const void *ctx)
+{
+	struct net_lpm_entry *entry;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&node->entries, entry, node) {
+		if (!lpm->match || lpm->match(entry, ctx)) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+void net_lpm_init(struct net_lpm *lpm)
+{
+	int i;
+
+	k_mutex_init(&lpm->lock);
+
+	lpm->root = NULL;
+	lpm->free_nodes = NULL;
+
+	for (i = 0; i < lpm->node_count; i++) {
+		node_free(lpm, &lpm->nodes[i]);
+	}
+
+	cache_flush(lpm);
+}
+
+static int lpm_add(struct net_lpm *lpm, struct net_lpm_entry *entry,
+		   const void *prefix, u8_t prefix_len)
+{
+	struct net_lpm_node *parent = NULL, *node = lpm->root;
+	struct net_lpm_node *new, *glue;
+	u8_t common = 0U;
+	int dir = 0;
+
+	NET_ASSERT(prefix_len <= lpm->key_len * 8);
+
+	/* Go down as long as the node prefixes are prefixes of the new
+	 * one.
+	 */
+	while (node) {
+		common = common_len(prefix, node->prefix,
+				    MIN(prefix_len, node->prefix_len));
+		if (common < node->prefix_len) {
+			break;
+		}
+
+		if (node->prefix_len == prefix_len) {
+			goto add;
+		}
+
+		parent = node;
+		dir = key_bit(prefix, node->prefix_len);
+		node = node->child[dir];
+	}
+
+	new = node_alloc(lpm, prefix, prefix_len);
+	if (!new) {
+		return -ENOMEM;
+	}
+
+	if (!node) {
+		/* New leaf */
+		new->parent = parent;
+
+		if (parent) {
+			parent->child[dir] = new;
+		} else {
+			lpm->root = new;
+		}
+	} else if (common == prefix_len) {
+		/* The new prefix is a prefix of the node one */
+		node_replace(lpm, node, new);
+		new->child[key_bit(node->prefix, prefix_len)] = node;
+		node->parent = new;
+	} else {
+		/* The prefixes diverge after common bits, they are both
+		 * put below an intermediate node.
+		 */
+		glue = node_alloc(lpm, prefix, common);
+		if (!glue) {
+			node_free(lpm, new);
+			return -ENOMEM;
+		}
+
+		node_replace(lpm, node, glue);
+		glue->child[key_bit(prefix, common)] = new;
+		glue->child[key_bit(node->prefix, common)] = node;
+		new->parent = glue;
+		node->parent = glue;
+	}
+
+	node = new;
+
+add:
+	entry->owner = node;
+	sys_slist_append(&node->entries, &entry->node);
+
+	cache_flush(lpm);
+
+	return 0;
+}
+
+static void lpm_del(struct net_lpm *lpm, struct net_lpm_entry *entry)
+{
+	struct net_lpm_node *node = entry->owner;
+	struct net_lpm_node *parent, *child;
+
+	if (!node) {
+		return;
+	}
+
+	sys_slist_find_and_remove(&node->entries, &entry->node);
+	entry->owner = NULL;
+
+	/* Remove the nodes which are not needed anymore: without entries
+	 * and with less than two children.
+	 */
+	while (node && sys_slist_is_empty(&node->entries) &&
+	       !(node->child[0] && node->child[1])) {
+		child = node->child[0] ? node->child[0] : node->child[1];
+		parent = node->parent;
+
+		node_replace(lpm, node, child);
+		node_free(lpm, node);
+
+		if (child) {
+			/* The parent has as many children as before */
+			break;
+		}
+
+		node = parent;
+	}
+
+	cache_flush(lpm);
+}
+
+static struct net_lpm_entry *lpm_lookup(struct net_lpm *lpm,
+					const void *key, const void *ctx)
+{
+	struct net_lpm_entry *found = NULL, *entry;
+	struct net_lpm_node *node = lpm->root;
+	struct net_lpm_cache *cache = NULL;
+	u8_t key_bits = lpm->key_len * 8;
+
+	if (lpm->cache_size) {
+		cache = cache_slot(lpm, key, ctx);
+		if (cache->valid && cache->ctx == ctx &&
+		    !memcmp(cache->key, key, lpm->key_len)) {
+			return cache->entry;
+		}
+	}
+
+	while (node && prefix_match(key, node)) {
+		if (!sys_slist_is_empty(&node->entries)) {
+			entry = node_entry(lpm, node, ctx);
+			if (entry) {
+				found = entry;
+			}
+		}
+
+		if (node->prefix_len == key_bits) {
+			break;
+		}
+
+		node = node->child[key_bit(key, node->prefix_len)];
+	}
+
+	if (cache) {
+		memcpy(cache->key, key, lpm->key_len);
+		cache->ctx = ctx;
+		cache->entry = found;
+		cache->valid = true;
+	}
+
+	return found;
+}
+
+static struct net_lpm_entry *lpm_find(struct net_lpm *lpm,
+				      const void *prefix, u8_t prefix_len,
+				      const void *ctx)
+{
+	struct net_lpm_node *node = lpm->root;
+
+	while (node && node->prefix_len <= prefix_len &&
+	       prefix_match(prefix, node)) {
+		if (node->prefix_len == prefix_len) {
+			return node_entry(lpm, node, ctx);
+		}
+
+		node = node->child[key_bit(prefix, node->prefix_len)];
+	}
+
+	return NULL;
+}
+
+/* Lookups update the cache, so they are serialized with the changes of
+ * the table by the lock of the table.
+ */
+int net_lpm_add(struct net_lpm *lpm, struct net_lpm_entry *entry,
+		const void *prefix, u8_t prefix_len)
+{
+	int ret;
+
+	k_mutex_lock(&lpm->lock, K_FOREVER);
+	ret = lpm_add(lpm, entry, prefix, prefix_len);
+	k_mutex_unlock(&lpm->lock);
+
+	return ret;
+}
+
+void net_lpm_del(struct net_lpm *lpm, struct net_lpm_entry *entry)
+{
+	k_mutex_lock(&lpm->lock, K_FOREVER);
+	lpm_del(lpm, entry);
+	k_mutex_unlock(&lpm->lock);
+}
+
+struct net_lpm_entry *net_lpm_lookup(struct net_lpm *lpm, const void *key,
+				     const void *ctx)
+{
+	struct net_lpm_entry *entry;
+
+	k_mutex_lock(&lpm->lock, K_FOREVER);
+	entry = lpm_lookup(lpm, key, ctx);
+	k_mutex_unlock(&lpm->lock);
+
+	return entry;
+}
+
+struct net_lpm_entry *net_lpm_find(struct net_lpm *lpm, const void *prefix,
+				   u8_t prefix_len, const void *ctx)
+{
+	struct net_lpm_entry *entry;
+
+	k_mutex_lock(&lpm->lock, K_FOREVER);
+	entry = lpm_find(lpm, prefix, prefix_len, ctx);
+	k_mutex_unlock(&lpm->lock);
+
+	return entry;
+}
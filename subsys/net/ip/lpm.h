@@ -0,0 +1,186 @@
+/** @file
+ * @brief Longest prefix match table
+ *
+ * This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __LPM_H
+#define __LPM_H
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <kernel.h>
+#include <misc/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The routing tables map IPv4 and IPv6 prefixes to routes with a path
+ * compressed binary trie (PATRICIA). A lookup walks down from the root
+ * and costs at most one node per bit of the address, whatever the number
+ * of routes. The last destinations looked up are also kept in a small
+ * cache which is flushed whenever the table changes.
+ */
+
+#define NET_LPM_MAX_KEY_LEN 16
+
+/**
+ * @brief Entry of a longest prefix match table, to be embedded in the
+ * route. Several entries can have the same prefix.
+ */
+struct net_lpm_entry {
+	/** Link in the list of entries of the prefix */
+	sys_snode_t node;
+
+	/** Trie node of the prefix */
+	struct net_lpm_node *owner;
+};
+
+struct net_lpm_node {
+	/** Parent node, NULL for the root */
+	struct net_lpm_node *parent;
+
+	/** Child nodes, by the value of the bit following the prefix.
+	 *  child[0] also links the free nodes.
+	 */
+	struct net_lpm_node *child[2];
+
+	/** Entries having this prefix, empty for intermediate nodes */
+	sys_slist_t entries;
+
+	/** Prefix, the bits after prefix_len are zero */
+	u8_t prefix[NET_LPM_MAX_KEY_LEN];
+
+	/** Prefix length in bits */
+	u8_t prefix_len;
+};
+
+struct net_lpm_cache {
+	/** Destination address looked up */
+	u8_t key[NET_LPM_MAX_KEY_LEN];
+
+	/** Lookup context, i.e. network interface */
+	const void *ctx;
+
+	/** Result of the lookup, can be NULL */
+	struct net_lpm_entry *entry;
+
+	/** Is this cache slot used */
+	bool valid;
+};
+
+/**
+ * @brief Tells if an entry can be used for a lookup context, typically
+ * if the route is on the network interface given to the lookup.
+ * The context given to the lookup can be NULL.
+ */
+typedef bool (*net_lpm_match_t)(struct net_lpm_entry *entry,
+				const void *ctx);
+
+struct net_lpm {
+	/** Serializes the lookups, which update the cache, and the changes */
+	struct k_mutex lock;
+
+	/** Root of the trie */
+	struct net_lpm_node *root;
+
+	/** Free nodes */
+	struct net_lpm_node *free_nodes;
+
+	/** Node pool */
+	struct net_lpm_node *nodes;
+
+	/** Cache of the last lookups */
+	struct net_lpm_cache *cache;
+
+	/** Entry filter */
+	net_lpm_match_t match;
+
+	/** Number of nodes in the pool */
+	u16_t node_count;
+
+	/** Number of cache slots */
+	u8_t cache_size;
+
+	/** Address length in bytes */
+	u8_t key_len;
+};
+
+/* A table of _count prefixes needs at most twice as many trie nodes. */
+#define NET_LPM_DEFINE(_name, _key_len, _count, _cache_size, _match)	\
+	static struct net_lpm_node _name##_nodes[2 * (_count)];		\
+	static struct net_lpm_cache _name##_cache[_cache_size];		\
+	static struct net_lpm _name = {					\
+		.nodes = _name##_nodes,					\
+		.cache = _name##_cache,					\
+		.match = _match,					\
+		.node_count = ARRAY_SIZE(_name##_nodes),		\
+		.cache_size = _cache_size,				\
+		.key_len = _key_len,					\
+	}
+
+/**
+ * @brief Empty a table.
+ *
+ * @param lpm Table
+ */
+void net_lpm_init(struct net_lpm *lpm);
+
+/**
+ * @brief Add an entry to a table.
+ *
+ * @param lpm Table
+ * @param entry Entry to add
+ * @param prefix Prefix of the entry, the bits after prefix_len are ignored
+ * @param prefix_len Prefix length in bits
+ *
+ * @return 0 if ok, -ENOMEM if there are no free nodes
+ */
+int net_lpm_add(struct net_lpm *lpm, struct net_lpm_entry *entry,
+		const void *prefix, u8_t prefix_len);
+
+/**
+ * @brief Remove an entry from a table.
+ *
+ * @param lpm Table
+ * @param entry Entry to remove
+ */
+void net_lpm_del(struct net_lpm *lpm, struct net_lpm_entry *entry);
+
+/**
+ * @brief Find the entry with the longest prefix matching an address.
+ *
+ * @param lpm Table
+ * @param key Address
+ * @param ctx Context given to the match function of the table
+ *
+ * @return Entry, NULL if no prefix matches
+ */
+struct net_lpm_entry *net_lpm_lookup(struct net_lpm *lpm, const void *key,
+				     const void *ctx);
+
+/**
+ * @brief Find an entry with exactly the given prefix.
+ *
+ * @param lpm Table
+ * @param prefix Prefix, the bits after prefix_len are ignored
+ * @param prefix_len Prefix length in bits
+ * @param ctx Context given to the match function of the table
+ *
+ * @return Entry, NULL if not found
+ */
+struct net_lpm_entry *net_lpm_find(struct net_lpm *lpm, const void *prefix,
+				   u8_t prefix_len, const void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LPM_H */
@@ -0,0 +1,172 @@
+/** @file
+ *  @brief Hashed index of neighbor cache entries.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __NET_NBR_HASH_H
+#define __NET_NBR_HASH_H
+
+#include <stddef.h>
+#include <zephyr/types.h>
+#include <misc/slist.h>
+#include <misc/dlist.h>
+#include <misc/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The ARP cache and the IPv6 neighbor cache are looked up for every
+ * transmitted packet. Their entries are indexed by a hash of the protocol
+ * address, given by net_hash_fnv1a(), so that a lookup costs the same
+ * whatever the number of neighbors, and are kept in a least recently used
+ * list which gives the entry to replace when the cache is full.
+ */
+
+/** Index node, to be embedded in the neighbor cache entry. */
+struct net_nbr_hash_node {
+	/** Link in the hash bucket */
+	sys_snode_t bucket_node;
+
+	/** Link in the LRU list, most recently used first */
+	sys_dnode_t lru_node;
+
+	/** Hash of the protocol address */
+	u32_t hash;
+};
+
+struct net_nbr_hash {
+	/** Hash buckets */
+	sys_slist_t *buckets;
+
+	/** Indexed entries, most recently used first */
+	sys_dlist_t lru;
+
+	/** Number of hash buckets */
+	u16_t bucket_count;
+};
+
+/* Define an index with the given number of hash buckets. It has to be
+ * initialized with net_nbr_hash_init() before use.
+ */
+#define NET_NBR_HASH_DEFINE(_name, _bucket_count)			\
+	static sys_slist_t _name##_buckets[_bucket_count];		\
+	static struct net_nbr_hash _name = {				\
+		.buckets = _name##_buckets,				\
+		.bucket_count = _bucket_count,				\
+	}
+
+static inline sys_slist_t *net_nbr_hash_bucket(struct net_nbr_hash *index,
+					       u32_t hash)
+{
+	return &index->buckets[hash % index->bucket_count];
+}
+
+/**
+ * @brief Iterate over the nodes of an index having a given hash. The
+ * caller still has to compare the addresses.
+ * @param _index Index
+ * @param _hash Hash of the address looked up
+ * @param _node Node pointer set for each candidate
+ */
+#define NET_NBR_HASH_FOR_EACH(_index, _hash, _node)			\
+	SYS_SLIST_FOR_EACH_CONTAINER(net_nbr_hash_bucket(_index, _hash), \
+				     _node, bucket_node)		\
+		if ((_node)->hash == (_hash))
+
+/**
+ * @brief Empty an index.
+ * @param index Index
+ */
+static inline void net_nbr_hash_init(struct net_nbr_hash *index)
+{
+	int i;
+
+	for (i = 0; i < index->bucket_count; i++) {
+		sys_slist_init(&index->buckets[i]);
+	}
+
+	sys_dlist_init(&index->lru);
+}
+
+/**
+ * @brief Add a node to an index, as the most recently used one.
+ * @param index Index
+ * @param node Node of the entry
+ * @param hash Hash of the address of the entry
+ */
+static inline void net_nbr_hash_add(struct net_nbr_hash *index,
+				    struct net_nbr_hash_node *node, u32_t hash)
+{
+	node->hash = hash;
+
+	sys_slist_prepend(net_nbr_hash_bucket(index, hash),
+			  &node->bucket_node);
+	sys_dlist_prepend(&index->lru, &node->lru_node);
+}
+
+/**
+ * @brief Remove a node from an index.
+ * @param index Index
+ * @param node Node of the entry
+ */
+static inline void net_nbr_hash_remove(struct net_nbr_hash *index,
+				       struct net_nbr_hash_node *node)
+{
+	sys_slist_find_and_remove(net_nbr_hash_bucket(index, node->hash),
+				  &node->bucket_node);
+	sys_dlist_remove(&node->lru_node);
+}
+
+/**
+ * @brief Mark a node as the most recently used one.
+ * @param index Index
+ * @param node Node of the entry
+ */
+static inline void net_nbr_hash_touch(struct net_nbr_hash *index,
+				      struct net_nbr_hash_node *node)
+{
+	if (!sys_dlist_is_head(&index->lru, &node->lru_node)) {
+		sys_dlist_remove(&node->lru_node);
+		sys_dlist_prepend(&index->lru, &node->lru_node);
+	}
+}
+
+/**
+ * @brief Get the least recently used node of an index.
+ * @param index Index
+ * @return Node, NULL if the index is empty
+ */
+static inline struct net_nbr_hash_node *
+net_nbr_hash_oldest(struct net_nbr_hash *index)
+{
+	sys_dnode_t *tail = sys_dlist_peek_tail(&index->lru);
+
+	return tail ? CONTAINER_OF(tail, struct net_nbr_hash_node, lru_node) :
+		NULL;
+}
+
+/**
+ * @brief Get the next older node of an index.
+ * @param index Index
+ * @param node Current node
+ * @return Node, NULL if node is the least recently used one
+ */
+static inline struct net_nbr_hash_node *
+net_nbr_hash_older(struct net_nbr_hash *index, struct net_nbr_hash_node *node)
+{
+	sys_dnode_t *prev = sys_dlist_peek_prev(&index->lru, &node->lru_node);
+
+	return prev ? CONTAINER_OF(prev, struct net_nbr_hash_node, lru_node) :
+		NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_NBR_HASH_H */
@@ -280,6 +280,8 @@ int net_context_get(sa_family_t family,
 
 		k_mutex_init(&contexts[i].lock);
 
+		net_pkt_quota_init_context(&contexts[i]);
+
 		contexts[i].flags |= NET_CONTEXT_IN_USE;
 		*context = &contexts[i];
 
@@ -371,6 +373,7 @@ int net_context_put(struct net_context *context)
 	context->connect_cb = NULL;
 	context->recv_cb = NULL;
 	context->send_cb = NULL;
+	context->writable_cb = NULL;
 
 	/* Decrement refcount on user app's behalf */
 	net_context_unref(context);
@@ -1098,6 +1101,23 @@ static int get_context_priority(struct net_context *context,
 #endif
 }
 
+static int get_context_quota(struct net_context *context, bool tx,
+			     void *value, size_t *len)
+{
+#if defined(CONFIG_NET_PKT_QUOTA)
+	*((u32_t *)value) = tx ? context->tx_quota.limit :
+		context->rx_quota.limit;
+
+	if (len) {
+		*len = sizeof(u32_t);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 static int get_context_timepstamp(struct net_context *context,
 				  void *value, size_t *len)
 {
@@ -1211,12 +1231,21 @@ static struct net_pkt *context_alloc_pkt(struct net_context *context,
 		return pkt;
 	}
 #endif
-	pkt = net_pkt_alloc_with_buffer(net_context_get_iface(context), len,
-					net_context_get_family(context),
-					net_context_get_ip_proto(context),
-					timeout);
-	if (pkt) {
-		net_pkt_set_context(pkt, context);
+	/* The context is set before allocating the data, which is then
+	 * charged to the memory quota of the context.
+	 */
+	pkt = net_pkt_alloc_on_iface(net_context_get_iface(context), timeout);
+	if (!pkt) {
+		return NULL;
+	}
+
+	net_pkt_set_family(pkt, net_context_get_family(context));
+	net_pkt_set_context(pkt, context);
+
+	if (net_pkt_alloc_buffer(pkt, len, net_context_get_ip_proto(context),
+				 timeout)) {
+		net_pkt_unref(pkt);
+		return NULL;
 	}
 
 	return pkt;
@@ -1323,6 +1352,12 @@ static int context_sendto(struct net_context *context,
 
 	pkt = context_alloc_pkt(context, len, PKT_WAIT_TIME);
 	if (!pkt) {
+#if defined(CONFIG_NET_PKT_QUOTA)
+		/* The writable callback tells when memory is released */
+		if (net_pkt_quota_is_full(&context->tx_quota)) {
+			return -EAGAIN;
+		}
+#endif
 		return -ENOMEM;
 	}
 
@@ -1500,6 +1535,22 @@ int net_context_sendto(struct net_context *context,
 	return ret;
 }
 
+bool net_context_is_writable(struct net_context *context)
+{
+#if defined(CONFIG_NET_PKT_QUOTA)
+	if (net_pkt_quota_is_full(&context->tx_quota)) {
+		return false;
+	}
+#endif
+
+	if (IS_ENABLED(CONFIG_NET_TCP) &&
+	    net_context_get_ip_proto(context) == IPPROTO_TCP) {
+		return net_tcp_is_writable(context);
+	}
+
+	return true;
+}
+
 enum net_verdict net_context_packet_received(struct net_conn *conn,
 					     struct net_pkt *pkt,
 					     union net_ip_header *ip_hdr,
@@ -1524,6 +1575,14 @@ enum net_verdict net_context_packet_received(struct net_conn *conn,
 		goto unlock;
 	}
 
+	/* Drop the data the context has no room for, TCP checks this
+	 * before acknowledging the data.
+	 */
+	if (net_pkt_quota_charge_rx(pkt, &context->rx_quota) < 0) {
+		NET_DBG("Context %p receive quota exceeded", context);
+		goto unlock;
+	}
+
 	if (net_context_get_ip_proto(context) == IPPROTO_TCP) {
 		net_stats_update_tcp_recv(net_pkt_iface(pkt),
 					  net_pkt_remaining_data(pkt));
@@ -1631,6 +1690,11 @@ static enum net_verdict net_context_raw_packet_received(
 		return NET_DROP;
 	}
 
+	if (net_pkt_quota_charge_rx(pkt, &context->rx_quota) < 0) {
+		NET_DBG("Context %p receive quota exceeded", context);
+		return NET_DROP;
+	}
+
 	net_context_set_iface(context, net_pkt_iface(pkt));
 	net_pkt_set_context(pkt, context);
 
@@ -1775,6 +1839,27 @@ int net_context_update_recv_wnd(struct net_context *context,
 	return ret;
 }
 
+static int set_context_quota(struct net_context *context, bool tx,
+			     const void *value, size_t len)
+{
+#if defined(CONFIG_NET_PKT_QUOTA)
+	if (len != sizeof(u32_t)) {
+		return -EINVAL;
+	}
+
+	net_pkt_quota_set_limit(tx ? &context->tx_quota : &context->rx_quota,
+				*((u32_t *)value));
+
+	if (tx && context->writable_cb) {
+		context->writable_cb(context);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 static int set_context_priority(struct net_context *context,
 				const void *value, size_t len)
 {
@@ -1828,6 +1913,12 @@ int net_context_set_option(struct net_context *context,
 	case NET_OPT_TIMESTAMP:
 		ret = set_context_timestamp(context, value, len);
 		break;
+	case NET_OPT_SNDBUF:
+		ret = set_context_quota(context, true, value, len);
+		break;
+	case NET_OPT_RCVBUF:
+		ret = set_context_quota(context, false, value, len);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -1856,6 +1947,12 @@ int net_context_get_option(struct net_context *context,
 	case NET_OPT_TIMESTAMP:
 		ret = get_context_timepstamp(context, value, len);
 		break;
+	case NET_OPT_SNDBUF:
+		ret = get_context_quota(context, true, value, len);
+		break;
+	case NET_OPT_RCVBUF:
+		ret = get_context_quota(context, false, value, len);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -39,6 +39,7 @@ LOG_MODULE_REGISTER(net_core, CONFIG_NET_CORE_LOG_LEVEL);
 #include "ipv6.h"
 
 #include "icmpv4.h"
+#include "ipv4.h"
 
 #include "dhcpv4.h"
 
@@ -79,15 +80,13 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 		return ret;
 	}
 
-#if defined(CONFIG_NET_IPV6_FRAGMENT)
 	/* If the packet is routed back to us when we have reassembled
-	 * an IPv6 packet, then do not pass it to L2 as the packet does
+	 * an IP packet, then do not pass it to L2 as the packet does
 	 * not have link layer headers in it.
 	 */
-	if (net_pkt_ipv6_fragment_start(pkt)) {
+	if (net_pkt_ip_reassembled(pkt)) {
 		locally_routed = true;
 	}
-#endif
 
 	/* If there is no data, then drop the packet. */
 	if (!pkt->frags) {
@@ -366,11 +365,23 @@ static void process_rx_packet(struct k_work *work)
 	net_rx(net_pkt_iface(pkt), pkt);
 }
 
-static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
+static u8_t net_prepare_rx(struct net_if *iface, struct net_pkt *pkt)
 {
 	u8_t prio = net_pkt_priority(pkt);
 	u8_t tc = net_rx_priority2tc(prio);
 
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_cursor_init(pkt);
+
+	NET_DBG("prio %d iface %p pkt %p len %zu", prio, iface, pkt,
+		net_pkt_get_len(pkt));
+
+	if (IS_ENABLED(CONFIG_NET_ROUTING)) {
+		net_pkt_set_orig_iface(pkt, iface);
+	}
+
+	net_pkt_set_iface(pkt, iface);
+
 	k_work_init(net_pkt_work(pkt), process_rx_packet);
 
 #if defined(CONFIG_NET_STATISTICS)
@@ -383,12 +394,14 @@ static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
 	NET_DBG("TC %d with prio %d pkt %p", tc, prio, pkt);
 #endif
 
-	net_tc_submit_to_rx_queue(tc, pkt);
+	return tc;
 }
 
 /* Called by driver when an IP packet has been received */
 int net_recv_data(struct net_if *iface, struct net_pkt *pkt)
 {
+	u8_t tc;
+
 	if (!pkt || !iface) {
 		return -EINVAL;
 	}
@@ -401,19 +414,38 @@ int net_recv_data(struct net_if *iface, struct net_pkt *pkt)
 		return -ENETDOWN;
 	}
 
-	net_pkt_set_overwrite(pkt, true);
-	net_pkt_cursor_init(pkt);
+	tc = net_prepare_rx(iface, pkt);
 
-	NET_DBG("prio %d iface %p pkt %p len %zu", net_pkt_priority(pkt),
-		iface, pkt, net_pkt_get_len(pkt));
+	net_tc_submit_to_rx_queue(tc, pkt);
 
-	if (IS_ENABLED(CONFIG_NET_ROUTING)) {
-		net_pkt_set_orig_iface(pkt, iface);
+	return 0;
+}
+
+int net_recv_data_burst(struct net_if *iface, struct net_pkt **pkts,
+			int count)
+{
+	int i, queued = 0;
+
+	if (!pkts || !iface) {
+		return -EINVAL;
 	}
 
-	net_pkt_set_iface(pkt, iface);
+	if (!net_if_flag_is_set(iface, NET_IF_UP)) {
+		return -ENETDOWN;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (!pkts[i]->frags) {
+			net_pkt_unref(pkts[i]);
+			continue;
+		}
 
-	net_queue_rx(iface, pkt);
+		(void)net_prepare_rx(iface, pkts[i]);
+
+		pkts[queued++] = pkts[i];
+	}
+
+	net_tc_submit_burst_to_rx_queues(pkts, queued);
 
 	return 0;
 }
@@ -423,6 +455,7 @@ static inline void l3_init(void)
 	net_icmpv4_init();
 	net_icmpv6_init();
 	net_ipv6_init();
+	net_ipv4_frag_init();
 
 	net_ipv4_autoconf_init();
 
@@ -437,6 +470,8 @@ static inline void l3_init(void)
 
 	net_route_init();
 
+	net_route_ipv4_init();
+
 	NET_DBG("Network L3 init done");
 }
 
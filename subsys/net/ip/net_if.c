@@ -17,9 +17,11 @@ LOG_MODULE_REGISTER(net_if, CONFIG_NET_IF_LOG_LEVEL);
 #include <net/net_if.h>
 #include <net/net_mgmt.h>
 #include <net/ethernet.h>
+#include <net/capture.h>
 
 #include "net_private.h"
 #include "ipv6.h"
+#include "ipv4.h"
 #include "ipv4_autoconf_internal.h"
 
 #include "net_stats.h"
@@ -135,7 +137,38 @@ static inline void net_context_send_cb(struct net_context *context,
 	}
 }
 
-static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
+static inline void net_if_tx_prepare(struct net_pkt *pkt)
+{
+	if (IS_ENABLED(CONFIG_NET_TCP) &&
+	    net_pkt_family(pkt) != AF_UNSPEC) {
+		net_pkt_set_sent(pkt, true);
+		net_pkt_set_queued(pkt, false);
+	}
+}
+
+static void net_if_tx_done(struct net_if *iface, struct net_pkt *pkt,
+			   struct net_context *context,
+			   struct net_linkaddr *dst, int status)
+{
+	if (status < 0) {
+		net_pkt_unref(pkt);
+	} else {
+		net_stats_update_bytes_sent(iface, status);
+	}
+
+	if (context) {
+		NET_DBG("Calling context send cb %p status %d",
+			context, status);
+
+		net_context_send_cb(context, status);
+	}
+
+	if (dst->addr) {
+		net_if_call_link_cb(iface, dst, status);
+	}
+}
+
+bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 {
 	struct net_linkaddr *dst;
 	struct net_context *context;
@@ -151,11 +184,7 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 	context = net_pkt_context(pkt);
 
 	if (net_if_flag_is_set(iface, NET_IF_UP)) {
-		if (IS_ENABLED(CONFIG_NET_TCP) &&
-		    net_pkt_family(pkt) != AF_UNSPEC) {
-			net_pkt_set_sent(pkt, true);
-			net_pkt_set_queued(pkt, false);
-		}
+		net_if_tx_prepare(pkt);
 
 		status = net_if_l2(iface)->send(iface, pkt);
 	} else {
@@ -164,25 +193,47 @@ static bool net_if_tx(struct net_if *iface, struct net_pkt *pkt)
 		status = -ENETDOWN;
 	}
 
-	if (status < 0) {
-		net_pkt_unref(pkt);
-	} else {
-		net_stats_update_bytes_sent(iface, status);
-	}
+	net_if_tx_done(iface, pkt, context, dst, status);
 
-	if (context) {
-		NET_DBG("Calling context send cb %p status %d",
-			context, status);
+	return true;
+}
 
-		net_context_send_cb(context, status);
+#if NET_TX_BURST_SIZE > 1
+/* Called by the Tx threads with packets of the same interface */
+void net_if_tx_burst(struct net_if *iface, struct net_pkt **pkts, int count)
+{
+	struct net_linkaddr *dst[NET_TX_BURST_SIZE];
+	struct net_context *context[NET_TX_BURST_SIZE];
+	int status[NET_TX_BURST_SIZE];
+	int i;
+
+	NET_ASSERT(count <= NET_TX_BURST_SIZE);
+
+	if (count == 1 || !net_if_l2(iface)->send_burst ||
+	    !net_if_flag_is_set(iface, NET_IF_UP)) {
+		for (i = 0; i < count; i++) {
+			net_if_tx(iface, pkts[i]);
+		}
+
+		return;
 	}
 
-	if (dst->addr) {
-		net_if_call_link_cb(iface, dst, status);
+	for (i = 0; i < count; i++) {
+		debug_check_packet(pkts[i]);
+
+		dst[i] = net_pkt_lladdr_dst(pkts[i]);
+		context[i] = net_pkt_context(pkts[i]);
+
+		net_if_tx_prepare(pkts[i]);
 	}
 
-	return true;
+	net_if_l2(iface)->send_burst(iface, pkts, status, count);
+
+	for (i = 0; i < count; i++) {
+		net_if_tx_done(iface, pkts[i], context[i], dst[i], status[i]);
+	}
 }
+#endif /* NET_TX_BURST_SIZE > 1 */
 
 static void process_tx_packet(struct k_work *work)
 {
@@ -200,6 +251,10 @@ void net_if_queue_tx(struct net_if *iface, struct net_pkt *pkt)
 
 	k_work_init(net_pkt_work(pkt), process_tx_packet);
 
+	if (net_qdisc_enqueue(iface, pkt)) {
+		return;
+	}
+
 #if defined(CONFIG_NET_STATISTICS)
 	net_stats_update_tc_sent_pkt(iface, tc);
 	net_stats_update_tc_sent_bytes(iface, tc, net_pkt_get_len(pkt));
@@ -271,6 +326,13 @@ enum net_verdict net_if_send_data(struct net_if *iface, struct net_pkt *pkt)
 	}
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	/* Fragment the packet if it does not fit into the MTU */
+	if (net_pkt_family(pkt) == AF_INET) {
+		verdict = net_ipv4_prepare_for_send(pkt);
+	}
+#endif
+
 done:
 	/*   NET_OK in which case packet has checked successfully. In this case
 	 *   the net_context callback is called after successful delivery in
@@ -2750,6 +2812,8 @@ out:
 
 enum net_verdict net_if_recv_data(struct net_if *iface, struct net_pkt *pkt)
 {
+	net_capture_pkt(iface, pkt, NET_CAPTURE_RX);
+
 	if (IS_ENABLED(CONFIG_NET_PROMISCUOUS_MODE) &&
 	    net_if_is_promisc(iface)) {
 		/* If the packet is not for us and the promiscuous
@@ -3114,6 +3178,7 @@ void net_if_init(void)
 
 	for (iface = __net_if_start, if_count = 0; iface != __net_if_end;
 	     iface++, if_count++) {
+		net_pkt_quota_init_iface(iface);
 		init_iface(iface);
 	}
 
@@ -93,6 +93,17 @@ LOG_MODULE_REGISTER(net_pkt, CONFIG_NET_PKT_LOG_LEVEL);
 #error "Too small net_buf fragment size"
 #endif
 
+#if defined(CONFIG_NET_BUF_SIZE_CLASSES)
+#if CONFIG_NET_BUF_SMALL_DATA_SIZE < (MAX_IP_PROTO_LEN + MAX_NEXT_PROTO_LEN)
+#error "Too small net_buf small fragment size"
+#endif
+
+#if CONFIG_NET_BUF_SMALL_DATA_SIZE >= CONFIG_NET_BUF_DATA_SIZE || \
+	CONFIG_NET_BUF_LARGE_DATA_SIZE <= CONFIG_NET_BUF_DATA_SIZE
+#error "The net_buf fragment sizes of the size classes must increase"
+#endif
+#endif /* CONFIG_NET_BUF_SIZE_CLASSES */
+
 #if CONFIG_NET_PKT_RX_COUNT <= 0
 #error "Minimum value for CONFIG_NET_PKT_RX_COUNT is 1"
 #endif
@@ -128,6 +139,132 @@ NET_BUF_POOL_VAR_DEFINE(tx_bufs, CONFIG_NET_BUF_TX_COUNT,
 
 #endif /* CONFIG_NET_BUF_FIXED_DATA_SIZE */
 
+#if defined(CONFIG_NET_BUF_SIZE_CLASSES)
+
+NET_BUF_POOL_FIXED_DEFINE(rx_bufs_small, CONFIG_NET_BUF_SMALL_RX_COUNT,
+			  CONFIG_NET_BUF_SMALL_DATA_SIZE, NULL);
+NET_BUF_POOL_FIXED_DEFINE(tx_bufs_small, CONFIG_NET_BUF_SMALL_TX_COUNT,
+			  CONFIG_NET_BUF_SMALL_DATA_SIZE, NULL);
+NET_BUF_POOL_FIXED_DEFINE(rx_bufs_large, CONFIG_NET_BUF_LARGE_RX_COUNT,
+			  CONFIG_NET_BUF_LARGE_DATA_SIZE, NULL);
+NET_BUF_POOL_FIXED_DEFINE(tx_bufs_large, CONFIG_NET_BUF_LARGE_TX_COUNT,
+			  CONFIG_NET_BUF_LARGE_DATA_SIZE, NULL);
+
+/* The size classes, from the smallest to the biggest buffers */
+static const u16_t class_size[] = {
+	CONFIG_NET_BUF_SMALL_DATA_SIZE,
+	CONFIG_NET_BUF_DATA_SIZE,
+	CONFIG_NET_BUF_LARGE_DATA_SIZE,
+};
+
+static struct net_buf_pool * const rx_classes[] = {
+	&rx_bufs_small, &rx_bufs, &rx_bufs_large,
+};
+
+static struct net_buf_pool * const tx_classes[] = {
+	&tx_bufs_small, &tx_bufs, &tx_bufs_large,
+};
+
+#define NET_BUF_CLASS_COUNT ARRAY_SIZE(class_size)
+
+#define NET_BUF_RX_DATA_SIZE						\
+	(CONFIG_NET_BUF_SMALL_RX_COUNT * CONFIG_NET_BUF_SMALL_DATA_SIZE +	\
+	 CONFIG_NET_BUF_RX_COUNT * CONFIG_NET_BUF_DATA_SIZE +		\
+	 CONFIG_NET_BUF_LARGE_RX_COUNT * CONFIG_NET_BUF_LARGE_DATA_SIZE)
+#define NET_BUF_TX_DATA_SIZE						\
+	(CONFIG_NET_BUF_SMALL_TX_COUNT * CONFIG_NET_BUF_SMALL_DATA_SIZE +	\
+	 CONFIG_NET_BUF_TX_COUNT * CONFIG_NET_BUF_DATA_SIZE +		\
+	 CONFIG_NET_BUF_LARGE_TX_COUNT * CONFIG_NET_BUF_LARGE_DATA_SIZE)
+
+#define NET_BUF_CLASS_RX_COUNT (CONFIG_NET_BUF_SMALL_RX_COUNT + \
+				CONFIG_NET_BUF_LARGE_RX_COUNT)
+#define NET_BUF_CLASS_TX_COUNT (CONFIG_NET_BUF_SMALL_TX_COUNT + \
+				CONFIG_NET_BUF_LARGE_TX_COUNT)
+
+#elif defined(CONFIG_NET_BUF_FIXED_DATA_SIZE)
+
+#define NET_BUF_RX_DATA_SIZE (CONFIG_NET_BUF_RX_COUNT * \
+			      CONFIG_NET_BUF_DATA_SIZE)
+#define NET_BUF_TX_DATA_SIZE (CONFIG_NET_BUF_TX_COUNT * \
+			      CONFIG_NET_BUF_DATA_SIZE)
+
+#define NET_BUF_CLASS_RX_COUNT 0
+#define NET_BUF_CLASS_TX_COUNT 0
+
+#else /* !CONFIG_NET_BUF_FIXED_DATA_SIZE */
+
+#define NET_BUF_RX_DATA_SIZE CONFIG_NET_BUF_DATA_POOL_SIZE
+#define NET_BUF_TX_DATA_SIZE CONFIG_NET_BUF_DATA_POOL_SIZE
+
+#define NET_BUF_CLASS_RX_COUNT 0
+#define NET_BUF_CLASS_TX_COUNT 0
+
+#endif /* CONFIG_NET_BUF_SIZE_CLASSES */
+
+#if defined(CONFIG_NET_PKT_POOL_STATS)
+#if defined(CONFIG_NET_BUF_FIXED_DATA_SIZE)
+#define POOL_STATS(_pool, _size, _tx) { .pool = &_pool, .data_size = _size, \
+					.tx = _tx }
+#else
+#define POOL_STATS(_pool, _size, _tx) { .pool = &_pool, .tx = _tx }
+#endif
+
+static struct net_pkt_pool_stats pool_stats[] = {
+#if defined(CONFIG_NET_BUF_SIZE_CLASSES)
+	POOL_STATS(rx_bufs_small, CONFIG_NET_BUF_SMALL_DATA_SIZE, false),
+	POOL_STATS(tx_bufs_small, CONFIG_NET_BUF_SMALL_DATA_SIZE, true),
+#endif
+	POOL_STATS(rx_bufs, CONFIG_NET_BUF_DATA_SIZE, false),
+	POOL_STATS(tx_bufs, CONFIG_NET_BUF_DATA_SIZE, true),
+#if defined(CONFIG_NET_BUF_SIZE_CLASSES)
+	POOL_STATS(rx_bufs_large, CONFIG_NET_BUF_LARGE_DATA_SIZE, false),
+	POOL_STATS(tx_bufs_large, CONFIG_NET_BUF_LARGE_DATA_SIZE, true),
+#endif
+};
+
+/* Account an allocation attempt from one of the predefined pools */
+static void pool_stats_update(struct net_buf_pool *pool, struct net_buf *buf)
+{
+	struct net_pkt_pool_stats *stats = NULL;
+	u16_t used;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(pool_stats); i++) {
+		if (pool_stats[i].pool == pool) {
+			stats = &pool_stats[i];
+			break;
+		}
+	}
+
+	if (!stats) {
+		return;
+	}
+
+	if (!buf) {
+		stats->empty++;
+		return;
+	}
+
+	stats->allocs++;
+
+	used = pool->buf_count - pool->avail_count;
+	if (used > stats->max_used) {
+		stats->max_used = used;
+	}
+}
+
+void net_pkt_pool_stats_foreach(net_pkt_pool_stats_cb_t cb, void *user_data)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(pool_stats); i++) {
+		cb(&pool_stats[i], user_data);
+	}
+}
+#else
+#define pool_stats_update(...)
+#endif /* CONFIG_NET_PKT_POOL_STATS */
+
 /* Allocation tracking is only available if separately enabled */
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
 struct net_pkt_alloc {
@@ -148,6 +285,8 @@ struct net_pkt_alloc {
 			    CONFIG_NET_PKT_TX_COUNT + \
 			    CONFIG_NET_BUF_RX_COUNT + \
 			    CONFIG_NET_BUF_TX_COUNT + \
+			    NET_BUF_CLASS_RX_COUNT + \
+			    NET_BUF_CLASS_TX_COUNT + \
 			    CONFIG_NET_DEBUG_NET_PKT_EXTERNALS)
 
 static struct net_pkt_alloc net_pkt_allocs[MAX_NET_PKT_ALLOCS];
@@ -277,6 +416,14 @@ const char *net_pkt_pool2str(struct net_buf_pool *pool)
 		return "TDATA";
 	}
 
+#if defined(CONFIG_NET_BUF_SIZE_CLASSES)
+	if (pool == &rx_bufs_small || pool == &rx_bufs_large) {
+		return "RDATA";
+	} else if (pool == &tx_bufs_small || pool == &tx_bufs_large) {
+		return "TDATA";
+	}
+#endif
+
 	return "EDATA";
 }
 #endif
@@ -381,6 +528,8 @@ struct net_buf *net_pkt_get_reserve_data(struct net_buf_pool *pool,
 		frag = net_buf_alloc(pool, timeout);
 	}
 
+	pool_stats_update(pool, frag);
+
 	if (!frag) {
 		return NULL;
 	}
@@ -493,6 +642,150 @@ static inline struct net_buf_pool *get_data_pool(struct net_context *context)
 #define get_data_pool(...) NULL
 #endif /* CONFIG_NET_CONTEXT_NET_PKT_POOL */
 
+#if defined(CONFIG_NET_PKT_QUOTA)
+static int quota_charge(struct net_pkt_quota *quota, size_t len,
+			s32_t timeout)
+{
+	u32_t alloc_start = k_uptime_get_32();
+	atomic_val_t used, max_used;
+	bool waited = false;
+
+	while (1) {
+		used = atomic_get(&quota->used);
+
+		/* An idle quota lets any packet through, so that one bigger
+		 * than the limit can still be sent.
+		 */
+		if (!quota->limit || !used || used + len <= quota->limit) {
+			if (atomic_cas(&quota->used, used, used + len)) {
+				break;
+			}
+
+			continue;
+		}
+
+		if (timeout == K_NO_WAIT) {
+			atomic_set(&quota->full, 1);
+
+			/* Memory released before the flag was set would not
+			 * clear it.
+			 */
+			if (atomic_get(&quota->used) != used) {
+				continue;
+			}
+
+			atomic_inc(&quota->exceeded);
+			return -ENOBUFS;
+		}
+
+		if (k_sem_take(&quota->released, timeout)) {
+			atomic_inc(&quota->exceeded);
+			return -ENOBUFS;
+		}
+
+		if (timeout != K_FOREVER) {
+			u32_t diff = k_uptime_get_32() - alloc_start;
+
+			timeout -= MIN(timeout, diff);
+		}
+
+		waited = true;
+	}
+
+	atomic_clear(&quota->full);
+
+	do {
+		max_used = atomic_get(&quota->max_used);
+		if (used + len <= max_used) {
+			break;
+		}
+	} while (!atomic_cas(&quota->max_used, max_used, used + len));
+
+	/* Pass the wake up on to the other waiting senders */
+	if (waited && (!quota->limit || used + len < quota->limit)) {
+		k_sem_give(&quota->released);
+	}
+
+	return 0;
+}
+
+/* Returns true if an allocation was refused since the last release */
+static bool quota_release(struct net_pkt_quota *quota, size_t len)
+{
+	atomic_sub(&quota->used, len);
+	k_sem_give(&quota->released);
+
+	return atomic_cas(&quota->full, 1, 0);
+}
+
+/* A sender refused by the quota of its context does not wait for it, as
+ * it holds the context lock, so tell it through the writable callback
+ * that it can try again.
+ */
+static void ctx_quota_release(struct net_pkt *pkt, size_t len)
+{
+	struct net_context *context = pkt->context;
+
+	if (quota_release(pkt->ctx_quota, len) && context &&
+	    pkt->ctx_quota == &context->tx_quota && context->writable_cb) {
+		context->writable_cb(context);
+	}
+}
+
+static void pkt_quota_release(struct net_pkt *pkt)
+{
+	if (pkt->ctx_quota) {
+		ctx_quota_release(pkt, pkt->ctx_charged);
+		pkt->ctx_quota = NULL;
+		pkt->ctx_charged = 0U;
+	}
+
+	if (pkt->iface_quota) {
+		(void)quota_release(pkt->iface_quota, pkt->iface_charged);
+		pkt->iface_quota = NULL;
+		pkt->iface_charged = 0U;
+	}
+}
+
+static u32_t quota_share(size_t pool_size, int percent)
+{
+	return (u32_t)((u64_t)pool_size * percent / 100U);
+}
+
+/* The packets of the previous user of a context can still be charged to
+ * its quotas, so only their limits and statistics are reset.
+ */
+static void quota_reset(struct net_pkt_quota *quota, u32_t limit)
+{
+	quota->limit = limit;
+	atomic_set(&quota->max_used, atomic_get(&quota->used));
+	atomic_clear(&quota->exceeded);
+	atomic_clear(&quota->full);
+
+	k_sem_init(&quota->released, 0, 1);
+}
+
+void net_pkt_quota_init_context(struct net_context *context)
+{
+	quota_reset(&context->tx_quota,
+		    quota_share(NET_BUF_TX_DATA_SIZE,
+				CONFIG_NET_PKT_QUOTA_CONTEXT));
+	quota_reset(&context->rx_quota,
+		    quota_share(NET_BUF_RX_DATA_SIZE,
+				CONFIG_NET_PKT_QUOTA_CONTEXT));
+}
+
+void net_pkt_quota_init_iface(struct net_if *iface)
+{
+	net_pkt_quota_init(&iface->mem_quota,
+			   quota_share(NET_BUF_RX_DATA_SIZE +
+				       NET_BUF_TX_DATA_SIZE,
+				       CONFIG_NET_PKT_QUOTA_IFACE));
+}
+#else
+#define pkt_quota_release(...)
+#endif /* CONFIG_NET_PKT_QUOTA */
+
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
 void net_pkt_unref_debug(struct net_pkt *pkt, const char *caller, int line)
 {
@@ -586,6 +879,8 @@ done:
 		net_pkt_frag_unref(pkt->frags);
 	}
 
+	pkt_quota_release(pkt);
+
 	if (IS_ENABLED(CONFIG_NET_DEBUG_NET_PKT_NON_FRAGILE_ACCESS)) {
 		pkt->buffer = NULL;
 		net_pkt_cursor_init(pkt);
@@ -848,6 +1143,102 @@ void net_pkt_print(void)
 
 #if defined(CONFIG_NET_BUF_FIXED_DATA_SIZE)
 
+#if defined(CONFIG_NET_BUF_SIZE_CLASSES)
+/* Memory taken by the buffers of a size class holding size bytes */
+static size_t class_cost(int class, size_t size)
+{
+	return ceiling_fraction(size, class_size[class]) *
+		(class_size[class] + sizeof(struct net_buf));
+}
+
+/* Pick the size class of the next buffer of an allocation. The biggest
+ * buffers are used as long as they are filled up, and the rest goes to
+ * the class wasting the least memory, buffer headers included.
+ */
+static int class_pick(size_t size)
+{
+	int best = NET_BUF_CLASS_COUNT - 1;
+	int i;
+
+	if (size >= class_size[best]) {
+		return best;
+	}
+
+	for (i = best - 1; i >= 0; i--) {
+		if (class_cost(i, size) < class_cost(best, size)) {
+			best = i;
+		}
+	}
+
+	return best;
+}
+
+static struct net_buf *class_alloc(struct net_buf_pool * const *classes,
+				   size_t size, s32_t timeout)
+{
+	int class = class_pick(size);
+	struct net_buf *buf;
+	int i;
+
+	buf = net_buf_alloc_fixed(classes[class], K_NO_WAIT);
+	pool_stats_update(classes[class], buf);
+	if (buf) {
+		return buf;
+	}
+
+	/* The best fitting pool is empty, rather take bigger buffers and
+	 * then more of the smaller ones than wait.
+	 */
+	for (i = class + 1; i < NET_BUF_CLASS_COUNT; i++) {
+		buf = net_buf_alloc_fixed(classes[i], K_NO_WAIT);
+		pool_stats_update(classes[i], buf);
+		if (buf) {
+			return buf;
+		}
+	}
+
+	for (i = class - 1; i >= 0; i--) {
+		buf = net_buf_alloc_fixed(classes[i], K_NO_WAIT);
+		pool_stats_update(classes[i], buf);
+		if (buf) {
+			return buf;
+		}
+	}
+
+	if (timeout == K_NO_WAIT) {
+		return NULL;
+	}
+
+	buf = net_buf_alloc_fixed(classes[class], timeout);
+	if (buf) {
+		pool_stats_update(classes[class], buf);
+	}
+
+	return buf;
+}
+#endif /* CONFIG_NET_BUF_SIZE_CLASSES */
+
+static struct net_buf *pool_alloc(struct net_buf_pool *pool, size_t size,
+				  s32_t timeout)
+{
+	struct net_buf *buf;
+
+#if defined(CONFIG_NET_BUF_SIZE_CLASSES)
+	if (pool == &rx_bufs) {
+		return class_alloc(rx_classes, size, timeout);
+	} else if (pool == &tx_bufs) {
+		return class_alloc(tx_classes, size, timeout);
+	}
+#else
+	ARG_UNUSED(size);
+#endif
+
+	buf = net_buf_alloc_fixed(pool, timeout);
+	pool_stats_update(pool, buf);
+
+	return buf;
+}
+
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
 static struct net_buf *pkt_alloc_buffer(struct net_buf_pool *pool,
 					size_t size, s32_t timeout,
@@ -864,7 +1255,7 @@ static struct net_buf *pkt_alloc_buffer(struct net_buf_pool *pool,
 	while (size) {
 		struct net_buf *new;
 
-		new = net_buf_alloc_fixed(pool, timeout);
+		new = pool_alloc(pool, size, timeout);
 		if (!new) {
 			goto error;
 		}
@@ -894,7 +1285,9 @@ static struct net_buf *pkt_alloc_buffer(struct net_buf_pool *pool,
 		net_pkt_alloc_add(new, false, caller, line);
 
 		NET_DBG("%s (%s) [%d] frag %p ref %d (%s():%d)",
-			pool2str(pool), get_name(pool), get_frees(pool),
+			pool2str(net_buf_pool_get(new->pool_id)),
+			get_name(net_buf_pool_get(new->pool_id)),
+			get_frees(net_buf_pool_get(new->pool_id)),
 			new, new->ref, caller, line);
 #endif
 	}
@@ -922,6 +1315,7 @@ static struct net_buf *pkt_alloc_buffer(struct net_buf_pool *pool,
 	struct net_buf *buf;
 
 	buf = net_buf_alloc_len(pool, size, timeout);
+	pool_stats_update(pool, buf);
 
 #if CONFIG_NET_PKT_LOG_LEVEL >= LOG_LEVEL_DBG
 	NET_FRAG_CHECK_IF_NOT_IN_USE(buf, buf->ref + 1);
@@ -1021,6 +1415,108 @@ static size_t pkt_get_size(struct net_pkt *pkt)
 	return size;
 }
 
+#if defined(CONFIG_NET_PKT_QUOTA)
+/* Charge the data allocated for a packet to its network context, when
+ * sending, and to its network interface. A packet stays charged to the
+ * quotas of its first allocation.
+ *
+ * Packets of a context are allocated with the context locked, and the
+ * memory is released by the RX path of that same context (e.g. when TCP
+ * data is acknowledged), so these never wait for the quotas: the context
+ * reports -EAGAIN and its writable callback is called once memory is
+ * released.
+ */
+static int pkt_quota_charge(struct net_pkt *pkt, size_t len, s32_t timeout)
+{
+	u32_t alloc_start = k_uptime_get_32();
+	struct net_pkt_quota *ctx_quota = pkt->ctx_quota;
+	struct net_pkt_quota *iface_quota = pkt->iface_quota;
+
+	if (pkt->context) {
+		timeout = K_NO_WAIT;
+	}
+
+	if (!ctx_quota && pkt->context && pkt->slab != &rx_pkts) {
+		ctx_quota = &pkt->context->tx_quota;
+	}
+
+	if (!iface_quota && pkt->iface) {
+		iface_quota = &pkt->iface->mem_quota;
+	}
+
+	if (ctx_quota) {
+		if (quota_charge(ctx_quota, len, timeout)) {
+			NET_DBG("Context %p over its quota", pkt->context);
+			return -ENOBUFS;
+		}
+
+		pkt->ctx_quota = ctx_quota;
+		pkt->ctx_charged += len;
+	}
+
+	if (timeout != K_NO_WAIT && timeout != K_FOREVER) {
+		u32_t diff = k_uptime_get_32() - alloc_start;
+
+		timeout -= MIN(timeout, diff);
+	}
+
+	if (iface_quota) {
+		if (quota_charge(iface_quota, len, timeout)) {
+			NET_DBG("Iface %p over its quota", pkt->iface);
+
+			if (ctx_quota) {
+				(void)quota_release(ctx_quota, len);
+				pkt->ctx_charged -= len;
+			}
+
+			return -ENOBUFS;
+		}
+
+		pkt->iface_quota = iface_quota;
+		pkt->iface_charged += len;
+	}
+
+	return 0;
+}
+
+static void pkt_quota_uncharge(struct net_pkt *pkt, size_t len)
+{
+	if (pkt->ctx_quota) {
+		ctx_quota_release(pkt, len);
+		pkt->ctx_charged -= len;
+	}
+
+	if (pkt->iface_quota) {
+		(void)quota_release(pkt->iface_quota, len);
+		pkt->iface_charged -= len;
+	}
+}
+
+int net_pkt_quota_charge_rx(struct net_pkt *pkt, struct net_pkt_quota *quota)
+{
+	size_t len;
+
+	/* Already charged to a context */
+	if (pkt->ctx_quota) {
+		return 0;
+	}
+
+	len = pkt_get_size(pkt);
+
+	if (quota_charge(quota, len, K_NO_WAIT)) {
+		return -ENOBUFS;
+	}
+
+	pkt->ctx_quota = quota;
+	pkt->ctx_charged = len;
+
+	return 0;
+}
+#else
+#define pkt_quota_charge(...) 0
+#define pkt_quota_uncharge(...)
+#endif /* CONFIG_NET_PKT_QUOTA */
+
 size_t net_pkt_available_buffer(struct net_pkt *pkt)
 {
 	if (!pkt) {
@@ -1130,6 +1626,10 @@ int net_pkt_alloc_buffer(struct net_pkt *pkt,
 		pool = pkt->slab == &tx_pkts ? &tx_bufs : &rx_bufs;
 	}
 
+	if (pkt_quota_charge(pkt, alloc_len, timeout)) {
+		return -ENOBUFS;
+	}
+
 	if (timeout != K_NO_WAIT && timeout != K_FOREVER) {
 		u32_t diff = k_uptime_get_32() - alloc_start;
 
@@ -1144,6 +1644,7 @@ int net_pkt_alloc_buffer(struct net_pkt *pkt,
 
 	if (!buf) {
 		NET_ERR("Data buffer allocation failed.");
+		pkt_quota_uncharge(pkt, alloc_len);
 		return -ENOMEM;
 	}
 
@@ -1757,7 +2258,7 @@ int net_pkt_pull(struct net_pkt *pkt, size_t length)
 	net_pkt_cursor_backup(pkt, &backup);
 
 	while (length) {
-		u8_t left, rem;
+		size_t left, rem;
 
 		pkt_cursor_advance(pkt, false);
 
@@ -1774,7 +2275,7 @@ int net_pkt_pull(struct net_pkt *pkt, size_t length)
 		c_op->buf->len -= rem;
 		left -= rem;
 		if (left) {
-			memmove(c_op->pos, c_op->pos+rem, rem);
+			memmove(c_op->pos, c_op->pos + rem, left);
 		}
 
 		/* For now, empty buffer are not freed, and there is no
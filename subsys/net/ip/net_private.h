@@ -49,6 +49,18 @@ extern void net_tc_tx_init(void);
 extern void net_tc_rx_init(void);
 extern void net_tc_submit_to_tx_queue(u8_t tc, struct net_pkt *pkt);
 extern void net_tc_submit_to_rx_queue(u8_t tc, struct net_pkt *pkt);
+extern void net_tc_submit_burst_to_rx_queues(struct net_pkt **pkts, int count);
+extern void net_if_tx_burst(struct net_if *iface, struct net_pkt **pkts,
+			    int count);
+
+#if defined(CONFIG_NET_QDISC)
+extern bool net_if_tx(struct net_if *iface, struct net_pkt *pkt);
+extern struct k_work_q *net_tc_tx_work_q(u8_t tc);
+extern u32_t net_tc_flow_hash(struct net_pkt *pkt, bool l2_hdr);
+extern bool net_qdisc_enqueue(struct net_if *iface, struct net_pkt *pkt);
+#else
+#define net_qdisc_enqueue(...) false
+#endif /* CONFIG_NET_QDISC */
 extern enum net_verdict net_promisc_mode_input(struct net_pkt *pkt);
 
 char *net_sprint_addr(sa_family_t af, const void *addr);
@@ -57,6 +69,17 @@ char *net_sprint_addr(sa_family_t af, const void *addr);
 
 #define net_sprint_ipv6_addr(_addr) net_sprint_addr(AF_INET6, _addr)
 
+#if defined(CONFIG_NET_PKT_QUOTA)
+extern void net_pkt_quota_init_context(struct net_context *context);
+extern void net_pkt_quota_init_iface(struct net_if *iface);
+extern int net_pkt_quota_charge_rx(struct net_pkt *pkt,
+				   struct net_pkt_quota *quota);
+#else
+#define net_pkt_quota_init_context(...)
+#define net_pkt_quota_init_iface(...)
+#define net_pkt_quota_charge_rx(...) 0
+#endif /* CONFIG_NET_PKT_QUOTA */
+
 #if defined(CONFIG_NET_GPTP)
 /**
  * @brief Initialize Precision Time Protocol Layer.
@@ -124,6 +147,41 @@ static inline u16_t net_calc_chksum_tcp(struct net_pkt *pkt)
 	return net_calc_chksum(pkt, IPPROTO_TCP);
 }
 
+/* Initial value of a FNV-1a hash */
+#define NET_HASH_FNV1A_INIT 2166136261U
+
+/* Add bytes to a FNV-1a hash, started with NET_HASH_FNV1A_INIT */
+static inline u32_t net_hash_fnv1a(u32_t hash, const void *data, size_t len)
+{
+	const u8_t *ptr = data;
+
+	while (len--) {
+		hash = (hash ^ *ptr++) * 16777619U;
+	}
+
+	return hash;
+}
+
+/* Add a 32-bit word to a Jenkins one-at-a-time hash, started with 0 */
+static inline u32_t net_hash_oaat_add(u32_t hash, u32_t value)
+{
+	hash += value;
+	hash += hash << 10;
+	hash ^= hash >> 6;
+
+	return hash;
+}
+
+/* Final mixing of a Jenkins one-at-a-time hash */
+static inline u32_t net_hash_oaat_final(u32_t hash)
+{
+	hash += hash << 3;
+	hash ^= hash >> 11;
+	hash += hash << 15;
+
+	return hash;
+}
+
 static inline char *net_sprint_ll_addr(const u8_t *ll, u8_t ll_len)
 {
 	static char buf[sizeof("xx:xx:xx:xx:xx:xx:xx:xx")];
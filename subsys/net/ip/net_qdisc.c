@@ -0,0 +1,752 @@
+/** @file
+ * @brief Network queueing disciplines
+ *
+ * The packets sent by an interface with a queueing discipline are queued
+ * to it by net_if_queue_tx(), instead of to the Tx traffic classes. The
+ * queueing discipline is then run by the Tx thread of the highest traffic
+ * class: it dequeues the packets in the order of its scheduling policy,
+ * and sends them while its token bucket allows.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_qdisc, CONFIG_NET_QDISC_LOG_LEVEL);
+
+#include <kernel.h>
+#include <spinlock.h>
+#include <errno.h>
+#include <string.h>
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/net_mgmt.h>
+#include <net/qdisc.h>
+
+#include "net_private.h"
+#include "net_stats.h"
+
+#define FQ_FLOWS CONFIG_NET_QDISC_FQ_FLOWS
+
+#define DEFAULT_TARGET (5 * USEC_PER_MSEC)
+#define DEFAULT_INTERVAL (100 * USEC_PER_MSEC)
+
+/* The Tx thread running the queueing disciplines */
+#define QDISC_TC (NET_TC_TX_COUNT - 1)
+
+/* Max number of packets sent by a run of a queueing discipline, before
+ * the other work items of the Tx thread get a chance to run.
+ */
+#define RUN_BUDGET 16
+
+struct fq_flow {
+	/* Link in the list of new or old flows */
+	sys_snode_t node;
+	sys_slist_t pkts;
+	s32_t deficit;
+	u16_t count;
+	/* In the list of new or old flows */
+	bool active;
+
+	/* CoDel state, see RFC 8289 */
+	bool dropping;
+	u32_t first_above_time;
+	u32_t drop_next;
+	u32_t drop_count;
+	u32_t last_drop_count;
+};
+
+struct qdisc {
+	struct net_if *iface;
+	struct net_qdisc_config config;
+	struct k_delayed_work work;
+	/* The work is submitted, possibly with a delay */
+	atomic_t scheduled;
+	bool initialized;
+
+	/* Token bucket, in bytes times MSEC_PER_SEC */
+	u64_t tokens;
+	s64_t last_fill;
+
+	/* Packet dequeued, waiting for enough tokens */
+	struct net_pkt *next;
+	u8_t next_band;
+
+	/* Number of packets queued */
+	u16_t count;
+
+	union {
+		sys_slist_t bands[NET_QDISC_PRIO_BANDS];
+
+		struct {
+			struct fq_flow flows[FQ_FLOWS];
+			sys_slist_t new_flows;
+			sys_slist_t old_flows;
+		} fq;
+	};
+};
+
+static struct qdisc qdiscs[CONFIG_NET_QDISC_IFACE_COUNT];
+
+/* Protects the queueing disciplines, taken by the senders and by the
+ * Tx thread.
+ */
+static struct k_spinlock lock;
+
+static struct qdisc *qdisc_find(struct net_if *iface)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(qdiscs); i++) {
+		if (qdiscs[i].iface == iface) {
+			return &qdiscs[i];
+		}
+	}
+
+	return NULL;
+}
+
+static inline u32_t cycles_to_us(u32_t cycles)
+{
+	return (u32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) / NSEC_PER_USEC);
+}
+
+/* CoDel time in microseconds, wrapping around */
+static inline u32_t codel_now(void)
+{
+	return (u32_t)k_uptime_get() * USEC_PER_MSEC;
+}
+
+static inline bool time_after_eq(u32_t a, u32_t b)
+{
+	return (s32_t)(a - b) >= 0;
+}
+
+static inline struct net_pkt *node_to_pkt(sys_snode_t *node)
+{
+	return node ? CONTAINER_OF(node, struct net_pkt, burst_node) : NULL;
+}
+
+static u8_t prio_band(struct net_pkt *pkt)
+{
+	switch (net_pkt_priority(pkt)) {
+	case NET_PRIORITY_NC:
+	case NET_PRIORITY_IC:
+	case NET_PRIORITY_VO:
+		return 0;
+	case NET_PRIORITY_BK:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+static u32_t isqrt(u32_t value)
+{
+	u32_t root = 0U;
+	u32_t bit = BIT(30);
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+
+	while (bit) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+
+		bit >>= 2;
+	}
+
+	return root;
+}
+
+static inline u32_t codel_control_law(struct qdisc *q, u32_t t, u32_t count)
+{
+	return t + q->config.interval / isqrt(count);
+}
+
+static struct net_pkt *flow_pop(struct qdisc *q, struct fq_flow *flow)
+{
+	struct net_pkt *pkt = node_to_pkt(sys_slist_get(&flow->pkts));
+
+	if (pkt) {
+		flow->count--;
+		q->count--;
+	}
+
+	return pkt;
+}
+
+/* Whether the queue delay of the flow has been above the target for at
+ * least an interval. A flow is left at least one packet, as there is no
+ * queue to manage then.
+ */
+static bool codel_should_drop(struct qdisc *q, struct fq_flow *flow,
+			      struct net_pkt *pkt, u32_t now)
+{
+	u32_t sojourn = cycles_to_us(k_cycle_get_32() - pkt->qdisc_time);
+
+	if (sojourn < q->config.target || !flow->count) {
+		flow->first_above_time = 0U;
+		return false;
+	}
+
+	if (!flow->first_above_time) {
+		flow->first_above_time = now + q->config.interval;
+		return false;
+	}
+
+	return time_after_eq(now, flow->first_above_time);
+}
+
+static struct net_pkt *codel_dequeue(struct qdisc *q, struct fq_flow *flow,
+				     sys_slist_t *drops)
+{
+	u32_t now = codel_now();
+	struct net_pkt *pkt;
+	u32_t delta;
+	bool drop;
+
+	pkt = flow_pop(q, flow);
+	if (!pkt) {
+		flow->dropping = false;
+		return NULL;
+	}
+
+	drop = codel_should_drop(q, flow, pkt, now);
+
+	if (flow->dropping) {
+		if (!drop) {
+			flow->dropping = false;
+		}
+
+		while (flow->dropping && time_after_eq(now, flow->drop_next)) {
+			sys_slist_append(drops, &pkt->burst_node);
+			flow->drop_count++;
+
+			pkt = flow_pop(q, flow);
+			if (!pkt || !codel_should_drop(q, flow, pkt, now)) {
+				flow->dropping = false;
+			} else {
+				flow->drop_next = codel_control_law(
+					q, flow->drop_next, flow->drop_count);
+			}
+		}
+	} else if (drop) {
+		sys_slist_append(drops, &pkt->burst_node);
+		pkt = flow_pop(q, flow);
+
+		flow->dropping = true;
+
+		/* Start from the previous drop rate if the flow was in
+		 * dropping state recently.
+		 */
+		delta = flow->drop_count - flow->last_drop_count;
+		if (delta > 1 &&
+		    !time_after_eq(now, flow->drop_next +
+				   16 * q->config.interval)) {
+			flow->drop_count = delta;
+		} else {
+			flow->drop_count = 1U;
+		}
+
+		flow->last_drop_count = flow->drop_count;
+		flow->drop_next = codel_control_law(q, now, flow->drop_count);
+	}
+
+	return pkt;
+}
+
+static void fq_enqueue(struct qdisc *q, struct net_pkt *pkt, u32_t hash,
+		       sys_slist_t *drops)
+{
+	struct fq_flow *flow = &q->fq.flows[hash % FQ_FLOWS];
+	struct fq_flow *fattest;
+	int i;
+
+	sys_slist_append(&flow->pkts, &pkt->burst_node);
+	flow->count++;
+	q->count++;
+
+	if (!flow->active) {
+		flow->active = true;
+		flow->deficit = q->config.quantum;
+		sys_slist_append(&q->fq.new_flows, &flow->node);
+	}
+
+	if (q->count <= q->config.limit) {
+		return;
+	}
+
+	/* Drop the oldest packet of the largest flow */
+	fattest = &q->fq.flows[0];
+
+	for (i = 1; i < FQ_FLOWS; i++) {
+		if (q->fq.flows[i].count > fattest->count) {
+			fattest = &q->fq.flows[i];
+		}
+	}
+
+	pkt = flow_pop(q, fattest);
+	sys_slist_append(drops, &pkt->burst_node);
+}
+
+static struct net_pkt *fq_dequeue(struct qdisc *q, sys_slist_t *drops)
+{
+	struct fq_flow *flow;
+	struct net_pkt *pkt;
+	sys_slist_t *list;
+	sys_snode_t *node;
+
+	while (1) {
+		if (!sys_slist_is_empty(&q->fq.new_flows)) {
+			list = &q->fq.new_flows;
+		} else {
+			list = &q->fq.old_flows;
+		}
+
+		node = sys_slist_get(list);
+		if (!node) {
+			return NULL;
+		}
+
+		flow = CONTAINER_OF(node, struct fq_flow, node);
+
+		if (flow->deficit <= 0) {
+			flow->deficit += q->config.quantum;
+			sys_slist_append(&q->fq.old_flows, node);
+			continue;
+		}
+
+		pkt = codel_dequeue(q, flow, drops);
+		if (!pkt) {
+			/* A new flow goes through the old flows before
+			 * leaving, so that it cannot get a new quantum by
+			 * sending one packet at a time.
+			 */
+			if (list == &q->fq.new_flows &&
+			    !sys_slist_is_empty(&q->fq.old_flows)) {
+				sys_slist_append(&q->fq.old_flows, node);
+			} else {
+				flow->active = false;
+			}
+
+			continue;
+		}
+
+		flow->deficit -= net_pkt_get_len(pkt);
+		sys_slist_prepend(list, node);
+
+		return pkt;
+	}
+}
+
+static struct net_pkt *prio_dequeue(struct qdisc *q, u8_t *band)
+{
+	struct net_pkt *pkt;
+	int i;
+
+	for (i = 0; i < NET_QDISC_PRIO_BANDS; i++) {
+		pkt = node_to_pkt(sys_slist_get(&q->bands[i]));
+		if (pkt) {
+			q->count--;
+			*band = i;
+
+			return pkt;
+		}
+	}
+
+	return NULL;
+}
+
+static void tokens_fill(struct qdisc *q)
+{
+	u64_t max = (u64_t)q->config.burst * MSEC_PER_SEC;
+	s64_t now = k_uptime_get();
+
+	q->tokens += (u64_t)(now - q->last_fill) * q->config.rate;
+	q->last_fill = now;
+
+	if (q->tokens > max) {
+		q->tokens = max;
+	}
+}
+
+/* Returns the next packet to send, or NULL. If the token bucket does not
+ * allow sending it yet, sets the delay to wait for.
+ */
+static struct net_pkt *qdisc_next(struct qdisc *q, u8_t *band,
+				  sys_slist_t *drops, s32_t *delay)
+{
+	struct net_pkt *pkt = q->next;
+	u64_t needed;
+
+	*band = 0U;
+
+	if (pkt) {
+		*band = q->next_band;
+		q->next = NULL;
+	} else if (q->config.type == NET_QDISC_FQ_CODEL) {
+		pkt = fq_dequeue(q, drops);
+	} else {
+		pkt = prio_dequeue(q, band);
+	}
+
+	if (!pkt || !q->config.rate) {
+		return pkt;
+	}
+
+	tokens_fill(q);
+
+	needed = (u64_t)net_pkt_get_len(pkt) * MSEC_PER_SEC;
+	if (q->tokens < needed) {
+		q->next = pkt;
+		q->next_band = *band;
+
+		*delay = (needed - q->tokens + q->config.rate - 1) /
+			q->config.rate;
+
+		return NULL;
+	}
+
+	q->tokens -= needed;
+
+	return pkt;
+}
+
+static void qdisc_schedule(struct qdisc *q, s32_t delay)
+{
+	if (atomic_cas(&q->scheduled, 0, 1)) {
+		k_delayed_work_submit_to_queue(net_tc_tx_work_q(QDISC_TC),
+					       &q->work, delay);
+	}
+}
+
+static void drop_all(struct net_if *iface, enum net_qdisc_type type,
+		     sys_slist_t *drops)
+{
+	struct net_pkt *pkt;
+
+	while ((pkt = node_to_pkt(sys_slist_get(drops)))) {
+		NET_DBG("Dropping pkt %p", pkt);
+
+		net_stats_update_qdisc_dropped(
+			iface, type == NET_QDISC_PRIO ? prio_band(pkt) : 0);
+
+		net_pkt_unref(pkt);
+	}
+}
+
+static void qdisc_run(struct k_work *work)
+{
+	struct qdisc *q = CONTAINER_OF(work, struct qdisc, work.work);
+	enum net_qdisc_type type = NET_QDISC_NONE;
+	struct net_if *iface = NULL;
+	struct net_pkt *pkt = NULL;
+	k_spinlock_key_t key;
+	sys_slist_t drops;
+	s32_t delay = 0;
+	bool more = false;
+	size_t len;
+	u32_t queued;
+	u8_t band;
+	int sent;
+
+	atomic_set(&q->scheduled, 0);
+
+	for (sent = 0; ; sent++) {
+		sys_slist_init(&drops);
+
+		key = k_spin_lock(&lock);
+
+		if (q->iface && sent < RUN_BUDGET) {
+			iface = q->iface;
+			type = q->config.type;
+			pkt = qdisc_next(q, &band, &drops, &delay);
+		} else {
+			pkt = NULL;
+			more = q->iface && (q->next || q->count);
+		}
+
+		k_spin_unlock(&lock, key);
+
+		drop_all(iface, type, &drops);
+
+		if (!pkt) {
+			break;
+		}
+
+		len = net_pkt_get_len(pkt);
+		queued = cycles_to_us(k_cycle_get_32() - pkt->qdisc_time);
+
+		net_stats_update_qdisc_sent(iface, band, len);
+		net_stats_update_qdisc_delay(iface, band, queued);
+
+		net_if_tx(iface, pkt);
+	}
+
+	if (delay) {
+		qdisc_schedule(q, delay);
+	} else if (more) {
+		qdisc_schedule(q, K_NO_WAIT);
+	}
+}
+
+bool net_qdisc_enqueue(struct net_if *iface, struct net_pkt *pkt)
+{
+	enum net_qdisc_type type;
+	k_spinlock_key_t key;
+	sys_slist_t drops;
+	struct qdisc *q;
+	u32_t hash;
+	u8_t band;
+
+	if (!net_if_flag_is_set(iface, NET_IF_QDISC)) {
+		return false;
+	}
+
+	sys_slist_init(&drops);
+
+	/* Parse the packet before taking the lock */
+	hash = net_tc_flow_hash(pkt, false);
+	band = prio_band(pkt);
+
+	pkt->qdisc_time = k_cycle_get_32();
+
+	key = k_spin_lock(&lock);
+
+	q = qdisc_find(iface);
+	if (!q) {
+		k_spin_unlock(&lock, key);
+		return false;
+	}
+
+	type = q->config.type;
+
+	if (type == NET_QDISC_FQ_CODEL) {
+		fq_enqueue(q, pkt, hash, &drops);
+	} else if (q->count < q->config.limit) {
+		if (type != NET_QDISC_PRIO) {
+			band = 0U;
+		}
+
+		sys_slist_append(&q->bands[band], &pkt->burst_node);
+		q->count++;
+	} else {
+		sys_slist_append(&drops, &pkt->burst_node);
+	}
+
+	k_spin_unlock(&lock, key);
+
+	drop_all(iface, type, &drops);
+
+	qdisc_schedule(q, K_NO_WAIT);
+
+	return true;
+}
+
+/* Called with the lock held */
+static void qdisc_purge(struct qdisc *q, sys_slist_t *drops)
+{
+	struct net_pkt *pkt;
+	int i;
+
+	if (q->next) {
+		sys_slist_append(drops, &q->next->burst_node);
+		q->next = NULL;
+	}
+
+	if (q->config.type == NET_QDISC_FQ_CODEL) {
+		for (i = 0; i < FQ_FLOWS; i++) {
+			while ((pkt = flow_pop(q, &q->fq.flows[i]))) {
+				sys_slist_append(drops, &pkt->burst_node);
+			}
+		}
+	} else {
+		for (i = 0; i < NET_QDISC_PRIO_BANDS; i++) {
+			sys_slist_merge_slist(drops, &q->bands[i]);
+		}
+	}
+
+	q->count = 0U;
+}
+
+/* Called with the lock held */
+static void qdisc_reset(struct qdisc *q, const struct net_qdisc_config *config)
+{
+	int i;
+
+	q->config = *config;
+	q->tokens = (u64_t)config->burst * MSEC_PER_SEC;
+	q->last_fill = k_uptime_get();
+	q->next = NULL;
+	q->count = 0U;
+
+	if (config->type == NET_QDISC_FQ_CODEL) {
+		(void)memset(&q->fq, 0, sizeof(q->fq));
+
+		for (i = 0; i < FQ_FLOWS; i++) {
+			sys_slist_init(&q->fq.flows[i].pkts);
+		}
+
+		sys_slist_init(&q->fq.new_flows);
+		sys_slist_init(&q->fq.old_flows);
+	} else {
+		for (i = 0; i < NET_QDISC_PRIO_BANDS; i++) {
+			sys_slist_init(&q->bands[i]);
+		}
+	}
+}
+
+static int config_check(struct net_if *iface, struct net_qdisc_config *config)
+{
+	u16_t mtu = net_if_get_mtu(iface);
+
+	if (!mtu) {
+		mtu = NET_IPV6_MTU;
+	}
+
+	switch (config->type) {
+	case NET_QDISC_NONE:
+		return 0;
+	case NET_QDISC_TBF:
+		if (!config->rate) {
+			return -EINVAL;
+		}
+
+		break;
+	case NET_QDISC_PRIO:
+	case NET_QDISC_FQ_CODEL:
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	if (!config->burst) {
+		config->burst = MAX(mtu, config->rate / 100U);
+	} else if (config->rate && config->burst < mtu) {
+		return -EINVAL;
+	}
+
+	if (!config->limit) {
+		config->limit = CONFIG_NET_QDISC_LIMIT;
+	}
+
+	if (!config->quantum) {
+		config->quantum = mtu;
+	}
+
+	if (!config->target) {
+		config->target = DEFAULT_TARGET;
+	}
+
+	if (!config->interval) {
+		config->interval = DEFAULT_INTERVAL;
+	}
+
+	return 0;
+}
+
+int net_qdisc_set(struct net_if *iface, const struct net_qdisc_config *config)
+{
+	enum net_qdisc_type type = NET_QDISC_NONE;
+	struct net_qdisc_config checked = *config;
+	k_spinlock_key_t key;
+	sys_slist_t drops;
+	struct qdisc *q;
+	int ret;
+
+	ret = config_check(iface, &checked);
+	if (ret < 0) {
+		return ret;
+	}
+
+	sys_slist_init(&drops);
+
+	key = k_spin_lock(&lock);
+
+	q = qdisc_find(iface);
+	if (q) {
+		type = q->config.type;
+		qdisc_purge(q, &drops);
+	} else if (checked.type != NET_QDISC_NONE) {
+		q = qdisc_find(NULL);
+		if (!q) {
+			ret = -ENOMEM;
+			goto out;
+		}
+
+		if (!q->initialized) {
+			k_delayed_work_init(&q->work, qdisc_run);
+			q->initialized = true;
+		}
+	} else {
+		goto out;
+	}
+
+	if (checked.type == NET_QDISC_NONE) {
+		net_if_flag_clear(iface, NET_IF_QDISC);
+		q->iface = NULL;
+	} else {
+		qdisc_reset(q, &checked);
+		q->iface = iface;
+		net_if_flag_set(iface, NET_IF_QDISC);
+	}
+
+	NET_DBG("iface %p qdisc type %d rate %u burst %u limit %u", iface,
+		checked.type, checked.rate, checked.burst, checked.limit);
+
+out:
+	k_spin_unlock(&lock, key);
+
+	drop_all(iface, type, &drops);
+
+	return ret;
+}
+
+int net_qdisc_get(struct net_if *iface, struct net_qdisc_config *config)
+{
+	k_spinlock_key_t key;
+	struct qdisc *q;
+
+	key = k_spin_lock(&lock);
+
+	q = qdisc_find(iface);
+	if (q) {
+		*config = q->config;
+	} else {
+		(void)memset(config, 0, sizeof(*config));
+		config->type = NET_QDISC_NONE;
+	}
+
+	k_spin_unlock(&lock, key);
+
+	return 0;
+}
+
+static int qdisc_mgmt_request(u32_t mgmt_request, struct net_if *iface,
+			      void *data, size_t len)
+{
+	if (!iface || !data || len != sizeof(struct net_qdisc_config)) {
+		return -EINVAL;
+	}
+
+	if (mgmt_request == NET_REQUEST_QDISC_SET) {
+		return net_qdisc_set(iface, data);
+	}
+
+	return net_qdisc_get(iface, data);
+}
+
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_QDISC_SET, qdisc_mgmt_request);
+
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_QDISC_GET, qdisc_mgmt_request);
@@ -21,6 +21,8 @@ LOG_MODULE_REGISTER(net_shell, LOG_LEVEL_DBG);
 
 #include <net/net_if.h>
 #include <net/dns_resolve.h>
+#include <net/capture.h>
+#include <net/qdisc.h>
 #include <misc/printk.h>
 
 #include "route.h"
@@ -33,6 +35,7 @@ LOG_MODULE_REGISTER(net_shell, LOG_LEVEL_DBG);
 #endif
 
 #include "ipv6.h"
+#include "ipv4.h"
 
 #if defined(CONFIG_NET_ARP)
 #include "ethernet/arp.h"
@@ -582,6 +585,43 @@ static void iface_per_route_cb(struct net_if *iface, void *user_data)
 }
 #endif /* CONFIG_NET_ROUTE */
 
+#if defined(CONFIG_NET_ROUTE_IPV4)
+static void route_ipv4_cb(struct net_route_entry_ipv4 *entry, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	struct net_if *iface = data->user_data;
+
+	if (entry->iface != iface) {
+		return;
+	}
+
+	PR("IPv4 prefix : %s/%d	", net_sprint_ipv4_addr(&entry->addr),
+	   entry->prefix_len);
+
+	if (net_ipv4_is_addr_unspecified(&entry->gw)) {
+		PR("gateway : <on link>\n");
+	} else {
+		PR("gateway : %s\n", net_sprint_ipv4_addr(&entry->gw));
+	}
+}
+
+static void iface_per_route_ipv4_cb(struct net_if *iface, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	const char *extra;
+
+	PR("\nIPv4 routes for interface %p (%s)\n", iface,
+	   iface2str(iface, &extra));
+	PR("=======================================%s\n", extra);
+
+	data->user_data = iface;
+
+	net_route_ipv4_foreach(route_ipv4_cb, data);
+}
+#endif /* CONFIG_NET_ROUTE_IPV4 */
+
 #if defined(CONFIG_NET_ROUTE_MCAST)
 static void route_mcast_cb(struct net_route_entry_mcast *entry,
 			   void *user_data)
@@ -805,6 +845,39 @@ static void net_shell_print_statistics(struct net_if *iface, void *user_data)
 #endif
 #endif /* NET_TC_COUNT > 1 */
 
+#if NET_RX_FLOW_QUEUE_COUNT > 1
+	{
+		int i;
+
+		PR("RX flow queue statistics:\n");
+		PR("Queue\tRecv pkts\tbytes\n");
+
+		for (i = 0; i < NET_RX_FLOW_QUEUE_COUNT; i++) {
+			PR("[%d]\t%d\t\t%d\n", i,
+			   GET_STAT(iface, rx_queue[i].pkts),
+			   GET_STAT(iface, rx_queue[i].bytes));
+		}
+	}
+#endif /* NET_RX_FLOW_QUEUE_COUNT > 1 */
+
+#if defined(CONFIG_NET_QDISC)
+	{
+		int i;
+
+		PR("Queueing discipline statistics:\n");
+		PR("Band\tSent pkts\tbytes\tdropped\tdelay avg\tmax\n");
+
+		for (i = 0; i < NET_QDISC_PRIO_BANDS; i++) {
+			PR("[%d]\t%d\t\t%d\t%d\t%d us\t\t%d us\n", i,
+			   GET_STAT(iface, qdisc[i].pkts),
+			   GET_STAT(iface, qdisc[i].bytes),
+			   GET_STAT(iface, qdisc[i].dropped),
+			   GET_STAT(iface, qdisc[i].delay_avg),
+			   GET_STAT(iface, qdisc[i].delay_max));
+		}
+	}
+#endif /* CONFIG_NET_QDISC */
+
 #if defined(CONFIG_NET_STATISTICS_ETHERNET) && \
 					defined(CONFIG_NET_STATISTICS_USER_API)
 	if (iface && net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET)) {
@@ -1031,9 +1104,8 @@ static void tcp_sent_list_cb(struct net_tcp *tcp, void *user_data)
 #endif /* CONFIG_NET_TCP_LOG_LEVEL >= LOG_LEVEL_DBG */
 #endif
 
-#if defined(CONFIG_NET_IPV6_FRAGMENT)
-static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
-			 void *user_data)
+#if defined(CONFIG_NET_REASSEMBLY)
+static void ip_frag_cb(struct net_reass *reass, void *user_data)
 {
 	struct net_shell_user_data *data = user_data;
 	const struct shell *shell = data->shell;
@@ -1042,39 +1114,39 @@ static void ipv6_frag_cb(struct net_ipv6_reassembly *reass,
 	int i;
 
 	if (!*count) {
-		PR("\nIPv6 reassembly Id         Remain "
-		   "Src             \tDst\n");
+		PR("\n%s reassembly Id         Remain "
+		   "Src             \tDst\n",
+		   reass->src.family == AF_INET6 ? "IPv6" : "IPv4");
 	}
 
-	snprintk(src, ADDR_LEN, "%s", net_sprint_ipv6_addr(&reass->src));
+	snprintk(src, ADDR_LEN, "%s",
+		 net_sprint_addr(reass->src.family, &reass->src.in6_addr));
 
 	PR("%p      0x%08x  %5d %16s\t%16s\n",
-	   reass, reass->id,
-	   k_delayed_work_remaining_get(&reass->timer),
-	   src, net_sprint_ipv6_addr(&reass->dst));
+	   reass, reass->id, net_reass_remaining(reass),
+	   src, net_sprint_addr(reass->dst.family, &reass->dst.in6_addr));
 
-	for (i = 0; i < NET_IPV6_FRAGMENTS_MAX_PKT; i++) {
-		if (reass->pkt[i]) {
-			struct net_buf *frag = reass->pkt[i]->frags;
+	for (i = 0; i < reass->count; i++) {
+		struct net_buf *frag = reass->frags[i].pkt->frags;
 
-			PR("[%d] pkt %p->", i, reass->pkt[i]);
+		PR("[%d] %u-%u pkt %p->", i, reass->frags[i].start,
+		   reass->frags[i].end, reass->frags[i].pkt);
 
-			while (frag) {
-				PR("%p", frag);
+		while (frag) {
+			PR("%p", frag);
 
-				frag = frag->frags;
-				if (frag) {
-					PR("->");
-				}
+			frag = frag->frags;
+			if (frag) {
+				PR("->");
 			}
-
-			PR("\n");
 		}
+
+		PR("\n");
 	}
 
 	(*count)++;
 }
-#endif /* CONFIG_NET_IPV6_FRAGMENT */
+#endif /* CONFIG_NET_REASSEMBLY */
 
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
 static void allocs_cb(struct net_pkt *pkt,
@@ -1291,11 +1363,17 @@ static int cmd_net_conn(const struct shell *shell, size_t argc, char *argv[])
 #if defined(CONFIG_NET_IPV6_FRAGMENT)
 	count = 0;
 
-	net_ipv6_frag_foreach(ipv6_frag_cb, &user_data);
+	net_ipv6_frag_foreach(ip_frag_cb, &user_data);
 
 	/* Do not print anything if no fragments are pending atm */
 #endif
 
+#if defined(CONFIG_NET_IPV4_FRAGMENT)
+	count = 0;
+
+	net_ipv4_frag_foreach(ip_frag_cb, &user_data);
+#endif
+
 	return 0;
 }
 
@@ -1489,6 +1567,84 @@ static int cmd_net_dns_query(const struct shell *shell, size_t argc,
 	return 0;
 }
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+static void dns_cache_cb(struct dns_cache_entry *entry, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	int *count = data->user_data;
+	int i;
+
+	if (*count == 0) {
+		PR("     Type Expires  Name\n");
+	}
+
+	PR("[%2d] %-4s %-8d %s\n", *count,
+	   entry->type == DNS_QUERY_TYPE_A ? "A" : "AAAA",
+	   (s32_t)(entry->expiry - k_uptime_get_32()), entry->name);
+
+	if (!entry->count) {
+		PR("\t<no address>\n");
+	}
+
+	for (i = 0; i < entry->count; i++) {
+		if (entry->type == DNS_QUERY_TYPE_A) {
+			PR("\t%s\n",
+			   net_sprint_ipv4_addr(&entry->addr[i].in_addr));
+		} else if (IS_ENABLED(CONFIG_NET_IPV6)) {
+			PR("\t%s\n",
+			   net_sprint_ipv6_addr(&entry->addr[i].in6_addr));
+		}
+	}
+
+	(*count)++;
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
+static int cmd_net_dns_cache(const struct shell *shell, size_t argc,
+			     char *argv[])
+{
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	struct net_shell_user_data user_data;
+	int count = 0;
+#endif
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	user_data.shell = shell;
+	user_data.user_data = &count;
+
+	if (dns_resolve_cache_foreach(dns_resolve_get_default(),
+				      dns_cache_cb, &user_data) == 0) {
+		PR("DNS cache is empty.\n");
+	}
+#else
+	PR_INFO("DNS cache not supported. Set CONFIG_DNS_RESOLVER_CACHE to "
+		"enable it.\n");
+#endif
+
+	return 0;
+}
+
+static int cmd_net_dns_cache_flush(const struct shell *shell, size_t argc,
+				   char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	PR("Flushing DNS cache.\n");
+	dns_resolve_cache_flush(dns_resolve_get_default());
+#else
+	PR_INFO("DNS cache not supported. Set CONFIG_DNS_RESOLVER_CACHE to "
+		"enable it.\n");
+#endif
+
+	return 0;
+}
+
 static int cmd_net_dns(const struct shell *shell, size_t argc, char *argv[])
 {
 #if defined(CONFIG_DNS_RESOLVER)
@@ -2059,6 +2215,51 @@ static int cmd_net_gptp_port(const struct shell *shell, size_t argc,
 	return 0;
 }
 
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+static const char *servo2str(enum gptp_servo_state state)
+{
+	switch (state) {
+	case GPTP_SERVO_UNLOCKED:
+		return "UNLOCKED";
+	case GPTP_SERVO_JUMP:
+		return "JUMP";
+	case GPTP_SERVO_LOCKED:
+		return "LOCKED";
+	}
+
+	return "<unknown>";
+}
+
+static void gptp_print_servo(const struct shell *shell)
+{
+	struct gptp_servo_stats stats;
+
+	if (gptp_servo_get_stats(&stats) < 0) {
+		return;
+	}
+
+	PR("Clock servo:\n");
+	PR("\tCurrent state                  : %s\n",
+	   servo2str(stats.state));
+
+	if (stats.offset > INT32_MAX || stats.offset < -INT32_MAX) {
+		PR("\tOffset from grandmaster        : %d s\n",
+		   (int)(stats.offset / NSEC_PER_SEC));
+	} else {
+		PR("\tOffset from grandmaster        : %d ns\n",
+		   (int)stats.offset);
+	}
+
+	PR("\tOffset RMS (last %d Syncs)     : %u ns\n",
+	   GPTP_SERVO_STATS_WINDOW, stats.offset_rms);
+	PR("\tOffset max (last %d Syncs)     : %u ns\n",
+	   GPTP_SERVO_STATS_WINDOW, stats.offset_max);
+	PR("\tPath delay                     : %u ns\n", stats.path_delay);
+	PR("\tFrequency adjustment           : %d ppb\n", stats.freq);
+	PR("\tSync messages since reset      : %u\n", stats.samples);
+}
+#endif /* CONFIG_NET_GPTP_SERVO_PI */
+
 static int cmd_net_gptp(const struct shell *shell, size_t argc, char *argv[])
 {
 #if defined(CONFIG_NET_GPTP)
@@ -2096,6 +2297,10 @@ static int cmd_net_gptp(const struct shell *shell, size_t argc, char *argv[])
 		   domain->state.clk_slave_sync.rcvd_local_clk_tick ?
 							   "yes" : "no");
 
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+		gptp_print_servo(shell);
+#endif
+
 		PR("PortRoleSelection state machine variables:\n");
 		PR("\tCurrent state                  : %s\n",
 		   pr_selection2str(domain->state.pr_sel.state));
@@ -2205,6 +2410,133 @@ static int cmd_net_iface_down(const struct shell *shell, size_t argc,
 	return 0;
 }
 
+#if defined(CONFIG_NET_CAPTURE)
+static void capture_cb(struct net_if *iface, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	struct net_capture_stats stats;
+	int *count = data->user_data;
+
+	if (net_capture_get_stats(iface, &stats) < 0) {
+		return;
+	}
+
+	PR("Interface %d captured %u filtered %u dropped %u\n",
+	   net_if_get_by_iface(iface), stats.captured, stats.filtered,
+	   stats.dropped);
+
+	(*count)++;
+}
+#endif /* CONFIG_NET_CAPTURE */
+
+static int cmd_net_capture(const struct shell *shell, size_t argc,
+			   char *argv[])
+{
+#if defined(CONFIG_NET_CAPTURE)
+	struct net_shell_user_data user_data;
+	int count = 0;
+
+	user_data.shell = shell;
+	user_data.user_data = &count;
+
+	net_if_foreach(capture_cb, &user_data);
+
+	if (!count) {
+		PR("No network interface is captured.\n");
+	}
+#else
+	PR_INFO("Set CONFIG_NET_CAPTURE to enable network packet "
+		"capture.\n");
+#endif
+
+	return 0;
+}
+
+static int cmd_net_capture_enable(const struct shell *shell, size_t argc,
+				  char *argv[])
+{
+#if defined(CONFIG_NET_CAPTURE)
+	static struct net_capture_filter filter;
+	char expr[CONFIG_SHELL_CMD_BUFF_SIZE];
+	struct net_if *iface;
+	size_t len = 0;
+	int idx, ret, i;
+
+	/* capture enable <interface index> [filter] */
+	idx = get_iface_idx(shell, argv[1]);
+	if (idx < 0) {
+		return -ENOEXEC;
+	}
+
+	iface = net_if_get_by_index(idx);
+	if (!iface) {
+		PR_WARNING("No such interface in index %d\n", idx);
+		return -ENOEXEC;
+	}
+
+	/* The filter expression is split in several arguments */
+	expr[0] = '\0';
+
+	for (i = 2; i < argc && len < sizeof(expr); i++) {
+		len += snprintk(&expr[len], sizeof(expr) - len, "%s%s",
+				i > 2 ? " " : "", argv[i]);
+	}
+
+	ret = net_capture_filter_compile(expr, &filter);
+	if (ret < 0) {
+		PR_WARNING("Invalid filter \"%s\" (%d)\n", expr, ret);
+		return -ENOEXEC;
+	}
+
+	ret = net_capture_enable(iface, &filter);
+	if (ret < 0) {
+		PR_WARNING("Cannot capture interface %d (%d)\n", idx, ret);
+		return -ENOEXEC;
+	}
+
+	PR("Capturing interface %d\n", idx);
+#else
+	PR_INFO("Set CONFIG_NET_CAPTURE to enable network packet "
+		"capture.\n");
+#endif
+
+	return 0;
+}
+
+static int cmd_net_capture_disable(const struct shell *shell, size_t argc,
+				   char *argv[])
+{
+#if defined(CONFIG_NET_CAPTURE)
+	struct net_if *iface;
+	int idx, ret;
+
+	idx = get_iface_idx(shell, argv[1]);
+	if (idx < 0) {
+		return -ENOEXEC;
+	}
+
+	iface = net_if_get_by_index(idx);
+	if (!iface) {
+		PR_WARNING("No such interface in index %d\n", idx);
+		return -ENOEXEC;
+	}
+
+	ret = net_capture_disable(iface);
+	if (ret < 0) {
+		PR_WARNING("Interface %d is not captured\n", idx);
+		return -ENOEXEC;
+	}
+
+	PR("Stopped capturing interface %d\n", idx);
+#else
+	PR_INFO("Set CONFIG_NET_CAPTURE to enable network packet "
+		"capture.\n");
+#endif
+
+	return 0;
+}
+
 #if defined(CONFIG_NET_IPV6)
 static u32_t time_diff(u32_t time1, u32_t time2)
 {
@@ -2455,6 +2787,49 @@ static void context_info(struct net_context *context, void *user_data)
 #endif /* CONFIG_NET_CONTEXT_NET_PKT_POOL */
 }
 
+#if defined(CONFIG_NET_PKT_POOL_STATS)
+static void pool_stats_cb(struct net_pkt_pool_stats *stats, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+
+	PR("%p\t%s DATA\t%d\t%d\t%d\t%d\t%u\t%u\n",
+	   stats->pool, stats->tx ? "TX" : "RX", stats->data_size,
+	   stats->pool->buf_count, stats->pool->avail_count,
+	   stats->max_used, stats->allocs, stats->empty);
+}
+#endif /* CONFIG_NET_PKT_POOL_STATS */
+
+#if defined(CONFIG_NET_PKT_QUOTA)
+static void print_quota(const struct shell *shell, const char *name,
+			struct net_pkt_quota *quota)
+{
+	PR("%s\t%u\t%u\t%u\t%u\n", name, net_pkt_quota_used(quota),
+	   quota->limit, (u32_t)atomic_get(&quota->max_used),
+	   (u32_t)atomic_get(&quota->exceeded));
+}
+
+static void iface_quota_cb(struct net_if *iface, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+
+	PR("%p\t", iface);
+	print_quota(shell, "IF", &iface->mem_quota);
+}
+
+static void context_quota_cb(struct net_context *context, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+
+	PR("%p\t", context);
+	print_quota(shell, "TX", &context->tx_quota);
+	PR("%p\t", context);
+	print_quota(shell, "RX", &context->rx_quota);
+}
+#endif /* CONFIG_NET_PKT_QUOTA */
+
 static int cmd_net_mem(const struct shell *shell, size_t argc, char *argv[])
 {
 	struct k_mem_slab *rx, *tx;
@@ -2495,6 +2870,36 @@ static int cmd_net_mem(const struct shell *shell, size_t argc, char *argv[])
 	PR("%p\t%d\tTX DATA\n", tx_data, tx_data->buf_count);
 #endif /* CONFIG_NET_BUF_POOL_USAGE */
 
+#if defined(CONFIG_NET_PKT_POOL_STATS)
+	{
+		struct net_shell_user_data user_data;
+
+		user_data.shell = shell;
+		user_data.user_data = NULL;
+
+		PR("\nData buffer pool pressure:\n");
+		PR("Address\t\tPool\tSize\tTotal\tAvail\tMaxUsed\t"
+		   "Allocs\tEmpty\n");
+
+		net_pkt_pool_stats_foreach(pool_stats_cb, &user_data);
+	}
+#endif /* CONFIG_NET_PKT_POOL_STATS */
+
+#if defined(CONFIG_NET_PKT_QUOTA)
+	{
+		struct net_shell_user_data user_data;
+
+		user_data.shell = shell;
+		user_data.user_data = NULL;
+
+		PR("\nMemory quotas (bytes):\n");
+		PR("Owner\t\tQuota\tUsed\tLimit\tMaxUsed\tExceeded\n");
+
+		net_if_foreach(iface_quota_cb, &user_data);
+		net_context_foreach(context_quota_cb, &user_data);
+	}
+#endif /* CONFIG_NET_PKT_QUOTA */
+
 	if (IS_ENABLED(CONFIG_NET_CONTEXT_NET_PKT_POOL)) {
 		struct net_shell_user_data user_data;
 		struct ctx_info info;
@@ -2991,24 +3396,172 @@ wait_reply:
 #endif
 }
 
+#if defined(CONFIG_NET_QDISC)
+static const char * const qdisc_types[] = {
+	[NET_QDISC_NONE] = "none",
+	[NET_QDISC_TBF] = "tbf",
+	[NET_QDISC_PRIO] = "prio",
+	[NET_QDISC_FQ_CODEL] = "fq_codel",
+};
+
+static void qdisc_cb(struct net_if *iface, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	struct net_qdisc_config config;
+	int *count = data->user_data;
+
+	if (net_mgmt(NET_REQUEST_QDISC_GET, iface, &config, sizeof(config)) ||
+	    config.type == NET_QDISC_NONE) {
+		return;
+	}
+
+	PR("Interface %d qdisc %s rate %u burst %u limit %u\n",
+	   net_if_get_by_iface(iface), qdisc_types[config.type],
+	   config.rate, config.burst, config.limit);
+
+	if (config.type == NET_QDISC_FQ_CODEL) {
+		PR("\tquantum %u target %u us interval %u us\n",
+		   config.quantum, config.target, config.interval);
+	}
+
+	(*count)++;
+}
+#endif /* CONFIG_NET_QDISC */
+
+static int cmd_net_qdisc(const struct shell *shell, size_t argc,
+			 char *argv[])
+{
+#if defined(CONFIG_NET_QDISC)
+	struct net_shell_user_data user_data;
+	int count = 0;
+
+	user_data.shell = shell;
+	user_data.user_data = &count;
+
+	net_if_foreach(qdisc_cb, &user_data);
+
+	if (!count) {
+		PR("No network interface has a queueing discipline.\n");
+	}
+#else
+	PR_INFO("Set CONFIG_NET_QDISC to enable queueing disciplines.\n");
+#endif
+
+	return 0;
+}
+
+static int cmd_net_qdisc_set(const struct shell *shell, size_t argc,
+			     char *argv[])
+{
+#if defined(CONFIG_NET_QDISC)
+	struct net_qdisc_config config;
+	struct net_if *iface;
+	unsigned long value;
+	char *endptr;
+	int idx, ret, i;
+
+	/* qdisc set <index> <type> [<parameter> <value>]... */
+	if (argc < 3) {
+		PR_WARNING("Missing interface index or type\n");
+		return -ENOEXEC;
+	}
+
+	idx = get_iface_idx(shell, argv[1]);
+	if (idx < 0) {
+		return -ENOEXEC;
+	}
+
+	iface = net_if_get_by_index(idx);
+	if (!iface) {
+		PR_WARNING("No such interface in index %d\n", idx);
+		return -ENOEXEC;
+	}
+
+	(void)memset(&config, 0, sizeof(config));
+
+	for (i = 0; i < ARRAY_SIZE(qdisc_types); i++) {
+		if (!strcmp(argv[2], qdisc_types[i])) {
+			config.type = i;
+			break;
+		}
+	}
+
+	if (i == ARRAY_SIZE(qdisc_types)) {
+		PR_WARNING("Unknown queueing discipline %s\n", argv[2]);
+		return -ENOEXEC;
+	}
+
+	for (i = 3; i < argc; i += 2) {
+		if (i + 1 == argc) {
+			PR_WARNING("Missing value of %s\n", argv[i]);
+			return -ENOEXEC;
+		}
+
+		value = strtoul(argv[i + 1], &endptr, 10);
+		if (*endptr || endptr == argv[i + 1]) {
+			PR_WARNING("Invalid %s %s\n", argv[i], argv[i + 1]);
+			return -ENOEXEC;
+		}
+
+		if (!strcmp(argv[i], "rate")) {
+			config.rate = value;
+		} else if (!strcmp(argv[i], "burst")) {
+			config.burst = value;
+		} else if (!strcmp(argv[i], "limit")) {
+			config.limit = value;
+		} else if (!strcmp(argv[i], "quantum")) {
+			config.quantum = value;
+		} else if (!strcmp(argv[i], "target")) {
+			config.target = value;
+		} else if (!strcmp(argv[i], "interval")) {
+			config.interval = value;
+		} else {
+			PR_WARNING("Unknown parameter %s\n", argv[i]);
+			return -ENOEXEC;
+		}
+	}
+
+	ret = net_mgmt(NET_REQUEST_QDISC_SET, iface, &config, sizeof(config));
+	if (ret < 0) {
+		PR_WARNING("Cannot set queueing discipline of interface %d "
+			   "(%d)\n", idx, ret);
+		return -ENOEXEC;
+	}
+
+	PR("Interface %d queueing discipline set to %s\n", idx, argv[2]);
+#else
+	PR_INFO("Set CONFIG_NET_QDISC to enable queueing disciplines.\n");
+#endif
+
+	return 0;
+}
+
 static int cmd_net_route(const struct shell *shell, size_t argc, char *argv[])
 {
-#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_MCAST)
+#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_MCAST) || \
+	defined(CONFIG_NET_ROUTE_IPV4)
 	struct net_shell_user_data user_data;
 #endif
 
 	ARG_UNUSED(argc);
 	ARG_UNUSED(argv);
 
-#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_MCAST)
+#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_MCAST) || \
+	defined(CONFIG_NET_ROUTE_IPV4)
 	user_data.shell = shell;
 #endif
 
+#if defined(CONFIG_NET_ROUTE) || defined(CONFIG_NET_ROUTE_IPV4)
 #if defined(CONFIG_NET_ROUTE)
 	net_if_foreach(iface_per_route_cb, &user_data);
+#endif
+#if defined(CONFIG_NET_ROUTE_IPV4)
+	net_if_foreach(iface_per_route_ipv4_cb, &user_data);
+#endif
 #else
 	PR_INFO("Network route support not enabled. "
-		"Set CONFIG_NET_ROUTE to enable it.\n");
+		"Set CONFIG_NET_ROUTE or CONFIG_NET_ROUTE_IPV4 to enable it.\n");
 #endif
 
 #if defined(CONFIG_NET_ROUTE_MCAST)
@@ -3712,7 +4265,28 @@ SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_arp,
 	SHELL_SUBCMD_SET_END
 );
 
+SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_capture,
+	SHELL_CMD(enable, NULL,
+		  "'net capture enable <index> [filter]' starts capturing "
+		  "the packets of a network interface, matching an optional "
+		  "tcpdump-like filter such as 'udp and port 53'.",
+		  cmd_net_capture_enable),
+	SHELL_CMD(disable, NULL,
+		  "'net capture disable <index>' stops capturing the packets "
+		  "of a network interface.",
+		  cmd_net_capture_disable),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_dns_cache,
+	SHELL_CMD(flush, NULL, "Remove all entries from DNS cache.",
+		  cmd_net_dns_cache_flush),
+	SHELL_SUBCMD_SET_END
+);
+
 SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_dns,
+	SHELL_CMD(cache, &net_cmd_dns_cache, "Print DNS cache contents.",
+		  cmd_net_dns_cache),
 	SHELL_CMD(cancel, NULL, "Cancel all pending requests.",
 		  cmd_net_dns_cancel),
 	SHELL_CMD(query, NULL,
@@ -3916,6 +4490,17 @@ SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_vlan,
 	SHELL_SUBCMD_SET_END
 );
 
+SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_qdisc,
+	SHELL_CMD(set, NULL,
+		  "'net qdisc set <index> <none|tbf|prio|fq_codel> "
+		  "[<parameter> <value>]...' sets the queueing discipline of a "
+		  "network interface. Parameters: rate (bytes/s), burst "
+		  "(bytes), limit (packets), quantum (bytes), target (us), "
+		  "interval (us).",
+		  cmd_net_qdisc_set),
+	SHELL_SUBCMD_SET_END
+);
+
 SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_ping,
 	SHELL_CMD(--help, NULL,
 		  "'net ping [-c count] [-i interval ms] <host>' "
@@ -3929,6 +4514,9 @@ SHELL_STATIC_SUBCMD_SET_CREATE(net_commands,
 		  cmd_net_allocs),
 	SHELL_CMD(arp, &net_cmd_arp, "Print information about IPv4 ARP cache.",
 		  cmd_net_arp),
+	SHELL_CMD(capture, &net_cmd_capture,
+		  "Capture network packets, print capture statistics.",
+		  cmd_net_capture),
 	SHELL_CMD(conn, NULL, "Print information about network connections.",
 		  cmd_net_conn),
 	SHELL_CMD(dns, &net_cmd_dns, "Show how DNS is configured.",
@@ -3947,6 +4535,9 @@ SHELL_STATIC_SUBCMD_SET_CREATE(net_commands,
 	SHELL_CMD(nbr, &net_cmd_nbr, "Print neighbor information.",
 		  cmd_net_nbr),
 	SHELL_CMD(ping, &net_cmd_ping, "Ping a network host.", cmd_net_ping),
+	SHELL_CMD(qdisc, &net_cmd_qdisc,
+		  "Show or set the queueing disciplines of network interfaces.",
+		  cmd_net_qdisc),
 	SHELL_CMD(route, NULL, "Show network route.", cmd_net_route),
 	SHELL_CMD(stacks, NULL, "Show network stacks information.",
 		  cmd_net_stacks),
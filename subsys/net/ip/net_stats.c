@@ -190,6 +190,31 @@ static inline void stats(struct net_if *iface)
 		ARG_UNUSED(i);
 #endif /* NET_TC_COUNT > 1 */
 
+#if NET_RX_FLOW_QUEUE_COUNT > 1
+		NET_INFO("RX flow queue statistics:");
+		NET_INFO("Queue\tRecv pkts\tbytes");
+
+		for (i = 0; i < NET_RX_FLOW_QUEUE_COUNT; i++) {
+			NET_INFO("[%d]\t%d\t\t%d", i,
+				 GET_STAT(iface, rx_queue[i].pkts),
+				 GET_STAT(iface, rx_queue[i].bytes));
+		}
+#endif
+
+#if defined(CONFIG_NET_QDISC)
+		NET_INFO("Queueing discipline statistics:");
+		NET_INFO("Band\tSent pkts\tbytes\tdropped\tdelay avg\tmax");
+
+		for (i = 0; i < NET_QDISC_PRIO_BANDS; i++) {
+			NET_INFO("[%d]\t%d\t\t%d\t%d\t%d us\t%d us", i,
+				 GET_STAT(iface, qdisc[i].pkts),
+				 GET_STAT(iface, qdisc[i].bytes),
+				 GET_STAT(iface, qdisc[i].dropped),
+				 GET_STAT(iface, qdisc[i].delay_avg),
+				 GET_STAT(iface, qdisc[i].delay_max));
+		}
+#endif
+
 		next_print = curr + PRINT_STATISTICS_INTERVAL;
 	}
 }
@@ -283,6 +308,12 @@ static int net_stats_get(u32_t mgmt_request, struct net_if *iface,
 		len_chk = sizeof(struct net_stats_tcp);
 		src = GET_STAT_ADDR(iface, tcp);
 		break;
+#endif
+#if defined(CONFIG_NET_QDISC)
+	case NET_REQUEST_STATS_CMD_GET_QDISC:
+		len_chk = sizeof(struct net_stats_qdisc) * NET_QDISC_PRIO_BANDS;
+		src = GET_STAT_ADDR(iface, qdisc);
+		break;
 #endif
 	}
 
@@ -337,4 +368,9 @@ NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_TCP,
 				  net_stats_get);
 #endif
 
+#if defined(CONFIG_NET_QDISC)
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_STATS_GET_QDISC,
+				  net_stats_get);
+#endif
+
 #endif /* CONFIG_NET_STATISTICS_USER_API */
@@ -351,6 +351,57 @@ static inline void net_stats_update_tc_recv_priority(struct net_if *iface,
 #define net_stats_update_tc_recv_priority(iface, tc, priority)
 #endif /* NET_TC_COUNT > 1 */
 
+#if (NET_RX_FLOW_QUEUE_COUNT > 1) && defined(CONFIG_NET_STATISTICS)
+static inline void net_stats_update_rx_queue(struct net_if *iface,
+					     u8_t queue, size_t bytes)
+{
+	UPDATE_STAT(iface, stats.rx_queue[queue].pkts++);
+	UPDATE_STAT(iface, stats.rx_queue[queue].bytes += bytes);
+}
+#else
+#define net_stats_update_rx_queue(iface, queue, bytes)
+#endif /* NET_RX_FLOW_QUEUE_COUNT > 1 */
+
+#if defined(CONFIG_NET_QDISC) && defined(CONFIG_NET_STATISTICS)
+static inline void net_stats_update_qdisc_sent(struct net_if *iface,
+					       u8_t band, size_t bytes)
+{
+	UPDATE_STAT(iface, stats.qdisc[band].pkts++);
+	UPDATE_STAT(iface, stats.qdisc[band].bytes += bytes);
+}
+
+static inline void net_stats_update_qdisc_dropped(struct net_if *iface,
+						  u8_t band)
+{
+	UPDATE_STAT(iface, stats.qdisc[band].dropped++);
+}
+
+static inline void qdisc_delay_update(struct net_stats_qdisc *stats,
+				      u32_t delay)
+{
+	/* Moving average with a gain of 1/8, as for the TCP smoothed RTT */
+	stats->delay_avg += ((s32_t)delay - (s32_t)stats->delay_avg) / 8;
+
+	if (delay > stats->delay_max) {
+		stats->delay_max = delay;
+	}
+}
+
+static inline void net_stats_update_qdisc_delay(struct net_if *iface,
+						u8_t band, u32_t delay)
+{
+	qdisc_delay_update(&net_stats.qdisc[band], delay);
+
+#if defined(CONFIG_NET_STATISTICS_PER_INTERFACE)
+	qdisc_delay_update(&iface->stats.qdisc[band], delay);
+#endif
+}
+#else
+#define net_stats_update_qdisc_sent(iface, band, bytes)
+#define net_stats_update_qdisc_dropped(iface, band)
+#define net_stats_update_qdisc_delay(iface, band, delay)
+#endif /* CONFIG_NET_QDISC && CONFIG_NET_STATISTICS */
+
 #if defined(CONFIG_NET_STATISTICS_PERIODIC_OUTPUT)
 /* A simple periodic statistic printer, used only in net core */
 void net_print_statistics_all(void);
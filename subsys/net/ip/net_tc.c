@@ -13,6 +13,7 @@ LOG_MODULE_REGISTER(net_tc, CONFIG_NET_TC_LOG_LEVEL);
 #include <net/net_core.h>
 #include <net/net_pkt.h>
 #include <net/net_stats.h>
+#include <net/ethernet.h>
 
 #include "net_private.h"
 #include "net_stats.h"
@@ -24,23 +25,279 @@ NET_STACK_ARRAY_DEFINE(TX, tx_stack,
 		       CONFIG_NET_TX_STACK_SIZE,
 		       NET_TC_TX_COUNT);
 
+/* Each RX traffic class is served by NET_RX_FLOW_QUEUE_COUNT threads */
+#define NET_RX_QUEUE_COUNT (NET_TC_RX_COUNT * NET_RX_FLOW_QUEUE_COUNT)
+
 /* Stacks for RX work queue */
 NET_STACK_ARRAY_DEFINE(RX, rx_stack,
 		       CONFIG_NET_RX_STACK_SIZE,
 		       CONFIG_NET_RX_STACK_SIZE,
-		       NET_TC_RX_COUNT);
+		       NET_RX_QUEUE_COUNT);
 
 static struct net_traffic_class tx_classes[NET_TC_TX_COUNT];
-static struct net_traffic_class rx_classes[NET_TC_RX_COUNT];
+static struct net_traffic_class rx_classes[NET_RX_QUEUE_COUNT];
+
+#if NET_TX_BURST_SIZE > 1
+/* Send the waiting packets, in bursts of packets of the same network
+ * interface.
+ */
+static void tx_burst_work(struct k_work *work)
+{
+	struct net_traffic_class *class =
+		CONTAINER_OF(work, struct net_traffic_class, burst_work);
+	struct net_pkt *pkts[NET_TX_BURST_SIZE];
+	struct net_pkt *pkt;
+	int count = 0;
+	int taken;
+
+	for (taken = 0; taken < NET_TX_BURST_SIZE; taken++) {
+		pkt = k_fifo_get(&class->fifo, K_NO_WAIT);
+		if (!pkt) {
+			break;
+		}
+
+		if (count && net_pkt_iface(pkt) != net_pkt_iface(pkts[0])) {
+			net_if_tx_burst(net_pkt_iface(pkts[0]), pkts, count);
+			count = 0;
+		}
+
+		pkts[count++] = pkt;
+	}
 
+	if (count) {
+		net_if_tx_burst(net_pkt_iface(pkts[0]), pkts, count);
+	}
+
+	/* Let the other work items of the queue run before the next burst */
+	if (!k_fifo_is_empty(&class->fifo)) {
+		k_work_submit_to_queue(&class->work_q, work);
+	}
+}
+
+void net_tc_submit_to_tx_queue(u8_t tc, struct net_pkt *pkt)
+{
+	k_fifo_put(&tx_classes[tc].fifo, pkt);
+	k_work_submit_to_queue(&tx_classes[tc].work_q,
+			       &tx_classes[tc].burst_work);
+}
+#else
 void net_tc_submit_to_tx_queue(u8_t tc, struct net_pkt *pkt)
 {
 	k_work_submit_to_queue(&tx_classes[tc].work_q, net_pkt_work(pkt));
 }
+#endif /* NET_TX_BURST_SIZE > 1 */
+
+#if defined(CONFIG_NET_QDISC)
+struct k_work_q *net_tc_tx_work_q(u8_t tc)
+{
+	return &tx_classes[tc].work_q;
+}
+#endif
+
+#if NET_RX_FLOW_QUEUE_COUNT > 1 || defined(CONFIG_NET_QDISC)
+static int flow_hash_add_words(struct net_pkt *pkt, u32_t *hash, int count)
+{
+	u32_t value;
+
+	while (count--) {
+		if (net_pkt_read_be32(pkt, &value)) {
+			return -ENOBUFS;
+		}
+
+		*hash = net_hash_oaat_add(*hash, value);
+	}
+
+	return 0;
+}
+
+/* Calculate a hash over the IP addresses, protocol and ports of a packet,
+ * starting with its L2 header if l2_hdr is set. Packets of the same flow
+ * always get the same hash and are thus processed in order by the same RX
+ * thread, or queued to the same flow queue of the queueing discipline.
+ * Packets which are not IP, or that cannot be parsed, get hash 0.
+ */
+u32_t net_tc_flow_hash(struct net_pkt *pkt, bool l2_hdr)
+{
+	struct net_pkt_cursor backup;
+	u32_t hash = 0U;
+	u16_t frag = 0U;
+	u8_t proto;
+	u8_t vtc;
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (l2_hdr &&
+	    net_if_l2(net_pkt_iface(pkt)) == &NET_L2_GET_NAME(ETHERNET)) {
+		u16_t ptype;
+
+		if (net_pkt_skip(pkt, 2 * sizeof(struct net_eth_addr)) ||
+		    net_pkt_read_be16(pkt, &ptype)) {
+			goto out;
+		}
+
+		if (ptype == NET_ETH_PTYPE_VLAN) {
+			if (net_pkt_skip(pkt, sizeof(u16_t)) ||
+			    net_pkt_read_be16(pkt, &ptype)) {
+				goto out;
+			}
+		}
+
+		if (ptype != NET_ETH_PTYPE_IP && ptype != NET_ETH_PTYPE_IPV6) {
+			goto out;
+		}
+	}
+#endif
+
+	if (net_pkt_read_u8(pkt, &vtc)) {
+		goto out;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && (vtc & 0xf0) == 0x40) {
+		size_t opts_len = (vtc & 0x0f) * 4U;
+
+		/* Skip TOS, length and id, then fetch fragment offset,
+		 * skip TTL and fetch protocol.
+		 */
+		if (opts_len < sizeof(struct net_ipv4_hdr) ||
+		    net_pkt_skip(pkt, 5) ||
+		    net_pkt_read_be16(pkt, &frag) ||
+		    net_pkt_skip(pkt, 1) ||
+		    net_pkt_read_u8(pkt, &proto) ||
+		    net_pkt_skip(pkt, sizeof(u16_t)) ||
+		    flow_hash_add_words(pkt, &hash, 2) ||
+		    net_pkt_skip(pkt, opts_len - sizeof(struct net_ipv4_hdr))) {
+			goto out;
+		}
+
+		/* Only the first fragment carries the ports */
+		frag &= 0x3fff;
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) && (vtc & 0xf0) == 0x60) {
+		/* Skip traffic class, flow label and length, fetch next
+		 * header and skip hop limit.
+		 */
+		if (net_pkt_skip(pkt, 5) ||
+		    net_pkt_read_u8(pkt, &proto) ||
+		    net_pkt_skip(pkt, 1) ||
+		    flow_hash_add_words(pkt, &hash, 8)) {
+			goto out;
+		}
+	} else {
+		goto out;
+	}
+
+	hash = net_hash_oaat_add(hash, proto);
+
+	if (!frag && (proto == IPPROTO_TCP || proto == IPPROTO_UDP)) {
+		/* Source and destination ports */
+		(void)flow_hash_add_words(pkt, &hash, 1);
+	}
+
+out:
+	net_pkt_cursor_restore(pkt, &backup);
+
+	return net_hash_oaat_final(hash);
+}
+#endif /* NET_RX_FLOW_QUEUE_COUNT > 1 || CONFIG_NET_QDISC */
+
+#if NET_RX_FLOW_QUEUE_COUNT > 1
+static u8_t rx_flow_queue(struct net_pkt *pkt)
+{
+	return net_tc_flow_hash(pkt, true) % NET_RX_FLOW_QUEUE_COUNT;
+}
+#else
+#define rx_flow_queue(pkt) 0
+#endif /* NET_RX_FLOW_QUEUE_COUNT > 1 */
+
+#if NET_RX_BURST_SIZE > 1
+/* Process the waiting packets. They were given their processing function
+ * as work handler when queued.
+ */
+static void rx_burst_work(struct k_work *work)
+{
+	struct net_traffic_class *class =
+		CONTAINER_OF(work, struct net_traffic_class, burst_work);
+	struct net_pkt *pkt;
+	int count;
+
+	for (count = 0; count < NET_RX_BURST_SIZE; count++) {
+		pkt = k_fifo_get(&class->fifo, K_NO_WAIT);
+		if (!pkt) {
+			break;
+		}
+
+		net_pkt_work(pkt)->handler(net_pkt_work(pkt));
+	}
+
+	/* Let the other work items of the queue run before the next burst */
+	if (!k_fifo_is_empty(&class->fifo)) {
+		k_work_submit_to_queue(&class->work_q, work);
+	}
+}
+#endif /* NET_RX_BURST_SIZE > 1 */
+
+static u8_t rx_queue(u8_t tc, struct net_pkt *pkt)
+{
+	u8_t queue = rx_flow_queue(pkt);
+
+	net_stats_update_rx_queue(net_pkt_iface(pkt), queue,
+				  net_pkt_get_len(pkt));
+
+	return tc * NET_RX_FLOW_QUEUE_COUNT + queue;
+}
 
 void net_tc_submit_to_rx_queue(u8_t tc, struct net_pkt *pkt)
 {
-	k_work_submit_to_queue(&rx_classes[tc].work_q, net_pkt_work(pkt));
+	struct net_traffic_class *class = &rx_classes[rx_queue(tc, pkt)];
+
+#if NET_RX_BURST_SIZE > 1
+	k_fifo_put(&class->fifo, pkt);
+	k_work_submit_to_queue(&class->work_q, &class->burst_work);
+#else
+	k_work_submit_to_queue(&class->work_q, net_pkt_work(pkt));
+#endif
+}
+
+void net_tc_submit_burst_to_rx_queues(struct net_pkt **pkts, int count)
+{
+#if NET_RX_BURST_SIZE > 1
+	/* Sort the packets by queue, keeping their order, and add them to
+	 * the queues all at once.
+	 */
+	sys_slist_t lists[NET_RX_QUEUE_COUNT];
+	u8_t tc;
+	int i;
+
+	for (i = 0; i < NET_RX_QUEUE_COUNT; i++) {
+		sys_slist_init(&lists[i]);
+	}
+
+	for (i = 0; i < count; i++) {
+		tc = net_rx_priority2tc(net_pkt_priority(pkts[i]));
+
+		sys_slist_append(&lists[rx_queue(tc, pkts[i])],
+				 &pkts[i]->burst_node);
+	}
+
+	for (i = 0; i < NET_RX_QUEUE_COUNT; i++) {
+		if (sys_slist_is_empty(&lists[i])) {
+			continue;
+		}
+
+		k_fifo_put_slist(&rx_classes[i].fifo, &lists[i]);
+		k_work_submit_to_queue(&rx_classes[i].work_q,
+				       &rx_classes[i].burst_work);
+	}
+#else
+	int i;
+
+	for (i = 0; i < count; i++) {
+		net_tc_submit_to_rx_queue(
+			net_rx_priority2tc(net_pkt_priority(pkts[i])),
+			pkts[i]);
+	}
+#endif /* NET_RX_BURST_SIZE > 1 */
 }
 
 int net_tx_priority2tc(enum net_priority prio)
@@ -253,6 +510,11 @@ void net_tc_tx_init(void)
 			K_THREAD_STACK_SIZEOF(tx_stack[i]),
 			thread_priority, K_PRIO_COOP(thread_priority));
 
+#if NET_TX_BURST_SIZE > 1
+		k_fifo_init(&tx_classes[i].fifo);
+		k_work_init(&tx_classes[i].burst_work, tx_burst_work);
+#endif
+
 		k_work_q_start(&tx_classes[i].work_q,
 			       tx_stack[i],
 			       K_THREAD_STACK_SIZEOF(tx_stack[i]),
@@ -271,10 +533,10 @@ void net_tc_rx_init(void)
 	net_if_foreach(net_tc_rx_stats_priority_setup, NULL);
 #endif
 
-	for (i = 0; i < NET_TC_RX_COUNT; i++) {
+	for (i = 0; i < NET_RX_QUEUE_COUNT; i++) {
 		u8_t thread_priority;
 
-		thread_priority = rx_tc2thread(i);
+		thread_priority = rx_tc2thread(i / NET_RX_FLOW_QUEUE_COUNT);
 		rx_classes[i].tc = thread_priority;
 
 #if defined(CONFIG_NET_SHELL)
@@ -292,10 +554,28 @@ void net_tc_rx_init(void)
 			K_THREAD_STACK_SIZEOF(rx_stack[i]),
 			thread_priority, K_PRIO_COOP(thread_priority));
 
+#if NET_RX_BURST_SIZE > 1
+		k_fifo_init(&rx_classes[i].fifo);
+		k_work_init(&rx_classes[i].burst_work, rx_burst_work);
+#endif
+
 		k_work_q_start(&rx_classes[i].work_q,
 			       rx_stack[i],
 			       K_THREAD_STACK_SIZEOF(rx_stack[i]),
 			       K_PRIO_COOP(thread_priority));
 		k_thread_name_set(&rx_classes[i].work_q.thread, "rx_workq");
+
+#if defined(CONFIG_NET_RX_FLOW_QUEUES_CPU_PIN)
+		/* Spread the flow queues of each traffic class over the
+		 * CPUs. The thread must not be runnable while changing its
+		 * CPU mask.
+		 */
+		k_thread_suspend(&rx_classes[i].work_q.thread);
+		k_thread_cpu_mask_clear(&rx_classes[i].work_q.thread);
+		k_thread_cpu_mask_enable(&rx_classes[i].work_q.thread,
+					 (i % NET_RX_FLOW_QUEUE_COUNT) %
+					 CONFIG_MP_NUM_CPUS);
+		k_thread_resume(&rx_classes[i].work_q.thread);
+#endif
 	}
 }
@@ -0,0 +1,360 @@
+/** @file
+ * @brief IP fragment reassembly
+ *
+ * Reassembly of IPv6 and IPv4 fragments. The pending packets are found
+ * from a hash table keyed by the fragment id and the addresses, and the
+ * fragments of a packet are kept ordered by offset so that overlaps and
+ * completion are detected on arrival. All the slots of a table share a
+ * single aging timer.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_reass, CONFIG_NET_REASSEMBLY_LOG_LEVEL);
+
+#include <errno.h>
+#include <string.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include "net_private.h"
+#include "reassembly.h"
+
+static u32_t reass_hash_addr(u32_t hash, const struct net_addr *addr)
+{
+	int i;
+
+	if (addr->family == AF_INET6) {
+		for (i = 0; i < ARRAY_SIZE(addr->in6_addr.s6_addr32); i++) {
+			hash = net_hash_oaat_add(hash,
+						 addr->in6_addr.s6_addr32[i]);
+		}
+
+		return hash;
+	}
+
+	return net_hash_oaat_add(hash, addr->in_addr.s_addr);
+}
+
+static sys_slist_t *reass_bucket(struct net_reass_table *table, u32_t id,
+				 const struct net_addr *src,
+				 const struct net_addr *dst)
+{
+	u32_t hash;
+
+	hash = net_hash_oaat_add(0, id);
+	hash = reass_hash_addr(hash, src);
+	hash = reass_hash_addr(hash, dst);
+
+	return &table->buckets[net_hash_oaat_final(hash) % table->count];
+}
+
+static bool reass_addr_cmp(const struct net_addr *addr1,
+			   const struct net_addr *addr2)
+{
+	if (addr1->family != addr2->family) {
+		return false;
+	}
+
+	if (addr1->family == AF_INET6) {
+		return net_ipv6_addr_cmp(&addr1->in6_addr, &addr2->in6_addr);
+	}
+
+	return net_ipv4_addr_cmp(&addr1->in_addr, &addr2->in_addr);
+}
+
+static struct net_reass *reass_find(sys_slist_t *bucket, u32_t id,
+				    const struct net_addr *src,
+				    const struct net_addr *dst)
+{
+	struct net_reass *reass;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(bucket, reass, node) {
+		if (reass->id == id && reass_addr_cmp(&reass->src, src) &&
+		    reass_addr_cmp(&reass->dst, dst)) {
+			return reass;
+		}
+	}
+
+	return NULL;
+}
+
+static struct net_reass *reass_alloc(struct net_reass_table *table,
+				     sys_slist_t *bucket, u32_t id,
+				     const struct net_addr *src,
+				     const struct net_addr *dst)
+{
+	struct net_reass *reass = NULL;
+	int i;
+
+	for (i = 0; i < table->count; i++) {
+		if (!table->slots[i].count) {
+			reass = &table->slots[i];
+			break;
+		}
+	}
+
+	if (!reass) {
+		return NULL;
+	}
+
+	memcpy(&reass->src, src, sizeof(reass->src));
+	memcpy(&reass->dst, dst, sizeof(reass->dst));
+	reass->id = id;
+	reass->expiry = k_uptime_get_32() + table->timeout;
+	reass->len = 0U;
+	reass->received = 0U;
+
+	sys_slist_prepend(bucket, &reass->node);
+
+	/* A new slot expires after all the others, so the timer only needs
+	 * to be started if it is not already running.
+	 */
+	if (!k_delayed_work_remaining_get(&table->timer)) {
+		k_delayed_work_submit(&table->timer, table->timeout);
+	}
+
+	return reass;
+}
+
+static void reass_release(struct net_reass_table *table,
+			  struct net_reass *reass)
+{
+	int i;
+
+	for (i = 0; i < reass->count; i++) {
+		if (reass->frags[i].pkt) {
+			net_pkt_unref(reass->frags[i].pkt);
+			reass->frags[i].pkt = NULL;
+		}
+	}
+
+	sys_slist_find_and_remove(reass_bucket(table, reass->id, &reass->src,
+					       &reass->dst),
+				  &reass->node);
+
+	reass->count = 0U;
+}
+
+/* Remove the headers in front of the fragment payload. Emptied buffers
+ * are freed, the remaining data is not moved.
+ */
+static void reass_pull(struct net_pkt *pkt, size_t hdr_len)
+{
+	struct net_buf *frag;
+	size_t len;
+
+	while (hdr_len) {
+		frag = pkt->buffer;
+		len = MIN(frag->len, hdr_len);
+
+		net_buf_pull(frag, len);
+		hdr_len -= len;
+
+		if (!frag->len) {
+			pkt->buffer = net_buf_frag_del(NULL, frag);
+		}
+	}
+
+	net_pkt_cursor_init(pkt);
+}
+
+/* Link the payload of all the fragments to the first one */
+static struct net_pkt *reass_collect(struct net_reass_table *table,
+				     struct net_reass *reass)
+{
+	struct net_pkt *pkt = reass->frags[0].pkt;
+	int i;
+
+	for (i = 1; i < reass->count; i++) {
+		net_pkt_append_buffer(pkt, reass->frags[i].pkt->buffer);
+		reass->frags[i].pkt->buffer = NULL;
+	}
+
+	reass->frags[0].pkt = NULL;
+
+	reass_release(table, reass);
+
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
+int net_reass_add(struct net_reass_table *table, struct net_pkt *pkt,
+		  u32_t id, const struct net_addr *src,
+		  const struct net_addr *dst, u16_t hdr_len, u16_t offset,
+		  bool more, struct net_pkt **done)
+{
+	size_t pkt_len = net_pkt_get_len(pkt);
+	struct net_reass *reass;
+	sys_slist_t *bucket;
+	u32_t end;
+	int ret = 0;
+	int i;
+
+	*done = NULL;
+
+	if (pkt_len <= hdr_len) {
+		return -EINVAL;
+	}
+
+	end = (u32_t)offset + pkt_len - hdr_len;
+	if (end > UINT16_MAX) {
+		return -EMSGSIZE;
+	}
+
+	k_mutex_lock(&table->lock, K_FOREVER);
+
+	bucket = reass_bucket(table, id, src, dst);
+
+	reass = reass_find(bucket, id, src, dst);
+	if (!reass) {
+		reass = reass_alloc(table, bucket, id, src, dst);
+		if (!reass) {
+			NET_DBG("No free slot for id 0x%x", id);
+			ret = -ENOMEM;
+			goto out;
+		}
+	}
+
+	for (i = 0; i < reass->count; i++) {
+		if (reass->frags[i].start >= offset) {
+			break;
+		}
+	}
+
+	if (i < reass->count && reass->frags[i].start == offset &&
+	    reass->frags[i].end == end) {
+		NET_DBG("Duplicate fragment id 0x%x offset %u", id, offset);
+		ret = -EALREADY;
+		goto out;
+	}
+
+	if ((i > 0 && reass->frags[i - 1].end > offset) ||
+	    (i < reass->count && reass->frags[i].start < end)) {
+		NET_DBG("Overlapping fragment id 0x%x offset %u", id, offset);
+		goto discard;
+	}
+
+	if (more) {
+		if (reass->len && end >= reass->len) {
+			goto discard;
+		}
+	} else {
+		if ((reass->len && reass->len != end) ||
+		    (reass->count &&
+		     reass->frags[reass->count - 1].end > end)) {
+			goto discard;
+		}
+
+		reass->len = end;
+	}
+
+	if (reass->count == NET_REASS_MAX_FRAGMENTS) {
+		NET_DBG("Too many fragments for id 0x%x", id);
+		goto discard;
+	}
+
+	/* Only the first fragment keeps its headers */
+	if (offset) {
+		reass_pull(pkt, hdr_len);
+	}
+
+	memmove(&reass->frags[i + 1], &reass->frags[i],
+		(reass->count - i) * sizeof(reass->frags[0]));
+
+	reass->frags[i].pkt = pkt;
+	reass->frags[i].start = offset;
+	reass->frags[i].end = end;
+	reass->count++;
+	reass->received += end - offset;
+
+	NET_DBG("id 0x%x fragment %u-%u received %u/%u", id, offset, end,
+		reass->received, reass->len);
+
+	/* The fragments do not overlap, so all of them are there once
+	 * the byte count matches.
+	 */
+	if (reass->len && reass->received == reass->len) {
+		*done = reass_collect(table, reass);
+	}
+
+	goto out;
+
+discard:
+	reass_release(table, reass);
+	ret = -EINVAL;
+
+out:
+	k_mutex_unlock(&table->lock);
+
+	return ret;
+}
+
+static void reass_timeout(struct k_work *work)
+{
+	struct net_reass_table *table =
+		CONTAINER_OF(work, struct net_reass_table, timer);
+	u32_t now = k_uptime_get_32();
+	s32_t remaining, next = 0;
+	int i;
+
+	k_mutex_lock(&table->lock, K_FOREVER);
+
+	for (i = 0; i < table->count; i++) {
+		struct net_reass *reass = &table->slots[i];
+
+		if (!reass->count) {
+			continue;
+		}
+
+		remaining = (s32_t)(reass->expiry - now);
+		if (remaining <= 0) {
+			NET_DBG("Reassembly id 0x%x timed out", reass->id);
+			reass_release(table, reass);
+			continue;
+		}
+
+		if (!next || remaining < next) {
+			next = remaining;
+		}
+	}
+
+	if (next) {
+		k_delayed_work_submit(&table->timer, next);
+	}
+
+	k_mutex_unlock(&table->lock);
+}
+
+void net_reass_foreach(struct net_reass_table *table, net_reass_cb_t cb,
+		       void *user_data)
+{
+	int i;
+
+	k_mutex_lock(&table->lock, K_FOREVER);
+
+	for (i = 0; i < table->count; i++) {
+		if (table->slots[i].count) {
+			cb(&table->slots[i], user_data);
+		}
+	}
+
+	k_mutex_unlock(&table->lock);
+}
+
+void net_reass_init(struct net_reass_table *table)
+{
+	int i;
+
+	k_mutex_init(&table->lock);
+	k_delayed_work_init(&table->timer, reass_timeout);
+
+	for (i = 0; i < table->count; i++) {
+		sys_slist_init(&table->buckets[i]);
+	}
+}
@@ -0,0 +1,185 @@
+/** @file
+ @brief IP fragment reassembly
+
+ This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __REASSEMBLY_H
+#define __REASSEMBLY_H
+
+#include <zephyr/types.h>
+#include <kernel.h>
+#include <misc/slist.h>
+
+#include <net/net_ip.h>
+#include <net/net_pkt.h>
+
+#if defined(CONFIG_NET_REASSEMBLY)
+#define NET_REASS_MAX_FRAGMENTS CONFIG_NET_REASSEMBLY_MAX_FRAGMENTS
+#else
+#define NET_REASS_MAX_FRAGMENTS 2
+#endif
+
+/** A received fragment of a packet being reassembled. */
+struct net_reass_frag {
+	/** The fragment. Only the first fragment contains the IP headers,
+	 * from the other ones they have been removed.
+	 */
+	struct net_pkt *pkt;
+
+	/** Offset of the first payload byte in the fragment */
+	u16_t start;
+
+	/** Offset of the byte following the fragment */
+	u16_t end;
+};
+
+/** Store pending IP fragment information that is needed for reassembly. */
+struct net_reass {
+	/** Hash bucket list node */
+	sys_snode_t node;
+
+	/** Source address of the fragments */
+	struct net_addr src;
+
+	/** Destination address of the fragments */
+	struct net_addr dst;
+
+	/** Fragment identification */
+	u32_t id;
+
+	/** Uptime in milliseconds when the reassembly is given up */
+	u32_t expiry;
+
+	/** Payload length, known once the last fragment is received */
+	u16_t len;
+
+	/** Number of payload bytes received so far */
+	u16_t received;
+
+	/** Number of received fragments, 0 if the slot is free */
+	u8_t count;
+
+	/** Received fragments, ordered by offset and never overlapping */
+	struct net_reass_frag frags[NET_REASS_MAX_FRAGMENTS];
+};
+
+/** Reassembly slots and lookup table of one IP protocol version. */
+struct net_reass_table {
+	/** Reassembly slots */
+	struct net_reass *slots;
+
+	/** Hash buckets of the slots in use */
+	sys_slist_t *buckets;
+
+	/** Aging timer shared by all the slots */
+	struct k_delayed_work timer;
+
+	/** Protects the slots and buckets */
+	struct k_mutex lock;
+
+	/** Reassembly timeout in milliseconds */
+	s32_t timeout;
+
+	/** Number of slots and of hash buckets */
+	u8_t count;
+};
+
+/**
+ * @brief Define a reassembly table.
+ *
+ * @param _name Name of the table variable.
+ * @param _slots Number of packets that can be reassembled at a time.
+ * @param _timeout Reassembly timeout in milliseconds.
+ */
+#define NET_REASS_TABLE_DEFINE(_name, _slots, _timeout)			\
+	static struct net_reass _net_reass_slots_##_name[_slots];	\
+	static sys_slist_t _net_reass_buckets_##_name[_slots];		\
+	static struct net_reass_table _name = {				\
+		.slots = _net_reass_slots_##_name,			\
+		.buckets = _net_reass_buckets_##_name,			\
+		.timeout = _timeout,					\
+		.count = _slots,					\
+	}
+
+/**
+ * @typedef net_reass_cb_t
+ * @brief Callback used while iterating over pending reassemblies.
+ *
+ * @param reass Reassembly slot
+ * @param user_data A valid pointer on some user data or NULL
+ */
+typedef void (*net_reass_cb_t)(struct net_reass *reass, void *user_data);
+
+/**
+ * @brief Initialize a reassembly table.
+ *
+ * @param table Reassembly table
+ */
+void net_reass_init(struct net_reass_table *table);
+
+/**
+ * @brief Add a received fragment to the packet it belongs to.
+ *
+ * @details The fragments of a packet are identified by the fragment id
+ * and the source and destination addresses. A fragment that overlaps
+ * already received data causes the whole packet to be discarded
+ * (RFC 5722), exact duplicates are ignored.
+ *
+ * On success the fragment is owned by the reassembly code. When the
+ * last missing fragment is added, the first fragment with the payload
+ * of all the others linked to it, without copying, is returned in
+ * @a done. Its IP headers are still those of the first fragment.
+ *
+ * @param table Reassembly table
+ * @param pkt Received fragment
+ * @param id Fragment identification
+ * @param src Source address
+ * @param dst Destination address
+ * @param hdr_len Length of the headers preceding the fragment payload
+ * @param offset Offset of the fragment payload in the packet
+ * @param more Are there more fragments after this one
+ * @param done Set to the reassembled packet if it is complete, NULL
+ * otherwise.
+ *
+ * @return 0 if the fragment was added, -EALREADY if it is a duplicate,
+ * -ENOMEM if there is no free slot, -EINVAL if the fragment does not
+ * fit with the already received ones and -EMSGSIZE if the packet would
+ * be too large. On error the caller still owns the fragment.
+ */
+int net_reass_add(struct net_reass_table *table, struct net_pkt *pkt,
+		  u32_t id, const struct net_addr *src,
+		  const struct net_addr *dst, u16_t hdr_len, u16_t offset,
+		  bool more, struct net_pkt **done);
+
+/**
+ * @brief Go through all the pending reassemblies of a table.
+ *
+ * @param table Reassembly table
+ * @param cb Callback to call for each pending reassembly.
+ * @param user_data User specified data or NULL.
+ */
+void net_reass_foreach(struct net_reass_table *table, net_reass_cb_t cb,
+		       void *user_data);
+
+/**
+ * @brief Get the time left before a reassembly is given up.
+ *
+ * @param reass Reassembly slot
+ *
+ * @return Remaining time in milliseconds.
+ */
+static inline s32_t net_reass_remaining(struct net_reass *reass)
+{
+	s32_t remaining = (s32_t)(reass->expiry - k_uptime_get_32());
+
+	return remaining > 0 ? remaining : 0;
+}
+
+#endif /* __REASSEMBLY_H */
@@ -36,7 +36,20 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 /* We keep track of the routes in a separate list so that we can remove
  * the oldest routes (at tail) if needed.
  */
-static sys_slist_t routes;
+static sys_dlist_t routes = SYS_DLIST_STATIC_INIT(&routes);
+
+static bool route_match(struct net_lpm_entry *entry, const void *iface)
+{
+	struct net_route_entry *route = CONTAINER_OF(entry,
+						     struct net_route_entry,
+						     lpm);
+
+	return !iface || route->iface == iface;
+}
+
+/* The routes are looked up by destination address in this table. */
+NET_LPM_DEFINE(route_table, sizeof(struct in6_addr), CONFIG_NET_MAX_ROUTES,
+	       CONFIG_NET_ROUTE_CACHE_SIZE, route_match);
 
 static void net_route_nexthop_remove(struct net_nbr *nbr)
 {
@@ -189,6 +202,13 @@ static struct net_nbr *nbr_new(struct net_if *iface,
 
 	net_ipaddr_copy(&net_route_data(nbr)->addr, addr);
 	net_route_data(nbr)->prefix_len = prefix_len;
+	net_route_data(nbr)->iface = iface;
+
+	if (net_lpm_add(&route_table, &net_route_data(nbr)->lpm, addr,
+			prefix_len) < 0) {
+		nbr_free(nbr);
+		return NULL;
+	}
 
 	NET_DBG("[%d] nbr %p iface %p IPv6 %s/%d",
 		nbr->idx, nbr, iface,
@@ -252,40 +272,22 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 /* Route was accessed, so place it in front of the routes list */
 static inline void update_route_access(struct net_route_entry *route)
 {
-	sys_slist_find_and_remove(&routes, &route->node);
-	sys_slist_prepend(&routes, &route->node);
+	if (!sys_dlist_is_head(&routes, &route->node)) {
+		sys_dlist_remove(&route->node);
+		sys_dlist_prepend(&routes, &route->node);
+	}
 }
 
 struct net_route_entry *net_route_lookup(struct net_if *iface,
 					 struct in6_addr *dst)
 {
-	struct net_route_entry *route, *found = NULL;
-	u8_t longest_match = 0U;
-	int i;
-
-	for (i = 0; i < CONFIG_NET_MAX_ROUTES && longest_match < 128; i++) {
-		struct net_nbr *nbr = get_nbr(i);
-
-		if (!nbr->ref) {
-			continue;
-		}
-
-		if (iface && nbr->iface != iface) {
-			continue;
-		}
-
-		route = net_route_data(nbr);
+	struct net_route_entry *found = NULL;
+	struct net_lpm_entry *entry;
 
-		if (route->prefix_len >= longest_match &&
-		    net_ipv6_is_prefix((u8_t *)dst,
-				       (u8_t *)&route->addr,
-				       route->prefix_len)) {
-			found = route;
-			longest_match = route->prefix_len;
-		}
-	}
+	entry = net_lpm_lookup(&route_table, dst, iface);
+	if (entry) {
+		found = CONTAINER_OF(entry, struct net_route_entry, lpm);
 
-	if (found) {
 		net_route_info("Found", found, dst);
 
 		update_route_access(found);
@@ -294,6 +296,21 @@ struct net_route_entry *net_route_lookup(struct net_if *iface,
 	return found;
 }
 
+/* Find the route to exactly this prefix */
+static struct net_route_entry *route_find(struct net_if *iface,
+					  struct in6_addr *addr,
+					  u8_t prefix_len)
+{
+	struct net_lpm_entry *entry;
+
+	entry = net_lpm_find(&route_table, addr, prefix_len, iface);
+	if (!entry) {
+		return NULL;
+	}
+
+	return CONTAINER_OF(entry, struct net_route_entry, lpm);
+}
+
 struct net_route_entry *net_route_add(struct net_if *iface,
 				      struct in6_addr *addr,
 				      u8_t prefix_len,
@@ -332,7 +349,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 		log_strdup(net_sprint_ll_addr(nexthop_lladdr->addr,
 					      nexthop_lladdr->len)));
 
-	route = net_route_lookup(iface, addr);
+	route = route_find(iface, addr, prefix_len);
 	if (route) {
 		/* Update nexthop if not the same */
 		struct in6_addr *nexthop_addr;
@@ -352,9 +369,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	nbr = nbr_new(iface, addr, prefix_len);
 	if (!nbr) {
 		/* Remove the oldest route and try again */
-		sys_snode_t *last = sys_slist_peek_tail(&routes);
-
-		sys_slist_find_and_remove(&routes, last);
+		sys_dnode_t *last = sys_dlist_peek_tail(&routes);
 
 		route = CONTAINER_OF(last,
 				     struct net_route_entry,
@@ -392,15 +407,16 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	tmp = get_nexthop_route();
 	if (!tmp) {
 		NET_ERR("No nexthop route available!");
+		net_lpm_del(&route_table, &net_route_data(nbr)->lpm);
+		nbr_free(nbr);
 		return NULL;
 	}
 
 	nexthop_route = net_nexthop_data(tmp);
 
 	route = net_route_data(nbr);
-	route->iface = iface;
 
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_prepend(&routes, &route->node);
 
 	tmp = nbr_nexthop_get(iface, nexthop);
 
@@ -440,6 +456,11 @@ int net_route_del(struct net_route_entry *route)
 		return -EINVAL;
 	}
 
+	nbr = net_route_get_nbr(route);
+	if (!nbr) {
+		return -ENOENT;
+	}
+
 #if defined(CONFIG_NET_MGMT_EVENT_INFO)
 	net_ipaddr_copy(&info.addr, &route->addr);
 	info.prefix_len = route->prefix_len;
@@ -453,12 +474,8 @@ int net_route_del(struct net_route_entry *route)
 	net_mgmt_event_notify(NET_EVENT_IPV6_ROUTE_DEL, route->iface);
 #endif
 
-	sys_slist_find_and_remove(&routes, &route->node);
-
-	nbr = net_route_get_nbr(route);
-	if (!nbr) {
-		return -ENOENT;
-	}
+	sys_dlist_remove(&route->node);
+	net_lpm_del(&route_table, &route->lpm);
 
 	net_route_info("Deleted", route, &route->addr);
 
@@ -826,6 +843,8 @@ int net_route_packet(struct net_pkt *pkt, struct in6_addr *nexthop)
 
 void net_route_init(void)
 {
+	net_lpm_init(&route_table);
+
 	NET_DBG("Allocated %d routing entries (%zu bytes)",
 		CONFIG_NET_MAX_ROUTES, sizeof(net_route_entries_pool));
 
@@ -0,0 +1,206 @@
+/** @file
+ * @brief IPv4 route handling.
+ *
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_route_ipv4, CONFIG_NET_ROUTE_LOG_LEVEL);
+
+#include <kernel.h>
+#include <errno.h>
+#include <zephyr/types.h>
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_ip.h>
+
+#include "net_private.h"
+#include "route.h"
+
+static struct net_route_entry_ipv4 routes_ipv4[CONFIG_NET_MAX_IPV4_ROUTES];
+
+static K_MUTEX_DEFINE(lock);
+
+static bool route_ipv4_match(struct net_lpm_entry *entry, const void *iface)
+{
+	struct net_route_entry_ipv4 *route =
+		CONTAINER_OF(entry, struct net_route_entry_ipv4, lpm);
+
+	return !iface || route->iface == iface;
+}
+
+/* The routes are looked up by destination address in this table. */
+NET_LPM_DEFINE(route_ipv4_table, sizeof(struct in_addr),
+	       CONFIG_NET_MAX_IPV4_ROUTES, CONFIG_NET_ROUTE_CACHE_SIZE,
+	       route_ipv4_match);
+
+static struct net_route_entry_ipv4 *route_ipv4_lookup(struct net_if *iface,
+						      struct in_addr *dst)
+{
+	struct net_lpm_entry *entry;
+
+	entry = net_lpm_lookup(&route_ipv4_table, dst, iface);
+	if (!entry) {
+		return NULL;
+	}
+
+	return CONTAINER_OF(entry, struct net_route_entry_ipv4, lpm);
+}
+
+struct net_route_entry_ipv4 *net_route_ipv4_lookup(struct net_if *iface,
+						   struct in_addr *dst)
+{
+	struct net_route_entry_ipv4 *route;
+
+	k_mutex_lock(&lock, K_FOREVER);
+	route = route_ipv4_lookup(iface, dst);
+	k_mutex_unlock(&lock);
+
+	return route;
+}
+
+bool net_route_ipv4_get_nexthop(struct net_if *iface, struct in_addr *dst,
+				struct in_addr *nexthop)
+{
+	struct net_route_entry_ipv4 *route;
+
+	k_mutex_lock(&lock, K_FOREVER);
+
+	/* The route may be deleted as soon as the lock is released, so its
+	 * gateway is copied out.
+	 */
+	route = route_ipv4_lookup(iface, dst);
+	if (route) {
+		if (net_ipv4_is_addr_unspecified(&route->gw)) {
+			net_ipaddr_copy(nexthop, dst);
+		} else {
+			net_ipaddr_copy(nexthop, &route->gw);
+		}
+	}
+
+	k_mutex_unlock(&lock);
+
+	return route != NULL;
+}
+
+struct net_route_entry_ipv4 *net_route_ipv4_add(struct net_if *iface,
+						struct in_addr *addr,
+						u8_t prefix_len,
+						struct in_addr *gw)
+{
+	struct net_route_entry_ipv4 *route = NULL;
+	struct net_lpm_entry *entry;
+	int i;
+
+	NET_ASSERT(addr);
+	NET_ASSERT(iface);
+
+	if (prefix_len > 32) {
+		return NULL;
+	}
+
+	k_mutex_lock(&lock, K_FOREVER);
+
+	entry = net_lpm_find(&route_ipv4_table, addr, prefix_len, iface);
+	if (entry) {
+		route = CONTAINER_OF(entry, struct net_route_entry_ipv4, lpm);
+
+		NET_DBG("Updating route %s/%d iface %p",
+			log_strdup(net_sprint_ipv4_addr(addr)), prefix_len,
+			iface);
+		goto update;
+	}
+
+	for (i = 0; i < CONFIG_NET_MAX_IPV4_ROUTES; i++) {
+		if (!routes_ipv4[i].is_used) {
+			route = &routes_ipv4[i];
+			break;
+		}
+	}
+
+	if (!route) {
+		NET_DBG("Route table is full");
+		goto out;
+	}
+
+	if (net_lpm_add(&route_ipv4_table, &route->lpm, addr, prefix_len)) {
+		route = NULL;
+		goto out;
+	}
+
+	route->iface = iface;
+	route->is_used = true;
+	route->prefix_len = prefix_len;
+	net_ipaddr_copy(&route->addr, addr);
+
+	NET_DBG("Added route %s/%d iface %p",
+		log_strdup(net_sprint_ipv4_addr(addr)), prefix_len, iface);
+
+update:
+	if (gw) {
+		net_ipaddr_copy(&route->gw, gw);
+	} else {
+		route->gw.s_addr = INADDR_ANY;
+	}
+
+out:
+	k_mutex_unlock(&lock);
+
+	return route;
+}
+
+int net_route_ipv4_del(struct net_route_entry_ipv4 *route)
+{
+	if (!route) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&lock, K_FOREVER);
+
+	if (!route->is_used) {
+		k_mutex_unlock(&lock);
+		return -ENOENT;
+	}
+
+	net_lpm_del(&route_ipv4_table, &route->lpm);
+	route->is_used = false;
+
+	NET_DBG("Deleted route %s/%d iface %p",
+		log_strdup(net_sprint_ipv4_addr(&route->addr)),
+		route->prefix_len, route->iface);
+
+	k_mutex_unlock(&lock);
+
+	return 0;
+}
+
+int net_route_ipv4_foreach(net_route_ipv4_cb_t cb, void *user_data)
+{
+	int i, ret = 0;
+
+	for (i = 0; i < CONFIG_NET_MAX_IPV4_ROUTES; i++) {
+		if (!routes_ipv4[i].is_used) {
+			continue;
+		}
+
+		cb(&routes_ipv4[i], user_data);
+
+		ret++;
+	}
+
+	return ret;
+}
+
+void net_route_ipv4_init(void)
+{
+	NET_DBG("Allocated %d IPv4 routing entries (%zu bytes)",
+		CONFIG_NET_MAX_IPV4_ROUTES, sizeof(routes_ipv4));
+
+	net_lpm_init(&route_ipv4_table);
+}
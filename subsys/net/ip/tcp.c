@@ -51,9 +51,15 @@ static struct tcp_backlog_entry {
 	u32_t send_ack;
 	struct k_delayed_work ack_timer;
 	struct sockaddr remote;
+	u32_t ts_recent;
 	u16_t send_mss;
+	u8_t opt_flags;
+	u8_t send_wscale;
 } tcp_backlog[CONFIG_NET_TCP_BACKLOG_SIZE];
 
+/* Flags of the options negotiated in the SYN segments */
+#define TCP_OPT_FLAGS (NET_TCP_SACK_OK | NET_TCP_TS_OK | NET_TCP_WSCALE_OK)
+
 #if defined(CONFIG_NET_TCP_ACK_TIMEOUT)
 #define ACK_TIMEOUT CONFIG_NET_TCP_ACK_TIMEOUT
 #else
@@ -163,8 +169,7 @@ static void net_tcp_trace(struct net_pkt *pkt,
 
 static inline u32_t retry_timeout(const struct net_tcp *tcp)
 {
-	return ((u32_t)1 << tcp->retry_timeout_shift) *
-				CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT;
+	return ((u32_t)1 << tcp->retry_timeout_shift) * tcp->rto;
 }
 
 #define is_6lo_technology(pkt)						\
@@ -193,6 +198,18 @@ static inline u32_t retry_timeout(const struct net_tcp *tcp)
 		}							\
 	} while (0)
 
+/* No more data can be sent on a reset connection. Wake up the senders
+ * waiting for room in the send queue, so that they fail.
+ */
+static void tcp_shutdown_send(struct net_context *ctx)
+{
+	ctx->tcp->flags |= NET_TCP_IS_SHUTDOWN;
+
+	if (ctx->writable_cb) {
+		ctx->writable_cb(ctx);
+	}
+}
+
 static void abort_connection(struct net_tcp *tcp)
 {
 	struct net_context *ctx = tcp->context;
@@ -200,6 +217,8 @@ static void abort_connection(struct net_tcp *tcp)
 	NET_DBG("[%p] segment retransmission exceeds %d, resetting context %p",
 		tcp, CONFIG_NET_TCP_RETRY_COUNT, ctx);
 
+	tcp_shutdown_send(ctx);
+
 	if (ctx->recv_cb) {
 		ctx->recv_cb(ctx, NULL, NULL, NULL, -ECONNRESET,
 			     tcp->recv_user_data);
@@ -208,13 +227,618 @@ static void abort_connection(struct net_tcp *tcp)
 	net_context_unref(ctx);
 }
 
+/* Get the first sequence number and the length in sequence space of a
+ * segment in the sent list. SYN and FIN count as one sequence number.
+ */
+static int tcp_seg_info(struct net_pkt *pkt, u32_t *seq, u32_t *seq_len,
+			u8_t *flags)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	struct net_tcp_hdr *tcp_hdr;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
+			 net_pkt_ipv6_ext_len(pkt))) {
+		return -EMSGSIZE;
+	}
+
+	tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data(pkt, &tcp_access);
+	if (!tcp_hdr) {
+		return -ENOBUFS;
+	}
+
+	net_pkt_acknowledge_data(pkt, &tcp_access);
+
+	*seq = sys_get_be32(tcp_hdr->seq);
+	*seq_len = net_pkt_remaining_data(pkt);
+
+	if (tcp_hdr->flags & NET_TCP_SYN) {
+		*seq_len += 1U;
+	}
+
+	if (tcp_hdr->flags & NET_TCP_FIN) {
+		*seq_len += 1U;
+	}
+
+	if (flags) {
+		*flags = tcp_hdr->flags;
+	}
+
+	return 0;
+}
+
+static void tcp_retransmit(struct net_tcp *tcp, struct net_pkt *pkt)
+{
+	if (net_pkt_sent(pkt)) {
+		do_ref_if_needed(tcp, pkt);
+		net_pkt_set_sent(pkt, false);
+	}
+
+	net_pkt_set_queued(pkt, true);
+
+	if (net_tcp_send_pkt(pkt) < 0 && !is_6lo_technology(pkt)) {
+		NET_DBG("retry %u: [%p] pkt %p send failed",
+			tcp->retry_timeout_shift, tcp, pkt);
+		net_pkt_unref(pkt);
+	} else {
+		NET_DBG("retry %u: [%p] sent pkt %p",
+			tcp->retry_timeout_shift, tcp, pkt);
+		if (IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
+		    !is_6lo_technology(pkt)) {
+			net_stats_update_tcp_seg_rexmit(net_pkt_iface(pkt));
+		}
+	}
+}
+
+#if defined(CONFIG_NET_TCP_SACK)
+static bool sack_block_empty(struct net_tcp_sack_block *block)
+{
+	return block->start == block->end;
+}
+
+/* Add a range SACKed by the peer to the scoreboard, merging it with
+ * the overlapping ranges. If the scoreboard is full, the lowest range
+ * is forgotten, it is the most likely one to be acknowledged soon.
+ */
+static void tcp_sack_insert(struct net_tcp *tcp, u32_t start, u32_t end)
+{
+	struct net_tcp_sack_block *block;
+	int i, slot = -1;
+
+	for (i = 0; i < NET_TCP_SACK_SCOREBOARD; i++) {
+		block = &tcp->sacked[i];
+
+		if (sack_block_empty(block) ||
+		    net_tcp_seq_cmp(start, block->end) > 0 ||
+		    net_tcp_seq_cmp(end, block->start) < 0) {
+			continue;
+		}
+
+		if (net_tcp_seq_cmp(block->start, start) < 0) {
+			start = block->start;
+		}
+
+		if (net_tcp_seq_greater(block->end, end)) {
+			end = block->end;
+		}
+
+		block->start = block->end = 0U;
+
+		/* The merged range may now overlap a range already
+		 * checked, start over.
+		 */
+		i = -1;
+	}
+
+	for (i = 0; i < NET_TCP_SACK_SCOREBOARD; i++) {
+		block = &tcp->sacked[i];
+
+		if (sack_block_empty(block)) {
+			slot = i;
+			break;
+		}
+
+		if (slot < 0 ||
+		    net_tcp_seq_cmp(block->start, tcp->sacked[slot].start) < 0) {
+			slot = i;
+		}
+	}
+
+	tcp->sacked[slot].start = start;
+	tcp->sacked[slot].end = end;
+}
+
+static void tcp_sack_update(struct net_tcp *tcp,
+			    struct net_tcp_options *opts)
+{
+	int i;
+
+	for (i = 0; i < opts->sack_count; i++) {
+		u32_t start = opts->sack[i].start;
+		u32_t end = opts->sack[i].end;
+
+		/* Skip D-SACK blocks and blocks for data not sent */
+		if (!net_tcp_seq_greater(end, start) ||
+		    !net_tcp_seq_greater(start, tcp->send_una) ||
+		    net_tcp_seq_greater(end, tcp->send_nxt)) {
+			continue;
+		}
+
+		tcp_sack_insert(tcp, start, end);
+	}
+}
+
+/* Forget the ranges below the cumulative ACK */
+static void tcp_sack_prune(struct net_tcp *tcp)
+{
+	struct net_tcp_sack_block *block;
+	int i;
+
+	for (i = 0; i < NET_TCP_SACK_SCOREBOARD; i++) {
+		block = &tcp->sacked[i];
+
+		if (sack_block_empty(block)) {
+			continue;
+		}
+
+		if (!net_tcp_seq_greater(block->end, tcp->send_una)) {
+			block->start = block->end = 0U;
+		} else if (net_tcp_seq_cmp(block->start, tcp->send_una) < 0) {
+			block->start = tcp->send_una;
+		}
+	}
+}
+
+static void tcp_sack_clear(struct net_tcp *tcp)
+{
+	(void)memset(tcp->sacked, 0, sizeof(tcp->sacked));
+}
+
+static bool tcp_is_sacked(struct net_tcp *tcp, u32_t start, u32_t end)
+{
+	struct net_tcp_sack_block *block;
+	int i;
+
+	for (i = 0; i < NET_TCP_SACK_SCOREBOARD; i++) {
+		block = &tcp->sacked[i];
+
+		if (!sack_block_empty(block) &&
+		    net_tcp_seq_cmp(block->start, start) <= 0 &&
+		    net_tcp_seq_cmp(block->end, end) >= 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Highest sequence number SACKed by the peer, or send_una if none */
+static u32_t tcp_sack_highest(struct net_tcp *tcp)
+{
+	u32_t highest = tcp->send_una;
+	int i;
+
+	for (i = 0; i < NET_TCP_SACK_SCOREBOARD; i++) {
+		if (!sack_block_empty(&tcp->sacked[i]) &&
+		    net_tcp_seq_greater(tcp->sacked[i].end, highest)) {
+			highest = tcp->sacked[i].end;
+		}
+	}
+
+	return highest;
+}
+#else
+#define tcp_sack_update(...)
+#define tcp_sack_prune(...)
+#define tcp_sack_clear(...)
+#define tcp_is_sacked(...) false
+#endif /* CONFIG_NET_TCP_SACK */
+
+/* Retransmit the first segment in [from, limit) that the peer has
+ * neither acknowledged nor SACKed. Returns the sequence number after
+ * the retransmitted segment, or from if nothing was retransmitted.
+ */
+static u32_t tcp_retransmit_hole(struct net_tcp *tcp, u32_t from,
+				 u32_t limit)
+{
+	struct net_pkt *pkt;
+	u32_t seq, seq_len;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		if (tcp_seg_info(pkt, &seq, &seq_len, NULL) < 0) {
+			continue;
+		}
+
+		if (net_tcp_seq_cmp(seq + seq_len, from) <= 0) {
+			continue;
+		}
+
+		if (net_tcp_seq_cmp(seq, limit) >= 0 ||
+		    net_tcp_seq_cmp(seq, tcp->send_nxt) >= 0) {
+			break;
+		}
+
+		if (tcp_is_sacked(tcp, seq, seq + seq_len)) {
+			continue;
+		}
+
+		/* Still waiting in the TX queue, it cannot be lost yet */
+		if (net_pkt_queued(pkt) && !is_6lo_technology(pkt)) {
+			break;
+		}
+
+		tcp_retransmit(tcp, pkt);
+
+		return seq + seq_len;
+	}
+
+	return from;
+}
+
+#if CONFIG_NET_TCP_OOO_QUEUE_SIZE > 0
+static void tcp_ooo_remove(struct net_tcp *tcp, int i)
+{
+	tcp->ooo_count--;
+
+	memmove(&tcp->ooo[i], &tcp->ooo[i + 1],
+		(tcp->ooo_count - i) * sizeof(tcp->ooo[0]));
+
+	if (tcp->ooo_last > i) {
+		tcp->ooo_last--;
+	} else if (tcp->ooo_last == i) {
+		tcp->ooo_last = 0U;
+	}
+}
+
+static void tcp_ooo_flush(struct net_tcp *tcp)
+{
+	while (tcp->ooo_count) {
+		net_pkt_unref(tcp->ooo[--tcp->ooo_count].pkt);
+	}
+
+	tcp->ooo_last = 0U;
+}
+
+/* Append the payload of src to dst. The cursor of both packets is at
+ * the start of the payload. The src packet is released.
+ */
+static void tcp_ooo_merge(struct net_pkt *dst, struct net_pkt *src)
+{
+	size_t hdr_len = net_pkt_get_len(src) - net_pkt_remaining_data(src);
+	struct net_buf *frag;
+	size_t len;
+
+	while (hdr_len) {
+		frag = src->buffer;
+		len = MIN(frag->len, hdr_len);
+
+		net_buf_pull(frag, len);
+		hdr_len -= len;
+
+		if (!frag->len) {
+			src->buffer = net_buf_frag_del(NULL, frag);
+		}
+	}
+
+	net_pkt_append_buffer(dst, src->buffer);
+	src->buffer = NULL;
+
+	net_pkt_unref(src);
+}
+
+/* Queue a data segment received above the next expected sequence
+ * number. Segments adjacent to queued data are merged with it, and
+ * segments overlapping queued data are dropped. Returns false if the
+ * segment was not queued and must be dropped by the caller.
+ */
+static bool tcp_ooo_queue(struct net_tcp *tcp, struct net_pkt *pkt,
+			  u32_t start, u16_t len, u8_t flags)
+{
+	struct net_tcp_ooo_seg *seg;
+	u32_t end = start + len;
+	int i;
+
+	if (!len || (flags & (NET_TCP_SYN | NET_TCP_FIN | NET_TCP_RST))) {
+		return false;
+	}
+
+	if (net_tcp_seq_greater(end, tcp->send_ack +
+				net_tcp_get_recv_wnd(tcp))) {
+		return false;
+	}
+
+	for (i = 0; i < tcp->ooo_count; i++) {
+		if (net_tcp_seq_cmp(start, tcp->ooo[i].start) < 0) {
+			break;
+		}
+	}
+
+	if (i > 0 && net_tcp_seq_greater(tcp->ooo[i - 1].end, start)) {
+#if defined(CONFIG_NET_TCP_SACK)
+		if (!net_tcp_seq_greater(end, tcp->ooo[i - 1].end)) {
+			tcp->dsack.start = start;
+			tcp->dsack.end = end;
+		}
+#endif
+		return false;
+	}
+
+	if (i < tcp->ooo_count &&
+	    net_tcp_seq_greater(end, tcp->ooo[i].start)) {
+		return false;
+	}
+
+	if (i > 0 && tcp->ooo[i - 1].end == start) {
+		seg = &tcp->ooo[i - 1];
+		tcp_ooo_merge(seg->pkt, pkt);
+		seg->end = end;
+		tcp->ooo_last = i - 1;
+
+		/* The segment filled the gap between two entries */
+		if (i < tcp->ooo_count && tcp->ooo[i].start == end) {
+			tcp_ooo_merge(seg->pkt, tcp->ooo[i].pkt);
+			seg->end = tcp->ooo[i].end;
+			tcp_ooo_remove(tcp, i);
+		}
+
+		return true;
+	}
+
+	if (i < tcp->ooo_count && tcp->ooo[i].start == end) {
+		seg = &tcp->ooo[i];
+		tcp_ooo_merge(pkt, seg->pkt);
+		seg->pkt = pkt;
+		seg->start = start;
+		tcp->ooo_last = i;
+
+		return true;
+	}
+
+	if (tcp->ooo_count == CONFIG_NET_TCP_OOO_QUEUE_SIZE) {
+		/* The data closest to the hole is the most useful one */
+		if (i == tcp->ooo_count) {
+			return false;
+		}
+
+		net_pkt_unref(tcp->ooo[--tcp->ooo_count].pkt);
+	}
+
+	memmove(&tcp->ooo[i + 1], &tcp->ooo[i],
+		(tcp->ooo_count - i) * sizeof(tcp->ooo[0]));
+
+	tcp->ooo[i].pkt = pkt;
+	tcp->ooo[i].start = start;
+	tcp->ooo[i].end = end;
+	tcp->ooo_count++;
+	tcp->ooo_last = i;
+
+	NET_DBG("[%p] Queued out of order pkt %p seq %u len %u (%u queued)",
+		tcp, pkt, start, len, tcp->ooo_count);
+
+	return true;
+}
+
+/* Pass the queued data that is now in sequence to the application */
+static void tcp_ooo_deliver(struct net_context *context,
+			    struct net_conn *conn)
+{
+	struct net_tcp *tcp = context->tcp;
+	struct net_tcp_ooo_seg seg;
+
+	while (tcp->ooo_count &&
+	       net_tcp_seq_cmp(tcp->ooo[0].start, tcp->send_ack) <= 0) {
+		NET_PKT_DATA_ACCESS_DEFINE(ipv4_access, struct net_ipv4_hdr);
+		NET_PKT_DATA_ACCESS_DEFINE(ipv6_access, struct net_ipv6_hdr);
+		NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+		union net_proto_header proto_hdr;
+		union net_ip_header ip_hdr;
+		struct net_pkt_cursor payload;
+		void *hdr;
+
+		seg = tcp->ooo[0];
+		tcp_ooo_remove(tcp, 0);
+
+		if (!net_tcp_seq_greater(seg.end, tcp->send_ack)) {
+			net_pkt_unref(seg.pkt);
+			continue;
+		}
+
+		/* The recv callback gets the headers of the first merged
+		 * segment.
+		 */
+		net_pkt_cursor_backup(seg.pkt, &payload);
+		net_pkt_cursor_init(seg.pkt);
+
+		if (net_pkt_family(seg.pkt) == AF_INET) {
+			hdr = net_pkt_get_data(seg.pkt, &ipv4_access);
+			ip_hdr.ipv4 = hdr;
+		} else {
+			hdr = net_pkt_get_data(seg.pkt, &ipv6_access);
+			ip_hdr.ipv6 = hdr;
+		}
+
+		net_pkt_skip(seg.pkt, net_pkt_ip_hdr_len(seg.pkt) +
+			     net_pkt_ipv6_ext_len(seg.pkt));
+		proto_hdr.tcp = net_pkt_get_data(seg.pkt, &tcp_access);
+
+		net_pkt_cursor_restore(seg.pkt, &payload);
+
+		if (!hdr || !proto_hdr.tcp ||
+		    net_pkt_skip(seg.pkt, tcp->send_ack - seg.start)) {
+			net_pkt_unref(seg.pkt);
+			continue;
+		}
+
+		NET_DBG("[%p] Deliver queued pkt %p seq %u len %u", tcp,
+			seg.pkt, tcp->send_ack, seg.end - tcp->send_ack);
+
+		tcp->send_ack = seg.end;
+
+		if (net_context_packet_received(conn, seg.pkt, &ip_hdr,
+						&proto_hdr,
+						tcp->recv_user_data) ==
+		    NET_DROP) {
+			net_pkt_unref(seg.pkt);
+		}
+	}
+}
+#else
+#define tcp_ooo_flush(...)
+#define tcp_ooo_queue(...) false
+#define tcp_ooo_deliver(...)
+#endif /* CONFIG_NET_TCP_OOO_QUEUE_SIZE > 0 */
+
+/* Initial window, RFC 5681 chapter 3.1 */
+static u32_t tcp_initial_window(struct net_tcp *tcp)
+{
+	if (tcp->send_mss > 2190) {
+		return 2U * tcp->send_mss;
+	} else if (tcp->send_mss > 1095) {
+		return 3U * tcp->send_mss;
+	}
+
+	return 4U * tcp->send_mss;
+}
+
+/* Reset the send side state, called when the connection gets
+ * established and the peer MSS and window are known.
+ */
+static void tcp_init_send_state(struct net_tcp *tcp, u32_t wnd)
+{
+	tcp->send_una = tcp->send_seq;
+	tcp->send_nxt = tcp->send_seq;
+	tcp->recover = tcp->send_seq - 1;
+	tcp->rexmit_nxt = tcp->send_seq;
+	tcp->send_wnd = wnd;
+	tcp->cwnd = tcp_initial_window(tcp);
+	tcp->ssthresh = UINT32_MAX;
+	tcp->dup_acks = 0U;
+	tcp->flags &= ~NET_TCP_IN_RECOVERY;
+
+	tcp_sack_clear(tcp);
+
+	tcp->cc->init(tcp);
+}
+
+/* Retransmission timeout, RFC 5681 chapter 3.1 and RFC 6582 chapter 4 */
+static void tcp_timeout_loss(struct net_tcp *tcp)
+{
+	/* Only the first timeout of a segment reduces ssthresh */
+	if (tcp->retry_timeout_shift == 1U) {
+		tcp->ssthresh = tcp->cc->ssthresh(tcp);
+	}
+
+	tcp->cwnd = tcp->send_mss;
+	tcp->recover = tcp->send_nxt;
+	tcp->rexmit_nxt = tcp->send_una;
+	tcp->dup_acks = 0U;
+	tcp->flags &= ~NET_TCP_IN_RECOVERY;
+
+	/* The peer may have dropped the SACKed data, RFC 2018 chapter 8 */
+	tcp_sack_clear(tcp);
+}
+
+/* New round trip time sample from the timestamps option, RFC 6298
+ * chapter 2. The configured initial RTO is also used as the lower
+ * bound, so that the timeout is never shorter than without samples.
+ */
+static void tcp_rtt_update(struct net_tcp *tcp, u32_t rtt)
+{
+	u32_t delta;
+
+	if (!tcp->srtt) {
+		tcp->srtt = MAX(rtt, 1U);
+		tcp->rttvar = rtt / 2U;
+	} else {
+		delta = tcp->srtt > rtt ? tcp->srtt - rtt : rtt - tcp->srtt;
+		tcp->rttvar = (3U * tcp->rttvar + delta) / 4U;
+		tcp->srtt = MAX((7U * tcp->srtt + rtt) / 8U, 1U);
+	}
+
+	tcp->rto = tcp->srtt + MAX(4U * tcp->rttvar, 1U);
+	tcp->rto = MAX(tcp->rto, CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT);
+	tcp->rto = MIN(tcp->rto, NET_TCP_MAX_RTO);
+
+	NET_DBG("[%p] rtt %u srtt %u rttvar %u rto %u", tcp, rtt, tcp->srtt,
+		tcp->rttvar, tcp->rto);
+}
+
+/* Smallest shift count that lets the whole receive buffer be
+ * advertised, RFC 7323 chapter 2.
+ */
+static u8_t tcp_recv_wscale(void)
+{
+	u8_t shift = 0U;
+
+	while (shift < NET_TCP_MAX_WSCALE &&
+	       (NET_TCP_BUF_MAX_LEN >> shift) > UINT16_MAX) {
+		shift++;
+	}
+
+	return shift;
+}
+
+/* Flags of the options that both sides have sent in their SYN */
+static u8_t tcp_negotiate_opts(struct net_tcp_options *opts)
+{
+	u8_t opt_flags = 0U;
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK) && opts->sack_perm) {
+		opt_flags |= NET_TCP_SACK_OK;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_TIMESTAMPS) && opts->ts_present) {
+		opt_flags |= NET_TCP_TS_OK;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) && opts->wscale_present) {
+		opt_flags |= NET_TCP_WSCALE_OK;
+	}
+
+	return opt_flags;
+}
+
+/* Use the negotiated options on a connection */
+static void tcp_set_opts(struct net_tcp *tcp, u8_t opt_flags,
+			 u8_t send_wscale, u32_t ts_recent)
+{
+	tcp->flags = (tcp->flags & ~TCP_OPT_FLAGS) | opt_flags;
+	tcp->ts_recent = ts_recent;
+
+	if (opt_flags & NET_TCP_WSCALE_OK) {
+		tcp->send_wscale = MIN(send_wscale, NET_TCP_MAX_WSCALE);
+		tcp->recv_wscale = tcp_recv_wscale();
+	} else {
+		tcp->send_wscale = 0U;
+		tcp->recv_wscale = 0U;
+	}
+}
+
+/* Window field of a segment. The window of a SYN segment is never
+ * scaled.
+ */
+static u16_t tcp_adv_wnd(struct net_tcp *tcp, u8_t flags)
+{
+	u32_t wnd = net_tcp_get_recv_wnd(tcp);
+
+	if (!(flags & NET_TCP_SYN)) {
+		wnd >>= tcp->recv_wscale;
+	}
+
+	return MIN(wnd, UINT16_MAX);
+}
+
 static void tcp_retry_expired(struct k_work *work)
 {
 	struct net_tcp *tcp = CONTAINER_OF(work, struct net_tcp, retry_timer);
 	struct net_pkt *pkt;
 
 	/* Double the retry period for exponential backoff and resend
-	 * the first (only the first!) unack'd packet.
+	 * the first (only the first!) unack'd packet. The remaining
+	 * segments are resent one by one when the ACKs for the
+	 * retransmissions arrive.
 	 */
 	if (!sys_slist_is_empty(&tcp->sent_list)) {
 		tcp->retry_timeout_shift++;
@@ -226,29 +850,12 @@ static void tcp_retry_expired(struct k_work *work)
 
 		k_delayed_work_submit(&tcp->retry_timer, retry_timeout(tcp));
 
+		tcp_timeout_loss(tcp);
+
 		pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
 				   struct net_pkt, sent_list);
 
-		if (net_pkt_sent(pkt)) {
-			do_ref_if_needed(tcp, pkt);
-			net_pkt_set_sent(pkt, false);
-		}
-
-		net_pkt_set_queued(pkt, true);
-
-		if (net_tcp_send_pkt(pkt) < 0 && !is_6lo_technology(pkt)) {
-			NET_DBG("retry %u: [%p] pkt %p send failed",
-				tcp->retry_timeout_shift, tcp, pkt);
-			net_pkt_unref(pkt);
-		} else {
-			NET_DBG("retry %u: [%p] sent pkt %p",
-				tcp->retry_timeout_shift, tcp, pkt);
-			if (IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
-			    !is_6lo_technology(pkt)) {
-				net_stats_update_tcp_seg_rexmit(
-							net_pkt_iface(pkt));
-			}
-		}
+		tcp_retransmit(tcp, pkt);
 	} else if (CONFIG_NET_TCP_TIME_WAIT_DELAY != 0) {
 		if (tcp->fin_sent && tcp->fin_rcvd) {
 			NET_DBG("[%p] Closing connection (context %p)",
@@ -284,9 +891,13 @@ struct net_tcp *net_tcp_alloc(struct net_context *context)
 	tcp_context[i].send_seq = tcp_init_isn();
 	tcp_context[i].recv_wnd = MIN(NET_TCP_MAX_WIN, NET_TCP_BUF_MAX_LEN);
 	tcp_context[i].send_mss = NET_TCP_DEFAULT_MSS;
+	tcp_context[i].rto = CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT;
 
 	tcp_context[i].accept_cb = NULL;
 
+	tcp_context[i].cc = NET_TCP_CC_DEFAULT;
+	tcp_init_send_state(&tcp_context[i], NET_TCP_MAX_WIN);
+
 	k_delayed_work_init(&tcp_context[i].retry_timer, tcp_retry_expired);
 	k_sem_init(&tcp_context[i].connect_wait, 0, UINT_MAX);
 
@@ -329,6 +940,8 @@ int net_tcp_release(struct net_tcp *tcp)
 		net_pkt_unref(pkt);
 	}
 
+	tcp_ooo_flush(tcp);
+
 	retry_timer_cancel(tcp);
 	k_sem_reset(&tcp->connect_wait);
 
@@ -562,7 +1175,7 @@ int net_tcp_prepare_segment(struct net_tcp *tcp, u8_t flags,
 		}
 	}
 
-	wnd = net_tcp_get_recv_wnd(tcp);
+	wnd = tcp_adv_wnd(tcp, flags);
 
 	segment.src_addr = (struct sockaddr_ptr *)local;
 	segment.dst_addr = remote;
@@ -648,39 +1261,174 @@ u16_t net_tcp_get_recv_mss(const struct net_tcp *tcp)
 			mss = NET_IPV6_MTU;
 		}
 
-		return mss;
+		return mss;
+	}
+#endif /* CONFIG_NET_IPV6 */
+
+	return 0;
+}
+
+static void net_tcp_set_syn_opt(struct net_tcp *tcp, u8_t *options,
+				u8_t *optionlen)
+{
+	u32_t recv_mss;
+
+	*optionlen = 0U;
+
+	if (!(tcp->flags & NET_TCP_RECV_MSS_SET)) {
+		recv_mss = net_tcp_get_recv_mss(tcp);
+		tcp->flags |= NET_TCP_RECV_MSS_SET;
+	} else {
+		recv_mss = 0U;
+	}
+
+	recv_mss |= (NET_TCP_MSS_OPT << 24) | (NET_TCP_MSS_SIZE << 16);
+	UNALIGNED_PUT(htonl(recv_mss),
+		      (u32_t *)(options + *optionlen));
+
+	*optionlen += NET_TCP_MSS_SIZE;
+}
+
+/* Append SACK permitted option to a SYN, or to a SYN-ACK if the peer
+ * sent it in its SYN.
+ */
+static void net_tcp_set_sack_perm_opt(u8_t opt_flags, u8_t flags,
+				      u8_t *options, u8_t *optionlen)
+{
+	if (!IS_ENABLED(CONFIG_NET_TCP_SACK)) {
+		return;
+	}
+
+	if ((flags & NET_TCP_ACK) && !(opt_flags & NET_TCP_SACK_OK)) {
+		return;
+	}
+
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_SACK_PERM_OPT;
+	options[(*optionlen)++] = NET_TCP_SACK_PERM_SIZE;
+}
+
+/* Append window scale option to a SYN, or to a SYN-ACK if the peer
+ * sent it in its SYN.
+ */
+static void net_tcp_set_wscale_opt(u8_t opt_flags, u8_t flags,
+				   u8_t *options, u8_t *optionlen)
+{
+	if (!IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE)) {
+		return;
+	}
+
+	if ((flags & NET_TCP_ACK) && !(opt_flags & NET_TCP_WSCALE_OK)) {
+		return;
+	}
+
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_WINDOW_SCALE_OPT;
+	options[(*optionlen)++] = NET_TCP_WINDOW_SCALE_SIZE;
+	options[(*optionlen)++] = tcp_recv_wscale();
+}
+
+static inline u32_t tcp_ts_now(void)
+{
+	/* One tick per millisecond, RFC 7323 chapter 5.4 */
+	return k_uptime_get_32();
+}
+
+/* Append timestamps option to a SYN, or to any other segment if both
+ * sides sent it in their SYN. ts_recent is the timestamp to echo.
+ */
+static void net_tcp_set_ts_opt(u8_t opt_flags, u32_t ts_recent, u8_t flags,
+			       u8_t *options, u8_t *optionlen)
+{
+	if (!IS_ENABLED(CONFIG_NET_TCP_TIMESTAMPS)) {
+		return;
+	}
+
+	if (flags != NET_TCP_SYN && !(opt_flags & NET_TCP_TS_OK)) {
+		return;
 	}
-#endif /* CONFIG_NET_IPV6 */
 
-	return 0;
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_TIMESTAMP_OPT;
+	options[(*optionlen)++] = NET_TCP_TIMESTAMP_SIZE;
+
+	UNALIGNED_PUT(htonl(tcp_ts_now()), (u32_t *)(options + *optionlen));
+	UNALIGNED_PUT(htonl((flags & NET_TCP_ACK) ? ts_recent : 0U),
+		      (u32_t *)(options + *optionlen + sizeof(u32_t)));
+	*optionlen += 2 * sizeof(u32_t);
 }
 
-static void net_tcp_set_syn_opt(struct net_tcp *tcp, u8_t *options,
-				u8_t *optionlen)
+#if defined(CONFIG_NET_TCP_SACK)
+/* Report a duplicate segment received from the peer (D-SACK, RFC 2883)
+ * and the data queued out of order. The D-SACK block is sent only once,
+ * and the queued segment received last comes first, RFC 2018 chapter 4.
+ */
+static void net_tcp_set_sack_opt(struct net_tcp *tcp, u8_t *options,
+				 u8_t *optionlen)
 {
-	u32_t recv_mss;
+	struct net_tcp_sack_block blocks[NET_TCP_MAX_SACK_BLOCKS];
+	int count = 0;
+	int max, i;
 
-	*optionlen = 0U;
+	if (!(tcp->flags & NET_TCP_SACK_OK)) {
+		return;
+	}
 
-	if (!(tcp->flags & NET_TCP_RECV_MSS_SET)) {
-		recv_mss = net_tcp_get_recv_mss(tcp);
-		tcp->flags |= NET_TCP_RECV_MSS_SET;
-	} else {
-		recv_mss = 0U;
+	max = (NET_TCP_MAX_OPT_SPACE - *optionlen - 4) /
+		NET_TCP_SACK_BLOCK_SIZE;
+	max = MIN(max, NET_TCP_MAX_SACK_BLOCKS);
+
+	if (!sack_block_empty(&tcp->dsack) && count < max) {
+		blocks[count++] = tcp->dsack;
+		tcp->dsack.start = tcp->dsack.end = 0U;
 	}
 
-	recv_mss |= (NET_TCP_MSS_OPT << 24) | (NET_TCP_MSS_SIZE << 16);
-	UNALIGNED_PUT(htonl(recv_mss),
-		      (u32_t *)(options + *optionlen));
+#if CONFIG_NET_TCP_OOO_QUEUE_SIZE > 0
+	if (tcp->ooo_count && count < max) {
+		blocks[count].start = tcp->ooo[tcp->ooo_last].start;
+		blocks[count].end = tcp->ooo[tcp->ooo_last].end;
+		count++;
+	}
 
-	*optionlen += NET_TCP_MSS_SIZE;
+	for (i = 0; i < tcp->ooo_count && count < max; i++) {
+		if (i == tcp->ooo_last) {
+			continue;
+		}
+
+		blocks[count].start = tcp->ooo[i].start;
+		blocks[count].end = tcp->ooo[i].end;
+		count++;
+	}
+#endif
+
+	if (!count) {
+		return;
+	}
+
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_SACK_OPT;
+	options[(*optionlen)++] = 2 + count * NET_TCP_SACK_BLOCK_SIZE;
+
+	for (i = 0; i < count; i++) {
+		UNALIGNED_PUT(htonl(blocks[i].start),
+			      (u32_t *)(options + *optionlen));
+		UNALIGNED_PUT(htonl(blocks[i].end),
+			      (u32_t *)(options + *optionlen + sizeof(u32_t)));
+		*optionlen += NET_TCP_SACK_BLOCK_SIZE;
+	}
 }
+#else
+#define net_tcp_set_sack_opt(...)
+#endif /* CONFIG_NET_TCP_SACK */
 
 int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 			struct net_pkt **pkt)
 {
-	u8_t options[NET_TCP_MAX_OPT_SIZE];
-	u8_t optionlen;
+	u8_t options[NET_TCP_MAX_OPT_SPACE];
+	u8_t optionlen = 0U;
 
 	switch (net_tcp_get_state(tcp)) {
 	case NET_TCP_SYN_RCVD:
@@ -688,6 +1436,14 @@ int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 		 * SYN flag.
 		 */
 		net_tcp_set_syn_opt(tcp, options, &optionlen);
+		net_tcp_set_wscale_opt(tcp->flags, NET_TCP_SYN | NET_TCP_ACK,
+				       options, &optionlen);
+		net_tcp_set_sack_perm_opt(tcp->flags,
+					  NET_TCP_SYN | NET_TCP_ACK,
+					  options, &optionlen);
+		net_tcp_set_ts_opt(tcp->flags, tcp->ts_recent,
+				   NET_TCP_SYN | NET_TCP_ACK,
+				   options, &optionlen);
 
 		return net_tcp_prepare_segment(tcp, NET_TCP_SYN | NET_TCP_ACK,
 					       options, optionlen, NULL, remote,
@@ -697,11 +1453,21 @@ int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 		/* In the FIN_WAIT_1 and LAST_ACK states acknowledgment must
 		 * be with the FIN flag.
 		 */
+		net_tcp_set_ts_opt(tcp->flags, tcp->ts_recent,
+				   NET_TCP_FIN | NET_TCP_ACK,
+				   options, &optionlen);
+
 		return net_tcp_prepare_segment(tcp, NET_TCP_FIN | NET_TCP_ACK,
-					       0, 0, NULL, remote, pkt);
+					       optionlen ? options : NULL,
+					       optionlen, NULL, remote, pkt);
 	default:
-		return net_tcp_prepare_segment(tcp, NET_TCP_ACK, 0, 0, NULL,
-					       remote, pkt);
+		net_tcp_set_ts_opt(tcp->flags, tcp->ts_recent, NET_TCP_ACK,
+				   options, &optionlen);
+		net_tcp_set_sack_opt(tcp, options, &optionlen);
+
+		return net_tcp_prepare_segment(tcp, NET_TCP_ACK,
+					       optionlen ? options : NULL,
+					       optionlen, NULL, remote, pkt);
 	}
 
 	return -EINVAL;
@@ -804,6 +1570,8 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 {
 	struct net_conn *conn = (struct net_conn *)context->conn_handler;
 	size_t data_len = net_pkt_get_len(pkt);
+	u8_t options[NET_TCP_TIMESTAMP_OPT_SIZE];
+	u8_t optionlen = 0U;
 	int ret;
 
 	NET_DBG("[%p] Queue %p len %zd", context->tcp, pkt, data_len);
@@ -817,12 +1585,22 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 		return -ESHUTDOWN;
 	}
 
+	if (!net_tcp_is_writable(context)) {
+		NET_DBG("[%p] Send queue full", context->tcp);
+		return -EAGAIN;
+	}
+
+	/* The timestamp is refreshed when the segment is (re)sent */
+	net_tcp_set_ts_opt(context->tcp->flags, context->tcp->ts_recent,
+			   NET_TCP_PSH | NET_TCP_ACK, options, &optionlen);
+
 	/* Set PSH on all packets, our window is so small that there's
 	 * no point in the remote side trying to finesse things and
 	 * coalesce packets.
 	 */
 	ret = net_tcp_prepare_segment(context->tcp, NET_TCP_PSH | NET_TCP_ACK,
-				      NULL, 0, NULL, &conn->remote_addr, &pkt);
+				      optionlen ? options : NULL, optionlen,
+				      NULL, &conn->remote_addr, &pkt);
 	if (ret) {
 		return ret;
 	}
@@ -834,6 +1612,22 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 	return net_tcp_queue_pkt(context, pkt);
 }
 
+bool net_tcp_is_writable(struct net_context *context)
+{
+	struct net_tcp *tcp = context->tcp;
+
+	/* Sending fails right away on these */
+	if (!tcp || net_context_get_state(context) != NET_CONTEXT_CONNECTED ||
+	    (tcp->flags & NET_TCP_IS_SHUTDOWN)) {
+		return true;
+	}
+
+	/* The queue may go over the limit by one segment, so that any
+	 * amount of data can be sent.
+	 */
+	return tcp->send_seq - tcp->send_una < CONFIG_NET_TCP_SEND_QUEUE_SIZE;
+}
+
 /* This function is the sole point of *adding* packets to tcp->sent_list,
  * and should remain such.
  */
@@ -852,6 +1646,46 @@ static int net_tcp_queue_pkt(struct net_context *context, struct net_pkt *pkt)
 	return 0;
 }
 
+/* Refresh the timestamps option of a segment about to be sent. Our
+ * segments have it first, right after the fixed header.
+ */
+static bool tcp_update_ts_opt(struct net_tcp *tcp, struct net_pkt *pkt,
+			      struct net_tcp_hdr *tcp_hdr)
+{
+	struct net_pkt_cursor backup;
+	u32_t opt;
+	bool updated = false;
+
+	if (!(tcp->flags & NET_TCP_TS_OK) ||
+	    NET_TCP_HDR_LEN(tcp_hdr) < NET_TCPH_LEN +
+				       NET_TCP_TIMESTAMP_OPT_SIZE) {
+		return false;
+	}
+
+	net_pkt_cursor_backup(pkt, &backup);
+
+	if (net_pkt_skip(pkt, NET_TCPH_LEN) ||
+	    net_pkt_read_be32(pkt, &opt)) {
+		goto out;
+	}
+
+	if (opt != ((NET_TCP_NOP_OPT << 24) | (NET_TCP_NOP_OPT << 16) |
+		    (NET_TCP_TIMESTAMP_OPT << 8) | NET_TCP_TIMESTAMP_SIZE)) {
+		goto out;
+	}
+
+	if (net_pkt_write_be32(pkt, tcp_ts_now()) ||
+	    net_pkt_write_be32(pkt, tcp->ts_recent)) {
+		goto out;
+	}
+
+	updated = true;
+out:
+	net_pkt_cursor_restore(pkt, &backup);
+
+	return updated;
+}
+
 int net_tcp_send_pkt(struct net_pkt *pkt)
 {
 	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
@@ -897,6 +1731,22 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 		calc_chksum = true;
 	}
 
+	/* Queued and retransmitted segments advertise the current window
+	 * and carry the current timestamp.
+	 */
+	if (sys_get_be16(tcp_hdr->wnd) != tcp_adv_wnd(ctx->tcp,
+						      tcp_hdr->flags)) {
+		sys_put_be16(tcp_adv_wnd(ctx->tcp, tcp_hdr->flags),
+			     tcp_hdr->wnd);
+		tcp_hdr->chksum = 0U;
+		calc_chksum = true;
+	}
+
+	if (tcp_update_ts_opt(ctx->tcp, pkt, tcp_hdr)) {
+		tcp_hdr->chksum = 0U;
+		calc_chksum = true;
+	}
+
 	/* As we modified the header, we need to write it back.
 	 */
 	net_pkt_set_data(pkt, &tcp_access);
@@ -990,38 +1840,69 @@ static void restart_timer(struct net_tcp *tcp)
 	}
 }
 
-int net_tcp_send_data(struct net_context *context, net_context_send_cb_t cb,
-		      void *user_data)
+/* Send the queued segments that fit into the congestion window and the
+ * window advertised by the peer. One segment is always allowed when
+ * nothing is in flight, so that a zero window gets probed by the
+ * retransmit timer.
+ */
+static void tcp_send_queued(struct net_tcp *tcp)
 {
+	u32_t wnd = MIN(tcp->cwnd, tcp->send_wnd);
 	struct net_pkt *pkt;
+	u32_t seq, seq_len;
+	u32_t flight;
 
-	/* For now, just send all queued data synchronously.  Need to
-	 * add window handling and retry/ACK logic.
-	 */
-	SYS_SLIST_FOR_EACH_CONTAINER(&context->tcp->sent_list, pkt, sent_list) {
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
 		/* Do not resend packets that were sent by expire timer */
 		if (net_pkt_queued(pkt)) {
 			NET_DBG("[%p] Skipping pkt %p because it was already "
-				"sent.", context->tcp, pkt);
+				"sent.", tcp, pkt);
 			continue;
 		}
 
 		if (!net_pkt_sent(pkt)) {
 			int ret;
 
-			NET_DBG("[%p] Sending pkt %p (%zd bytes)", context->tcp,
+			if (tcp_seg_info(pkt, &seq, &seq_len, NULL) < 0) {
+				continue;
+			}
+
+			flight = tcp->send_nxt - tcp->send_una;
+			if (flight && flight + seq_len > wnd) {
+				NET_DBG("[%p] Window full (flight %u cwnd %u "
+					"wnd %u)", tcp, flight, tcp->cwnd,
+					tcp->send_wnd);
+				break;
+			}
+
+			NET_DBG("[%p] Sending pkt %p (%zd bytes)", tcp,
 				pkt, net_pkt_get_len(pkt));
 
 			ret = net_tcp_send_pkt(pkt);
-			if (ret < 0 && !is_6lo_technology(pkt)) {
+			if (ret < 0) {
+				/* Keep the reference taken for the driver,
+				 * the segment is sent again by the next call
+				 * or by the retransmit timer.
+				 */
 				NET_DBG("[%p] pkt %p not sent (%d)",
-					context->tcp, pkt, ret);
-				net_pkt_unref(pkt);
+					tcp, pkt, ret);
+				break;
 			}
 
 			net_pkt_set_queued(pkt, true);
+
+			if (net_tcp_seq_greater(seq + seq_len,
+						tcp->send_nxt)) {
+				tcp->send_nxt = seq + seq_len;
+			}
 		}
 	}
+}
+
+int net_tcp_send_data(struct net_context *context, net_context_send_cb_t cb,
+		      void *user_data)
+{
+	tcp_send_queued(context->tcp);
 
 	/* Just make the callback synchronously even if it didn't
 	 * go over the wire.  In theory it would be nice to track
@@ -1036,6 +1917,113 @@ int net_tcp_send_data(struct net_context *context, net_context_send_cb_t cb,
 	return 0;
 }
 
+/* The peer acknowledged new data, RFC 5681 and RFC 6582 chapter 3.2 */
+static void tcp_new_ack(struct net_tcp *tcp, u32_t ack)
+{
+	u32_t acked = ack - tcp->send_una;
+	u32_t from;
+
+	tcp->send_una = ack;
+	tcp->dup_acks = 0U;
+
+	if (net_tcp_seq_greater(ack, tcp->send_nxt)) {
+		/* A segment sent by the retransmit timer only */
+		tcp->send_nxt = ack;
+	}
+
+	tcp_sack_prune(tcp);
+
+	from = net_tcp_seq_greater(tcp->rexmit_nxt, ack) ?
+		tcp->rexmit_nxt : ack;
+
+	if (tcp->flags & NET_TCP_IN_RECOVERY) {
+		if (!net_tcp_seq_greater(tcp->recover, ack)) {
+			/* Full acknowledgment, deflate the window */
+			tcp->cwnd = MIN(tcp->ssthresh,
+					MAX(tcp->send_nxt - ack,
+					    (u32_t)tcp->send_mss) +
+					tcp->send_mss);
+			tcp->flags &= ~NET_TCP_IN_RECOVERY;
+
+			NET_DBG("[%p] Fast recovery done, cwnd %u", tcp,
+				tcp->cwnd);
+			return;
+		}
+
+		/* Partial acknowledgment, the next hole is lost too */
+		tcp->rexmit_nxt = tcp_retransmit_hole(tcp, from,
+						      tcp->recover);
+
+		tcp->cwnd -= MIN(acked, tcp->cwnd);
+		if (acked >= tcp->send_mss) {
+			tcp->cwnd += tcp->send_mss;
+		}
+
+		tcp->cwnd = MAX(tcp->cwnd, (u32_t)tcp->send_mss);
+
+		return;
+	}
+
+	tcp->cc->cong_avoid(tcp, acked);
+
+	if (net_tcp_seq_greater(tcp->recover, ack)) {
+		/* After a retransmission timeout, all the segments that
+		 * were in flight are presumed lost, send them again as
+		 * their predecessors get acknowledged.
+		 */
+		tcp->rexmit_nxt = tcp_retransmit_hole(tcp, from,
+						      tcp->recover);
+	}
+}
+
+/* A duplicate ACK was received, RFC 5681 chapter 3.2 and RFC 6582 */
+static void tcp_dup_ack(struct net_tcp *tcp)
+{
+	if (tcp->flags & NET_TCP_IN_RECOVERY) {
+		/* Another segment has left the network */
+		tcp->cwnd += tcp->send_mss;
+
+#if defined(CONFIG_NET_TCP_SACK)
+		/* With SACK the holes below the highest SACKed segment
+		 * are known, resend the next one.
+		 */
+		if (tcp->flags & NET_TCP_SACK_OK) {
+			tcp->rexmit_nxt = tcp_retransmit_hole(tcp,
+						tcp->rexmit_nxt,
+						tcp_sack_highest(tcp));
+		}
+#endif
+
+		return;
+	}
+
+	if (tcp->dup_acks < NET_TCP_DUP_ACK_THRESHOLD) {
+		tcp->dup_acks++;
+	}
+
+	if (tcp->dup_acks < NET_TCP_DUP_ACK_THRESHOLD) {
+		return;
+	}
+
+	/* Do not start a new recovery for losses of the segments that
+	 * were in flight during the previous one.
+	 */
+	if (!net_tcp_seq_greater(tcp->send_una, tcp->recover)) {
+		return;
+	}
+
+	tcp->ssthresh = tcp->cc->ssthresh(tcp);
+	tcp->cwnd = tcp->ssthresh + NET_TCP_DUP_ACK_THRESHOLD * tcp->send_mss;
+	tcp->recover = tcp->send_nxt;
+	tcp->flags |= NET_TCP_IN_RECOVERY;
+
+	NET_DBG("[%p] Fast retransmit, ssthresh %u cwnd %u", tcp,
+		tcp->ssthresh, tcp->cwnd);
+
+	tcp->rexmit_nxt = tcp_retransmit_hole(tcp, tcp->send_una,
+					      tcp->recover);
+}
+
 bool net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 {
 	struct net_tcp *tcp = ctx->tcp;
@@ -1055,51 +2043,31 @@ bool net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 	}
 
 	while (!sys_slist_is_empty(list)) {
-		NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
-		struct net_tcp_hdr *tcp_hdr;
 		u32_t last_seq;
 		u32_t seq_len;
+		u32_t seq;
+		u8_t flags;
+		int ret;
 
 		head = sys_slist_peek_head(list);
 		pkt = CONTAINER_OF(head, struct net_pkt, sent_list);
 
-		net_pkt_cursor_init(pkt);
-		net_pkt_set_overwrite(pkt, true);
-
-		if (net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
-			 net_pkt_ipv6_ext_len(pkt))) {
-			sys_slist_remove(list, NULL, head);
-			net_pkt_unref(pkt);
-			continue;
-		}
+		ret = tcp_seg_info(pkt, &seq, &seq_len, &flags);
+		if (ret < 0) {
+			if (ret == -ENOBUFS) {
+				/* The pkt does not contain TCP header, this
+				 * should not happen.
+				 */
+				NET_ERR("pkt %p has no TCP header", pkt);
+			}
 
-		tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data(pkt,
-								 &tcp_access);
-		if (!tcp_hdr) {
-			/* The pkt does not contain TCP header, this should
-			 * not happen.
-			 */
-			NET_ERR("pkt %p has no TCP header", pkt);
 			sys_slist_remove(list, NULL, head);
 			net_pkt_unref(pkt);
 			continue;
 		}
 
-		net_pkt_acknowledge_data(pkt, &tcp_access);
-		seq_len = net_pkt_remaining_data(pkt);
-
-		/* Each of SYN and FIN flags are counted
-		 * as one sequence number.
-		 */
-		if (tcp_hdr->flags & NET_TCP_SYN) {
-			seq_len += 1U;
-		}
-		if (tcp_hdr->flags & NET_TCP_FIN) {
-			seq_len += 1U;
-		}
-
 		/* Last sequence number in this packet. */
-		last_seq = sys_get_be32(tcp_hdr->seq) + seq_len - 1;
+		last_seq = seq + seq_len - 1;
 
 		/* Ack number should be strictly greater to acknowledged numbers
 		 * below it. For example, ack no. 10 acknowledges all numbers up
@@ -1109,7 +2077,7 @@ bool net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 			break;
 		}
 
-		if (tcp_hdr->flags & NET_TCP_FIN) {
+		if (flags & NET_TCP_FIN) {
 			enum net_tcp_state s = net_tcp_get_state(tcp);
 
 			if (s == NET_TCP_FIN_WAIT_1) {
@@ -1134,6 +2102,17 @@ bool net_tcp_ack_received(struct net_context *ctx, u32_t ack)
 		restart_timer(ctx->tcp);
 	}
 
+	if (net_tcp_seq_greater(ack, tcp->send_una)) {
+		tcp_new_ack(tcp, ack);
+
+		/* Data left the send queue */
+		if (ctx->writable_cb && net_tcp_is_writable(ctx)) {
+			ctx->writable_cb(ctx);
+		}
+	}
+
+	tcp_send_queued(tcp);
+
 	return true;
 }
 
@@ -1302,6 +2281,12 @@ int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 		 * followed by length-2 octets of option data."
 		 */
 		if (opt == NET_TCP_END_OPT) {
+			/* Skip the padding so that only the payload remains */
+			if (net_pkt_skip(pkt, opt_totlen)) {
+				optlen = 0U;
+				goto error;
+			}
+
 			break;
 		} else if (opt == NET_TCP_NOP_OPT) {
 			continue;
@@ -1336,6 +2321,59 @@ int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 				goto error;
 			}
 
+			break;
+		case NET_TCP_SACK_PERM_OPT:
+			if (optlen != 0U) {
+				goto error;
+			}
+
+			opts->sack_perm = 1U;
+
+			break;
+		case NET_TCP_WINDOW_SCALE_OPT:
+			if (optlen != 1U) {
+				goto error;
+			}
+
+			if (net_pkt_read_u8(pkt, &opts->wscale)) {
+				goto error;
+			}
+
+			opts->wscale_present = 1U;
+
+			break;
+		case NET_TCP_TIMESTAMP_OPT:
+			if (optlen != 8U) {
+				goto error;
+			}
+
+			if (net_pkt_read_be32(pkt, &opts->tsval) ||
+			    net_pkt_read_be32(pkt, &opts->tsecr)) {
+				goto error;
+			}
+
+			opts->ts_present = 1U;
+
+			break;
+		case NET_TCP_SACK_OPT:
+			if (!optlen || (optlen % NET_TCP_SACK_BLOCK_SIZE) ||
+			    optlen > NET_TCP_MAX_SACK_BLOCKS *
+			    NET_TCP_SACK_BLOCK_SIZE) {
+				goto error;
+			}
+
+			for (opts->sack_count = 0U;
+			     opts->sack_count < optlen / NET_TCP_SACK_BLOCK_SIZE;
+			     opts->sack_count++) {
+				struct net_tcp_sack_block *block =
+					&opts->sack[opts->sack_count];
+
+				if (net_pkt_read_be32(pkt, &block->start) ||
+				    net_pkt_read_be32(pkt, &block->end)) {
+					goto error;
+				}
+			}
+
 			break;
 		default:
 			if (net_pkt_skip(pkt, optlen)) {
@@ -1418,8 +2456,12 @@ int net_tcp_listen(struct net_context *context)
 	return -EOPNOTSUPP;
 }
 
+static int send_ack(struct net_context *context,
+		    struct sockaddr *remote, bool force);
+
 int net_tcp_update_recv_wnd(struct net_context *context, s32_t delta)
 {
+	u16_t mss;
 	s32_t new_win;
 
 	if (!context->tcp) {
@@ -1428,10 +2470,23 @@ int net_tcp_update_recv_wnd(struct net_context *context, s32_t delta)
 	}
 
 	new_win = context->tcp->recv_wnd + delta;
-	if (new_win < 0 || new_win > UINT16_MAX) {
+	if (new_win < 0 || new_win > NET_TCP_MAX_WIN) {
 		return -EINVAL;
 	}
 
+	mss = net_tcp_get_recv_mss(context->tcp);
+
+	/* The sender stops once our advertised window is closed, so let
+	 * it know when the application has made room for a full segment.
+	 */
+	if (delta > 0 && context->tcp->recv_wnd < mss && new_win >= mss &&
+	    net_tcp_get_state(context->tcp) == NET_TCP_ESTABLISHED) {
+		context->tcp->recv_wnd = new_win;
+		(void)send_ack(context, &context->remote, true);
+
+		return 0;
+	}
+
 	context->tcp->recv_wnd = new_win;
 
 	return 0;
@@ -1555,7 +2610,7 @@ static int tcp_backlog_syn(struct net_pkt *pkt,
 			   union net_ip_header *ip_hdr,
 			   struct net_tcp_hdr *tcp_hdr,
 			   struct net_context *context,
-			   u16_t send_mss)
+			   struct net_tcp_options *opts)
 {
 	int empty_slot = -1;
 
@@ -1574,13 +2629,21 @@ static int tcp_backlog_syn(struct net_pkt *pkt,
 
 	tcp_backlog[empty_slot].send_seq = context->tcp->send_seq;
 	tcp_backlog[empty_slot].send_ack = context->tcp->send_ack;
-	tcp_backlog[empty_slot].send_mss = send_mss;
+	tcp_backlog[empty_slot].send_mss = opts->mss;
+
+	/* The options negotiated for the new connection are kept here,
+	 * and not on the listening context, until the final ACK creates
+	 * the connection.
+	 */
+	tcp_backlog[empty_slot].opt_flags = tcp_negotiate_opts(opts);
+	tcp_backlog[empty_slot].send_wscale = opts->wscale;
+	tcp_backlog[empty_slot].ts_recent = opts->tsval;
 
 	k_delayed_work_init(&tcp_backlog[empty_slot].ack_timer,
 			    backlog_ack_timeout);
 	k_delayed_work_submit(&tcp_backlog[empty_slot].ack_timer, ACK_TIMEOUT);
 
-	return 0;
+	return empty_slot;
 }
 
 static int tcp_backlog_ack(struct net_pkt *pkt,
@@ -1605,6 +2668,11 @@ static int tcp_backlog_ack(struct net_pkt *pkt,
 	context->tcp->send_seq = tcp_backlog[r].send_seq + 1;
 	context->tcp->send_ack = tcp_backlog[r].send_ack;
 	context->tcp->send_mss = tcp_backlog[r].send_mss;
+	tcp_set_opts(context->tcp, tcp_backlog[r].opt_flags,
+		     tcp_backlog[r].send_wscale, tcp_backlog[r].ts_recent);
+
+	tcp_init_send_state(context->tcp, (u32_t)sys_get_be16(tcp_hdr->wnd) <<
+				   context->tcp->send_wscale);
 
 	k_delayed_work_cancel(&tcp_backlog[r].ack_timer);
 	(void)memset(&tcp_backlog[r], 0, sizeof(struct tcp_backlog_entry));
@@ -1783,21 +2851,28 @@ static void print_send_info(struct net_pkt *pkt,
 	}
 }
 
-/* Send SYN or SYN/ACK. */
+/* Send SYN or SYN/ACK. A SYN/ACK carries the options negotiated for the
+ * new connection, opt_flags and ts_recent are ignored for a SYN.
+ */
 static inline int send_syn_segment(struct net_context *context,
 				       const struct sockaddr_ptr *local,
 				       const struct sockaddr *remote,
-				       int flags, const char *msg)
+				       int flags, u8_t opt_flags,
+				       u32_t ts_recent, const char *msg)
 {
 	struct net_pkt *pkt = NULL;
 	int ret;
-	u8_t options[NET_TCP_MAX_OPT_SIZE];
+	u8_t options[NET_TCP_SYN_OPT_SIZE];
 	u8_t optionlen = 0U;
 
 	if (flags == NET_TCP_SYN) {
 		net_tcp_set_syn_opt(context->tcp, options, &optionlen);
 	}
 
+	net_tcp_set_wscale_opt(opt_flags, flags, options, &optionlen);
+	net_tcp_set_sack_perm_opt(opt_flags, flags, options, &optionlen);
+	net_tcp_set_ts_opt(opt_flags, ts_recent, flags, options, &optionlen);
+
 	ret = net_tcp_prepare_segment(context->tcp, flags, options, optionlen,
 				      local, remote, &pkt);
 	if (ret) {
@@ -1822,15 +2897,18 @@ static inline int send_syn(struct net_context *context,
 {
 	net_tcp_change_state(context->tcp, NET_TCP_SYN_SENT);
 
-	return send_syn_segment(context, NULL, remote, NET_TCP_SYN, "SYN");
+	return send_syn_segment(context, NULL, remote, NET_TCP_SYN, 0U, 0U,
+				"SYN");
 }
 
 static inline int send_syn_ack(struct net_context *context,
 			       struct sockaddr_ptr *local,
-			       struct sockaddr *remote)
+			       struct sockaddr *remote,
+			       struct tcp_backlog_entry *entry)
 {
 	return send_syn_segment(context, local, remote,
 				    NET_TCP_SYN | NET_TCP_ACK,
+				    entry->opt_flags, entry->ts_recent,
 				    "SYN_ACK");
 }
 
@@ -1898,6 +2976,9 @@ NET_CONN_CB(tcp_established)
 {
 	struct net_context *context = (struct net_context *)user_data;
 	struct net_tcp_hdr *tcp_hdr = proto_hdr->tcp;
+	struct net_tcp_options tcp_opts = {
+		.mss = NET_TCP_DEFAULT_MSS,
+	};
 	enum net_verdict ret = NET_OK;
 	u8_t tcp_flags;
 	u16_t data_len;
@@ -1917,11 +2998,49 @@ NET_CONN_CB(tcp_established)
 
 	tcp_flags = NET_TCP_FLAGS(tcp_hdr);
 
+	/* Skip the options so that only the payload remains */
+	if (net_tcp_parse_opts(pkt, NET_TCP_HDR_LEN(tcp_hdr) -
+			       sizeof(struct net_tcp_hdr), &tcp_opts) < 0) {
+		ret = NET_DROP;
+		goto unlock;
+	}
+
+	data_len = net_pkt_remaining_data(pkt);
+
+	if ((context->tcp->flags & NET_TCP_TS_OK) && tcp_opts.ts_present) {
+		/* Protection against wrapped sequence numbers (PAWS),
+		 * RFC 7323 chapter 5.3
+		 */
+		if (!(tcp_flags & NET_TCP_RST) &&
+		    net_tcp_seq_cmp(tcp_opts.tsval,
+				    context->tcp->ts_recent) < 0) {
+			NET_DBG("[%p] Old timestamp %u, pkt dropped",
+				context->tcp, tcp_opts.tsval);
+			goto resend_ack;
+		}
+
+		if (net_tcp_seq_cmp(sys_get_be32(tcp_hdr->seq),
+				    context->tcp->sent_ack) <= 0) {
+			context->tcp->ts_recent = tcp_opts.tsval;
+		}
+	}
+
 	if (net_tcp_seq_cmp(sys_get_be32(tcp_hdr->seq),
 			    context->tcp->send_ack) < 0) {
 		/* Peer sent us packet we've already seen. Apparently,
 		 * our ack was lost.
 		 */
+#if defined(CONFIG_NET_TCP_SACK)
+		if (data_len) {
+			u32_t seq = sys_get_be32(tcp_hdr->seq);
+
+			context->tcp->dsack.start = seq;
+			context->tcp->dsack.end =
+				net_tcp_seq_greater(seq + data_len,
+						    context->tcp->send_ack) ?
+				context->tcp->send_ack : seq + data_len;
+		}
+#endif
 
 		/* RFC793 specifies that "highest" (i.e. current from our PoV)
 		 * ack # value can/should be sent, so we just force resend.
@@ -1934,12 +3053,21 @@ resend_ack:
 
 	if (net_tcp_seq_cmp(sys_get_be32(tcp_hdr->seq),
 			    context->tcp->send_ack) > 0) {
-		/* Don't try to reorder packets.  If it doesn't
-		 * match the next segment exactly, drop and wait for
-		 * retransmit
+		/* Keep the segment until the missing data arrives, if
+		 * there is room for it. Send a duplicate ACK right away
+		 * so that the peer can do a fast retransmit. The queued
+		 * data is charged to the context right away, so it is not
+		 * dropped once acknowledged.
 		 */
-		ret = NET_DROP;
-		goto unlock;
+		if (net_pkt_quota_charge_rx(pkt, &context->rx_quota) == 0 &&
+		    tcp_ooo_queue(context->tcp, pkt,
+				  sys_get_be32(tcp_hdr->seq), data_len,
+				  tcp_flags)) {
+			send_ack(context, &conn->remote_addr, true);
+			goto unlock;
+		}
+
+		goto resend_ack;
 	}
 
 	/*
@@ -1958,6 +3086,8 @@ resend_ack:
 
 		net_tcp_print_recv_info("RST", pkt, tcp_hdr->src_port);
 
+		tcp_shutdown_send(context);
+
 		if (context->recv_cb) {
 			context->recv_cb(context, NULL, NULL, NULL, -ECONNRESET,
 					 context->tcp->recv_user_data);
@@ -1971,8 +3101,30 @@ resend_ack:
 
 	/* Handle TCP state transition */
 	if (tcp_flags & NET_TCP_ACK) {
-		if (!net_tcp_ack_received(context,
-					  sys_get_be32(tcp_hdr->ack))) {
+		u32_t ack = sys_get_be32(tcp_hdr->ack);
+		u32_t wnd = (u32_t)sys_get_be16(tcp_hdr->wnd) <<
+			    context->tcp->send_wscale;
+
+		tcp_sack_update(context->tcp, &tcp_opts);
+
+		/* Round trip time measurement, RFC 7323 chapter 4 */
+		if ((context->tcp->flags & NET_TCP_TS_OK) &&
+		    tcp_opts.ts_present && tcp_opts.tsecr &&
+		    net_tcp_seq_greater(ack, context->tcp->send_una)) {
+			tcp_rtt_update(context->tcp,
+				       tcp_ts_now() - tcp_opts.tsecr);
+		}
+
+		if (ack == context->tcp->send_una && !data_len &&
+		    !(tcp_flags & (NET_TCP_SYN | NET_TCP_FIN)) &&
+		    wnd == context->tcp->send_wnd &&
+		    context->tcp->send_nxt != context->tcp->send_una) {
+			tcp_dup_ack(context->tcp);
+		}
+
+		context->tcp->send_wnd = wnd;
+
+		if (!net_tcp_ack_received(context, ack)) {
 			ret = NET_DROP;
 			goto unlock;
 		}
@@ -2018,7 +3170,18 @@ resend_ack:
 		context->tcp->fin_rcvd = 1U;
 	}
 
-	data_len = net_pkt_remaining_data(pkt);
+	/* Like for a window overflow, the data is not acknowledged if the
+	 * context has too much received data pending, and the peer will
+	 * send it again.
+	 */
+	if (data_len > 0 &&
+	    net_pkt_quota_charge_rx(pkt, &context->rx_quota) < 0) {
+		NET_DBG("Context %p: receive quota exceeded, pkt dropped",
+			context);
+		ret = NET_DROP;
+		goto unlock;
+	}
+
 	if (data_len > net_tcp_get_recv_wnd(context->tcp)) {
 		/* In case we have zero window, we should still accept
 		 * Zero Window Probes from peer, which per convention
@@ -2051,6 +3214,11 @@ resend_ack:
 
 	/* Increment the ack */
 	context->tcp->send_ack += data_len;
+
+	if (data_len > 0) {
+		tcp_ooo_deliver(context, conn);
+	}
+
 	if (tcp_flags & NET_TCP_FIN) {
 		context->tcp->send_ack += 1U;
 	}
@@ -2138,9 +3306,26 @@ NET_CONN_CB(tcp_synack_received)
 		/* Remove the temporary connection handler and register
 		 * a proper now as we have an established connection.
 		 */
+		struct net_tcp_options tcp_opts = {
+			.mss = NET_TCP_DEFAULT_MSS,
+		};
 		struct sockaddr local_addr;
 		struct sockaddr remote_addr;
 
+		if (net_tcp_parse_opts(pkt, NET_TCP_HDR_LEN(tcp_hdr) -
+				       sizeof(struct net_tcp_hdr),
+				       &tcp_opts) < 0) {
+			return NET_DROP;
+		}
+
+		context->tcp->send_mss = tcp_opts.mss;
+
+		tcp_set_opts(context->tcp, tcp_negotiate_opts(&tcp_opts),
+			     tcp_opts.wscale, tcp_opts.tsval);
+
+		/* The window of a SYN-ACK is not scaled */
+		tcp_init_send_state(context->tcp, sys_get_be16(tcp_hdr->wnd));
+
 		tcp_copy_ip_addr_from_hdr(net_pkt_family(pkt), ip_hdr, tcp_hdr,
 					  &remote_addr, true);
 		tcp_copy_ip_addr_from_hdr(net_pkt_family(pkt), ip_hdr, tcp_hdr,
@@ -2292,7 +3477,7 @@ NET_CONN_CB(tcp_syn_rcvd)
 		/* Get MSS from TCP options here*/
 
 		r = tcp_backlog_syn(pkt, ip_hdr, tcp_hdr,
-				    context, tcp_opts.mss);
+				    context, &tcp_opts);
 		if (r < 0) {
 			if (r == -EADDRINUSE) {
 				NET_DBG("TCP connection already exists");
@@ -2306,7 +3491,9 @@ NET_CONN_CB(tcp_syn_rcvd)
 		get_sockaddr_ptr(ip_hdr, tcp_hdr,
 				 net_context_get_family(context),
 				 &pkt_src_addr);
-		send_syn_ack(context, &pkt_src_addr, &remote_addr);
+		/* Answer only with the options the peer offered */
+		send_syn_ack(context, &pkt_src_addr, &remote_addr,
+			     &tcp_backlog[r]);
 		net_pkt_unref(pkt);
 		return NET_OK;
 	}
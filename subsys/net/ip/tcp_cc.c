@@ -0,0 +1,198 @@
+/** @file
+ * @brief TCP congestion control algorithms
+ *
+ * The generic TCP code in tcp.c handles duplicate ACKs, fast
+ * retransmit / fast recovery and retransmission timeouts. The
+ * algorithms here only decide how the congestion window grows when
+ * new data is acknowledged and how much it is reduced on loss.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <kernel.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "tcp_internal.h"
+
+/* Slow start with appropriate byte counting (RFC 3465, L = 1 SMSS).
+ * Returns true if the connection is in slow start.
+ */
+static bool slow_start(struct net_tcp *tcp, u32_t acked)
+{
+	if (tcp->cwnd >= tcp->ssthresh) {
+		return false;
+	}
+
+	tcp->cwnd += MIN(acked, tcp->send_mss);
+
+	return true;
+}
+
+static u32_t flight_size(struct net_tcp *tcp)
+{
+	return tcp->send_nxt - tcp->send_una;
+}
+
+static void newreno_init(struct net_tcp *tcp)
+{
+	ARG_UNUSED(tcp);
+}
+
+static void newreno_cong_avoid(struct net_tcp *tcp, u32_t acked)
+{
+	u32_t inc;
+
+	if (slow_start(tcp, acked)) {
+		return;
+	}
+
+	/* Congestion avoidance, about one SMSS per round trip time
+	 * (RFC 5681, chapter 3.1).
+	 */
+	inc = (u32_t)tcp->send_mss * tcp->send_mss / tcp->cwnd;
+	tcp->cwnd += MAX(inc, 1U);
+}
+
+static u32_t newreno_ssthresh(struct net_tcp *tcp)
+{
+	/* RFC 5681, equation (4) */
+	return MAX(flight_size(tcp) / 2U, 2U * tcp->send_mss);
+}
+
+const struct net_tcp_cc net_tcp_cc_newreno = {
+	.name = "newreno",
+	.init = newreno_init,
+	.cong_avoid = newreno_cong_avoid,
+	.ssthresh = newreno_ssthresh,
+};
+
+#if defined(CONFIG_NET_TCP_CC_CUBIC)
+/* RFC 8312 constants, C = 0.4 and beta_cubic = 0.7 */
+#define CUBIC_C_NUM    4
+#define CUBIC_C_DEN    10
+#define CUBIC_BETA_NUM 7
+#define CUBIC_BETA_DEN 10
+
+/* Upper bound of |t - K| in ms, keeps the cube within 64 bits */
+#define CUBIC_MAX_OFFSET (1 << 20)
+
+/* Integer cube root, one bit of the result per iteration */
+static u32_t cubic_root(u64_t a)
+{
+	u64_t y = 0U;
+	u64_t b;
+	int s;
+
+	for (s = 63; s >= 0; s -= 3) {
+		y <<= 1;
+		b = 3U * y * (y + 1U) + 1U;
+
+		if ((a >> s) >= b) {
+			a -= b << s;
+			y++;
+		}
+	}
+
+	return (u32_t)y;
+}
+
+static void cubic_init(struct net_tcp *tcp)
+{
+	(void)memset(&tcp->cc_data.cubic, 0, sizeof(tcp->cc_data.cubic));
+}
+
+static void cubic_cong_avoid(struct net_tcp *tcp, u32_t acked)
+{
+	u32_t mss = tcp->send_mss;
+	u32_t now = k_uptime_get_32();
+	s64_t offset, delta;
+	u64_t target;
+
+	if (slow_start(tcp, acked)) {
+		return;
+	}
+
+	if (!tcp->cc_data.cubic.epoch_start) {
+		tcp->cc_data.cubic.epoch_start = now ? now : 1;
+
+		if (tcp->cwnd < tcp->cc_data.cubic.w_max) {
+			/* K = cubic_root((W_max - cwnd) / C), in segments
+			 * and seconds, here converted to ms.
+			 */
+			tcp->cc_data.cubic.k = cubic_root(
+				(u64_t)(tcp->cc_data.cubic.w_max - tcp->cwnd) *
+				NSEC_PER_SEC / mss * CUBIC_C_DEN / CUBIC_C_NUM);
+		} else {
+			tcp->cc_data.cubic.k = 0U;
+			tcp->cc_data.cubic.w_max = tcp->cwnd;
+		}
+
+		tcp->cc_data.cubic.w_est = tcp->cwnd;
+	}
+
+	/* W_cubic(t) = C * (t - K)^3 + W_max */
+	offset = (s64_t)(now - tcp->cc_data.cubic.epoch_start) -
+		 tcp->cc_data.cubic.k;
+	offset = MIN(MAX(offset, -CUBIC_MAX_OFFSET), CUBIC_MAX_OFFSET);
+
+	delta = offset * offset * offset / USEC_PER_SEC * CUBIC_C_NUM * mss /
+		(CUBIC_C_DEN * MSEC_PER_SEC);
+
+	if ((s64_t)tcp->cc_data.cubic.w_max + delta < (s64_t)mss) {
+		target = mss;
+	} else {
+		target = tcp->cc_data.cubic.w_max + delta;
+	}
+
+	/* TCP friendly region: the window Reno would have, growing by
+	 * 3 * (1 - beta) / (1 + beta) SMSS per round trip time.
+	 */
+	tcp->cc_data.cubic.w_est += (u64_t)acked * mss * 9U /
+				    (17U * tcp->cwnd);
+	if (tcp->cc_data.cubic.w_est > target) {
+		target = tcp->cc_data.cubic.w_est;
+	}
+
+	/* Do not grow more than 1.5 times per round trip time */
+	target = MIN(target, (u64_t)tcp->cwnd * 3U / 2U);
+
+	if (target > tcp->cwnd) {
+		tcp->cwnd += MAX((u32_t)((target - tcp->cwnd) * acked /
+					 tcp->cwnd), 1U);
+	}
+}
+
+static u32_t cubic_ssthresh(struct net_tcp *tcp)
+{
+	/* Fast convergence: release bandwidth to new flows if the
+	 * window did not reach the previous maximum.
+	 */
+	if (tcp->cwnd < tcp->cc_data.cubic.w_max) {
+		tcp->cc_data.cubic.w_max = (u64_t)tcp->cwnd *
+			(CUBIC_BETA_DEN + CUBIC_BETA_NUM) /
+			(2U * CUBIC_BETA_DEN);
+	} else {
+		tcp->cc_data.cubic.w_max = tcp->cwnd;
+	}
+
+	tcp->cc_data.cubic.epoch_start = 0U;
+
+	return MAX((u64_t)tcp->cwnd * CUBIC_BETA_NUM / CUBIC_BETA_DEN,
+		   2U * tcp->send_mss);
+}
+
+const struct net_tcp_cc net_tcp_cc_cubic = {
+	.name = "cubic",
+	.init = cubic_init,
+	.cong_avoid = cubic_cong_avoid,
+	.ssthresh = cubic_ssthresh,
+};
+#endif /* CONFIG_NET_TCP_CC_CUBIC */
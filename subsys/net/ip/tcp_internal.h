@@ -29,7 +29,11 @@ extern "C" {
 /** Is this TCP context/socket used or not */
 #define NET_TCP_IN_USE BIT(0)
 
-/* BIT(1), BIT(2) are unused and available */
+/** Peer has sent SACK permitted option */
+#define NET_TCP_SACK_OK BIT(1)
+
+/** Loss recovery (fast recovery or after RTO) is in progress */
+#define NET_TCP_IN_RECOVERY BIT(2)
 
 /** Is the socket shutdown for read/write */
 #define NET_TCP_IS_SHUTDOWN BIT(3)
@@ -40,6 +44,12 @@ extern "C" {
 /** MSS option has been set already */
 #define NET_TCP_RECV_MSS_SET BIT(5)
 
+/** Timestamps option is used on this connection */
+#define NET_TCP_TS_OK BIT(6)
+
+/** Window scale option is used on this connection */
+#define NET_TCP_WSCALE_OK BIT(7)
+
 /*
  * TCP connection states
  */
@@ -77,38 +87,157 @@ enum net_tcp_state {
  */
 #define NET_TCP_DEFAULT_MSS   536
 
+/* RFC 7323 chapter 2.3, max window scale shift count */
+#define NET_TCP_MAX_WSCALE 14
+
 /* TCP max window size */
-#define NET_TCP_MAX_WIN   (4 * 1024)
+#if defined(CONFIG_NET_TCP_WINDOW_SCALE)
+#define NET_TCP_MAX_WIN   ((u32_t)UINT16_MAX << NET_TCP_MAX_WSCALE)
+#else
+#define NET_TCP_MAX_WIN   UINT16_MAX
+#endif
 
 /* Maximal value of the sequence number */
 #define NET_TCP_MAX_SEQ   0xffffffff
 
+/* Option space reserved in data segments */
+#if defined(CONFIG_NET_TCP_TIMESTAMPS)
+#define NET_TCP_MAX_OPT_SIZE  NET_TCP_TIMESTAMP_OPT_SIZE
+#else
 #define NET_TCP_MAX_OPT_SIZE  8
+#endif
+
+/* Max size of the options sent in a SYN segment: MSS, window scale,
+ * SACK permitted and timestamps, with NOPs for alignment.
+ */
+#define NET_TCP_SYN_OPT_SIZE  24
+
+/* Max size of the TCP options field */
+#define NET_TCP_MAX_OPT_SPACE 40
 
 /* TCP Option codes */
 #define NET_TCP_END_OPT          0
 #define NET_TCP_NOP_OPT          1
 #define NET_TCP_MSS_OPT          2
 #define NET_TCP_WINDOW_SCALE_OPT 3
+#define NET_TCP_SACK_PERM_OPT    4
+#define NET_TCP_SACK_OPT         5
+#define NET_TCP_TIMESTAMP_OPT    8
 
 /* TCP Option sizes */
 #define NET_TCP_END_SIZE          1
 #define NET_TCP_NOP_SIZE          1
 #define NET_TCP_MSS_SIZE          4
 #define NET_TCP_WINDOW_SCALE_SIZE 3
+#define NET_TCP_SACK_PERM_SIZE    2
+#define NET_TCP_SACK_BLOCK_SIZE   8
+#define NET_TCP_TIMESTAMP_SIZE    10
+
+/* Timestamps option as sent by us, with the two NOPs for alignment */
+#define NET_TCP_TIMESTAMP_OPT_SIZE (2 * NET_TCP_NOP_SIZE + \
+				    NET_TCP_TIMESTAMP_SIZE)
+
+/* Max number of SACK blocks that fit into the option space */
+#define NET_TCP_MAX_SACK_BLOCKS   4
+
+/* Max size of a SACK option, including the two NOPs for alignment */
+#define NET_TCP_SACK_OPT_MAX_SIZE (2 * NET_TCP_NOP_SIZE + 2 + \
+				   NET_TCP_MAX_SACK_BLOCKS * \
+				   NET_TCP_SACK_BLOCK_SIZE)
+
+/* Number of SACKed ranges remembered by the sender */
+#define NET_TCP_SACK_SCOREBOARD   4
+
+/* Number of duplicate ACKs that trigger fast retransmit (RFC 5681) */
+#define NET_TCP_DUP_ACK_THRESHOLD 3
+
+/** Range of sequence numbers [start, end) reported in a SACK option */
+struct net_tcp_sack_block {
+	u32_t start;
+	u32_t end;
+};
 
 /** Parsed TCP option values for net_tcp_parse_opts()  */
 struct net_tcp_options {
 	u16_t mss;
+	/** SACK permitted option was present */
+	u8_t sack_perm;
+	/** Number of valid entries in sack */
+	u8_t sack_count;
+	/** Window scale option was present */
+	u8_t wscale_present;
+	/** Window scale shift count sent by the peer */
+	u8_t wscale;
+	/** Timestamps option was present */
+	u8_t ts_present;
+	/** Timestamp value of the peer */
+	u32_t tsval;
+	/** Timestamp echo reply */
+	u32_t tsecr;
+	struct net_tcp_sack_block sack[NET_TCP_MAX_SACK_BLOCKS];
 };
 
 /* Max received bytes to buffer internally */
-#define NET_TCP_BUF_MAX_LEN 1280
+#define NET_TCP_BUF_MAX_LEN CONFIG_NET_TCP_RECV_WINDOW_SIZE
+
+/* Upper bound of the retransmission timeout, RFC 6298 chapter 2.5 */
+#define NET_TCP_MAX_RTO K_SECONDS(60)
+
+#if CONFIG_NET_TCP_OOO_QUEUE_SIZE > 0
+/** Segment received out of order, waiting for the missing data */
+struct net_tcp_ooo_seg {
+	struct net_pkt *pkt;
+	/** Sequence number of the first data byte */
+	u32_t start;
+	/** Sequence number following the last data byte */
+	u32_t end;
+};
+#endif
 
 /* Max segment lifetime, in seconds */
 #define NET_TCP_MAX_SEG_LIFETIME 60
 
 struct net_context;
+struct net_tcp;
+
+/**
+ * Congestion control algorithm. The generic code takes care of
+ * duplicate ACK counting, fast retransmit and fast recovery (RFC 6582)
+ * and retransmission timeouts, and asks the algorithm how to grow and
+ * shrink the congestion window.
+ */
+struct net_tcp_cc {
+	/** Algorithm name */
+	const char *name;
+
+	/** Reset the algorithm state when the connection is established */
+	void (*init)(struct net_tcp *tcp);
+
+	/** New data was acknowledged outside of loss recovery; grow
+	 * tcp->cwnd by the slow start or congestion avoidance rule.
+	 */
+	void (*cong_avoid)(struct net_tcp *tcp, u32_t acked);
+
+	/** A loss was detected, return the new slow start threshold */
+	u32_t (*ssthresh)(struct net_tcp *tcp);
+};
+
+/** Per connection state of the congestion control algorithms */
+union net_tcp_cc_data {
+#if defined(CONFIG_NET_TCP_CC_CUBIC)
+	struct {
+		/** Window before the last reduction, in bytes */
+		u32_t w_max;
+		/** Estimate of the window NewReno would have, in bytes */
+		u32_t w_est;
+		/** Start of the current congestion avoidance epoch, in ms */
+		u32_t epoch_start;
+		/** Time to get back to w_max, in ms */
+		u32_t k;
+	} cubic;
+#endif
+	u32_t unused;
+};
 
 struct net_tcp {
 	/** Network context back pointer. */
@@ -141,6 +270,66 @@ struct net_tcp {
 	/** Last ACK value sent */
 	u32_t sent_ack;
 
+	/** Oldest unacknowledged sequence number */
+	u32_t send_una;
+
+	/** Next sequence number of new data to be transmitted */
+	u32_t send_nxt;
+
+	/** Highest sequence number sent when loss recovery started */
+	u32_t recover;
+
+	/** Send window advertised by the peer */
+	u32_t send_wnd;
+
+	/** Congestion window, in bytes */
+	u32_t cwnd;
+
+	/** Slow start threshold, in bytes */
+	u32_t ssthresh;
+
+	/** Congestion control algorithm */
+	const struct net_tcp_cc *cc;
+
+	/** Congestion control algorithm private state */
+	union net_tcp_cc_data cc_data;
+
+	/** Highest sequence number retransmitted during loss recovery */
+	u32_t rexmit_nxt;
+
+	/** Timestamp to echo to the peer (TS.Recent in RFC 7323) */
+	u32_t ts_recent;
+
+	/** Smoothed round trip time, in ms */
+	u32_t srtt;
+
+	/** Round trip time variation, in ms */
+	u32_t rttvar;
+
+	/** Retransmission timeout, in ms */
+	u32_t rto;
+
+#if CONFIG_NET_TCP_OOO_QUEUE_SIZE > 0
+	/** Segments received out of order, sorted by sequence number.
+	 * Adjacent segments are merged into one entry.
+	 */
+	struct net_tcp_ooo_seg ooo[CONFIG_NET_TCP_OOO_QUEUE_SIZE];
+
+	/** Number of valid entries in ooo */
+	u8_t ooo_count;
+
+	/** Entry that received the latest out of order segment */
+	u8_t ooo_last;
+#endif
+
+#if defined(CONFIG_NET_TCP_SACK)
+	/** Ranges above send_una that the peer has SACKed */
+	struct net_tcp_sack_block sacked[NET_TCP_SACK_SCOREBOARD];
+
+	/** Duplicate segment to report in the next ACK (D-SACK) */
+	struct net_tcp_sack_block dsack;
+#endif
+
 	/** Accept callback to be called when the connection has been
 	 * established.
 	 */
@@ -154,7 +343,7 @@ struct net_tcp {
 	/**
 	 * Current TCP receive window for our side
 	 */
-	u16_t recv_wnd;
+	u32_t recv_wnd;
 
 	/**
 	 * Send MSS for the peer
@@ -171,10 +360,26 @@ struct net_tcp {
 	u32_t fin_sent : 1;
 	/* An inbound FIN packet has been received */
 	u32_t fin_rcvd : 1;
+	/** Number of duplicate ACKs received in a row */
+	u32_t dup_acks : 4;
+	/** Window scale shift count of the peer */
+	u32_t send_wscale : 4;
+	/** Window scale shift count of our side */
+	u32_t recv_wscale : 4;
 	/** Remaining bits in this u32_t */
-	u32_t _padding : 13;
+	u32_t _padding : 1;
 };
 
+extern const struct net_tcp_cc net_tcp_cc_newreno;
+extern const struct net_tcp_cc net_tcp_cc_cubic;
+
+/** Congestion control algorithm given to new connections */
+#if defined(CONFIG_NET_TCP_CC_CUBIC)
+#define NET_TCP_CC_DEFAULT (&net_tcp_cc_cubic)
+#else
+#define NET_TCP_CC_DEFAULT (&net_tcp_cc_newreno)
+#endif
+
 typedef void (*net_tcp_cb_t)(struct net_tcp *tcp, void *user_data);
 
 static inline bool net_tcp_is_used(struct net_tcp *tcp)
@@ -419,7 +624,7 @@ static inline int net_tcp_send_data(struct net_context *context,
  * @param context TCP context
  * @param pkt Packet
  *
- * @return 0 if ok, < 0 if error
+ * @return 0 if ok, -EAGAIN if the send queue is full, < 0 if other error
  */
 #if defined(CONFIG_NET_TCP)
 int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt);
@@ -433,6 +638,24 @@ static inline int net_tcp_queue_data(struct net_context *context,
 }
 #endif
 
+/**
+ * @brief Check if more data can be queued for transmission
+ *
+ * @param context TCP context
+ *
+ * @return False if CONFIG_NET_TCP_SEND_QUEUE_SIZE bytes or more wait to
+ * be acknowledged by the peer, true otherwise.
+ */
+#if defined(CONFIG_NET_TCP)
+bool net_tcp_is_writable(struct net_context *context);
+#else
+static inline bool net_tcp_is_writable(struct net_context *context)
+{
+	ARG_UNUSED(context);
+	return true;
+}
+#endif
+
 /**
  * @brief Sends one TCP packet initialized with the _prepare_*()
  *        family of functions.
@@ -559,8 +782,8 @@ static inline int net_tcp_finalize(struct net_pkt *pkt)
 /**
  * @brief Parse TCP options from network packet.
  *
- * Parse TCP options, returning MSS value (as that the only one we
- * handle so far).
+ * Parse TCP options, returning MSS value, window scale, SACK permitted,
+ * SACK blocks and timestamps options.
  *
  * @param pkt Network packet
  * @param opt_totlen Total length of options to parse
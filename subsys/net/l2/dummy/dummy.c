@@ -11,6 +11,7 @@ LOG_MODULE_REGISTER(net_l2_dummy, LOG_LEVEL_NONE);
 #include <net/net_l2.h>
 #include <net/net_if.h>
 #include <net/net_pkt.h>
+#include <net/capture.h>
 
 #include <net/dummy.h>
 
@@ -27,22 +28,55 @@ static inline enum net_verdict dummy_recv(struct net_if *iface,
 	return NET_CONTINUE;
 }
 
+static inline int dummy_sent(struct net_if *iface, struct net_pkt *pkt,
+			     int ret)
+{
+	if (!ret) {
+		net_capture_pkt(iface, pkt, NET_CAPTURE_TX);
+
+		ret = net_pkt_get_len(pkt);
+		net_pkt_unref(pkt);
+	}
+
+	return ret;
+}
+
 static inline int dummy_send(struct net_if *iface, struct net_pkt *pkt)
 {
 	const struct dummy_api *api = net_if_get_device(iface)->driver_api;
-	int ret;
 
 	if (!api) {
 		return -ENOENT;
 	}
 
-	ret = api->send(net_if_get_device(iface), pkt);
-	if (!ret) {
-		ret = net_pkt_get_len(pkt);
-		net_pkt_unref(pkt);
+	return dummy_sent(iface, pkt,
+			  api->send(net_if_get_device(iface), pkt));
+}
+
+static void dummy_send_burst(struct net_if *iface, struct net_pkt **pkts,
+			     int *status, int count)
+{
+	struct device *dev = net_if_get_device(iface);
+	const struct dummy_api *api = dev->driver_api;
+	int i, ret, sent = 0;
+
+	if (!api) {
+		for (i = 0; i < count; i++) {
+			status[i] = -ENOENT;
+		}
+
+		return;
 	}
 
-	return ret;
+	if (api->send_burst) {
+		sent = api->send_burst(dev, pkts, count);
+	}
+
+	for (i = 0; i < count; i++) {
+		ret = i < sent ? 0 : api->send(dev, pkts[i]);
+
+		status[i] = dummy_sent(iface, pkts[i], ret);
+	}
 }
 
 static enum net_l2_flags dummy_flags(struct net_if *iface)
@@ -50,4 +84,5 @@ static enum net_l2_flags dummy_flags(struct net_if *iface)
 	return NET_L2_MULTICAST;
 }
 
-NET_L2_INIT(DUMMY_L2, dummy_recv, dummy_send, NULL, dummy_flags);
+NET_L2_BURST_INIT(DUMMY_L2, dummy_recv, dummy_send, dummy_send_burst, NULL,
+		  dummy_flags);
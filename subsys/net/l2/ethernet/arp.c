@@ -19,6 +19,7 @@ LOG_MODULE_REGISTER(net_arp, CONFIG_NET_ARP_LOG_LEVEL);
 
 #include "arp.h"
 #include "net_private.h"
+#include "route.h"
 
 #define NET_BUF_TIMEOUT K_MSEC(100)
 #define ARP_REQUEST_TIMEOUT K_SECONDS(2)
@@ -28,7 +29,9 @@ static struct arp_entry arp_entries[CONFIG_NET_ARP_TABLE_SIZE];
 
 static sys_slist_t arp_free_entries;
 static sys_slist_t arp_pending_entries;
-static sys_slist_t arp_table;
+
+/* Resolved entries, indexed by IPv4 address */
+NET_NBR_HASH_DEFINE(arp_table, CONFIG_NET_ARP_TABLE_SIZE);
 
 struct k_delayed_work arp_request_timer;
 
@@ -74,30 +77,51 @@ static struct arp_entry *arp_entry_find(sys_slist_t *list,
 	return NULL;
 }
 
+static struct arp_entry *arp_entry_lookup(struct net_if *iface,
+					  struct in_addr *dst)
+{
+	u32_t hash = net_hash_fnv1a(NET_HASH_FNV1A_INIT, dst,
+				    sizeof(struct in_addr));
+	struct net_nbr_hash_node *node;
+	struct arp_entry *entry;
+
+	NET_NBR_HASH_FOR_EACH(&arp_table, hash, node) {
+		entry = CONTAINER_OF(node, struct arp_entry, hash);
+
+		if (entry->iface == iface &&
+		    net_ipv4_addr_cmp(&entry->ip, dst)) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
 static inline struct arp_entry *arp_entry_find_move_first(struct net_if *iface,
 							  struct in_addr *dst)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(dst)));
 
-	entry = arp_entry_find(&arp_table, iface, dst, &prev);
+	entry = arp_entry_lookup(iface, dst);
 	if (entry) {
-		/* Let's assume the target is going to be accessed
-		 * more than once here in a short time frame. So we
-		 * place the entry first in position into the table
-		 * in order to reduce subsequent find.
+		/* The least recently used entry is the one replaced
+		 * when the table is full.
 		 */
-		if (&entry->node != sys_slist_peek_head(&arp_table)) {
-			sys_slist_remove(&arp_table, prev, &entry->node);
-			sys_slist_prepend(&arp_table, &entry->node);
-		}
+		net_nbr_hash_touch(&arp_table, &entry->hash);
 	}
 
 	return entry;
 }
 
+static void arp_entry_add(struct arp_entry *entry)
+{
+	net_nbr_hash_add(&arp_table, &entry->hash,
+			 net_hash_fnv1a(NET_HASH_FNV1A_INIT, &entry->ip,
+					sizeof(struct in_addr)));
+}
+
 static inline
 struct arp_entry *arp_entry_find_pending(struct net_if *iface,
 					 struct in_addr *dst)
@@ -145,23 +169,21 @@ static struct arp_entry *arp_entry_get_free(void)
 
 static struct arp_entry *arp_entry_get_last_from_table(void)
 {
-	sys_snode_t *node;
+	struct net_nbr_hash_node *node;
 
-	/* We assume last entry is the oldest one,
-	 * so is the preferred one to be taken out.
+	/* The least recently used entry is the preferred one to be
+	 * taken out.
 	 */
-
-	node = sys_slist_peek_tail(&arp_table);
+	node = net_nbr_hash_oldest(&arp_table);
 	if (!node) {
 		return NULL;
 	}
 
-	sys_slist_find_and_remove(&arp_table, node);
+	net_nbr_hash_remove(&arp_table, node);
 
-	return CONTAINER_OF(node, struct arp_entry, node);
+	return CONTAINER_OF(node, struct arp_entry, hash);
 }
 
-
 static void arp_entry_register_pending(struct arp_entry *entry)
 {
 	NET_DBG("dst %s", log_strdup(net_sprint_ipv4_addr(&entry->ip)));
@@ -318,6 +340,7 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 				struct in_addr *current_ip)
 {
 	struct arp_entry *entry;
+	struct in_addr nexthop;
 	struct in_addr *addr;
 
 	if (!pkt || !pkt->buffer) {
@@ -325,13 +348,21 @@ struct net_pkt *net_arp_prepare(struct net_pkt *pkt,
 	}
 
 	/* Is the destination in the local network, if not route via
-	 * the gateway address.
+	 * the gateway of the longest matching route, or else via the
+	 * gateway address of the interface.
 	 */
 	if (!current_ip &&
 	    !net_if_ipv4_addr_mask_cmp(net_pkt_iface(pkt), request_ip)) {
 		struct net_if_ipv4 *ipv4 = net_pkt_iface(pkt)->config.ip.ipv4;
 
-		if (ipv4) {
+		if (net_route_ipv4_get_nexthop(net_pkt_iface(pkt),
+					       request_ip, &nexthop)) {
+			addr = &nexthop;
+
+			NET_DBG("Routing %s via %s",
+				log_strdup(net_sprint_ipv4_addr(request_ip)),
+				log_strdup(net_sprint_ipv4_addr(addr)));
+		} else if (ipv4) {
 			addr = &ipv4->gw;
 			if (net_ipv4_is_addr_unspecified(addr)) {
 				NET_ERR("Gateway not set for iface %p",
@@ -399,10 +430,9 @@ static void arp_gratuitous(struct net_if *iface,
 			   struct in_addr *src,
 			   struct net_eth_addr *hwaddr)
 {
-	sys_snode_t *prev = NULL;
 	struct arp_entry *entry;
 
-	entry = arp_entry_find(&arp_table, iface, src, &prev);
+	entry = arp_entry_lookup(iface, src);
 	if (entry) {
 		NET_DBG("Gratuitous ARP hwaddr %s -> %s",
 			log_strdup(net_sprint_ll_addr(
@@ -434,10 +464,9 @@ static void arp_update(struct net_if *iface,
 		}
 
 		if (force) {
-			sys_snode_t *prev = NULL;
 			struct arp_entry *entry;
 
-			entry = arp_entry_find(&arp_table, iface, src, &prev);
+			entry = arp_entry_lookup(iface, src);
 			if (entry) {
 				memcpy(&entry->eth, hwaddr,
 				       sizeof(struct net_eth_addr));
@@ -456,7 +485,7 @@ static void arp_update(struct net_if *iface,
 					entry->iface = iface;
 					net_ipaddr_copy(&entry->ip, src);
 					memcpy(&entry->eth, hwaddr, sizeof(entry->eth));
-					sys_slist_prepend(&arp_table, &entry->node);
+					arp_entry_add(entry);
 				}
 			}
 		}
@@ -479,7 +508,7 @@ static void arp_update(struct net_if *iface,
 	memcpy(&entry->eth, hwaddr, sizeof(struct net_eth_addr));
 
 	/* Inserting entry into the table */
-	sys_slist_prepend(&arp_table, &entry->node);
+	arp_entry_add(entry);
 
 	net_if_queue_tx(iface, pkt);
 }
@@ -674,20 +703,19 @@ void net_arp_clear_cache(struct net_if *iface)
 
 	NET_DBG("Flushing ARP table");
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_table, entry, next, node) {
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&arp_table.lru, entry, next,
+					  hash.lru_node) {
 		if (iface && iface != entry->iface) {
-			prev = &entry->node;
 			continue;
 		}
 
+		net_nbr_hash_remove(&arp_table, &entry->hash);
+
 		arp_entry_cleanup(entry, false);
 
-		sys_slist_remove(&arp_table, prev, &entry->node);
 		sys_slist_prepend(&arp_free_entries, &entry->node);
 	}
 
-	prev = NULL;
-
 	NET_DBG("Flushing ARP pending requests");
 
 	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&arp_pending_entries,
@@ -713,7 +741,7 @@ int net_arp_foreach(net_arp_cb_t cb, void *user_data)
 	int ret = 0;
 	struct arp_entry *entry;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&arp_table, entry, node) {
+	SYS_DLIST_FOR_EACH_CONTAINER(&arp_table.lru, entry, hash.lru_node) {
 		ret++;
 		cb(entry, user_data);
 	}
@@ -731,7 +759,7 @@ void net_arp_init(void)
 
 	sys_slist_init(&arp_free_entries);
 	sys_slist_init(&arp_pending_entries);
-	sys_slist_init(&arp_table);
+	net_nbr_hash_init(&arp_table);
 
 	for (i = 0; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
 		/* Inserting entry as free */
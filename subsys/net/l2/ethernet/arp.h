@@ -16,6 +16,8 @@ extern "C" {
 #include <misc/slist.h>
 #include <net/ethernet.h>
 
+#include "nbr_hash.h"
+
 /**
  * @brief Address resolution (ARP) library
  * @defgroup arp ARP Library
@@ -51,6 +53,7 @@ enum net_verdict net_arp_input(struct net_pkt *pkt,
 
 struct arp_entry {
 	sys_snode_t node;
+	struct net_nbr_hash_node hash;
 	u32_t req_start;
 	struct net_if *iface;
 	struct in_addr ip;
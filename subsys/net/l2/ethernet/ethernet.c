@@ -13,6 +13,7 @@ LOG_MODULE_REGISTER(net_ethernet, CONFIG_NET_L2_ETHERNET_LOG_LEVEL);
 #include <net/net_mgmt.h>
 #include <net/ethernet.h>
 #include <net/ethernet_mgmt.h>
+#include <net/capture.h>
 #include <net/gptp.h>
 
 #if defined(CONFIG_NET_LLDP)
@@ -545,17 +546,15 @@ static void ethernet_remove_l2_header(struct net_pkt *pkt)
 	net_pkt_frag_unref(buf);
 }
 
-static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
+/* Prepare a packet for the driver. The packet to send is returned, which
+ * is an ARP request if the packet has to wait for the address resolution,
+ * or NULL with the error in ret.
+ */
+static struct net_pkt *ethernet_prepare_send(struct net_if *iface,
+					     struct net_pkt *pkt, int *ret)
 {
-	const struct ethernet_api *api = net_if_get_device(iface)->driver_api;
 	struct ethernet_context *ctx = net_if_l2_data(iface);
 	u16_t ptype;
-	int ret;
-
-	if (!api) {
-		ret = -ENOENT;
-		goto error;
-	}
 
 	if (IS_ENABLED(CONFIG_NET_IPV4) &&
 	    net_pkt_family(pkt) == AF_INET) {
@@ -566,8 +565,8 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 		} else {
 			tmp = ethernet_ll_prepare_on_ipv4(iface, pkt);
 			if (!tmp) {
-				ret = -ENOMEM;
-				goto error;
+				*ret = -ENOMEM;
+				return NULL;
 			} else if (IS_ENABLED(CONFIG_NET_ARP) && tmp != pkt) {
 				/* Original pkt got queued and is replaced
 				 * by an ARP request packet.
@@ -584,7 +583,7 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 		ptype = htons(NET_ETH_PTYPE_IPV6);
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
 		   net_pkt_family(pkt) == AF_PACKET) {
-		goto send;
+		return pkt;
 	} else if (IS_ENABLED(CONFIG_NET_GPTP) && net_pkt_is_gptp(pkt)) {
 		ptype = htons(NET_ETH_PTYPE_PTP);
 	} else if (IS_ENABLED(CONFIG_NET_LLDP) && net_pkt_is_lldp(pkt)) {
@@ -595,8 +594,8 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 		ptype = htons(NET_ETH_PTYPE_ARP);
 		net_pkt_set_family(pkt, AF_INET);
 	} else {
-		ret = -ENOTSUP;
-		goto error;
+		*ret = -ENOTSUP;
+		return NULL;
 	}
 
 	/* If the ll dst addr has not been set before, let's assume
@@ -611,8 +610,8 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 	if (IS_ENABLED(CONFIG_NET_VLAN) &&
 	    net_eth_is_vlan_enabled(ctx, iface)) {
 		if (set_vlan_tag(ctx, iface, pkt) == NET_DROP) {
-			ret = -EINVAL;
-			goto error;
+			*ret = -EINVAL;
+			return NULL;
 		}
 
 		set_vlan_priority(ctx, pkt);
@@ -621,30 +620,95 @@ static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
 	/* Then set the ethernet header.
 	 */
 	if (!ethernet_fill_header(ctx, pkt, ptype)) {
-		ret = -ENOMEM;
-		goto error;
+		*ret = -ENOMEM;
+		return NULL;
 	}
 
 	net_pkt_cursor_init(pkt);
 
-send:
-	ret = api->send(net_if_get_device(iface), pkt);
+	return pkt;
+}
+
+/* Finish the sending of a packet, ret being the result from the driver */
+static int ethernet_sent(struct net_if *iface, struct net_pkt *pkt, int ret)
+{
 	if (ret != 0) {
 		eth_stats_update_errors_tx(iface);
 		ethernet_remove_l2_header(pkt);
-		goto error;
+		return ret;
 	}
 #if defined(CONFIG_NET_STATISTICS_ETHERNET)
 	ethernet_update_tx_stats(iface, pkt);
 #endif
+	net_capture_pkt(iface, pkt, NET_CAPTURE_TX);
+
 	ret = net_pkt_get_len(pkt);
 	ethernet_remove_l2_header(pkt);
 
 	net_pkt_unref(pkt);
-error:
+
 	return ret;
 }
 
+static int ethernet_send(struct net_if *iface, struct net_pkt *pkt)
+{
+	const struct ethernet_api *api = net_if_get_device(iface)->driver_api;
+	int ret;
+
+	if (!api) {
+		return -ENOENT;
+	}
+
+	pkt = ethernet_prepare_send(iface, pkt, &ret);
+	if (!pkt) {
+		return ret;
+	}
+
+	ret = api->send(net_if_get_device(iface), pkt);
+
+	return ethernet_sent(iface, pkt, ret);
+}
+
+static void ethernet_send_burst(struct net_if *iface, struct net_pkt **pkts,
+				int *status, int count)
+{
+	struct device *dev = net_if_get_device(iface);
+	const struct ethernet_api *api = dev->driver_api;
+	struct net_pkt *send[NET_TX_BURST_SIZE];
+	int idx[NET_TX_BURST_SIZE];
+	int i, ret, sent, n = 0;
+
+	if (!api || !api->send_burst) {
+		for (i = 0; i < count; i++) {
+			status[i] = ethernet_send(iface, pkts[i]);
+		}
+
+		return;
+	}
+
+	for (i = 0; i < count; i++) {
+		send[n] = ethernet_prepare_send(iface, pkts[i], &status[i]);
+		if (send[n]) {
+			idx[n++] = i;
+		}
+	}
+
+	if (!n) {
+		return;
+	}
+
+	/* The packets following the ones the driver could send are given
+	 * to it one by one, so that each gets its own error.
+	 */
+	sent = api->send_burst(dev, send, n);
+
+	for (i = 0; i < n; i++) {
+		ret = i < sent ? 0 : api->send(dev, send[i]);
+
+		status[idx[i]] = ethernet_sent(iface, send[i], ret);
+	}
+}
+
 static inline int ethernet_enable(struct net_if *iface, bool state)
 {
 	const struct ethernet_api *eth =
@@ -913,8 +977,8 @@ int net_eth_vlan_disable(struct net_if *iface, u16_t tag)
 }
 #endif
 
-NET_L2_INIT(ETHERNET_L2, ethernet_recv, ethernet_send, ethernet_enable,
-	    ethernet_flags);
+NET_L2_BURST_INIT(ETHERNET_L2, ethernet_recv, ethernet_send,
+		  ethernet_send_burst, ethernet_enable, ethernet_flags);
 
 static void carrier_on(struct k_work *work)
 {
@@ -686,8 +686,6 @@ static void gptp_update_local_port_clock(void)
 	s64_t nanosecond_diff;
 	s64_t second_diff;
 	struct device *clk;
-	struct net_ptp_time tm;
-	int key;
 
 	state = &GPTP_STATE()->clk_slave_sync;
 	global_ds = GPTP_GLOBAL_DS();
@@ -714,6 +712,12 @@ static void gptp_update_local_port_clock(void)
 		return;
 	}
 
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+	/* The servo measures the frequency offset itself */
+	gptp_servo_sample(clk, -(second_diff * NSEC_PER_SEC + nanosecond_diff),
+			  global_ds->sync_receipt_local_time,
+			  (u32_t)port_ds->neighbor_prop_delay);
+#else
 	if (second_diff > 0 && nanosecond_diff < 0) {
 		second_diff--;
 		nanosecond_diff = NSEC_PER_SEC + nanosecond_diff;
@@ -732,7 +736,9 @@ static void gptp_update_local_port_clock(void)
 	if (second_diff || (second_diff == 0 &&
 			    (nanosecond_diff < -5000 ||
 			     nanosecond_diff > 5000))) {
+		struct net_ptp_time tm;
 		bool underflow = false;
+		int key;
 
 		key = irq_lock();
 		ptp_clock_get(clk, &tm);
@@ -765,6 +771,7 @@ static void gptp_update_local_port_clock(void)
 
 		ptp_clock_adjust(clk, nanosecond_diff);
 	}
+#endif /* CONFIG_NET_GPTP_SERVO_PI */
 }
 #endif /* CONFIG_NET_GPTP_USE_DEFAULT_CLOCK_UPDATE */
 
@@ -1768,6 +1775,15 @@ static void gptp_updt_roles_tree(void)
 		update_bmca(port, best_port, global_ds, default_ds, gm_prio);
 	}
 
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+	/* A new grandmaster has its own time and frequency */
+	if (memcmp(last_gm_prio->root_system_id.grand_master_id,
+		   gm_prio->root_system_id.grand_master_id,
+		   GPTP_CLOCK_ID_LEN)) {
+		gptp_servo_reset();
+	}
+#endif
+
 	/* Update gmPresent. */
 	global_ds->gm_present =
 		(gm_prio->root_system_id.grand_master_prio1 == 255U) ?
@@ -133,6 +133,27 @@ void gptp_change_port_state_debug(int port, enum gptp_port_state state,
 				  const char *caller, int line);
 #endif
 
+#if defined(CONFIG_NET_GPTP_SERVO_PI)
+/**
+ * @brief Update the local clock from a Sync message.
+ *
+ * @param clk PTP clock of the slave port.
+ * @param offset Offset of the local clock from the grandmaster time, in
+ *        nanoseconds.
+ * @param local_time Local time the Sync message was received at, in
+ *        nanoseconds.
+ * @param path_delay Mean propagation delay of the link, in nanoseconds.
+ */
+void gptp_servo_sample(struct device *clk, s64_t offset, u64_t local_time,
+		       u32_t path_delay);
+
+/**
+ * @brief Reset the servo, the next Sync messages measuring the frequency
+ * offset from the grandmaster again.
+ */
+void gptp_servo_reset(void);
+#endif /* CONFIG_NET_GPTP_SERVO_PI */
+
 #ifdef __cplusplus
 }
 #endif
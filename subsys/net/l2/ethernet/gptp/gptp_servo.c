@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2019 Intel Corporation.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_gptp, CONFIG_NET_GPTP_LOG_LEVEL);
+
+#include <kernel.h>
+#include <spinlock.h>
+#include <limits.h>
+#include <ptp_clock.h>
+#include <net/gptp.h>
+
+#include "gptp_messages.h"
+#include "gptp_data_set.h"
+#include "gptp_state.h"
+#include "gptp_private.h"
+
+#define KP (CONFIG_NET_GPTP_SERVO_KP / 1000.0)
+#define KI (CONFIG_NET_GPTP_SERVO_KI / 1000.0)
+#define STEP_THRESHOLD CONFIG_NET_GPTP_SERVO_STEP_THRESHOLD
+
+/* Bound of the frequency adjustment, in parts per billion */
+#define MAX_PPB 500000.0
+
+struct gptp_servo {
+	/* Protects the statistics read by gptp_servo_get_stats() */
+	struct k_spinlock lock;
+	struct gptp_servo_stats stats;
+
+	/* First sample, measuring the frequency offset */
+	s64_t offset0;
+	u64_t local_time0;
+
+	/* Local time of the last sample */
+	u64_t last_local_time;
+
+	/* Frequency adjustment applied to the clock, and its integral part,
+	 * in parts per billion.
+	 */
+	double freq;
+	double drift;
+
+	/* Offsets of the current statistics window */
+	u64_t sum_sq;
+	u32_t max;
+	int count;
+};
+
+static struct gptp_servo servo;
+
+static double clamp_ppb(double ppb)
+{
+	if (ppb > MAX_PPB) {
+		return MAX_PPB;
+	}
+
+	if (ppb < -MAX_PPB) {
+		return -MAX_PPB;
+	}
+
+	return ppb;
+}
+
+static u32_t isqrt64(u64_t value)
+{
+	u64_t res = 0U;
+	u64_t bit = 1ULL << 62;
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+
+	while (bit) {
+		if (value >= res + bit) {
+			value -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+
+		bit >>= 2;
+	}
+
+	return (u32_t)res;
+}
+
+static void servo_set_freq(struct device *clk, double freq)
+{
+	float ratio;
+	int ret;
+
+	/* The rate adjustment is relative to the current frequency. Mirror
+	 * the rounding of the ratio, so that the frequency tracked here is
+	 * the one of the clock.
+	 */
+	ratio = (NSEC_PER_SEC + clamp_ppb(freq)) / (NSEC_PER_SEC + servo.freq);
+	if (ratio == 1.0f) {
+		return;
+	}
+
+	ret = ptp_clock_rate_adjust(clk, ratio);
+	if (ret < 0) {
+		NET_DBG("Cannot adjust clock rate (%d)", ret);
+		return;
+	}
+
+	servo.freq = (NSEC_PER_SEC + servo.freq) * ratio - NSEC_PER_SEC;
+}
+
+static void servo_step(struct device *clk, s64_t offset)
+{
+	struct net_ptp_time tm;
+	u64_t time;
+	int key;
+
+	if (offset > INT_MIN && offset <= INT_MAX) {
+		ptp_clock_adjust(clk, (int)-offset);
+		NET_DBG("Clock stepped by %d ns", (int)-offset);
+		return;
+	}
+
+	key = irq_lock();
+
+	ptp_clock_get(clk, &tm);
+
+	time = gptp_timestamp_to_nsec(&tm) - offset;
+	tm.second = time / NSEC_PER_SEC;
+	tm.nanosecond = time % NSEC_PER_SEC;
+
+	ptp_clock_set(clk, &tm);
+
+	irq_unlock(key);
+
+	NET_DBG("Clock set to the grandmaster time");
+}
+
+/* Called with the lock held */
+static void servo_restart(s64_t offset, u64_t local_time)
+{
+	servo.stats.state = GPTP_SERVO_UNLOCKED;
+	servo.stats.samples = 0U;
+	servo.offset0 = offset;
+	servo.local_time0 = local_time;
+	servo.sum_sq = 0U;
+	servo.max = 0U;
+	servo.count = 0;
+}
+
+/* Called with the lock held */
+static void servo_update_stats(s64_t offset, u32_t path_delay)
+{
+	u32_t abs_offset;
+
+	servo.stats.offset = offset;
+	servo.stats.path_delay = path_delay;
+	servo.stats.freq = (s32_t)servo.freq;
+	servo.stats.samples++;
+
+	if (servo.stats.state != GPTP_SERVO_LOCKED) {
+		return;
+	}
+
+	/* Bounded by the step threshold when locked */
+	abs_offset = offset < 0 ? -offset : offset;
+
+	servo.sum_sq += (u64_t)abs_offset * abs_offset;
+	servo.max = MAX(servo.max, abs_offset);
+
+	if (++servo.count < GPTP_SERVO_STATS_WINDOW) {
+		return;
+	}
+
+	servo.stats.offset_rms = isqrt64(servo.sum_sq / servo.count);
+	servo.stats.offset_max = servo.max;
+
+	NET_DBG("offset rms %u max %u ns freq %d ppb path delay %u ns",
+		servo.stats.offset_rms, servo.stats.offset_max,
+		servo.stats.freq, path_delay);
+
+	servo.sum_sq = 0U;
+	servo.max = 0U;
+	servo.count = 0;
+}
+
+void gptp_servo_sample(struct device *clk, s64_t offset, u64_t local_time,
+		       u32_t path_delay)
+{
+	enum gptp_servo_state state = servo.stats.state;
+	k_spinlock_key_t key;
+	double interval;
+
+	switch (state) {
+	case GPTP_SERVO_UNLOCKED:
+		if (!servo.stats.samples) {
+			servo.offset0 = offset;
+			servo.local_time0 = local_time;
+			break;
+		}
+
+		if (local_time <= servo.local_time0) {
+			key = k_spin_lock(&servo.lock);
+			servo_restart(offset, local_time);
+			k_spin_unlock(&servo.lock, key);
+			break;
+		}
+
+		/* The offset drifts by the frequency offset from the
+		 * grandmaster, compensate it and set the clock to the
+		 * grandmaster time.
+		 */
+		servo_set_freq(clk, servo.freq -
+			       (double)(offset - servo.offset0) * NSEC_PER_SEC /
+			       (local_time - servo.local_time0));
+		servo.drift = servo.freq;
+
+		servo_step(clk, offset);
+
+		local_time -= offset;
+		state = GPTP_SERVO_JUMP;
+		break;
+
+	case GPTP_SERVO_JUMP:
+	case GPTP_SERVO_LOCKED:
+		if (offset > STEP_THRESHOLD || offset < -STEP_THRESHOLD) {
+			NET_DBG("Offset above step threshold, reset servo");
+
+			key = k_spin_lock(&servo.lock);
+			servo_restart(offset, local_time);
+			k_spin_unlock(&servo.lock, key);
+
+			state = GPTP_SERVO_UNLOCKED;
+			break;
+		}
+
+		interval = (double)(s64_t)(local_time - servo.last_local_time) /
+			   NSEC_PER_SEC;
+		if (interval > 0) {
+			servo.drift = clamp_ppb(servo.drift -
+						KI * offset * interval);
+		}
+
+		servo_set_freq(clk, servo.drift - KP * offset);
+
+		state = GPTP_SERVO_LOCKED;
+		break;
+	}
+
+	servo.last_local_time = local_time;
+
+	key = k_spin_lock(&servo.lock);
+
+	servo.stats.state = state;
+	servo_update_stats(offset, path_delay);
+
+	k_spin_unlock(&servo.lock, key);
+}
+
+void gptp_servo_reset(void)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&servo.lock);
+	servo_restart(0, 0U);
+	k_spin_unlock(&servo.lock, key);
+}
+
+int gptp_servo_get_stats(struct gptp_servo_stats *stats)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&servo.lock);
+	*stats = servo.stats;
+	k_spin_unlock(&servo.lock, key);
+
+	return 0;
+}
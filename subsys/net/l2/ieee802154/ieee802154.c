@@ -25,6 +25,7 @@ LOG_MODULE_REGISTER(net_ieee802154, CONFIG_NET_L2_IEEE802154_LOG_LEVEL);
 #include "ieee802154_security.h"
 #include "ieee802154_utils.h"
 #include "ieee802154_radio_utils.h"
+#include "ieee802154_tsch.h"
 
 #define BUF_TIMEOUT K_MSEC(50)
 
@@ -189,6 +190,11 @@ static enum net_verdict ieee802154_recv(struct net_if *iface,
 	}
 
 	if (mpdu.mhr.fs->fc.frame_type == IEEE802154_FRAME_TYPE_BEACON) {
+		if (ieee802154_tsch_handle_eb(iface, &mpdu)) {
+			net_pkt_unref(pkt);
+			return NET_OK;
+		}
+
 		return ieee802154_handle_beacon(iface, &mpdu,
 						net_pkt_ieee802154_lqi(pkt));
 	}
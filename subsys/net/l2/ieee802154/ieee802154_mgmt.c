@@ -21,6 +21,7 @@ LOG_MODULE_REGISTER(net_ieee802154_mgmt, CONFIG_NET_L2_IEEE802154_LOG_LEVEL);
 #include "ieee802154_security.h"
 #include "ieee802154_utils.h"
 #include "ieee802154_radio_utils.h"
+#include "ieee802154_tsch.h"
 
 enum net_verdict ieee802154_handle_beacon(struct net_if *iface,
 					  struct ieee802154_mpdu *mpdu,
@@ -554,3 +555,42 @@ NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_IEEE802154_GET_SECURITY_SETTINGS,
 				  ieee802154_get_security_settings);
 
 #endif /* CONFIG_NET_L2_IEEE802154_SECURITY */
+
+#ifdef CONFIG_NET_L2_IEEE802154_RADIO_TSCH
+
+static int ieee802154_tsch_start_request(u32_t mgmt_request,
+					 struct net_if *iface,
+					 void *data, size_t len)
+{
+	if (len != sizeof(bool) || !data) {
+		return -EINVAL;
+	}
+
+	return ieee802154_tsch_start(iface, *((bool *)data));
+}
+
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_IEEE802154_TSCH_START,
+				  ieee802154_tsch_start_request);
+
+static int ieee802154_tsch_cell_request(u32_t mgmt_request,
+					struct net_if *iface,
+					void *data, size_t len)
+{
+	if (len != sizeof(struct ieee802154_tsch_cell) || !data) {
+		return -EINVAL;
+	}
+
+	if (mgmt_request == NET_REQUEST_IEEE802154_TSCH_ADD_CELL) {
+		return ieee802154_tsch_add_cell(iface, data);
+	}
+
+	return ieee802154_tsch_del_cell(iface, data);
+}
+
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_IEEE802154_TSCH_ADD_CELL,
+				  ieee802154_tsch_cell_request);
+
+NET_MGMT_REGISTER_REQUEST_HANDLER(NET_REQUEST_IEEE802154_TSCH_DEL_CELL,
+				  ieee802154_tsch_cell_request);
+
+#endif /* CONFIG_NET_L2_IEEE802154_RADIO_TSCH */
@@ -0,0 +1,564 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_ieee802154_tsch, CONFIG_NET_L2_IEEE802154_LOG_LEVEL);
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+
+#include <misc/util.h>
+#include <misc/byteorder.h>
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "ieee802154_frame.h"
+#include "ieee802154_utils.h"
+#include "ieee802154_radio_utils.h"
+#include "ieee802154_tsch.h"
+
+/* This is a simplified Time Slotted Channel Hopping MAC, after the TSCH
+ * mode of IEEE 802.15.4-2015. Time is divided into timeslots, numbered by
+ * the Absolute Slot Number (ASN) and grouped in slotframes. The schedule
+ * tells in which timeslots of the slotframe the node sends or listens,
+ * and with which channel offset. The channel of a cell changes from one
+ * slotframe to the next, following the hopping sequence.
+ *
+ * The time source of the network sends Enhanced Beacons (EB) carrying the
+ * ASN, on which the other nodes align their timeslots. Unlike the
+ * standard, the nodes only synchronize on the time source, EBs carry the
+ * ASN in their payload rather than in Information Elements, and only one
+ * interface can use TSCH.
+ */
+
+#define SLOT_DURATION CONFIG_NET_L2_IEEE802154_RADIO_TSCH_SLOT_DURATION
+#define SLOTFRAME_SIZE CONFIG_NET_L2_IEEE802154_RADIO_TSCH_SLOTFRAME_SIZE
+#define MAX_CELLS CONFIG_NET_L2_IEEE802154_RADIO_TSCH_MAX_CELLS
+#define MIN_BE CONFIG_NET_L2_IEEE802154_RADIO_TSCH_MIN_BE
+#define MAX_BE CONFIG_NET_L2_IEEE802154_RADIO_TSCH_MAX_BE
+
+/* EBs are sent in the minimal cell of one slotframe out of EB_PERIOD */
+#define EB_PERIOD (SLOTFRAME_SIZE *					\
+		   CONFIG_NET_L2_IEEE802154_RADIO_TSCH_EB_PERIOD)
+
+/* Time from the start of a timeslot to the start of the transmission, in
+ * milliseconds, which leaves the receivers time to switch channel.
+ */
+#define TX_OFFSET 2
+
+/* Number of timeslots looked at for sending a frame: a full backoff
+ * window of shared cells, when there is one in each slotframe.
+ */
+#define MAX_LOOKAHEAD (SLOTFRAME_SIZE * ((1 << MAX_BE) + 1))
+
+#define TSCH_THREAD_PRIO K_PRIO_COOP(1)
+
+#define EB_SYNC_ID 0x1a
+
+/* Payload of an EB, after the superframe, GTS and pending address fields */
+struct tsch_eb_sync {
+	u8_t id;
+	/* ASN of the timeslot the EB is sent in, little endian */
+	u8_t asn[5];
+	u8_t join_priority;
+} __packed;
+
+static const u8_t hopping_sequence[] = { 15, 25, 26, 20 };
+
+static const u8_t any_addr[IEEE802154_EXT_ADDR_LENGTH];
+
+static struct {
+	struct net_if *iface;
+	struct ieee802154_tsch_cell cells[MAX_CELLS];
+	u8_t cell_count;
+
+	/* Uptime at the start of ASN 0 */
+	s64_t epoch;
+
+	/* Extended address of the time source, as found in its frames */
+	u8_t time_source_addr[IEEE802154_EXT_ADDR_LENGTH];
+
+	/* Shared cells to skip before sending again, and backoff exponent */
+	u16_t backoff;
+	u8_t be;
+
+	bool time_source;
+	bool synchronized;
+} tsch;
+
+/* Protects the schedule and the radio while it is used in a timeslot */
+static K_MUTEX_DEFINE(tsch_lock);
+
+K_THREAD_STACK_DEFINE(tsch_stack,
+		      CONFIG_NET_L2_IEEE802154_RADIO_TSCH_STACK_SIZE);
+static struct k_thread tsch_thread_data;
+
+static inline u64_t slot_asn(s64_t time)
+{
+	return (time - tsch.epoch) / SLOT_DURATION;
+}
+
+static inline s64_t slot_start(u64_t asn)
+{
+	return tsch.epoch + asn * SLOT_DURATION;
+}
+
+static inline u16_t slot_channel(u64_t asn,
+				 struct ieee802154_tsch_cell *cell)
+{
+	return hopping_sequence[(asn + cell->channel_offset) %
+				ARRAY_SIZE(hopping_sequence)];
+}
+
+static void sleep_until(s64_t time)
+{
+	s64_t now = k_uptime_get();
+
+	if (time > now) {
+		k_sleep((s32_t)(time - now));
+	}
+}
+
+static inline bool is_any_addr(struct ieee802154_tsch_cell *cell)
+{
+	return !memcmp(cell->addr, any_addr, sizeof(any_addr));
+}
+
+static struct ieee802154_tsch_cell *find_cell(u16_t slot_offset,
+					      u8_t options)
+{
+	int i;
+
+	for (i = 0; i < tsch.cell_count; i++) {
+		if (tsch.cells[i].slot_offset == slot_offset &&
+		    (tsch.cells[i].options & options) == options) {
+			return &tsch.cells[i];
+		}
+	}
+
+	return NULL;
+}
+
+static int find_same_cell(struct ieee802154_tsch_cell *cell)
+{
+	int i;
+
+	for (i = 0; i < tsch.cell_count; i++) {
+		if (tsch.cells[i].slot_offset == cell->slot_offset &&
+		    !memcmp(tsch.cells[i].addr, cell->addr,
+			    sizeof(cell->addr))) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static bool cell_matches(struct ieee802154_tsch_cell *cell,
+			 struct net_linkaddr *dst)
+{
+	if (!(cell->options & IEEE802154_TSCH_CELL_TX)) {
+		return false;
+	}
+
+	if (is_any_addr(cell)) {
+		return true;
+	}
+
+	return dst->addr && dst->len == IEEE802154_EXT_ADDR_LENGTH &&
+		!memcmp(cell->addr, dst->addr, IEEE802154_EXT_ADDR_LENGTH);
+}
+
+/* Find the next timeslot a frame to dst can be sent in. In a timeslot, a
+ * dedicated cell is preferred to a shared one, and shared cells are
+ * skipped while a backoff is pending.
+ */
+static bool next_tx_cell(struct net_linkaddr *dst,
+			 struct ieee802154_tsch_cell *tx_cell, u64_t *asn)
+{
+	struct ieee802154_tsch_cell *cell, *shared;
+	bool found = false;
+	u64_t next;
+	int slot, i;
+
+	k_mutex_lock(&tsch_lock, K_FOREVER);
+
+	next = slot_asn(k_uptime_get()) + 1;
+
+	for (slot = 0; slot < MAX_LOOKAHEAD && !found; slot++, next++) {
+		shared = NULL;
+
+		for (i = 0; i < tsch.cell_count; i++) {
+			cell = &tsch.cells[i];
+
+			if (cell->slot_offset != next % SLOTFRAME_SIZE ||
+			    !cell_matches(cell, dst)) {
+				continue;
+			}
+
+			if (!(cell->options & IEEE802154_TSCH_CELL_SHARED)) {
+				*tx_cell = *cell;
+				found = true;
+				break;
+			}
+
+			shared = cell;
+		}
+
+		if (found || !shared) {
+			continue;
+		}
+
+		if (tsch.backoff) {
+			tsch.backoff--;
+			continue;
+		}
+
+		*tx_cell = *shared;
+		found = true;
+	}
+
+	*asn = next - 1;
+
+	k_mutex_unlock(&tsch_lock);
+
+	return found;
+}
+
+static void shared_cell_backoff(bool success)
+{
+	k_mutex_lock(&tsch_lock, K_FOREVER);
+
+	if (success) {
+		tsch.be = MIN_BE;
+		tsch.backoff = 0U;
+	} else {
+		tsch.be = MIN(tsch.be + 1, MAX_BE);
+		tsch.backoff = sys_rand32_get() & ((1 << tsch.be) - 1);
+	}
+
+	k_mutex_unlock(&tsch_lock);
+}
+
+static inline int tsch_radio_send(struct net_if *iface,
+				  struct net_pkt *pkt,
+				  struct net_buf *frag)
+{
+	u8_t retries = CONFIG_NET_L2_IEEE802154_RADIO_TX_RETRIES;
+	struct ieee802154_context *ctx = net_if_l2_data(iface);
+	struct ieee802154_tsch_cell cell;
+	bool ack_required;
+	int ret = -EIO;
+	u64_t asn;
+
+	NET_DBG("frag %p", frag);
+
+	if (iface != tsch.iface || !tsch.synchronized) {
+		return -ENETDOWN;
+	}
+
+	ack_required = prepare_for_ack(ctx, pkt, frag);
+
+	while (retries) {
+		retries--;
+
+		if (!next_tx_cell(net_pkt_lladdr_dst(pkt), &cell, &asn)) {
+			return -ENETUNREACH;
+		}
+
+		sleep_until(slot_start(asn) + TX_OFFSET);
+
+		k_mutex_lock(&tsch_lock, K_FOREVER);
+
+		ret = ieee802154_set_channel(iface, slot_channel(asn, &cell));
+		if (!ret) {
+			ret = ieee802154_tx(iface, pkt, frag);
+		}
+
+		if (!ret) {
+			ret = wait_for_ack(iface, ack_required);
+		}
+
+		k_mutex_unlock(&tsch_lock);
+
+		if (cell.options & IEEE802154_TSCH_CELL_SHARED) {
+			shared_cell_backoff(!ret);
+		}
+
+		if (!ret) {
+			break;
+		}
+	}
+
+	return ret;
+}
+
+static enum net_verdict tsch_radio_handle_ack(struct net_if *iface,
+					      struct net_pkt *pkt)
+{
+	struct ieee802154_context *ctx = net_if_l2_data(iface);
+
+	return handle_ack(ctx, pkt);
+}
+
+static void send_eb(struct net_if *iface, u64_t asn)
+{
+	struct ieee802154_context *ctx = net_if_l2_data(iface);
+	struct ieee802154_fcf_seq *fs;
+	struct ieee802154_beacon *beacon;
+	struct tsch_eb_sync *sync;
+	struct net_pkt *pkt;
+	u8_t *p_buf;
+
+	pkt = net_pkt_alloc_with_buffer(iface,
+					IEEE802154_MTU - IEEE802154_MFR_LENGTH,
+					AF_UNSPEC, 0, K_NO_WAIT);
+	if (!pkt) {
+		NET_DBG("Could not allocate EB");
+		return;
+	}
+
+	p_buf = net_pkt_data(pkt);
+
+	fs = (struct ieee802154_fcf_seq *)p_buf;
+	(void)memset(fs, 0, sizeof(*fs));
+
+	fs->fc.frame_type = IEEE802154_FRAME_TYPE_BEACON;
+	fs->fc.frame_version = IEEE802154_VERSION_802154_2006;
+	fs->fc.src_addr_mode = IEEE802154_ADDR_MODE_EXTENDED;
+	fs->sequence = ctx->sequence++;
+	p_buf += sizeof(*fs);
+
+	sys_put_le16(ctx->pan_id, p_buf);
+	p_buf += IEEE802154_PAN_ID_LENGTH;
+
+	memcpy(p_buf, ctx->ext_addr, IEEE802154_EXT_ADDR_LENGTH);
+	p_buf += IEEE802154_EXT_ADDR_LENGTH;
+
+	/* Non beacon-enabled PAN, no GTS and no pending address */
+	beacon = (struct ieee802154_beacon *)p_buf;
+	(void)memset(beacon, 0,
+		     sizeof(*beacon) + IEEE802154_BEACON_PAS_SPEC_SIZE);
+
+	beacon->sf.bc_order = 15U;
+	beacon->sf.sf_order = 15U;
+	beacon->sf.coordinator = 1U;
+	p_buf += sizeof(*beacon) + IEEE802154_BEACON_PAS_SPEC_SIZE;
+
+	sync = (struct tsch_eb_sync *)p_buf;
+	sync->id = EB_SYNC_ID;
+	sys_put_le32((u32_t)asn, sync->asn);
+	sync->asn[4] = (u8_t)(asn >> 32);
+	sync->join_priority = 0U;
+	p_buf += sizeof(*sync);
+
+	net_buf_add(pkt->buffer, p_buf - net_pkt_data(pkt));
+
+	if (ieee802154_tx(iface, pkt, pkt->buffer)) {
+		NET_DBG("Could not send EB");
+	}
+
+	net_pkt_unref(pkt);
+}
+
+bool ieee802154_tsch_handle_eb(struct net_if *iface,
+			       struct ieee802154_mpdu *mpdu)
+{
+	s64_t now = k_uptime_get();
+	struct ieee802154_pas_spec *pas;
+	struct tsch_eb_sync *sync;
+	u8_t *src;
+	u64_t asn;
+
+	if (iface != tsch.iface || mpdu->beacon->gts.desc_count ||
+	    mpdu->mhr.fs->fc.src_addr_mode != IEEE802154_ADDR_MODE_EXTENDED) {
+		return false;
+	}
+
+	pas = (struct ieee802154_pas_spec *)(mpdu->beacon + 1);
+	if (pas->nb_sap || pas->nb_eap) {
+		return false;
+	}
+
+	sync = (struct tsch_eb_sync *)((u8_t *)pas +
+				       IEEE802154_BEACON_PAS_SPEC_SIZE);
+	if ((u8_t *)mpdu->mfr < (u8_t *)(sync + 1) ||
+	    sync->id != EB_SYNC_ID) {
+		return false;
+	}
+
+	src = mpdu->mhr.src_addr->plain.addr.ext_addr;
+
+	if (tsch.time_source ||
+	    (tsch.synchronized &&
+	     memcmp(src, tsch.time_source_addr, IEEE802154_EXT_ADDR_LENGTH))) {
+		return true;
+	}
+
+	asn = sys_get_le32(sync->asn) | ((u64_t)sync->asn[4] << 32);
+
+	k_mutex_lock(&tsch_lock, K_FOREVER);
+
+	tsch.epoch = now - (s64_t)asn * SLOT_DURATION - TX_OFFSET;
+
+	if (!tsch.synchronized) {
+		memcpy(tsch.time_source_addr, src,
+		       IEEE802154_EXT_ADDR_LENGTH);
+		tsch.synchronized = true;
+
+		NET_DBG("Synchronized at ASN %u", (u32_t)asn);
+	}
+
+	k_mutex_unlock(&tsch_lock);
+
+	return true;
+}
+
+static void tsch_thread(void)
+{
+	struct ieee802154_tsch_cell *cell;
+	u8_t scan = 0U;
+	u64_t asn;
+
+	while (1) {
+		if (!tsch.synchronized) {
+			/* Listen long enough on each channel to hear an EB
+			 * sent on it.
+			 */
+			ieee802154_set_channel(tsch.iface,
+					       hopping_sequence[scan]);
+			scan = (scan + 1) % ARRAY_SIZE(hopping_sequence);
+
+			k_sleep((EB_PERIOD + 1) * SLOT_DURATION);
+			continue;
+		}
+
+		k_mutex_lock(&tsch_lock, K_FOREVER);
+
+		asn = slot_asn(k_uptime_get());
+
+		cell = find_cell(asn % SLOTFRAME_SIZE, IEEE802154_TSCH_CELL_RX);
+		if (cell) {
+			ieee802154_set_channel(tsch.iface,
+					       slot_channel(asn, cell));
+		}
+
+		k_mutex_unlock(&tsch_lock);
+
+		if (tsch.time_source && !(asn % EB_PERIOD)) {
+			sleep_until(slot_start(asn) + TX_OFFSET);
+
+			k_mutex_lock(&tsch_lock, K_FOREVER);
+
+			cell = find_cell(0, IEEE802154_TSCH_CELL_TX |
+					 IEEE802154_TSCH_CELL_SHARED);
+			if (cell) {
+				ieee802154_set_channel(tsch.iface,
+						       slot_channel(asn, cell));
+				send_eb(tsch.iface, asn);
+			}
+
+			k_mutex_unlock(&tsch_lock);
+		}
+
+		sleep_until(slot_start(asn + 1));
+	}
+}
+
+int ieee802154_tsch_start(struct net_if *iface, bool time_source)
+{
+	struct ieee802154_tsch_cell minimal = {
+		.options = IEEE802154_TSCH_CELL_TX | IEEE802154_TSCH_CELL_RX |
+			   IEEE802154_TSCH_CELL_SHARED,
+	};
+
+	if (tsch.iface) {
+		return -EALREADY;
+	}
+
+	tsch.iface = iface;
+	tsch.time_source = time_source;
+	tsch.be = MIN_BE;
+
+	if (time_source) {
+		tsch.epoch = k_uptime_get();
+		tsch.synchronized = true;
+	}
+
+	/* The minimal cell, shared by all the nodes, carries the EBs and
+	 * the traffic not having a dedicated cell.
+	 */
+	ieee802154_tsch_add_cell(iface, &minimal);
+
+	k_thread_create(&tsch_thread_data, tsch_stack,
+			K_THREAD_STACK_SIZEOF(tsch_stack),
+			(k_thread_entry_t)tsch_thread,
+			NULL, NULL, NULL, TSCH_THREAD_PRIO, 0, K_NO_WAIT);
+
+	NET_DBG("TSCH started on iface %p%s", iface,
+		time_source ? " as time source" : "");
+
+	return 0;
+}
+
+int ieee802154_tsch_add_cell(struct net_if *iface,
+			     struct ieee802154_tsch_cell *cell)
+{
+	int ret = 0;
+
+	if (iface != tsch.iface) {
+		return -ENETDOWN;
+	}
+
+	if (cell->slot_offset >= SLOTFRAME_SIZE ||
+	    !(cell->options & (IEEE802154_TSCH_CELL_TX |
+			       IEEE802154_TSCH_CELL_RX))) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&tsch_lock, K_FOREVER);
+
+	if (find_same_cell(cell) >= 0) {
+		ret = -EALREADY;
+	} else if (tsch.cell_count == MAX_CELLS) {
+		ret = -ENOMEM;
+	} else {
+		tsch.cells[tsch.cell_count++] = *cell;
+	}
+
+	k_mutex_unlock(&tsch_lock);
+
+	return ret;
+}
+
+int ieee802154_tsch_del_cell(struct net_if *iface,
+			     struct ieee802154_tsch_cell *cell)
+{
+	int idx;
+
+	if (iface != tsch.iface) {
+		return -ENETDOWN;
+	}
+
+	k_mutex_lock(&tsch_lock, K_FOREVER);
+
+	idx = find_same_cell(cell);
+	if (idx >= 0) {
+		tsch.cells[idx] = tsch.cells[--tsch.cell_count];
+	}
+
+	k_mutex_unlock(&tsch_lock);
+
+	return idx < 0 ? idx : 0;
+}
+
+/* Declare the public Radio driver function used by the HW drivers */
+FUNC_ALIAS(tsch_radio_send,
+	   ieee802154_radio_send, int);
+
+FUNC_ALIAS(tsch_radio_handle_ack,
+	   ieee802154_radio_handle_ack, enum net_verdict);
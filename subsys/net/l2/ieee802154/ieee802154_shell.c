@@ -591,6 +591,140 @@ static int cmd_ieee802154_get_tx_power(const struct shell *shell,
 	return 0;
 }
 
+static int cmd_ieee802154_tsch_start(const struct shell *shell,
+				     size_t argc, char *argv[])
+{
+#if defined(CONFIG_NET_L2_IEEE802154_RADIO_TSCH)
+	struct net_if *iface = net_if_get_ieee802154();
+	bool time_source = argc > 1 && !strcmp(argv[1], "time_source");
+
+	if (!iface) {
+		shell_fprintf(shell, SHELL_INFO,
+			      "No IEEE 802.15.4 interface found.\n");
+		return -ENOEXEC;
+	}
+
+	if (net_mgmt(NET_REQUEST_IEEE802154_TSCH_START, iface,
+		     &time_source, sizeof(bool))) {
+		shell_fprintf(shell, SHELL_WARNING, "Could not start TSCH\n");
+		return -ENOEXEC;
+	}
+
+	shell_fprintf(shell, SHELL_NORMAL, "TSCH started%s\n",
+		      time_source ? " as time source" : "");
+#else
+	shell_fprintf(shell, SHELL_INFO,
+		      "Set CONFIG_NET_L2_IEEE802154_RADIO_TSCH to enable "
+		      "TSCH.\n");
+#endif
+
+	return 0;
+}
+
+#if defined(CONFIG_NET_L2_IEEE802154_RADIO_TSCH)
+static int tsch_cell_request(const struct shell *shell, bool add,
+			     struct ieee802154_tsch_cell *cell,
+			     char *addr)
+{
+	struct net_if *iface = net_if_get_ieee802154();
+	int ret;
+
+	if (!iface) {
+		shell_fprintf(shell, SHELL_INFO,
+			      "No IEEE 802.15.4 interface found.\n");
+		return -ENOEXEC;
+	}
+
+	if (addr) {
+		if (strlen(addr) != MAX_EXT_ADDR_STR_LEN - 1) {
+			shell_fprintf(shell, SHELL_WARNING,
+				      "Invalid address %s\n", addr);
+			return -ENOEXEC;
+		}
+
+		parse_extended_address(addr, cell->addr);
+	}
+
+	if (add) {
+		ret = net_mgmt(NET_REQUEST_IEEE802154_TSCH_ADD_CELL, iface,
+			       cell, sizeof(struct ieee802154_tsch_cell));
+	} else {
+		ret = net_mgmt(NET_REQUEST_IEEE802154_TSCH_DEL_CELL, iface,
+			       cell, sizeof(struct ieee802154_tsch_cell));
+	}
+
+	if (ret) {
+		shell_fprintf(shell, SHELL_WARNING,
+			      "Could not %s cell at slot %u\n",
+			      add ? "add" : "remove", cell->slot_offset);
+		return -ENOEXEC;
+	}
+
+	return 0;
+}
+#endif
+
+static int cmd_ieee802154_tsch_add_cell(const struct shell *shell,
+					size_t argc, char *argv[])
+{
+#if defined(CONFIG_NET_L2_IEEE802154_RADIO_TSCH)
+	struct ieee802154_tsch_cell cell = { 0 };
+
+	if (argc < 4) {
+		shell_help(shell);
+		return -ENOEXEC;
+	}
+
+	cell.slot_offset = (u16_t)atoi(argv[1]);
+	cell.channel_offset = (u16_t)atoi(argv[2]);
+
+	if (strstr(argv[3], "tx")) {
+		cell.options |= IEEE802154_TSCH_CELL_TX;
+	}
+
+	if (strstr(argv[3], "rx")) {
+		cell.options |= IEEE802154_TSCH_CELL_RX;
+	}
+
+	if (strstr(argv[3], "shared")) {
+		cell.options |= IEEE802154_TSCH_CELL_SHARED;
+	}
+
+	return tsch_cell_request(shell, true, &cell,
+				 argc > 4 ? argv[4] : NULL);
+#else
+	shell_fprintf(shell, SHELL_INFO,
+		      "Set CONFIG_NET_L2_IEEE802154_RADIO_TSCH to enable "
+		      "TSCH.\n");
+
+	return 0;
+#endif
+}
+
+static int cmd_ieee802154_tsch_del_cell(const struct shell *shell,
+					size_t argc, char *argv[])
+{
+#if defined(CONFIG_NET_L2_IEEE802154_RADIO_TSCH)
+	struct ieee802154_tsch_cell cell = { 0 };
+
+	if (argc < 2) {
+		shell_help(shell);
+		return -ENOEXEC;
+	}
+
+	cell.slot_offset = (u16_t)atoi(argv[1]);
+
+	return tsch_cell_request(shell, false, &cell,
+				 argc > 2 ? argv[2] : NULL);
+#else
+	shell_fprintf(shell, SHELL_INFO,
+		      "Set CONFIG_NET_L2_IEEE802154_RADIO_TSCH to enable "
+		      "TSCH.\n");
+
+	return 0;
+#endif
+}
+
 SHELL_STATIC_SUBCMD_SET_CREATE(ieee802154_commands,
 	SHELL_CMD(ack, NULL,
 		  "<set/1 | unset/0> Set auto-ack flag",
@@ -635,6 +769,17 @@ SHELL_STATIC_SUBCMD_SET_CREATE(ieee802154_commands,
 	SHELL_CMD(set_tx_power,	NULL,
 		  "<-18/-7/-4/-2/0/1/2/3/5> Set TX power",
 		  cmd_ieee802154_set_tx_power),
+	SHELL_CMD(tsch_add_cell, NULL,
+		  "<slot offset> <channel offset> <tx,rx,shared> "
+		  "[neighbor address (EUI-64)] Add a TSCH cell",
+		  cmd_ieee802154_tsch_add_cell),
+	SHELL_CMD(tsch_del_cell, NULL,
+		  "<slot offset> [neighbor address (EUI-64)] "
+		  "Remove a TSCH cell",
+		  cmd_ieee802154_tsch_del_cell),
+	SHELL_CMD(tsch_start, NULL,
+		  "[time_source] Start TSCH, as time source of the network",
+		  cmd_ieee802154_tsch_start),
 	SHELL_SUBCMD_SET_END
 );
 
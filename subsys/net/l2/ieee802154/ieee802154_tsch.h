@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief IEEE 802.15.4 TSCH-style radio protocol
+ */
+
+#ifndef __IEEE802154_TSCH_H__
+#define __IEEE802154_TSCH_H__
+
+#ifdef CONFIG_NET_L2_IEEE802154_RADIO_TSCH
+
+#include <net/ieee802154_mgmt.h>
+
+#include "ieee802154_frame.h"
+
+int ieee802154_tsch_start(struct net_if *iface, bool time_source);
+
+int ieee802154_tsch_add_cell(struct net_if *iface,
+			     struct ieee802154_tsch_cell *cell);
+
+int ieee802154_tsch_del_cell(struct net_if *iface,
+			     struct ieee802154_tsch_cell *cell);
+
+/* Returns true if the beacon was an Enhanced Beacon, after getting the
+ * timing of the network from it.
+ */
+bool ieee802154_tsch_handle_eb(struct net_if *iface,
+			       struct ieee802154_mpdu *mpdu);
+
+#else
+
+#define ieee802154_tsch_handle_eb(...) false
+
+#endif /* CONFIG_NET_L2_IEEE802154_RADIO_TSCH */
+
+#endif /* __IEEE802154_TSCH_H__ */
@@ -13,6 +13,7 @@
 #define __IEEE802154_UTILS_H__
 
 #include <net/ieee802154_radio.h>
+#include <net/capture.h>
 
 static inline
 enum ieee802154_hw_caps ieee802154_get_hw_capabilities(struct net_if *iface)
@@ -68,12 +69,18 @@ static inline int ieee802154_tx(struct net_if *iface,
 {
 	const struct ieee802154_radio_api *radio =
 		net_if_get_device(iface)->driver_api;
+	int ret;
 
 	if (!radio) {
 		return -ENOENT;
 	}
 
-	return radio->tx(net_if_get_device(iface), pkt, buf);
+	ret = radio->tx(net_if_get_device(iface), pkt, buf);
+	if (!ret) {
+		net_capture_frag(iface, buf, NET_CAPTURE_TX);
+	}
+
+	return ret;
 }
 
 static inline int ieee802154_start(struct net_if *iface)
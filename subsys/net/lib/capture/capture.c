@@ -0,0 +1,607 @@
+/** @file
+ * @brief Network packet capture
+ *
+ * The packets sent and received by the captured interfaces are queued to
+ * a ring per interface, without copying their data: each entry of the
+ * ring holds a reference to the fragments of a packet, with the part of
+ * them the packet was made of when captured. The capture thread then
+ * periodically writes the packets out in pcapng format and releases the
+ * fragments.
+ *
+ * The ring is a bounded multi-producer queue: a producer reserves a slot
+ * by moving the head forward, fills it and publishes it by updating its
+ * sequence number, so that the Rx and Tx threads never wait for each
+ * other nor for the capture thread. When the ring is full, the packet is
+ * dropped.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_capture, CONFIG_NET_CAPTURE_LOG_LEVEL);
+
+#include <kernel.h>
+#include <errno.h>
+#include <string.h>
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/buf.h>
+#include <net/capture.h>
+
+#include "capture_internal.h"
+
+#define RING_SIZE CONFIG_NET_CAPTURE_RING_SIZE
+#define MAX_FRAGS CONFIG_NET_CAPTURE_MAX_FRAGS
+#define SNAPLEN CONFIG_NET_CAPTURE_SNAPLEN
+
+BUILD_ASSERT_MSG((RING_SIZE & (RING_SIZE - 1)) == 0,
+		 "CONFIG_NET_CAPTURE_RING_SIZE must be a power of two");
+
+/* pcapng blocks, see https://github.com/pcapng/pcapng */
+#define PCAPNG_SHB			0x0A0D0D0A
+#define PCAPNG_IDB			0x00000001
+#define PCAPNG_EPB			0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC		0x1A2B3C4D
+
+#define PCAPNG_OPT_END			0
+#define PCAPNG_OPT_EPB_FLAGS		2
+#define PCAPNG_OPT_IF_TSRESOL		9
+
+/* Timestamps are in milliseconds */
+#define PCAPNG_TSRESOL_MS		3
+
+struct pcapng_block_hdr {
+	u32_t type;
+	u32_t len;
+} __packed;
+
+struct pcapng_opt {
+	u16_t code;
+	u16_t len;
+} __packed;
+
+struct pcapng_shb {
+	struct pcapng_block_hdr hdr;
+	u32_t magic;
+	u16_t major;
+	u16_t minor;
+	s64_t section_len;
+	u32_t len;
+} __packed;
+
+struct pcapng_idb {
+	struct pcapng_block_hdr hdr;
+	u16_t link_type;
+	u16_t reserved;
+	u32_t snaplen;
+	struct pcapng_opt tsresol;
+	u8_t tsresol_value[4];
+	struct pcapng_opt end;
+	u32_t len;
+} __packed;
+
+struct pcapng_epb {
+	struct pcapng_block_hdr hdr;
+	u32_t iface_id;
+	u32_t timestamp_high;
+	u32_t timestamp_low;
+	u32_t cap_len;
+	u32_t orig_len;
+} __packed;
+
+/* Follows the data of the packet, padded to 32 bits */
+struct pcapng_epb_trailer {
+	struct pcapng_opt flags;
+	u32_t flags_value;
+	struct pcapng_opt end;
+	u32_t len;
+} __packed;
+
+struct capture_frag {
+	struct net_buf *buf;
+	u8_t *data;
+	u16_t len;
+};
+
+struct capture_entry {
+	/* Position in the ring it can be reserved at, plus one once the
+	 * packet is published.
+	 */
+	atomic_t seq;
+	s64_t timestamp;
+	u16_t orig_len;
+	u8_t frag_count;
+	u8_t dir;
+	struct capture_frag frags[MAX_FRAGS];
+};
+
+struct capture {
+	struct net_if *iface;
+	struct net_capture_filter filter;
+	u16_t link_type;
+	/* The frames are copied, as the L2 rewrites them in place */
+	bool copy;
+	/* Id of the pcapng interface description, -1 if not written yet */
+	s32_t idb_id;
+	atomic_t head;
+	atomic_val_t tail;
+	atomic_t captured;
+	atomic_t filtered;
+	atomic_t dropped;
+	struct capture_entry ring[RING_SIZE];
+};
+
+static struct capture captures[CONFIG_NET_CAPTURE_IFACE_COUNT];
+
+#if defined(CONFIG_NET_L2_IEEE802154)
+NET_BUF_POOL_DEFINE(capture_copies, CONFIG_NET_CAPTURE_COPY_BUF_COUNT,
+		    CONFIG_NET_CAPTURE_COPY_BUF_SIZE, 0, NULL);
+#endif
+
+/* Serializes the output, and the enabling and disabling of the capture */
+static K_MUTEX_DEFINE(capture_lock);
+
+#if defined(CONFIG_NET_CAPTURE_BACKEND_NONE)
+static const struct net_capture_backend *backend;
+#else
+static const struct net_capture_backend *backend =
+	&net_capture_default_backend;
+#endif
+
+/* The section header was written out */
+static bool output_open;
+static u32_t idb_count;
+
+K_THREAD_STACK_DEFINE(capture_stack, CONFIG_NET_CAPTURE_STACK_SIZE);
+static struct k_thread capture_thread_data;
+static bool capture_thread_started;
+
+static struct capture *capture_find(struct net_if *iface)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(captures); i++) {
+		if (captures[i].iface == iface) {
+			return &captures[i];
+		}
+	}
+
+	return NULL;
+}
+
+static bool fill_copy(struct capture_entry *entry, struct net_buf *buf,
+		      size_t len)
+{
+#if defined(CONFIG_NET_L2_IEEE802154)
+	struct net_buf *copy;
+
+	copy = net_buf_alloc(&capture_copies, K_NO_WAIT);
+	if (!copy) {
+		return false;
+	}
+
+	net_buf_add(copy, net_buf_linearize(copy->data,
+					    net_buf_tailroom(copy),
+					    buf, 0, len));
+
+	entry->frags[0].buf = copy;
+	entry->frags[0].data = copy->data;
+	entry->frags[0].len = copy->len;
+	entry->frag_count = 1U;
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+static bool fill_entry(struct capture *capture, struct capture_entry *entry,
+		       struct net_buf *buf, size_t len,
+		       enum net_capture_dir dir)
+{
+	struct capture_frag *frag;
+	size_t left = MIN(len, SNAPLEN);
+
+	entry->timestamp = k_uptime_get();
+	entry->orig_len = len;
+	entry->dir = dir;
+	entry->frag_count = 0U;
+
+	if (capture->copy) {
+		return fill_copy(entry, buf, left);
+	}
+
+	while (buf && left && entry->frag_count < MAX_FRAGS) {
+		frag = &entry->frags[entry->frag_count++];
+
+		frag->buf = net_buf_ref(buf);
+		frag->data = buf->data;
+		frag->len = MIN(buf->len, left);
+
+		left -= frag->len;
+		buf = buf->frags;
+	}
+
+	return true;
+}
+
+void net_capture_buf(struct net_if *iface, struct net_buf *buf, size_t len,
+		     enum net_capture_dir dir)
+{
+	struct capture *capture = capture_find(iface);
+	struct capture_entry *entry;
+	atomic_val_t pos;
+	s32_t diff;
+
+	if (!capture) {
+		return;
+	}
+
+	if (capture->filter.count &&
+	    !net_capture_filter_match(&capture->filter, iface, buf, len)) {
+		atomic_inc(&capture->filtered);
+		return;
+	}
+
+	do {
+		pos = atomic_get(&capture->head);
+		entry = &capture->ring[pos & (RING_SIZE - 1)];
+
+		diff = atomic_get(&entry->seq) - pos;
+		if (diff < 0) {
+			/* Not written out yet, the ring is full */
+			atomic_inc(&capture->dropped);
+			return;
+		}
+
+		/* If diff > 0, another producer took the slot */
+	} while (diff || !atomic_cas(&capture->head, pos, pos + 1));
+
+	if (fill_entry(capture, entry, buf, len, dir)) {
+		atomic_inc(&capture->captured);
+	} else {
+		/* The slot is published anyway, and skipped */
+		atomic_inc(&capture->dropped);
+	}
+
+	atomic_set(&entry->seq, pos + 1);
+}
+
+static void release_entry(struct capture_entry *entry)
+{
+	int i;
+
+	for (i = 0; i < entry->frag_count; i++) {
+		net_buf_unref(entry->frags[i].buf);
+	}
+
+	entry->frag_count = 0U;
+}
+
+static void ring_reset(struct capture *capture)
+{
+	int i;
+
+	for (i = 0; i < RING_SIZE; i++) {
+		release_entry(&capture->ring[i]);
+		atomic_set(&capture->ring[i].seq, i);
+	}
+
+	atomic_set(&capture->head, 0);
+	capture->tail = 0;
+}
+
+static int write_shb(void)
+{
+	struct pcapng_shb shb = {
+		.hdr.type = PCAPNG_SHB,
+		.hdr.len = sizeof(shb),
+		.magic = PCAPNG_BYTE_ORDER_MAGIC,
+		.major = 1U,
+		.minor = 0U,
+		/* Unknown */
+		.section_len = -1,
+		.len = sizeof(shb),
+	};
+	int ret;
+
+	if (output_open) {
+		return 0;
+	}
+
+	if (!backend) {
+		return -ENOENT;
+	}
+
+	if (backend->open) {
+		ret = backend->open();
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	ret = backend->write(&shb, sizeof(shb));
+	if (ret < 0) {
+		return ret;
+	}
+
+	output_open = true;
+	idb_count = 0U;
+
+	return 0;
+}
+
+static int write_idb(struct capture *capture)
+{
+	struct pcapng_idb idb = {
+		.hdr.type = PCAPNG_IDB,
+		.hdr.len = sizeof(idb),
+		.link_type = capture->link_type,
+		.snaplen = SNAPLEN,
+		.tsresol.code = PCAPNG_OPT_IF_TSRESOL,
+		.tsresol.len = 1U,
+		.tsresol_value = { PCAPNG_TSRESOL_MS },
+		.end.code = PCAPNG_OPT_END,
+		.len = sizeof(idb),
+	};
+	int ret;
+
+	if (capture->idb_id >= 0) {
+		return 0;
+	}
+
+	ret = write_shb();
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = backend->write(&idb, sizeof(idb));
+	if (ret < 0) {
+		return ret;
+	}
+
+	capture->idb_id = idb_count++;
+
+	return 0;
+}
+
+static int write_epb(struct capture *capture, struct capture_entry *entry)
+{
+	static const u8_t padding[sizeof(u32_t)];
+	struct pcapng_epb epb;
+	struct pcapng_epb_trailer trailer;
+	u32_t cap_len = 0U;
+	u32_t pad;
+	int i, ret;
+
+	for (i = 0; i < entry->frag_count; i++) {
+		cap_len += entry->frags[i].len;
+	}
+
+	pad = ROUND_UP(cap_len, sizeof(u32_t)) - cap_len;
+
+	epb.hdr.type = PCAPNG_EPB;
+	epb.hdr.len = sizeof(epb) + cap_len + pad + sizeof(trailer);
+	epb.iface_id = capture->idb_id;
+	epb.timestamp_high = (u64_t)entry->timestamp >> 32;
+	epb.timestamp_low = (u32_t)entry->timestamp;
+	epb.cap_len = cap_len;
+	epb.orig_len = entry->orig_len;
+
+	trailer.flags.code = PCAPNG_OPT_EPB_FLAGS;
+	trailer.flags.len = sizeof(trailer.flags_value);
+	trailer.flags_value = entry->dir;
+	trailer.end.code = PCAPNG_OPT_END;
+	trailer.end.len = 0U;
+	trailer.len = epb.hdr.len;
+
+	ret = backend->write(&epb, sizeof(epb));
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (i = 0; i < entry->frag_count; i++) {
+		ret = backend->write(entry->frags[i].data,
+				     entry->frags[i].len);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	if (pad) {
+		ret = backend->write(padding, pad);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return backend->write(&trailer, sizeof(trailer));
+}
+
+/* Called with capture_lock held */
+static void drain(struct capture *capture)
+{
+	struct capture_entry *entry;
+	int ret;
+
+	while (1) {
+		entry = &capture->ring[capture->tail & (RING_SIZE - 1)];
+
+		if (atomic_get(&entry->seq) != capture->tail + 1) {
+			return;
+		}
+
+		if (entry->frag_count) {
+			ret = write_idb(capture);
+			if (!ret) {
+				ret = write_epb(capture, entry);
+			}
+
+			if (ret < 0) {
+				NET_DBG("Cannot write packet (%d)", ret);
+			}
+		}
+
+		release_entry(entry);
+
+		atomic_set(&entry->seq, capture->tail + RING_SIZE);
+		capture->tail++;
+	}
+}
+
+void net_capture_flush(void)
+{
+	int i;
+
+	k_mutex_lock(&capture_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(captures); i++) {
+		if (captures[i].iface) {
+			drain(&captures[i]);
+		}
+	}
+
+	k_mutex_unlock(&capture_lock);
+}
+
+static void capture_thread(void)
+{
+	while (1) {
+		net_capture_flush();
+
+		k_sleep(CONFIG_NET_CAPTURE_FLUSH_PERIOD);
+	}
+}
+
+int net_capture_enable(struct net_if *iface,
+		       const struct net_capture_filter *filter)
+{
+	struct capture *capture;
+	int link_type;
+	int ret = 0;
+
+	link_type = net_capture_link_type(iface);
+	if (link_type < 0) {
+		return link_type;
+	}
+
+	k_mutex_lock(&capture_lock, K_FOREVER);
+
+	if (net_capture_is_enabled(iface)) {
+		ret = -EALREADY;
+		goto out;
+	}
+
+	capture = capture_find(NULL);
+	if (!capture) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	/* Packets can be left over by producers which found the interface
+	 * just before it was disabled.
+	 */
+	ring_reset(capture);
+
+	if (filter) {
+		capture->filter = *filter;
+	} else {
+		capture->filter.count = 0U;
+	}
+
+	capture->link_type = link_type;
+	capture->copy = (link_type == LINKTYPE_IEEE802_15_4_NOFCS);
+	capture->idb_id = -1;
+
+	atomic_clear(&capture->captured);
+	atomic_clear(&capture->filtered);
+	atomic_clear(&capture->dropped);
+
+	capture->iface = iface;
+
+	if (!capture_thread_started) {
+		k_thread_create(&capture_thread_data, capture_stack,
+				K_THREAD_STACK_SIZEOF(capture_stack),
+				(k_thread_entry_t)capture_thread,
+				NULL, NULL, NULL,
+				K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
+		k_thread_name_set(&capture_thread_data, "net_capture");
+
+		capture_thread_started = true;
+	}
+
+	net_if_flag_set(iface, NET_IF_CAPTURE);
+
+	NET_DBG("Capturing iface %p, link type %d", iface, link_type);
+
+out:
+	k_mutex_unlock(&capture_lock);
+
+	return ret;
+}
+
+int net_capture_disable(struct net_if *iface)
+{
+	struct capture *capture;
+	int ret = 0;
+
+	k_mutex_lock(&capture_lock, K_FOREVER);
+
+	capture = capture_find(iface);
+	if (!capture) {
+		ret = -EALREADY;
+		goto out;
+	}
+
+	net_if_flag_clear(iface, NET_IF_CAPTURE);
+
+	drain(capture);
+
+	capture->iface = NULL;
+
+	NET_DBG("Stopped capturing iface %p", iface);
+
+out:
+	k_mutex_unlock(&capture_lock);
+
+	return ret;
+}
+
+int net_capture_get_stats(struct net_if *iface,
+			  struct net_capture_stats *stats)
+{
+	struct capture *capture = capture_find(iface);
+
+	if (!capture) {
+		return -ENOENT;
+	}
+
+	stats->captured = atomic_get(&capture->captured);
+	stats->filtered = atomic_get(&capture->filtered);
+	stats->dropped = atomic_get(&capture->dropped);
+
+	return 0;
+}
+
+void net_capture_set_backend(const struct net_capture_backend *new_backend)
+{
+	int i;
+
+	k_mutex_lock(&capture_lock, K_FOREVER);
+
+	backend = new_backend;
+
+	/* The new output starts with its own section */
+	output_open = false;
+
+	for (i = 0; i < ARRAY_SIZE(captures); i++) {
+		captures[i].idb_id = -1;
+	}
+
+	k_mutex_unlock(&capture_lock);
+}
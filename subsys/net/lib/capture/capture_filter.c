@@ -0,0 +1,542 @@
+/** @file
+ * @brief Network packet capture filters
+ *
+ * A filter expression is compiled to a program in postfix order, each
+ * primitive pushing its result to a stack of booleans and each operator
+ * combining the results on top of it. The headers of a packet are decoded
+ * once, before the program is run on them.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_capture, CONFIG_NET_CAPTURE_LOG_LEVEL);
+
+#include <kernel.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <misc/byteorder.h>
+
+#include <net/net_core.h>
+#include <net/net_ip.h>
+#include <net/ethernet.h>
+#include <net/buf.h>
+#include <net/capture.h>
+
+#include "capture_internal.h"
+
+enum capture_op {
+	OP_AND,
+	OP_OR,
+	OP_NOT,
+	/* Network protocol, as an Ethernet protocol type */
+	OP_NET_PROTO,
+	/* IP protocol */
+	OP_PROTO,
+	OP_HOST,
+	OP_PORT,
+	OP_LESS,
+	OP_GREATER,
+};
+
+#define DIR_SRC BIT(0)
+#define DIR_DST BIT(1)
+#define DIR_ANY (DIR_SRC | DIR_DST)
+
+/* Long enough for an Ethernet header with a VLAN tag, an IPv4 header
+ * with options and the ports.
+ */
+#define MAX_HDR_LEN 96
+
+/* The results of the program are stacked as bits */
+#define MAX_DEPTH 32
+
+BUILD_ASSERT_MSG(NET_CAPTURE_FILTER_MAX_INSNS <= MAX_DEPTH,
+		 "Filter programs too long for the evaluation stack");
+
+struct keyword {
+	const char *name;
+	u8_t op;
+	u16_t value;
+};
+
+static const struct keyword keywords[] = {
+	{ "ip", OP_NET_PROTO, NET_ETH_PTYPE_IP },
+	{ "ip6", OP_NET_PROTO, NET_ETH_PTYPE_IPV6 },
+	{ "arp", OP_NET_PROTO, NET_ETH_PTYPE_ARP },
+	{ "tcp", OP_PROTO, IPPROTO_TCP },
+	{ "udp", OP_PROTO, IPPROTO_UDP },
+	{ "icmp", OP_PROTO, IPPROTO_ICMP },
+	{ "icmp6", OP_PROTO, IPPROTO_ICMPV6 },
+	{ "less", OP_LESS, 0 },
+	{ "greater", OP_GREATER, 0 },
+};
+
+struct parser {
+	const char *pos;
+	char token[INET6_ADDRSTRLEN];
+	struct net_capture_filter *filter;
+};
+
+/* Reads the next token, returns false at the end of the expression */
+static bool next_token(struct parser *p)
+{
+	size_t len = 0;
+
+	while (*p->pos == ' ' || *p->pos == '\t') {
+		p->pos++;
+	}
+
+	if (!*p->pos) {
+		p->token[0] = '\0';
+		return false;
+	}
+
+	if (strchr("()!", *p->pos)) {
+		len = 1;
+	} else if (!strncmp(p->pos, "&&", 2) || !strncmp(p->pos, "||", 2)) {
+		len = 2;
+	} else {
+		while (p->pos[len] && !strchr(" \t()!&|", p->pos[len])) {
+			len++;
+		}
+	}
+
+	/* Truncated tokens are invalid anyway */
+	len = MIN(len, sizeof(p->token) - 1);
+
+	memcpy(p->token, p->pos, len);
+	p->token[len] = '\0';
+	p->pos += len;
+
+	return true;
+}
+
+/* Consumes the next token if it is one of the given words */
+static bool accept(struct parser *p, const char *word, const char *alias)
+{
+	const char *pos = p->pos;
+
+	if (next_token(p) &&
+	    (!strcmp(p->token, word) || (alias && !strcmp(p->token, alias)))) {
+		return true;
+	}
+
+	p->pos = pos;
+
+	return false;
+}
+
+static struct net_capture_insn *emit(struct parser *p, u8_t op)
+{
+	struct net_capture_insn *insn;
+
+	if (p->filter->count >= ARRAY_SIZE(p->filter->insns)) {
+		return NULL;
+	}
+
+	insn = &p->filter->insns[p->filter->count++];
+	(void)memset(insn, 0, sizeof(*insn));
+	insn->op = op;
+
+	return insn;
+}
+
+static int parse_number(struct parser *p, u16_t *value)
+{
+	unsigned long number;
+	char *end;
+
+	if (!next_token(p)) {
+		return -EINVAL;
+	}
+
+	number = strtoul(p->token, &end, 10);
+	if (*end || end == p->token || number > UINT16_MAX) {
+		return -EINVAL;
+	}
+
+	*value = number;
+
+	return 0;
+}
+
+static int parse_primitive(struct parser *p)
+{
+	struct net_capture_insn *insn;
+	u8_t dir = DIR_ANY;
+	int i;
+
+	if (accept(p, "src", NULL)) {
+		dir = DIR_SRC;
+	} else if (accept(p, "dst", NULL)) {
+		dir = DIR_DST;
+	}
+
+	if (accept(p, "host", NULL)) {
+		insn = emit(p, OP_HOST);
+		if (!insn) {
+			return -ENOMEM;
+		}
+
+		insn->dir = dir;
+
+		if (!next_token(p)) {
+			return -EINVAL;
+		}
+
+		insn->family = strchr(p->token, ':') ? AF_INET6 : AF_INET;
+
+		return net_addr_pton(insn->family, p->token,
+				     &insn->in6_addr) ? -EINVAL : 0;
+	}
+
+	if (accept(p, "port", NULL)) {
+		insn = emit(p, OP_PORT);
+		if (!insn) {
+			return -ENOMEM;
+		}
+
+		insn->dir = dir;
+
+		return parse_number(p, &insn->value);
+	}
+
+	if (dir != DIR_ANY || !next_token(p)) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(keywords); i++) {
+		if (strcmp(p->token, keywords[i].name)) {
+			continue;
+		}
+
+		insn = emit(p, keywords[i].op);
+		if (!insn) {
+			return -ENOMEM;
+		}
+
+		if (insn->op == OP_LESS || insn->op == OP_GREATER) {
+			return parse_number(p, &insn->value);
+		}
+
+		insn->value = keywords[i].value;
+
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+static int parse_or(struct parser *p);
+
+static int parse_not(struct parser *p)
+{
+	int ret;
+
+	if (accept(p, "not", "!")) {
+		ret = parse_not(p);
+		if (ret < 0) {
+			return ret;
+		}
+
+		return emit(p, OP_NOT) ? 0 : -ENOMEM;
+	}
+
+	if (accept(p, "(", NULL)) {
+		ret = parse_or(p);
+		if (ret < 0) {
+			return ret;
+		}
+
+		return accept(p, ")", NULL) ? 0 : -EINVAL;
+	}
+
+	return parse_primitive(p);
+}
+
+/* Tells if the next token ends a sequence of primitives */
+static bool end_of_and(struct parser *p)
+{
+	const char *pos = p->pos;
+	bool end;
+
+	end = !next_token(p) || !strcmp(p->token, ")") ||
+		!strcmp(p->token, "or") || !strcmp(p->token, "||");
+
+	p->pos = pos;
+
+	return end;
+}
+
+static int parse_and(struct parser *p)
+{
+	int ret;
+
+	ret = parse_not(p);
+	if (ret < 0) {
+		return ret;
+	}
+
+	while (accept(p, "and", "&&") || !end_of_and(p)) {
+		ret = parse_not(p);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (!emit(p, OP_AND)) {
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+static int parse_or(struct parser *p)
+{
+	int ret;
+
+	ret = parse_and(p);
+	if (ret < 0) {
+		return ret;
+	}
+
+	while (accept(p, "or", "||")) {
+		ret = parse_and(p);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (!emit(p, OP_OR)) {
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+int net_capture_filter_compile(const char *expr,
+			       struct net_capture_filter *filter)
+{
+	struct parser p = {
+		.pos = expr,
+		.filter = filter,
+	};
+	int ret;
+
+	filter->count = 0U;
+
+	if (end_of_and(&p)) {
+		/* Empty, matches everything */
+		return next_token(&p) ? -EINVAL : 0;
+	}
+
+	ret = parse_or(&p);
+	if (ret == 0 && next_token(&p)) {
+		/* Unbalanced parenthesis */
+		ret = -EINVAL;
+	}
+
+	if (ret < 0) {
+		NET_DBG("Invalid filter \"%s\" (%d)", expr, ret);
+		filter->count = 0U;
+	}
+
+	return ret;
+}
+
+struct pkt_info {
+	size_t len;
+	u16_t net_proto;
+	sa_family_t family;
+	u8_t proto;
+	bool has_ports;
+	const u8_t *src;
+	const u8_t *dst;
+	u16_t src_port;
+	u16_t dst_port;
+};
+
+static void decode_ip(const u8_t *hdr, size_t hdr_len, size_t offset,
+		      struct pkt_info *info)
+{
+	size_t l4_offset;
+
+	if (info->net_proto == NET_ETH_PTYPE_IP &&
+	    hdr_len >= offset + sizeof(struct net_ipv4_hdr)) {
+		info->family = AF_INET;
+		info->proto = hdr[offset + 9];
+		info->src = &hdr[offset + 12];
+		info->dst = &hdr[offset + 16];
+
+		/* The ports are only in the first fragment */
+		if ((hdr[offset + 6] & 0x1f) || hdr[offset + 7]) {
+			return;
+		}
+
+		l4_offset = offset + (hdr[offset] & 0x0f) * 4U;
+	} else if (info->net_proto == NET_ETH_PTYPE_IPV6 &&
+		   hdr_len >= offset + sizeof(struct net_ipv6_hdr)) {
+		info->family = AF_INET6;
+		info->proto = hdr[offset + 6];
+		info->src = &hdr[offset + 8];
+		info->dst = &hdr[offset + 24];
+
+		/* Extension headers are not followed */
+		l4_offset = offset + sizeof(struct net_ipv6_hdr);
+	} else {
+		return;
+	}
+
+	if ((info->proto == IPPROTO_TCP || info->proto == IPPROTO_UDP) &&
+	    hdr_len >= l4_offset + 2 * sizeof(u16_t)) {
+		info->has_ports = true;
+		info->src_port = sys_get_be16(&hdr[l4_offset]);
+		info->dst_port = sys_get_be16(&hdr[l4_offset + 2]);
+	}
+}
+
+static void decode(int link_type, const u8_t *hdr, size_t hdr_len,
+		   struct pkt_info *info)
+{
+	size_t offset;
+
+	switch (link_type) {
+	case LINKTYPE_ETHERNET:
+		if (hdr_len < sizeof(struct net_eth_hdr)) {
+			return;
+		}
+
+		info->net_proto = sys_get_be16(&hdr[12]);
+		offset = sizeof(struct net_eth_hdr);
+
+		if (info->net_proto == NET_ETH_PTYPE_VLAN && hdr_len >= 18) {
+			info->net_proto = sys_get_be16(&hdr[16]);
+			offset = 18;
+		}
+
+		break;
+
+	case LINKTYPE_RAW:
+		if (!hdr_len) {
+			return;
+		}
+
+		if ((hdr[0] >> 4) == 4) {
+			info->net_proto = NET_ETH_PTYPE_IP;
+		} else if ((hdr[0] >> 4) == 6) {
+			info->net_proto = NET_ETH_PTYPE_IPV6;
+		}
+
+		offset = 0;
+
+		break;
+
+	default:
+		/* The 6LoWPAN compressed headers are not decoded, only the
+		 * length of the frames can be matched.
+		 */
+		return;
+	}
+
+	decode_ip(hdr, hdr_len, offset, info);
+}
+
+static bool match_host(const struct net_capture_insn *insn,
+		       const struct pkt_info *info)
+{
+	size_t len = insn->family == AF_INET6 ?
+		sizeof(struct in6_addr) : sizeof(struct in_addr);
+
+	if (insn->family != info->family) {
+		return false;
+	}
+
+	return ((insn->dir & DIR_SRC) &&
+		!memcmp(info->src, &insn->in6_addr, len)) ||
+		((insn->dir & DIR_DST) &&
+		 !memcmp(info->dst, &insn->in6_addr, len));
+}
+
+static bool match_port(const struct net_capture_insn *insn,
+		       const struct pkt_info *info)
+{
+	if (!info->has_ports) {
+		return false;
+	}
+
+	return ((insn->dir & DIR_SRC) && info->src_port == insn->value) ||
+		((insn->dir & DIR_DST) && info->dst_port == insn->value);
+}
+
+bool net_capture_filter_match(const struct net_capture_filter *filter,
+			      struct net_if *iface, struct net_buf *buf,
+			      size_t len)
+{
+	const struct net_capture_insn *insn;
+	struct pkt_info info = {
+		.len = len,
+	};
+	u8_t hdr[MAX_HDR_LEN];
+	u32_t stack = 0U;
+	size_t hdr_len;
+	bool result;
+	int i;
+
+	if (!filter->count) {
+		return true;
+	}
+
+	hdr_len = net_buf_linearize(hdr, sizeof(hdr), buf, 0,
+				    MIN(len, sizeof(hdr)));
+
+	decode(net_capture_link_type(iface), hdr, hdr_len, &info);
+
+	for (i = 0; i < filter->count; i++) {
+		insn = &filter->insns[i];
+
+		switch (insn->op) {
+		case OP_AND:
+			result = (stack & BIT(1)) && (stack & BIT(0));
+			stack >>= 2;
+			break;
+		case OP_OR:
+			result = (stack & BIT(1)) || (stack & BIT(0));
+			stack >>= 2;
+			break;
+		case OP_NOT:
+			result = !(stack & BIT(0));
+			stack >>= 1;
+			break;
+		case OP_NET_PROTO:
+			result = info.net_proto == insn->value;
+			break;
+		case OP_PROTO:
+			result = info.family && info.proto == insn->value;
+			break;
+		case OP_HOST:
+			result = match_host(insn, &info);
+			break;
+		case OP_PORT:
+			result = match_port(insn, &info);
+			break;
+		case OP_LESS:
+			result = info.len <= insn->value;
+			break;
+		case OP_GREATER:
+			result = info.len >= insn->value;
+			break;
+		default:
+			return false;
+		}
+
+		stack = (stack << 1) | result;
+	}
+
+	return stack & BIT(0);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Network packet capture internals
+ */
+
+#ifndef __NET_CAPTURE_INTERNAL_H
+#define __NET_CAPTURE_INTERNAL_H
+
+#include <net/net_if.h>
+#include <net/net_l2.h>
+#include <net/capture.h>
+
+/* pcapng link types, see http://www.tcpdump.org/linktypes.html */
+#define LINKTYPE_ETHERNET		1
+#define LINKTYPE_RAW			101
+#define LINKTYPE_IEEE802_15_4_NOFCS	230
+
+/* Returns the link type of the packets of an interface, or -ENOTSUP */
+static inline int net_capture_link_type(struct net_if *iface)
+{
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET)) {
+		return LINKTYPE_ETHERNET;
+	}
+#endif
+
+#if defined(CONFIG_NET_L2_IEEE802154)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(IEEE802154)) {
+		return LINKTYPE_IEEE802_15_4_NOFCS;
+	}
+#endif
+
+#if defined(CONFIG_NET_L2_DUMMY)
+	/* IP only interfaces, such as the loopback */
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(DUMMY)) {
+		return LINKTYPE_RAW;
+	}
+#endif
+
+	return -ENOTSUP;
+}
+
+#if !defined(CONFIG_NET_CAPTURE_BACKEND_NONE)
+/* Backend selected in Kconfig */
+extern const struct net_capture_backend net_capture_default_backend;
+#endif
+
+#endif /* __NET_CAPTURE_INTERNAL_H */
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Network packet capture to a host file
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_capture, CONFIG_NET_CAPTURE_LOG_LEVEL);
+
+#include <kernel.h>
+#include <errno.h>
+
+#include <net/net_core.h>
+#include <net/capture.h>
+
+#include "cmdline.h"
+#include "soc.h"
+
+#include "capture_internal.h"
+#include "capture_native_posix_priv.h"
+
+static char *capture_file = CONFIG_NET_CAPTURE_FILE;
+static int capture_fd = -1;
+
+static int native_posix_open(void)
+{
+	capture_fd = capture_file_open(capture_file);
+	if (capture_fd < 0) {
+		NET_ERR("Cannot open capture file %s (%d)", capture_file,
+			capture_fd);
+		return capture_fd;
+	}
+
+	return 0;
+}
+
+static int native_posix_write(const void *data, size_t len)
+{
+	return capture_file_write(capture_fd, data, len);
+}
+
+const struct net_capture_backend net_capture_default_backend = {
+	.open = native_posix_open,
+	.write = native_posix_write,
+};
+
+static void capture_options(void)
+{
+	static struct args_struct_t capture_options[] = {
+		{ .manual = false,
+		  .is_mandatory = false,
+		  .is_switch = false,
+		  .option = "capture_file",
+		  .name = "path",
+		  .type = 's',
+		  .dest = (void *)&capture_file,
+		  .call_when_found = NULL,
+		  .descript = "File the captured network packets are written "
+			      "to, in pcapng format (default: "
+			      CONFIG_NET_CAPTURE_FILE ")" },
+		ARG_TABLE_ENDMARKER
+	};
+
+	native_add_command_line_opts(capture_options);
+}
+
+NATIVE_TASK(capture_options, PRE_BOOT_1, 10);
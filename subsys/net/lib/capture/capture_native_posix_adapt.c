@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * Routines writing the capture file on the host. Those are placed in
+ * separate file because there is naming conflicts between host and zephyr
+ * network stacks.
+ */
+
+/* Host include files */
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "capture_native_posix_priv.h"
+
+int capture_file_open(const char *path)
+{
+	int fd;
+
+	/* Opening a named pipe waits for its reader, e.g. Wireshark */
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return -errno;
+	}
+
+	return fd;
+}
+
+int capture_file_write(int fd, const void *buf, size_t buf_len)
+{
+	const char *data = buf;
+	ssize_t ret;
+
+	while (buf_len) {
+		ret = write(fd, data, buf_len);
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			return -errno;
+		}
+
+		data += ret;
+		buf_len -= ret;
+	}
+
+	return 0;
+}
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Private functions for the native posix capture backend.
+ */
+
+#ifndef ZEPHYR_SUBSYS_NET_LIB_CAPTURE_NATIVE_POSIX_PRIV_H_
+#define ZEPHYR_SUBSYS_NET_LIB_CAPTURE_NATIVE_POSIX_PRIV_H_
+
+int capture_file_open(const char *path);
+int capture_file_write(int fd, const void *buf, size_t buf_len);
+
+#endif /* ZEPHYR_SUBSYS_NET_LIB_CAPTURE_NATIVE_POSIX_PRIV_H_ */
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Network packet capture to a Segger J-Link RTT up-buffer
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_capture, CONFIG_NET_CAPTURE_LOG_LEVEL);
+
+#include <kernel.h>
+#include <errno.h>
+#include <SEGGER_RTT.h>
+
+#include <net/net_core.h>
+#include <net/capture.h>
+
+#include "capture_internal.h"
+
+static u8_t rtt_buf[CONFIG_NET_CAPTURE_RTT_BUFFER_SIZE];
+
+static int rtt_open(void)
+{
+	/* A block written partially would corrupt the stream, so the
+	 * capture thread waits for the host to read the buffer.
+	 */
+	SEGGER_RTT_ConfigUpBuffer(CONFIG_NET_CAPTURE_RTT_BUFFER, "Capture",
+				  rtt_buf, sizeof(rtt_buf),
+				  SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL);
+
+	return 0;
+}
+
+static int rtt_write(const void *data, size_t len)
+{
+	SEGGER_RTT_Write(CONFIG_NET_CAPTURE_RTT_BUFFER, data, len);
+
+	return 0;
+}
+
+const struct net_capture_backend net_capture_default_backend = {
+	.open = rtt_open,
+	.write = rtt_write,
+};
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Network packet capture to a UART
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_capture, CONFIG_NET_CAPTURE_LOG_LEVEL);
+
+#include <kernel.h>
+#include <device.h>
+#include <errno.h>
+#include <uart.h>
+
+#include <net/net_core.h>
+#include <net/capture.h>
+
+#include "capture_internal.h"
+
+static struct device *capture_uart;
+
+static int uart_open(void)
+{
+	capture_uart = device_get_binding(CONFIG_NET_CAPTURE_UART_DEV_NAME);
+	if (!capture_uart) {
+		NET_ERR("Cannot find %s", CONFIG_NET_CAPTURE_UART_DEV_NAME);
+		return -ENODEV;
+	}
+
+	return 0;
+}
+
+static int uart_write(const void *data, size_t len)
+{
+	const u8_t *ptr = data;
+
+	while (len--) {
+		uart_poll_out(capture_uart, *ptr++);
+	}
+
+	return 0;
+}
+
+const struct net_capture_backend net_capture_default_backend = {
+	.open = uart_open,
+	.write = uart_write,
+};
@@ -45,6 +45,25 @@ LOG_MODULE_REGISTER(net_coap, CONFIG_COAP_LOG_LEVEL);
 
 #define BASIC_HEADER_SIZE	4
 
+static void index_option(struct coap_packet *cpkt, u16_t num, u16_t offset,
+			 u16_t len)
+{
+#if COAP_OPTION_INDEX_SIZE > 0
+	struct coap_option_ref *ref;
+
+	if (cpkt->opt_count == COAP_OPTION_INDEX_SIZE) {
+		/* Too many options, they are found by parsing them */
+		cpkt->opt_indexed = false;
+		return;
+	}
+
+	ref = &cpkt->opt_index[cpkt->opt_count++];
+	ref->num = num;
+	ref->offset = offset;
+	ref->len = len;
+#endif
+}
+
 static inline bool append_u8(struct coap_packet *cpkt, u8_t data)
 {
 	if (!cpkt) {
@@ -109,6 +128,9 @@ int coap_packet_init(struct coap_packet *cpkt, u8_t *data,
 	cpkt->offset = 0U;
 	cpkt->max_len = max_len;
 	cpkt->delta = 0U;
+#if COAP_OPTION_INDEX_SIZE > 0
+	cpkt->opt_indexed = true;
+#endif
 
 	hdr = (ver & 0x3) << 6;
 	hdr |= (type & 0x3) << 4;
@@ -263,6 +285,8 @@ int coap_packet_append_option(struct coap_packet *cpkt, u16_t code,
 	cpkt->opt_len += r;
 	cpkt->delta += code;
 
+	index_option(cpkt, cpkt->delta, cpkt->offset - len, len);
+
 	return 0;
 }
 
@@ -424,7 +448,7 @@ static int decode_delta(u8_t *data, u16_t offset, u16_t *pos, u16_t max_len,
 
 static int parse_option(u8_t *data, u16_t offset, u16_t *pos,
 			u16_t max_len, u16_t *opt_delta, u16_t *opt_len,
-			struct coap_option *option)
+			struct coap_option *option, u16_t *value_len)
 {
 	u16_t hdr_len;
 	u16_t delta;
@@ -481,6 +505,10 @@ static int parse_option(u8_t *data, u16_t offset, u16_t *pos,
 	*opt_delta += delta;
 	*opt_len += len;
 
+	if (value_len) {
+		*value_len = len;
+	}
+
 	if (r == 0) {
 		if (len == 0U) {
 			return r;
@@ -549,6 +577,10 @@ int coap_packet_parse(struct coap_packet *cpkt, u8_t *data, u16_t len,
 	cpkt->opt_len = 0U;
 	cpkt->hdr_len = 0U;
 	cpkt->delta = 0U;
+#if COAP_OPTION_INDEX_SIZE > 0
+	cpkt->opt_count = 0U;
+	cpkt->opt_indexed = true;
+#endif
 
 	/* Token lengths 9-15 are reserved. */
 	tkl = cpkt->data[0] & 0x0f;
@@ -573,13 +605,23 @@ int coap_packet_parse(struct coap_packet *cpkt, u8_t *data, u16_t len,
 
 	while (1) {
 		struct coap_option *option;
+		u16_t start = offset;
+		u16_t value_len;
 
 		option = num < opt_num ? &options[num++] : NULL;
 		ret = parse_option(cpkt->data, offset, &offset, cpkt->max_len,
-				   &delta, &opt_len, option);
+				   &delta, &opt_len, option, &value_len);
 		if (ret < 0) {
 			return ret;
-		} else if (ret == 0) {
+		}
+
+		/* Index the options while they are parsed anyway */
+		if (cpkt->data[start] != COAP_MARKER) {
+			index_option(cpkt, delta, offset - value_len,
+				     value_len);
+		}
+
+		if (ret == 0) {
 			break;
 		}
 	}
@@ -591,6 +633,40 @@ int coap_packet_parse(struct coap_packet *cpkt, u8_t *data, u16_t len,
 	return 0;
 }
 
+#if COAP_OPTION_INDEX_SIZE > 0
+static int find_indexed_options(const struct coap_packet *cpkt, u16_t code,
+				struct coap_option *options, u16_t veclen)
+{
+	const struct coap_option_ref *ref;
+	u16_t num = 0U;
+	u8_t i;
+
+	for (i = 0U; i < cpkt->opt_count && num < veclen; i++) {
+		ref = &cpkt->opt_index[i];
+
+		/* The options are in ascending order */
+		if (ref->num < code) {
+			continue;
+		} else if (ref->num > code) {
+			break;
+		}
+
+		if (ref->len > sizeof(options[num].value)) {
+			NET_ERR("%u is > sizeof(coap_option->value)(%zu)!",
+				ref->len, sizeof(options[num].value));
+			return -EINVAL;
+		}
+
+		options[num].delta = code;
+		options[num].len = ref->len;
+		memcpy(options[num].value, cpkt->data + ref->offset, ref->len);
+		num++;
+	}
+
+	return num;
+}
+#endif
+
 int coap_find_options(const struct coap_packet *cpkt, u16_t code,
 		      struct coap_option *options, u16_t veclen)
 {
@@ -600,6 +676,12 @@ int coap_find_options(const struct coap_packet *cpkt, u16_t code,
 	u8_t num;
 	int r;
 
+#if COAP_OPTION_INDEX_SIZE > 0
+	if (cpkt->opt_indexed) {
+		return find_indexed_options(cpkt, code, options, veclen);
+	}
+#endif
+
 	offset = cpkt->hdr_len;
 	opt_len = 0U;
 	delta = 0U;
@@ -608,7 +690,7 @@ int coap_find_options(const struct coap_packet *cpkt, u16_t code,
 	while (delta <= code && num < veclen) {
 		r = parse_option(cpkt->data, offset, &offset,
 				 cpkt->max_len, &delta, &opt_len,
-				 &options[num]);
+				 &options[num], NULL);
 		if (r < 0) {
 			return -EINVAL;
 		}
@@ -834,6 +916,226 @@ int coap_handle_request(struct coap_packet *cpkt,
 	return -ENOENT;
 }
 
+/* Compare the last path segment of a node to a request path segment */
+static int router_segment_cmp(const struct coap_router_node *node,
+			      const char *segment, u16_t len)
+{
+	if (node->len != len) {
+		return node->len < len ? -1 : 1;
+	}
+
+	return memcmp(node->path[node->depth - 1], segment, len);
+}
+
+static bool router_path_match(const struct coap_router_node *node,
+			      const char * const *path)
+{
+	u8_t i;
+
+	for (i = 0U; i < node->depth; i++) {
+		if (!path[i] || strcmp(path[i], node->path[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Add a child for the next path segment of a resource, unless there
+ * is already one. The children of the node are the last nodes in use.
+ */
+static int router_add_child(struct coap_router *router,
+			    struct coap_router_node *node,
+			    const char * const *path, u16_t max_nodes)
+{
+	const char *segment = path[node->depth];
+	u16_t len = strlen(segment);
+	u16_t i;
+	int r;
+
+	for (i = node->first_child; i < router->node_count; i++) {
+		r = router_segment_cmp(&router->nodes[i], segment, len);
+		if (r == 0) {
+			return 0;
+		} else if (r > 0) {
+			break;
+		}
+	}
+
+	if (router->node_count == max_nodes) {
+		return -ENOMEM;
+	}
+
+	memmove(&router->nodes[i + 1], &router->nodes[i],
+		(router->node_count - i) * sizeof(router->nodes[0]));
+	router->node_count++;
+
+	memset(&router->nodes[i], 0, sizeof(router->nodes[0]));
+	router->nodes[i].path = path;
+	router->nodes[i].len = len;
+	router->nodes[i].depth = node->depth + 1;
+
+	return 0;
+}
+
+int coap_router_init(struct coap_router *router,
+		     struct coap_resource *resources,
+		     struct coap_router_node *nodes, u16_t max_nodes)
+{
+	struct coap_router_node *node;
+	struct coap_resource *resource;
+	u16_t i;
+	int r;
+
+	if (!router || !nodes || !max_nodes) {
+		return -EINVAL;
+	}
+
+	router->nodes = nodes;
+	router->node_count = 1U;
+	memset(&nodes[0], 0, sizeof(nodes[0]));
+
+	/* The nodes are created breadth first, so the children of each
+	 * node are created in one go after all the nodes before it.
+	 */
+	for (i = 0U; i < router->node_count; i++) {
+		node = &nodes[i];
+		node->first_child = router->node_count;
+
+		for (resource = resources; resource && resource->path;
+		     resource++) {
+			if (!router_path_match(node, resource->path)) {
+				continue;
+			}
+
+			if (!resource->path[node->depth]) {
+				/* The first matching resource is used, as in
+				 * coap_handle_request().
+				 */
+				if (!node->resource) {
+					node->resource = resource;
+				}
+
+				continue;
+			}
+
+			if (node->depth == UINT8_MAX) {
+				return -EINVAL;
+			}
+
+			r = router_add_child(router, node, resource->path,
+					     max_nodes);
+			if (r < 0) {
+				return r;
+			}
+		}
+
+		node->child_count = router->node_count - node->first_child;
+	}
+
+	NET_DBG("%u nodes for the resources", router->node_count);
+
+	return 0;
+}
+
+static struct coap_router_node *router_child(struct coap_router *router,
+					     struct coap_router_node *node,
+					     const char *segment, u16_t len)
+{
+	int low = node->first_child;
+	int high = node->first_child + node->child_count - 1;
+	int mid, r;
+
+	while (low <= high) {
+		mid = (low + high) / 2;
+
+		r = router_segment_cmp(&router->nodes[mid], segment, len);
+		if (r == 0) {
+			return &router->nodes[mid];
+		} else if (r < 0) {
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
+	}
+
+	return NULL;
+}
+
+static struct coap_resource *router_find(struct coap_router *router,
+					 struct coap_packet *cpkt,
+					 struct coap_option *options,
+					 u8_t opt_num)
+{
+	struct coap_router_node *node = &router->nodes[0];
+	u8_t i;
+
+#if COAP_OPTION_INDEX_SIZE > 0
+	if (cpkt->opt_indexed) {
+		const struct coap_option_ref *ref;
+
+		for (i = 0U; i < cpkt->opt_count; i++) {
+			ref = &cpkt->opt_index[i];
+
+			if (ref->num < COAP_OPTION_URI_PATH) {
+				continue;
+			} else if (ref->num > COAP_OPTION_URI_PATH) {
+				break;
+			}
+
+			node = router_child(router, node,
+					    (char *)cpkt->data + ref->offset,
+					    ref->len);
+			if (!node) {
+				return NULL;
+			}
+		}
+
+		return node->resource;
+	}
+#endif
+
+	for (i = 0U; i < opt_num; i++) {
+		if (options[i].delta != COAP_OPTION_URI_PATH) {
+			continue;
+		}
+
+		node = router_child(router, node, (char *)options[i].value,
+				    options[i].len);
+		if (!node) {
+			return NULL;
+		}
+	}
+
+	return node->resource;
+}
+
+int coap_router_handle_request(struct coap_router *router,
+			       struct coap_packet *cpkt,
+			       struct coap_option *options,
+			       u8_t opt_num,
+			       struct sockaddr *addr, socklen_t addr_len)
+{
+	struct coap_resource *resource;
+	coap_method_t method;
+
+	if (!is_request(cpkt)) {
+		return 0;
+	}
+
+	resource = router_find(router, cpkt, options, opt_num);
+	if (!resource) {
+		return -ENOENT;
+	}
+
+	method = method_from_code(resource, coap_header_get_code(cpkt));
+	if (!method) {
+		return -EPERM;
+	}
+
+	return method(resource, cpkt, addr, addr_len);
+}
+
 int coap_block_transfer_init(struct coap_block_context *ctx,
 			      enum coap_block_size block_size,
 			      size_t total_size)
@@ -139,6 +139,83 @@ int dns_unpack_answer(struct dns_msg_t *dns_msg, int dname_ptr, u32_t *ttl)
 	return 0;
 }
 
+/* Returns the offset following the name at offset */
+static int dns_skip_name(const u8_t *msg, u16_t size, int offset)
+{
+	while (offset < size) {
+		u8_t len = msg[offset];
+
+		if ((len & NS_CMPRSFLGS) == NS_CMPRSFLGS) {
+			/* A pointer ends the name */
+			offset += 2;
+			break;
+		}
+
+		offset += DNS_LABEL_LEN_SIZE + len;
+		if (len == 0U) {
+			break;
+		}
+	}
+
+	return offset <= size ? offset : -ENOMEM;
+}
+
+int dns_unpack_soa_minimum(struct dns_msg_t *dns_msg, u32_t *ttl)
+{
+	const u8_t *msg = dns_msg->msg;
+	u16_t size = dns_msg->msg_size;
+	int offset = dns_msg->answer_offset;
+	int count = dns_header_nscount(dns_msg->msg);
+	int rdata;
+	u32_t minimum;
+
+	while (count-- > 0) {
+		u8_t *rr;
+		u16_t rdlength;
+
+		/* type, class, ttl and rdlength follow the name */
+		offset = dns_skip_name(msg, size, offset);
+		rdata = offset + DNS_QTYPE_LEN + DNS_QCLASS_LEN + DNS_TTL_LEN +
+			DNS_RDLENGTH_LEN;
+		if (offset < 0 || rdata > size) {
+			return -ENOMEM;
+		}
+
+		rr = dns_msg->msg + offset;
+		rdlength = dns_answer_rdlength(0, rr);
+		if (rdata + rdlength > size) {
+			return -ENOMEM;
+		}
+
+		offset = rdata + rdlength;
+
+		if (dns_answer_type(0, rr) != DNS_RR_TYPE_SOA ||
+		    dns_answer_class(0, rr) != DNS_CLASS_IN) {
+			continue;
+		}
+
+		/* MNAME and RNAME, then SERIAL, REFRESH, RETRY, EXPIRE and
+		 * MINIMUM
+		 */
+		rdata = dns_skip_name(msg, offset, rdata);
+		if (rdata >= 0) {
+			rdata = dns_skip_name(msg, offset, rdata);
+		}
+
+		if (rdata < 0 || rdata + 5 * DNS_TTL_LEN > offset) {
+			return -ENOMEM;
+		}
+
+		minimum = ntohl(UNALIGNED_GET((u32_t *)(msg + rdata +
+							4 * DNS_TTL_LEN)));
+		*ttl = MIN((u32_t)dns_answer_ttl(0, rr), minimum);
+
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
 int dns_unpack_response_header(struct dns_msg_t *msg, int src_id)
 {
 	u8_t *dns_header;
@@ -86,6 +86,7 @@ enum dns_rr_type {
 	DNS_RR_TYPE_INVALID = 0,
 	DNS_RR_TYPE_A	= 1,		/* IPv4  */
 	DNS_RR_TYPE_CNAME = 5,		/* CNAME */
+	DNS_RR_TYPE_SOA = 6,		/* SOA   */
 	DNS_RR_TYPE_AAAA = 28		/* IPv6  */
 };
 
@@ -287,6 +288,19 @@ int dns_msg_pack_qname(u16_t *len, u8_t *buf, u16_t size,
  */
 int dns_unpack_answer(struct dns_msg_t *dns_msg, int dname_ptr, u32_t *ttl);
 
+/**
+ * @brief Finds the negative caching TTL in the authority section
+ *
+ * @param dns_msg Structure, answer_offset must point past the last
+ *        answer.
+ * @param ttl Minimum of the TTL and of the MINIMUM field of the SOA
+ *        record, see RFC 2308, 5 - Caching Negative Answers.
+ * @retval 0 on success
+ * @retval -ENOENT if there is no SOA record
+ * @retval -ENOMEM if the authority section is truncated
+ */
+int dns_unpack_soa_minimum(struct dns_msg_t *dns_msg, u32_t *ttl);
+
 /**
  * @brief Unpacks the header's response.
  *
@@ -290,6 +290,10 @@ int dns_resolve_init(struct dns_resolve_context *ctx, const char *servers[],
 	ctx->is_used = true;
 	ctx->buf_timeout = DNS_BUF_TIMEOUT;
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	k_mutex_init(&ctx->cache_lock);
+#endif
+
 	return 0;
 }
 
@@ -320,6 +324,282 @@ static inline int get_slot_by_id(struct dns_resolve_context *ctx,
 	return -ENOENT;
 }
 
+static inline int get_slot_by_msg_id(struct dns_resolve_context *ctx,
+				     u16_t msg_id)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (ctx->queries[i].cb && ctx->queries[i].msg_id == msg_id) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+/* Pass a result to all the queries waiting for the answer to a message */
+static void dns_notify(struct dns_resolve_context *ctx, u16_t msg_id,
+		       enum dns_resolve_status status,
+		       struct dns_addrinfo *info)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (ctx->queries[i].cb && ctx->queries[i].msg_id == msg_id) {
+			ctx->queries[i].cb(status, info,
+					   ctx->queries[i].user_data);
+		}
+	}
+}
+
+/* Mark the end of the results for all the queries waiting for the
+ * answer to a message.
+ */
+static void dns_finish(struct dns_resolve_context *ctx, u16_t msg_id,
+		       enum dns_resolve_status status)
+{
+	dns_resolve_cb_t cb;
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (!ctx->queries[i].cb || ctx->queries[i].msg_id != msg_id) {
+			continue;
+		}
+
+		if (k_delayed_work_remaining_get(&ctx->queries[i].timer) > 0) {
+			k_delayed_work_cancel(&ctx->queries[i].timer);
+		}
+
+		/* The slot can be reused from the callback */
+		cb = ctx->queries[i].cb;
+		ctx->queries[i].cb = NULL;
+
+		cb(status, NULL, ctx->queries[i].user_data);
+	}
+}
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+static void dns_set_query_name(struct dns_pending_query *query,
+			       const char *name)
+{
+	size_t len = strlen(name);
+
+	if (len >= sizeof(query->name)) {
+		query->name[0] = '\0';
+		return;
+	}
+
+	memcpy(query->name, name, len + 1);
+}
+
+/* Find a pending query identical to the given one */
+static int get_slot_by_name(struct dns_resolve_context *ctx, int query_idx)
+{
+	struct dns_pending_query *query = &ctx->queries[query_idx];
+	int i;
+
+	if (!query->name[0]) {
+		return -ENOENT;
+	}
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (i == query_idx || !ctx->queries[i].cb) {
+			continue;
+		}
+
+		if (ctx->queries[i].query_type == query->query_type &&
+		    !strcmp(ctx->queries[i].name, query->name)) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static struct dns_cache_entry *dns_cache_find(struct dns_resolve_context *ctx,
+					      const char *name,
+					      enum dns_query_type type,
+					      u32_t now)
+{
+	struct dns_cache_entry *entry;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ctx->cache); i++) {
+		entry = &ctx->cache[i];
+
+		if (!entry->name[0]) {
+			continue;
+		}
+
+		if ((s32_t)(entry->expiry - now) <= 0) {
+			entry->name[0] = '\0';
+			continue;
+		}
+
+		if (entry->type == type && !strcmp(entry->name, name)) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static void dns_cache_addrinfo(struct dns_cache_entry *entry, int idx,
+			       struct dns_addrinfo *info)
+{
+	memset(info, 0, sizeof(*info));
+
+	if (entry->type == DNS_QUERY_TYPE_A) {
+		net_ipaddr_copy(&net_sin(&info->ai_addr)->sin_addr,
+				&entry->addr[idx].in_addr);
+		info->ai_family = AF_INET;
+		info->ai_addr.sa_family = AF_INET;
+		info->ai_addrlen = sizeof(struct sockaddr_in);
+	} else {
+#if defined(CONFIG_NET_IPV6)
+		net_ipaddr_copy(&net_sin6(&info->ai_addr)->sin6_addr,
+				&entry->addr[idx].in6_addr);
+		info->ai_family = AF_INET6;
+		info->ai_addr.sa_family = AF_INET6;
+		info->ai_addrlen = sizeof(struct sockaddr_in6);
+#endif
+	}
+}
+
+/* Give the results from the cache if the answer is there */
+static bool dns_cache_answer(struct dns_resolve_context *ctx,
+			     const char *name, enum dns_query_type type,
+			     dns_resolve_cb_t cb, void *user_data)
+{
+	struct dns_cache_entry *entry;
+	struct dns_cache_entry answer;
+	struct dns_addrinfo info;
+	u32_t now = k_uptime_get_32();
+	int i;
+
+	k_mutex_lock(&ctx->cache_lock, K_FOREVER);
+
+	entry = dns_cache_find(ctx, name, type, now);
+	if (entry) {
+		entry->last_used = now;
+		memcpy(&answer, entry, sizeof(answer));
+	}
+
+	k_mutex_unlock(&ctx->cache_lock);
+
+	if (!entry) {
+		return false;
+	}
+
+	NET_DBG("Answer for %s found from cache", name);
+
+	for (i = 0; i < answer.count; i++) {
+		dns_cache_addrinfo(&answer, i, &info);
+		cb(DNS_EAI_INPROGRESS, &info, user_data);
+	}
+
+	cb(answer.count ? DNS_EAI_ALLDONE : DNS_EAI_NODATA, NULL, user_data);
+
+	return true;
+}
+
+static void dns_cache_store(struct dns_resolve_context *ctx,
+			    struct dns_cache_entry *answer, u32_t ttl)
+{
+	struct dns_cache_entry *entry;
+	u32_t now = k_uptime_get_32();
+	int i;
+
+	if (!answer->name[0] || !ttl) {
+		return;
+	}
+
+	k_mutex_lock(&ctx->cache_lock, K_FOREVER);
+
+	entry = dns_cache_find(ctx, answer->name, answer->type, now);
+	if (!entry) {
+		/* Use a free entry or replace the least recently used one */
+		entry = &ctx->cache[0];
+
+		for (i = 0; i < ARRAY_SIZE(ctx->cache); i++) {
+			if (!ctx->cache[i].name[0]) {
+				entry = &ctx->cache[i];
+				break;
+			}
+
+			if ((s32_t)(ctx->cache[i].last_used -
+				    entry->last_used) < 0) {
+				entry = &ctx->cache[i];
+			}
+		}
+	}
+
+	memcpy(entry, answer, sizeof(*entry));
+	entry->expiry = now + MIN(ttl, CONFIG_DNS_RESOLVER_CACHE_MAX_TTL) *
+		MSEC_PER_SEC;
+	entry->last_used = now;
+
+	k_mutex_unlock(&ctx->cache_lock);
+
+	NET_DBG("Cached %u addresses for %s ttl %u", answer->count,
+		answer->name, ttl);
+}
+
+int dns_resolve_cache_foreach(struct dns_resolve_context *ctx,
+			      dns_cache_cb_t cb, void *user_data)
+{
+	u32_t now = k_uptime_get_32();
+	int i, ret = 0;
+
+	if (!ctx->is_used) {
+		return 0;
+	}
+
+	k_mutex_lock(&ctx->cache_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(ctx->cache); i++) {
+		if (!ctx->cache[i].name[0] ||
+		    (s32_t)(ctx->cache[i].expiry - now) <= 0) {
+			continue;
+		}
+
+		cb(&ctx->cache[i], user_data);
+		ret++;
+	}
+
+	k_mutex_unlock(&ctx->cache_lock);
+
+	return ret;
+}
+
+void dns_resolve_cache_flush(struct dns_resolve_context *ctx)
+{
+	int i;
+
+	if (!ctx->is_used) {
+		return;
+	}
+
+	k_mutex_lock(&ctx->cache_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(ctx->cache); i++) {
+		ctx->cache[i].name[0] = '\0';
+	}
+
+	k_mutex_unlock(&ctx->cache_lock);
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
+static bool dns_is_nodata(struct dns_msg_t *dns_msg)
+{
+	return dns_msg->msg_size >= DNS_MSG_HEADER_SIZE &&
+	       dns_header_qr(dns_msg->msg) == DNS_RESPONSE &&
+	       dns_header_rcode(dns_msg->msg) == DNS_HEADER_NOERROR &&
+	       dns_header_qdcount(dns_msg->msg) == 1 &&
+	       dns_header_ancount(dns_msg->msg) == 0;
+}
+
 static int dns_read(struct dns_resolve_context *ctx,
 		    struct net_pkt *pkt,
 		    struct net_buf *dns_data,
@@ -330,12 +610,17 @@ static int dns_read(struct dns_resolve_context *ctx,
 	/* Helper struct to track the dns msg received from the server */
 	struct dns_msg_t dns_msg;
 	u32_t ttl; /* RR ttl, so far it is not passed to caller */
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	struct dns_cache_entry answer;
+	u32_t answer_ttl = UINT32_MAX;
+#endif
 	u8_t *src, *addr;
 	int address_size;
 	/* index that points to the current answer being analyzed */
 	int answer_ptr;
 	int data_len;
 	int items;
+	int rcode;
 	int ret;
 	int server_idx, query_idx;
 
@@ -351,6 +636,7 @@ static int dns_read(struct dns_resolve_context *ctx,
 
 	dns_msg.msg = dns_data->data;
 	dns_msg.msg_size = data_len;
+	dns_msg.response_type = DNS_RESPONSE_INVALID;
 
 	/* The dns_unpack_response_header() has design flaw as it expects
 	 * dns id to be given instead of returning the id to the caller.
@@ -360,19 +646,26 @@ static int dns_read(struct dns_resolve_context *ctx,
 	 */
 	*dns_id = dns_unpack_header_id(dns_msg.msg);
 
-	query_idx = get_slot_by_id(ctx, *dns_id);
+	query_idx = get_slot_by_msg_id(ctx, *dns_id);
 	if (query_idx < 0) {
 		ret = DNS_EAI_SYSTEM;
 		goto quit;
 	}
 
-	if (dns_header_rcode(dns_msg.msg) == DNS_HEADER_REFUSED) {
+	/* Other errors than a name which does not exist (NXDOMAIN), like
+	 * SERVFAIL or REFUSED, might be transient and are not an answer.
+	 */
+	rcode = dns_header_rcode(dns_msg.msg);
+	if (rcode != DNS_HEADER_NOERROR && rcode != DNS_HEADER_NAMEERROR) {
 		ret = DNS_EAI_FAIL;
 		goto quit;
 	}
 
+	/* An answer without any record (NODATA) is not an error, the name
+	 * simply has no address of this type.
+	 */
 	ret = dns_unpack_response_header(&dns_msg, *dns_id);
-	if (ret < 0) {
+	if (ret < 0 && !dns_is_nodata(&dns_msg)) {
 		ret = DNS_EAI_FAIL;
 		goto quit;
 	}
@@ -414,6 +707,13 @@ static int dns_read(struct dns_resolve_context *ctx,
 		goto quit;
 	}
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	/* The callbacks might free the query slot */
+	strcpy(answer.name, ctx->queries[query_idx].name);
+	answer.type = ctx->queries[query_idx].query_type;
+	answer.count = 0U;
+#endif
+
 	/* while loop to traverse the response */
 	answer_ptr = DNS_QUERY_POS;
 	items = 0;
@@ -437,8 +737,16 @@ static int dns_read(struct dns_resolve_context *ctx,
 
 			memcpy(addr, src, address_size);
 
-			ctx->queries[query_idx].cb(DNS_EAI_INPROGRESS, &info,
-					ctx->queries[query_idx].user_data);
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+			if (answer.count < ARRAY_SIZE(answer.addr)) {
+				memcpy(&answer.addr[answer.count++], src,
+				       address_size);
+			}
+
+			answer_ttl = MIN(answer_ttl, ttl);
+#endif
+
+			dns_notify(ctx, *dns_id, DNS_EAI_INPROGRESS, &info);
 			items++;
 			break;
 
@@ -475,8 +783,9 @@ static int dns_read(struct dns_resolve_context *ctx,
 				goto quit;
 			}
 
+			/* The query stays pending for the new answer */
 			ret = DNS_EAI_AGAIN;
-			goto finished;
+			goto quit;
 		}
 	}
 
@@ -486,22 +795,27 @@ static int dns_read(struct dns_resolve_context *ctx,
 		ret = DNS_EAI_ALLDONE;
 	}
 
-	if (k_delayed_work_remaining_get(&ctx->queries[query_idx].timer) > 0) {
-		k_delayed_work_cancel(&ctx->queries[query_idx].timer);
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	if (items == 0) {
+		/* The zone tells how long the name stays unresolved */
+		if (dns_unpack_soa_minimum(&dns_msg, &answer_ttl) < 0) {
+			answer_ttl = CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL;
+		}
+
+		answer_ttl = MIN(answer_ttl,
+				 CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL);
 	}
 
+	dns_cache_store(ctx, &answer, answer_ttl);
+#endif
+
 	/* Marks the end of the results */
-	ctx->queries[query_idx].cb(ret, NULL,
-				   ctx->queries[query_idx].user_data);
-	ctx->queries[query_idx].cb = NULL;
+	dns_finish(ctx, *dns_id, ret);
 
 	net_pkt_unref(pkt);
 
 	return 0;
 
-finished:
-	dns_resolve_cancel(ctx, *dns_id);
-
 quit:
 	net_pkt_unref(pkt);
 
@@ -553,7 +867,7 @@ static void cb_recv(struct net_context *net_ctx,
 		int failure = 0;
 		int j;
 
-		i = get_slot_by_id(ctx, dns_id);
+		i = get_slot_by_msg_id(ctx, dns_id);
 		if (i < 0) {
 			goto free_buf;
 		}
@@ -582,18 +896,8 @@ static void cb_recv(struct net_context *net_ctx,
 	}
 
 quit:
-	i = get_slot_by_id(ctx, dns_id);
-	if (i < 0) {
-		goto free_buf;
-	}
-
-	if (k_delayed_work_remaining_get(&ctx->queries[i].timer) > 0) {
-		k_delayed_work_cancel(&ctx->queries[i].timer);
-	}
-
 	/* Marks the end of the results */
-	ctx->queries[i].cb(ret, NULL, ctx->queries[i].user_data);
-	ctx->queries[i].cb = NULL;
+	dns_finish(ctx, dns_id, ret);
 
 free_buf:
 	if (dns_data) {
@@ -621,7 +925,7 @@ static int dns_write(struct dns_resolve_context *ctx,
 
 	net_ctx = ctx->servers[server_idx].net_ctx;
 	server = &ctx->servers[server_idx].dns_server;
-	dns_id = ctx->queries[query_idx].id;
+	dns_id = ctx->queries[query_idx].msg_id;
 	query_type = ctx->queries[query_idx].query_type;
 
 	ret = dns_msg_pack_query(dns_data->data, &dns_data->len, dns_data->size,
@@ -770,6 +1074,16 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 	}
 
 try_resolve:
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	if (dns_cache_answer(ctx, query, type, cb, user_data)) {
+		if (dns_id) {
+			*dns_id = DNS_RESOLVE_ID_CACHED;
+		}
+
+		return 0;
+	}
+#endif
+
 	i = get_cb_slot(ctx);
 	if (i < 0) {
 		return -EAGAIN;
@@ -782,6 +1096,10 @@ try_resolve:
 	ctx->queries[i].user_data = user_data;
 	ctx->queries[i].ctx = ctx;
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	dns_set_query_name(&ctx->queries[i], query);
+#endif
+
 	k_delayed_work_init(&ctx->queries[i].timer, query_timeout);
 
 	dns_data = net_buf_alloc(&dns_msg_pool, ctx->buf_timeout);
@@ -802,7 +1120,10 @@ try_resolve:
 		goto quit;
 	}
 
-	ctx->queries[i].id = sys_rand32_get();
+	/* The id of the answers from the cache is not given to queries */
+	do {
+		ctx->queries[i].id = sys_rand32_get();
+	} while (ctx->queries[i].id == DNS_RESOLVE_ID_CACHED);
 
 	/* Do this immediately after calculating the Id so that the unit
 	 * test will work properly.
@@ -813,6 +1134,24 @@ try_resolve:
 		NET_DBG("DNS id will be %u", *dns_id);
 	}
 
+	ctx->queries[i].msg_id = ctx->queries[i].id;
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	/* If an identical query is already pending, wait for its answer
+	 * instead of sending another one.
+	 */
+	j = get_slot_by_name(ctx, i);
+	if (j >= 0) {
+		ctx->queries[i].msg_id = ctx->queries[j].msg_id;
+
+		NET_DBG("DNS id %u waits for the answer to id %u",
+			ctx->queries[i].id, ctx->queries[i].msg_id);
+
+		ret = k_delayed_work_submit(&ctx->queries[i].timer, timeout);
+		goto quit;
+	}
+#endif
+
 	mdns_query = false;
 
 	/* If mDNS is enabled, then send .local queries only to multicast
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_http_client, CONFIG_HTTP_CLIENT_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <errno.h>
+#include <net/socket.h>
+#include <net/http_client.h>
+
+#include "http_internal.h"
+
+static struct http_request *pending_req(struct http_client_conn *conn)
+{
+	if (conn->pending_count == 0) {
+		return NULL;
+	}
+
+	return conn->pending[conn->pending_head];
+}
+
+static bool is_pending(struct http_client_conn *conn,
+		       struct http_request *req)
+{
+	int i, idx;
+
+	for (i = 0; i < conn->pending_count; i++) {
+		idx = (conn->pending_head + i) % CONFIG_HTTP_CLIENT_MAX_PIPELINE;
+		if (conn->pending[idx] == req) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static int on_headers_complete(struct http_parser *parser)
+{
+	struct http_client_conn *conn = parser->data;
+	struct http_request *req = pending_req(conn);
+
+	if (!req) {
+		NET_DBG("[%p] Unsolicited response", conn);
+		return -EINVAL;
+	}
+
+	/* Interim responses are not reported */
+	if (parser->status_code < 200) {
+		return 0;
+	}
+
+	req->status = parser->status_code;
+
+	if (req->response_cb) {
+		req->response_cb(conn, req, req->status);
+	}
+
+	/* The response to a HEAD request has headers but no body */
+	return req->method == HTTP_HEAD ? 1 : 0;
+}
+
+static int on_body(struct http_parser *parser, const char *at, size_t length)
+{
+	struct http_client_conn *conn = parser->data;
+	struct http_request *req = pending_req(conn);
+
+	if (req->body_cb && parser->status_code >= 200) {
+		req->body_cb(conn, req, (const u8_t *)at, length, false);
+	}
+
+	return 0;
+}
+
+static int on_message_complete(struct http_parser *parser)
+{
+	struct http_client_conn *conn = parser->data;
+	struct http_request *req = pending_req(conn);
+
+	if (parser->status_code < 200) {
+		return 0;
+	}
+
+	conn->pending_head = (conn->pending_head + 1) %
+		CONFIG_HTTP_CLIENT_MAX_PIPELINE;
+	conn->pending_count--;
+
+	if (!http_should_keep_alive(parser)) {
+		conn->closing = true;
+	}
+
+	if (req->body_cb) {
+		req->body_cb(conn, req, NULL, 0, true);
+	}
+
+	return 0;
+}
+
+static const struct http_parser_settings response_settings = {
+	.on_headers_complete = on_headers_complete,
+	.on_body = on_body,
+	.on_message_complete = on_message_complete,
+};
+
+void http_client_init(struct http_client_conn *conn, int sock,
+		      u8_t *buf, size_t buf_len)
+{
+	(void)memset(conn, 0, sizeof(*conn));
+
+	conn->sock = sock;
+	conn->buf = buf;
+	conn->buf_len = buf_len;
+
+	http_parser_init(&conn->parser, HTTP_RESPONSE);
+	conn->parser.data = conn;
+}
+
+static int send_payload(struct http_client_conn *conn,
+			struct http_request *req, struct http_out *out)
+{
+	const u8_t *data;
+	int ret, len;
+
+	if (!req->payload_cb) {
+		if (req->payload_len == 0) {
+			return 0;
+		}
+
+		return http_out_append(out, req->payload, req->payload_len);
+	}
+
+	do {
+		len = req->payload_cb(conn, req, &data);
+		if (len < 0) {
+			return len;
+		}
+
+		ret = http_out_chunk(out, data, len);
+		if (ret < 0) {
+			return ret;
+		}
+	} while (len > 0);
+
+	return 0;
+}
+
+int http_client_send(struct http_client_conn *conn, struct http_request *req)
+{
+	struct http_out out;
+	int ret, idx;
+
+	if (conn->closing) {
+		return -ENOTCONN;
+	}
+
+	if (conn->pending_count == CONFIG_HTTP_CLIENT_MAX_PIPELINE) {
+		return -EAGAIN;
+	}
+
+	http_out_init(&out, conn->sock);
+
+	ret = http_out_printf(&out, "%s %s HTTP/1.1" HTTP_CRLF,
+			      http_method_str(req->method), req->url);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = http_out_printf(&out, "Host: %s" HTTP_CRLF, req->host);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (req->content_type) {
+		ret = http_out_printf(&out, "Content-Type: %s" HTTP_CRLF,
+				      req->content_type);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	if (req->payload_cb) {
+		ret = http_out_str(&out, "Transfer-Encoding: chunked" HTTP_CRLF);
+	} else if (req->payload_len > 0 || req->method == HTTP_POST ||
+		   req->method == HTTP_PUT) {
+		ret = http_out_printf(&out, "Content-Length: %u" HTTP_CRLF,
+				      (unsigned int)req->payload_len);
+	}
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (req->headers) {
+		ret = http_out_str(&out, req->headers);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	ret = http_out_str(&out, HTTP_CRLF);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* The request is pending as soon as a part of it may be sent, the
+	 * response can only come afterwards.
+	 */
+	req->status = 0U;
+
+	idx = (conn->pending_head + conn->pending_count) %
+		CONFIG_HTTP_CLIENT_MAX_PIPELINE;
+	conn->pending[idx] = req;
+	conn->pending_count++;
+
+	ret = send_payload(conn, req, &out);
+	if (ret == 0) {
+		ret = http_out_flush(&out);
+	}
+
+	if (ret < 0) {
+		/* A partial request cannot be recovered from */
+		NET_DBG("[%p] Cannot send request (%d)", conn, ret);
+		conn->closing = true;
+		return ret;
+	}
+
+	return 0;
+}
+
+int http_client_process(struct http_client_conn *conn, s32_t timeout)
+{
+	struct pollfd fds = {
+		.fd = conn->sock,
+		.events = POLLIN,
+	};
+	int pending_count = conn->pending_count;
+	ssize_t len;
+	size_t parsed;
+	int ret;
+
+	if (pending_count == 0) {
+		return 0;
+	}
+
+	ret = poll(&fds, 1, timeout);
+	if (ret < 0) {
+		return -errno;
+	} else if (ret == 0) {
+		return -EAGAIN;
+	}
+
+	len = recv(conn->sock, conn->buf, conn->buf_len, 0);
+	if (len < 0) {
+		conn->closing = true;
+		return -errno;
+	}
+
+	/* The callbacks get the body directly from the receive buffer. With
+	 * len being 0, the parser completes a response ending with the
+	 * connection.
+	 */
+	parsed = http_parser_execute(&conn->parser, &response_settings,
+				     (const char *)conn->buf, len);
+
+	if (len == 0) {
+		conn->closing = true;
+
+		if (conn->pending_count > 0) {
+			return -ENOTCONN;
+		}
+	} else if (HTTP_PARSER_ERRNO(&conn->parser) != HPE_OK ||
+		   parsed != len) {
+		NET_DBG("[%p] Invalid response: %s", conn,
+			http_errno_name(HTTP_PARSER_ERRNO(&conn->parser)));
+		conn->closing = true;
+		return -EBADMSG;
+	}
+
+	return pending_count - conn->pending_count;
+}
+
+int http_client_request(struct http_client_conn *conn,
+			struct http_request *req, s32_t timeout)
+{
+	int ret;
+
+	ret = http_client_send(conn, req);
+	if (ret < 0) {
+		return ret;
+	}
+
+	while (is_pending(conn, req)) {
+		ret = http_client_process(conn, timeout);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return req->status;
+}
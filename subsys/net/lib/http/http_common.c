@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <errno.h>
+#include <string.h>
+#include <stdarg.h>
+#include <misc/printk.h>
+#include <net/socket.h>
+
+#include "http_internal.h"
+
+int http_send_all(int sock, const void *data, size_t len)
+{
+	const u8_t *pos = data;
+	ssize_t sent;
+
+	while (len > 0) {
+		sent = send(sock, pos, len, 0);
+		if (sent < 0) {
+			return -errno;
+		}
+
+		pos += sent;
+		len -= sent;
+	}
+
+	return 0;
+}
+
+int http_out_flush(struct http_out *out)
+{
+	int ret;
+
+	if (out->len == 0) {
+		return 0;
+	}
+
+	ret = http_send_all(out->sock, out->buf, out->len);
+	out->len = 0;
+
+	return ret;
+}
+
+int http_out_append(struct http_out *out, const void *data, size_t len)
+{
+	int ret;
+
+	if (len > sizeof(out->buf) - out->len) {
+		ret = http_out_flush(out);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (len >= sizeof(out->buf)) {
+			return http_send_all(out->sock, data, len);
+		}
+	}
+
+	memcpy(out->buf + out->len, data, len);
+	out->len += len;
+
+	return 0;
+}
+
+int http_out_str(struct http_out *out, const char *str)
+{
+	return http_out_append(out, str, strlen(str));
+}
+
+int http_out_printf(struct http_out *out, const char *fmt, ...)
+{
+	va_list ap;
+	int ret, len;
+
+	va_start(ap, fmt);
+	len = vsnprintk(out->buf + out->len, sizeof(out->buf) - out->len,
+			fmt, ap);
+	va_end(ap);
+
+	if (len < 0) {
+		return -EINVAL;
+	}
+
+	if (len < sizeof(out->buf) - out->len) {
+		out->len += len;
+		return 0;
+	}
+
+	if (out->len == 0) {
+		return -ENOMEM;
+	}
+
+	/* Retry at the beginning of the buffer */
+	ret = http_out_flush(out);
+	if (ret < 0) {
+		return ret;
+	}
+
+	va_start(ap, fmt);
+	len = vsnprintk(out->buf, sizeof(out->buf), fmt, ap);
+	va_end(ap);
+
+	if (len < 0 || len >= sizeof(out->buf)) {
+		return -ENOMEM;
+	}
+
+	out->len = len;
+
+	return 0;
+}
+
+int http_out_chunk(struct http_out *out, const void *data, size_t len)
+{
+	int ret;
+
+	ret = http_out_printf(out, "%x" HTTP_CRLF, (unsigned int)len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (len > 0) {
+		ret = http_out_append(out, data, len);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return http_out_str(out, HTTP_CRLF);
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __HTTP_INTERNAL_H__
+#define __HTTP_INTERNAL_H__
+
+#include <zephyr/types.h>
+#include <stddef.h>
+
+#define HTTP_CRLF "\r\n"
+
+/* Messages are built in a small buffer so that the headers and a short
+ * body go out in a single send, larger data is sent from where it is.
+ */
+#define HTTP_OUT_BUF_SIZE 256
+
+struct http_out {
+	int sock;
+	size_t len;
+	u8_t buf[HTTP_OUT_BUF_SIZE];
+};
+
+static inline void http_out_init(struct http_out *out, int sock)
+{
+	out->sock = sock;
+	out->len = 0;
+}
+
+int http_send_all(int sock, const void *data, size_t len);
+
+int http_out_flush(struct http_out *out);
+int http_out_append(struct http_out *out, const void *data, size_t len);
+int http_out_str(struct http_out *out, const char *str);
+int http_out_printf(struct http_out *out, const char *fmt, ...);
+int http_out_chunk(struct http_out *out, const void *data, size_t len);
+
+#endif /* __HTTP_INTERNAL_H__ */
@@ -0,0 +1,575 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_http_server, CONFIG_HTTP_SERVER_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <errno.h>
+#include <string.h>
+#include <net/socket.h>
+#include <net/http_server.h>
+
+#include "http_internal.h"
+
+#define LISTEN_BACKLOG 4
+#define RUN_POLL_TIMEOUT MSEC_PER_SEC
+
+struct status_reason {
+	u16_t status;
+	const char *reason;
+};
+
+static const struct status_reason reasons[] = {
+	{ 200, "OK" },
+	{ 201, "Created" },
+	{ 204, "No Content" },
+	{ 400, "Bad Request" },
+	{ 404, "Not Found" },
+	{ 405, "Method Not Allowed" },
+	{ 413, "Payload Too Large" },
+	{ 414, "URI Too Long" },
+	{ 500, "Internal Server Error" },
+	{ 503, "Service Unavailable" },
+};
+
+static const char *status_reason(u16_t status)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(reasons); i++) {
+		if (reasons[i].status == status) {
+			return reasons[i].reason;
+		}
+	}
+
+	return "";
+}
+
+static int send_headers(struct http_server_conn *conn, struct http_out *out,
+			u16_t status, const char *content_type)
+{
+	struct http_parser *parser = &conn->parser;
+	int ret;
+
+	if (conn->responding) {
+		return -EALREADY;
+	}
+
+	conn->responding = true;
+
+	if (!http_should_keep_alive(parser)) {
+		conn->closing = true;
+	}
+
+	http_out_init(out, conn->sock);
+
+	ret = http_out_printf(out, "HTTP/1.1 %u %s" HTTP_CRLF, status,
+			      status_reason(status));
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (content_type) {
+		ret = http_out_printf(out, "Content-Type: %s" HTTP_CRLF,
+				      content_type);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	if (conn->closing) {
+		return http_out_str(out, "Connection: close" HTTP_CRLF);
+	}
+
+	if (parser->http_major == 1 && parser->http_minor == 0) {
+		return http_out_str(out, "Connection: keep-alive" HTTP_CRLF);
+	}
+
+	return 0;
+}
+
+int http_server_respond(struct http_server_conn *conn, u16_t status,
+			const char *content_type, const u8_t *body,
+			size_t len)
+{
+	struct http_out out;
+	int ret;
+
+	ret = send_headers(conn, &out, status, content_type);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = http_out_printf(&out, "Content-Length: %u" HTTP_CRLF HTTP_CRLF,
+			      (unsigned int)len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (conn->method != HTTP_HEAD && len > 0) {
+		ret = http_out_append(&out, body, len);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return http_out_flush(&out);
+}
+
+int http_server_respond_begin(struct http_server_conn *conn, u16_t status,
+			      const char *content_type)
+{
+	struct http_out out;
+	int ret;
+
+	/* Without chunks, only closing the connection ends the body */
+	if (conn->parser.http_major == 1 && conn->parser.http_minor == 0) {
+		conn->closing = true;
+	}
+
+	ret = send_headers(conn, &out, status, content_type);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (!conn->closing) {
+		conn->chunked = true;
+
+		ret = http_out_str(&out, "Transfer-Encoding: chunked" HTTP_CRLF);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	ret = http_out_str(&out, HTTP_CRLF);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return http_out_flush(&out);
+}
+
+int http_server_respond_write(struct http_server_conn *conn,
+			      const u8_t *data, size_t len)
+{
+	struct http_out out;
+	int ret;
+
+	if (!conn->responding) {
+		return -EINVAL;
+	}
+
+	if (len == 0 || conn->method == HTTP_HEAD) {
+		return 0;
+	}
+
+	if (!conn->chunked) {
+		return http_send_all(conn->sock, data, len);
+	}
+
+	http_out_init(&out, conn->sock);
+
+	ret = http_out_chunk(&out, data, len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return http_out_flush(&out);
+}
+
+int http_server_respond_end(struct http_server_conn *conn)
+{
+	struct http_out out;
+	int ret;
+
+	if (!conn->responding) {
+		return -EINVAL;
+	}
+
+	if (!conn->chunked) {
+		return 0;
+	}
+
+	conn->chunked = false;
+
+	if (conn->method == HTTP_HEAD) {
+		return 0;
+	}
+
+	http_out_init(&out, conn->sock);
+
+	ret = http_out_chunk(&out, NULL, 0);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return http_out_flush(&out);
+}
+
+static const struct http_server_resource *
+find_resource(struct http_server *server, const char *url)
+{
+	const struct http_server_resource *res;
+	size_t path_len = 0;
+	size_t len;
+	int i;
+
+	while (url[path_len] && url[path_len] != '?' && url[path_len] != '#') {
+		path_len++;
+	}
+
+	for (i = 0; i < server->resource_count; i++) {
+		res = &server->resources[i];
+		len = strlen(res->path);
+
+		if (len == path_len && !strncmp(res->path, url, len)) {
+			return res;
+		}
+
+		if (res->prefix && len < path_len &&
+		    !strncmp(res->path, url, len)) {
+			return res;
+		}
+	}
+
+	return NULL;
+}
+
+static struct http_server *conn_server(struct http_server_conn *conn)
+{
+	return conn->parser.data;
+}
+
+static int notify(struct http_server_conn *conn, enum http_server_event evt,
+		  const u8_t *data, size_t len)
+{
+	int ret;
+
+	if (!conn->resource) {
+		return 0;
+	}
+
+	ret = conn->resource->cb(conn, evt, data, len);
+	if (ret < 0) {
+		NET_DBG("[%p] Resource %s closes the connection (%d)", conn,
+			conn->resource->path, ret);
+		conn->closing = true;
+		return -1;
+	}
+
+	return 0;
+}
+
+static int on_message_begin(struct http_parser *parser)
+{
+	struct http_server_conn *conn = CONTAINER_OF(parser,
+						     struct http_server_conn,
+						     parser);
+
+	conn->resource = NULL;
+	conn->user_data = NULL;
+	conn->url_len = 0U;
+	conn->responding = false;
+	conn->chunked = false;
+
+	return 0;
+}
+
+static int on_url(struct http_parser *parser, const char *at, size_t length)
+{
+	struct http_server_conn *conn = CONTAINER_OF(parser,
+						     struct http_server_conn,
+						     parser);
+
+	/* The URL may come in several parts, a URL filling the buffer is
+	 * too long.
+	 */
+	length = MIN(length, sizeof(conn->url) - conn->url_len);
+	memcpy(conn->url + conn->url_len, at, length);
+	conn->url_len += length;
+
+	return 0;
+}
+
+static int on_headers_complete(struct http_parser *parser)
+{
+	struct http_server_conn *conn = CONTAINER_OF(parser,
+						     struct http_server_conn,
+						     parser);
+	int ret;
+
+	conn->method = parser->method;
+
+	if (conn->url_len == sizeof(conn->url)) {
+		conn->url[sizeof(conn->url) - 1] = '\0';
+		ret = http_server_respond(conn, 414, NULL, NULL, 0);
+	} else {
+		conn->url[conn->url_len] = '\0';
+		conn->resource = find_resource(conn_server(conn), conn->url);
+		if (conn->resource) {
+			return notify(conn, HTTP_SERVER_REQUEST, NULL, 0);
+		}
+
+		ret = http_server_respond(conn, 404, NULL, NULL, 0);
+	}
+
+	if (ret < 0) {
+		conn->closing = true;
+		return -1;
+	}
+
+	return 0;
+}
+
+static int on_body(struct http_parser *parser, const char *at, size_t length)
+{
+	struct http_server_conn *conn = CONTAINER_OF(parser,
+						     struct http_server_conn,
+						     parser);
+
+	return notify(conn, HTTP_SERVER_BODY, (const u8_t *)at, length);
+}
+
+static int on_message_complete(struct http_parser *parser)
+{
+	struct http_server_conn *conn = CONTAINER_OF(parser,
+						     struct http_server_conn,
+						     parser);
+	int ret = 0;
+
+	if (notify(conn, HTTP_SERVER_COMPLETE, NULL, 0) < 0) {
+		return -1;
+	}
+
+	if (!conn->responding) {
+		ret = http_server_respond(conn, 500, NULL, NULL, 0);
+	} else if (conn->chunked) {
+		ret = http_server_respond_end(conn);
+	}
+
+	conn->resource = NULL;
+
+	if (ret < 0) {
+		conn->closing = true;
+		return -1;
+	}
+
+	/* Requests pipelined after this one are not served */
+	if (conn->closing) {
+		http_parser_pause(parser, 1);
+	}
+
+	return 0;
+}
+
+static const struct http_parser_settings request_settings = {
+	.on_message_begin = on_message_begin,
+	.on_url = on_url,
+	.on_headers_complete = on_headers_complete,
+	.on_body = on_body,
+	.on_message_complete = on_message_complete,
+};
+
+static void conn_close(struct http_server_conn *conn)
+{
+	/* Let the resource release what it allocated for the request */
+	if (conn->resource) {
+		(void)conn->resource->cb(conn, HTTP_SERVER_ABORT, NULL, 0);
+		conn->resource = NULL;
+	}
+
+	NET_DBG("[%p] Closing connection", conn);
+
+	(void)close(conn->sock);
+	conn->sock = -1;
+}
+
+static void conn_open(struct http_server *server, int sock)
+{
+	struct http_server_conn *conn = NULL;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(server->conns); i++) {
+		if (server->conns[i].sock < 0) {
+			conn = &server->conns[i];
+			break;
+		}
+	}
+
+	if (!conn) {
+		(void)close(sock);
+		return;
+	}
+
+	NET_DBG("[%p] New connection", conn);
+
+	conn->sock = sock;
+	conn->resource = NULL;
+	conn->closing = false;
+	conn->last_activity = k_uptime_get();
+
+	http_parser_init(&conn->parser, HTTP_REQUEST);
+	conn->parser.data = server;
+}
+
+static void conn_recv(struct http_server_conn *conn)
+{
+	enum http_errno err;
+	ssize_t len;
+
+	len = recv(conn->sock, conn->buf, sizeof(conn->buf), 0);
+	if (len <= 0) {
+		conn_close(conn);
+		return;
+	}
+
+	conn->last_activity = k_uptime_get();
+
+	/* The resources get the body directly from the receive buffer and
+	 * the pipelined requests are answered in order.
+	 */
+	(void)http_parser_execute(&conn->parser, &request_settings,
+				  (const char *)conn->buf, len);
+
+	err = HTTP_PARSER_ERRNO(&conn->parser);
+	if (err != HPE_OK && err != HPE_PAUSED &&
+	    !(err >= HPE_CB_message_begin && err <= HPE_CB_chunk_complete)) {
+		NET_DBG("[%p] Invalid request: %s", conn, http_errno_name(err));
+
+		conn->closing = true;
+
+		if (!conn->responding) {
+			(void)http_server_respond(conn, 400, NULL, NULL, 0);
+		}
+	}
+
+	if (conn->closing || err != HPE_OK) {
+		conn_close(conn);
+	}
+}
+
+static bool has_free_conn(struct http_server *server)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(server->conns); i++) {
+		if (server->conns[i].sock < 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int http_server_init(struct http_server *server, const struct sockaddr *addr,
+		     socklen_t addrlen,
+		     const struct http_server_resource *resources,
+		     size_t resource_count)
+{
+	int i, ret;
+
+	(void)memset(server, 0, sizeof(*server));
+
+	for (i = 0; i < ARRAY_SIZE(server->conns); i++) {
+		server->conns[i].sock = -1;
+	}
+
+	server->resources = resources;
+	server->resource_count = resource_count;
+
+	server->sock = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
+	if (server->sock < 0) {
+		return -errno;
+	}
+
+	ret = bind(server->sock, addr, addrlen);
+	if (ret == 0) {
+		ret = listen(server->sock, LISTEN_BACKLOG);
+	}
+
+	if (ret < 0) {
+		ret = -errno;
+		(void)close(server->sock);
+		server->sock = -1;
+		return ret;
+	}
+
+	return 0;
+}
+
+int http_server_poll(struct http_server *server, s32_t timeout)
+{
+	struct pollfd fds[1 + CONFIG_HTTP_SERVER_MAX_CONNECTIONS];
+	struct http_server_conn *conn;
+	s64_t now;
+	int i, ret;
+
+	/* Leave new connections in the backlog while all slots are busy */
+	fds[0].fd = has_free_conn(server) ? server->sock : -1;
+	fds[0].events = POLLIN;
+	fds[0].revents = 0;
+
+	for (i = 0; i < ARRAY_SIZE(server->conns); i++) {
+		fds[i + 1].fd = server->conns[i].sock;
+		fds[i + 1].events = POLLIN;
+		fds[i + 1].revents = 0;
+	}
+
+	ret = poll(fds, ARRAY_SIZE(fds), timeout);
+	if (ret < 0) {
+		return -errno;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(server->conns); i++) {
+		conn = &server->conns[i];
+
+		if (conn->sock >= 0 && fds[i + 1].revents) {
+			conn_recv(conn);
+		}
+	}
+
+	if (fds[0].revents & POLLIN) {
+		ret = accept(server->sock, NULL, NULL);
+		if (ret >= 0) {
+			conn_open(server, ret);
+		}
+	}
+
+	now = k_uptime_get();
+
+	for (i = 0; i < ARRAY_SIZE(server->conns); i++) {
+		conn = &server->conns[i];
+
+		if (conn->sock >= 0 &&
+		    now - conn->last_activity >
+		    K_SECONDS(CONFIG_HTTP_SERVER_IDLE_TIMEOUT)) {
+			conn_close(conn);
+		}
+	}
+
+	return 0;
+}
+
+int http_server_run(struct http_server *server)
+{
+	int i, ret = 0;
+
+	while (!server->stop && ret == 0) {
+		ret = http_server_poll(server, RUN_POLL_TIMEOUT);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(server->conns); i++) {
+		if (server->conns[i].sock >= 0) {
+			conn_close(&server->conns[i]);
+		}
+	}
+
+	(void)close(server->sock);
+	server->sock = -1;
+
+	return ret;
+}
@@ -49,6 +49,9 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #ifdef CONFIG_LWM2M_RW_JSON_SUPPORT
 #include "lwm2m_rw_json.h"
 #endif
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+#include "lwm2m_rw_senml_cbor.h"
+#endif
 #ifdef CONFIG_LWM2M_RD_CLIENT_SUPPORT
 #include "lwm2m_rd_client.h"
 #endif
@@ -91,11 +94,13 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 
 struct observe_node {
 	sys_snode_t node;
+	sys_snode_t index_node;
 	struct lwm2m_ctx *ctx;
 	struct lwm2m_obj_path path;
 	u8_t  token[MAX_TOKEN_LEN];
 	s64_t event_timestamp;
 	s64_t last_timestamp;
+	s64_t batch_timestamp;
 	u32_t min_period_sec;
 	u32_t max_period_sec;
 	u32_t counter;
@@ -131,6 +136,18 @@ static sys_slist_t engine_obj_inst_list;
 static sys_slist_t engine_observer_list;
 static sys_slist_t engine_service_list;
 
+/* Hash indexes of the lists above, keyed by object and instance IDs */
+#define INDEX_BUCKETS		CONFIG_LWM2M_ENGINE_INDEX_BUCKETS
+
+static sys_slist_t engine_obj_index[INDEX_BUCKETS];
+static sys_slist_t engine_obj_inst_index[INDEX_BUCKETS];
+static sys_slist_t engine_observer_index[INDEX_BUCKETS];
+
+/* Changed whenever an object or instance is added or removed, so that
+ * the objects resolved by a path handle can be known to be still valid.
+ */
+static u32_t engine_index_generation;
+
 static K_THREAD_STACK_DEFINE(engine_thread_stack,
 			      CONFIG_LWM2M_ENGINE_STACK_SIZE);
 static struct k_thread engine_thread_data;
@@ -376,25 +393,98 @@ static void clear_attrs(void *ref)
 	}
 }
 
-int lwm2m_notify_observer(u16_t obj_id, u16_t obj_inst_id, u16_t res_id)
+static sys_slist_t *index_bucket(sys_slist_t *index, u16_t obj_id,
+				 u16_t obj_inst_id)
+{
+	u32_t key = (u32_t)obj_id << 16 | obj_inst_id;
+
+	/* Knuth's multiplicative hash */
+	return &index[((key * 2654435761U) >> 16) % INDEX_BUCKETS];
+}
+
+/*
+ * Observers of a whole object are indexed under this reserved instance ID
+ * so that they are found by the changes of any of its instances.
+ */
+#define OBSERVER_ANY_INST UINT16_MAX
+
+static sys_slist_t *observer_bucket(struct observe_node *obs)
+{
+	return index_bucket(engine_observer_index, obs->path.obj_id,
+			    obs->path.level < 2 ? OBSERVER_ANY_INST :
+			    obs->path.obj_inst_id);
+}
+
+static void observer_index_add(struct observe_node *obs)
+{
+	sys_slist_append(observer_bucket(obs), &obs->index_node);
+}
+
+static void observer_index_remove(struct observe_node *obs)
+{
+	sys_slist_find_and_remove(observer_bucket(obs), &obs->index_node);
+}
+
+static bool observer_matches(struct observe_node *obs, u16_t obj_id,
+			     u16_t obj_inst_id, u16_t res_id)
+{
+	if (obs->path.obj_id != obj_id) {
+		return false;
+	}
+
+	if (obs->path.level < 2) {
+		return true;
+	}
+
+	return obs->path.obj_inst_id == obj_inst_id &&
+	       (obs->path.level < 3 || obs->path.res_id == res_id);
+}
+
+static int notify_bucket(sys_slist_t *bucket, u16_t obj_id,
+			 u16_t obj_inst_id, u16_t res_id)
 {
 	struct observe_node *obs;
+	s64_t timestamp = k_uptime_get();
 	int ret = 0;
 
-	/* look for observers which match our resource */
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_observer_list, obs, node) {
-		if (obs->path.obj_id == obj_id &&
-		    obs->path.obj_inst_id == obj_inst_id &&
-		    (obs->path.level < 3 ||
-		     obs->path.res_id == res_id)) {
-			/* update the event time for this observer */
-			obs->event_timestamp = k_uptime_get();
-
-			LOG_DBG("NOTIFY EVENT %u/%u/%u",
-				obj_id, obj_inst_id, res_id);
+	SYS_SLIST_FOR_EACH_CONTAINER(bucket, obs, index_node) {
+		if (!observer_matches(obs, obj_id, obj_inst_id, res_id)) {
+			continue;
+		}
 
-			ret++;
+		/*
+		 * The first change since the last notification opens the
+		 * window in which the following changes are gathered.
+		 */
+		if (obs->event_timestamp <= obs->last_timestamp) {
+			obs->batch_timestamp = timestamp;
 		}
+
+		/* update the event time for this observer */
+		obs->event_timestamp = timestamp;
+
+		LOG_DBG("NOTIFY EVENT %u/%u/%u",
+			obj_id, obj_inst_id, res_id);
+
+		ret++;
+	}
+
+	return ret;
+}
+
+int lwm2m_notify_observer(u16_t obj_id, u16_t obj_inst_id, u16_t res_id)
+{
+	sys_slist_t *inst_bucket, *obj_bucket;
+	int ret;
+
+	/* look for observers which match our resource or its object */
+	inst_bucket = index_bucket(engine_observer_index, obj_id, obj_inst_id);
+	obj_bucket = index_bucket(engine_observer_index, obj_id,
+				  OBSERVER_ANY_INST);
+
+	ret = notify_bucket(inst_bucket, obj_id, obj_inst_id, res_id);
+	if (obj_bucket != inst_bucket) {
+		ret += notify_bucket(obj_bucket, obj_id, obj_inst_id, res_id);
 	}
 
 	return ret;
@@ -413,6 +503,7 @@ static int engine_add_observer(struct lwm2m_message *msg,
 	struct lwm2m_engine_obj *obj = NULL;
 	struct lwm2m_engine_obj_field *obj_field = NULL;
 	struct lwm2m_engine_obj_inst *obj_inst = NULL;
+	struct lwm2m_engine_res_inst *res = NULL;
 	struct observe_node *obs;
 	struct notification_attrs attrs = {
 		.flags = BIT(LWM2M_ATTR_PMIN) | BIT(LWM2M_ATTR_PMAX),
@@ -485,13 +576,8 @@ static int engine_add_observer(struct lwm2m_message *msg,
 
 	/* check if resource exists */
 	if (msg->path.level >= 3U) {
-		for (i = 0; i < obj_inst->resource_count; i++) {
-			if (obj_inst->resources[i].res_id == msg->path.res_id) {
-				break;
-			}
-		}
-
-		if (i == obj_inst->resource_count) {
+		res = lwm2m_get_engine_res_inst(obj_inst, msg->path.res_id);
+		if (!res) {
 			LOG_ERR("unable to find res_id: %u/%u/%u",
 				msg->path.obj_id, msg->path.obj_inst_id,
 				msg->path.res_id);
@@ -499,8 +585,7 @@ static int engine_add_observer(struct lwm2m_message *msg,
 		}
 
 		/* load object field data */
-		obj_field = lwm2m_get_engine_obj_field(obj,
-				obj_inst->resources[i].res_id);
+		obj_field = lwm2m_get_engine_obj_field(obj, res->res_id);
 		if (!obj_field) {
 			LOG_ERR("unable to find obj_field: %u/%u/%u",
 				msg->path.obj_id, msg->path.obj_inst_id,
@@ -513,7 +598,7 @@ static int engine_add_observer(struct lwm2m_message *msg,
 			return -EPERM;
 		}
 
-		ret = update_attrs(&obj_inst->resources[i], &attrs);
+		ret = update_attrs(res, &attrs);
 		if (ret < 0) {
 			return ret;
 		}
@@ -539,12 +624,15 @@ static int engine_add_observer(struct lwm2m_message *msg,
 	observe_node_data[i].last_timestamp = k_uptime_get();
 	observe_node_data[i].event_timestamp =
 			observe_node_data[i].last_timestamp;
+	observe_node_data[i].batch_timestamp =
+			observe_node_data[i].last_timestamp;
 	observe_node_data[i].min_period_sec = attrs.pmin;
 	observe_node_data[i].max_period_sec = MAX(attrs.pmax, attrs.pmin);
 	observe_node_data[i].format = format;
 	observe_node_data[i].counter = 1U;
 	sys_slist_append(&engine_observer_list,
 			 &observe_node_data[i].node);
+	observer_index_add(&observe_node_data[i]);
 
 	LOG_DBG("OBSERVER ADDED %u/%u/%u(%u) token:'%s' addr:%s",
 		msg->path.obj_id, msg->path.obj_inst_id,
@@ -581,6 +669,7 @@ static int engine_remove_observer(const u8_t *token, u8_t tkl)
 	}
 
 	sys_slist_remove(&engine_observer_list, prev_node, &found_obj->node);
+	observer_index_remove(found_obj);
 	(void)memset(found_obj, 0, sizeof(*found_obj));
 
 	LOG_DBG("observer '%s' removed", log_strdup(sprint_token(token, tkl)));
@@ -603,6 +692,7 @@ static void engine_remove_observer_by_id(u16_t obj_id, s32_t obj_inst_id)
 		}
 
 		sys_slist_remove(&engine_observer_list, prev_node, &obs->node);
+		observer_index_remove(obs);
 		(void)memset(obs, 0, sizeof(*obs));
 	}
 }
@@ -611,20 +701,38 @@ static void engine_remove_observer_by_id(u16_t obj_id, s32_t obj_inst_id)
 
 void lwm2m_register_obj(struct lwm2m_engine_obj *obj)
 {
+	int i;
+
+	obj->fields_sorted = true;
+	for (i = 1; i < obj->field_count; i++) {
+		if (obj->fields[i - 1].res_id >= obj->fields[i].res_id) {
+			obj->fields_sorted = false;
+			break;
+		}
+	}
+
 	sys_slist_append(&engine_obj_list, &obj->node);
+	sys_slist_append(index_bucket(engine_obj_index, obj->obj_id, 0),
+			 &obj->index_node);
+	engine_index_generation++;
 }
 
 void lwm2m_unregister_obj(struct lwm2m_engine_obj *obj)
 {
 	engine_remove_observer_by_id(obj->obj_id, -1);
 	sys_slist_find_and_remove(&engine_obj_list, &obj->node);
+	sys_slist_find_and_remove(index_bucket(engine_obj_index,
+					       obj->obj_id, 0),
+				  &obj->index_node);
+	engine_index_generation++;
 }
 
 static struct lwm2m_engine_obj *get_engine_obj(int obj_id)
 {
 	struct lwm2m_engine_obj *obj;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_list, obj, node) {
+	SYS_SLIST_FOR_EACH_CONTAINER(index_bucket(engine_obj_index, obj_id, 0),
+				     obj, index_node) {
 		if (obj->obj_id == obj_id) {
 			return obj;
 		}
@@ -636,14 +744,75 @@ static struct lwm2m_engine_obj *get_engine_obj(int obj_id)
 struct lwm2m_engine_obj_field *
 lwm2m_get_engine_obj_field(struct lwm2m_engine_obj *obj, int res_id)
 {
+	int low, high, mid;
 	int i;
 
-	if (obj && obj->fields && obj->field_count > 0) {
+	if (!obj || !obj->fields || obj->field_count == 0) {
+		return NULL;
+	}
+
+	if (!obj->fields_sorted) {
 		for (i = 0; i < obj->field_count; i++) {
 			if (obj->fields[i].res_id == res_id) {
 				return &obj->fields[i];
 			}
 		}
+
+		return NULL;
+	}
+
+	low = 0;
+	high = obj->field_count - 1;
+
+	while (low <= high) {
+		mid = (low + high) / 2;
+
+		if (obj->fields[mid].res_id == res_id) {
+			return &obj->fields[mid];
+		} else if (obj->fields[mid].res_id < res_id) {
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
+	}
+
+	return NULL;
+}
+
+struct lwm2m_engine_res_inst *
+lwm2m_get_engine_res_inst(struct lwm2m_engine_obj_inst *obj_inst, int res_id)
+{
+	int low, high, mid;
+	int i;
+
+	if (!obj_inst || !obj_inst->resources ||
+	    obj_inst->resource_count == 0U) {
+		return NULL;
+	}
+
+	if (!obj_inst->resources_sorted) {
+		for (i = 0; i < obj_inst->resource_count; i++) {
+			if (obj_inst->resources[i].res_id == res_id) {
+				return &obj_inst->resources[i];
+			}
+		}
+
+		return NULL;
+	}
+
+	low = 0;
+	high = obj_inst->resource_count - 1;
+
+	while (low <= high) {
+		mid = (low + high) / 2;
+
+		if (obj_inst->resources[mid].res_id == res_id) {
+			return &obj_inst->resources[mid];
+		} else if (obj_inst->resources[mid].res_id < res_id) {
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
 	}
 
 	return NULL;
@@ -653,7 +822,26 @@ lwm2m_get_engine_obj_field(struct lwm2m_engine_obj *obj, int res_id)
 
 static void engine_register_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 {
+	int i;
+
+	/* the resources of the object implementations are normally in
+	 * res_id order, this allows them to be found by binary search
+	 */
+	obj_inst->resources_sorted = true;
+	for (i = 1; i < obj_inst->resource_count; i++) {
+		if (obj_inst->resources[i - 1].res_id >=
+		    obj_inst->resources[i].res_id) {
+			obj_inst->resources_sorted = false;
+			break;
+		}
+	}
+
 	sys_slist_append(&engine_obj_inst_list, &obj_inst->node);
+	sys_slist_append(index_bucket(engine_obj_inst_index,
+				      obj_inst->obj->obj_id,
+				      obj_inst->obj_inst_id),
+			 &obj_inst->index_node);
+	engine_index_generation++;
 }
 
 static void engine_unregister_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
@@ -661,6 +849,11 @@ static void engine_unregister_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 	engine_remove_observer_by_id(
 			obj_inst->obj->obj_id, obj_inst->obj_inst_id);
 	sys_slist_find_and_remove(&engine_obj_inst_list, &obj_inst->node);
+	sys_slist_find_and_remove(index_bucket(engine_obj_inst_index,
+					       obj_inst->obj->obj_id,
+					       obj_inst->obj_inst_id),
+				  &obj_inst->index_node);
+	engine_index_generation++;
 }
 
 static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
@@ -668,8 +861,9 @@ static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
 {
 	struct lwm2m_engine_obj_inst *obj_inst;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_inst_list, obj_inst,
-				     node) {
+	SYS_SLIST_FOR_EACH_CONTAINER(index_bucket(engine_obj_inst_index,
+						  obj_id, obj_inst_id),
+				     obj_inst, index_node) {
 		if (obj_inst->obj->obj_id == obj_id &&
 		    obj_inst->obj_inst_id == obj_inst_id) {
 			return obj_inst;
@@ -1143,6 +1337,12 @@ static int select_writer(struct lwm2m_output_context *out, u16_t accept)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		out->writer = &senml_cbor_writer;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", accept);
 		return -ENOMSG;
@@ -1174,6 +1374,12 @@ static int select_reader(struct lwm2m_input_context *in, u16_t format)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		in->reader = &senml_cbor_reader;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", format);
 		return -ENOMSG;
@@ -1257,7 +1463,6 @@ static int path_to_objs(const struct lwm2m_obj_path *path,
 	struct lwm2m_engine_obj_inst *oi;
 	struct lwm2m_engine_obj_field *of;
 	struct lwm2m_engine_res_inst *r = NULL;
-	int i;
 
 	if (!path) {
 		return -EINVAL;
@@ -1281,13 +1486,7 @@ static int path_to_objs(const struct lwm2m_obj_path *path,
 		return -ENOENT;
 	}
 
-	for (i = 0; i < oi->resource_count; i++) {
-		if (oi->resources[i].res_id == path->res_id) {
-			r = &oi->resources[i];
-			break;
-		}
-	}
-
+	r = lwm2m_get_engine_res_inst(oi, path->res_id);
 	if (!r) {
 		LOG_ERR("res instance %d not found", path->res_id);
 		return -ENOENT;
@@ -1362,41 +1561,17 @@ int lwm2m_engine_set_res_data(char *pathstr, void *data_ptr, u16_t data_len,
 	return ret;
 }
 
-static int lwm2m_engine_set(char *pathstr, void *value, u16_t len)
+static int engine_set_res(struct lwm2m_obj_path *path,
+			  struct lwm2m_engine_obj_inst *obj_inst,
+			  struct lwm2m_engine_obj_field *obj_field,
+			  struct lwm2m_engine_res_inst *res,
+			  void *value, u16_t len)
 {
-	struct lwm2m_obj_path path;
-	struct lwm2m_engine_obj_inst *obj_inst;
-	struct lwm2m_engine_obj_field *obj_field;
-	struct lwm2m_engine_res_inst *res = NULL;
 	void *data_ptr = NULL;
 	size_t data_len = 0;
 	int ret = 0;
 	bool changed = false;
 
-	LOG_DBG("path:%s, value:%p, len:%d", log_strdup(pathstr), value, len);
-
-	/* translate path -> path_obj */
-	ret = string_to_path(pathstr, &path, '/');
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (path.level < 3) {
-		LOG_ERR("path must have 3 parts");
-		return -EINVAL;
-	}
-
-	/* look up resource obj */
-	ret = path_to_objs(&path, &obj_inst, &obj_field, &res);
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (!res) {
-		LOG_ERR("res instance %d not found", path.res_id);
-		return -ENOENT;
-	}
-
 	if (LWM2M_HAS_RES_FLAG(res, LWM2M_RES_DATA_FLAG_RO)) {
 		LOG_ERR("res data pointer is read-only");
 		return -EACCES;
@@ -1420,7 +1595,7 @@ static int lwm2m_engine_set(char *pathstr, void *value, u16_t len)
 	if (len > res->data_len -
 		(obj_field->data_type == LWM2M_RES_TYPE_STRING ? 1 : 0)) {
 		LOG_ERR("length %u is too long for resource %d data",
-			len, path.res_id);
+			len, path->res_id);
 		return -ENOMEM;
 	}
 
@@ -1502,12 +1677,42 @@ static int lwm2m_engine_set(char *pathstr, void *value, u16_t len)
 	}
 
 	if (changed) {
-		NOTIFY_OBSERVER_PATH(&path);
+		NOTIFY_OBSERVER_PATH(path);
 	}
 
 	return ret;
 }
 
+static int lwm2m_engine_set(char *pathstr, void *value, u16_t len)
+{
+	struct lwm2m_obj_path path;
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_engine_obj_field *obj_field;
+	struct lwm2m_engine_res_inst *res = NULL;
+	int ret = 0;
+
+	LOG_DBG("path:%s, value:%p, len:%d", log_strdup(pathstr), value, len);
+
+	/* translate path -> path_obj */
+	ret = string_to_path(pathstr, &path, '/');
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (path.level < 3) {
+		LOG_ERR("path must have 3 parts");
+		return -EINVAL;
+	}
+
+	/* look up resource obj */
+	ret = path_to_objs(&path, &obj_inst, &obj_field, &res);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return engine_set_res(&path, obj_inst, obj_field, res, value, len);
+}
+
 int lwm2m_engine_set_opaque(char *pathstr, char *data_ptr, u16_t data_len)
 {
 	return lwm2m_engine_set(pathstr, data_ptr, data_len);
@@ -1608,40 +1813,14 @@ int lwm2m_engine_get_res_data(char *pathstr, void **data_ptr, u16_t *data_len,
 	return 0;
 }
 
-static int lwm2m_engine_get(char *pathstr, void *buf, u16_t buflen)
+static int engine_get_res(struct lwm2m_engine_obj_inst *obj_inst,
+			  struct lwm2m_engine_obj_field *obj_field,
+			  struct lwm2m_engine_res_inst *res,
+			  void *buf, u16_t buflen)
 {
-	int ret = 0;
-	struct lwm2m_obj_path path;
-	struct lwm2m_engine_obj_inst *obj_inst;
-	struct lwm2m_engine_obj_field *obj_field;
-	struct lwm2m_engine_res_inst *res = NULL;
 	void *data_ptr = NULL;
 	size_t data_len = 0;
 
-	LOG_DBG("path:%s, buf:%p, buflen:%d", log_strdup(pathstr), buf, buflen);
-
-	/* translate path -> path_obj */
-	ret = string_to_path(pathstr, &path, '/');
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (path.level < 3) {
-		LOG_ERR("path must have 3 parts");
-		return -EINVAL;
-	}
-
-	/* look up resource obj */
-	ret = path_to_objs(&path, &obj_inst, &obj_field, &res);
-	if (ret < 0) {
-		return ret;
-	}
-
-	if (!res) {
-		LOG_ERR("res instance %d not found", path.res_id);
-		return -ENOENT;
-	}
-
 	/* setup initial data elements */
 	data_ptr = res->data_ptr;
 	data_len = res->data_len;
@@ -1730,6 +1909,36 @@ static int lwm2m_engine_get(char *pathstr, void *buf, u16_t buflen)
 	return 0;
 }
 
+static int lwm2m_engine_get(char *pathstr, void *buf, u16_t buflen)
+{
+	int ret = 0;
+	struct lwm2m_obj_path path;
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_engine_obj_field *obj_field;
+	struct lwm2m_engine_res_inst *res = NULL;
+
+	LOG_DBG("path:%s, buf:%p, buflen:%d", log_strdup(pathstr), buf, buflen);
+
+	/* translate path -> path_obj */
+	ret = string_to_path(pathstr, &path, '/');
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (path.level < 3) {
+		LOG_ERR("path must have 3 parts");
+		return -EINVAL;
+	}
+
+	/* look up resource obj */
+	ret = path_to_objs(&path, &obj_inst, &obj_field, &res);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return engine_get_res(obj_inst, obj_field, res, buf, buflen);
+}
+
 int lwm2m_engine_get_opaque(char *pathstr, void *buf, u16_t buflen)
 {
 	return lwm2m_engine_get(pathstr, buf, buflen);
@@ -1803,6 +2012,100 @@ int lwm2m_engine_get_float64(char *pathstr, float64_value_t *buf)
 	return lwm2m_engine_get(pathstr, buf, sizeof(float64_value_t));
 }
 
+/* path handle functions */
+
+int lwm2m_engine_path_handle_init(char *pathstr,
+				  struct lwm2m_path_handle *handle)
+{
+	struct lwm2m_obj_path path;
+	int ret;
+
+	ret = string_to_path(pathstr, &path, '/');
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (path.level < 3) {
+		LOG_ERR("path must have 3 parts");
+		return -EINVAL;
+	}
+
+	(void)memset(handle, 0, sizeof(*handle));
+	handle->obj_id = path.obj_id;
+	handle->obj_inst_id = path.obj_inst_id;
+	handle->res_id = path.res_id;
+
+	ret = path_to_objs(&path, &handle->obj_inst, &handle->obj_field,
+			   &handle->res);
+	if (ret < 0) {
+		return ret;
+	}
+
+	handle->generation = engine_index_generation;
+
+	return 0;
+}
+
+/* Resolve the objects of a handle again if instances have come and gone
+ * since the last time it was used.
+ */
+static int handle_to_objs(struct lwm2m_path_handle *handle,
+			  struct lwm2m_obj_path *path)
+{
+	int ret;
+
+	(void)memset(path, 0, sizeof(*path));
+	path->obj_id = handle->obj_id;
+	path->obj_inst_id = handle->obj_inst_id;
+	path->res_id = handle->res_id;
+	path->level = 3U;
+
+	if (handle->res && handle->generation == engine_index_generation) {
+		return 0;
+	}
+
+	ret = path_to_objs(path, &handle->obj_inst, &handle->obj_field,
+			   &handle->res);
+	if (ret < 0) {
+		handle->res = NULL;
+		return ret;
+	}
+
+	handle->generation = engine_index_generation;
+
+	return 0;
+}
+
+int lwm2m_engine_set_by_handle(struct lwm2m_path_handle *handle,
+			       void *value, u16_t len)
+{
+	struct lwm2m_obj_path path;
+	int ret;
+
+	ret = handle_to_objs(handle, &path);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return engine_set_res(&path, handle->obj_inst, handle->obj_field,
+			      handle->res, value, len);
+}
+
+int lwm2m_engine_get_by_handle(struct lwm2m_path_handle *handle,
+			       void *buf, u16_t buflen)
+{
+	struct lwm2m_obj_path path;
+	int ret;
+
+	ret = handle_to_objs(handle, &path);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return engine_get_res(handle->obj_inst, handle->obj_field,
+			      handle->res, buf, buflen);
+}
+
 int lwm2m_engine_get_resource(char *pathstr, struct lwm2m_engine_res_inst **res)
 {
 	int ret;
@@ -2665,6 +2968,11 @@ static int do_read_op(struct lwm2m_engine_obj *obj,
 		return do_read_op_json(obj, msg, content_format);
 #endif
 
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_read_op_senml_cbor(obj, msg, content_format);
+#endif
+
 	default:
 		LOG_ERR("Unsupported content-format: %u", content_format);
 		return -ENOMSG;
@@ -3070,6 +3378,11 @@ static int do_write_op(struct lwm2m_engine_obj *obj,
 		return do_write_op_json(obj, msg);
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_write_op_senml_cbor(obj, msg);
+#endif
+
 	default:
 		LOG_ERR("Unsupported format: %u", format);
 		return -ENOMSG;
@@ -3631,7 +3944,7 @@ static int generate_notify_message(struct observe_node *obs,
 				   bool manual_trigger)
 {
 	struct lwm2m_message *msg;
-	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_engine_obj *obj;
 	int ret = 0;
 
 	if (!obs->ctx) {
@@ -3659,12 +3972,11 @@ static int generate_notify_message(struct observe_node *obs,
 		log_strdup(lwm2m_sprint_ip_addr(&obs->ctx->remote_addr)),
 		k_uptime_get());
 
-	obj_inst = get_engine_obj_inst(obs->path.obj_id,
-				       obs->path.obj_inst_id);
-	if (!obj_inst) {
-		LOG_ERR("unable to get engine obj for %u/%u",
-			obs->path.obj_id,
-			obs->path.obj_inst_id);
+	/* an object observation reports all of its instances */
+	obj = get_engine_obj(obs->path.obj_id);
+	if (!obj) {
+		LOG_ERR("unable to get engine obj for %u",
+			obs->path.obj_id);
 		ret = -EINVAL;
 		goto cleanup;
 	}
@@ -3695,7 +4007,7 @@ static int generate_notify_message(struct observe_node *obs,
 	/* set the output writer */
 	select_writer(&msg->out, obs->format);
 
-	ret = do_read_op(obj_inst->obj, msg, obs->format);
+	ret = do_read_op(obj, msg, obs->format);
 	if (ret < 0) {
 		LOG_ERR("error in multi-format read (err:%d)", ret);
 		goto cleanup;
@@ -3783,10 +4095,13 @@ static int lwm2m_engine_service(void)
 		 * manual notify requirements:
 		 * - event_timestamp > last_timestamp
 		 * - current timestamp > last_timestamp + min_period_sec
+		 * - current timestamp >= batch_timestamp + notify window
 		 */
 		if (obs->event_timestamp > obs->last_timestamp &&
 		    timestamp > obs->last_timestamp +
-				K_SECONDS(obs->min_period_sec)) {
+				K_SECONDS(obs->min_period_sec) &&
+		    timestamp >= obs->batch_timestamp +
+				K_MSEC(CONFIG_LWM2M_ENGINE_NOTIFY_WINDOW_MS)) {
 			obs->last_timestamp = k_uptime_get();
 			generate_notify_message(obs, true);
 
@@ -3795,7 +4110,7 @@ static int lwm2m_engine_service(void)
 		 * - current timestamp > last_timestamp + max_period_sec
 		 */
 		} else if (timestamp > obs->last_timestamp +
-				K_SECONDS(obs->min_period_sec)) {
+				K_SECONDS(obs->max_period_sec)) {
 			obs->last_timestamp = k_uptime_get();
 			generate_notify_message(obs, false);
 		}
@@ -3829,6 +4144,7 @@ int lwm2m_engine_context_close(struct lwm2m_ctx *client_ctx)
 		if (obs->ctx == client_ctx) {
 			sys_slist_remove(&engine_observer_list, prev_node,
 					 &obs->node);
+			observer_index_remove(obs);
 			(void)memset(obs, 0, sizeof(*obs));
 		} else {
 			prev_node = &obs->node;
@@ -175,6 +175,9 @@ struct lwm2m_engine_obj {
 	/* object list */
 	sys_snode_t node;
 
+	/* object index bucket */
+	sys_snode_t index_node;
+
 	/* object field definitions */
 	struct lwm2m_engine_obj_field *fields;
 
@@ -189,6 +192,9 @@ struct lwm2m_engine_obj {
 	u16_t field_count;
 	u16_t instance_count;
 	u16_t max_instance_count;
+
+	/* fields are in ascending res_id order */
+	bool fields_sorted;
 };
 
 #define INIT_OBJ_RES(res_var, index_var, id_val, multi_var, \
@@ -257,12 +263,18 @@ struct lwm2m_engine_obj_inst {
 	/* instance list */
 	sys_snode_t node;
 
+	/* instance index bucket */
+	sys_snode_t index_node;
+
 	struct lwm2m_engine_obj *obj;
 	struct lwm2m_engine_res_inst *resources;
 
 	/* object instance member data */
 	u16_t obj_inst_id;
 	u16_t resource_count;
+
+	/* resources are in ascending res_id order */
+	bool resources_sorted;
 };
 
 struct lwm2m_output_context {
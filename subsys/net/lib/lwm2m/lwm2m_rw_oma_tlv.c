@@ -811,7 +811,7 @@ static int do_write_op_tlv_item(struct lwm2m_message *msg)
 	struct lwm2m_engine_res_inst *res = NULL;
 	struct lwm2m_engine_obj_field *obj_field = NULL;
 	u8_t created = 0U;
-	int ret, i;
+	int ret;
 
 	ret = lwm2m_get_or_create_engine_obj(msg, &obj_inst, &created);
 	if (ret < 0) {
@@ -835,12 +835,7 @@ static int do_write_op_tlv_item(struct lwm2m_message *msg)
 		goto error;
 	}
 
-	for (i = 0; i < obj_inst->resource_count; i++) {
-		if (obj_inst->resources[i].res_id == msg->path.res_id) {
-			res = &obj_inst->resources[i];
-			break;
-		}
-	}
+	res = lwm2m_get_engine_res_inst(obj_inst, msg->path.res_id);
 
 	if (!res) {
 		/* if OPTIONAL and BOOTSTRAP-WRITE or CREATE use ENOTSUP */
@@ -333,7 +333,7 @@ int do_write_op_plain_text(struct lwm2m_engine_obj *obj,
 	struct lwm2m_engine_obj_inst *obj_inst = NULL;
 	struct lwm2m_engine_obj_field *obj_field;
 	struct lwm2m_engine_res_inst *res = NULL;
-	int ret, i;
+	int ret;
 	u8_t created = 0U;
 
 	ret = lwm2m_get_or_create_engine_obj(msg, &obj_inst, &created);
@@ -354,12 +354,7 @@ int do_write_op_plain_text(struct lwm2m_engine_obj *obj,
 		return -EINVAL;
 	}
 
-	for (i = 0; i < obj_inst->resource_count; i++) {
-		if (obj_inst->resources[i].res_id == msg->path.res_id) {
-			res = &obj_inst->resources[i];
-			break;
-		}
-	}
+	res = lwm2m_get_engine_res_inst(obj_inst, msg->path.res_id);
 
 	if (!res) {
 		return -ENOENT;
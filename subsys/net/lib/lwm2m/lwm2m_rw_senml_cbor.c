@@ -0,0 +1,765 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * SenML CBOR content format (RFC 8428, section 6)
+ *
+ * The records are written as an indefinite length array of maps using
+ * the integer SenML labels. A base name "/obj/inst/" is only written in
+ * the first record of each object instance, the other records only carry
+ * the resource ID as name, which keeps the payload close to the size of
+ * OMA-TLV while staying readable by generic SenML tools.
+ *
+ * The data items are encoded and decoded by the CBOR library.
+ */
+
+#define LOG_MODULE_NAME net_lwm2m_senml_cbor
+#define LOG_LEVEL CONFIG_LWM2M_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <cbor.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_rw_senml_cbor.h"
+#include "lwm2m_engine.h"
+#include "lwm2m_util.h"
+
+/* SenML labels */
+#define SENML_BASE_NAME		-2
+#define SENML_NAME		0
+#define SENML_VALUE		2
+#define SENML_STRING_VALUE	3
+#define SENML_BOOL_VALUE	4
+#define SENML_DATA_VALUE	8
+
+#define NAME_BUF_LEN		32
+
+struct cbor_out_formatter_data {
+	/* flags */
+	u8_t writer_flags;
+
+	/* next record starts a new object instance */
+	bool base_name_pending;
+
+	/* first error met while writing */
+	int error;
+};
+
+struct cbor_in_formatter_data {
+	/* position of the value of the current record */
+	u16_t value_offset;
+};
+
+/* encoding */
+
+/* Output of the CBOR encoder. The first error is kept in the formatter
+ * data, as the writer callbacks cannot return it to the engine.
+ */
+static int append_bytes(const char *bytes, size_t len, void *data)
+{
+	struct lwm2m_output_context *out = data;
+	struct cbor_out_formatter_data *fd;
+
+	if (len > UINT16_MAX ||
+	    buf_append(CPKT_BUF_WRITE(out->out_cpkt), (u8_t *)bytes,
+		       len) < 0) {
+		fd = engine_get_out_user_data(out);
+		if (fd && !fd->error) {
+			fd->error = -ENOMEM;
+		}
+
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/* Start a record: the base name if needed, the name and the value label */
+static int put_record(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int label)
+{
+	struct cbor_out_formatter_data *fd;
+	char name[NAME_BUF_LEN];
+	int name_len;
+	int ret;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return -EINVAL;
+	}
+
+	ret = cbor_encode_map(fd->base_name_pending ? 3 : 2, append_bytes,
+			      out);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (fd->base_name_pending) {
+		name_len = snprintk(name, sizeof(name), "/%u/%u/",
+				    path->obj_id, path->obj_inst_id);
+
+		ret = cbor_encode_int(SENML_BASE_NAME, append_bytes, out);
+		if (ret < 0) {
+			return ret;
+		}
+
+		ret = cbor_encode_text(name, name_len, append_bytes, out);
+		if (ret < 0) {
+			return ret;
+		}
+
+		fd->base_name_pending = false;
+	}
+
+	if (fd->writer_flags & WRITER_RESOURCE_INSTANCE) {
+		name_len = snprintk(name, sizeof(name), "%u/%u",
+				    path->res_id, path->res_inst_id);
+	} else {
+		name_len = snprintk(name, sizeof(name), "%u", path->res_id);
+	}
+
+	ret = cbor_encode_int(SENML_NAME, append_bytes, out);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = cbor_encode_text(name, name_len, append_bytes, out);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return cbor_encode_int(label, append_bytes, out);
+}
+
+static size_t put_begin(struct lwm2m_output_context *out,
+			struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+	u16_t start = out->out_cpkt->offset;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->base_name_pending = true;
+
+	if (cbor_encode_array(CBOR_INDEFINITE_LEN, append_bytes, out) < 0) {
+		return 0;
+	}
+
+	return out->out_cpkt->offset - start;
+}
+
+static size_t put_end(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path)
+{
+	u16_t start = out->out_cpkt->offset;
+
+	if (cbor_encode_break(append_bytes, out) < 0) {
+		return 0;
+	}
+
+	return out->out_cpkt->offset - start;
+}
+
+static size_t put_begin_oi(struct lwm2m_output_context *out,
+			   struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->base_name_pending = true;
+	return 0;
+}
+
+static size_t put_begin_ri(struct lwm2m_output_context *out,
+			   struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags |= WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+static size_t put_end_ri(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags &= ~WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+static size_t put_s64(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, s64_t value)
+{
+	u16_t start = out->out_cpkt->offset;
+
+	if (put_record(out, path, SENML_VALUE) < 0 ||
+	    cbor_encode_int(value, append_bytes, out) < 0) {
+		return 0;
+	}
+
+	return out->out_cpkt->offset - start;
+}
+
+static size_t put_s32(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, s32_t value)
+{
+	return put_s64(out, path, (s64_t)value);
+}
+
+static size_t put_s16(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, s16_t value)
+{
+	return put_s64(out, path, (s64_t)value);
+}
+
+static size_t put_s8(struct lwm2m_output_context *out,
+		     struct lwm2m_obj_path *path, s8_t value)
+{
+	return put_s64(out, path, (s64_t)value);
+}
+
+static size_t put_string(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	u16_t start = out->out_cpkt->offset;
+
+	if (put_record(out, path, SENML_STRING_VALUE) < 0 ||
+	    cbor_encode_text(buf, buflen, append_bytes, out) < 0) {
+		return 0;
+	}
+
+	return out->out_cpkt->offset - start;
+}
+
+static size_t put_opaque(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	u16_t start = out->out_cpkt->offset;
+
+	if (put_record(out, path, SENML_DATA_VALUE) < 0 ||
+	    cbor_encode_bytes((u8_t *)buf, buflen, append_bytes, out) < 0) {
+		return 0;
+	}
+
+	return out->out_cpkt->offset - start;
+}
+
+static size_t put_float32fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float32_value_t *value)
+{
+	u16_t start = out->out_cpkt->offset;
+	u8_t b32[4];
+	int ret;
+
+	ret = lwm2m_f32_to_b32(value, b32, sizeof(b32));
+	if (ret < 0) {
+		LOG_ERR("float32 conversion error: %d", ret);
+		return 0;
+	}
+
+	if (put_record(out, path, SENML_VALUE) < 0 ||
+	    cbor_encode_float(b32, sizeof(b32), append_bytes, out) < 0) {
+		return 0;
+	}
+
+	return out->out_cpkt->offset - start;
+}
+
+static size_t put_float64fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float64_value_t *value)
+{
+	u16_t start = out->out_cpkt->offset;
+	u8_t b64[8];
+	int ret;
+
+	ret = lwm2m_f64_to_b64(value, b64, sizeof(b64));
+	if (ret < 0) {
+		LOG_ERR("float64 conversion error: %d", ret);
+		return 0;
+	}
+
+	if (put_record(out, path, SENML_VALUE) < 0 ||
+	    cbor_encode_float(b64, sizeof(b64), append_bytes, out) < 0) {
+		return 0;
+	}
+
+	return out->out_cpkt->offset - start;
+}
+
+static size_t put_bool(struct lwm2m_output_context *out,
+		       struct lwm2m_obj_path *path,
+		       bool value)
+{
+	u16_t start = out->out_cpkt->offset;
+
+	if (put_record(out, path, SENML_BOOL_VALUE) < 0 ||
+	    cbor_encode_bool(value, append_bytes, out) < 0) {
+		return 0;
+	}
+
+	return out->out_cpkt->offset - start;
+}
+
+/* decoding */
+
+static void reader_init(struct cbor_reader *reader, struct coap_packet *cpkt,
+			u16_t offset)
+{
+	cbor_reader_init(reader, cpkt->data + offset, cpkt->max_len - offset);
+}
+
+/* Reader positioned on the value of the current record */
+static int value_reader_init(struct lwm2m_input_context *in,
+			     struct cbor_reader *reader)
+{
+	struct cbor_in_formatter_data *fd;
+
+	fd = engine_get_in_user_data(in);
+	if (!fd) {
+		return -EINVAL;
+	}
+
+	reader_init(reader, in->in_cpkt, fd->value_offset);
+
+	return 0;
+}
+
+static int get_text(struct cbor_reader *reader, u8_t *buf, size_t buflen)
+{
+	const char *text;
+	size_t len;
+
+	if (cbor_read_text(reader, &text, &len) < 0 || len >= buflen) {
+		return -EINVAL;
+	}
+
+	memcpy(buf, text, len);
+	buf[len] = '\0';
+
+	return len;
+}
+
+/* Read the value of the current record as a number */
+static size_t get_number(struct lwm2m_input_context *in,
+			 float64_value_t *value)
+{
+	struct cbor_reader reader;
+	const u8_t *start, *bits;
+	float32_value_t f32;
+	u8_t b64[8];
+	u8_t b32[4];
+	s64_t num;
+	size_t len;
+
+	if (value_reader_init(in, &reader) < 0) {
+		return 0;
+	}
+
+	start = reader.pos;
+	value->val1 = 0;
+	value->val2 = 0;
+
+	if (cbor_read_int64(&reader, &num) == 0) {
+		value->val1 = num;
+		return reader.pos - start;
+	}
+
+	if (cbor_read_float(&reader, &bits, &len) < 0) {
+		LOG_ERR("value is not a number");
+		return 0;
+	}
+
+	if (len == sizeof(b32)) {
+		memcpy(b32, bits, len);
+		if (lwm2m_b32_to_f32(b32, sizeof(b32), &f32) < 0) {
+			return 0;
+		}
+
+		value->val1 = f32.val1;
+		value->val2 = (s64_t)f32.val2 *
+			(LWM2M_FLOAT64_DEC_MAX / LWM2M_FLOAT32_DEC_MAX);
+	} else if (len == sizeof(b64)) {
+		memcpy(b64, bits, len);
+		if (lwm2m_b64_to_f64(b64, sizeof(b64), value) < 0) {
+			return 0;
+		}
+	} else {
+		LOG_ERR("unsupported float size %zu", len);
+		return 0;
+	}
+
+	return reader.pos - start;
+}
+
+static size_t get_s64(struct lwm2m_input_context *in, s64_t *value)
+{
+	float64_value_t number;
+	size_t len;
+
+	len = get_number(in, &number);
+	if (len > 0) {
+		*value = number.val1;
+	}
+
+	return len;
+}
+
+static size_t get_s32(struct lwm2m_input_context *in, s32_t *value)
+{
+	float64_value_t number;
+	size_t len;
+
+	len = get_number(in, &number);
+	if (len > 0) {
+		*value = (s32_t)number.val1;
+	}
+
+	return len;
+}
+
+static size_t get_float32fix(struct lwm2m_input_context *in,
+			     float32_value_t *value)
+{
+	float64_value_t number;
+	size_t len;
+
+	len = get_number(in, &number);
+	if (len > 0) {
+		value->val1 = (s32_t)number.val1;
+		value->val2 = (s32_t)(number.val2 /
+				(LWM2M_FLOAT64_DEC_MAX / LWM2M_FLOAT32_DEC_MAX));
+	}
+
+	return len;
+}
+
+static size_t get_float64fix(struct lwm2m_input_context *in,
+			     float64_value_t *value)
+{
+	return get_number(in, value);
+}
+
+static size_t get_bool(struct lwm2m_input_context *in, bool *value)
+{
+	struct cbor_reader reader;
+	const u8_t *start;
+
+	if (value_reader_init(in, &reader) < 0) {
+		return 0;
+	}
+
+	start = reader.pos;
+	if (cbor_read_bool(&reader, value) < 0) {
+		return 0;
+	}
+
+	return reader.pos - start;
+}
+
+static size_t get_string(struct lwm2m_input_context *in,
+			 u8_t *buf, size_t buflen)
+{
+	struct cbor_reader reader;
+	const char *text;
+	size_t len;
+
+	if (buflen == 0 || value_reader_init(in, &reader) < 0 ||
+	    cbor_read_text(&reader, &text, &len) < 0) {
+		return 0;
+	}
+
+	if (len >= buflen) {
+		LOG_WRN("string truncated from %zu to %zu bytes", len,
+			buflen - 1);
+		len = buflen - 1;
+	}
+
+	memcpy(buf, text, len);
+	buf[len] = '\0';
+
+	return len;
+}
+
+static size_t get_opaque(struct lwm2m_input_context *in,
+			 u8_t *value, size_t buflen, bool *last_block)
+{
+	struct cbor_reader reader;
+	const u8_t *bytes;
+	size_t len;
+
+	if (value_reader_init(in, &reader) < 0 ||
+	    cbor_read_bytes(&reader, &bytes, &len) < 0 || len > UINT16_MAX) {
+		return 0;
+	}
+
+	/* the engine reads the data from the input position */
+	in->offset = bytes - in->in_cpkt->data;
+	in->opaque_len = len;
+
+	return lwm2m_engine_get_opaque_more(in, value, buflen, last_block);
+}
+
+const struct lwm2m_writer senml_cbor_writer = {
+	.put_begin = put_begin,
+	.put_end = put_end,
+	.put_begin_oi = put_begin_oi,
+	.put_begin_ri = put_begin_ri,
+	.put_end_ri = put_end_ri,
+	.put_s8 = put_s8,
+	.put_s16 = put_s16,
+	.put_s32 = put_s32,
+	.put_s64 = put_s64,
+	.put_string = put_string,
+	.put_float32fix = put_float32fix,
+	.put_float64fix = put_float64fix,
+	.put_bool = put_bool,
+	.put_opaque = put_opaque,
+};
+
+const struct lwm2m_reader senml_cbor_reader = {
+	.get_s32 = get_s32,
+	.get_s64 = get_s64,
+	.get_string = get_string,
+	.get_float32fix = get_float32fix,
+	.get_float64fix = get_float64fix,
+	.get_bool = get_bool,
+	.get_opaque = get_opaque,
+};
+
+int do_read_op_senml_cbor(struct lwm2m_engine_obj *obj,
+			  struct lwm2m_message *msg, int content_format)
+{
+	struct cbor_out_formatter_data fd;
+	int ret;
+
+	(void)memset(&fd, 0, sizeof(fd));
+	engine_set_out_user_data(&msg->out, &fd);
+	ret = lwm2m_perform_read_op(obj, msg, content_format);
+	engine_clear_out_user_data(&msg->out);
+
+	if (ret == 0 && fd.error < 0) {
+		LOG_ERR("SenML pack does not fit in the message");
+		ret = fd.error;
+	}
+
+	return ret;
+}
+
+static int parse_path(const u8_t *buf, struct lwm2m_obj_path *path)
+{
+	u16_t *id[] = { &path->obj_id, &path->obj_inst_id,
+			&path->res_id, &path->res_inst_id };
+	u32_t val;
+
+	(void)memset(path, 0, sizeof(*path));
+
+	while (*buf) {
+		/* skip slashes between the IDs */
+		if (*buf == '/') {
+			buf++;
+			continue;
+		}
+
+		if (!isdigit(*buf) || path->level == ARRAY_SIZE(id)) {
+			return -EINVAL;
+		}
+
+		val = 0U;
+		while (isdigit(*buf)) {
+			val = val * 10U + (*buf++ - '0');
+			if (val > UINT16_MAX) {
+				return -EINVAL;
+			}
+		}
+
+		*id[path->level++] = val;
+	}
+
+	return 0;
+}
+
+/* Write the value of a record to the resource it names */
+static int write_record(struct lwm2m_engine_obj *obj,
+			struct lwm2m_message *msg, const u8_t *name)
+{
+	struct lwm2m_engine_obj_field *obj_field;
+	struct lwm2m_engine_obj_inst *obj_inst = NULL;
+	struct lwm2m_engine_res_inst *res;
+	u8_t created = 0U;
+	int ret;
+
+	ret = parse_path(name, &msg->path);
+	if (ret < 0 || msg->path.level < 3U) {
+		LOG_ERR("invalid record name %s", log_strdup(name));
+		return -EINVAL;
+	}
+
+	ret = lwm2m_get_or_create_engine_obj(msg, &obj_inst, &created);
+	if (ret < 0) {
+		return ret;
+	}
+
+	obj_field = lwm2m_get_engine_obj_field(obj, msg->path.res_id);
+	if (!obj_field) {
+		return -ENOENT;
+	}
+
+	if (!LWM2M_HAS_PERM(obj_field, LWM2M_PERM_W)) {
+		return -EPERM;
+	}
+
+	res = lwm2m_get_engine_res_inst(obj_inst, msg->path.res_id);
+	if (!res) {
+		return -ENOENT;
+	}
+
+	return lwm2m_write_handler(obj_inst, res, obj_field, msg);
+}
+
+int do_write_op_senml_cbor(struct lwm2m_engine_obj *obj,
+			   struct lwm2m_message *msg)
+{
+	struct coap_packet *cpkt = msg->in.in_cpkt;
+	struct cbor_in_formatter_data fd;
+	struct lwm2m_obj_path orig_path;
+	u8_t base_name[MAX_RESOURCE_LEN];
+	u8_t name[MAX_RESOURCE_LEN];
+	u8_t full_name[MAX_RESOURCE_LEN * 2];
+	struct cbor_reader reader;
+	size_t records, pairs;
+	bool indefinite, map_indefinite, has_value;
+	int ret = 0;
+	s32_t key;
+
+	(void)memset(&fd, 0, sizeof(fd));
+	engine_set_in_user_data(&msg->in, &fd);
+
+	/* store a copy of the original path */
+	memcpy(&orig_path, &msg->path, sizeof(msg->path));
+
+	base_name[0] = '\0';
+
+	reader_init(&reader, cpkt, msg->in.offset);
+
+	ret = cbor_read_array(&reader, &records);
+	if (ret < 0) {
+		LOG_ERR("SenML pack is not an array");
+		goto out;
+	}
+
+	indefinite = records == CBOR_INDEFINITE_LEN;
+
+	while (records--) {
+		/* a break ends an indefinite length array */
+		if (indefinite && cbor_read_break(&reader) == 0) {
+			break;
+		}
+
+		ret = cbor_read_map(&reader, &pairs);
+		if (ret < 0) {
+			break;
+		}
+
+		map_indefinite = pairs == CBOR_INDEFINITE_LEN;
+		name[0] = '\0';
+		has_value = false;
+
+		while (pairs--) {
+			if (map_indefinite && cbor_read_break(&reader) == 0) {
+				break;
+			}
+
+			ret = cbor_read_int(&reader, &key);
+			if (ret < 0) {
+				break;
+			}
+
+			switch (key) {
+
+			case SENML_BASE_NAME:
+				ret = get_text(&reader, base_name,
+					       sizeof(base_name));
+				break;
+
+			case SENML_NAME:
+				ret = get_text(&reader, name, sizeof(name));
+				break;
+
+			case SENML_VALUE:
+			case SENML_STRING_VALUE:
+			case SENML_BOOL_VALUE:
+			case SENML_DATA_VALUE:
+				fd.value_offset = reader.pos - cpkt->data;
+				has_value = true;
+				ret = cbor_skip(&reader);
+				break;
+
+			default:
+				/* ignore the other fields (time, unit, ...) */
+				ret = cbor_skip(&reader);
+				break;
+
+			}
+
+			if (ret < 0) {
+				break;
+			}
+		}
+
+		if (ret < 0) {
+			LOG_ERR("invalid SenML record");
+			break;
+		}
+
+		if (!has_value) {
+			continue;
+		}
+
+		snprintk(full_name, sizeof(full_name), "%s%s",
+			 base_name, name);
+
+		ret = write_record(obj, msg, full_name);
+		if (ret < 0 && orig_path.level == 3U) {
+			/* return errors on a single write */
+			break;
+		}
+
+		ret = 0;
+	}
+
+out:
+	engine_clear_in_user_data(&msg->in);
+
+	return ret;
+}
@@ -129,7 +129,7 @@ static int client_read(struct mqtt_client *client)
 	}
 
 	err_code = mqtt_handle_rx(client);
-	if (err_code < 0) {
+	if (err_code < 0 && MQTT_HAS_STATE(client, MQTT_STATE_TCP_CONNECTED)) {
 		client_disconnect(client, err_code);
 	}
 
@@ -157,6 +157,276 @@ static int client_write(struct mqtt_client *client, const u8_t *data,
 	return 0;
 }
 
+/**@brief Sends the data pending in the tx buffer. */
+static int tx_flush(struct mqtt_client *client, struct buf_ctx *pending)
+{
+	int err_code = 0;
+
+	if (pending->end > pending->cur) {
+		err_code = client_write(client, pending->cur,
+					pending->end - pending->cur);
+	}
+
+	pending->end = pending->cur;
+
+	return err_code;
+}
+
+/**@brief Appends a publish message to the data pending in the tx buffer.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[inout] pending Data pending in the tx buffer, from its beginning.
+ * @param[in] param Publish message parameters.
+ *
+ * @retval 0 if the message was appended.
+ * @retval 1 if only the header was appended, the payload does not fit.
+ * @retval -ENOSPC if the pending data shall be sent first.
+ * @retval Another error code if the message cannot be encoded.
+ */
+static int publish_stage(struct mqtt_client *client, struct buf_ctx *pending,
+			 const struct mqtt_publish_param *param)
+{
+	u8_t *tx_end = client->tx_buf + client->tx_buf_size;
+	u32_t payload_len = param->message.payload.len;
+	struct buf_ctx packet;
+	u32_t header_len;
+	int err_code;
+
+	packet.cur = pending->end;
+	packet.end = tx_end;
+
+	err_code = publish_encode(param, &packet);
+	if (err_code == -ENOMEM && pending->end > pending->cur) {
+		return -ENOSPC;
+	} else if (err_code < 0) {
+		return err_code;
+	}
+
+	header_len = packet.end - packet.cur;
+
+	if (tx_end - pending->end - header_len < payload_len &&
+	    pending->end > pending->cur) {
+		return -ENOSPC;
+	}
+
+	/* Close the gap left by the variable length of the fixed header. */
+	memmove(pending->end, packet.cur, header_len);
+	pending->end += header_len;
+
+	if (tx_end - pending->end < payload_len) {
+		return 1;
+	}
+
+	memcpy(pending->end, param->message.payload.data, payload_len);
+	pending->end += payload_len;
+
+	return 0;
+}
+
+/**@brief Publishes a message, packed with the data pending in the tx buffer
+ *        if it fits.
+ */
+static int publish_send(struct mqtt_client *client, struct buf_ctx *pending,
+			const struct mqtt_publish_param *param)
+{
+	int err_code;
+
+	err_code = publish_stage(client, pending, param);
+	if (err_code == -ENOSPC) {
+		err_code = tx_flush(client, pending);
+		if (err_code < 0) {
+			return err_code;
+		}
+
+		err_code = publish_stage(client, pending, param);
+	}
+
+	if (err_code <= 0) {
+		return err_code;
+	}
+
+	/* Send the payload directly from the memory of the caller. */
+	err_code = tx_flush(client, pending);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	return client_write(client, param->message.payload.data,
+			    param->message.payload.len);
+}
+
+#if defined(CONFIG_MQTT_INFLIGHT)
+static struct mqtt_inflight *inflight_find(struct mqtt_client *client,
+					   u16_t message_id)
+{
+	struct mqtt_inflight *inflight = client->internal.inflight;
+	int i;
+
+	for (i = 0; i < CONFIG_MQTT_INFLIGHT_WINDOW; i++) {
+		if (inflight[i].awaiting &&
+		    inflight[i].param.message_id == message_id) {
+			return &inflight[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**@brief Gets the slot to track a message, the one of its previous
+ *        transmission if any.
+ */
+static struct mqtt_inflight *inflight_slot(struct mqtt_client *client,
+					   u16_t message_id)
+{
+	struct mqtt_inflight *inflight = client->internal.inflight;
+	struct mqtt_inflight *free_slot = NULL;
+	int i;
+
+	for (i = 0; i < CONFIG_MQTT_INFLIGHT_WINDOW; i++) {
+		if (!inflight[i].awaiting) {
+			if (free_slot == NULL) {
+				free_slot = &inflight[i];
+			}
+		} else if (inflight[i].param.message_id == message_id) {
+			return &inflight[i];
+		}
+	}
+
+	return free_slot;
+}
+
+static void inflight_track(struct mqtt_inflight *inflight,
+			   const struct mqtt_publish_param *param)
+{
+	inflight->param = *param;
+	inflight->timestamp = mqtt_sys_tick_in_ms_get();
+
+	if (param->message.topic.qos == MQTT_QOS_1_AT_LEAST_ONCE) {
+		inflight->awaiting = MQTT_PKT_TYPE_PUBACK;
+	} else {
+		inflight->awaiting = MQTT_PKT_TYPE_PUBREC;
+	}
+}
+
+/**@brief Sends the messages in flight again, all of them or only those
+ *        not acknowledged in time.
+ */
+static int inflight_retransmit(struct mqtt_client *client, bool all)
+{
+	struct mqtt_inflight *inflight = client->internal.inflight;
+	struct mqtt_pubrel_param pubrel;
+	struct buf_ctx pending;
+	struct buf_ctx packet;
+	int err_code = 0;
+	int i;
+
+	pending.cur = client->tx_buf;
+	pending.end = client->tx_buf;
+
+	for (i = 0; i < CONFIG_MQTT_INFLIGHT_WINDOW; i++) {
+		if (!inflight[i].awaiting) {
+			continue;
+		}
+
+		if (!all && mqtt_elapsed_time_in_ms_get(inflight[i].timestamp) <
+			    CONFIG_MQTT_INFLIGHT_RETRY_TIMEOUT) {
+			continue;
+		}
+
+		MQTT_TRC("[CID %p]: Retransmitting message id 0x%04x",
+			 client, inflight[i].param.message_id);
+
+		if (inflight[i].awaiting == MQTT_PKT_TYPE_PUBCOMP) {
+			err_code = tx_flush(client, &pending);
+			if (err_code < 0) {
+				return err_code;
+			}
+
+			pubrel.message_id = inflight[i].param.message_id;
+
+			tx_buf_init(client, &packet);
+
+			err_code = publish_release_encode(&pubrel, &packet);
+			if (err_code == 0) {
+				err_code = client_write(client, packet.cur,
+							packet.end - packet.cur);
+			}
+		} else {
+			inflight[i].param.dup_flag = 1U;
+
+			err_code = publish_send(client, &pending,
+						&inflight[i].param);
+		}
+
+		if (err_code < 0) {
+			return err_code;
+		}
+
+		inflight[i].timestamp = mqtt_sys_tick_in_ms_get();
+	}
+
+	return tx_flush(client, &pending);
+}
+
+void mqtt_inflight_ack(struct mqtt_client *client, u8_t type,
+		       u16_t message_id)
+{
+	struct mqtt_inflight *inflight;
+
+	inflight = inflight_find(client, message_id);
+	if (inflight == NULL || inflight->awaiting != type) {
+		return;
+	}
+
+	if (type == MQTT_PKT_TYPE_PUBREC) {
+		/* The application releases the message with PUBREL. */
+		inflight->awaiting = MQTT_PKT_TYPE_PUBCOMP;
+		inflight->timestamp = mqtt_sys_tick_in_ms_get();
+	} else {
+		inflight->awaiting = 0U;
+	}
+}
+
+int mqtt_inflight_resume(struct mqtt_client *client, bool session_present)
+{
+	if (!session_present) {
+		/* The broker discarded the session, so do we. */
+		memset(client->internal.inflight, 0,
+		       sizeof(client->internal.inflight));
+		return 0;
+	}
+
+	return inflight_retransmit(client, true);
+}
+#endif /* CONFIG_MQTT_INFLIGHT */
+
+/**@brief Publishes a message and tracks it until it is acknowledged. */
+static int publish_tracked(struct mqtt_client *client,
+			   struct buf_ctx *pending,
+			   const struct mqtt_publish_param *param)
+{
+#if defined(CONFIG_MQTT_INFLIGHT)
+	struct mqtt_inflight *inflight = NULL;
+	int err_code;
+
+	if (param->message.topic.qos > MQTT_QOS_0_AT_MOST_ONCE) {
+		inflight = inflight_slot(client, param->message_id);
+		if (inflight == NULL) {
+			return -EAGAIN;
+		}
+	}
+
+	err_code = publish_send(client, pending, param);
+	if (err_code == 0 && inflight != NULL) {
+		inflight_track(inflight, param);
+	}
+
+	return err_code;
+#else
+	return publish_send(client, pending, param);
+#endif /* CONFIG_MQTT_INFLIGHT */
+}
+
 void mqtt_client_init(struct mqtt_client *client)
 {
 	NULL_PARAM_CHECK_VOID(client);
@@ -209,7 +479,7 @@ int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param)
 {
 	int err_code;
-	struct buf_ctx packet;
+	struct buf_ctx pending;
 
 	NULL_PARAM_CHECK(client);
 	NULL_PARAM_CHECK(param);
@@ -221,29 +491,76 @@ int mqtt_publish(struct mqtt_client *client,
 
 	mqtt_mutex_lock(client);
 
-	tx_buf_init(client, &packet);
-
 	err_code = verify_tx_state(client);
 	if (err_code < 0) {
 		goto error;
 	}
 
-	err_code = publish_encode(param, &packet);
+	pending.cur = client->tx_buf;
+	pending.end = client->tx_buf;
+
+	err_code = publish_tracked(client, &pending, param);
 	if (err_code < 0) {
 		goto error;
 	}
 
-	err_code = client_write(client, packet.cur, packet.end - packet.cur);
+	err_code = tx_flush(client, &pending);
+
+error:
+	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
+			 client, client->internal.state, err_code);
+
+	mqtt_mutex_unlock(client);
+
+	return err_code;
+}
+
+int mqtt_publish_batch(struct mqtt_client *client,
+		       const struct mqtt_publish_param *params, size_t count)
+{
+	int err_code, flush_err_code;
+	struct buf_ctx pending;
+	size_t i;
+
+	NULL_PARAM_CHECK(client);
+	NULL_PARAM_CHECK(params);
+
+	MQTT_TRC("[CID %p]:[State 0x%02x]: >> Message count %zu",
+		 client, client->internal.state, count);
+
+	mqtt_mutex_lock(client);
+
+	err_code = verify_tx_state(client);
 	if (err_code < 0) {
 		goto error;
 	}
 
-	err_code = client_write(client, param->message.payload.data,
-				param->message.payload.len);
+	pending.cur = client->tx_buf;
+	pending.end = client->tx_buf;
+
+	for (i = 0; i < count; i++) {
+		err_code = publish_tracked(client, &pending, &params[i]);
+		if (err_code < 0) {
+			break;
+		}
+	}
+
+	/* A transport error has closed the connection. */
+	if (verify_tx_state(client) < 0) {
+		goto error;
+	}
+
+	/* Send what was packed before a message could not be published. */
+	flush_err_code = tx_flush(client, &pending);
+	if (flush_err_code < 0) {
+		err_code = flush_err_code;
+	} else if (i > 0) {
+		err_code = i;
+	}
 
 error:
 	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
-			 client, client->internal.state, err_code);
+		 client, client->internal.state, err_code);
 
 	mqtt_mutex_unlock(client);
 
@@ -352,6 +669,18 @@ int mqtt_publish_qos2_release(struct mqtt_client *client,
 
 	err_code = client_write(client, packet.cur, packet.end - packet.cur);
 
+#if defined(CONFIG_MQTT_INFLIGHT)
+	if (err_code == 0) {
+		struct mqtt_inflight *inflight;
+
+		/* Wait for PUBCOMP from now on. */
+		inflight = inflight_find(client, param->message_id);
+		if (inflight != NULL) {
+			inflight->timestamp = mqtt_sys_tick_in_ms_get();
+		}
+	}
+#endif /* CONFIG_MQTT_INFLIGHT */
+
 error:
 	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
 		 client, client->internal.state, err_code);
@@ -559,6 +888,13 @@ int mqtt_live(struct mqtt_client *client)
 	if (MQTT_HAS_STATE(client, MQTT_STATE_DISCONNECTING)) {
 		client_disconnect(client, 0);
 	} else {
+#if defined(CONFIG_MQTT_INFLIGHT)
+		if (CONFIG_MQTT_INFLIGHT_RETRY_TIMEOUT > 0 &&
+		    MQTT_HAS_STATE(client, MQTT_STATE_CONNECTED)) {
+			(void)inflight_retransmit(client, false);
+		}
+#endif /* CONFIG_MQTT_INFLIGHT */
+
 		elapsed_time = mqtt_elapsed_time_in_ms_get(
 					client->internal.last_activity);
 
@@ -153,6 +153,25 @@ enum mqtt_state {
  */
 void event_notify(struct mqtt_client *client, const struct mqtt_evt *evt);
 
+/**@brief Updates the in-flight window on an acknowledgment from the broker.
+ *
+ * @param[in] client Identifies the client for which the packet was received.
+ * @param[in] type Type of the packet received, PUBACK, PUBREC or PUBCOMP.
+ * @param[in] message_id Identifies the message acknowledged.
+ */
+void mqtt_inflight_ack(struct mqtt_client *client, u8_t type,
+		       u16_t message_id);
+
+/**@brief Sends the messages in flight again once the connection is
+ *        restored, or forgets them if the broker has no session.
+ *
+ * @param[in] client Identifies the client which got connected.
+ * @param[in] session_present Whether the broker restored the session.
+ *
+ * @return 0 if the procedure is successful, an error code otherwise.
+ */
+int mqtt_inflight_resume(struct mqtt_client *client, bool session_present);
+
 /**@brief Handles MQTT messages received from the peer.
  *
  * @param[in] client Identifies the client for which the data was received.
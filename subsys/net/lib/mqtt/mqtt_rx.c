@@ -23,6 +23,7 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 {
 	int err_code = 0;
 	bool notify_event = true;
+	bool resume_session = false;
 	struct mqtt_evt evt;
 
 	/* Success by default, overwritten in special cases. */
@@ -42,6 +43,7 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 						MQTT_CONNECTION_ACCEPTED) {
 				/* Set state. */
 				MQTT_SET_STATE(client, MQTT_STATE_CONNECTED);
+				resume_session = true;
 			}
 
 			evt.result = evt.param.connack.return_code;
@@ -75,6 +77,11 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBACK;
 		err_code = publish_ack_decode(buf, &evt.param.puback);
 		evt.result = err_code;
+
+		if (IS_ENABLED(CONFIG_MQTT_INFLIGHT) && err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBACK,
+					  evt.param.puback.message_id);
+		}
 		break;
 
 	case MQTT_PKT_TYPE_PUBREC:
@@ -83,6 +90,11 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBREC;
 		err_code = publish_receive_decode(buf, &evt.param.pubrec);
 		evt.result = err_code;
+
+		if (IS_ENABLED(CONFIG_MQTT_INFLIGHT) && err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBREC,
+					  evt.param.pubrec.message_id);
+		}
 		break;
 
 	case MQTT_PKT_TYPE_PUBREL:
@@ -99,6 +111,11 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBCOMP;
 		err_code = publish_complete_decode(buf, &evt.param.pubcomp);
 		evt.result = err_code;
+
+		if (IS_ENABLED(CONFIG_MQTT_INFLIGHT) && err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBCOMP,
+					  evt.param.pubcomp.message_id);
+		}
 		break;
 
 	case MQTT_PKT_TYPE_SUBACK:
@@ -134,6 +151,13 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		event_notify(client, &evt);
 	}
 
+	/* Messages in flight follow the connection acknowledgment. */
+	if (IS_ENABLED(CONFIG_MQTT_INFLIGHT) && resume_session &&
+	    MQTT_HAS_STATE(client, MQTT_STATE_CONNECTED)) {
+		err_code = mqtt_inflight_resume(
+				client, evt.param.connack.session_present_flag);
+	}
+
 	return err_code;
 }
 
@@ -105,6 +105,8 @@ int zsock_socket_internal(int family, int type, int proto)
 
 	/* recv_q and accept_q are in union */
 	k_fifo_init(&ctx->recv_q);
+	zsock_tx_init(ctx);
+	zsock_epoll_ctx_init(ctx);
 
 #ifdef CONFIG_USERSPACE
 	/* Set net context object as initialized and grant access to the
@@ -182,6 +184,7 @@ int zsock_close_ctx(struct net_context *ctx)
 	}
 
 	zsock_flush_queue(ctx);
+	zsock_epoll_ctx_close(ctx);
 
 	SET_ERRNO(net_context_put(ctx));
 
@@ -244,8 +247,11 @@ static void zsock_accepted_cb(struct net_context *new_ctx,
 		(void)net_context_recv(new_ctx, zsock_received_cb, K_NO_WAIT,
 				       NULL);
 		k_fifo_init(&new_ctx->recv_q);
+		zsock_tx_init(new_ctx);
+		zsock_epoll_ctx_init(new_ctx);
 
 		k_fifo_put(&parent->accept_q, new_ctx);
+		zsock_epoll_notify(parent);
 	}
 }
 
@@ -275,6 +281,8 @@ static void zsock_received_cb(struct net_context *ctx,
 			net_pkt_set_eof(last_pkt, true);
 			NET_DBG("Set EOF flag on pkt %p", last_pkt);
 		}
+
+		zsock_epoll_notify(ctx);
 		return;
 	}
 
@@ -286,6 +294,7 @@ static void zsock_received_cb(struct net_context *ctx,
 	}
 
 	k_fifo_put(&ctx->recv_q, pkt);
+	zsock_epoll_notify(ctx);
 }
 
 int zsock_bind_ctx(struct net_context *ctx, const struct sockaddr *addr,
@@ -457,6 +466,8 @@ ssize_t zsock_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
 			 int flags,
 			 const struct sockaddr *dest_addr, socklen_t addrlen)
 {
+	struct k_poll_event event = K_POLL_EVENT_INITIALIZER(
+		K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &ctx->tx_signal);
 	s32_t timeout = K_FOREVER;
 	int status;
 
@@ -474,13 +485,39 @@ ssize_t zsock_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
 		return -1;
 	}
 
-	if (dest_addr) {
-		status = net_context_sendto(ctx, buf, len, dest_addr,
-					    addrlen, NULL, timeout,
-					    ctx->user_data);
-	} else {
-		status = net_context_send(ctx, buf, len, NULL, timeout,
-					  ctx->user_data);
+	while (1) {
+		unsigned int signaled;
+		int result;
+
+		k_poll_signal_reset(&ctx->tx_signal);
+
+		if (dest_addr) {
+			status = net_context_sendto(ctx, buf, len, dest_addr,
+						    addrlen, NULL, timeout,
+						    ctx->user_data);
+		} else {
+			status = net_context_send(ctx, buf, len, NULL,
+						  timeout, ctx->user_data);
+		}
+
+		if (status != -EAGAIN || timeout == K_NO_WAIT) {
+			break;
+		}
+
+		/* The signal was reset before sending, so it tells if room
+		 * was made since. Otherwise, the context refused the data
+		 * for another reason than a full send queue.
+		 */
+		k_poll_signal_check(&ctx->tx_signal, &signaled, &result);
+		if (!signaled && net_context_is_writable(ctx)) {
+			break;
+		}
+
+		/* Wait without holding the context for the peer to make
+		 * room in the send queue.
+		 */
+		event.state = K_POLL_STATE_NOT_READY;
+		(void)k_poll(&event, 1, K_FOREVER);
 	}
 
 	if (status < 0) {
@@ -879,6 +916,31 @@ static int zsock_poll_prepare_ctx(struct net_context *ctx,
 		(*pev)++;
 	}
 
+	if (pfd->events & ZSOCK_POLLOUT) {
+		k_poll_signal_reset(&ctx->tx_signal);
+
+		/* Checked after the reset, so that no wake up is missed.
+		 * A writable socket is reported without taking an event,
+		 * the update function tells so from the revents set here.
+		 */
+		if (net_context_is_writable(ctx)) {
+			pfd->revents |= ZSOCK_POLLOUT;
+			errno = EALREADY;
+			return -1;
+		}
+
+		if (*pev == pev_end) {
+			errno = ENOMEM;
+			return -1;
+		}
+
+		(*pev)->obj = &ctx->tx_signal;
+		(*pev)->type = K_POLL_TYPE_SIGNAL;
+		(*pev)->mode = K_POLL_MODE_NOTIFY_ONLY;
+		(*pev)->state = K_POLL_STATE_NOT_READY;
+		(*pev)++;
+	}
+
 	/* If socket is already in EOF, it can be reported
 	 * immediately, so we tell poll() to short-circuit wait.
 	 */
@@ -894,12 +956,7 @@ static int zsock_poll_update_ctx(struct net_context *ctx,
 				 struct zsock_pollfd *pfd,
 				 struct k_poll_event **pev)
 {
-	ARG_UNUSED(ctx);
-
-	/* For now, assume that socket is always writable */
-	if (pfd->events & ZSOCK_POLLOUT) {
-		pfd->revents |= ZSOCK_POLLOUT;
-	}
+	bool woken = false;
 
 	if (pfd->events & ZSOCK_POLLIN) {
 		if ((*pev)->state != K_POLL_STATE_NOT_READY || sock_is_eof(ctx)) {
@@ -908,6 +965,24 @@ static int zsock_poll_update_ctx(struct net_context *ctx,
 		(*pev)++;
 	}
 
+	/* Already reported by the prepare function otherwise */
+	if ((pfd->events & ZSOCK_POLLOUT) && !(pfd->revents & ZSOCK_POLLOUT)) {
+		if (net_context_is_writable(ctx)) {
+			pfd->revents |= ZSOCK_POLLOUT;
+		} else if ((*pev)->state != K_POLL_STATE_NOT_READY) {
+			/* Some data was acknowledged, but not enough */
+			k_poll_signal_reset(&ctx->tx_signal);
+			(*pev)->state = K_POLL_STATE_NOT_READY;
+			woken = true;
+		}
+		(*pev)++;
+	}
+
+	if (woken && !pfd->revents) {
+		errno = EAGAIN;
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -938,6 +1013,9 @@ int z_impl_zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout)
 	for (pfd = fds, i = nfds; i--; pfd++) {
 		struct net_context *ctx;
 
+		/* Cleared here, as POLL_PREPARE may already report events */
+		pfd->revents = 0;
+
 		/* Per POSIX, negative fd's are just ignored */
 		if (pfd->fd < 0) {
 			continue;
@@ -984,8 +1062,9 @@ int z_impl_zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout)
 		for (pfd = fds, i = nfds; i--; pfd++) {
 			struct net_context *ctx;
 
-			pfd->revents = 0;
-
+			/* revents are not cleared, to keep the events already
+			 * reported by POLL_PREPARE.
+			 */
 			if (pfd->fd < 0) {
 				continue;
 			}
@@ -1139,6 +1218,25 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 
 				return 0;
 			}
+
+			break;
+
+		case SO_SNDBUF:
+		case SO_RCVBUF:
+			if (IS_ENABLED(CONFIG_NET_PKT_QUOTA)) {
+				ret = net_context_set_option(ctx,
+					optname == SO_SNDBUF ?
+					NET_OPT_SNDBUF : NET_OPT_RCVBUF,
+					optval, optlen);
+				if (ret < 0) {
+					errno = -ret;
+					return -1;
+				}
+
+				return 0;
+			}
+
+			break;
 		}
 
 		break;
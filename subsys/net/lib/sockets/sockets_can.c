@@ -35,7 +35,7 @@ static struct can_recv receivers[CONFIG_NET_SOCKETS_CAN_RECEIVERS];
 
 extern const struct socket_op_vtable sock_fd_op_vtable;
 
-static const struct socket_op_vtable can_sock_fd_op_vtable;
+const struct socket_op_vtable can_sock_fd_op_vtable;
 
 static inline int k_fifo_wait_non_empty(struct k_fifo *fifo, int32_t timeout)
 {
@@ -69,6 +69,7 @@ int zcan_socket(int family, int type, int proto)
 	ctx->user_data = NULL;
 
 	k_fifo_init(&ctx->recv_q);
+	zsock_epoll_ctx_init(ctx);
 
 #ifdef CONFIG_USERSPACE
 	/* Set net context object as initialized and grant access to the
@@ -158,12 +159,14 @@ static void zcan_received_cb(struct net_context *ctx, struct net_pkt *pkt,
 				NET_DBG("Set EOF flag on pkt %p", ctx);
 			}
 
+			zsock_epoll_notify(ctx);
 			return;
 		} else {
 			/* Normal packet */
 			net_pkt_set_eof(clone, false);
 
 			k_fifo_put(&ctx->recv_q, clone);
+			zsock_epoll_notify(ctx);
 		}
 	}
 
@@ -672,7 +675,7 @@ static int can_sock_setsockopt_vmeth(void *obj, int level, int optname,
 	return api->setsockopt(dev, obj, level, optname, optval, optlen);
 }
 
-static const struct socket_op_vtable can_sock_fd_op_vtable = {
+const struct socket_op_vtable can_sock_fd_op_vtable = {
 	.fd_vtable = {
 		.read = can_sock_read_vmeth,
 		.write = can_sock_write_vmeth,
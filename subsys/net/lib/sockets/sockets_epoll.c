@@ -0,0 +1,643 @@
+/*
+ * Copyright (c) 2019 Linaro Limited
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Persistent interest sets for socket readiness (epoll-like API).
+ *
+ * Every registered socket is represented by an item, linked both into
+ * the owning instance and into the socket's net_context. The receive and
+ * accept callbacks of the socket layer push items onto the instance
+ * ready list, so zsock_epoll_wait() only has to look at sockets which
+ * actually saw activity, instead of rebuilding k_poll events for the
+ * whole set on every call like zsock_poll() does.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_sock, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <kernel.h>
+#include <spinlock.h>
+#include <net/net_context.h>
+#include <net/socket.h>
+#include <misc/fdtable.h>
+
+#include "sockets_internal.h"
+
+#define ZSOCK_EPOLL_USER_EVENTS (ZSOCK_EPOLLIN | ZSOCK_EPOLLPRI | \
+				 ZSOCK_EPOLLOUT)
+
+struct zsock_epoll;
+
+struct zsock_epoll_item {
+	/* Link in the instance ready list */
+	sys_dnode_t ready_node;
+	/* Link in net_context::epoll_items */
+	sys_snode_t ctx_node;
+	struct zsock_epoll *ep;
+	struct net_context *ctx;
+	zsock_epoll_data_t data;
+	u32_t events;
+	int fd;
+	/* Item is linked into ready_node */
+	u8_t queued : 1;
+	/* Item is being evaluated by zsock_epoll_wait() */
+	u8_t busy : 1;
+	/* Notification arrived while the item was busy */
+	u8_t pending : 1;
+	/* Socket or instance went away while the item was busy */
+	u8_t stale : 1;
+};
+
+struct zsock_epoll {
+	sys_dlist_t ready;
+	struct k_poll_signal signal;
+	u16_t count;
+	bool in_use;
+};
+
+static struct zsock_epoll epoll_instances[CONFIG_NET_SOCKETS_EPOLL_MAX];
+static struct zsock_epoll_item epoll_items[CONFIG_NET_SOCKETS_EPOLL_MAX_ITEMS];
+static struct k_spinlock epoll_lock;
+
+static const struct fd_op_vtable epoll_fd_op_vtable;
+
+extern const struct socket_op_vtable sock_fd_op_vtable;
+#if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
+extern const struct socket_op_vtable tls_sock_fd_op_vtable;
+#endif
+#if defined(CONFIG_NET_SOCKETS_PACKET)
+extern const struct socket_op_vtable packet_sock_fd_op_vtable;
+#endif
+#if defined(CONFIG_NET_SOCKETS_CAN)
+extern const struct socket_op_vtable can_sock_fd_op_vtable;
+#endif
+
+/* Only descriptors of these types are backed by a net_context */
+static bool epoll_is_socket(const struct fd_op_vtable *vtable)
+{
+	if (vtable == &sock_fd_op_vtable.fd_vtable) {
+		return true;
+	}
+
+#if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
+	if (vtable == &tls_sock_fd_op_vtable.fd_vtable) {
+		return true;
+	}
+#endif
+#if defined(CONFIG_NET_SOCKETS_PACKET)
+	if (vtable == &packet_sock_fd_op_vtable.fd_vtable) {
+		return true;
+	}
+#endif
+#if defined(CONFIG_NET_SOCKETS_CAN)
+	if (vtable == &can_sock_fd_op_vtable.fd_vtable) {
+		return true;
+	}
+#endif
+
+	return false;
+}
+
+static struct zsock_epoll_item *epoll_item_alloc(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(epoll_items); i++) {
+		if (epoll_items[i].ep == NULL) {
+			(void)memset(&epoll_items[i], 0, sizeof(epoll_items[i]));
+			return &epoll_items[i];
+		}
+	}
+
+	return NULL;
+}
+
+static struct zsock_epoll_item *epoll_item_find(struct zsock_epoll *ep,
+						struct net_context *ctx)
+{
+	struct zsock_epoll_item *item;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->epoll_items, item, ctx_node) {
+		if (item->ep == ep && !item->stale) {
+			return item;
+		}
+	}
+
+	return NULL;
+}
+
+/* Must be called with epoll_lock held */
+static void epoll_item_queue(struct zsock_epoll_item *item)
+{
+	if (item->busy) {
+		item->pending = 1U;
+		return;
+	}
+
+	if (!item->queued) {
+		sys_dlist_append(&item->ep->ready, &item->ready_node);
+		item->queued = 1U;
+	}
+}
+
+/* Must be called with epoll_lock held */
+static void epoll_item_unlink(struct zsock_epoll_item *item)
+{
+	if (item->queued) {
+		sys_dlist_remove(&item->ready_node);
+		item->queued = 0U;
+	}
+
+	if (item->ctx != NULL) {
+		sys_slist_find_and_remove(&item->ctx->epoll_items,
+					  &item->ctx_node);
+	}
+
+	item->ep->count--;
+
+	/* A busy item is released by zsock_epoll_wait() once it is done
+	 * with it.
+	 */
+	if (item->busy) {
+		item->stale = 1U;
+		item->ctx = NULL;
+		return;
+	}
+
+	item->ep = NULL;
+}
+
+void zsock_epoll_notify(struct net_context *ctx)
+{
+	struct zsock_epoll *wake[CONFIG_NET_SOCKETS_EPOLL_MAX];
+	struct zsock_epoll_item *item;
+	k_spinlock_key_t key;
+	int i, count = 0;
+
+	if (sys_slist_is_empty(&ctx->epoll_items)) {
+		return;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->epoll_items, item, ctx_node) {
+		if (!(item->events & ZSOCK_EPOLL_USER_EVENTS)) {
+			/* Disabled by ZSOCK_EPOLLONESHOT */
+			continue;
+		}
+
+		epoll_item_queue(item);
+
+		/* A socket can be in each instance at most once */
+		if (count < ARRAY_SIZE(wake)) {
+			wake[count++] = item->ep;
+		}
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	/* Wake up waiters outside of the lock, as raising a signal may
+	 * reschedule.
+	 */
+	for (i = 0; i < count; i++) {
+		k_poll_signal_raise(&wake[i]->signal, 0);
+	}
+}
+
+void zsock_epoll_ctx_close(struct net_context *ctx)
+{
+	struct zsock_epoll_item *item, *next;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&epoll_lock);
+
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&ctx->epoll_items, item, next,
+					  ctx_node) {
+		epoll_item_unlink(item);
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+}
+
+/* Evaluate current readiness of a single socket, reusing the per-socket
+ * type poll handlers, so TLS, packet and CAN sockets report the same
+ * events as they would from zsock_poll().
+ */
+static u32_t epoll_item_revents(int fd, struct net_context *ctx,
+				u32_t events)
+{
+	/* One event for ZSOCK_EPOLLIN, one for ZSOCK_EPOLLOUT */
+	struct k_poll_event poll_events[2];
+	struct k_poll_event *pev = poll_events;
+	struct k_poll_event *pev_end = poll_events + ARRAY_SIZE(poll_events);
+	const struct fd_op_vtable *vtable;
+	struct zsock_pollfd pfd;
+	void *obj;
+
+	obj = z_get_fd_obj_and_vtable(fd, &vtable);
+	if (obj != ctx) {
+		return ZSOCK_EPOLLHUP;
+	}
+
+	pfd.fd = fd;
+	pfd.events = events & ZSOCK_EPOLL_USER_EVENTS;
+	pfd.revents = 0;
+
+	if (z_fdtable_call_ioctl(vtable, obj, ZFD_IOCTL_POLL_PREPARE,
+				 &pfd, &pev, pev_end) < 0 &&
+	    errno != EALREADY) {
+		return ZSOCK_EPOLLERR;
+	}
+
+	if (pev != poll_events) {
+		(void)k_poll(poll_events, pev - poll_events, K_NO_WAIT);
+	}
+
+	pev = poll_events;
+
+	if (z_fdtable_call_ioctl(vtable, obj, ZFD_IOCTL_POLL_UPDATE,
+				 &pfd, &pev) < 0) {
+		/* EAGAIN means there is data, but not enough of it yet
+		 * (e.g. partial TLS record); wait for next notification.
+		 */
+		if (errno == EAGAIN) {
+			return 0;
+		}
+
+		return ZSOCK_EPOLLERR;
+	}
+
+	if (pfd.revents & ZSOCK_POLLNVAL) {
+		return ZSOCK_EPOLLHUP;
+	}
+
+	return pfd.revents;
+}
+
+static int epoll_collect(struct zsock_epoll *ep,
+			 struct zsock_epoll_event *events, int maxevents)
+{
+	struct zsock_epoll_item *item;
+	sys_dlist_t work;
+	sys_dnode_t *node;
+	k_spinlock_key_t key;
+	int count = 0;
+
+	sys_dlist_init(&work);
+
+	/* Detach the current ready list, so that callbacks can keep
+	 * queueing new notifications while sockets are evaluated.
+	 */
+	key = k_spin_lock(&epoll_lock);
+
+	while ((node = sys_dlist_get(&ep->ready)) != NULL) {
+		item = CONTAINER_OF(node, struct zsock_epoll_item, ready_node);
+		item->queued = 0U;
+		item->busy = 1U;
+		item->pending = 0U;
+		sys_dlist_append(&work, node);
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	while ((node = sys_dlist_get(&work)) != NULL) {
+		struct net_context *ctx;
+		u32_t revents = 0U;
+		u32_t interest;
+		bool requeue = false;
+		int fd;
+
+		item = CONTAINER_OF(node, struct zsock_epoll_item, ready_node);
+
+		/* The socket may be closed, or the item modified, from
+		 * another thread while it is evaluated, so work on a copy.
+		 */
+		key = k_spin_lock(&epoll_lock);
+		ctx = item->stale ? NULL : item->ctx;
+		interest = item->events;
+		fd = item->fd;
+		k_spin_unlock(&epoll_lock, key);
+
+		if (count < maxevents && ctx != NULL) {
+			revents = epoll_item_revents(fd, ctx, interest);
+		} else if (ctx != NULL) {
+			/* No room left, keep for the next call */
+			requeue = true;
+		}
+
+		key = k_spin_lock(&epoll_lock);
+
+		item->busy = 0U;
+
+		if (item->stale) {
+			item->ep = NULL;
+			k_spin_unlock(&epoll_lock, key);
+			continue;
+		}
+
+		if (revents) {
+			events[count].events = revents;
+			events[count].data = item->data;
+			count++;
+
+			if (item->events & ZSOCK_EPOLLONESHOT) {
+				item->events &= ~ZSOCK_EPOLL_USER_EVENTS;
+			} else if (!(item->events & ZSOCK_EPOLLET)) {
+				/* Level-triggered: report again until the
+				 * condition is consumed.
+				 */
+				requeue = true;
+			}
+		}
+
+		if (requeue || item->pending) {
+			item->pending = 0U;
+			epoll_item_queue(item);
+		}
+
+		k_spin_unlock(&epoll_lock, key);
+	}
+
+	return count;
+}
+
+static inline int time_left(u32_t start, u32_t timeout)
+{
+	u32_t elapsed = k_uptime_get_32() - start;
+
+	return timeout - elapsed;
+}
+
+static struct zsock_epoll *epoll_get(int epfd)
+{
+	return z_get_fd_obj(epfd, &epoll_fd_op_vtable, EINVAL);
+}
+
+int zsock_epoll_create(int size)
+{
+	struct zsock_epoll *ep = NULL;
+	k_spinlock_key_t key;
+	int fd, i;
+
+	if (size <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	fd = z_reserve_fd();
+	if (fd < 0) {
+		return -1;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_instances); i++) {
+		if (!epoll_instances[i].in_use) {
+			ep = &epoll_instances[i];
+			ep->in_use = true;
+			break;
+		}
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	if (ep == NULL) {
+		z_free_fd(fd);
+		errno = ENFILE;
+		return -1;
+	}
+
+	sys_dlist_init(&ep->ready);
+	k_poll_signal_init(&ep->signal);
+	ep->count = 0U;
+
+	z_finalize_fd(fd, ep, &epoll_fd_op_vtable);
+
+	NET_DBG("epoll_create: ep=%p, fd=%d", ep, fd);
+
+	return fd;
+}
+
+int zsock_epoll_ctl(int epfd, int op, int fd, struct zsock_epoll_event *event)
+{
+	const struct fd_op_vtable *vtable;
+	struct zsock_epoll_item *item;
+	struct net_context *ctx;
+	struct zsock_epoll *ep;
+	k_spinlock_key_t key;
+	int ret = 0;
+
+	ep = epoll_get(epfd);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	ctx = z_get_fd_obj_and_vtable(fd, &vtable);
+	if (ctx == NULL) {
+		return -1;
+	}
+
+	if (vtable == &epoll_fd_op_vtable) {
+		/* Nesting of interest sets is not supported */
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (!epoll_is_socket(vtable)) {
+		errno = EPERM;
+		return -1;
+	}
+
+	if (op != ZSOCK_EPOLL_CTL_DEL && event == NULL) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	item = epoll_item_find(ep, ctx);
+
+	switch (op) {
+	case ZSOCK_EPOLL_CTL_ADD:
+		if (item != NULL) {
+			ret = -EEXIST;
+			break;
+		}
+
+		item = epoll_item_alloc();
+		if (item == NULL) {
+			ret = -ENOSPC;
+			break;
+		}
+
+		item->ep = ep;
+		item->ctx = ctx;
+		item->fd = fd;
+		item->events = event->events;
+		item->data = event->data;
+		sys_slist_prepend(&ctx->epoll_items, &item->ctx_node);
+		ep->count++;
+
+		/* Let the next wait evaluate initial state */
+		epoll_item_queue(item);
+		break;
+
+	case ZSOCK_EPOLL_CTL_MOD:
+		if (item == NULL) {
+			ret = -ENOENT;
+			break;
+		}
+
+		item->events = event->events;
+		item->data = event->data;
+
+		epoll_item_queue(item);
+		break;
+
+	case ZSOCK_EPOLL_CTL_DEL:
+		if (item == NULL) {
+			ret = -ENOENT;
+			break;
+		}
+
+		epoll_item_unlink(item);
+		break;
+
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	if (op != ZSOCK_EPOLL_CTL_DEL) {
+		k_poll_signal_raise(&ep->signal, 0);
+	}
+
+	return 0;
+}
+
+int zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+		     int maxevents, int timeout)
+{
+	struct k_poll_event poll_event;
+	struct zsock_epoll *ep;
+	u32_t entry_time = k_uptime_get_32();
+	int remaining_time;
+	int ret;
+
+	ep = epoll_get(epfd);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	if (events == NULL || maxevents <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (timeout < 0) {
+		timeout = K_FOREVER;
+	}
+
+	remaining_time = timeout;
+
+	k_poll_event_init(&poll_event, K_POLL_TYPE_SIGNAL,
+			  K_POLL_MODE_NOTIFY_ONLY, &ep->signal);
+
+	while (true) {
+		/* Reset before looking at the ready list, so that any
+		 * notification arriving after the scan wakes us up.
+		 */
+		k_poll_signal_reset(&ep->signal);
+
+		ret = epoll_collect(ep, events, maxevents);
+		if (ret > 0 || timeout == K_NO_WAIT) {
+			return ret;
+		}
+
+		poll_event.state = K_POLL_STATE_NOT_READY;
+
+		ret = k_poll(&poll_event, 1, remaining_time);
+		if (ret == -EAGAIN) {
+			return 0;
+		}
+
+		if (ret != 0 && ret != -EINTR) {
+			errno = -ret;
+			return -1;
+		}
+
+		if (timeout != K_FOREVER) {
+			remaining_time = time_left(entry_time, timeout);
+			if (remaining_time <= 0) {
+				return epoll_collect(ep, events, maxevents);
+			}
+		}
+	}
+}
+
+static int epoll_close(struct zsock_epoll *ep)
+{
+	k_spinlock_key_t key;
+	int i;
+
+	key = k_spin_lock(&epoll_lock);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_items); i++) {
+		if (epoll_items[i].ep == ep && !epoll_items[i].stale) {
+			epoll_item_unlink(&epoll_items[i]);
+		}
+	}
+
+	ep->in_use = false;
+
+	k_spin_unlock(&epoll_lock, key);
+
+	return 0;
+}
+
+static ssize_t epoll_read_vmeth(void *obj, void *buffer, size_t count)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(buffer);
+	ARG_UNUSED(count);
+
+	errno = EINVAL;
+	return -1;
+}
+
+static ssize_t epoll_write_vmeth(void *obj, const void *buffer, size_t count)
+{
+	ARG_UNUSED(obj);
+	ARG_UNUSED(buffer);
+	ARG_UNUSED(count);
+
+	errno = EINVAL;
+	return -1;
+}
+
+static int epoll_ioctl_vmeth(void *obj, unsigned int request, va_list args)
+{
+	switch (request) {
+	case ZFD_IOCTL_CLOSE:
+		return epoll_close(obj);
+
+	default:
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+}
+
+static const struct fd_op_vtable epoll_fd_op_vtable = {
+	.read = epoll_read_vmeth,
+	.write = epoll_write_vmeth,
+	.ioctl = epoll_ioctl_vmeth,
+};
@@ -30,6 +30,53 @@ static inline u32_t sock_get_flag(struct net_context *ctx, u32_t mask)
 #define sock_set_eof(ctx) sock_set_flag(ctx, SOCK_EOF, SOCK_EOF)
 #define sock_is_nonblock(ctx) sock_get_flag(ctx, SOCK_NONBLOCK)
 
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+/* Called when a socket queue is initialized, to clear epoll bookkeeping. */
+static inline void zsock_epoll_ctx_init(struct net_context *ctx)
+{
+	sys_slist_init(&ctx->epoll_items);
+}
+
+/* Called by receive/accept callbacks whenever socket readiness changes. */
+void zsock_epoll_notify(struct net_context *ctx);
+
+/* Called on socket close to drop it from all interest sets. */
+void zsock_epoll_ctx_close(struct net_context *ctx);
+#else
+static inline void zsock_epoll_ctx_init(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+
+static inline void zsock_epoll_notify(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+
+static inline void zsock_epoll_ctx_close(struct net_context *ctx)
+{
+	ARG_UNUSED(ctx);
+}
+#endif /* CONFIG_NET_SOCKETS_EPOLL */
+
+static inline void zsock_writable_cb(struct net_context *ctx)
+{
+	k_poll_signal_raise(&ctx->tx_signal, 0);
+	/* Acknowledged data freed room in the send queue, report
+	 * EPOLLOUT again to edge-triggered waiters.
+	 */
+	zsock_epoll_notify(ctx);
+}
+
+/* Called when a socket queue is initialized, to wake up the senders
+ * waiting for room in the send queue.
+ */
+static inline void zsock_tx_init(struct net_context *ctx)
+{
+	k_poll_signal_init(&ctx->tx_signal);
+	net_context_set_writable_cb(ctx, zsock_writable_cb);
+}
+
 struct socket_op_vtable {
 	struct fd_op_vtable fd_vtable;
 	int (*bind)(void *obj, const struct sockaddr *addr, socklen_t addrlen);
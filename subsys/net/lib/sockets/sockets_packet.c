@@ -24,7 +24,7 @@ LOG_MODULE_REGISTER(net_sock_packet, CONFIG_NET_SOCKETS_LOG_LEVEL);
 
 extern const struct socket_op_vtable sock_fd_op_vtable;
 
-static const struct socket_op_vtable packet_sock_fd_op_vtable;
+const struct socket_op_vtable packet_sock_fd_op_vtable;
 
 static inline int k_fifo_wait_non_empty(struct k_fifo *fifo, int32_t timeout)
 {
@@ -59,6 +59,7 @@ static int zpacket_socket(int family, int type, int proto)
 
 	/* recv_q and accept_q are in union */
 	k_fifo_init(&ctx->recv_q);
+	zsock_epoll_ctx_init(ctx);
 
 #ifdef CONFIG_USERSPACE
 	/* Set net context object as initialized and grant access to the
@@ -100,6 +101,7 @@ static void zpacket_received_cb(struct net_context *ctx,
 			NET_DBG("Set EOF flag on pkt %p", ctx);
 		}
 
+		zsock_epoll_notify(ctx);
 		return;
 	}
 
@@ -107,6 +109,7 @@ static void zpacket_received_cb(struct net_context *ctx,
 	net_pkt_set_eof(pkt, false);
 
 	k_fifo_put(&ctx->recv_q, pkt);
+	zsock_epoll_notify(ctx);
 }
 
 static int zpacket_bind_ctx(struct net_context *ctx,
@@ -321,7 +324,7 @@ static int packet_sock_setsockopt_vmeth(void *obj, int level, int optname,
 	return zpacket_setsockopt_ctx(obj, level, optname, optval, optlen);
 }
 
-static const struct socket_op_vtable packet_sock_fd_op_vtable = {
+const struct socket_op_vtable packet_sock_fd_op_vtable = {
 	.fd_vtable = {
 		.read = packet_sock_read_vmeth,
 		.write = packet_sock_write_vmeth,
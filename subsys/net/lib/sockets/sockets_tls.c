@@ -32,16 +32,19 @@ LOG_MODULE_REGISTER(net_sock_tls, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #include <mbedtls/x509_crt.h>
 #include <mbedtls/ssl.h>
 #include <mbedtls/ssl_cookie.h>
+#include <mbedtls/ssl_cache.h>
+#include <mbedtls/ssl_ticket.h>
 #include <mbedtls/error.h>
 #include <mbedtls/debug.h>
 #endif /* CONFIG_MBEDTLS */
 
 #include "sockets_internal.h"
 #include "tls_internal.h"
+#include "net_private.h"
 
 extern const struct socket_op_vtable sock_fd_op_vtable;
 
-static const struct socket_op_vtable tls_sock_fd_op_vtable;
+const struct socket_op_vtable tls_sock_fd_op_vtable;
 
 /** A list of secure tags that TLS context should use. */
 struct sec_tag_list {
@@ -68,6 +71,8 @@ struct dtls_timing_context {
 	u32_t fin_ms;
 };
 
+struct dtls_peer;
+
 /** TLS context information. */
 struct tls_context {
 	/** Information whether TLS context is used. */
@@ -102,6 +107,12 @@ struct tls_context {
 
 		/** DTLS role, client by default. */
 		s8_t role;
+
+		/** Information whether sessions are cached and resumed. */
+		bool cache_enabled;
+
+		/** Information whether a DTLS server serves several peers. */
+		bool dtls_multi_peer;
 	} options;
 
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
@@ -116,6 +127,14 @@ struct tls_context {
 
 	/** DTLS peer address length. */
 	socklen_t dtls_peer_addrlen;
+
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+	/** Peer data was last received from, default destination. */
+	struct dtls_peer *dtls_last_peer;
+
+	/** Uptime of the last check for idle peers. */
+	s64_t dtls_idle_check;
+#endif /* CONFIG_NET_SOCKETS_DTLS_MULTI_PEER */
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
 #if defined(CONFIG_MBEDTLS)
@@ -147,9 +166,103 @@ static struct tls_context tls_contexts[CONFIG_NET_SOCKETS_TLS_MAX_CONTEXTS];
 /* A mutex for protecting TLS context allocation. */
 static struct k_mutex context_lock;
 
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+/* DTLS record header: content type, version, epoch, sequence number,
+ * length.
+ */
+#define DTLS_HDR_EPOCH_OFFSET 3
+#define DTLS_HDR_LEN 13
+
+#define DTLS_MSG_HANDSHAKE 22
+
+/** DTLS session with one of the peers of a DTLS server socket. */
+struct dtls_peer {
+	/** Node in the address index. */
+	sys_snode_t node;
+
+	/** TLS context of the socket, NULL if the peer is free. */
+	struct tls_context *tls;
+
+	/** Socket the peer talks to. */
+	struct net_context *ctx;
+
+	/** mbedTLS context, set up with the configuration of the socket. */
+	mbedtls_ssl_context ssl;
+
+	/** Context information for DTLS timing. */
+	struct dtls_timing_context timing;
+
+	/** Address of the peer. */
+	struct sockaddr addr;
+
+	/** Address length. */
+	socklen_t addrlen;
+
+	/** Uptime of the last datagram received from the peer. */
+	s64_t last_activity;
+
+	/** Information whether the handshake is complete. */
+	bool established;
+
+	/** Information whether the datagram at the head of the socket queue
+	 *  is for this peer.
+	 */
+	bool rx_pending;
+};
+
+/* A global pool of DTLS peers, shared by the DTLS server sockets. */
+static struct dtls_peer dtls_peers[CONFIG_NET_SOCKETS_DTLS_MAX_PEERS];
+
+/* The peers hashed by address, protected by context_lock. */
+static sys_slist_t dtls_peer_index[CONFIG_NET_SOCKETS_DTLS_MAX_PEERS];
+#endif /* CONFIG_NET_SOCKETS_DTLS_MULTI_PEER */
+
 #define IS_LISTENING(context) (net_context_get_state(context) == \
 			       NET_CONTEXT_LISTENING)
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+#define SESSION_LIFETIME_MS \
+	((s64_t)CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME * MSEC_PER_SEC)
+
+#if defined(MBEDTLS_SSL_CLI_C)
+/** A session cached by TLS clients. */
+struct tls_session_entry {
+	/** Uptime the entry was last used at, 0 if the entry is free. */
+	s64_t last_used;
+
+	/** Uptime the session was established at. */
+	s64_t created;
+
+	/** Address of the peer the session was established with. */
+	struct sockaddr peer_addr;
+
+	/** Hash of the hostname and the credentials used for the session. */
+	u32_t key;
+
+	/** mbedTLS session, holding the session ID or the ticket. */
+	mbedtls_ssl_session session;
+};
+
+/* Sessions cached by TLS clients. */
+static struct tls_session_entry
+	client_sessions[CONFIG_NET_SOCKETS_TLS_SESSION_CACHE_SIZE];
+#endif /* MBEDTLS_SSL_CLI_C */
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+/* Sessions cached by TLS servers, for session ID resumption. */
+static mbedtls_ssl_cache_context server_sessions;
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+/* Keys for the session tickets issued by TLS servers. */
+static mbedtls_ssl_ticket_context server_tickets;
+static bool server_tickets_ready;
+#endif
+
+/* A mutex for protecting the session caches, shared by all the contexts. */
+static struct k_mutex session_lock;
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 #if defined(MBEDTLS_DEBUG_C) && (CONFIG_NET_SOCKETS_LOG_LEVEL >= LOG_LEVEL_DBG)
 static void tls_debug(void *ctx, int level, const char *file,
 		      int line, const char *str)
@@ -250,6 +363,116 @@ static int dtls_timing_get_delay(void *data)
 }
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
+#if CONFIG_NET_SOCKETS_TLS_MAX_FRAGMENT_LENGTH == 512
+#define TLS_MAX_FRAG_LEN MBEDTLS_SSL_MAX_FRAG_LEN_512
+#elif CONFIG_NET_SOCKETS_TLS_MAX_FRAGMENT_LENGTH == 1024
+#define TLS_MAX_FRAG_LEN MBEDTLS_SSL_MAX_FRAG_LEN_1024
+#elif CONFIG_NET_SOCKETS_TLS_MAX_FRAGMENT_LENGTH == 2048
+#define TLS_MAX_FRAG_LEN MBEDTLS_SSL_MAX_FRAG_LEN_2048
+#elif CONFIG_NET_SOCKETS_TLS_MAX_FRAGMENT_LENGTH == 4096
+#define TLS_MAX_FRAG_LEN MBEDTLS_SSL_MAX_FRAG_LEN_4096
+#elif CONFIG_NET_SOCKETS_TLS_MAX_FRAGMENT_LENGTH != 0
+#error "Unsupported CONFIG_NET_SOCKETS_TLS_MAX_FRAGMENT_LENGTH"
+#endif
+
+#if defined(TLS_MAX_FRAG_LEN) && !defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+#error "TLS max fragment length requires MBEDTLS_SSL_MAX_FRAGMENT_LENGTH"
+#endif
+
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+#if defined(MBEDTLS_SSL_CACHE_C)
+/* The mbedTLS session cache is not thread safe without MBEDTLS_THREADING_C,
+ * it is shared by all the server contexts.
+ */
+static int tls_session_cache_get(void *data, mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_cache_get(data, session);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+
+static int tls_session_cache_set(void *data,
+				 const mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_cache_set(data, session);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+#endif /* MBEDTLS_SSL_CACHE_C */
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+/* Ticket keys are rotated on use, so the ticket context is protected the
+ * same way as the session cache.
+ */
+static int tls_ticket_write(void *p_ticket,
+			    const mbedtls_ssl_session *session,
+			    unsigned char *start, const unsigned char *end,
+			    size_t *tlen, uint32_t *lifetime)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_ticket_write(p_ticket, session, start, end,
+				       tlen, lifetime);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+
+static int tls_ticket_parse(void *p_ticket, mbedtls_ssl_session *session,
+			    unsigned char *buf, size_t len)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_ticket_parse(p_ticket, session, buf, len);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+#endif /* MBEDTLS_SSL_TICKET_C */
+
+static void tls_session_cache_init(void)
+{
+#if defined(MBEDTLS_SSL_TICKET_C)
+	int ret;
+#endif
+
+	k_mutex_init(&session_lock);
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+	mbedtls_ssl_cache_init(&server_sessions);
+	mbedtls_ssl_cache_set_max_entries(&server_sessions,
+				CONFIG_NET_SOCKETS_TLS_SESSION_CACHE_SIZE);
+#if defined(MBEDTLS_HAVE_TIME)
+	mbedtls_ssl_cache_set_timeout(&server_sessions,
+				      CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME);
+#endif
+#endif /* MBEDTLS_SSL_CACHE_C */
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+	mbedtls_ssl_ticket_init(&server_tickets);
+
+	ret = mbedtls_ssl_ticket_setup(&server_tickets, mbedtls_ctr_drbg_random,
+				       &tls_ctr_drbg, MBEDTLS_CIPHER_AES_256_GCM,
+				       CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME);
+	if (ret != 0) {
+		NET_WARN("Session tickets not available: -%x", -ret);
+	} else {
+		server_tickets_ready = true;
+	}
+#endif /* MBEDTLS_SSL_TICKET_C */
+}
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 /* Initialize TLS internals. */
 static int tls_init(struct device *unused)
 {
@@ -258,6 +481,9 @@ static int tls_init(struct device *unused)
 	int ret;
 	static const unsigned char drbg_seed[] = "zephyr";
 	struct device *dev = NULL;
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+	int i;
+#endif
 
 #if defined(CONFIG_ENTROPY_HAS_DRIVER)
 	dev = device_get_binding(CONFIG_ENTROPY_NAME);
@@ -275,6 +501,14 @@ static int tls_init(struct device *unused)
 
 	k_mutex_init(&context_lock);
 
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+	(void)memset(dtls_peers, 0, sizeof(dtls_peers));
+
+	for (i = 0; i < ARRAY_SIZE(dtls_peer_index); i++) {
+		sys_slist_init(&dtls_peer_index[i]);
+	}
+#endif
+
 	mbedtls_ctr_drbg_init(&tls_ctr_drbg);
 
 	ret = mbedtls_ctr_drbg_seed(&tls_ctr_drbg, tls_entropy_func, dev,
@@ -285,6 +519,10 @@ static int tls_init(struct device *unused)
 		return -EFAULT;
 	}
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	tls_session_cache_init();
+#endif
+
 #if defined(MBEDTLS_DEBUG_C) && (CONFIG_NET_SOCKETS_LOG_LEVEL >= LOG_LEVEL_DBG)
 	mbedtls_debug_set_threshold(CONFIG_MBEDTLS_DEBUG_LEVEL);
 #endif
@@ -299,6 +537,21 @@ static inline bool is_handshake_complete(struct net_context *ctx)
 	return k_sem_count_get(&ctx->tls->tls_established) != 0;
 }
 
+/* A multi-peer DTLS server socket has no mbedTLS context of its own, the
+ * peers have one each.
+ */
+static inline bool dtls_is_multi_peer(struct net_context *ctx)
+{
+	return IS_ENABLED(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER) &&
+	       net_context_get_type(ctx) == SOCK_DGRAM &&
+	       ctx->tls->options.role == MBEDTLS_SSL_IS_SERVER &&
+	       ctx->tls->options.dtls_multi_peer;
+}
+
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+static void dtls_peers_release(struct tls_context *tls);
+#endif
+
 /* Allocate TLS context. */
 static struct tls_context *tls_alloc(void)
 {
@@ -383,6 +636,9 @@ static int tls_release(struct tls_context *tls)
 		return -EBADF;
 	}
 
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+	dtls_peers_release(tls);
+#endif
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 	mbedtls_ssl_cookie_free(&tls->cookie);
 #endif
@@ -406,35 +662,43 @@ static inline int time_left(u32_t start, u32_t timeout)
 	return timeout - elapsed;
 }
 
-#if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
-static bool dtls_is_peer_addr_valid(struct net_context *context,
-				    const struct sockaddr *peer_addr,
-				    socklen_t addrlen)
+#if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS) || \
+	defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+static bool tls_addr_cmp(const struct sockaddr *addr1,
+			 const struct sockaddr *addr2)
 {
-	if (context->tls->dtls_peer_addrlen != addrlen ||
-	    context->tls->dtls_peer_addr.sa_family != peer_addr->sa_family) {
+	if (addr1->sa_family != addr2->sa_family) {
 		return false;
 	}
 
-	if (IS_ENABLED(CONFIG_NET_IPV6) && peer_addr->sa_family == AF_INET6) {
-		struct sockaddr_in6 *addr1 = net_sin6(peer_addr);
-		struct sockaddr_in6 *addr2 =
-				net_sin6(&context->tls->dtls_peer_addr);
-
-		return (addr1->sin6_port == addr2->sin6_port) &&
-			net_ipv6_addr_cmp(&addr1->sin6_addr, &addr2->sin6_addr);
+	if (IS_ENABLED(CONFIG_NET_IPV6) && addr1->sa_family == AF_INET6) {
+		return (net_sin6(addr1)->sin6_port ==
+			net_sin6(addr2)->sin6_port) &&
+			net_ipv6_addr_cmp(&net_sin6(addr1)->sin6_addr,
+					  &net_sin6(addr2)->sin6_addr);
 	} else if (IS_ENABLED(CONFIG_NET_IPV4) &&
-		   peer_addr->sa_family == AF_INET) {
-		struct sockaddr_in *addr1 = net_sin(peer_addr);
-		struct sockaddr_in *addr2 =
-				net_sin(&context->tls->dtls_peer_addr);
-
-		return (addr1->sin_port == addr2->sin_port) &&
-			net_ipv4_addr_cmp(&addr1->sin_addr, &addr2->sin_addr);
+		   addr1->sa_family == AF_INET) {
+		return (net_sin(addr1)->sin_port ==
+			net_sin(addr2)->sin_port) &&
+			net_ipv4_addr_cmp(&net_sin(addr1)->sin_addr,
+					  &net_sin(addr2)->sin_addr);
 	}
 
 	return false;
 }
+#endif
+
+#if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
+static bool dtls_is_peer_addr_valid(struct net_context *context,
+				    const struct sockaddr *peer_addr,
+				    socklen_t addrlen)
+{
+	if (context->tls->dtls_peer_addrlen != addrlen) {
+		return false;
+	}
+
+	return tls_addr_cmp(&context->tls->dtls_peer_addr, peer_addr);
+}
 
 static void dtls_peer_address_set(struct net_context *context,
 				  const struct sockaddr *peer_addr,
@@ -551,6 +815,355 @@ static int dtls_rx(void *ctx, unsigned char *buf, size_t len, uint32_t timeout)
 
 	return received;
 }
+
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+static sys_slist_t *dtls_peer_bucket(const struct sockaddr *addr)
+{
+	u32_t hash;
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && addr->sa_family == AF_INET6) {
+		hash = net_hash_fnv1a(NET_HASH_FNV1A_INIT,
+				      &net_sin6(addr)->sin6_addr,
+				      sizeof(struct in6_addr));
+	} else {
+		hash = net_hash_fnv1a(NET_HASH_FNV1A_INIT,
+				      &net_sin(addr)->sin_addr,
+				      sizeof(struct in_addr));
+	}
+
+	/* sin_port and sin6_port are at the same offset. */
+	hash = net_hash_fnv1a(hash, &net_sin(addr)->sin_port,
+			      sizeof(net_sin(addr)->sin_port));
+
+	return &dtls_peer_index[hash % ARRAY_SIZE(dtls_peer_index)];
+}
+
+/* Called with context_lock held. */
+static struct dtls_peer *dtls_peer_find(struct tls_context *tls,
+					const struct sockaddr *addr)
+{
+	struct dtls_peer *peer;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(dtls_peer_bucket(addr), peer, node) {
+		if (peer->tls == tls && tls_addr_cmp(&peer->addr, addr)) {
+			return peer;
+		}
+	}
+
+	return NULL;
+}
+
+/* Only a handshake record of epoch 0 may start a session. */
+static bool dtls_is_session_start(const u8_t *hdr, size_t len)
+{
+	return len >= DTLS_HDR_LEN && hdr[0] == DTLS_MSG_HANDSHAKE &&
+	       hdr[DTLS_HDR_EPOCH_OFFSET] == 0U &&
+	       hdr[DTLS_HDR_EPOCH_OFFSET + 1] == 0U;
+}
+
+static bool dtls_peer_is_idle(struct dtls_peer *peer, s64_t now)
+{
+	return CONFIG_NET_SOCKETS_DTLS_TIMEOUT != 0 &&
+	       now - peer->last_activity >= CONFIG_NET_SOCKETS_DTLS_TIMEOUT;
+}
+
+static int dtls_peer_tx(void *ctx, const unsigned char *buf, size_t len)
+{
+	struct dtls_peer *peer = ctx;
+	ssize_t sent;
+
+	sent = sock_fd_op_vtable.sendto(peer->ctx, buf, len, peer->tls->flags,
+					&peer->addr, peer->addrlen);
+	if (sent < 0) {
+		if (errno == EAGAIN) {
+			return MBEDTLS_ERR_SSL_WANT_WRITE;
+		}
+
+		return MBEDTLS_ERR_NET_SEND_FAILED;
+	}
+
+	return sent;
+}
+
+/* The datagram at the head of the socket queue is only consumed by the
+ * peer it was looked up for, and only once.
+ */
+static int dtls_peer_rx(void *ctx, unsigned char *buf, size_t len)
+{
+	struct dtls_peer *peer = ctx;
+	ssize_t received;
+
+	if (!peer->rx_pending) {
+		return MBEDTLS_ERR_SSL_WANT_READ;
+	}
+
+	peer->rx_pending = false;
+
+	received = sock_fd_op_vtable.recvfrom(peer->ctx, buf, len,
+					      ZSOCK_MSG_DONTWAIT, NULL, NULL);
+	if (received < 0) {
+		if (errno == EAGAIN) {
+			return MBEDTLS_ERR_SSL_WANT_READ;
+		}
+
+		return MBEDTLS_ERR_NET_RECV_FAILED;
+	}
+
+	return received;
+}
+
+static void dtls_drop_datagram(struct net_context *ctx)
+{
+	u8_t byte;
+
+	(void)sock_fd_op_vtable.recvfrom(ctx, &byte, sizeof(byte),
+					 ZSOCK_MSG_DONTWAIT, NULL, NULL);
+}
+
+/* Called with context_lock held. */
+static void dtls_peer_free(struct dtls_peer *peer, bool notify)
+{
+	if (notify) {
+		(void)mbedtls_ssl_close_notify(&peer->ssl);
+	}
+
+	sys_slist_find_and_remove(dtls_peer_bucket(&peer->addr), &peer->node);
+	mbedtls_ssl_free(&peer->ssl);
+
+	if (peer->tls->dtls_last_peer == peer) {
+		peer->tls->dtls_last_peer = NULL;
+	}
+
+	peer->tls = NULL;
+}
+
+static void dtls_peer_release(struct dtls_peer *peer, bool notify)
+{
+	k_mutex_lock(&context_lock, K_FOREVER);
+	dtls_peer_free(peer, notify);
+	k_mutex_unlock(&context_lock);
+}
+
+static void dtls_peers_release(struct tls_context *tls)
+{
+	int i;
+
+	k_mutex_lock(&context_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(dtls_peers); i++) {
+		if (dtls_peers[i].tls == tls) {
+			dtls_peer_free(&dtls_peers[i], dtls_peers[i].established);
+		}
+	}
+
+	k_mutex_unlock(&context_lock);
+}
+
+static void dtls_peers_expire(struct tls_context *tls)
+{
+	s64_t now = k_uptime_get();
+	int i;
+
+	/* Checking once a second keeps the cost per datagram bounded. */
+	if (now - tls->dtls_idle_check < MSEC_PER_SEC) {
+		return;
+	}
+
+	tls->dtls_idle_check = now;
+
+	k_mutex_lock(&context_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(dtls_peers); i++) {
+		if (dtls_peers[i].tls == tls &&
+		    dtls_peer_is_idle(&dtls_peers[i], now)) {
+			NET_DBG("DTLS peer %p idle, closing", &dtls_peers[i]);
+			dtls_peer_free(&dtls_peers[i], dtls_peers[i].established);
+		}
+	}
+
+	k_mutex_unlock(&context_lock);
+}
+
+/* Take a free peer or, if there is none, the peer of the same socket with
+ * the oldest incomplete handshake or the oldest idle session.
+ */
+static struct dtls_peer *dtls_peer_alloc(struct net_context *ctx,
+					 const struct sockaddr *addr,
+					 socklen_t addrlen)
+{
+	struct dtls_peer *peer = NULL, *half_open = NULL, *idle = NULL;
+	s64_t now = k_uptime_get();
+	int i, ret;
+
+	k_mutex_lock(&context_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(dtls_peers); i++) {
+		struct dtls_peer *p = &dtls_peers[i];
+
+		if (!p->tls) {
+			peer = p;
+			break;
+		}
+
+		if (p->tls != ctx->tls) {
+			continue;
+		}
+
+		if (!p->established) {
+			if (!half_open ||
+			    p->last_activity < half_open->last_activity) {
+				half_open = p;
+			}
+		} else if (dtls_peer_is_idle(p, now)) {
+			if (!idle || p->last_activity < idle->last_activity) {
+				idle = p;
+			}
+		}
+	}
+
+	if (!peer) {
+		peer = half_open ? half_open : idle;
+		if (!peer) {
+			goto out;
+		}
+
+		NET_DBG("Replacing DTLS peer %p", peer);
+		dtls_peer_free(peer, peer->established);
+	}
+
+	peer->tls = ctx->tls;
+	peer->ctx = ctx;
+	peer->addrlen = MIN(addrlen, sizeof(peer->addr));
+	memcpy(&peer->addr, addr, peer->addrlen);
+	peer->last_activity = now;
+	peer->established = false;
+	peer->rx_pending = false;
+
+	mbedtls_ssl_init(&peer->ssl);
+
+	ret = mbedtls_ssl_setup(&peer->ssl, &ctx->tls->config);
+	if (ret == 0) {
+		mbedtls_ssl_set_bio(&peer->ssl, peer, dtls_peer_tx,
+				    dtls_peer_rx, NULL);
+		mbedtls_ssl_set_timer_cb(&peer->ssl, &peer->timing,
+					 dtls_timing_set_delay,
+					 dtls_timing_get_delay);
+
+		ret = mbedtls_ssl_set_client_transport_id(
+			&peer->ssl, (const unsigned char *)addr, addrlen);
+	}
+
+	if (ret != 0) {
+		NET_ERR("Cannot set up DTLS peer: -%x", -ret);
+		mbedtls_ssl_free(&peer->ssl);
+		peer->tls = NULL;
+		peer = NULL;
+		goto out;
+	}
+
+	sys_slist_append(dtls_peer_bucket(&peer->addr), &peer->node);
+
+out:
+	k_mutex_unlock(&context_lock);
+
+	return peer;
+}
+
+/* Called with context_lock held. */
+static struct dtls_peer *dtls_peer_with_data(struct tls_context *tls)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(dtls_peers); i++) {
+		if (dtls_peers[i].tls == tls && dtls_peers[i].established &&
+		    mbedtls_ssl_get_bytes_avail(&dtls_peers[i].ssl) > 0) {
+			return &dtls_peers[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Hand the datagram at the head of the socket queue to the session of the
+ * peer. Returns the length of the data received, -EAGAIN if there is none
+ * yet, or another negative error code if the peer was released.
+ */
+static int dtls_peer_process(struct dtls_peer *peer, void *buf,
+			     size_t max_len)
+{
+	bool release = false;
+	int ret;
+
+	peer->rx_pending = true;
+	peer->last_activity = k_uptime_get();
+
+handshake:
+	if (!peer->established) {
+		ret = mbedtls_ssl_handshake(&peer->ssl);
+		if (ret == MBEDTLS_ERR_SSL_WANT_READ ||
+		    ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+			ret = -EAGAIN;
+			goto out;
+		} else if (ret == MBEDTLS_ERR_SSL_HELLO_VERIFY_REQUIRED) {
+			/* No state is kept until the peer returns the
+			 * cookie.
+			 */
+			release = true;
+			ret = -ECONNRESET;
+			goto out;
+		} else if (ret != 0) {
+			NET_DBG("DTLS handshake error with peer %p: -%x",
+				peer, -ret);
+			release = true;
+			ret = -ECONNABORTED;
+			goto out;
+		}
+
+		NET_DBG("DTLS peer %p connected", peer);
+		peer->established = true;
+	}
+
+	ret = mbedtls_ssl_read(&peer->ssl, buf, max_len);
+	if (ret >= 0) {
+		goto out;
+	}
+
+	switch (ret) {
+	case MBEDTLS_ERR_SSL_WANT_READ:
+	case MBEDTLS_ERR_SSL_WANT_WRITE:
+		ret = -EAGAIN;
+		break;
+
+	case MBEDTLS_ERR_SSL_CLIENT_RECONNECT:
+		/* mbedTLS was reset and kept the new ClientHello. */
+		peer->established = false;
+		goto handshake;
+
+	case MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY:
+		release = true;
+		ret = -ENOTCONN;
+		break;
+
+	default:
+		release = true;
+		ret = -EIO;
+		break;
+	}
+
+out:
+	/* Make sure a datagram mbedTLS did not want is not seen again. */
+	if (peer->rx_pending) {
+		peer->rx_pending = false;
+		dtls_drop_datagram(peer->ctx);
+	}
+
+	if (release) {
+		dtls_peer_release(peer, false);
+	}
+
+	return ret;
+}
+#endif /* CONFIG_NET_SOCKETS_DTLS_MULTI_PEER */
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
 static int tls_tx(void *ctx, const unsigned char *buf, size_t len)
@@ -703,55 +1316,295 @@ static int tls_set_credential(struct tls_context *tls,
 		 */
 		break;
 
-	default:
-		return -EINVAL;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int tls_mbedtls_set_credentials(struct tls_context *tls)
+{
+	struct tls_credential *cred;
+	sec_tag_t tag;
+	int i, err = 0;
+	bool tag_found, ca_cert_present = false;
+
+	credentials_lock();
+
+	for (i = 0; i < tls->options.sec_tag_list.sec_tag_count; i++) {
+		tag = tls->options.sec_tag_list.sec_tags[i];
+		cred = NULL;
+		tag_found = false;
+
+		while ((cred = credential_next_get(tag, cred)) != NULL) {
+			tag_found = true;
+
+			err = tls_set_credential(tls, cred);
+			if (err != 0) {
+				goto exit;
+			}
+
+			if (cred->type == TLS_CREDENTIAL_CA_CERTIFICATE) {
+				ca_cert_present = true;
+			}
+		}
+
+		if (!tag_found) {
+			err = -ENOENT;
+			goto exit;
+		}
+	}
+
+exit:
+	credentials_unlock();
+
+	if (err == 0 && ca_cert_present) {
+		tls_set_ca_chain(tls);
+	}
+
+	return err;
+}
+
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE) && defined(MBEDTLS_SSL_CLI_C)
+static const struct sockaddr *tls_peer_addr(struct net_context *context)
+{
+#if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
+	if (net_context_get_type(context) == SOCK_DGRAM) {
+		return &context->tls->dtls_peer_addr;
+	}
+#endif
+
+	return &context->remote;
+}
+
+/* A session is only resumed with the hostname and the credentials it was
+ * established with, the key is a FNV-1a hash of both.
+ */
+static u32_t tls_session_key(struct tls_context *tls)
+{
+	u32_t key = NET_HASH_FNV1A_INIT;
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+	if (tls->ssl.hostname) {
+		key = net_hash_fnv1a(key, tls->ssl.hostname,
+				     strlen(tls->ssl.hostname));
+	}
+#endif
+
+	return net_hash_fnv1a(key, tls->options.sec_tag_list.sec_tags,
+			      tls->options.sec_tag_list.sec_tag_count *
+			      sizeof(sec_tag_t));
+}
+
+static struct tls_session_entry *tls_session_find(const struct sockaddr *addr,
+						  u32_t key)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client_sessions); i++) {
+		if (client_sessions[i].last_used != 0 &&
+		    client_sessions[i].key == key &&
+		    tls_addr_cmp(&client_sessions[i].peer_addr, addr)) {
+			return &client_sessions[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void tls_session_free(struct tls_session_entry *entry)
+{
+	mbedtls_ssl_session_free(&entry->session);
+	entry->last_used = 0;
+}
+
+/* Offer the session cached for the peer, if any, in the next handshake. */
+static void tls_session_restore(struct net_context *context)
+{
+	struct tls_session_entry *entry;
+	s64_t now = k_uptime_get();
+
+	if (!context->tls->options.cache_enabled) {
+		return;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	entry = tls_session_find(tls_peer_addr(context),
+				 tls_session_key(context->tls));
+	if (entry) {
+		if (now - entry->created > SESSION_LIFETIME_MS) {
+			NET_DBG("Cached session %p expired", entry);
+			tls_session_free(entry);
+		} else if (mbedtls_ssl_set_session(&context->tls->ssl,
+						   &entry->session) == 0) {
+			NET_DBG("Resuming cached session %p", entry);
+			entry->last_used = now;
+		}
+	}
+
+	k_mutex_unlock(&session_lock);
+}
+
+/* Cache the session of a completed handshake, in place of the session of
+ * the same peer or of the least recently used session.
+ */
+static void tls_session_save(struct net_context *context)
+{
+	const mbedtls_ssl_session *session = context->tls->ssl.session;
+	const struct sockaddr *addr = tls_peer_addr(context);
+	u32_t key = tls_session_key(context->tls);
+	struct tls_session_entry *entry;
+	s64_t now = k_uptime_get();
+	s64_t created = now;
+	int i, ret;
+
+	if (!context->tls->options.cache_enabled || !session) {
+		return;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	entry = tls_session_find(addr, key);
+	if (entry) {
+		/* A resumed session keeps its session ID and its lifetime. */
+		if (entry->session.id_len == session->id_len &&
+		    memcmp(entry->session.id, session->id,
+			   session->id_len) == 0) {
+			created = entry->created;
+		}
+	} else {
+		entry = &client_sessions[0];
+
+		for (i = 1; i < ARRAY_SIZE(client_sessions); i++) {
+			if (client_sessions[i].last_used < entry->last_used) {
+				entry = &client_sessions[i];
+			}
+		}
+	}
+
+	tls_session_free(entry);
+
+	ret = mbedtls_ssl_get_session(&context->tls->ssl, &entry->session);
+	if (ret != 0) {
+		NET_DBG("Cannot cache session: -%x", -ret);
+		mbedtls_ssl_session_free(&entry->session);
+		goto out;
+	}
+
+	memcpy(&entry->peer_addr, addr, sizeof(entry->peer_addr));
+	entry->key = key;
+	entry->created = created;
+	entry->last_used = now;
+
+out:
+	k_mutex_unlock(&session_lock);
+}
+
+/* Forget the session cached for the peer after a failed handshake. */
+static void tls_session_drop(struct net_context *context)
+{
+	struct tls_session_entry *entry;
+
+	if (!context->tls->options.cache_enabled) {
+		return;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	entry = tls_session_find(tls_peer_addr(context),
+				 tls_session_key(context->tls));
+	if (entry) {
+		tls_session_free(entry);
 	}
 
-	return 0;
+	k_mutex_unlock(&session_lock);
 }
 
-static int tls_mbedtls_set_credentials(struct tls_context *tls)
+static void tls_session_purge(void)
 {
-	struct tls_credential *cred;
-	sec_tag_t tag;
-	int i, err = 0;
-	bool tag_found, ca_cert_present = false;
+	int i;
 
-	credentials_lock();
+	k_mutex_lock(&session_lock, K_FOREVER);
 
-	for (i = 0; i < tls->options.sec_tag_list.sec_tag_count; i++) {
-		tag = tls->options.sec_tag_list.sec_tags[i];
-		cred = NULL;
-		tag_found = false;
+	for (i = 0; i < ARRAY_SIZE(client_sessions); i++) {
+		tls_session_free(&client_sessions[i]);
+	}
 
-		while ((cred = credential_next_get(tag, cred)) != NULL) {
-			tag_found = true;
+	k_mutex_unlock(&session_lock);
+}
+#else
+static inline void tls_session_restore(struct net_context *context)
+{
+	ARG_UNUSED(context);
+}
 
-			err = tls_set_credential(tls, cred);
-			if (err != 0) {
-				goto exit;
-			}
+static inline void tls_session_save(struct net_context *context)
+{
+	ARG_UNUSED(context);
+}
 
-			if (cred->type == TLS_CREDENTIAL_CA_CERTIFICATE) {
-				ca_cert_present = true;
-			}
-		}
+static inline void tls_session_drop(struct net_context *context)
+{
+	ARG_UNUSED(context);
+}
 
-		if (!tag_found) {
-			err = -ENOENT;
-			goto exit;
+static inline void tls_session_purge(void)
+{
+}
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE && MBEDTLS_SSL_CLI_C */
+
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+/* Servers resume sessions with the mbedTLS session cache, or with session
+ * tickets. Without either of them, caching cannot be enabled on a server.
+ */
+static int tls_session_conf(struct net_context *context, bool is_server)
+{
+	bool supported = false;
+
+	if (!context->tls->options.cache_enabled) {
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+		/* Do not ask for tickets that would not be used. */
+		if (!is_server) {
+			mbedtls_ssl_conf_session_tickets(
+				&context->tls->config,
+				MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
 		}
+#endif
+		return 0;
 	}
 
-exit:
-	credentials_unlock();
+	if (!is_server) {
+		return 0;
+	}
 
-	if (err == 0 && ca_cert_present) {
-		tls_set_ca_chain(tls);
+#if defined(MBEDTLS_SSL_CACHE_C)
+	mbedtls_ssl_conf_session_cache(&context->tls->config, &server_sessions,
+				       tls_session_cache_get,
+				       tls_session_cache_set);
+	supported = true;
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+	if (server_tickets_ready) {
+		mbedtls_ssl_conf_session_tickets_cb(&context->tls->config,
+						    tls_ticket_write,
+						    tls_ticket_parse,
+						    &server_tickets);
+		supported = true;
+	}
+#endif
+
+	if (!supported) {
+		NET_ERR("Session cache requires MBEDTLS_SSL_CACHE_C or "
+			"MBEDTLS_SSL_TICKET_C");
+		return -ENOTSUP;
 	}
 
-	return err;
+	return 0;
 }
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
 
 static int tls_mbedtls_reset(struct net_context *context)
 {
@@ -799,12 +1652,22 @@ static int tls_mbedtls_handshake(struct net_context *context, bool block)
 		}
 
 		NET_ERR("TLS handshake error: -%x", -ret);
+
+		if (context->tls->config.endpoint == MBEDTLS_SSL_IS_CLIENT) {
+			tls_session_drop(context);
+		}
+
 		ret = -ECONNABORTED;
 		break;
 	}
 
 	if (ret == 0) {
+		if (context->tls->config.endpoint == MBEDTLS_SSL_IS_CLIENT) {
+			tls_session_save(context);
+		}
+
 		k_sem_give(&context->tls->tls_established);
+		zsock_epoll_notify(context);
 	}
 
 	return ret;
@@ -825,8 +1688,11 @@ static int tls_mbedtls_init(struct net_context *context, bool is_server)
 				    tls_tx, tls_rx, NULL);
 	} else {
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
-		mbedtls_ssl_set_bio(&context->tls->ssl, context,
-				    dtls_tx, NULL, dtls_rx);
+		/* The peers of a multi-peer server have their own BIO. */
+		if (!dtls_is_multi_peer(context)) {
+			mbedtls_ssl_set_bio(&context->tls->ssl, context,
+					    dtls_tx, NULL, dtls_rx);
+		}
 #else
 		return -ENOTSUP;
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
@@ -845,10 +1711,12 @@ static int tls_mbedtls_init(struct net_context *context, bool is_server)
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 	if (type == MBEDTLS_SSL_TRANSPORT_DATAGRAM) {
 		/* DTLS requires timer callbacks to operate */
-		mbedtls_ssl_set_timer_cb(&context->tls->ssl,
-					 &context->tls->dtls_timing,
-					 dtls_timing_set_delay,
-					 dtls_timing_get_delay);
+		if (!dtls_is_multi_peer(context)) {
+			mbedtls_ssl_set_timer_cb(&context->tls->ssl,
+						 &context->tls->dtls_timing,
+						 dtls_timing_set_delay,
+						 dtls_timing_get_delay);
+		}
 
 		/* Configure cookie for DTLS server */
 		if (role == MBEDTLS_SSL_IS_SERVER) {
@@ -868,6 +1736,7 @@ static int tls_mbedtls_init(struct net_context *context, bool is_server)
 					&context->tls->config,
 					CONFIG_NET_SOCKETS_DTLS_TIMEOUT);
 		}
+
 	}
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
@@ -893,11 +1762,35 @@ static int tls_mbedtls_init(struct net_context *context, bool is_server)
 			     mbedtls_ctr_drbg_random,
 			     &tls_ctr_drbg);
 
+#if defined(TLS_MAX_FRAG_LEN)
+	/* Servers follow the length requested by the client. */
+	if (!is_server) {
+		ret = mbedtls_ssl_conf_max_frag_len(&context->tls->config,
+						    TLS_MAX_FRAG_LEN);
+		if (ret != 0) {
+			return -EINVAL;
+		}
+	}
+#endif
+
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	ret = tls_session_conf(context, is_server);
+	if (ret != 0) {
+		return ret;
+	}
+#endif
+
 	ret = tls_mbedtls_set_credentials(context->tls);
 	if (ret != 0) {
 		return ret;
 	}
 
+	/* The peers of a multi-peer server are set up as they connect. */
+	if (dtls_is_multi_peer(context)) {
+		context->tls->is_initialized = true;
+		return 0;
+	}
+
 	ret = mbedtls_ssl_setup(&context->tls->ssl,
 				&context->tls->config);
 	if (ret != 0) {
@@ -907,6 +1800,10 @@ static int tls_mbedtls_init(struct net_context *context, bool is_server)
 		return -ENOMEM;
 	}
 
+	if (!is_server) {
+		tls_session_restore(context);
+	}
+
 	context->tls->is_initialized = true;
 
 	return 0;
@@ -1100,6 +1997,106 @@ static int tls_opt_dtls_role_set(struct net_context *context,
 	return 0;
 }
 
+static int tls_opt_session_cache_set(struct net_context *context,
+				     const void *optval, socklen_t optlen)
+{
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	int *cache;
+
+	if (!optval) {
+		return -EINVAL;
+	}
+
+	if (optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	cache = (int *)optval;
+	if (*cache != 0 && *cache != 1) {
+		return -EINVAL;
+	}
+
+	context->tls->options.cache_enabled = *cache;
+
+	return 0;
+#else
+	return -ENOPROTOOPT;
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+}
+
+static int tls_opt_session_cache_get(struct net_context *context,
+				     void *optval, socklen_t *optlen)
+{
+	if (*optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	*(int *)optval = context->tls->options.cache_enabled;
+
+	return 0;
+}
+
+static int tls_opt_session_cache_purge_set(struct net_context *context,
+					   const void *optval,
+					   socklen_t optlen)
+{
+	ARG_UNUSED(context);
+	ARG_UNUSED(optval);
+	ARG_UNUSED(optlen);
+
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	tls_session_purge();
+
+	return 0;
+#else
+	return -ENOPROTOOPT;
+#endif
+}
+
+static int tls_opt_dtls_multi_peer_set(struct net_context *context,
+				       const void *optval, socklen_t optlen)
+{
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+	int *multi_peer;
+
+	if (!optval) {
+		return -EINVAL;
+	}
+
+	if (optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	multi_peer = (int *)optval;
+	if (*multi_peer != 0 && *multi_peer != 1) {
+		return -EINVAL;
+	}
+
+	/* The peers are set up from the configuration of the socket. */
+	if (context->tls->is_initialized) {
+		return -EBUSY;
+	}
+
+	context->tls->options.dtls_multi_peer = *multi_peer;
+
+	return 0;
+#else
+	return -ENOPROTOOPT;
+#endif /* CONFIG_NET_SOCKETS_DTLS_MULTI_PEER */
+}
+
+static int tls_opt_dtls_multi_peer_get(struct net_context *context,
+				       void *optval, socklen_t *optlen)
+{
+	if (*optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	*(int *)optval = context->tls->options.dtls_multi_peer;
+
+	return 0;
+}
+
 static int ztls_socket(int family, int type, int proto)
 {
 	enum net_ip_protocol_secure tls_proto = 0;
@@ -1146,6 +2143,8 @@ static int ztls_socket(int family, int type, int proto)
 
 	/* recv_q and accept_q are in union */
 	k_fifo_init(&ctx->recv_q);
+	zsock_tx_init(ctx);
+	zsock_epoll_ctx_init(ctx);
 
 #ifdef CONFIG_USERSPACE
 	/* Set net context object as initialized and grant access to the
@@ -1423,6 +2422,54 @@ static ssize_t sendto_dtls_server(struct net_context *ctx, const void *buf,
 
 	return send_tls(ctx, buf, len, flags);
 }
+
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+static ssize_t sendto_dtls_server_multi(struct net_context *ctx,
+					const void *buf, size_t len, int flags,
+					const struct sockaddr *dest_addr,
+					socklen_t addrlen)
+{
+	struct dtls_peer *peer;
+	int ret;
+
+	ARG_UNUSED(flags);
+	ARG_UNUSED(addrlen);
+
+	k_mutex_lock(&context_lock, K_FOREVER);
+
+	/* Without an address, reply to the peer data was last received
+	 * from.
+	 */
+	if (dest_addr) {
+		peer = dtls_peer_find(ctx->tls, dest_addr);
+	} else {
+		peer = ctx->tls->dtls_last_peer;
+	}
+
+	if (!peer || !peer->established) {
+		k_mutex_unlock(&context_lock);
+		errno = ENOTCONN;
+		return -1;
+	}
+
+	ret = mbedtls_ssl_write(&peer->ssl, buf, len);
+
+	k_mutex_unlock(&context_lock);
+
+	if (ret >= 0) {
+		return ret;
+	}
+
+	if (ret == MBEDTLS_ERR_SSL_WANT_READ ||
+	    ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+		errno = EAGAIN;
+	} else {
+		errno = EIO;
+	}
+
+	return -1;
+}
+#endif /* CONFIG_NET_SOCKETS_DTLS_MULTI_PEER */
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
 ssize_t ztls_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
@@ -1443,6 +2490,13 @@ ssize_t ztls_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
 
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 	/* DTLS */
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+	if (dtls_is_multi_peer(ctx)) {
+		return sendto_dtls_server_multi(ctx, buf, len, flags,
+						dest_addr, addrlen);
+	}
+#endif
+
 	if (ctx->tls->options.role == MBEDTLS_SSL_IS_SERVER) {
 		return sendto_dtls_server(ctx, buf, len, flags,
 					  dest_addr, addrlen);
@@ -1614,6 +2668,95 @@ error:
 	errno = -ret;
 	return -1;
 }
+
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+static ssize_t recvfrom_dtls_server_multi(struct net_context *ctx,
+					  void *buf, size_t max_len, int flags,
+					  struct sockaddr *src_addr,
+					  socklen_t *addrlen)
+{
+	u8_t hdr[DTLS_HDR_LEN];
+	struct dtls_peer *peer;
+	struct sockaddr addr;
+	socklen_t len;
+	ssize_t received;
+	int ret;
+
+	if (!ctx->tls->is_initialized) {
+		ret = tls_mbedtls_init(ctx, true);
+		if (ret < 0) {
+			goto error;
+		}
+	}
+
+	/* The peers are used with context_lock held, as the ones of the
+	 * socket may be released or replaced by another thread.
+	 */
+	k_mutex_lock(&context_lock, K_FOREVER);
+
+	/* Data left from a previous record is returned first. */
+	peer = dtls_peer_with_data(ctx->tls);
+	if (peer) {
+		ret = mbedtls_ssl_read(&peer->ssl, buf, max_len);
+		if (ret >= 0) {
+			goto out;
+		}
+	}
+
+	k_mutex_unlock(&context_lock);
+
+	/* Datagrams are handed to their peer until one carries data. */
+	do {
+		dtls_peers_expire(ctx->tls);
+
+		len = sizeof(addr);
+		received = sock_fd_op_vtable.recvfrom(ctx, hdr, sizeof(hdr),
+						      flags | ZSOCK_MSG_PEEK,
+						      &addr, &len);
+		if (received < 0) {
+			ret = -errno;
+			goto error;
+		}
+
+		k_mutex_lock(&context_lock, K_FOREVER);
+
+		peer = dtls_peer_find(ctx->tls, &addr);
+		if (!peer && dtls_is_session_start(hdr, received)) {
+			peer = dtls_peer_alloc(ctx, &addr, len);
+		}
+
+		if (!peer) {
+			k_mutex_unlock(&context_lock);
+
+			NET_DBG("Dropping datagram from unknown DTLS peer");
+			dtls_drop_datagram(ctx);
+			ret = -EAGAIN;
+			continue;
+		}
+
+		ret = dtls_peer_process(peer, buf, max_len);
+		if (ret < 0) {
+			k_mutex_unlock(&context_lock);
+		}
+	} while (ret < 0);
+
+out:
+	ctx->tls->dtls_last_peer = peer;
+
+	if (src_addr && addrlen) {
+		*addrlen = MIN(peer->addrlen, *addrlen);
+		memcpy(src_addr, &peer->addr, *addrlen);
+	}
+
+	k_mutex_unlock(&context_lock);
+
+	return ret;
+
+error:
+	errno = -ret;
+	return -1;
+}
+#endif /* CONFIG_NET_SOCKETS_DTLS_MULTI_PEER */
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
 ssize_t ztls_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
@@ -1642,6 +2785,13 @@ ssize_t ztls_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 	/* DTLS */
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+	if (dtls_is_multi_peer(ctx)) {
+		return recvfrom_dtls_server_multi(ctx, buf, max_len, flags,
+						  src_addr, addrlen);
+	}
+#endif
+
 	if (ctx->tls->options.role == MBEDTLS_SSL_IS_SERVER) {
 		return recvfrom_dtls_server(ctx, buf, max_len, flags,
 					    src_addr, addrlen);
@@ -1655,6 +2805,23 @@ ssize_t ztls_recvfrom_ctx(struct net_context *ctx, void *buf, size_t max_len,
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 }
 
+static bool tls_has_data(struct net_context *ctx)
+{
+#if defined(CONFIG_NET_SOCKETS_DTLS_MULTI_PEER)
+	if (dtls_is_multi_peer(ctx)) {
+		bool has_data;
+
+		k_mutex_lock(&context_lock, K_FOREVER);
+		has_data = dtls_peer_with_data(ctx->tls) != NULL;
+		k_mutex_unlock(&context_lock);
+
+		return has_data;
+	}
+#endif
+
+	return mbedtls_ssl_get_bytes_avail(&ctx->tls->ssl) > 0;
+}
+
 static int ztls_poll_prepare_ctx(struct net_context *ctx,
 				 struct zsock_pollfd *pfd,
 				 struct k_poll_event **pev,
@@ -1702,7 +2869,7 @@ static int ztls_poll_prepare_ctx(struct net_context *ctx,
 		 * so we won't block in the k_poll.
 		 */
 		if (!IS_LISTENING(ctx)) {
-			if (mbedtls_ssl_get_bytes_avail(&ctx->tls->ssl) > 0) {
+			if (tls_has_data(ctx)) {
 				errno = EALREADY;
 				return -1;
 			}
@@ -1749,7 +2916,7 @@ static int ztls_poll_update_ctx(struct net_context *ctx,
 
 		if (!IS_LISTENING(ctx)) {
 			/* Already had TLS data to read on socket. */
-			if (mbedtls_ssl_get_bytes_avail(&ctx->tls->ssl) > 0) {
+			if (tls_has_data(ctx)) {
 				pfd->revents |= ZSOCK_POLLIN;
 				goto next;
 			}
@@ -1771,8 +2938,7 @@ static int ztls_poll_update_ctx(struct net_context *ctx,
 				goto next;
 			}
 
-			if (mbedtls_ssl_get_bytes_avail(&ctx->tls->ssl) > 0 ||
-			    sock_is_eof(ctx)) {
+			if (tls_has_data(ctx) || sock_is_eof(ctx)) {
 				pfd->revents |= ZSOCK_POLLIN;
 				goto next;
 			}
@@ -1834,6 +3000,14 @@ int ztls_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 		err = tls_opt_ciphersuite_used_get(ctx, optval, optlen);
 		break;
 
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_get(ctx, optval, optlen);
+		break;
+
+	case TLS_DTLS_MULTI_PEER:
+		err = tls_opt_dtls_multi_peer_get(ctx, optval, optlen);
+		break;
+
 	default:
 		/* Unknown or write-only option. */
 		err = -ENOPROTOOPT;
@@ -1884,6 +3058,18 @@ int ztls_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 		err = tls_opt_dtls_role_set(ctx, optval, optlen);
 		break;
 
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_set(ctx, optval, optlen);
+		break;
+
+	case TLS_SESSION_CACHE_PURGE:
+		err = tls_opt_session_cache_purge_set(ctx, optval, optlen);
+		break;
+
+	case TLS_DTLS_MULTI_PEER:
+		err = tls_opt_dtls_multi_peer_set(ctx, optval, optlen);
+		break;
+
 	default:
 		/* Unknown or read-only option. */
 		err = -ENOPROTOOPT;
@@ -2003,7 +3189,7 @@ static int tls_sock_setsockopt_vmeth(void *obj, int level, int optname,
 }
 
 
-static const struct socket_op_vtable tls_sock_fd_op_vtable = {
+const struct socket_op_vtable tls_sock_fd_op_vtable = {
 	.fd_vtable = {
 		.read = tls_sock_read_vmeth,
 		.write = tls_sock_write_vmeth,
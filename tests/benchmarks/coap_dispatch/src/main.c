@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <stdio.h>
+#include <net/coap.h>
+
+/* This benchmark compares the time it takes to dispatch a request to
+ * one of a large number of CoAP resources with the linear search done
+ * by coap_handle_request() and with a resource router. The requests are
+ * built and parsed once, only the dispatching is timed.
+ */
+
+#define N_GROUPS 20
+#define N_PER_GROUP 10
+#define N_RESOURCES (N_GROUPS * N_PER_GROUP)
+#define N_ROUNDS 20
+
+/* The root, the groups and the resources */
+#define N_NODES (1 + N_GROUPS + N_RESOURCES)
+
+#define NAME_LEN 8
+#define PKT_LEN 32
+
+static char group_names[N_GROUPS][NAME_LEN];
+static char resource_names[N_PER_GROUP][NAME_LEN];
+static const char *paths[N_RESOURCES][3];
+static struct coap_resource resources[N_RESOURCES + 1];
+
+static struct coap_router_node nodes[N_NODES];
+static struct coap_router router;
+
+static u8_t requests[N_RESOURCES][PKT_LEN];
+static struct coap_packet cpkts[N_RESOURCES];
+
+#define MAX_OPTIONS 4
+static struct coap_option options[N_RESOURCES][MAX_OPTIONS];
+
+static struct sockaddr_in6 peer_addr = {
+	.sin6_family = AF_INET6,
+};
+
+static u32_t dispatched;
+
+static int resource_get(struct coap_resource *resource,
+			struct coap_packet *request,
+			struct sockaddr *addr, socklen_t addr_len)
+{
+	dispatched++;
+
+	return 0;
+}
+
+static int setup(void)
+{
+	struct coap_packet cpkt;
+	int i, r;
+
+	for (i = 0; i < N_GROUPS; i++) {
+		snprintf(group_names[i], NAME_LEN, "g%d", i);
+	}
+
+	for (i = 0; i < N_PER_GROUP; i++) {
+		snprintf(resource_names[i], NAME_LEN, "r%d", i);
+	}
+
+	for (i = 0; i < N_RESOURCES; i++) {
+		paths[i][0] = group_names[i / N_PER_GROUP];
+		paths[i][1] = resource_names[i % N_PER_GROUP];
+		paths[i][2] = NULL;
+
+		resources[i].path = (const char * const *)paths[i];
+		resources[i].get = resource_get;
+
+		r = coap_packet_init(&cpkt, requests[i], PKT_LEN, 1,
+				     COAP_TYPE_NON_CON, 0, NULL,
+				     COAP_METHOD_GET, i);
+		if (r < 0) {
+			return r;
+		}
+
+		r = coap_packet_append_option(&cpkt, COAP_OPTION_URI_PATH,
+					      paths[i][0],
+					      strlen(paths[i][0]));
+		if (r < 0) {
+			return r;
+		}
+
+		r = coap_packet_append_option(&cpkt, COAP_OPTION_URI_PATH,
+					      paths[i][1],
+					      strlen(paths[i][1]));
+		if (r < 0) {
+			return r;
+		}
+
+		r = coap_packet_parse(&cpkts[i], requests[i], cpkt.offset,
+				      options[i], MAX_OPTIONS);
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	return coap_router_init(&router, resources, nodes, N_NODES);
+}
+
+static u32_t run(bool use_router)
+{
+	u32_t start, cycles;
+	int i, j, r;
+
+	dispatched = 0U;
+
+	start = k_cycle_get_32();
+
+	for (j = 0; j < N_ROUNDS; j++) {
+		for (i = 0; i < N_RESOURCES; i++) {
+			if (use_router) {
+				r = coap_router_handle_request(
+					&router, &cpkts[i], options[i],
+					MAX_OPTIONS,
+					(struct sockaddr *)&peer_addr,
+					sizeof(peer_addr));
+			} else {
+				r = coap_handle_request(
+					&cpkts[i], resources, options[i],
+					MAX_OPTIONS,
+					(struct sockaddr *)&peer_addr,
+					sizeof(peer_addr));
+			}
+
+			if (r < 0) {
+				printk("Request %d not dispatched (%d)\n", i,
+				       r);
+			}
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	if (dispatched != N_ROUNDS * N_RESOURCES) {
+		printk("Dispatched %u requests out of %d\n", dispatched,
+		       N_ROUNDS * N_RESOURCES);
+	}
+
+	return (u32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) /
+		       (N_ROUNDS * N_RESOURCES));
+}
+
+void main(void)
+{
+	int r;
+
+	r = setup();
+	if (r < 0) {
+		printk("Setup failed (%d)\n", r);
+		return;
+	}
+
+	printk("resources %d requests %d\n", N_RESOURCES,
+	       N_ROUNDS * N_RESOURCES);
+
+	printk("linear %u ns/req\n", run(false));
+	printk("router %u ns/req\n", run(true));
+
+	printk("fin\n");
+}
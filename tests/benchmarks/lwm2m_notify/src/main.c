@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <stdio.h>
+#include <net/lwm2m.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_engine.h"
+#include "lwm2m_rw_oma_tlv.h"
+#include "lwm2m_rw_json.h"
+#include "lwm2m_rw_senml_cbor.h"
+
+/* This benchmark compares the notifications sent for a change of every
+ * temperature sensor: one notification per sensor value, or a single
+ * notification of the whole object. The messages are built like the
+ * engine does for an observer, but they are not sent.
+ */
+
+#define N_SENSORS CONFIG_LWM2M_IPSO_TEMP_SENSOR_INSTANCE_COUNT
+#define N_ROUNDS 50
+
+#define SENSOR_VALUE_ID 5700
+#define TOKEN_LEN 8
+
+typedef int (*read_op_t)(struct lwm2m_engine_obj *obj,
+			 struct lwm2m_message *msg, int content_format);
+
+struct format {
+	const char *name;
+	const struct lwm2m_writer *writer;
+	read_op_t read_op;
+	u16_t content_format;
+};
+
+static const struct format tlv = {
+	"tlv", &oma_tlv_writer, do_read_op_tlv, LWM2M_FORMAT_OMA_TLV
+};
+
+static const struct format json = {
+	"json", &json_writer, do_read_op_json, LWM2M_FORMAT_OMA_JSON
+};
+
+static const struct format cbor = {
+	"cbor", &senml_cbor_writer, do_read_op_senml_cbor,
+	LWM2M_FORMAT_APP_SENML_CBOR
+};
+
+static u8_t token[TOKEN_LEN] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+static struct lwm2m_engine_obj *sensor_obj;
+static struct lwm2m_message msg;
+
+static u32_t counter;
+static u32_t total_bytes;
+
+static int setup(void)
+{
+	struct lwm2m_engine_obj_inst *obj_inst;
+	int i, r;
+
+	for (i = 0; i < N_SENSORS; i++) {
+		r = lwm2m_create_obj_inst(IPSO_OBJECT_TEMP_SENSOR_ID, i,
+					  &obj_inst);
+		if (r < 0) {
+			return r;
+		}
+
+		sensor_obj = obj_inst->obj;
+	}
+
+	return 0;
+}
+
+static void update_sensors(int round)
+{
+	float32_value_t value;
+	char path[MAX_RESOURCE_LEN];
+	int i;
+
+	for (i = 0; i < N_SENSORS; i++) {
+		value.val1 = 20 + i;
+		value.val2 = round * 10000;
+
+		snprintf(path, sizeof(path), "%u/%d/%u",
+			 IPSO_OBJECT_TEMP_SENSOR_ID, i, SENSOR_VALUE_ID);
+		lwm2m_engine_set_float32(path, &value);
+	}
+}
+
+/* Build a notification of the path, see generate_notify_message() */
+static int notify(const struct format *format, struct lwm2m_obj_path *path)
+{
+	int r;
+
+	(void)memset(&msg, 0, sizeof(msg));
+	memcpy(&msg.path, path, sizeof(msg.path));
+	msg.operation = LWM2M_OP_READ;
+	msg.out.out_cpkt = &msg.cpkt;
+	msg.out.writer = format->writer;
+
+	r = coap_packet_init(&msg.cpkt, msg.msg_data, sizeof(msg.msg_data),
+			     1, COAP_TYPE_CON, sizeof(token), token,
+			     COAP_RESPONSE_CODE_CONTENT, 0U);
+	if (r < 0) {
+		return r;
+	}
+
+	r = coap_append_option_int(&msg.cpkt, COAP_OPTION_OBSERVE,
+				   ++counter);
+	if (r < 0) {
+		return r;
+	}
+
+	r = format->read_op(sensor_obj, &msg, format->content_format);
+	if (r < 0) {
+		return r;
+	}
+
+	total_bytes += msg.cpkt.offset;
+
+	return 0;
+}
+
+static void run(const struct format *format, bool object)
+{
+	struct lwm2m_obj_path path = {
+		.obj_id = IPSO_OBJECT_TEMP_SENSOR_ID,
+		.res_id = SENSOR_VALUE_ID,
+	};
+	u32_t start, cycles = 0U;
+	int i, j, r = 0;
+
+	total_bytes = 0U;
+
+	for (j = 0; j < N_ROUNDS && r == 0; j++) {
+		update_sensors(j);
+
+		start = k_cycle_get_32();
+
+		if (object) {
+			path.level = 1U;
+			r = notify(format, &path);
+		} else {
+			path.level = 3U;
+			for (i = 0; i < N_SENSORS && r == 0; i++) {
+				path.obj_inst_id = i;
+				r = notify(format, &path);
+			}
+		}
+
+		cycles += k_cycle_get_32() - start;
+	}
+
+	if (r < 0) {
+		printk("%s %s notification failed (%d)\n",
+		       object ? "object" : "single", format->name, r);
+		return;
+	}
+
+	printk("%s %s %u bytes %u ns/change\n",
+	       object ? "object" : "single", format->name,
+	       total_bytes / (N_ROUNDS * N_SENSORS),
+	       (u32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) /
+		       (N_ROUNDS * N_SENSORS)));
+}
+
+void main(void)
+{
+	int r;
+
+	r = setup();
+	if (r < 0) {
+		printk("Setup failed (%d)\n", r);
+		return;
+	}
+
+	printk("sensors %d rounds %d\n", N_SENSORS, N_ROUNDS);
+
+	run(&tlv, false);
+	run(&cbor, false);
+	run(&tlv, true);
+	run(&json, true);
+	run(&cbor, true);
+
+	printk("fin\n");
+}
@@ -72,6 +72,8 @@
 
 #include "kernel.h"
 
+#include "handshake.h"
+
 #include <misc/printk.h>
 #define  MBEDTLS_PRINT ((int(*)(const char *, ...)) printk)
 
@@ -1061,6 +1063,8 @@ int main(int argc, char *argv[])
 		}
 	}
 #endif
+	handshake_benchmark();
+
 	mbedtls_printf("\n       Done\n");
 
 	return 0;
@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#if !defined(CONFIG_MBEDTLS_CFG_FILE)
+#include "mbedtls/config.h"
+#else
+#include CONFIG_MBEDTLS_CFG_FILE
+#endif /* CONFIG_MBEDTLS_CFG_FILE */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
+#include "mbedtls/certs.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pk.h"
+
+#include <zephyr.h>
+#include <misc/printk.h>
+
+#include "handshake.h"
+
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_SSL_SRV_C) && \
+	defined(MBEDTLS_CERTS_C) && defined(MBEDTLS_X509_CRT_PARSE_C) && \
+	defined(MBEDTLS_PEM_PARSE_C)
+
+#define HEADER_FORMAT   "  %-24s :  "
+#define HANDSHAKES      8
+#define MAX_STEPS       64
+
+enum resumption {
+	RESUME_NONE,
+	RESUME_SESSION_ID,
+	RESUME_TICKET,
+};
+
+/* One direction of the in-memory transport. */
+struct pipe {
+	unsigned char buf[4096];
+	size_t len;
+};
+
+static struct pipe to_server, to_client;
+
+/* The client writes to_server and reads to_client, the server the other
+ * way around.
+ */
+struct endpoint {
+	struct pipe *tx;
+	struct pipe *rx;
+};
+
+static struct endpoint client_end = { &to_server, &to_client };
+static struct endpoint server_end = { &to_client, &to_server };
+
+static int pipe_send(void *ctx, const unsigned char *buf, size_t len)
+{
+	struct pipe *pipe = ((struct endpoint *)ctx)->tx;
+
+	len = MIN(len, sizeof(pipe->buf) - pipe->len);
+	if (len == 0) {
+		return MBEDTLS_ERR_SSL_WANT_WRITE;
+	}
+
+	memcpy(pipe->buf + pipe->len, buf, len);
+	pipe->len += len;
+
+	return len;
+}
+
+static int pipe_recv(void *ctx, unsigned char *buf, size_t len)
+{
+	struct pipe *pipe = ((struct endpoint *)ctx)->rx;
+
+	len = MIN(len, pipe->len);
+	if (len == 0) {
+		return MBEDTLS_ERR_SSL_WANT_READ;
+	}
+
+	memcpy(buf, pipe->buf, len);
+	memmove(pipe->buf, pipe->buf + len, pipe->len - len);
+	pipe->len -= len;
+
+	return len;
+}
+
+static int hs_rand(void *rng_state, unsigned char *output, size_t len)
+{
+	u32_t rnd;
+	size_t use_len;
+
+	ARG_UNUSED(rng_state);
+
+	while (len > 0) {
+		use_len = MIN(len, sizeof(rnd));
+		rnd = sys_rand32_get();
+		memcpy(output, &rnd, use_len);
+		output += use_len;
+		len -= use_len;
+	}
+
+	return 0;
+}
+
+static mbedtls_ssl_context client, server;
+static mbedtls_ssl_config client_conf, server_conf;
+static mbedtls_x509_crt srv_crt;
+static mbedtls_pk_context srv_key;
+static mbedtls_ssl_session session;
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+static mbedtls_ssl_cache_context cache;
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+static mbedtls_ssl_ticket_context tickets;
+#endif
+
+/* Run both ends of the handshake until they are done. */
+static int handshake(void)
+{
+	bool client_done = false, server_done = false;
+	int ret, steps;
+
+	for (steps = 0; steps < MAX_STEPS; steps++) {
+		if (!client_done) {
+			ret = mbedtls_ssl_handshake(&client);
+			if (ret == 0) {
+				client_done = true;
+			} else if (ret != MBEDTLS_ERR_SSL_WANT_READ &&
+				   ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+				return ret;
+			}
+		}
+
+		if (!server_done) {
+			ret = mbedtls_ssl_handshake(&server);
+			if (ret == 0) {
+				server_done = true;
+			} else if (ret != MBEDTLS_ERR_SSL_WANT_READ &&
+				   ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+				return ret;
+			}
+		}
+
+		if (client_done && server_done) {
+			return 0;
+		}
+	}
+
+	return MBEDTLS_ERR_SSL_TIMEOUT;
+}
+
+static int reset(bool resume)
+{
+	int ret;
+
+	to_server.len = 0;
+	to_client.len = 0;
+
+	ret = mbedtls_ssl_session_reset(&client);
+	if (ret == 0) {
+		ret = mbedtls_ssl_session_reset(&server);
+	}
+
+	if (ret == 0 && resume) {
+		ret = mbedtls_ssl_set_session(&client, &session);
+	}
+
+	return ret;
+}
+
+static int setup(enum resumption resumption)
+{
+	int ret;
+
+	ret = mbedtls_ssl_config_defaults(&client_conf, MBEDTLS_SSL_IS_CLIENT,
+					  MBEDTLS_SSL_TRANSPORT_STREAM,
+					  MBEDTLS_SSL_PRESET_DEFAULT);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = mbedtls_ssl_config_defaults(&server_conf, MBEDTLS_SSL_IS_SERVER,
+					  MBEDTLS_SSL_TRANSPORT_STREAM,
+					  MBEDTLS_SSL_PRESET_DEFAULT);
+	if (ret != 0) {
+		return ret;
+	}
+
+	/* Only the cost of the handshake itself is measured. */
+	mbedtls_ssl_conf_authmode(&client_conf, MBEDTLS_SSL_VERIFY_NONE);
+	mbedtls_ssl_conf_rng(&client_conf, hs_rand, NULL);
+	mbedtls_ssl_conf_rng(&server_conf, hs_rand, NULL);
+
+	ret = mbedtls_ssl_conf_own_cert(&server_conf, &srv_crt, &srv_key);
+	if (ret != 0) {
+		return ret;
+	}
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+	mbedtls_ssl_conf_session_tickets(&client_conf,
+					 resumption == RESUME_TICKET ?
+					 MBEDTLS_SSL_SESSION_TICKETS_ENABLED :
+					 MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+#endif
+
+	if (resumption == RESUME_SESSION_ID) {
+#if defined(MBEDTLS_SSL_CACHE_C)
+		mbedtls_ssl_conf_session_cache(&server_conf, &cache,
+					       mbedtls_ssl_cache_get,
+					       mbedtls_ssl_cache_set);
+#else
+		return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+#endif
+	} else if (resumption == RESUME_TICKET) {
+#if defined(MBEDTLS_SSL_TICKET_C) && defined(MBEDTLS_SSL_SESSION_TICKETS)
+		mbedtls_ssl_conf_session_tickets_cb(&server_conf,
+						    mbedtls_ssl_ticket_write,
+						    mbedtls_ssl_ticket_parse,
+						    &tickets);
+#else
+		return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+#endif
+	}
+
+	ret = mbedtls_ssl_setup(&client, &client_conf);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = mbedtls_ssl_setup(&server, &server_conf);
+	if (ret != 0) {
+		return ret;
+	}
+
+	mbedtls_ssl_set_bio(&client, &client_end, pipe_send, pipe_recv, NULL);
+	mbedtls_ssl_set_bio(&server, &server_end, pipe_send, pipe_recv, NULL);
+
+	/* The first handshake gives the session to resume. */
+	if (resumption != RESUME_NONE) {
+		ret = handshake();
+		if (ret == 0) {
+			ret = mbedtls_ssl_get_session(&client, &session);
+		}
+	}
+
+	return ret;
+}
+
+static void time_handshake(const char *title, enum resumption resumption)
+{
+	u64_t cycles = 0;
+	u32_t start;
+	int ret, i;
+
+	printk(HEADER_FORMAT, title);
+
+	mbedtls_ssl_init(&client);
+	mbedtls_ssl_init(&server);
+	mbedtls_ssl_config_init(&client_conf);
+	mbedtls_ssl_config_init(&server_conf);
+	mbedtls_ssl_session_init(&session);
+
+	ret = setup(resumption);
+
+	for (i = 0; ret == 0 && i < HANDSHAKES; i++) {
+		ret = reset(resumption != RESUME_NONE);
+		if (ret != 0) {
+			break;
+		}
+
+		start = k_cycle_get_32();
+		ret = handshake();
+		cycles += k_cycle_get_32() - start;
+	}
+
+	if (ret != 0) {
+		printk("FAILED: -0x%04x\n", -ret);
+	} else {
+		printk("%9u us/handshake\n",
+		       (u32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) /
+			       (HANDSHAKES * NSEC_PER_USEC)));
+	}
+
+	mbedtls_ssl_session_free(&session);
+	mbedtls_ssl_free(&client);
+	mbedtls_ssl_free(&server);
+	mbedtls_ssl_config_free(&client_conf);
+	mbedtls_ssl_config_free(&server_conf);
+}
+
+void handshake_benchmark(void)
+{
+	int ret;
+
+	mbedtls_x509_crt_init(&srv_crt);
+	mbedtls_pk_init(&srv_key);
+
+	ret = mbedtls_x509_crt_parse(&srv_crt,
+				     (const unsigned char *)mbedtls_test_srv_crt,
+				     mbedtls_test_srv_crt_len);
+	if (ret == 0) {
+		ret = mbedtls_pk_parse_key(&srv_key,
+				(const unsigned char *)mbedtls_test_srv_key,
+				mbedtls_test_srv_key_len, NULL, 0);
+	}
+
+	if (ret != 0) {
+		printk("Cannot load the test certificate: -0x%04x\n", -ret);
+		goto out;
+	}
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+	mbedtls_ssl_cache_init(&cache);
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+	mbedtls_ssl_ticket_init(&tickets);
+
+	ret = mbedtls_ssl_ticket_setup(&tickets, hs_rand, NULL,
+				       MBEDTLS_CIPHER_AES_256_GCM, 86400);
+	if (ret != 0) {
+		printk("Cannot set up session tickets: -0x%04x\n", -ret);
+	}
+#endif
+
+	time_handshake("TLS full handshake", RESUME_NONE);
+	time_handshake("TLS resume (session ID)", RESUME_SESSION_ID);
+	time_handshake("TLS resume (ticket)", RESUME_TICKET);
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+	mbedtls_ssl_ticket_free(&tickets);
+#endif
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+	mbedtls_ssl_cache_free(&cache);
+#endif
+
+out:
+	mbedtls_x509_crt_free(&srv_crt);
+	mbedtls_pk_free(&srv_key);
+}
+
+#else
+
+void handshake_benchmark(void)
+{
+	printk("TLS handshake benchmark not supported by the mbedTLS "
+	       "configuration\n");
+}
+
+#endif
@@ -0,0 +1,15 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __HANDSHAKE_H__
+#define __HANDSHAKE_H__
+
+/* Time TLS handshakes between a client and a server in memory, with and
+ * without session resumption.
+ */
+void handshake_benchmark(void);
+
+#endif /* __HANDSHAKE_H__ */
@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/socket.h>
+#include <net/mqtt.h>
+
+/* This benchmark publishes QoS 1 messages to a broker stand-in on the
+ * loopback interface, which acknowledges every message it receives.
+ * The client either waits for the acknowledgment of each message before
+ * publishing the next one, or keeps a window of messages in flight.
+ */
+
+#define BROKER_PORT 1883
+#define BROKER_STACK_SIZE 2048
+#define BROKER_PRIORITY 7
+
+#define N_MESSAGES 500
+#define PAYLOAD_LEN 32
+#define WINDOW CONFIG_MQTT_INFLIGHT_WINDOW
+
+#define MQTT_CONNECT 0x10
+#define MQTT_CONNACK 0x20
+#define MQTT_PUBLISH 0x30
+#define MQTT_PUBACK 0x40
+#define MQTT_PINGREQ 0xc0
+#define MQTT_PINGRESP 0xd0
+#define MQTT_DISCONNECT 0xe0
+
+#define POLL_TIMEOUT 1000
+
+static u8_t broker_rx[512];
+static u8_t broker_tx[256];
+
+static u8_t rx_buffer[256];
+static u8_t tx_buffer[256];
+static u8_t payload[PAYLOAD_LEN];
+
+static struct mqtt_client client;
+static struct sockaddr_in broker_addr;
+static struct mqtt_publish_param params[WINDOW];
+
+static bool connected;
+static u32_t acked;
+
+/* Parse a message of the buffer, return its length or 0 if incomplete */
+static int parse_message(const u8_t *buf, int len, u8_t *type, u16_t *id)
+{
+	u32_t remaining = 0U;
+	int pos = 1;
+	int shift = 0;
+
+	do {
+		if (pos >= len || shift > 21) {
+			return 0;
+		}
+
+		remaining |= (buf[pos] & 0x7f) << shift;
+		shift += 7;
+	} while (buf[pos++] & 0x80);
+
+	if (pos + remaining > len) {
+		return 0;
+	}
+
+	*type = buf[0];
+	*id = 0U;
+
+	/* The message id follows the topic of a QoS 1 or 2 publish */
+	if ((buf[0] & 0xf0) == MQTT_PUBLISH && (buf[0] & 0x06)) {
+		int topic_len = buf[pos] << 8 | buf[pos + 1];
+
+		*id = buf[pos + 2 + topic_len] << 8 |
+		      buf[pos + 3 + topic_len];
+	}
+
+	return pos + remaining;
+}
+
+static int answer(u8_t type, u16_t id, u8_t *out)
+{
+	switch (type & 0xf0) {
+	case MQTT_CONNECT:
+		out[0] = MQTT_CONNACK;
+		out[1] = 2U;
+		out[2] = 0U;
+		out[3] = 0U;
+		return 4;
+	case MQTT_PUBLISH:
+		if (!id) {
+			return 0;
+		}
+
+		out[0] = MQTT_PUBACK;
+		out[1] = 2U;
+		out[2] = id >> 8;
+		out[3] = id;
+		return 4;
+	case MQTT_PINGREQ:
+		out[0] = MQTT_PINGRESP;
+		out[1] = 0U;
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+static void broker_session(int sock)
+{
+	int fill = 0;
+	int len, msg_len, out;
+	u8_t type;
+	u16_t id;
+
+	while (true) {
+		len = recv(sock, broker_rx + fill, sizeof(broker_rx) - fill, 0);
+		if (len <= 0) {
+			return;
+		}
+
+		fill += len;
+		out = 0;
+
+		/* Answer all the messages received at once with one write */
+		while ((msg_len = parse_message(broker_rx, fill, &type,
+						&id)) > 0) {
+			if ((type & 0xf0) == MQTT_DISCONNECT) {
+				return;
+			}
+
+			if (out + 4 > sizeof(broker_tx)) {
+				send(sock, broker_tx, out, 0);
+				out = 0;
+			}
+
+			out += answer(type, id, broker_tx + out);
+
+			fill -= msg_len;
+			memmove(broker_rx, broker_rx + msg_len, fill);
+		}
+
+		if (out) {
+			send(sock, broker_tx, out, 0);
+		}
+	}
+}
+
+static void broker(void *p1, void *p2, void *p3)
+{
+	struct sockaddr_in addr = { 0 };
+	int sock, client_sock;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (sock < 0) {
+		printk("Broker socket failed (%d)\n", errno);
+		return;
+	}
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(BROKER_PORT);
+	inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+	if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    listen(sock, 1) < 0) {
+		printk("Broker listen failed (%d)\n", errno);
+		return;
+	}
+
+	while (true) {
+		client_sock = accept(sock, NULL, NULL);
+		if (client_sock < 0) {
+			continue;
+		}
+
+		broker_session(client_sock);
+		close(client_sock);
+	}
+}
+
+K_THREAD_DEFINE(broker_stand_in, BROKER_STACK_SIZE, broker, NULL, NULL, NULL,
+		K_PRIO_PREEMPT(BROKER_PRIORITY), 0, K_NO_WAIT);
+
+static void mqtt_evt_handler(struct mqtt_client *const c,
+			     const struct mqtt_evt *evt)
+{
+	ARG_UNUSED(c);
+
+	switch (evt->type) {
+	case MQTT_EVT_CONNACK:
+		connected = (evt->result == 0);
+		break;
+	case MQTT_EVT_DISCONNECT:
+		connected = false;
+		break;
+	case MQTT_EVT_PUBACK:
+		if (evt->result == 0) {
+			acked++;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/* Wait for input from the broker and process one message */
+static int input(void)
+{
+	struct pollfd fds = {
+		.fd = client.transport.tcp.sock,
+		.events = ZSOCK_POLLIN,
+	};
+	int r;
+
+	r = poll(&fds, 1, POLL_TIMEOUT);
+	if (r <= 0) {
+		return r < 0 ? -errno : -ETIMEDOUT;
+	}
+
+	return mqtt_input(&client);
+}
+
+static int setup(void)
+{
+	int r;
+
+	broker_addr.sin_family = AF_INET;
+	broker_addr.sin_port = htons(BROKER_PORT);
+	inet_pton(AF_INET, "127.0.0.1", &broker_addr.sin_addr);
+
+	mqtt_client_init(&client);
+
+	client.broker = &broker_addr;
+	client.evt_cb = mqtt_evt_handler;
+	client.client_id.utf8 = (u8_t *)"bench";
+	client.client_id.size = sizeof("bench") - 1;
+	client.protocol_version = MQTT_VERSION_3_1_1;
+	client.rx_buf = rx_buffer;
+	client.rx_buf_size = sizeof(rx_buffer);
+	client.tx_buf = tx_buffer;
+	client.tx_buf_size = sizeof(tx_buffer);
+	client.transport.type = MQTT_TRANSPORT_NON_SECURE;
+
+	r = mqtt_connect(&client);
+	if (r < 0) {
+		return r;
+	}
+
+	while (!connected) {
+		r = input();
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	return 0;
+}
+
+static void prepare(struct mqtt_publish_param *param, u32_t seq)
+{
+	param->message.topic.topic.utf8 = (u8_t *)"bench/data";
+	param->message.topic.topic.size = sizeof("bench/data") - 1;
+	param->message.topic.qos = MQTT_QOS_1_AT_LEAST_ONCE;
+	param->message.payload.data = payload;
+	param->message.payload.len = sizeof(payload);
+	param->message_id = seq % 0xffff + 1;
+	param->dup_flag = 0U;
+	param->retain_flag = 0U;
+}
+
+static int stop_and_wait(void)
+{
+	u32_t i;
+	int r;
+
+	for (i = 0U; i < N_MESSAGES; i++) {
+		prepare(&params[0], i);
+
+		r = mqtt_publish(&client, &params[0]);
+		if (r < 0) {
+			return r;
+		}
+
+		while (acked <= i) {
+			r = input();
+			if (r < 0) {
+				return r;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static int windowed(void)
+{
+	u32_t sent = 0U;
+	u32_t count, i;
+	int r;
+
+	while (acked < N_MESSAGES) {
+		count = MIN(WINDOW - (sent - acked), N_MESSAGES - sent);
+
+		for (i = 0U; i < count; i++) {
+			prepare(&params[i], sent + i);
+		}
+
+		if (count > 0) {
+			r = mqtt_publish_batch(&client, params, count);
+			if (r < 0 && r != -EAGAIN) {
+				return r;
+			} else if (r > 0) {
+				sent += r;
+			}
+		}
+
+		r = input();
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	return 0;
+}
+
+static void run(const char *name, int (*publish)(void))
+{
+	u32_t start, elapsed;
+	int r;
+
+	acked = 0U;
+
+	start = k_uptime_get_32();
+	r = publish();
+	elapsed = k_uptime_get_32() - start;
+
+	if (r < 0) {
+		printk("%s publish failed (%d)\n", name, r);
+		return;
+	}
+
+	printk("%s %u msg/s\n", name,
+	       (u32_t)(N_MESSAGES * MSEC_PER_SEC / MAX(elapsed, 1U)));
+}
+
+void main(void)
+{
+	int r;
+
+	r = setup();
+	if (r < 0) {
+		printk("Setup failed (%d)\n", r);
+		return;
+	}
+
+	printk("messages %d payload %d bytes window %d\n", N_MESSAGES,
+	       PAYLOAD_LEN, WINDOW);
+
+	run("stop-and-wait", stop_and_wait);
+	run("window", windowed);
+
+	mqtt_disconnect(&client);
+
+	printk("fin\n");
+}
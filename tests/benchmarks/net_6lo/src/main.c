@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_pkt.h>
+#include <net/dummy.h>
+
+#include "6lo.h"
+#include "icmpv6.h"
+
+/* This is a header compression benchmark for 6lowpan. For each of some
+ * of the tests/net/6lo vectors, a stream of packets of the same flow is
+ * compressed and uncompressed, and the average time spent in each is
+ * reported. With CONFIG_NET_6LO_FLOW_CACHE_SIZE set, all but the first
+ * packet of a stream go through the flow caches.
+ */
+
+#define N_ROUNDS 200
+#define PAYLOAD_LEN 40
+
+struct bench_vector {
+	const char *name;
+	struct net_ipv6_hdr ipv6;
+	struct net_udp_hdr udp;
+};
+
+#define ADDR(a0, a1, a11, a12, a14, a15)				\
+	{ { { a0, a1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,		\
+	      0x00, 0x00, 0x00, a11, a12, 0x00, a14, a15 } } }
+
+#define IPV6_HDR(_tcflow, _flow, _nexthdr, _src, _dst)			\
+	{ .vtc = 0x60, .tcflow = _tcflow, .flow = _flow,		\
+	  .nexthdr = _nexthdr, .hop_limit = 0xff,			\
+	  .src = _src, .dst = _dst }
+
+#define UDP_HDR(_src_port, _dst_port)					\
+	{ .src_port = htons(_src_port), .dst_port = htons(_dst_port) }
+
+static struct bench_vector vectors[] = {
+	{ "sam00_dam00",
+	  IPV6_HDR(0x00, 0x0000, IPPROTO_UDP,
+		   ADDR(0x20, 0x00, 0x00, 0x00, 0x00, 0x00),
+		   ADDR(0x20, 0x00, 0x00, 0x00, 0x00, 0x00)),
+	  UDP_HDR(0xf0b1, 0xf0b2) },
+	{ "sam01_dam01",
+	  IPV6_HDR(0x20, 0x3412, IPPROTO_UDP,
+		   ADDR(0xfe, 0x80, 0x00, 0x00, 0x00, 0xaa),
+		   ADDR(0xfe, 0x80, 0x00, 0x00, 0x00, 0xaa)),
+	  UDP_HDR(0xf011, 0xf122) },
+	{ "sam10_dam10",
+	  IPV6_HDR(0x21, 0x3412, IPPROTO_UDP,
+		   ADDR(0xfe, 0x80, 0xff, 0xfe, 0x00, 0xbb),
+		   ADDR(0xfe, 0x80, 0xff, 0xfe, 0x00, 0xbb)),
+	  UDP_HDR(0xf111, 0xf022) },
+	{ "sam11_dam11",
+	  IPV6_HDR(0x21, 0x3412, IPPROTO_UDP,
+		   ADDR(0xfe, 0x80, 0x00, 0x00, 0xaa, 0xbb),
+		   ADDR(0xfe, 0x80, 0x00, 0x00, 0xbb, 0xaa)),
+	  UDP_HDR(0xf111, 0xf022) },
+	{ "sam00_m1_dam00",
+	  IPV6_HDR(0x20, 0x0000, IPPROTO_UDP,
+		   ADDR(0x20, 0x00, 0x00, 0x00, 0x00, 0x00),
+		   ADDR(0xff, 0x00, 0x11, 0x22, 0x55, 0x66)),
+	  UDP_HDR(0xff11, 0xff22) },
+	{ "sam10_m1_dam10_no_udp",
+	  IPV6_HDR(0x00, 0x0000, NET_IPV6_NEXTHDR_NONE,
+		   ADDR(0xfe, 0x80, 0xff, 0xfe, 0x00, 0xbb),
+		   ADDR(0xff, 0x11, 0x00, 0x11, 0x22, 0x33)),
+	  UDP_HDR(0, 0) },
+	{ "sac1_sam11_dac1_dam11",
+	  IPV6_HDR(0x21, 0x3412, IPPROTO_UDP,
+		   ADDR(0xaa, 0xbb, 0x00, 0x00, 0xaa, 0xbb),
+		   ADDR(0xcc, 0xdd, 0x00, 0x00, 0xbb, 0xaa)),
+	  UDP_HDR(0xf111, 0xf022) },
+};
+
+/* Contexts of the sac1/dac1 vector */
+static struct net_icmpv6_nd_opt_6co ctx1 = {
+	.context_len = 0x40,
+	.flag = 0x11,
+	.lifetime = 0x1234,
+	.prefix = ADDR(0xaa, 0xbb, 0x00, 0x00, 0x00, 0x00),
+};
+
+static struct net_icmpv6_nd_opt_6co ctx2 = {
+	.context_len = 0x40,
+	.flag = 0x12,
+	.lifetime = 0x1234,
+	.prefix = ADDR(0xcc, 0xdd, 0x00, 0x00, 0x00, 0x00),
+};
+
+static u8_t src_mac[8] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xaa, 0xbb };
+static u8_t dst_mac[8] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0xbb, 0xaa };
+
+static u8_t payload[PAYLOAD_LEN];
+
+static struct net_if *iface;
+
+static void bench_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, src_mac, sizeof(src_mac),
+			     NET_LINK_IEEE802154);
+}
+
+static int bench_send(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static int bench_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static struct dummy_api bench_if_api = {
+	.iface_api.init = bench_iface_init,
+	.send = bench_send,
+};
+
+NET_DEVICE_INIT(net_6lo_bench, "net_6lo_bench",
+		bench_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&bench_if_api, DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+static bool is_udp(struct bench_vector *vector)
+{
+	return vector->ipv6.nexthdr == IPPROTO_UDP;
+}
+
+static struct net_pkt *create_pkt(struct bench_vector *vector)
+{
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+	u16_t len = PAYLOAD_LEN;
+
+	pkt = net_pkt_alloc_on_iface(iface, K_FOREVER);
+	if (!pkt) {
+		return NULL;
+	}
+
+	net_pkt_set_ip_hdr_len(pkt, NET_IPV6H_LEN);
+
+	net_pkt_lladdr_src(pkt)->addr = src_mac;
+	net_pkt_lladdr_src(pkt)->len = sizeof(src_mac);
+	net_pkt_lladdr_dst(pkt)->addr = dst_mac;
+	net_pkt_lladdr_dst(pkt)->len = sizeof(dst_mac);
+
+	frag = net_pkt_get_frag(pkt, K_FOREVER);
+	if (!frag) {
+		net_pkt_unref(pkt);
+		return NULL;
+	}
+
+	net_pkt_frag_add(pkt, frag);
+
+	if (is_udp(vector)) {
+		len += NET_UDPH_LEN;
+		vector->udp.len = htons(len);
+	}
+
+	vector->ipv6.len = htons(len);
+
+	memcpy(net_buf_add(frag, NET_IPV6H_LEN), &vector->ipv6,
+	       NET_IPV6H_LEN);
+
+	if (is_udp(vector)) {
+		memcpy(net_buf_add(frag, NET_UDPH_LEN), &vector->udp,
+		       NET_UDPH_LEN);
+	}
+
+	memcpy(net_buf_add(frag, PAYLOAD_LEN), payload, PAYLOAD_LEN);
+
+	return pkt;
+}
+
+static bool run_vector(struct bench_vector *vector)
+{
+	u32_t compress = 0U, uncompress = 0U;
+	struct net_pkt *pkt;
+	u32_t start;
+	int round;
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		pkt = create_pkt(vector);
+		if (!pkt) {
+			printk("Cannot create packet\n");
+			return false;
+		}
+
+		start = k_cycle_get_32();
+
+		if (net_6lo_compress(pkt, true) < 0) {
+			printk("%s: compression failed\n", vector->name);
+			net_pkt_unref(pkt);
+			return false;
+		}
+
+		compress += k_cycle_get_32() - start;
+		start = k_cycle_get_32();
+
+		if (!net_6lo_uncompress(pkt)) {
+			printk("%s: uncompression failed\n", vector->name);
+			net_pkt_unref(pkt);
+			return false;
+		}
+
+		uncompress += k_cycle_get_32() - start;
+
+		if (memcmp(pkt->frags->data, &vector->ipv6, NET_IPV6H_LEN) ||
+		    (is_udp(vector) &&
+		     memcmp(pkt->frags->data + NET_IPV6H_LEN, &vector->udp,
+			    NET_UDPH_LEN))) {
+			printk("%s: headers differ\n", vector->name);
+			net_pkt_unref(pkt);
+			return false;
+		}
+
+		net_pkt_unref(pkt);
+	}
+
+	printk("%-24s compress %6u uncompress %6u ns\n", vector->name,
+	       (u32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(compress) / N_ROUNDS),
+	       (u32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(uncompress) / N_ROUNDS));
+
+	return true;
+}
+
+void main(void)
+{
+	int i;
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	if (!iface) {
+		printk("No dummy interface\n");
+		return;
+	}
+
+	for (i = 0; i < sizeof(payload); i++) {
+		payload[i] = i;
+	}
+
+	net_6lo_set_context(iface, &ctx1);
+	net_6lo_set_context(iface, &ctx2);
+
+	for (i = 0; i < ARRAY_SIZE(vectors); i++) {
+		if (!run_vector(&vectors[i])) {
+			break;
+		}
+	}
+
+	printk("fin\n");
+}
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <string.h>
+
+#include <net/socket.h>
+#include <net/net_if.h>
+#include <net/net_mgmt.h>
+#include <net/ieee802154_mgmt.h>
+
+/* Node 1 is the sink, echoing back the UDP packets it receives. The other
+ * nodes send N_PACKETS packets each to the sink, waiting for the echo of
+ * each one, and report how many echoes came back, their average round
+ * trip time and the resulting goodput.
+ *
+ * With CONFIG_NET_L2_IEEE802154_RADIO_TSCH, the sink is the time source of
+ * the network and each node gets a dedicated cell to the sink and another
+ * one back from it, next to the shared minimal cell.
+ */
+
+#define SINK_NODE 1
+#define MAX_NODES 8
+
+#define PAN_ID 0xabcd
+#define CHANNEL 26
+
+#define ECHO_PORT 4242
+#define N_PACKETS 100
+#define PAYLOAD_LEN 64
+#define ECHO_TIMEOUT 2000 /* ms */
+#define JOIN_ATTEMPTS 30
+
+static u8_t payload[PAYLOAD_LEN];
+static u8_t echo_buf[PAYLOAD_LEN];
+
+static u32_t node_id(struct net_if *iface)
+{
+	struct net_linkaddr *ll_addr = net_if_get_link_addr(iface);
+
+	/* The driver puts the node id in the last 3 bytes of the address */
+	return (ll_addr->addr[5] << 16) | (ll_addr->addr[6] << 8) |
+		ll_addr->addr[7];
+}
+
+#if defined(CONFIG_NET_L2_IEEE802154_RADIO_TSCH)
+
+/* The uplink of node n is in slot n - 1, its downlink MAX_NODES slots
+ * later.
+ */
+#define UPLINK_SLOT(node) ((node) - SINK_NODE)
+#define DOWNLINK_SLOT(node) (MAX_NODES + (node) - SINK_NODE)
+
+BUILD_ASSERT_MSG(CONFIG_NET_L2_IEEE802154_RADIO_TSCH_SLOTFRAME_SIZE >
+		 DOWNLINK_SLOT(SINK_NODE + MAX_NODES),
+		 "Slotframe too small for the schedule");
+
+static int tsch_add_cell(struct net_if *iface, u32_t peer, u16_t slot,
+			 u8_t options)
+{
+	struct ieee802154_tsch_cell cell = {
+		.slot_offset = slot,
+		.channel_offset = slot,
+		.options = options,
+	};
+
+	/* Rx cells listen to any neighbor */
+	if (options & IEEE802154_TSCH_CELL_TX) {
+		cell.addr[2] = 0x5e;
+		cell.addr[3] = 0xef;
+		cell.addr[4] = 0x10;
+		cell.addr[5] = peer >> 16;
+		cell.addr[6] = peer >> 8;
+		cell.addr[7] = peer;
+	}
+
+	return net_mgmt(NET_REQUEST_IEEE802154_TSCH_ADD_CELL, iface,
+			&cell, sizeof(cell));
+}
+
+static int tsch_setup(struct net_if *iface, u32_t node)
+{
+	bool time_source = (node == SINK_NODE);
+	u32_t peer;
+	int ret;
+
+	ret = net_mgmt(NET_REQUEST_IEEE802154_TSCH_START, iface,
+		       &time_source, sizeof(time_source));
+	if (ret) {
+		return ret;
+	}
+
+	if (!time_source) {
+		if (node > SINK_NODE + MAX_NODES) {
+			printk("node %u only uses the minimal cell\n", node);
+			return 0;
+		}
+
+		ret = tsch_add_cell(iface, SINK_NODE, UPLINK_SLOT(node),
+				    IEEE802154_TSCH_CELL_TX);
+		if (ret) {
+			return ret;
+		}
+
+		return tsch_add_cell(iface, SINK_NODE, DOWNLINK_SLOT(node),
+				     IEEE802154_TSCH_CELL_RX);
+	}
+
+	for (peer = SINK_NODE + 1; peer <= SINK_NODE + MAX_NODES; peer++) {
+		ret = tsch_add_cell(iface, peer, UPLINK_SLOT(peer),
+				    IEEE802154_TSCH_CELL_RX);
+		if (ret) {
+			return ret;
+		}
+
+		ret = tsch_add_cell(iface, peer, DOWNLINK_SLOT(peer),
+				    IEEE802154_TSCH_CELL_TX);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+#else
+
+#define tsch_setup(...) 0
+
+#endif /* CONFIG_NET_L2_IEEE802154_RADIO_TSCH */
+
+static int setup_iface(struct net_if *iface)
+{
+	u16_t pan_id = PAN_ID;
+	u16_t channel = CHANNEL;
+	int ret;
+
+	ret = net_mgmt(NET_REQUEST_IEEE802154_SET_PAN_ID, iface,
+		       &pan_id, sizeof(pan_id));
+	if (ret) {
+		return ret;
+	}
+
+	ret = net_mgmt(NET_REQUEST_IEEE802154_SET_CHANNEL, iface,
+		       &channel, sizeof(channel));
+	if (ret) {
+		return ret;
+	}
+
+	ret = net_mgmt(NET_REQUEST_IEEE802154_SET_ACK, iface, NULL, 0);
+	if (ret) {
+		return ret;
+	}
+
+	return net_if_up(iface);
+}
+
+static void run_sink(u32_t node)
+{
+	struct sockaddr_in6 addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(ECHO_PORT),
+	};
+	struct sockaddr_in6 peer;
+	socklen_t peer_len;
+	ssize_t len;
+	int sock;
+
+	sock = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock < 0 ||
+	    bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		printk("Cannot create echo socket (%d)\n", -errno);
+		return;
+	}
+
+	printk("sink node %u echoing on port %d\n", node, ECHO_PORT);
+
+	while (1) {
+		peer_len = sizeof(peer);
+
+		len = recvfrom(sock, echo_buf, sizeof(echo_buf), 0,
+			       (struct sockaddr *)&peer, &peer_len);
+		if (len <= 0) {
+			continue;
+		}
+
+		(void)sendto(sock, echo_buf, len, 0,
+			     (struct sockaddr *)&peer, peer_len);
+	}
+}
+
+/* Sends a packet to the sink and waits for its echo */
+static int echo(int sock, struct sockaddr_in6 *sink, u32_t seq, u32_t *rtt)
+{
+	struct pollfd pfd = {
+		.fd = sock,
+		.events = POLLIN,
+	};
+	u32_t start = k_uptime_get_32();
+	s32_t left;
+	ssize_t len;
+
+	memcpy(payload, &seq, sizeof(seq));
+
+	if (sendto(sock, payload, sizeof(payload), 0,
+		   (struct sockaddr *)sink, sizeof(*sink)) < 0) {
+		k_sleep(ECHO_TIMEOUT);
+		return -errno;
+	}
+
+	while (1) {
+		left = ECHO_TIMEOUT - (s32_t)(k_uptime_get_32() - start);
+		if (left <= 0 || poll(&pfd, 1, left) <= 0) {
+			return -ETIMEDOUT;
+		}
+
+		len = recv(sock, echo_buf, sizeof(echo_buf), 0);
+
+		/* Late echoes of earlier packets are dropped */
+		if (len == sizeof(payload) &&
+		    !memcmp(echo_buf, &seq, sizeof(seq))) {
+			*rtt = k_uptime_get_32() - start;
+			return 0;
+		}
+	}
+}
+
+static void run_node(u32_t node)
+{
+	struct sockaddr_in6 sink = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(ECHO_PORT),
+	};
+	u32_t seq = 0U, rtt, total_rtt = 0U, start, elapsed;
+	int sock, received = 0, i;
+
+	net_ipv6_addr_create(&sink.sin6_addr, 0xfe80, 0, 0, 0,
+			     0x0200, 0x5eef, 0x1000, SINK_NODE);
+
+	sock = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock < 0) {
+		printk("Cannot create socket (%d)\n", -errno);
+		return;
+	}
+
+	/* Wait for the sink to be reachable, which with TSCH also takes
+	 * getting synchronized to the network.
+	 */
+	for (i = 0; i < JOIN_ATTEMPTS; i++) {
+		if (!echo(sock, &sink, seq++, &rtt)) {
+			break;
+		}
+	}
+
+	if (i == JOIN_ATTEMPTS) {
+		printk("node %u cannot reach the sink\n", node);
+		return;
+	}
+
+	start = k_uptime_get_32();
+
+	for (i = 0; i < N_PACKETS; i++) {
+		if (!echo(sock, &sink, seq++, &rtt)) {
+			total_rtt += rtt;
+			received++;
+		}
+	}
+
+	elapsed = MAX(k_uptime_get_32() - start, 1U);
+
+	printk("node %u sent %d received %d rtt %u ms goodput %u bps\n",
+	       node, N_PACKETS, received,
+	       received ? total_rtt / received : 0U,
+	       (u32_t)((u64_t)received * PAYLOAD_LEN * 8U * MSEC_PER_SEC /
+		       elapsed));
+	printk("fin\n");
+}
+
+void main(void)
+{
+	struct net_if *iface = net_if_get_ieee802154();
+	u32_t node;
+	int ret;
+
+	if (!iface) {
+		printk("No IEEE 802.15.4 interface\n");
+		return;
+	}
+
+	ret = setup_iface(iface);
+	if (ret) {
+		printk("Cannot set up interface (%d)\n", ret);
+		return;
+	}
+
+	node = node_id(iface);
+
+	ret = tsch_setup(iface, node);
+	if (ret) {
+		printk("Cannot set up TSCH schedule (%d)\n", ret);
+		return;
+	}
+
+	if (node == SINK_NODE) {
+		run_sink(node);
+	} else {
+		run_node(node);
+	}
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+#include <net/ethernet.h>
+
+#include "arp.h"
+#include "ipv6.h"
+
+/* This is a transmit path benchmark for the neighbor caches. The ARP
+ * cache and the IPv6 neighbor cache of a fake Ethernet interface are
+ * filled with a growing number of neighbors, then packets are addressed
+ * to all of them in turn and the average link layer address resolution
+ * time per packet is reported.
+ */
+
+#define N_ROUNDS 64
+
+/* Numbers of destinations, limited by the sizes of the caches */
+static const int dests[] = { 8, 32, CONFIG_NET_ARP_TABLE_SIZE };
+
+BUILD_ASSERT(CONFIG_NET_ARP_TABLE_SIZE <= CONFIG_NET_IPV6_MAX_NEIGHBORS);
+
+static struct in_addr my_addr4 = { { { 10, 0, 0, 1 } } };
+static struct in_addr netmask = { { { 255, 255, 0, 0 } } };
+
+static struct in_addr dst_addr4[CONFIG_NET_ARP_TABLE_SIZE];
+static struct in6_addr dst_addr6[CONFIG_NET_ARP_TABLE_SIZE];
+
+static u8_t mac_addr[sizeof(struct net_eth_addr)] = {
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	0x00, 0x00, 0x5E, 0x00, 0x53, 0x01
+};
+
+static struct net_if *iface;
+
+static void bench_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, mac_addr, sizeof(mac_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int bench_send(struct device *dev, struct net_pkt *pkt)
+{
+	/* The ARP replies are just dropped */
+	return 0;
+}
+
+static int bench_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static const struct ethernet_api bench_if_api = {
+	.iface_api.init = bench_iface_init,
+	.send = bench_send,
+};
+
+NET_DEVICE_INIT(net_neighbors_bench, "net_neighbors_bench",
+		bench_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&bench_if_api, ETHERNET_L2, NET_L2_GET_CTX_TYPE(ETHERNET_L2),
+		NET_ETH_MTU);
+
+static void nbr_hwaddr(int idx, struct net_eth_addr *hwaddr)
+{
+	hwaddr->addr[0] = 0x02;
+	hwaddr->addr[1] = 0x00;
+	hwaddr->addr[2] = 0x5E;
+	hwaddr->addr[3] = 0x10;
+	hwaddr->addr[4] = idx >> 8;
+	hwaddr->addr[5] = idx;
+}
+
+/* Make the neighbor known to the ARP cache by feeding an ARP request
+ * from it to our address.
+ */
+static int add_arp_nbr(int idx)
+{
+	struct net_eth_hdr *eth;
+	struct net_arp_hdr *hdr;
+	struct net_pkt *pkt;
+
+	dst_addr4[idx] = my_addr4;
+	dst_addr4[idx].s4_addr[2] = (idx + 2) >> 8;
+	dst_addr4[idx].s4_addr[3] = idx + 2;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, sizeof(struct net_eth_hdr) +
+					   sizeof(struct net_arp_hdr),
+					   AF_UNSPEC, 0, K_FOREVER);
+	if (!pkt) {
+		return -ENOMEM;
+	}
+
+	eth = (struct net_eth_hdr *)net_buf_add(pkt->buffer, sizeof(*eth));
+	(void)memset(&eth->dst, 0xff, sizeof(struct net_eth_addr));
+	nbr_hwaddr(idx, &eth->src);
+	eth->type = htons(NET_ETH_PTYPE_ARP);
+
+	net_buf_pull(pkt->buffer, sizeof(*eth));
+
+	hdr = (struct net_arp_hdr *)net_buf_add(pkt->buffer, sizeof(*hdr));
+	hdr->hwtype = htons(NET_ARP_HTYPE_ETH);
+	hdr->protocol = htons(NET_ETH_PTYPE_IP);
+	hdr->hwlen = sizeof(struct net_eth_addr);
+	hdr->protolen = sizeof(struct in_addr);
+	hdr->opcode = htons(NET_ARP_REQUEST);
+	nbr_hwaddr(idx, &hdr->src_hwaddr);
+	net_ipaddr_copy(&hdr->src_ipaddr, &dst_addr4[idx]);
+	(void)memset(&hdr->dst_hwaddr, 0, sizeof(struct net_eth_addr));
+	net_ipaddr_copy(&hdr->dst_ipaddr, &my_addr4);
+
+	if (net_arp_input(pkt, eth) != NET_OK) {
+		net_pkt_unref(pkt);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int add_ipv6_nbr(int idx)
+{
+	struct net_eth_addr hwaddr;
+	struct net_linkaddr lladdr = {
+		.addr = hwaddr.addr,
+		.len = sizeof(hwaddr),
+		.type = NET_LINK_ETHERNET,
+	};
+
+	net_ipv6_addr_create(&dst_addr6[idx], 0xfe80, 0, 0, 0, 0x0200, 0x5eff,
+			     0xfe10, idx);
+	nbr_hwaddr(idx, &hwaddr);
+
+	if (!net_ipv6_nbr_add(iface, &dst_addr6[idx], &lladdr, false,
+			      NET_IPV6_NBR_STATE_REACHABLE)) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static u32_t time_arp(struct net_pkt *pkt, int count)
+{
+	u32_t start, cycles;
+	int round, i;
+
+	start = k_cycle_get_32();
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		for (i = 0; i < count; i++) {
+			if (net_arp_prepare(pkt, &dst_addr4[i], NULL) != pkt) {
+				printk("ARP cache miss for neighbor %d\n", i);
+				return 0;
+			}
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return (u32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) /
+		       (N_ROUNDS * count));
+}
+
+static u32_t time_ipv6(int count)
+{
+	u32_t start, cycles;
+	int round, i;
+
+	start = k_cycle_get_32();
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		for (i = 0; i < count; i++) {
+			if (!net_ipv6_nbr_lookup(iface, &dst_addr6[i])) {
+				printk("IPv6 neighbor cache miss for "
+				       "neighbor %d\n", i);
+				return 0;
+			}
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return (u32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) /
+		       (N_ROUNDS * count));
+}
+
+void main(void)
+{
+	struct net_pkt *pkt;
+	int added = 0;
+	int i;
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(ETHERNET));
+	if (!iface) {
+		printk("No Ethernet interface\n");
+		return;
+	}
+
+	if (!net_if_ipv4_addr_add(iface, &my_addr4, NET_ADDR_MANUAL, 0)) {
+		printk("Cannot add IPv4 address\n");
+		return;
+	}
+
+	net_if_ipv4_set_netmask(iface, &netmask);
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct net_ipv4_hdr),
+					AF_INET, 0, K_FOREVER);
+	if (!pkt) {
+		printk("Cannot allocate packet\n");
+		return;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(dests); i++) {
+		for (; added < dests[i]; added++) {
+			if (add_arp_nbr(added) < 0 ||
+			    add_ipv6_nbr(added) < 0) {
+				printk("Cannot add neighbor %d\n", added);
+				goto out;
+			}
+
+			/* Let the ARP reply be sent */
+			k_yield();
+		}
+
+		printk("dests %3d arp %6u ns/pkt nd %6u ns/pkt\n", dests[i],
+		       time_arp(pkt, dests[i]), time_ipv6(dests[i]));
+	}
+
+out:
+	net_pkt_unref(pkt);
+
+	printk("fin\n");
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/socket.h>
+
+/* This is a packet rate benchmark for the burst handling of the Tx and
+ * Rx threads. Each round sends a burst of UDP packets over the loopback
+ * interface from a cooperative thread, so that all of them are queued
+ * before the Tx thread runs, and then receives them on another socket.
+ * At the end the received packet rate is reported.
+ *
+ * Run it with CONFIG_NET_TX_BURST_SIZE=1 and CONFIG_NET_RX_BURST_SIZE=1
+ * to get the baseline.
+ */
+
+#define N_ROUNDS 400
+#define N_BURST 16
+
+#define TX_PORT 5000
+#define RX_PORT 6000
+
+#define PAYLOAD_LEN 64
+
+/* Time to wait for the last packets of a round, in milliseconds */
+#define DRAIN_TIMEOUT 100
+
+static int tx_sock;
+static int rx_sock;
+static struct sockaddr_in rx_addr;
+
+static u8_t payload[PAYLOAD_LEN];
+static u8_t buf[PAYLOAD_LEN];
+
+static int bound_socket(u16_t port, struct sockaddr_in *addr)
+{
+	int sock;
+
+	sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock < 0) {
+		printk("socket() failed (%d)\n", errno);
+		return -1;
+	}
+
+	addr->sin_family = AF_INET;
+	addr->sin_port = htons(port);
+	inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR, &addr->sin_addr);
+
+	if (bind(sock, (struct sockaddr *)addr, sizeof(*addr)) < 0) {
+		printk("bind() failed (%d)\n", errno);
+		close(sock);
+		return -1;
+	}
+
+	return sock;
+}
+
+static int send_burst(void)
+{
+	int prio = k_thread_priority_get(k_current_get());
+	int sent = 0;
+	int i;
+
+	/* Do not let the Tx thread preempt us until the burst is queued */
+	k_thread_priority_set(k_current_get(),
+			      K_PRIO_COOP(CONFIG_NUM_COOP_PRIORITIES - 1));
+
+	for (i = 0; i < N_BURST; i++) {
+		if (sendto(tx_sock, payload, sizeof(payload), 0,
+			   (struct sockaddr *)&rx_addr,
+			   sizeof(rx_addr)) > 0) {
+			sent++;
+		}
+	}
+
+	k_thread_priority_set(k_current_get(), prio);
+
+	return sent;
+}
+
+static int drain(int expected)
+{
+	struct pollfd pfd = {
+		.fd = rx_sock,
+		.events = POLLIN,
+	};
+	int received = 0;
+
+	while (received < expected) {
+		if (poll(&pfd, 1, DRAIN_TIMEOUT) <= 0) {
+			break;
+		}
+
+		while (recv(rx_sock, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+			received++;
+		}
+	}
+
+	return received;
+}
+
+void main(void)
+{
+	struct sockaddr_in tx_addr;
+	int sent = 0, received = 0;
+	u32_t start, elapsed;
+	int round, burst, i;
+
+	for (i = 0; i < sizeof(payload); i++) {
+		payload[i] = i;
+	}
+
+	rx_sock = bound_socket(RX_PORT, &rx_addr);
+	tx_sock = bound_socket(TX_PORT, &tx_addr);
+	if (rx_sock < 0 || tx_sock < 0) {
+		return;
+	}
+
+	start = k_uptime_get_32();
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		burst = send_burst();
+
+		sent += burst;
+		received += drain(burst);
+	}
+
+	elapsed = k_uptime_get_32() - start;
+	if (elapsed == 0U) {
+		elapsed = 1U;
+	}
+
+	printk("tx burst %d rx burst %d pkts %d lost %d pps %u\n",
+	       NET_TX_BURST_SIZE, NET_RX_BURST_SIZE, received,
+	       sent - received,
+	       (u32_t)((u64_t)received * MSEC_PER_SEC / elapsed));
+
+	printk("fin\n");
+}
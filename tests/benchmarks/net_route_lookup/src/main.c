@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/ethernet.h>
+
+#include "ipv6.h"
+#include "route.h"
+
+/* This is a forwarding path benchmark for the routing tables. The IPv6
+ * and IPv4 routing tables of a fake Ethernet interface are filled with a
+ * growing number of routes, then destinations covered by all of them are
+ * looked up in turn and the average lookup time is reported, first for
+ * lookups missing the cache of recent destinations and then for lookups
+ * hitting it.
+ */
+
+#define N_ROUNDS 16
+#define N_GATEWAYS 8
+
+/* Numbers of routes, limited by the sizes of the tables */
+static const int routes[] = { 10, 100, CONFIG_NET_MAX_ROUTES };
+
+BUILD_ASSERT(CONFIG_NET_MAX_ROUTES <= CONFIG_NET_MAX_NEXTHOPS);
+BUILD_ASSERT(CONFIG_NET_MAX_ROUTES <= CONFIG_NET_MAX_IPV4_ROUTES);
+BUILD_ASSERT(N_GATEWAYS <= CONFIG_NET_IPV6_MAX_NEIGHBORS);
+
+static struct in6_addr gw_addr6[N_GATEWAYS];
+static struct in_addr gw_addr4 = { { { 192, 0, 2, 254 } } };
+
+static struct in6_addr dst_addr6[CONFIG_NET_MAX_ROUTES];
+static struct in_addr dst_addr4[CONFIG_NET_MAX_ROUTES];
+
+static u8_t mac_addr[sizeof(struct net_eth_addr)] = {
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	0x00, 0x00, 0x5E, 0x00, 0x53, 0x01
+};
+
+static struct net_if *iface;
+
+static void bench_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, mac_addr, sizeof(mac_addr),
+			     NET_LINK_ETHERNET);
+}
+
+static int bench_send(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static int bench_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static const struct ethernet_api bench_if_api = {
+	.iface_api.init = bench_iface_init,
+	.send = bench_send,
+};
+
+NET_DEVICE_INIT(net_route_lookup_bench, "net_route_lookup_bench",
+		bench_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&bench_if_api, ETHERNET_L2, NET_L2_GET_CTX_TYPE(ETHERNET_L2),
+		NET_ETH_MTU);
+
+static int add_gateways(void)
+{
+	struct net_eth_addr hwaddr = {
+		{ 0x02, 0x00, 0x5E, 0x20, 0x00, 0x00 }
+	};
+	struct net_linkaddr lladdr = {
+		.addr = hwaddr.addr,
+		.len = sizeof(hwaddr),
+		.type = NET_LINK_ETHERNET,
+	};
+	int i;
+
+	for (i = 0; i < N_GATEWAYS; i++) {
+		net_ipv6_addr_create(&gw_addr6[i], 0xfe80, 0, 0, 0, 0x0200,
+				     0x5eff, 0xfe20, i);
+		hwaddr.addr[5] = i;
+
+		if (!net_ipv6_nbr_add(iface, &gw_addr6[i], &lladdr, false,
+				      NET_IPV6_NBR_STATE_REACHABLE)) {
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+/* Route idx covers 2001:db8:idx::/48 to /64 and 10.x.y.0/24 to /31, with
+ * idx written in x.y, and the destination looked up is an address within
+ * the prefix.
+ */
+static int add_route(int idx)
+{
+	struct in6_addr prefix6;
+	struct in_addr prefix4 = { { { 10, idx >> 8, idx, 0 } } };
+
+	net_ipv6_addr_create(&prefix6, 0x2001, 0x0db8, idx, 0, 0, 0, 0, 0);
+	net_ipv6_addr_create(&dst_addr6[idx], 0x2001, 0x0db8, idx, 0, 0xbe,
+			     0xef, idx, 1);
+
+	if (!net_route_add(iface, &prefix6, 48 + (idx % 17),
+			   &gw_addr6[idx % N_GATEWAYS])) {
+		return -ENOMEM;
+	}
+
+	net_ipaddr_copy(&dst_addr4[idx], &prefix4);
+	dst_addr4[idx].s4_addr[3] = 1U;
+
+	if (!net_route_ipv4_add(iface, &prefix4, 24 + (idx % 8),
+				&gw_addr4)) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static u32_t time_ipv6(int count, bool same)
+{
+	struct net_route_entry *route;
+	struct in6_addr *nexthop;
+	u32_t start, cycles;
+	int round, i;
+
+	start = k_cycle_get_32();
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		for (i = 0; i < count; i++) {
+			if (!net_route_get_info(iface,
+						&dst_addr6[same ? 0 : i],
+						&route, &nexthop) || !route) {
+				printk("No IPv6 route to destination %d\n", i);
+				return 0;
+			}
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return (u32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) /
+		       (N_ROUNDS * count));
+}
+
+static u32_t time_ipv4(int count, bool same)
+{
+	struct in_addr nexthop;
+	u32_t start, cycles;
+	int round, i;
+
+	start = k_cycle_get_32();
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		for (i = 0; i < count; i++) {
+			if (!net_route_ipv4_get_nexthop(
+				    iface, &dst_addr4[same ? 0 : i],
+				    &nexthop)) {
+				printk("No IPv4 route to destination %d\n", i);
+				return 0;
+			}
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return (u32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) /
+		       (N_ROUNDS * count));
+}
+
+void main(void)
+{
+	int added = 0;
+	int i;
+
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(ETHERNET));
+	if (!iface) {
+		printk("No Ethernet interface\n");
+		return;
+	}
+
+	if (add_gateways() < 0) {
+		printk("Cannot add gateways\n");
+		return;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(routes); i++) {
+		for (; added < routes[i]; added++) {
+			if (add_route(added) < 0) {
+				printk("Cannot add route %d\n", added);
+				goto out;
+			}
+		}
+
+		printk("routes %4d ipv6 miss %6u hit %6u ns "
+		       "ipv4 miss %6u hit %6u ns\n", routes[i],
+		       time_ipv6(routes[i], false), time_ipv6(routes[i], true),
+		       time_ipv4(routes[i], false), time_ipv4(routes[i], true));
+	}
+
+out:
+	printk("fin\n");
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <misc/printk.h>
+#include <net/socket.h>
+#include <net/net_mgmt.h>
+#include <net/net_stats.h>
+
+/* This is a receive path benchmark for the Rx flow queues. A number of
+ * UDP flows, each with its own pair of ports, is sent over the loopback
+ * interface. The flows are hashed to CONFIG_NET_RX_FLOW_QUEUES Rx threads
+ * which, on SMP targets, process them in parallel. Each round sends a
+ * burst of packets on every flow and then drains all the receiving
+ * sockets, and at the end the received packet rate and the per-queue
+ * statistics are reported.
+ *
+ * Run it with CONFIG_NET_RX_FLOW_QUEUES=1 to get the single thread
+ * baseline.
+ */
+
+#define N_FLOWS 8
+#define N_ROUNDS 200
+#define N_BURST 4
+
+#define TX_PORT_BASE 5000
+#define RX_PORT_BASE 6000
+
+#define PAYLOAD_LEN 64
+
+/* Time to wait for the last packets of a round, in milliseconds */
+#define DRAIN_TIMEOUT 100
+
+static int tx_sock[N_FLOWS];
+static int rx_sock[N_FLOWS];
+static struct sockaddr_in rx_addr[N_FLOWS];
+static struct pollfd pfds[N_FLOWS];
+
+static u8_t payload[PAYLOAD_LEN];
+static u8_t buf[PAYLOAD_LEN];
+
+static int bound_socket(u16_t port, struct sockaddr_in *addr)
+{
+	int sock;
+
+	sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock < 0) {
+		printk("socket() failed (%d)\n", errno);
+		return -1;
+	}
+
+	addr->sin_family = AF_INET;
+	addr->sin_port = htons(port);
+	inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR, &addr->sin_addr);
+
+	if (bind(sock, (struct sockaddr *)addr, sizeof(*addr)) < 0) {
+		printk("bind() failed (%d)\n", errno);
+		close(sock);
+		return -1;
+	}
+
+	return sock;
+}
+
+static int setup_flows(void)
+{
+	struct sockaddr_in tx_addr;
+	int i;
+
+	for (i = 0; i < N_FLOWS; i++) {
+		rx_sock[i] = bound_socket(RX_PORT_BASE + i, &rx_addr[i]);
+		tx_sock[i] = bound_socket(TX_PORT_BASE + i, &tx_addr);
+
+		if (rx_sock[i] < 0 || tx_sock[i] < 0) {
+			return -1;
+		}
+
+		pfds[i].fd = rx_sock[i];
+		pfds[i].events = POLLIN;
+	}
+
+	return 0;
+}
+
+static int drain_flows(int expected)
+{
+	int received = 0;
+	int i, ret;
+
+	while (received < expected) {
+		ret = poll(pfds, N_FLOWS, DRAIN_TIMEOUT);
+		if (ret <= 0) {
+			break;
+		}
+
+		for (i = 0; i < N_FLOWS; i++) {
+			if (!(pfds[i].revents & POLLIN)) {
+				continue;
+			}
+
+			while (recv(rx_sock[i], buf, sizeof(buf),
+				    MSG_DONTWAIT) > 0) {
+				received++;
+			}
+		}
+	}
+
+	return received;
+}
+
+static void print_queue_stats(void)
+{
+#if NET_RX_FLOW_QUEUE_COUNT > 1
+	static struct net_stats stats;
+	int i;
+
+	if (net_mgmt(NET_REQUEST_STATS_GET_ALL, NULL, &stats, sizeof(stats))) {
+		return;
+	}
+
+	for (i = 0; i < NET_RX_FLOW_QUEUE_COUNT; i++) {
+		printk("queue %d pkts %u bytes %u\n", i,
+		       stats.rx_queue[i].pkts, stats.rx_queue[i].bytes);
+	}
+#endif
+}
+
+void main(void)
+{
+	int sent = 0, received = 0;
+	int round, flow, i;
+	u32_t start, elapsed;
+
+	for (i = 0; i < sizeof(payload); i++) {
+		payload[i] = i;
+	}
+
+	if (setup_flows() < 0) {
+		return;
+	}
+
+	start = k_uptime_get_32();
+
+	for (round = 0; round < N_ROUNDS; round++) {
+		int burst = 0;
+
+		for (i = 0; i < N_BURST; i++) {
+			for (flow = 0; flow < N_FLOWS; flow++) {
+				if (sendto(tx_sock[flow], payload,
+					   sizeof(payload), 0,
+					   (struct sockaddr *)&rx_addr[flow],
+					   sizeof(rx_addr[flow])) > 0) {
+					burst++;
+				}
+			}
+		}
+
+		sent += burst;
+		received += drain_flows(burst);
+	}
+
+	elapsed = k_uptime_get_32() - start;
+	if (elapsed == 0U) {
+		elapsed = 1U;
+	}
+
+	printk("flows %d queues %d pkts %d lost %d pps %u\n",
+	       N_FLOWS, NET_RX_FLOW_QUEUE_COUNT, received, sent - received,
+	       (u32_t)((u64_t)received * MSEC_PER_SEC / elapsed));
+
+	print_queue_stats();
+
+	printk("fin\n");
+}
@@ -0,0 +1,611 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <ztest.h>
+#include <cbor.h>
+#include <json.h>
+#include <net/buf.h>
+
+/* Same structures and descriptors as the JSON library tests */
+
+struct test_nested {
+	int nested_int;
+	bool nested_bool;
+	const char *nested_string;
+};
+
+struct test_struct {
+	const char *some_string;
+	int some_int;
+	bool some_bool;
+	struct test_nested some_nested_struct;
+	int some_array[16];
+	size_t some_array_len;
+	bool another_bxxl;		 /* JSON field: "another_b!@l" */
+	bool if_;			 /* JSON: "if" */
+	int another_array[10];		 /* JSON: "another-array" */
+	size_t another_array_len;
+	struct test_nested xnother_nexx; /* JSON: "4nother_ne$+" */
+};
+
+struct elt {
+	const char *name;
+	int height;
+};
+
+struct obj_array {
+	struct elt elements[10];
+	size_t num_elements;
+};
+
+static const struct json_obj_descr nested_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct test_nested, nested_int, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct test_nested, nested_bool, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM(struct test_nested, nested_string,
+			    JSON_TOK_STRING),
+};
+
+static const struct json_obj_descr test_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct test_struct, some_string, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct test_struct, some_int, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM(struct test_struct, some_bool, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_OBJECT(struct test_struct, some_nested_struct,
+			      nested_descr),
+	JSON_OBJ_DESCR_ARRAY(struct test_struct, some_array,
+			     16, some_array_len, JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_PRIM_NAMED(struct test_struct, "another_b!@l",
+				  another_bxxl, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_PRIM_NAMED(struct test_struct, "if",
+				  if_, JSON_TOK_TRUE),
+	JSON_OBJ_DESCR_ARRAY_NAMED(struct test_struct, "another-array",
+				   another_array, 10, another_array_len,
+				   JSON_TOK_NUMBER),
+	JSON_OBJ_DESCR_OBJECT_NAMED(struct test_struct, "4nother_ne$+",
+				    xnother_nexx, nested_descr),
+};
+
+static const struct json_obj_descr elt_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct elt, name, JSON_TOK_STRING),
+	JSON_OBJ_DESCR_PRIM(struct elt, height, JSON_TOK_NUMBER),
+};
+
+static const struct json_obj_descr obj_array_descr[] = {
+	JSON_OBJ_DESCR_OBJ_ARRAY(struct obj_array, elements, 10, num_elements,
+				 elt_descr, ARRAY_SIZE(elt_descr)),
+};
+
+static const struct test_struct test_struct_fixture = {
+	.some_string = "zephyr 123",
+	.some_int = 42,
+	.some_bool = true,
+	.some_nested_struct = {
+		.nested_int = -1234,
+		.nested_bool = false,
+		.nested_string = "this should be escaped: \t"
+	},
+	.some_array[0] = 1,
+	.some_array[1] = 4,
+	.some_array[2] = 8,
+	.some_array[3] = 16,
+	.some_array[4] = 32,
+	.some_array_len = 5,
+	.another_bxxl = true,
+	.if_ = false,
+	.another_array[0] = 2,
+	.another_array[1] = 3,
+	.another_array[2] = 5,
+	.another_array[3] = 7,
+	.another_array_len = 4,
+	.xnother_nexx = {
+		.nested_int = 1234,
+		.nested_bool = true,
+		.nested_string = "no escape necessary",
+	},
+};
+
+static const struct obj_array obj_array_fixture = {
+	.elements = {
+		[0] = { .name = "Simón Bolívar",   .height = 168 },
+		[1] = { .name = "Muggsy Bogues",   .height = 160 },
+		[2] = { .name = "Pelé",            .height = 173 },
+		[3] = { .name = "Hakeem Olajuwon", .height = 213 },
+		[4] = { .name = "Alex Honnold",    .height = 180 },
+		[5] = { .name = "Hazel Findlay",   .height = 157 },
+		[6] = { .name = "Daila Ojeda",     .height = 158 },
+		[7] = { .name = "Albert Einstein", .height = 172 },
+		[8] = { .name = "Usain Bolt",      .height = 195 },
+		[9] = { .name = "Paavo Nurmi",     .height = 174 },
+	},
+	.num_elements = 10,
+};
+
+static u8_t encoded[512];
+static u8_t payload[512];
+
+static void test_cbor_encoding(void)
+{
+	const struct elt elt = { .name = "Pelé", .height = 173 };
+	const u8_t expected[] = {
+		0xa2,
+		0x64, 'n', 'a', 'm', 'e',
+		0x65, 'P', 'e', 'l', 0xc3, 0xa9,
+		0x66, 'h', 'e', 'i', 'g', 'h', 't',
+		0x18, 173,
+	};
+	ssize_t len;
+
+	len = cbor_obj_encode_buf(elt_descr, ARRAY_SIZE(elt_descr), &elt,
+				  encoded, sizeof(encoded));
+	zassert_equal(len, sizeof(expected), "Encoded length incorrect");
+	zassert_mem_equal(encoded, expected, sizeof(expected),
+			  "Encoded contents incorrect");
+
+	len = cbor_calc_encoded_len(elt_descr, ARRAY_SIZE(elt_descr), &elt);
+	zassert_equal(len, sizeof(expected), "Calculated length incorrect");
+
+	len = cbor_obj_encode_buf(elt_descr, ARRAY_SIZE(elt_descr), &elt,
+				  encoded, sizeof(expected) - 1);
+	zassert_equal(len, -ENOMEM, "Buffer overflow not detected");
+}
+
+static void test_cbor_decoding(void)
+{
+	struct test_struct ts;
+	ssize_t len;
+	int ret;
+
+	len = cbor_obj_encode_buf(test_descr, ARRAY_SIZE(test_descr),
+				  &test_struct_fixture, payload,
+				  sizeof(payload));
+	zassert_true(len > 0, "Encoding failed");
+
+	(void)memset(&ts, 0, sizeof(ts));
+
+	ret = cbor_obj_parse(payload, len, test_descr, ARRAY_SIZE(test_descr),
+			     &ts);
+	zassert_equal(ret, (1 << ARRAY_SIZE(test_descr)) - 1,
+		      "All fields decoded correctly");
+
+	zassert_true(!strcmp(ts.some_string, "zephyr 123"),
+		     "String decoded correctly");
+	zassert_true((u8_t *)ts.some_string >= payload &&
+		     (u8_t *)ts.some_string < payload + len,
+		     "String not decoded in place");
+	zassert_equal(ts.some_int, 42, "Positive integer decoded correctly");
+	zassert_equal(ts.some_bool, true, "Boolean decoded correctly");
+	zassert_equal(ts.some_nested_struct.nested_int, -1234,
+		      "Nested negative integer decoded correctly");
+	zassert_equal(ts.some_nested_struct.nested_bool, false,
+		      "Nested boolean value decoded correctly");
+	zassert_true(!strcmp(ts.some_nested_struct.nested_string,
+			     "this should be escaped: \t"),
+		     "Nested string decoded correctly");
+	zassert_equal(ts.some_array_len, 5,
+		      "Array has correct number of items");
+	zassert_true(!memcmp(ts.some_array, test_struct_fixture.some_array,
+			     5 * sizeof(int)),
+		     "Array decoded with expected values");
+	zassert_true(ts.another_bxxl,
+		     "Named boolean (special chars) decoded correctly");
+	zassert_false(ts.if_,
+		      "Named boolean (reserved word) decoded correctly");
+	zassert_equal(ts.another_array_len, 4,
+		      "Named array has correct number of items");
+	zassert_true(!memcmp(ts.another_array,
+			     test_struct_fixture.another_array,
+			     4 * sizeof(int)),
+		     "Decoded named array with expected values");
+	zassert_equal(ts.xnother_nexx.nested_int, 1234,
+		      "Named nested integer decoded correctly");
+	zassert_equal(ts.xnother_nexx.nested_bool, true,
+		      "Named nested boolean decoded correctly");
+	zassert_true(!strcmp(ts.xnother_nexx.nested_string,
+			     "no escape necessary"),
+		     "Named nested string decoded correctly");
+}
+
+static void test_cbor_obj_arr_decoding(void)
+{
+	struct obj_array oa;
+	ssize_t len;
+	size_t i;
+	int ret;
+
+	len = cbor_obj_encode_buf(obj_array_descr, ARRAY_SIZE(obj_array_descr),
+				  &obj_array_fixture, payload,
+				  sizeof(payload));
+	zassert_true(len > 0, "Encoding array of objects failed");
+
+	ret = cbor_obj_parse(payload, len, obj_array_descr,
+			     ARRAY_SIZE(obj_array_descr), &oa);
+	zassert_equal(ret, (1 << ARRAY_SIZE(obj_array_descr)) - 1,
+		      "Array of object fields decoded correctly");
+	zassert_equal(oa.num_elements, 10,
+		      "Number of object fields decoded correctly");
+
+	for (i = 0; i < oa.num_elements; i++) {
+		zassert_true(!strcmp(oa.elements[i].name,
+				     obj_array_fixture.elements[i].name),
+			     "Element %zu name decoded correctly", i);
+		zassert_equal(oa.elements[i].height,
+			      obj_array_fixture.elements[i].height,
+			      "Element %zu height decoded correctly", i);
+	}
+}
+
+static void test_cbor_unknown_keys(void)
+{
+	/* {"extra": [1, {"deep": h'0102'}], "name": "Al", "height": 180,
+	 *  "name": "Bo"}
+	 */
+	u8_t data[] = {
+		0xa4,
+		0x65, 'e', 'x', 't', 'r', 'a',
+		0x82, 0x01, 0xa1, 0x64, 'd', 'e', 'e', 'p', 0x42, 0x01, 0x02,
+		0x64, 'n', 'a', 'm', 'e', 0x62, 'A', 'l',
+		0x66, 'h', 'e', 'i', 'g', 'h', 't', 0x18, 180,
+		0x64, 'n', 'a', 'm', 'e', 0x62, 'B', 'o',
+	};
+	u8_t wrong_type[] = { 0xa1, 0x64, 'n', 'a', 'm', 'e', 0x01 };
+	u8_t truncated[] = { 0xa2, 0x64, 'n', 'a', 'm', 'e', 0x62, 'A' };
+	struct elt elt;
+	int ret;
+
+	ret = cbor_obj_parse(data, sizeof(data), elt_descr,
+			     ARRAY_SIZE(elt_descr), &elt);
+	zassert_equal(ret, 3, "Known fields not decoded");
+	zassert_true(!strcmp(elt.name, "Al"), "Duplicate key not ignored");
+	zassert_equal(elt.height, 180, "Height decoded incorrectly");
+
+	ret = cbor_obj_parse(wrong_type, sizeof(wrong_type), elt_descr,
+			     ARRAY_SIZE(elt_descr), &elt);
+	zassert_equal(ret, -EINVAL, "Decoding has to fail");
+
+	ret = cbor_obj_parse(truncated, sizeof(truncated), elt_descr,
+			     ARRAY_SIZE(elt_descr), &elt);
+	zassert_equal(ret, -EINVAL, "Decoding has to fail");
+}
+
+static void test_cbor_reader(void)
+{
+	const u8_t data[] = {
+		0x00, 0x17, 0x18, 0x18, 0x18, 0xff, 0x19, 0x01, 0x00,
+		0x19, 0xff, 0xff, 0x1a, 0x00, 0x01, 0x00, 0x00,
+		0x20, 0x37, 0x38, 0x18,
+		0x1a, 0x7f, 0xff, 0xff, 0xff, 0x3a, 0x7f, 0xff, 0xff, 0xff,
+		/* 2^32, out of range */
+		0x1b, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+		0xf5, 0x43, 0x01, 0x02, 0x03, 0x62, 'h', 'i',
+	};
+	const s32_t expected[] = {
+		0, 23, 24, 255, 256, 65535, 65536, -1, -24, -25,
+		INT32_MAX, INT32_MIN,
+	};
+	struct cbor_reader reader;
+	const u8_t *bytes;
+	const char *text;
+	size_t len, i;
+	s32_t value;
+	bool flag;
+	int ret;
+
+	cbor_reader_init(&reader, data, sizeof(data));
+
+	for (i = 0; i < ARRAY_SIZE(expected); i++) {
+		ret = cbor_read_int(&reader, &value);
+		zassert_equal(ret, 0, "Integer %zu not read", i);
+		zassert_equal(value, expected[i], "Integer %zu incorrect", i);
+	}
+
+	ret = cbor_read_int(&reader, &value);
+	zassert_equal(ret, -ERANGE, "Integer range not checked");
+
+	ret = cbor_read_bool(&reader, &flag);
+	zassert_equal(ret, -EINVAL, "Reader moved on after an error");
+
+	ret = cbor_skip(&reader);
+	zassert_equal(ret, 0, "Integer not skipped");
+
+	ret = cbor_read_bool(&reader, &flag);
+	zassert_equal(ret, 0, "Boolean not read");
+	zassert_true(flag, "Boolean incorrect");
+
+	ret = cbor_read_text(&reader, &text, &len);
+	zassert_equal(ret, -EINVAL, "Byte string read as text");
+
+	ret = cbor_read_bytes(&reader, &bytes, &len);
+	zassert_equal(ret, 0, "Byte string not read");
+	zassert_equal(len, 3, "Byte string length incorrect");
+	zassert_equal_ptr(bytes, &data[sizeof(data) - 6],
+			  "Byte string copied");
+
+	ret = cbor_read_text(&reader, &text, &len);
+	zassert_equal(ret, 0, "Text string not read");
+	zassert_equal(len, 2, "Text string length incorrect");
+	zassert_equal_ptr(text, &data[sizeof(data) - 2], "Text string copied");
+
+	ret = cbor_read_int(&reader, &value);
+	zassert_equal(ret, -EINVAL, "Read past the end");
+}
+
+static void test_cbor_skip(void)
+{
+	/* {"a": [1, {"b": h'0102'}, 1(1.5)], "c": "x"}, 7 */
+	const u8_t data[] = {
+		0xa2, 0x61, 'a', 0x83, 0x01, 0xa1, 0x61, 'b', 0x42, 0x01, 0x02,
+		0xc1, 0xf9, 0x3e, 0x00, 0x61, 'c', 0x61, 'x',
+		0x07,
+	};
+	const u8_t indefinite[] = { 0x9f, 0x01, 0xff };
+	const u8_t too_long[] = { 0x9a, 0xff, 0xff, 0xff, 0xff, 0x01 };
+	struct cbor_reader reader;
+	s32_t value;
+	size_t count;
+	int ret;
+
+	cbor_reader_init(&reader, data, sizeof(data));
+
+	ret = cbor_skip(&reader);
+	zassert_equal(ret, 0, "Map not skipped");
+
+	ret = cbor_read_int(&reader, &value);
+	zassert_equal(ret, 0, "Item after the map not read");
+	zassert_equal(value, 7, "Item after the map incorrect");
+
+	cbor_reader_init(&reader, data, sizeof(data) - 2);
+	ret = cbor_skip(&reader);
+	zassert_equal(ret, -EINVAL, "Truncated map skipped");
+
+	cbor_reader_init(&reader, indefinite, sizeof(indefinite));
+	ret = cbor_skip(&reader);
+	zassert_equal(ret, -ENOTSUP, "Indefinite length array skipped");
+
+	cbor_reader_init(&reader, too_long, sizeof(too_long));
+	ret = cbor_read_array(&reader, &count);
+	zassert_equal(ret, -EINVAL, "Truncated array read");
+	ret = cbor_skip(&reader);
+	zassert_equal(ret, -EINVAL, "Truncated array skipped");
+}
+
+struct item_buf {
+	u8_t data[32];
+	size_t used;
+};
+
+static int append_to_buf(const char *bytes, size_t len, void *data)
+{
+	struct item_buf *buf = data;
+
+	if (len > sizeof(buf->data) - buf->used) {
+		return -ENOMEM;
+	}
+
+	memcpy(buf->data + buf->used, bytes, len);
+	buf->used += len;
+
+	return 0;
+}
+
+static void test_cbor_items(void)
+{
+	/* [_ {-2: "a", 2: 5000000000}, 1.5, h'01', true] */
+	const u8_t expected[] = {
+		0x9f, 0xa2, 0x21, 0x61, 'a', 0x02,
+		0x1b, 0x00, 0x00, 0x00, 0x01, 0x2a, 0x05, 0xf2, 0x00,
+		0xfa, 0x3f, 0xc0, 0x00, 0x00, 0x41, 0x01, 0xf5, 0xff,
+	};
+	const u8_t one_and_half[] = { 0x3f, 0xc0, 0x00, 0x00 };
+	const u8_t byte = 0x01;
+	struct item_buf out = { .used = 0 };
+	struct cbor_reader reader;
+	const u8_t *bits, *bytes;
+	const char *text;
+	size_t count, len;
+	s64_t value;
+	s32_t key;
+	bool flag;
+	int ret;
+
+	ret = cbor_encode_array(CBOR_INDEFINITE_LEN, append_to_buf, &out);
+	ret |= cbor_encode_map(2, append_to_buf, &out);
+	ret |= cbor_encode_int(-2, append_to_buf, &out);
+	ret |= cbor_encode_text("a", 1, append_to_buf, &out);
+	ret |= cbor_encode_int(2, append_to_buf, &out);
+	ret |= cbor_encode_int(5000000000LL, append_to_buf, &out);
+	ret |= cbor_encode_float(one_and_half, sizeof(one_and_half),
+				 append_to_buf, &out);
+	ret |= cbor_encode_bytes(&byte, sizeof(byte), append_to_buf, &out);
+	ret |= cbor_encode_bool(true, append_to_buf, &out);
+	ret |= cbor_encode_break(append_to_buf, &out);
+	zassert_equal(ret, 0, "Encoding failed");
+	zassert_equal(out.used, sizeof(expected), "Encoded length incorrect");
+	zassert_true(!memcmp(out.data, expected, sizeof(expected)),
+		     "Encoded items incorrect");
+
+	ret = cbor_encode_float(one_and_half, 3, append_to_buf, &out);
+	zassert_equal(ret, -EINVAL, "Float of invalid length encoded");
+
+	cbor_reader_init(&reader, expected, sizeof(expected));
+
+	ret = cbor_read_array(&reader, &count);
+	zassert_equal(ret, 0, "Indefinite length array not read");
+	zassert_equal(count, CBOR_INDEFINITE_LEN, "Array length incorrect");
+
+	ret = cbor_read_break(&reader);
+	zassert_equal(ret, -EINVAL, "Map read as a break");
+
+	ret = cbor_read_map(&reader, &count);
+	zassert_equal(ret, 0, "Map not read");
+	zassert_equal(count, 2, "Map length incorrect");
+
+	ret = cbor_read_int(&reader, &key);
+	zassert_equal(ret, 0, "Key not read");
+	zassert_equal(key, -2, "Key incorrect");
+
+	ret = cbor_read_text(&reader, &text, &len);
+	zassert_equal(ret, 0, "Text string not read");
+	zassert_equal(len, 1, "Text string length incorrect");
+
+	ret = cbor_skip(&reader);
+	zassert_equal(ret, 0, "Key not skipped");
+
+	ret = cbor_read_int(&reader, &key);
+	zassert_equal(ret, -ERANGE, "Integer range not checked");
+
+	ret = cbor_read_int64(&reader, &value);
+	zassert_equal(ret, 0, "64-bit integer not read");
+	zassert_equal(value, 5000000000LL, "64-bit integer incorrect");
+
+	ret = cbor_read_int64(&reader, &value);
+	zassert_equal(ret, -EINVAL, "Float read as an integer");
+
+	ret = cbor_read_float(&reader, &bits, &len);
+	zassert_equal(ret, 0, "Float not read");
+	zassert_equal(len, sizeof(one_and_half), "Float length incorrect");
+	zassert_true(!memcmp(bits, one_and_half, len), "Float incorrect");
+
+	ret = cbor_read_bytes(&reader, &bytes, &len);
+	zassert_equal(ret, 0, "Byte string not read");
+
+	ret = cbor_read_float(&reader, &bits, &len);
+	zassert_equal(ret, -EINVAL, "Boolean read as a float");
+
+	ret = cbor_read_bool(&reader, &flag);
+	zassert_equal(ret, 0, "Boolean not read");
+
+	ret = cbor_read_break(&reader);
+	zassert_equal(ret, 0, "Break not read");
+	zassert_equal_ptr(reader.pos, reader.end, "Items left after break");
+}
+
+#define FRAG_SIZE 16
+
+NET_BUF_POOL_DEFINE(cbor_pool, 32, FRAG_SIZE, 0, NULL);
+
+static struct net_buf *cbor_frag_alloc(s32_t timeout, void *user_data)
+{
+	return net_buf_alloc(&cbor_pool, timeout);
+}
+
+static void test_cbor_net_buf(void)
+{
+	struct net_buf *buf;
+	ssize_t len;
+	int ret;
+
+	len = cbor_obj_encode_buf(obj_array_descr, ARRAY_SIZE(obj_array_descr),
+				  &obj_array_fixture, encoded,
+				  sizeof(encoded));
+	zassert_true(len > FRAG_SIZE, "Encoding array of objects failed");
+
+	buf = net_buf_alloc(&cbor_pool, K_NO_WAIT);
+	zassert_not_null(buf, "Out of buffers");
+
+	ret = cbor_obj_encode_net_buf(obj_array_descr,
+				      ARRAY_SIZE(obj_array_descr),
+				      &obj_array_fixture, buf, K_NO_WAIT,
+				      cbor_frag_alloc, NULL);
+	zassert_equal(ret, 0, "Encoding into net_buf failed");
+	zassert_not_null(buf->frags, "No fragment added");
+	zassert_equal(net_buf_frags_len(buf), len,
+		      "Encoded length in net_buf incorrect");
+	zassert_equal(net_buf_linearize(payload, sizeof(payload), buf, 0, len),
+		      len, "Linearizing failed");
+	zassert_mem_equal(payload, encoded, len,
+			  "Encoded contents in net_buf incorrect");
+
+	net_buf_unref(buf);
+}
+
+#define COMPARE_ROUNDS 100
+
+static char json_buf[sizeof(encoded)];
+static char json_payload[sizeof(encoded)];
+
+static u32_t ns_per_round(u32_t cycles)
+{
+	return (u32_t)(SYS_CLOCK_HW_CYCLES_TO_NS64(cycles) / COMPARE_ROUNDS);
+}
+
+static void compare_with_json(const char *name,
+			      const struct json_obj_descr *descr,
+			      size_t descr_len, const void *val, void *out)
+{
+	u32_t json_enc = 0U, json_dec = 0U, cbor_enc = 0U, cbor_dec = 0U;
+	ssize_t json_len, cbor_len;
+	u32_t start;
+	int i, ret;
+
+	json_len = json_calc_encoded_len(descr, descr_len, val);
+	cbor_len = cbor_calc_encoded_len(descr, descr_len, val);
+	zassert_true(json_len > 0 && cbor_len > 0, "Encoding failed");
+	zassert_true(cbor_len < json_len, "CBOR not more compact than JSON");
+
+	for (i = 0; i < COMPARE_ROUNDS; i++) {
+		start = k_cycle_get_32();
+		ret = json_obj_encode_buf(descr, descr_len, val, json_buf,
+					  sizeof(json_buf));
+		json_enc += k_cycle_get_32() - start;
+		zassert_equal(ret, 0, "JSON encoding failed");
+
+		start = k_cycle_get_32();
+		ret = cbor_obj_encode_buf(descr, descr_len, val, encoded,
+					  sizeof(encoded));
+		cbor_enc += k_cycle_get_32() - start;
+		zassert_equal(ret, cbor_len, "CBOR encoding failed");
+
+		/* Both parsers terminate the strings in place */
+		memcpy(json_payload, json_buf, json_len);
+		memcpy(payload, encoded, cbor_len);
+
+		start = k_cycle_get_32();
+		ret = json_obj_parse(json_payload, json_len, descr, descr_len,
+				     out);
+		json_dec += k_cycle_get_32() - start;
+		zassert_true(ret > 0, "JSON decoding failed");
+
+		start = k_cycle_get_32();
+		ret = cbor_obj_parse(payload, cbor_len, descr, descr_len, out);
+		cbor_dec += k_cycle_get_32() - start;
+		zassert_true(ret > 0, "CBOR decoding failed");
+	}
+
+	TC_PRINT("%s: JSON %zd bytes, encode %u ns, parse %u ns\n", name,
+		 json_len, ns_per_round(json_enc), ns_per_round(json_dec));
+	TC_PRINT("%s: CBOR %zd bytes, encode %u ns, parse %u ns\n", name,
+		 cbor_len, ns_per_round(cbor_enc), ns_per_round(cbor_dec));
+}
+
+static void test_cbor_json_comparison(void)
+{
+	static struct test_struct ts;
+	static struct obj_array oa;
+
+	compare_with_json("test_struct", test_descr, ARRAY_SIZE(test_descr),
+			  &test_struct_fixture, &ts);
+	compare_with_json("obj_array", obj_array_descr,
+			  ARRAY_SIZE(obj_array_descr), &obj_array_fixture,
+			  &oa);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lib_cbor_test,
+			 ztest_unit_test(test_cbor_encoding),
+			 ztest_unit_test(test_cbor_decoding),
+			 ztest_unit_test(test_cbor_obj_arr_decoding),
+			 ztest_unit_test(test_cbor_unknown_keys),
+			 ztest_unit_test(test_cbor_reader),
+			 ztest_unit_test(test_cbor_skip),
+			 ztest_unit_test(test_cbor_items),
+			 ztest_unit_test(test_cbor_net_buf),
+			 ztest_unit_test(test_cbor_json_comparison)
+			 );
+
+	ztest_run_test_suite(lib_cbor_test);
+}
@@ -494,6 +494,262 @@ static void test_json_escape_bounds_check(void)
 	zassert_equal(ret, -ENOMEM, "Bounds check OK");
 }
 
+#define STREAM_BUF_SIZE 32
+
+static char stream_out[256];
+static size_t stream_out_len;
+
+static int stream_append(const char *bytes, size_t len, void *data)
+{
+	if (len >= sizeof(stream_out) - stream_out_len) {
+		return -ENOMEM;
+	}
+
+	memcpy(stream_out + stream_out_len, bytes, len);
+	stream_out_len += len;
+	stream_out[stream_out_len] = '\0';
+
+	return 0;
+}
+
+static int stream_encode(const struct json_token *token, void *data)
+{
+	return json_encoder_token(data, token);
+}
+
+static int stream_parse(const char *doc, size_t len, size_t chunk_len,
+			json_token_cb_t token_cb, void *data)
+{
+	struct json_parser parser;
+	char buf[STREAM_BUF_SIZE];
+	size_t pos;
+	int ret;
+
+	json_parser_init(&parser, buf, sizeof(buf), token_cb, data);
+
+	for (pos = 0; pos < len; pos += chunk_len) {
+		ret = json_parser_feed(&parser, doc + pos,
+				       MIN(chunk_len, len - pos));
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return json_parser_finish(&parser);
+}
+
+static int stream_reencode(const char *doc, size_t chunk_len)
+{
+	struct json_encoder encoder;
+
+	stream_out_len = 0;
+	stream_out[0] = '\0';
+
+	json_encoder_init(&encoder, stream_append, NULL);
+
+	return stream_parse(doc, strlen(doc), chunk_len, stream_encode,
+			    &encoder);
+}
+
+static void test_json_stream_chunks(void)
+{
+	const char doc[] = " {\"name\" : \"Pel\\u00e9 \\\"O Rei\\\"\",\n"
+		"\t\"goals\": [1281, -1.5e3, 0],\n"
+		"\t\"retired\": true, \"coach\": null, \"injured\": false,\n"
+		"\t\"clubs\": [ {\"name\": \"Santos\"}, {}, [] ] }\n";
+	const char compact[] = "{\"name\":\"Pel\\u00e9 \\\"O Rei\\\"\","
+		"\"goals\":[1281,-1.5e3,0],"
+		"\"retired\":true,\"coach\":null,\"injured\":false,"
+		"\"clubs\":[{\"name\":\"Santos\"},{},[]]}";
+	size_t chunk_len;
+	int ret;
+
+	/* Every split of the document must give the same tokens, which the
+	 * encoder turns back into the compact form of the document.
+	 */
+	for (chunk_len = 1; chunk_len <= sizeof(doc); chunk_len++) {
+		ret = stream_reencode(doc, chunk_len);
+		zassert_equal(ret, 0, "Parsing in chunks of %zu failed (%d)",
+			      chunk_len, ret);
+		zassert_true(!strcmp(stream_out, compact),
+			     "Chunks of %zu not re-encoded correctly",
+			     chunk_len);
+	}
+
+	ret = stream_reencode(compact, sizeof(compact));
+	zassert_equal(ret, 0, "Parsing compact document failed");
+	zassert_true(!strcmp(stream_out, compact),
+		     "Compact document re-encoded byte for byte");
+
+	ret = stream_reencode(" -42 ", 1);
+	zassert_equal(ret, 0, "Top-level number not parsed");
+	zassert_true(!strcmp(stream_out, "-42"),
+		     "Top-level number re-encoded");
+
+	ret = stream_reencode("42", 1);
+	zassert_equal(ret, 0, "Number at the end of the document not parsed");
+	zassert_true(!strcmp(stream_out, "42"),
+		     "Number at the end of the document re-encoded");
+}
+
+static int stream_cancel(const struct json_token *token, void *data)
+{
+	return -ECANCELED;
+}
+
+static void test_json_stream_errors(void)
+{
+	static const char * const invalid[] = {
+		"", "{", "{\"a\"}", "{\"a\":}", "{\"a\" 1}", "{1:2}", "[1,]",
+		"{\"a\":1,}", "[}", "{]", "tru", "nul1", "-", "1.", "1e",
+		"\"abc", "\"\\q\"", "\"\\uABC@\"", "{} {}", "[1 2]",
+		"1-2", "1.2.3", "1e5e5", "-01", "[00]", "1.e5", "1e+", "--1",
+	};
+	const char deep[] = "[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[["
+			    "]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]";
+	const char long_value[] = "[\"this value does not fit in the "
+				  "token buffer\"]";
+	struct json_parser parser;
+	struct json_encoder encoder;
+	struct json_token token = { .type = JSON_TOK_OBJECT_END };
+	char buf[STREAM_BUF_SIZE];
+	size_t i;
+	int ret;
+
+	for (i = 0; i < ARRAY_SIZE(invalid); i++) {
+		ret = stream_reencode(invalid[i], 3);
+		zassert_equal(ret, -EINVAL, "Invalid document %s accepted",
+			      invalid[i]);
+	}
+
+	ret = stream_reencode(deep, 4);
+	zassert_equal(ret, -ENOSPC, "Nesting limit not enforced");
+
+	ret = stream_reencode(long_value, 4);
+	zassert_equal(ret, -ENOMEM, "Token buffer size not enforced");
+
+	json_parser_init(&parser, buf, sizeof(buf), stream_cancel, NULL);
+	ret = json_parser_feed(&parser, "[1]", 3);
+	zassert_equal(ret, -ECANCELED, "Callback error not returned");
+	ret = json_parser_feed(&parser, "[1]", 3);
+	zassert_equal(ret, -EINVAL, "Parser usable after an error");
+
+	json_encoder_init(&encoder, stream_append, NULL);
+	ret = json_encoder_token(&encoder, &token);
+	zassert_equal(ret, -EINVAL, "Encoder closed an unopened object");
+
+	token.type = JSON_TOK_OBJECT_START;
+	ret = json_encoder_token(&encoder, &token);
+	zassert_equal(ret, 0, "Encoder failed to open an object");
+
+	token.type = JSON_TOK_TRUE;
+	ret = json_encoder_token(&encoder, &token);
+	zassert_equal(ret, -EINVAL, "Encoder accepted a member without key");
+
+	token.type = JSON_TOK_LIST_END;
+	ret = json_encoder_token(&encoder, &token);
+	zassert_equal(ret, -EINVAL, "Encoder closed an object as an array");
+}
+
+#define BENCH_ELEMENTS 100
+#define BENCH_ROUNDS 20
+#define BENCH_CHUNK_LEN 64
+
+struct bench_array {
+	struct elt elements[BENCH_ELEMENTS];
+	size_t num_elements;
+};
+
+static const struct json_obj_descr bench_array_descr[] = {
+	JSON_OBJ_DESCR_OBJ_ARRAY(struct bench_array, elements, BENCH_ELEMENTS,
+				 num_elements, elt_descr,
+				 ARRAY_SIZE(elt_descr)),
+};
+
+static struct bench_array bench_array;
+static char bench_doc[BENCH_ELEMENTS * 48];
+static char bench_copy[sizeof(bench_doc)];
+
+static int stream_count(const struct json_token *token, void *data)
+{
+	u32_t *tokens = data;
+
+	(*tokens)++;
+
+	return 0;
+}
+
+static u32_t bench_kib_per_sec(size_t len, u32_t cycles)
+{
+	u64_t ns = SYS_CLOCK_HW_CYCLES_TO_NS64(cycles);
+
+	if (ns == 0U) {
+		ns = 1U;
+	}
+
+	return (u32_t)((u64_t)len * BENCH_ROUNDS * NSEC_PER_SEC / 1024U / ns);
+}
+
+static void test_json_stream_benchmark(void)
+{
+	static const char * const names[] = {
+		"Simón Bolívar", "Muggsy Bogues", "Pelé", "Hakeem Olajuwon",
+		"Alex Honnold", "Hazel Findlay", "Daila Ojeda",
+	};
+	u32_t parse_cycles = 0U, stream_cycles = 0U;
+	u32_t start, tokens;
+	size_t len, i;
+	int ret;
+
+	for (i = 0; i < BENCH_ELEMENTS; i++) {
+		bench_array.elements[i].name = names[i % ARRAY_SIZE(names)];
+		bench_array.elements[i].height = 150 + i;
+	}
+
+	bench_array.num_elements = BENCH_ELEMENTS;
+
+	ret = json_obj_encode_buf(bench_array_descr,
+				  ARRAY_SIZE(bench_array_descr), &bench_array,
+				  bench_doc, sizeof(bench_doc) - 1);
+	zassert_equal(ret, 0, "Encoding benchmark document failed");
+
+	len = strlen(bench_doc);
+
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		/* json_obj_parse() terminates the strings in place */
+		memcpy(bench_copy, bench_doc, len);
+
+		start = k_cycle_get_32();
+		ret = json_obj_parse(bench_copy, len, bench_array_descr,
+				     ARRAY_SIZE(bench_array_descr),
+				     &bench_array);
+		parse_cycles += k_cycle_get_32() - start;
+
+		zassert_equal(ret, 1, "Parsing benchmark document failed");
+		zassert_equal(bench_array.num_elements, BENCH_ELEMENTS,
+			      "Wrong number of elements parsed");
+
+		tokens = 0U;
+
+		start = k_cycle_get_32();
+		ret = stream_parse(bench_doc, len, BENCH_CHUNK_LEN,
+				   stream_count, &tokens);
+		stream_cycles += k_cycle_get_32() - start;
+
+		zassert_equal(ret, 0, "Streaming benchmark document failed");
+		zassert_equal(tokens, 4 * BENCH_ELEMENTS + 4,
+			      "Wrong number of tokens streamed");
+	}
+
+	TC_PRINT("%zu byte document, %u elements:\n", len, BENCH_ELEMENTS);
+	TC_PRINT("json_obj_parse: %u KiB/s, %zu bytes of input buffer\n",
+		 bench_kib_per_sec(len, parse_cycles), len);
+	TC_PRINT("json_parser_feed: %u KiB/s, %zu bytes of parser, token "
+		 "and chunk buffers\n", bench_kib_per_sec(len, stream_cycles),
+		 sizeof(struct json_parser) + STREAM_BUF_SIZE +
+		 BENCH_CHUNK_LEN);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(lib_json_test,
@@ -511,7 +767,10 @@ void test_main(void)
 			 ztest_unit_test(test_json_escape_one),
 			 ztest_unit_test(test_json_escape_empty),
 			 ztest_unit_test(test_json_escape_no_op),
-			 ztest_unit_test(test_json_escape_bounds_check)
+			 ztest_unit_test(test_json_escape_bounds_check),
+			 ztest_unit_test(test_json_stream_chunks),
+			 ztest_unit_test(test_json_stream_errors),
+			 ztest_unit_test(test_json_stream_benchmark)
 			 );
 
 	ztest_run_test_suite(lib_json_test);
@@ -939,9 +939,25 @@ void test_loop(void)
 	net_pkt_print();
 }
 
+/* Each packet is compressed and uncompressed twice in a row, so that
+ * the second time goes through the flow caches if they are enabled.
+ */
+void test_flow_cache(void)
+{
+	int count;
+
+	for (count = 0; count < ARRAY_SIZE(tests); count++) {
+		TC_START(tests[count].name);
+
+		test_6lo(tests[count].data);
+		test_6lo(tests[count].data);
+	}
+}
+
 /*test case main entry*/
 void test_main(void)
 {
-	ztest_test_suite(test_6lo, ztest_unit_test(test_loop));
+	ztest_test_suite(test_6lo, ztest_unit_test(test_loop),
+			 ztest_unit_test(test_flow_cache));
 	ztest_run_test_suite(test_6lo);
 }
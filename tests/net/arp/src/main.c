@@ -633,9 +633,133 @@ void test_arp(void)
 	}
 }
 
+static void lru_nbr(int idx, struct in_addr *addr,
+		    struct net_eth_addr *nbr_hwaddr)
+{
+	struct in_addr nbr_addr = { { { 192, 168, 0, 100 } } };
+
+	nbr_addr.s4_addr[3] += idx;
+	net_ipaddr_copy(addr, &nbr_addr);
+
+	memcpy(nbr_hwaddr, &hwaddr, sizeof(struct net_eth_addr));
+	nbr_hwaddr->addr[5] = idx;
+}
+
+/* Make a neighbor known to the ARP cache by feeding an ARP request from
+ * it to our address.
+ */
+static void lru_add_nbr(struct net_if *iface, int idx)
+{
+	struct net_eth_addr nbr_hwaddr;
+	struct net_eth_hdr *eth_hdr;
+	struct net_arp_hdr *arp_hdr;
+	struct in_addr addr;
+	struct net_pkt *pkt;
+
+	lru_nbr(idx, &addr, &nbr_hwaddr);
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct net_eth_hdr) +
+					sizeof(struct net_arp_hdr),
+					AF_UNSPEC, 0, K_SECONDS(1));
+	zassert_not_null(pkt, "out of mem request");
+
+	eth_hdr = (struct net_eth_hdr *)net_buf_add(pkt->buffer,
+						    sizeof(*eth_hdr));
+	memcpy(&eth_hdr->dst, net_if_get_link_addr(iface)->addr,
+	       sizeof(struct net_eth_addr));
+	memcpy(&eth_hdr->src, &nbr_hwaddr, sizeof(struct net_eth_addr));
+	eth_hdr->type = htons(NET_ETH_PTYPE_ARP);
+
+	net_buf_pull(pkt->buffer, sizeof(*eth_hdr));
+
+	arp_hdr = (struct net_arp_hdr *)net_buf_add(pkt->buffer,
+						    sizeof(*arp_hdr));
+	arp_hdr->hwtype = htons(NET_ARP_HTYPE_ETH);
+	arp_hdr->protocol = htons(NET_ETH_PTYPE_IP);
+	arp_hdr->hwlen = sizeof(struct net_eth_addr);
+	arp_hdr->protolen = sizeof(struct in_addr);
+	arp_hdr->opcode = htons(NET_ARP_REQUEST);
+	memcpy(&arp_hdr->src_hwaddr, &nbr_hwaddr, sizeof(struct net_eth_addr));
+	(void)memset(&arp_hdr->dst_hwaddr, 0, sizeof(struct net_eth_addr));
+	net_ipaddr_copy(&arp_hdr->src_ipaddr, &addr);
+	net_ipaddr_copy(&arp_hdr->dst_ipaddr, if_get_addr(iface));
+
+	zassert_equal(net_arp_input(pkt, eth_hdr), NET_OK,
+		      "ARP request not handled");
+
+	/* Let the ARP reply be sent */
+	k_yield();
+}
+
+static bool lru_nbr_cached(int idx)
+{
+	struct net_eth_addr nbr_hwaddr;
+	struct in_addr addr;
+
+	lru_nbr(idx, &addr, &nbr_hwaddr);
+
+	entry_found = false;
+	expected_hwaddr = &nbr_hwaddr;
+	net_arp_foreach(arp_cb, &addr);
+
+	return entry_found;
+}
+
+void test_arp_lru(void)
+{
+	struct net_eth_addr nbr_hwaddr;
+	struct net_if *iface;
+	struct in_addr addr;
+	struct net_pkt *pkt;
+	int i;
+
+	iface = net_if_get_default();
+	zassert_not_null(if_get_addr(iface), "No IPv4 address");
+
+	/* Replies to the neighbors are not checked */
+	req_test = true;
+
+	net_arp_clear_cache(NULL);
+
+	for (i = 0; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
+		lru_add_nbr(iface, i);
+	}
+
+	for (i = 0; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
+		zassert_true(lru_nbr_cached(i), "Neighbor %d not cached", i);
+	}
+
+	/* Sending to the first neighbor makes it the most recently used
+	 * one, so that the second one is replaced by the next neighbor.
+	 */
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(struct net_ipv4_hdr),
+					AF_INET, 0, K_SECONDS(1));
+	zassert_not_null(pkt, "out of mem");
+
+	lru_nbr(0, &addr, &nbr_hwaddr);
+	zassert_equal_ptr(net_arp_prepare(pkt, &addr, NULL), pkt,
+			  "First neighbor not resolved");
+
+	net_pkt_unref(pkt);
+
+	lru_add_nbr(iface, CONFIG_NET_ARP_TABLE_SIZE);
+
+	zassert_true(lru_nbr_cached(CONFIG_NET_ARP_TABLE_SIZE),
+		     "New neighbor not cached");
+	zassert_true(lru_nbr_cached(0), "Recently used neighbor replaced");
+	zassert_false(lru_nbr_cached(1), "Least recently used neighbor kept");
+
+	for (i = 2; i < CONFIG_NET_ARP_TABLE_SIZE; i++) {
+		zassert_true(lru_nbr_cached(i), "Neighbor %d replaced", i);
+	}
+
+	net_arp_clear_cache(NULL);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_arp_fn,
-		ztest_unit_test(test_arp));
+		ztest_unit_test(test_arp),
+		ztest_unit_test(test_arp_lru));
 	ztest_run_test_suite(test_arp_fn);
 }
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_ieee802154_tsch_test, LOG_LEVEL_DBG);
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#include <net/net_core.h>
+#include "net_private.h"
+
+#include <net/net_pkt.h>
+#include <net/net_mgmt.h>
+#include <net/ieee802154_mgmt.h>
+
+#include <ieee802154_frame.h>
+#include <ieee802154_radio_utils.h>
+#include <ieee802154_tsch.h>
+
+#define SLOT_DURATION CONFIG_NET_L2_IEEE802154_RADIO_TSCH_SLOT_DURATION
+#define SLOTFRAME_SIZE CONFIG_NET_L2_IEEE802154_RADIO_TSCH_SLOTFRAME_SIZE
+#define MAX_CELLS CONFIG_NET_L2_IEEE802154_RADIO_TSCH_MAX_CELLS
+
+/* ASN carried by eb_pkt */
+#define EB_ASN 1000
+
+/* Channels the cells hop on, as used by the TSCH MAC */
+static const u8_t hopping_sequence[] = { 15, 25, 26, 20 };
+
+/* Set by the fake driver on each transmission */
+s64_t tx_time;
+u16_t tx_channel;
+
+static struct net_if *iface;
+
+/* Uptime at which the EB was handed to the MAC */
+static s64_t sync_time;
+
+static u8_t peer_addr[IEEE802154_EXT_ADDR_LENGTH] = {
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08
+};
+
+static u8_t other_addr[IEEE802154_EXT_ADDR_LENGTH] = {
+	0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18
+};
+
+/* Enhanced Beacon of the time source, with the ASN in its payload */
+static u8_t eb_pkt[] = {
+	0x00, 0xd0, 0x01, 0xcd, 0xab, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26,
+	0x27, 0x28, 0xff, 0x40, 0x00, 0x00, 0x1a, 0xe8, 0x03, 0x00, 0x00,
+	0x00, 0x00
+};
+
+/* Same beacon, without the synchronization payload */
+static u8_t beacon_pkt[] = {
+	0x00, 0xd0, 0x02, 0xcd, 0xab, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26,
+	0x27, 0x28, 0xff, 0x40, 0x00, 0x00
+};
+
+/* Data frame without acknowledgment request */
+static u8_t data_pkt[] = {
+	0x41, 0xdc, 0x03, 0xcd, 0xab, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+	0x07, 0x08, 0xc2, 0xa3, 0x9e, 0x00, 0x00, 0x4b, 0x12, 0x00, 0x74,
+	0x73, 0x63, 0x68
+};
+
+static void set_cell(struct ieee802154_tsch_cell *cell, u8_t *addr,
+		     u16_t slot_offset, u16_t channel_offset, u8_t options)
+{
+	(void)memset(cell, 0, sizeof(*cell));
+
+	if (addr) {
+		memcpy(cell->addr, addr, IEEE802154_EXT_ADDR_LENGTH);
+	}
+
+	cell->slot_offset = slot_offset;
+	cell->channel_offset = channel_offset;
+	cell->options = options;
+}
+
+static int add_cell(u8_t *addr, u16_t slot_offset, u16_t channel_offset,
+		    u8_t options)
+{
+	struct ieee802154_tsch_cell cell;
+
+	set_cell(&cell, addr, slot_offset, channel_offset, options);
+
+	return net_mgmt(NET_REQUEST_IEEE802154_TSCH_ADD_CELL, iface,
+			&cell, sizeof(cell));
+}
+
+static int del_cell(u8_t *addr, u16_t slot_offset)
+{
+	struct ieee802154_tsch_cell cell;
+
+	set_cell(&cell, addr, slot_offset, 0, 0);
+
+	return net_mgmt(NET_REQUEST_IEEE802154_TSCH_DEL_CELL, iface,
+			&cell, sizeof(cell));
+}
+
+static int send_frame(u8_t *dst)
+{
+	struct net_pkt *pkt;
+	int ret;
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(data_pkt), AF_UNSPEC,
+					0, K_FOREVER);
+	zassert_not_null(pkt, "Could not allocate packet");
+
+	zassert_equal(net_pkt_write(pkt, data_pkt, sizeof(data_pkt)), 0,
+		      "Could not write packet");
+
+	net_pkt_lladdr_dst(pkt)->addr = dst;
+	net_pkt_lladdr_dst(pkt)->len = IEEE802154_EXT_ADDR_LENGTH;
+
+	ret = ieee802154_radio_send(iface, pkt, pkt->buffer);
+
+	net_pkt_unref(pkt);
+
+	return ret;
+}
+
+static u64_t tx_asn(void)
+{
+	return EB_ASN + (tx_time - sync_time) / SLOT_DURATION;
+}
+
+/* Returns the slot offset of the last frame sent, after checking that it
+ * was sent on the channel of the cell with the given channel offset.
+ */
+static u16_t check_tx_cell(u16_t channel_offset)
+{
+	u64_t asn = tx_asn();
+
+	zassert_equal(tx_channel,
+		      hopping_sequence[(asn + channel_offset) %
+				       ARRAY_SIZE(hopping_sequence)],
+		      "Frame sent on the wrong channel");
+
+	return asn % SLOTFRAME_SIZE;
+}
+
+static void test_init(void)
+{
+	struct device *dev;
+
+	dev = device_get_binding("fake_ieee802154");
+	zassert_not_null(dev, "Could not get fake device");
+
+	iface = net_if_lookup_by_dev(dev);
+	zassert_not_null(iface, "Could not get fake iface");
+}
+
+static void test_start(void)
+{
+	bool time_source = false;
+	int ret;
+
+	ret = add_cell(NULL, 1, 0, IEEE802154_TSCH_CELL_TX);
+	zassert_equal(ret, -ENETDOWN, "Cell added before TSCH started");
+
+	ret = net_mgmt(NET_REQUEST_IEEE802154_TSCH_START, iface,
+		       &time_source, sizeof(time_source));
+	zassert_equal(ret, 0, "Could not start TSCH");
+
+	ret = net_mgmt(NET_REQUEST_IEEE802154_TSCH_START, iface,
+		       &time_source, sizeof(time_source));
+	zassert_equal(ret, -EALREADY, "TSCH started twice");
+}
+
+static void test_add_del_cells(void)
+{
+	int ret, i;
+
+	ret = add_cell(peer_addr, SLOTFRAME_SIZE, 0, IEEE802154_TSCH_CELL_TX);
+	zassert_equal(ret, -EINVAL, "Cell added out of the slotframe");
+
+	ret = add_cell(peer_addr, 1, 0, 0);
+	zassert_equal(ret, -EINVAL, "Cell added without TX nor RX");
+
+	ret = add_cell(peer_addr, 1, 0, IEEE802154_TSCH_CELL_TX);
+	zassert_equal(ret, 0, "Could not add cell");
+
+	ret = add_cell(peer_addr, 1, 2, IEEE802154_TSCH_CELL_RX);
+	zassert_equal(ret, -EALREADY, "Same cell added twice");
+
+	/* The minimal cell and the one above are in the schedule */
+	for (i = 2; i < MAX_CELLS; i++) {
+		ret = add_cell(other_addr, i, 0, IEEE802154_TSCH_CELL_RX);
+		zassert_equal(ret, 0, "Could not add cell");
+	}
+
+	ret = add_cell(other_addr, 0, 0, IEEE802154_TSCH_CELL_RX);
+	zassert_equal(ret, -ENOMEM, "Cell added to a full schedule");
+
+	for (i = 2; i < MAX_CELLS; i++) {
+		ret = del_cell(other_addr, i);
+		zassert_equal(ret, 0, "Could not remove cell");
+	}
+
+	ret = del_cell(peer_addr, 1);
+	zassert_equal(ret, 0, "Could not remove cell");
+
+	ret = del_cell(peer_addr, 1);
+	zassert_equal(ret, -ENOENT, "Cell removed twice");
+}
+
+static void test_eb_sync(void)
+{
+	struct ieee802154_mpdu mpdu;
+
+	zassert_equal(send_frame(peer_addr), -ENETDOWN,
+		      "Frame sent while not synchronized");
+
+	zassert_true(ieee802154_validate_frame(beacon_pkt, sizeof(beacon_pkt),
+					       &mpdu), "Invalid beacon");
+	zassert_false(ieee802154_tsch_handle_eb(iface, &mpdu),
+		      "Beacon taken for an EB");
+
+	zassert_true(ieee802154_validate_frame(eb_pkt, sizeof(eb_pkt),
+					       &mpdu), "Invalid EB");
+
+	sync_time = k_uptime_get();
+
+	zassert_true(ieee802154_tsch_handle_eb(iface, &mpdu),
+		     "EB not recognized");
+
+	/* Only the minimal cell, in the first timeslot, can be used */
+	zassert_equal(send_frame(peer_addr), 0, "Could not send frame");
+	zassert_equal(check_tx_cell(0), 0, "Frame sent in the wrong slot");
+}
+
+static void test_next_tx_cell(void)
+{
+	u16_t slot;
+	int ret, i;
+
+	/* Dedicated cell to the peer, and an RX cell which is not used */
+	ret = add_cell(peer_addr, 3, 1, IEEE802154_TSCH_CELL_TX);
+	zassert_equal(ret, 0, "Could not add cell");
+
+	ret = add_cell(peer_addr, 5, 0, IEEE802154_TSCH_CELL_RX);
+	zassert_equal(ret, 0, "Could not add cell");
+
+	for (i = 0; i < 2; i++) {
+		zassert_equal(send_frame(peer_addr), 0, "Could not send frame");
+		zassert_equal(check_tx_cell(1), 3, "Dedicated cell not used");
+
+		zassert_equal(send_frame(other_addr), 0,
+			      "Could not send frame");
+		zassert_equal(check_tx_cell(0), 0, "Minimal cell not used");
+	}
+
+	/* In the same timeslot, the dedicated cell wins over a shared one */
+	ret = add_cell(NULL, 3, 2, IEEE802154_TSCH_CELL_TX |
+		       IEEE802154_TSCH_CELL_SHARED);
+	zassert_equal(ret, 0, "Could not add cell");
+
+	zassert_equal(send_frame(peer_addr), 0, "Could not send frame");
+	zassert_equal(check_tx_cell(1), 3, "Dedicated cell not used");
+
+	/* Without its dedicated cell, the peer gets the shared ones */
+	ret = del_cell(peer_addr, 3);
+	zassert_equal(ret, 0, "Could not remove cell");
+
+	for (i = 0; i < 2; i++) {
+		zassert_equal(send_frame(peer_addr), 0, "Could not send frame");
+
+		slot = tx_asn() % SLOTFRAME_SIZE;
+		zassert_true(slot == 0 || slot == 3, "Shared cell not used");
+		zassert_equal(check_tx_cell(slot ? 2 : 0), slot,
+			      "Frame sent in the wrong slot");
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(ieee802154_tsch,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_start),
+			 ztest_unit_test(test_add_del_cells),
+			 ztest_unit_test(test_eb_sync),
+			 ztest_unit_test(test_next_tx_cell)
+		);
+
+	ztest_run_test_suite(ieee802154_tsch);
+}
@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IPV4_LOG_LEVEL);
+
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+#include <net/dummy.h>
+
+#include "net_private.h"
+#include "ipv4.h"
+
+/* The datagrams sent by the client do not fit the link MTU, so they are
+ * fragmented. The fragments are captured by the driver and fed back to
+ * the stack with the addresses swapped, in various orders, to be
+ * reassembled and received by the server.
+ */
+
+#define LINK_MTU 128
+#define MAX_CAPTURED 8
+
+#define SERVER_PORT 4242
+#define PAYLOAD_LEN 512
+
+/* Payload bytes in every fragment but the last one */
+#define FRAG_PAYLOAD_LEN ((LINK_MTU - NET_IPV4H_LEN) & ~7)
+#define FRAG_COUNT ((NET_UDPH_LEN + PAYLOAD_LEN + FRAG_PAYLOAD_LEN - 1) / \
+		    FRAG_PAYLOAD_LEN)
+
+#define WAIT_TIME K_MSEC(100)
+
+static struct net_pkt *captured[MAX_CAPTURED];
+static int captured_count;
+
+static struct sockaddr_in server_addr;
+static struct sockaddr_in peer_addr;
+static int s_sock;
+static int c_sock;
+
+static u8_t tx_buf[PAYLOAD_LEN];
+static u8_t rx_buf[PAYLOAD_LEN + 1];
+
+static int frag_dev_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 0;
+}
+
+static void frag_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, "\x00\x00\x5e\x00\x53\x01", 6,
+			     NET_LINK_DUMMY);
+}
+
+static int frag_send(struct device *dev, struct net_pkt *pkt)
+{
+	struct net_pkt *cloned;
+	struct in_addr addr;
+
+	ARG_UNUSED(dev);
+
+	if (!pkt->frags) {
+		return -ENODATA;
+	}
+
+	zassert_true(captured_count < MAX_CAPTURED, "Too many fragments");
+
+	/* Swapping the addresses keeps both checksums valid */
+	net_ipaddr_copy(&addr, &NET_IPV4_HDR(pkt)->src);
+	net_ipaddr_copy(&NET_IPV4_HDR(pkt)->src, &NET_IPV4_HDR(pkt)->dst);
+	net_ipaddr_copy(&NET_IPV4_HDR(pkt)->dst, &addr);
+
+	cloned = net_pkt_clone(pkt, WAIT_TIME);
+	if (!cloned) {
+		return -ENOMEM;
+	}
+
+	captured[captured_count++] = cloned;
+
+	return 0;
+}
+
+static struct dummy_api frag_api = {
+	.iface_api.init = frag_iface_init,
+
+	.send = frag_send,
+};
+
+NET_DEVICE_INIT(frag, "frag",
+		frag_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&frag_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), LINK_MTU);
+
+static u16_t frag_field(struct net_pkt *pkt)
+{
+	struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+
+	return hdr->offset[0] << 8 | hdr->offset[1];
+}
+
+static void set_frag_field(struct net_pkt *pkt, u16_t value)
+{
+	struct net_ipv4_hdr *hdr = NET_IPV4_HDR(pkt);
+
+	hdr->offset[0] = value >> 8;
+	hdr->offset[1] = value;
+
+	hdr->chksum = 0U;
+	hdr->chksum = net_calc_chksum_ipv4(pkt);
+}
+
+static void inject(int idx)
+{
+	struct net_pkt *pkt = captured[idx];
+	int res;
+
+	zassert_not_null(pkt, "Fragment %d already injected", idx);
+
+	captured[idx] = NULL;
+
+	res = net_recv_data(net_pkt_iface(pkt), pkt);
+	zassert_true(res >= 0, "Cannot inject fragment %d (%d)", idx, res);
+}
+
+static void release_captured(void)
+{
+	int i;
+
+	for (i = 0; i < captured_count; i++) {
+		if (captured[i]) {
+			net_pkt_unref(captured[i]);
+			captured[i] = NULL;
+		}
+	}
+
+	captured_count = 0;
+}
+
+static void send_datagram(u8_t seed)
+{
+	ssize_t len;
+	int i;
+
+	for (i = 0; i < PAYLOAD_LEN; i++) {
+		tx_buf[i] = seed + i * 7U;
+	}
+
+	release_captured();
+
+	len = sendto(c_sock, tx_buf, sizeof(tx_buf), 0,
+		     (struct sockaddr *)&peer_addr, sizeof(peer_addr));
+	zassert_equal(len, sizeof(tx_buf), "sendto failed (%d)", errno);
+
+	zassert_equal(captured_count, FRAG_COUNT,
+		      "Sent %d fragments, expected %d", captured_count,
+		      FRAG_COUNT);
+}
+
+static void expect_datagram(void)
+{
+	ssize_t len;
+
+	len = recv(s_sock, rx_buf, sizeof(rx_buf), 0);
+	zassert_equal(len, PAYLOAD_LEN, "recv returned %d (%d)", len, errno);
+	zassert_mem_equal(rx_buf, tx_buf, PAYLOAD_LEN, "Data mismatch");
+}
+
+static void expect_nothing(void)
+{
+	ssize_t len;
+
+	k_sleep(WAIT_TIME);
+
+	len = recv(s_sock, rx_buf, sizeof(rx_buf), MSG_DONTWAIT);
+	zassert_equal(len, -1, "Unexpected datagram of %d bytes", len);
+	zassert_equal(errno, EAGAIN, "Unexpected error %d", errno);
+}
+
+static void count_reassemblies(struct net_reass *reass, void *user_data)
+{
+	int *count = user_data;
+
+	ARG_UNUSED(reass);
+
+	(*count)++;
+}
+
+static int pending_reassemblies(void)
+{
+	int count = 0;
+
+	net_ipv4_frag_foreach(count_reassemblies, &count);
+
+	return count;
+}
+
+void test_setup(void)
+{
+	int res;
+
+	server_addr.sin_family = AF_INET;
+	server_addr.sin_port = htons(SERVER_PORT);
+	res = inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			&server_addr.sin_addr);
+	zassert_equal(res, 1, "inet_pton failed");
+
+	/* The fragments come back from this address */
+	peer_addr.sin_family = AF_INET;
+	peer_addr.sin_port = htons(SERVER_PORT);
+	res = inet_pton(AF_INET, "192.0.2.2", &peer_addr.sin_addr);
+	zassert_equal(res, 1, "inet_pton failed");
+
+	s_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(s_sock >= 0, "socket open failed");
+	c_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(c_sock >= 0, "socket open failed");
+
+	res = bind(s_sock, (struct sockaddr *)&server_addr,
+		   sizeof(server_addr));
+	zassert_equal(res, 0, "bind failed");
+}
+
+void test_send_fragments(void)
+{
+	u16_t offset = 0U;
+	u16_t field;
+	int i;
+
+	send_datagram(0x10);
+
+	for (i = 0; i < captured_count; i++) {
+		struct net_pkt *pkt = captured[i];
+		size_t len = net_pkt_get_len(pkt);
+
+		field = frag_field(pkt);
+
+		zassert_true(len <= LINK_MTU, "Fragment %d too long", i);
+		zassert_equal(ntohs(NET_IPV4_HDR(pkt)->len), len,
+			      "Fragment %d length mismatch", i);
+		zassert_equal((field & NET_IPV4_FRAGH_OFFSET_MASK) * 8U,
+			      offset, "Fragment %d offset mismatch", i);
+		zassert_equal(!!(field & NET_IPV4_MORE_FRAG_MASK),
+			      i < captured_count - 1,
+			      "Fragment %d more flag mismatch", i);
+
+		offset += len - NET_IPV4H_LEN;
+	}
+
+	zassert_equal(offset, NET_UDPH_LEN + PAYLOAD_LEN,
+		      "Fragments do not add up");
+
+	for (i = 0; i < captured_count; i++) {
+		inject(i);
+	}
+
+	expect_datagram();
+	zassert_equal(pending_reassemblies(), 0, "Reassembly left pending");
+}
+
+void test_reverse_order(void)
+{
+	int i;
+
+	send_datagram(0x20);
+
+	for (i = captured_count - 1; i >= 0; i--) {
+		inject(i);
+	}
+
+	expect_datagram();
+}
+
+void test_duplicate(void)
+{
+	struct net_pkt *dup;
+	int i;
+
+	send_datagram(0x30);
+
+	dup = net_pkt_clone(captured[1], WAIT_TIME);
+	zassert_not_null(dup, "Cannot clone fragment");
+
+	inject(1);
+
+	zassert_true(net_recv_data(net_pkt_iface(dup), dup) >= 0,
+		     "Cannot inject duplicate");
+
+	for (i = 0; i < captured_count; i++) {
+		if (captured[i]) {
+			inject(i);
+		}
+	}
+
+	expect_datagram();
+	expect_nothing();
+}
+
+void test_overlap(void)
+{
+	u16_t field;
+
+	send_datagram(0x40);
+
+	/* Make the second fragment overlap the end of the first one */
+	field = frag_field(captured[1]);
+	set_frag_field(captured[1], field - 1U);
+
+	inject(0);
+	inject(1);
+
+	expect_nothing();
+	zassert_equal(pending_reassemblies(), 0,
+		      "Overlapping fragments not discarded");
+
+	release_captured();
+}
+
+void test_timeout(void)
+{
+	send_datagram(0x50);
+
+	inject(0);
+
+	k_sleep(WAIT_TIME);
+	zassert_equal(pending_reassemblies(), 1, "Reassembly not pending");
+
+	k_sleep(K_SECONDS(CONFIG_NET_IPV4_FRAGMENT_TIMEOUT) + WAIT_TIME);
+	zassert_equal(pending_reassemblies(), 0, "Reassembly not timed out");
+
+	release_captured();
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_ipv4_fragment,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_send_fragments),
+			 ztest_unit_test(test_reverse_order),
+			 ztest_unit_test(test_duplicate),
+			 ztest_unit_test(test_overlap),
+			 ztest_unit_test(test_timeout));
+
+	ztest_run_test_suite(net_ipv4_fragment);
+}
@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+#include <net/net_ip.h>
+#include <net/dummy.h>
+#include <net/buf.h>
+#include <net/capture.h>
+
+#include <ztest.h>
+
+#define SHB_LEN 28
+#define IDB_LEN 32
+#define EPB_HDR_LEN 28
+#define EPB_TRAILER_LEN 16
+
+#define LINKTYPE_RAW 101
+
+static struct net_if *iface;
+
+/* 2001:db8::1 port 1234 -> 2001:db8::2 port 53 */
+static const u8_t ipv6_udp[] = {
+	0x60, 0x00, 0x00, 0x00, 0x00, 0x10, 0x11, 0x40,
+	0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+	0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+	0x04, 0xd2, 0x00, 0x35, 0x00, 0x10, 0x00, 0x00,
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+};
+
+/* 192.0.2.1 port 80 -> 192.0.2.2 port 8080 */
+static const u8_t ipv4_tcp[] = {
+	0x45, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0x00,
+	0x40, 0x06, 0x00, 0x00, 0xc0, 0x00, 0x02, 0x01,
+	0xc0, 0x00, 0x02, 0x02, 0x00, 0x50, 0x1f, 0x90,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x50, 0x02, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+NET_BUF_POOL_DEFINE(test_pool, 16, 64, 0, NULL);
+
+static u8_t output[1024];
+static size_t output_len;
+static int output_opened;
+
+static int test_open(void)
+{
+	output_opened++;
+	output_len = 0;
+
+	return 0;
+}
+
+static int test_write(const void *data, size_t len)
+{
+	zassert_true(output_len + len <= sizeof(output), "Output too long");
+
+	memcpy(&output[output_len], data, len);
+	output_len += len;
+
+	return 0;
+}
+
+static const struct net_capture_backend test_backend = {
+	.open = test_open,
+	.write = test_write,
+};
+
+static void fake_iface_init(struct net_if *netif)
+{
+	static u8_t mac[] = { 0x00, 0x00, 0x5e, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(netif, mac, sizeof(mac), NET_LINK_DUMMY);
+}
+
+static int fake_send(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static int fake_init(struct device *dev)
+{
+	return 0;
+}
+
+static const struct dummy_api fake_api = {
+	.iface_api.init = fake_iface_init,
+	.send = fake_send,
+};
+
+NET_DEVICE_INIT(capture_fake, "capture_fake", fake_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &fake_api,
+		DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 1280);
+
+/* Builds a packet out of fragments of frag_len bytes */
+static struct net_pkt *build_pkt(const u8_t *data, size_t len,
+				 size_t frag_len)
+{
+	struct net_pkt *pkt;
+	struct net_buf *frag;
+	size_t chunk;
+
+	pkt = net_pkt_alloc(K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	net_pkt_set_iface(pkt, iface);
+
+	while (len) {
+		chunk = MIN(len, frag_len);
+
+		frag = net_buf_alloc(&test_pool, K_NO_WAIT);
+		zassert_not_null(frag, "Cannot allocate fragment");
+
+		net_buf_add_mem(frag, data, chunk);
+		net_pkt_frag_add(pkt, frag);
+
+		data += chunk;
+		len -= chunk;
+	}
+
+	return pkt;
+}
+
+static bool match(const char *expr, const u8_t *data, size_t len)
+{
+	struct net_capture_filter filter;
+	struct net_pkt *pkt;
+	bool ret;
+
+	zassert_equal(net_capture_filter_compile(expr, &filter), 0,
+		      "Cannot compile \"%s\"", expr);
+
+	pkt = build_pkt(data, len, 64);
+	ret = net_capture_filter_match(&filter, iface, pkt->buffer, len);
+	net_pkt_unref(pkt);
+
+	return ret;
+}
+
+static void test_setup(void)
+{
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "No dummy interface");
+
+	net_capture_set_backend(&test_backend);
+}
+
+static void test_filter_compile(void)
+{
+	static const char * const valid[] = {
+		"",
+		"udp",
+		"udp port 53",
+		"src host 192.0.2.1 and not dst port 80",
+		"(tcp || udp) && !icmp6",
+		"ip6 host 2001:db8::1 or arp",
+		"less 100 or greater 1000",
+	};
+	static const char * const invalid[] = {
+		"foo",
+		"udp and",
+		"(udp",
+		"udp)",
+		"host",
+		"host 192.0.2",
+		"src udp",
+		"port 65536",
+		"less",
+		"or tcp",
+	};
+	struct net_capture_filter filter;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(valid); i++) {
+		zassert_equal(net_capture_filter_compile(valid[i], &filter),
+			      0, "Cannot compile \"%s\"", valid[i]);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(invalid); i++) {
+		zassert_equal(net_capture_filter_compile(invalid[i], &filter),
+			      -EINVAL, "Compiled \"%s\"", invalid[i]);
+	}
+
+	zassert_equal(net_capture_filter_compile(
+			      "udp or udp or udp or udp or udp or udp or udp "
+			      "or udp or udp", &filter), -ENOMEM,
+		      "Compiled a too long filter");
+}
+
+static void test_filter_match(void)
+{
+	zassert_true(match("", ipv6_udp, sizeof(ipv6_udp)), "");
+	zassert_true(match("ip6", ipv6_udp, sizeof(ipv6_udp)), "");
+	zassert_false(match("ip", ipv6_udp, sizeof(ipv6_udp)), "");
+	zassert_true(match("udp", ipv6_udp, sizeof(ipv6_udp)), "");
+	zassert_false(match("tcp", ipv6_udp, sizeof(ipv6_udp)), "");
+	zassert_true(match("udp port 53", ipv6_udp, sizeof(ipv6_udp)), "");
+	zassert_true(match("src port 1234", ipv6_udp, sizeof(ipv6_udp)), "");
+	zassert_false(match("src port 53", ipv6_udp, sizeof(ipv6_udp)), "");
+	zassert_true(match("host 2001:db8::2", ipv6_udp, sizeof(ipv6_udp)),
+		     "");
+	zassert_false(match("src host 2001:db8::2", ipv6_udp,
+			    sizeof(ipv6_udp)), "");
+	zassert_false(match("host 192.0.2.1", ipv6_udp, sizeof(ipv6_udp)),
+		      "");
+	zassert_true(match("less 64 and greater 64", ipv6_udp,
+			   sizeof(ipv6_udp)), "");
+	zassert_false(match("less 63", ipv6_udp, sizeof(ipv6_udp)), "");
+
+	zassert_true(match("ip and tcp", ipv4_tcp, sizeof(ipv4_tcp)), "");
+	zassert_true(match("src host 192.0.2.1 and dst port 8080", ipv4_tcp,
+			   sizeof(ipv4_tcp)), "");
+	zassert_false(match("not port 80", ipv4_tcp, sizeof(ipv4_tcp)), "");
+	zassert_true(match("udp or (tcp and not port 53)", ipv4_tcp,
+			   sizeof(ipv4_tcp)), "");
+	zassert_false(match("!(tcp || udp)", ipv4_tcp, sizeof(ipv4_tcp)), "");
+}
+
+static void test_capture_output(void)
+{
+	struct net_capture_stats stats;
+	struct net_buf *frag;
+	struct net_pkt *pkt;
+	u32_t value;
+	u8_t *epb;
+
+	zassert_equal(net_capture_enable(iface, NULL), 0, "Cannot enable");
+	zassert_equal(net_capture_enable(iface, NULL), -EALREADY,
+		      "Enabled twice");
+
+	/* The packet is captured by reference, its fragments staying
+	 * around after it is freed, until written out.
+	 */
+	pkt = build_pkt(ipv6_udp, sizeof(ipv6_udp), 20);
+	frag = pkt->buffer;
+
+	net_capture_pkt(iface, pkt, NET_CAPTURE_RX);
+	net_pkt_unref(pkt);
+
+	zassert_equal(frag->ref, 1, "Fragment not referenced");
+
+	net_capture_flush();
+
+	zassert_equal(net_capture_get_stats(iface, &stats), 0, "No stats");
+	zassert_equal(stats.captured, 1, "Packet not captured");
+	zassert_equal(output_opened, 1, "Output not opened");
+	zassert_equal(output_len, SHB_LEN + IDB_LEN + EPB_HDR_LEN +
+		      sizeof(ipv6_udp) + EPB_TRAILER_LEN,
+		      "Invalid output length %d", output_len);
+
+	memcpy(&value, &output[0], sizeof(value));
+	zassert_equal(value, 0x0A0D0D0A, "Invalid section header");
+
+	memcpy(&value, &output[SHB_LEN], sizeof(value));
+	zassert_equal(value, 1, "Invalid interface description");
+	zassert_equal(output[SHB_LEN + 8], LINKTYPE_RAW, "Invalid link type");
+
+	epb = &output[SHB_LEN + IDB_LEN];
+
+	memcpy(&value, &epb[0], sizeof(value));
+	zassert_equal(value, 6, "Invalid packet block");
+	memcpy(&value, &epb[20], sizeof(value));
+	zassert_equal(value, sizeof(ipv6_udp), "Invalid captured length");
+	zassert_mem_equal(&epb[EPB_HDR_LEN], ipv6_udp, sizeof(ipv6_udp),
+			  "Invalid packet data");
+
+	memcpy(&value, &epb[EPB_HDR_LEN + sizeof(ipv6_udp) + 4],
+	       sizeof(value));
+	zassert_equal(value, NET_CAPTURE_RX, "Invalid direction");
+
+	zassert_equal(net_capture_disable(iface), 0, "Cannot disable");
+	zassert_equal(net_capture_disable(iface), -EALREADY,
+		      "Disabled twice");
+	zassert_false(net_capture_is_enabled(iface), "Still enabled");
+}
+
+static void test_capture_filtered_and_dropped(void)
+{
+	struct net_capture_filter filter;
+	struct net_capture_stats stats;
+	struct net_pkt *pkt;
+	int i;
+
+	zassert_equal(net_capture_filter_compile("tcp", &filter), 0,
+		      "Cannot compile filter");
+	zassert_equal(net_capture_enable(iface, &filter), 0, "Cannot enable");
+
+	for (i = 0; i < CONFIG_NET_CAPTURE_RING_SIZE + 2; i++) {
+		pkt = build_pkt(ipv4_tcp, sizeof(ipv4_tcp), 64);
+		net_capture_pkt(iface, pkt, NET_CAPTURE_TX);
+		net_pkt_unref(pkt);
+
+		pkt = build_pkt(ipv6_udp, sizeof(ipv6_udp), 64);
+		net_capture_pkt(iface, pkt, NET_CAPTURE_TX);
+		net_pkt_unref(pkt);
+	}
+
+	zassert_equal(net_capture_get_stats(iface, &stats), 0, "No stats");
+	zassert_equal(stats.captured, CONFIG_NET_CAPTURE_RING_SIZE,
+		      "Invalid captured count %u", stats.captured);
+	zassert_equal(stats.dropped, 2, "Invalid dropped count %u",
+		      stats.dropped);
+	zassert_equal(stats.filtered, CONFIG_NET_CAPTURE_RING_SIZE + 2,
+		      "Invalid filtered count %u", stats.filtered);
+
+	/* Disabling writes the packets out and frees their fragments */
+	zassert_equal(net_capture_disable(iface), 0, "Cannot disable");
+
+	for (i = 0; i < 16; i++) {
+		zassert_not_null(net_buf_alloc(&test_pool, K_NO_WAIT),
+				 "Fragments not released");
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_capture,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_filter_compile),
+			 ztest_unit_test(test_filter_match),
+			 ztest_unit_test(test_capture_output),
+			 ztest_unit_test(test_capture_filtered_and_dropped));
+
+	ztest_run_test_suite(net_capture);
+}
@@ -1456,6 +1456,217 @@ done:
 	return result;
 }
 
+#define MANY_OPTIONS 20
+
+static int test_find_many_options(void)
+{
+	struct coap_packet cpkt;
+	struct coap_option options[MANY_OPTIONS + 1];
+	char query[] = "q=0";
+	u8_t format = 0U;
+	u8_t *data;
+	int result = TC_FAIL;
+	int r, i;
+
+	data = (u8_t *)k_malloc(COAP_BUF_SIZE);
+	if (!data) {
+		goto done;
+	}
+
+	r = coap_packet_init(&cpkt, data, COAP_BUF_SIZE,
+			     1, COAP_TYPE_CON, 0, NULL,
+			     COAP_METHOD_GET, 0);
+	if (r < 0) {
+		TC_PRINT("Could not initialize packet\n");
+		goto done;
+	}
+
+	/* More options than can be indexed, the last ones have to be
+	 * found by parsing the packet.
+	 */
+	r = coap_packet_append_option(&cpkt, COAP_OPTION_CONTENT_FORMAT,
+				      &format, sizeof(format));
+	if (r < 0) {
+		TC_PRINT("Could not append option\n");
+		goto done;
+	}
+
+	for (i = 0; i < MANY_OPTIONS; i++) {
+		query[2] = 'a' + i;
+
+		r = coap_packet_append_option(&cpkt, COAP_OPTION_URI_QUERY,
+					      query, strlen(query));
+		if (r < 0) {
+			TC_PRINT("Could not append option\n");
+			goto done;
+		}
+	}
+
+	r = coap_find_options(&cpkt, COAP_OPTION_URI_QUERY, options,
+			      ARRAY_SIZE(options));
+	if (r != MANY_OPTIONS) {
+		TC_PRINT("Unexpected number of options in built packet\n");
+		goto done;
+	}
+
+	r = coap_packet_parse(&cpkt, data, cpkt.offset, NULL, 0);
+	if (r) {
+		TC_PRINT("Could not parse packet\n");
+		goto done;
+	}
+
+	r = coap_find_options(&cpkt, COAP_OPTION_URI_QUERY, options,
+			      ARRAY_SIZE(options));
+	if (r != MANY_OPTIONS) {
+		TC_PRINT("Unexpected number of options in parsed packet\n");
+		goto done;
+	}
+
+	if (options[MANY_OPTIONS - 1].len != strlen(query) ||
+	    memcmp(options[MANY_OPTIONS - 1].value, query, strlen(query))) {
+		TC_PRINT("Option value doesn't match the reference\n");
+		goto done;
+	}
+
+	r = coap_find_options(&cpkt, COAP_OPTION_CONTENT_FORMAT, options, 1);
+	if (r != 1 || options[0].len != 1U) {
+		TC_PRINT("Content format option not found\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	k_free(data);
+
+	TC_END_RESULT(result);
+
+	return result;
+}
+
+static struct coap_resource *routed_resource;
+
+static int router_resource_get(struct coap_resource *resource,
+			       struct coap_packet *request,
+			       struct sockaddr *addr, socklen_t addr_len)
+{
+	routed_resource = resource;
+
+	return 0;
+}
+
+static const char * const router_root_path[] = { NULL };
+static const char * const router_s_1_path[] = { "s", "1", NULL };
+static const char * const router_s_10_path[] = { "s", "10", NULL };
+static const char * const router_s_1_a_path[] = { "s", "1", "a", NULL };
+static const char * const router_t_path[] = { "t", NULL };
+static const char * const router_u_v_path[] = { "u", "v", NULL };
+static struct coap_resource router_resources[] = {
+	{ .path = router_s_1_path, .get = router_resource_get },
+	{ .path = router_t_path, .get = router_resource_get },
+	{ .path = router_s_1_a_path, .get = router_resource_get },
+	{ .path = router_root_path, .get = router_resource_get },
+	{ .path = router_s_10_path, .get = router_resource_get },
+	{ .path = router_u_v_path, .post = router_resource_get },
+	{ },
+};
+
+static int route_request(struct coap_router *router, const char * const *path,
+			 u8_t method)
+{
+	struct coap_packet cpkt;
+	struct coap_option options[4];
+	u8_t data[COAP_BUF_SIZE];
+	int r;
+
+	r = coap_packet_init(&cpkt, data, sizeof(data), 1, COAP_TYPE_CON,
+			     0, NULL, method, 0);
+	if (r < 0) {
+		return r;
+	}
+
+	for (; *path; path++) {
+		r = coap_packet_append_option(&cpkt, COAP_OPTION_URI_PATH,
+					      *path, strlen(*path));
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	r = coap_packet_parse(&cpkt, data, cpkt.offset, options,
+			      ARRAY_SIZE(options));
+	if (r < 0) {
+		return r;
+	}
+
+	routed_resource = NULL;
+
+	return coap_router_handle_request(router, &cpkt, options,
+					  ARRAY_SIZE(options),
+					  (struct sockaddr *)&dummy_addr,
+					  sizeof(dummy_addr));
+}
+
+static int test_router(void)
+{
+	static const char * const s_path[] = { "s", NULL };
+	static const char * const s_2_path[] = { "s", "2", NULL };
+	static const char * const s_1_a_b_path[] = { "s", "1", "a", "b", NULL };
+	struct coap_router_node nodes[8];
+	struct coap_router router;
+	struct coap_resource *resource;
+	int result = TC_FAIL;
+	int r;
+
+	r = coap_router_init(&router, router_resources, nodes, 7);
+	if (r != -ENOMEM) {
+		TC_PRINT("Router built with too few nodes\n");
+		goto done;
+	}
+
+	r = coap_router_init(&router, router_resources, nodes,
+			     ARRAY_SIZE(nodes));
+	if (r < 0) {
+		TC_PRINT("Could not build router (%d)\n", r);
+		goto done;
+	}
+
+	for (resource = router_resources; resource->path; resource++) {
+		if (resource->get) {
+			r = route_request(&router, resource->path,
+					  COAP_METHOD_GET);
+		} else {
+			r = route_request(&router, resource->path,
+					  COAP_METHOD_POST);
+		}
+
+		if (r < 0 || routed_resource != resource) {
+			TC_PRINT("Request not routed to its resource\n");
+			goto done;
+		}
+	}
+
+	if (route_request(&router, s_path, COAP_METHOD_GET) != -ENOENT ||
+	    route_request(&router, s_2_path, COAP_METHOD_GET) != -ENOENT ||
+	    route_request(&router, s_1_a_b_path, COAP_METHOD_GET) != -ENOENT) {
+		TC_PRINT("Request routed to a missing resource\n");
+		goto done;
+	}
+
+	if (route_request(&router, router_u_v_path, COAP_METHOD_GET) !=
+	    -EPERM) {
+		TC_PRINT("Request routed to a missing method\n");
+		goto done;
+	}
+
+	result = TC_PASS;
+
+done:
+	TC_END_RESULT(result);
+
+	return result;
+}
+
 static const struct {
 	const char *name;
 	int (*func)(void);
@@ -1478,6 +1689,8 @@ static const struct {
 	{ "Test retransmission", test_retransmit_second_round, },
 	{ "Test observer server", test_observer_server, },
 	{ "Test observer client", test_observer_client, },
+	{ "Test find many options", test_find_many_options, },
+	{ "Test resource router", test_router, },
 };
 
 int main(int argc, char *argv[])
@@ -0,0 +1,517 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+#include <net/dns_resolve.h>
+
+/* A stub DNS server on the loopback interface answers the queries after
+ * a delay that simulates the round trip to a real server. Answers given
+ * from the cache must not reach the server and must arrive faster.
+ */
+
+#define SERVER_PORT 15353
+#define SERVER_DELAY_MS 100
+
+#define SERVER_STACK_SIZE 2048
+#define SERVER_PRIORITY 7
+
+#define DNS_HEADER_LEN 12
+#define MAX_MSG_LEN 512
+#define MAX_NAME_LEN 64
+
+#define CACHED_NAME "cached.example"
+#define SHORT_TTL_NAME "short.example"
+#define COALESCED_NAME "coalesced.example"
+#define UNKNOWN_NAME "unknown.example"
+#define NODATA_NAME "nodata.example"
+#define SOA_NAME "soa.example"
+#define SERVFAIL_NAME "servfail.example"
+
+#define LONG_TTL 60
+#define SHORT_TTL 1
+
+#define RCODE_SERVFAIL 2
+
+#define COALESCED_QUERIES 3
+
+#define DNS_TIMEOUT K_SECONDS(2)
+#define WAIT_TIME K_SECONDS(3)
+
+struct stub_record {
+	const char *name;
+	const char *addr;
+	u32_t ttl;
+	/* Negative caching TTL of an SOA record in the authority section */
+	u32_t soa_minimum;
+	u8_t rcode;
+};
+
+static const struct stub_record records[] = {
+	{ CACHED_NAME, "192.0.2.10", LONG_TTL },
+	{ SHORT_TTL_NAME, "192.0.2.11", SHORT_TTL },
+	{ COALESCED_NAME, "192.0.2.12", LONG_TTL },
+	/* The name exists, but has no address of the queried type */
+	{ NODATA_NAME, NULL, LONG_TTL },
+	/* Same, but the zone limits how long this can be cached */
+	{ SOA_NAME, NULL, LONG_TTL, SHORT_TTL },
+	/* The server cannot answer right now */
+	{ SERVFAIL_NAME, NULL, LONG_TTL, 0, RCODE_SERVFAIL },
+};
+
+struct lookup {
+	struct k_sem done;
+	struct in_addr addr;
+	int status;
+	int count;
+};
+
+static atomic_t queries_received;
+
+static u8_t server_buf[MAX_MSG_LEN];
+
+static int parse_qname(const u8_t *msg, int len, char *name)
+{
+	int pos = DNS_HEADER_LEN;
+	int out = 0;
+
+	while (pos < len && msg[pos]) {
+		int label = msg[pos++];
+
+		if (pos + label > len || out + label + 1 >= MAX_NAME_LEN) {
+			return -EINVAL;
+		}
+
+		if (out) {
+			name[out++] = '.';
+		}
+
+		memcpy(&name[out], &msg[pos], label);
+		out += label;
+		pos += label;
+	}
+
+	name[out] = '\0';
+
+	/* Skip the terminating zero, QTYPE and QCLASS */
+	pos += 5;
+
+	return pos <= len ? pos : -EINVAL;
+}
+
+static int build_soa(u8_t *msg, int len, const struct stub_record *record)
+{
+	/* Name pointer to the question, type SOA, class IN */
+	msg[len++] = 0xc0;
+	msg[len++] = DNS_HEADER_LEN;
+	msg[len++] = 0U;
+	msg[len++] = 6U;
+	msg[len++] = 0U;
+	msg[len++] = 1U;
+
+	UNALIGNED_PUT(htonl(record->ttl), (u32_t *)&msg[len]);
+	len += sizeof(u32_t);
+
+	/* MNAME and RNAME pointers, then SERIAL, REFRESH, RETRY, EXPIRE
+	 * and MINIMUM
+	 */
+	msg[len++] = 0U;
+	msg[len++] = 2 * 2 + 5 * sizeof(u32_t);
+
+	msg[len++] = 0xc0;
+	msg[len++] = DNS_HEADER_LEN;
+	msg[len++] = 0xc0;
+	msg[len++] = DNS_HEADER_LEN;
+
+	memset(&msg[len], 0, 4 * sizeof(u32_t));
+	len += 4 * sizeof(u32_t);
+
+	UNALIGNED_PUT(htonl(record->soa_minimum), (u32_t *)&msg[len]);
+	len += sizeof(u32_t);
+
+	return len;
+}
+
+static int build_answer(u8_t *msg, int len, const struct stub_record *record)
+{
+	struct in_addr addr;
+
+	/* QR, RD and RA, an NXDOMAIN error if there is no such record */
+	msg[2] = 0x81;
+	msg[3] = record ? 0x80 | record->rcode : 0x83;
+
+	/* One answer if there is an address, an SOA record in the
+	 * authority section if the record has one, no additional records
+	 */
+	msg[6] = 0U;
+	msg[7] = (record && record->addr) ? 1U : 0U;
+	msg[8] = 0U;
+	msg[9] = (record && record->soa_minimum) ? 1U : 0U;
+	memset(&msg[10], 0, 2);
+
+	if (record && record->soa_minimum) {
+		return build_soa(msg, len, record);
+	}
+
+	if (!record || !record->addr) {
+		return len;
+	}
+
+	inet_pton(AF_INET, record->addr, &addr);
+
+	/* Name pointer to the question, type A, class IN */
+	msg[len++] = 0xc0;
+	msg[len++] = DNS_HEADER_LEN;
+	msg[len++] = 0U;
+	msg[len++] = 1U;
+	msg[len++] = 0U;
+	msg[len++] = 1U;
+
+	UNALIGNED_PUT(htonl(record->ttl), (u32_t *)&msg[len]);
+	len += sizeof(u32_t);
+
+	msg[len++] = 0U;
+	msg[len++] = sizeof(addr);
+
+	memcpy(&msg[len], &addr, sizeof(addr));
+	len += sizeof(addr);
+
+	return len;
+}
+
+static void server(void *p1, void *p2, void *p3)
+{
+	const struct stub_record *record;
+	struct sockaddr_in addr = { 0 };
+	struct sockaddr peer;
+	socklen_t peer_len;
+	char name[MAX_NAME_LEN];
+	int sock, len, i;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(sock >= 0, "socket open failed");
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(SERVER_PORT);
+	inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+	zassert_equal(bind(sock, (struct sockaddr *)&addr, sizeof(addr)), 0,
+		      "bind failed");
+
+	while (true) {
+		peer_len = sizeof(peer);
+
+		len = recvfrom(sock, server_buf, sizeof(server_buf), 0,
+			       &peer, &peer_len);
+		if (len < DNS_HEADER_LEN) {
+			continue;
+		}
+
+		len = parse_qname(server_buf, len, name);
+		if (len < 0) {
+			continue;
+		}
+
+		atomic_inc(&queries_received);
+
+		record = NULL;
+
+		for (i = 0; i < ARRAY_SIZE(records); i++) {
+			if (!strcmp(records[i].name, name)) {
+				record = &records[i];
+				break;
+			}
+		}
+
+		len = build_answer(server_buf, len, record);
+
+		k_sleep(K_MSEC(SERVER_DELAY_MS));
+
+		sendto(sock, server_buf, len, 0, &peer, peer_len);
+	}
+}
+
+K_THREAD_DEFINE(stub_server, SERVER_STACK_SIZE, server, NULL, NULL, NULL,
+		K_PRIO_PREEMPT(SERVER_PRIORITY), 0, K_NO_WAIT);
+
+static void lookup_cb(enum dns_resolve_status status,
+		      struct dns_addrinfo *info, void *user_data)
+{
+	struct lookup *lookup = user_data;
+
+	if (status == DNS_EAI_INPROGRESS && info) {
+		net_ipaddr_copy(&lookup->addr,
+				&net_sin(&info->ai_addr)->sin_addr);
+		lookup->count++;
+		return;
+	}
+
+	lookup->status = status;
+	k_sem_give(&lookup->done);
+}
+
+static void lookup_start(struct lookup *lookup, const char *name,
+			 u16_t *dns_id)
+{
+	int ret;
+
+	k_sem_init(&lookup->done, 0, 1);
+	lookup->status = 0;
+	lookup->count = 0;
+
+	ret = dns_get_addr_info(name, DNS_QUERY_TYPE_A, dns_id, lookup_cb,
+				lookup, DNS_TIMEOUT);
+	zassert_equal(ret, 0, "Cannot resolve %s (%d)", name, ret);
+}
+
+static void lookup_wait(struct lookup *lookup, const char *name,
+			const char *expected)
+{
+	struct in_addr addr;
+
+	zassert_equal(k_sem_take(&lookup->done, WAIT_TIME), 0,
+		      "Timeout while resolving %s", name);
+
+	if (!expected) {
+		zassert_equal(lookup->status, DNS_EAI_NODATA,
+			      "Unexpected status %d for %s", lookup->status,
+			      name);
+		zassert_equal(lookup->count, 0, "Unexpected address");
+		return;
+	}
+
+	zassert_equal(lookup->status, DNS_EAI_ALLDONE,
+		      "Unexpected status %d for %s", lookup->status, name);
+	zassert_equal(lookup->count, 1, "Unexpected number of addresses");
+
+	inet_pton(AF_INET, expected, &addr);
+	zassert_true(net_ipv4_addr_cmp(&lookup->addr, &addr),
+		     "Unexpected address for %s", name);
+}
+
+/* Resolve a name and return how long it took */
+static u32_t resolve(const char *name, const char *expected)
+{
+	struct lookup lookup;
+	u32_t start = k_uptime_get_32();
+
+	lookup_start(&lookup, name, NULL);
+	lookup_wait(&lookup, name, expected);
+
+	return k_uptime_get_32() - start;
+}
+
+static void test_cache_hit(void)
+{
+	atomic_val_t queries = atomic_get(&queries_received);
+	struct lookup lookup;
+	u32_t miss, hit;
+	u16_t dns_id;
+
+	miss = resolve(CACHED_NAME, "192.0.2.10");
+	zassert_true(miss >= SERVER_DELAY_MS, "Answer faster than server");
+	zassert_equal(atomic_get(&queries_received), queries + 1,
+		      "Query not sent to server");
+
+	hit = resolve(CACHED_NAME, "192.0.2.10");
+	zassert_true(hit < SERVER_DELAY_MS, "Answer not from cache");
+	zassert_equal(atomic_get(&queries_received), queries + 1,
+		      "Cached answer queried from server");
+
+	/* Answers from the cache have no query left to cancel */
+	lookup_start(&lookup, CACHED_NAME, &dns_id);
+	lookup_wait(&lookup, CACHED_NAME, "192.0.2.10");
+
+	zassert_equal(dns_id, DNS_RESOLVE_ID_CACHED,
+		      "Cached answer given a query id");
+	zassert_equal(dns_cancel_addr_info(dns_id), -ENOENT,
+		      "Cached answer cancelled");
+
+	TC_PRINT("lookup latency: server %u ms, cache %u ms\n", miss, hit);
+}
+
+static void test_getaddrinfo(void)
+{
+	atomic_val_t queries = atomic_get(&queries_received);
+	struct addrinfo hints = { 0 };
+	struct addrinfo *res = NULL;
+	struct in_addr addr;
+	u32_t start, elapsed;
+	int ret;
+
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+
+	start = k_uptime_get_32();
+	ret = getaddrinfo(CACHED_NAME, "80", &hints, &res);
+	elapsed = k_uptime_get_32() - start;
+
+	zassert_equal(ret, 0, "getaddrinfo failed (%d)", ret);
+	zassert_not_null(res, "No result");
+
+	inet_pton(AF_INET, "192.0.2.10", &addr);
+	zassert_true(net_ipv4_addr_cmp(&net_sin(res->ai_addr)->sin_addr,
+				       &addr), "Unexpected address");
+
+	freeaddrinfo(res);
+
+	zassert_true(elapsed < SERVER_DELAY_MS, "Answer not from cache");
+	zassert_equal(atomic_get(&queries_received), queries,
+		      "Cached answer queried from server");
+}
+
+static void test_coalesce(void)
+{
+	atomic_val_t queries = atomic_get(&queries_received);
+	struct lookup lookups[COALESCED_QUERIES];
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(lookups); i++) {
+		lookup_start(&lookups[i], COALESCED_NAME, NULL);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(lookups); i++) {
+		lookup_wait(&lookups[i], COALESCED_NAME, "192.0.2.12");
+	}
+
+	zassert_equal(atomic_get(&queries_received), queries + 1,
+		      "Identical queries not coalesced");
+}
+
+static void test_negative(void)
+{
+	atomic_val_t queries = atomic_get(&queries_received);
+	u32_t miss, hit;
+
+	miss = resolve(UNKNOWN_NAME, NULL);
+	zassert_true(miss >= SERVER_DELAY_MS, "Answer faster than server");
+	zassert_equal(atomic_get(&queries_received), queries + 1,
+		      "Query not sent to server");
+
+	hit = resolve(UNKNOWN_NAME, NULL);
+	zassert_true(hit < SERVER_DELAY_MS, "Negative answer not from cache");
+	zassert_equal(atomic_get(&queries_received), queries + 1,
+		      "Negative answer queried from server");
+
+	TC_PRINT("negative lookup latency: server %u ms, cache %u ms\n",
+		 miss, hit);
+}
+
+static void test_nodata(void)
+{
+	atomic_val_t queries = atomic_get(&queries_received);
+	u32_t miss, hit;
+
+	miss = resolve(NODATA_NAME, NULL);
+	zassert_true(miss >= SERVER_DELAY_MS, "Answer faster than server");
+	zassert_equal(atomic_get(&queries_received), queries + 1,
+		      "Query not sent to server");
+
+	hit = resolve(NODATA_NAME, NULL);
+	zassert_true(hit < SERVER_DELAY_MS, "NODATA answer not from cache");
+	zassert_equal(atomic_get(&queries_received), queries + 1,
+		      "NODATA answer queried from server");
+}
+
+static void test_soa_minimum(void)
+{
+	atomic_val_t queries = atomic_get(&queries_received);
+
+	resolve(SOA_NAME, NULL);
+	resolve(SOA_NAME, NULL);
+	zassert_equal(atomic_get(&queries_received), queries + 1,
+		      "Negative answer queried from server");
+
+	/* Cached for the SOA minimum rather than the configured time */
+	k_sleep(K_SECONDS(SHORT_TTL) + K_MSEC(100));
+
+	resolve(SOA_NAME, NULL);
+	zassert_equal(atomic_get(&queries_received), queries + 2,
+		      "Expired negative answer not queried from server");
+}
+
+static void test_servfail(void)
+{
+	atomic_val_t queries = atomic_get(&queries_received);
+	struct lookup lookup;
+	int i;
+
+	/* A server failure is reported, but not cached as an answer */
+	for (i = 0; i < 2; i++) {
+		lookup_start(&lookup, SERVFAIL_NAME, NULL);
+
+		zassert_equal(k_sem_take(&lookup.done, WAIT_TIME), 0,
+			      "Timeout while resolving %s", SERVFAIL_NAME);
+		zassert_equal(lookup.status, DNS_EAI_FAIL,
+			      "Unexpected status %d", lookup.status);
+		zassert_equal(atomic_get(&queries_received), queries + i + 1,
+			      "Server failure answered from cache");
+	}
+}
+
+static void test_ttl_expiry(void)
+{
+	atomic_val_t queries = atomic_get(&queries_received);
+
+	resolve(SHORT_TTL_NAME, "192.0.2.11");
+	resolve(SHORT_TTL_NAME, "192.0.2.11");
+	zassert_equal(atomic_get(&queries_received), queries + 1,
+		      "Cached answer queried from server");
+
+	k_sleep(K_SECONDS(SHORT_TTL) + K_MSEC(100));
+
+	resolve(SHORT_TTL_NAME, "192.0.2.11");
+	zassert_equal(atomic_get(&queries_received), queries + 2,
+		      "Expired answer not queried from server");
+}
+
+static void count_entries(struct dns_cache_entry *entry, void *user_data)
+{
+	ARG_UNUSED(entry);
+	ARG_UNUSED(user_data);
+}
+
+static void test_flush(void)
+{
+	struct dns_resolve_context *ctx = dns_resolve_get_default();
+	atomic_val_t queries = atomic_get(&queries_received);
+
+	zassert_true(dns_resolve_cache_foreach(ctx, count_entries, NULL) > 0,
+		     "Cache is empty");
+
+	dns_resolve_cache_flush(ctx);
+
+	zassert_equal(dns_resolve_cache_foreach(ctx, count_entries, NULL), 0,
+		      "Cache not flushed");
+
+	resolve(CACHED_NAME, "192.0.2.10");
+	zassert_equal(atomic_get(&queries_received), queries + 1,
+		      "Flushed answer not queried from server");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(dns_cache,
+			 ztest_unit_test(test_cache_hit),
+			 ztest_unit_test(test_getaddrinfo),
+			 ztest_unit_test(test_coalesce),
+			 ztest_unit_test(test_negative),
+			 ztest_unit_test(test_nodata),
+			 ztest_unit_test(test_soa_minimum),
+			 ztest_unit_test(test_servfail),
+			 ztest_unit_test(test_ttl_expiry),
+			 ztest_unit_test(test_flush));
+
+	ztest_run_test_suite(dns_cache);
+}
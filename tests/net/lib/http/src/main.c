@@ -0,0 +1,459 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_HTTP_CLIENT_LOG_LEVEL);
+
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+#include <net/http_client.h>
+#include <net/http_server.h>
+
+/* The client and the server talk over the loopback interface, the server
+ * runs in its own thread. The connections are kept open between the
+ * requests, so most tests use the same one.
+ */
+
+#define SERVER_PORT 8080
+#define SERVER_STACK_SIZE 3072
+#define SERVER_PRIORITY 7
+
+#define HOST "127.0.0.1"
+#define HELLO "Hello"
+
+#define N_CONNS CONFIG_HTTP_SERVER_MAX_CONNECTIONS
+#define PIPELINE CONFIG_HTTP_CLIENT_MAX_PIPELINE
+#define LOAD_REQUESTS 64
+
+#define TIMEOUT MSEC_PER_SEC
+#define MAX_BODY_LEN 128
+#define RECV_BUF_LEN 256
+
+struct response {
+	u8_t body[MAX_BODY_LEN];
+	size_t len;
+	int order;
+	bool done;
+};
+
+static const char * const parts[] = { "first ", "second ", "third" };
+#define PARTS_TEXT "first second third"
+
+static struct http_server server;
+static K_SEM_DEFINE(server_ready, 0, 1);
+
+static struct http_server_conn *last_server_conn;
+static u8_t echo_buf[MAX_BODY_LEN];
+static size_t echo_len;
+
+static struct http_client_conn conns[N_CONNS];
+static u8_t recv_bufs[N_CONNS][RECV_BUF_LEN];
+
+static int completed;
+
+static int hello_cb(struct http_server_conn *conn, enum http_server_event evt,
+		    const u8_t *data, size_t len)
+{
+	last_server_conn = conn;
+
+	if (evt != HTTP_SERVER_COMPLETE) {
+		return 0;
+	}
+
+	return http_server_respond(conn, 200, "text/plain", HELLO,
+				   sizeof(HELLO) - 1);
+}
+
+static int stream_cb(struct http_server_conn *conn, enum http_server_event evt,
+		     const u8_t *data, size_t len)
+{
+	int i, ret;
+
+	if (evt != HTTP_SERVER_COMPLETE) {
+		return 0;
+	}
+
+	ret = http_server_respond_begin(conn, 200, "text/plain");
+
+	for (i = 0; i < ARRAY_SIZE(parts) && ret == 0; i++) {
+		ret = http_server_respond_write(conn, parts[i],
+						strlen(parts[i]));
+	}
+
+	return ret;
+}
+
+static int echo_cb(struct http_server_conn *conn, enum http_server_event evt,
+		   const u8_t *data, size_t len)
+{
+	switch (evt) {
+	case HTTP_SERVER_REQUEST:
+		echo_len = 0;
+		break;
+	case HTTP_SERVER_BODY:
+		len = MIN(len, sizeof(echo_buf) - echo_len);
+		memcpy(echo_buf + echo_len, data, len);
+		echo_len += len;
+		break;
+	case HTTP_SERVER_COMPLETE:
+		return http_server_respond(conn, 200, NULL, echo_buf,
+					   echo_len);
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+static int url_cb(struct http_server_conn *conn, enum http_server_event evt,
+		  const u8_t *data, size_t len)
+{
+	if (evt != HTTP_SERVER_COMPLETE) {
+		return 0;
+	}
+
+	return http_server_respond(conn, 200, NULL, conn->url,
+				   strlen(conn->url));
+}
+
+static const struct http_server_resource resources[] = {
+	{ .path = "/hello", .cb = hello_cb },
+	{ .path = "/stream", .cb = stream_cb },
+	{ .path = "/echo", .cb = echo_cb },
+	{ .path = "/url/", .cb = url_cb, .prefix = true },
+};
+
+static void server_thread(void *p1, void *p2, void *p3)
+{
+	struct sockaddr_in addr = { 0 };
+	int ret;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(SERVER_PORT);
+	inet_pton(AF_INET, HOST, &addr.sin_addr);
+
+	ret = http_server_init(&server, (struct sockaddr *)&addr,
+			       sizeof(addr), resources, ARRAY_SIZE(resources));
+	zassert_equal(ret, 0, "Cannot start server (%d)", ret);
+
+	k_sem_give(&server_ready);
+
+	http_server_run(&server);
+}
+
+K_THREAD_DEFINE(http_server_thread, SERVER_STACK_SIZE, server_thread,
+		NULL, NULL, NULL, K_PRIO_PREEMPT(SERVER_PRIORITY), 0, K_NO_WAIT);
+
+static void body_cb(struct http_client_conn *conn, struct http_request *req,
+		    const u8_t *data, size_t len, bool final)
+{
+	struct response *rsp = req->user_data;
+
+	if (data) {
+		len = MIN(len, sizeof(rsp->body) - rsp->len);
+		memcpy(rsp->body + rsp->len, data, len);
+		rsp->len += len;
+	}
+
+	if (final) {
+		rsp->done = true;
+		rsp->order = completed++;
+	}
+}
+
+static void prepare(struct http_request *req, struct response *rsp,
+		    enum http_method method, const char *url)
+{
+	(void)memset(req, 0, sizeof(*req));
+	(void)memset(rsp, 0, sizeof(*rsp));
+
+	req->method = method;
+	req->url = url;
+	req->host = HOST;
+	req->body_cb = body_cb;
+	req->user_data = rsp;
+}
+
+static void expect_body(struct response *rsp, const char *body)
+{
+	zassert_true(rsp->done, "Response not complete");
+	zassert_equal(rsp->len, strlen(body), "Unexpected body length %d",
+		      rsp->len);
+	zassert_mem_equal(rsp->body, body, rsp->len, "Unexpected body");
+}
+
+static void connect_client(struct http_client_conn *conn, u8_t *buf)
+{
+	struct sockaddr_in addr = { 0 };
+	int sock, ret;
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(SERVER_PORT);
+	inet_pton(AF_INET, HOST, &addr.sin_addr);
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(sock >= 0, "socket open failed");
+
+	ret = connect(sock, (struct sockaddr *)&addr, sizeof(addr));
+	zassert_equal(ret, 0, "connect failed (%d)", errno);
+
+	http_client_init(conn, sock, buf, RECV_BUF_LEN);
+}
+
+static void test_setup(void)
+{
+	zassert_equal(k_sem_take(&server_ready, K_SECONDS(1)), 0,
+		      "Server not started");
+
+	connect_client(&conns[0], recv_bufs[0]);
+}
+
+static void test_keep_alive(void)
+{
+	struct http_server_conn *server_conn = NULL;
+	struct http_request req;
+	struct response rsp;
+	int i, ret;
+
+	for (i = 0; i < 3; i++) {
+		prepare(&req, &rsp, HTTP_GET, "/hello");
+
+		ret = http_client_request(&conns[0], &req, TIMEOUT);
+		zassert_equal(ret, 200, "Unexpected status %d", ret);
+		expect_body(&rsp, HELLO);
+
+		if (server_conn) {
+			zassert_equal_ptr(last_server_conn, server_conn,
+					  "Connection not reused");
+		}
+
+		server_conn = last_server_conn;
+	}
+
+	zassert_true(http_client_is_reusable(&conns[0]), "Connection closed");
+}
+
+static void test_head(void)
+{
+	struct http_request req;
+	struct response rsp;
+	int ret;
+
+	prepare(&req, &rsp, HTTP_HEAD, "/hello");
+
+	ret = http_client_request(&conns[0], &req, TIMEOUT);
+	zassert_equal(ret, 200, "Unexpected status %d", ret);
+	expect_body(&rsp, "");
+
+	/* The Content-Length of the response must not be waited for */
+	prepare(&req, &rsp, HTTP_GET, "/hello");
+
+	ret = http_client_request(&conns[0], &req, TIMEOUT);
+	zassert_equal(ret, 200, "Unexpected status %d", ret);
+	expect_body(&rsp, HELLO);
+}
+
+static void test_not_found(void)
+{
+	struct http_request req;
+	struct response rsp;
+	int ret;
+
+	prepare(&req, &rsp, HTTP_GET, "/missing");
+
+	ret = http_client_request(&conns[0], &req, TIMEOUT);
+	zassert_equal(ret, 404, "Unexpected status %d", ret);
+	zassert_true(http_client_is_reusable(&conns[0]), "Connection closed");
+}
+
+static void test_chunked_response(void)
+{
+	struct http_request req;
+	struct response rsp;
+	int ret;
+
+	prepare(&req, &rsp, HTTP_GET, "/stream");
+
+	ret = http_client_request(&conns[0], &req, TIMEOUT);
+	zassert_equal(ret, 200, "Unexpected status %d", ret);
+	expect_body(&rsp, PARTS_TEXT);
+}
+
+static int payload_cb(struct http_client_conn *conn, struct http_request *req,
+		      const u8_t **data)
+{
+	static int part;
+
+	if (part == ARRAY_SIZE(parts)) {
+		part = 0;
+		return 0;
+	}
+
+	*data = parts[part];
+
+	return strlen(parts[part++]);
+}
+
+static void test_chunked_request(void)
+{
+	struct http_request req;
+	struct response rsp;
+	int ret;
+
+	prepare(&req, &rsp, HTTP_POST, "/echo");
+	req.content_type = "text/plain";
+	req.payload_cb = payload_cb;
+
+	ret = http_client_request(&conns[0], &req, TIMEOUT);
+	zassert_equal(ret, 200, "Unexpected status %d", ret);
+	expect_body(&rsp, PARTS_TEXT);
+
+	prepare(&req, &rsp, HTTP_PUT, "/echo");
+	req.payload = HELLO;
+	req.payload_len = sizeof(HELLO) - 1;
+
+	ret = http_client_request(&conns[0], &req, TIMEOUT);
+	zassert_equal(ret, 200, "Unexpected status %d", ret);
+	expect_body(&rsp, HELLO);
+}
+
+static void test_pipelining(void)
+{
+	static const char * const urls[] = {
+		"/url/a", "/url/b?c=d", "/url/e", "/url/f"
+	};
+	struct http_request reqs[ARRAY_SIZE(urls)];
+	struct response rsps[ARRAY_SIZE(urls)];
+	int i, ret, done = 0;
+
+	BUILD_ASSERT(ARRAY_SIZE(urls) <= PIPELINE);
+
+	completed = 0;
+
+	for (i = 0; i < ARRAY_SIZE(urls); i++) {
+		prepare(&reqs[i], &rsps[i], HTTP_GET, urls[i]);
+
+		ret = http_client_send(&conns[0], &reqs[i]);
+		zassert_equal(ret, 0, "Cannot send request %d (%d)", i, ret);
+	}
+
+	while (done < ARRAY_SIZE(urls)) {
+		ret = http_client_process(&conns[0], TIMEOUT);
+		zassert_true(ret >= 0, "Cannot receive responses (%d)", ret);
+		done += ret;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(urls); i++) {
+		zassert_equal(reqs[i].status, 200, "Unexpected status");
+		zassert_equal(rsps[i].order, i, "Response out of order");
+		expect_body(&rsps[i], urls[i]);
+	}
+}
+
+static void test_connection_close(void)
+{
+	struct http_client_conn conn;
+	u8_t buf[RECV_BUF_LEN];
+	struct http_request req;
+	struct response rsp;
+	int ret;
+
+	connect_client(&conn, buf);
+
+	prepare(&req, &rsp, HTTP_GET, "/hello");
+	req.headers = "Connection: close\r\n";
+
+	ret = http_client_request(&conn, &req, TIMEOUT);
+	zassert_equal(ret, 200, "Unexpected status %d", ret);
+	expect_body(&rsp, HELLO);
+
+	zassert_false(http_client_is_reusable(&conn), "Connection reusable");
+	zassert_equal(http_client_send(&conn, &req), -ENOTCONN,
+		      "Request sent on closed connection");
+
+	close(conn.sock);
+}
+
+/* Keep every connection busy with pipelined requests */
+static void test_load(void)
+{
+	static struct http_request reqs[N_CONNS][PIPELINE];
+	static struct response rsps[N_CONNS][PIPELINE];
+	int sent[N_CONNS] = { 0 };
+	int done[N_CONNS] = { 0 };
+	int total = 0;
+	u32_t start, elapsed;
+	int i, slot, ret;
+
+	for (i = 1; i < N_CONNS; i++) {
+		connect_client(&conns[i], recv_bufs[i]);
+	}
+
+	start = k_uptime_get_32();
+
+	while (total < N_CONNS * LOAD_REQUESTS) {
+		for (i = 0; i < N_CONNS; i++) {
+			while (sent[i] < LOAD_REQUESTS &&
+			       sent[i] - done[i] < PIPELINE) {
+				slot = sent[i] % PIPELINE;
+
+				prepare(&reqs[i][slot], &rsps[i][slot],
+					HTTP_GET, "/hello");
+
+				ret = http_client_send(&conns[i],
+						       &reqs[i][slot]);
+				zassert_equal(ret, 0, "Cannot send (%d)", ret);
+
+				sent[i]++;
+			}
+		}
+
+		for (i = 0; i < N_CONNS; i++) {
+			if (done[i] == sent[i]) {
+				continue;
+			}
+
+			ret = http_client_process(&conns[i], TIMEOUT);
+			zassert_true(ret >= 0, "Cannot receive (%d)", ret);
+
+			done[i] += ret;
+			total += ret;
+		}
+	}
+
+	elapsed = k_uptime_get_32() - start;
+
+	for (i = 0; i < N_CONNS; i++) {
+		zassert_true(http_client_is_reusable(&conns[i]),
+			     "Connection %d closed", i);
+		close(conns[i].sock);
+	}
+
+	TC_PRINT("%d connections, %d requests in %u ms, %u requests/s\n",
+		 N_CONNS, total, elapsed,
+		 (u32_t)(total * MSEC_PER_SEC / MAX(elapsed, 1U)));
+}
+
+void test_main(void)
+{
+	ztest_test_suite(http,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_keep_alive),
+			 ztest_unit_test(test_head),
+			 ztest_unit_test(test_not_found),
+			 ztest_unit_test(test_chunked_response),
+			 ztest_unit_test(test_chunked_request),
+			 ztest_unit_test(test_pipelining),
+			 ztest_unit_test(test_connection_close),
+			 ztest_unit_test(test_load));
+
+	ztest_run_test_suite(http);
+}
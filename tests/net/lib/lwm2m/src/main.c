@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_LWM2M_LOG_LEVEL);
+
+#include <stdio.h>
+#include <ztest.h>
+
+#include <net/lwm2m.h>
+
+#include "lwm2m_engine.h"
+
+/* server.c */
+extern void test_server_start(void);
+extern void test_senml_cbor_write(void);
+extern void test_senml_cbor_write_errors(void);
+extern void test_notify_window(void);
+extern void test_server_stop(void);
+
+#define TEMP_SENSOR_ID 3303
+#define INSTANCE_COUNT CONFIG_LWM2M_IPSO_TEMP_SENSOR_INSTANCE_COUNT
+
+static char path[32];
+
+static char *inst_path(int obj_inst_id)
+{
+	snprintf(path, sizeof(path), "%u/%d", TEMP_SENSOR_ID, obj_inst_id);
+
+	return path;
+}
+
+static char *value_path(int obj_inst_id)
+{
+	snprintf(path, sizeof(path), "%u/%d/5700", TEMP_SENSOR_ID,
+		 obj_inst_id);
+
+	return path;
+}
+
+static void set_value(int obj_inst_id, s32_t val)
+{
+	float32_value_t value = { .val1 = val };
+
+	zassert_equal(lwm2m_engine_set_float32(value_path(obj_inst_id),
+					       &value), 0,
+		      "Cannot set value");
+}
+
+static s32_t get_value(int obj_inst_id)
+{
+	float32_value_t value;
+
+	zassert_equal(lwm2m_engine_get_float32(value_path(obj_inst_id),
+					       &value), 0,
+		      "Cannot get value");
+
+	return value.val1;
+}
+
+static void test_index(void)
+{
+	float32_value_t value;
+	int i;
+
+	/* More instances than buckets, so that they share them */
+	for (i = 0; i < INSTANCE_COUNT; i++) {
+		zassert_equal(lwm2m_engine_create_obj_inst(inst_path(i)), 0,
+			      "Cannot create instance");
+	}
+
+	zassert_not_equal(lwm2m_engine_create_obj_inst(inst_path(0)), 0,
+			  "Instance created twice");
+
+	for (i = 0; i < INSTANCE_COUNT; i++) {
+		set_value(i, 100 + i);
+	}
+
+	for (i = 0; i < INSTANCE_COUNT; i++) {
+		zassert_equal(get_value(i), 100 + i, "Wrong instance found");
+	}
+
+	/* Only the deleted instance is gone from its bucket */
+	zassert_equal(lwm2m_delete_obj_inst(TEMP_SENSOR_ID, 1), 0,
+		      "Cannot delete instance");
+
+	zassert_equal(lwm2m_engine_get_float32(value_path(1), &value),
+		      -ENOENT, "Deleted instance found");
+
+	for (i = 0; i < INSTANCE_COUNT; i++) {
+		if (i != 1) {
+			zassert_equal(get_value(i), 100 + i,
+				      "Wrong instance found");
+		}
+	}
+
+	zassert_equal(lwm2m_engine_create_obj_inst(inst_path(1)), 0,
+		      "Cannot create instance again");
+	set_value(1, 101);
+}
+
+static void test_path_handle(void)
+{
+	struct lwm2m_path_handle handle;
+	float32_value_t value = { .val1 = 42 };
+
+	zassert_equal(lwm2m_engine_path_handle_init("3303/0", &handle),
+		      -EINVAL, "Handle to an object instance");
+
+	zassert_not_equal(lwm2m_engine_path_handle_init("3303/99/5700",
+							&handle), 0,
+			  "Handle to a missing instance");
+
+	zassert_not_equal(lwm2m_engine_path_handle_init("3303/0/9999",
+							&handle), 0,
+			  "Handle to a missing resource");
+
+	zassert_equal(lwm2m_engine_path_handle_init(value_path(2), &handle),
+		      0, "Cannot init handle");
+
+	/* Values written through the handle are seen through the path */
+	zassert_equal(lwm2m_engine_set_by_handle(&handle, &value,
+						 sizeof(value)), 0,
+		      "Cannot set by handle");
+	zassert_equal(get_value(2), 42, "Value not set by handle");
+
+	/* And the other way round */
+	set_value(2, 43);
+
+	(void)memset(&value, 0, sizeof(value));
+	zassert_equal(lwm2m_engine_get_by_handle(&handle, &value,
+						 sizeof(value)), 0,
+		      "Cannot get by handle");
+	zassert_equal(value.val1, 43, "Wrong value got by handle");
+
+	/* The other instances are left alone */
+	zassert_equal(get_value(3), 103, "Wrong instance set by handle");
+}
+
+static void test_path_handle_generation(void)
+{
+	struct lwm2m_path_handle handle;
+	float32_value_t value;
+
+	zassert_equal(lwm2m_engine_path_handle_init(value_path(4), &handle),
+		      0, "Cannot init handle");
+
+	/* Changes of other instances do not invalidate the handle */
+	zassert_equal(lwm2m_delete_obj_inst(TEMP_SENSOR_ID, 0), 0,
+		      "Cannot delete instance");
+
+	zassert_equal(lwm2m_engine_get_by_handle(&handle, &value,
+						 sizeof(value)), 0,
+		      "Handle lost by deleting another instance");
+	zassert_equal(value.val1, 104, "Wrong value got by handle");
+
+	/* Its own instance is recreated in the storage freed by the first
+	 * one, the handle must not keep using the old storage.
+	 */
+	zassert_equal(lwm2m_delete_obj_inst(TEMP_SENSOR_ID, 4), 0,
+		      "Cannot delete instance");
+	zassert_equal(lwm2m_engine_create_obj_inst(inst_path(4)), 0,
+		      "Cannot create instance again");
+	set_value(4, 204);
+
+	zassert_equal(lwm2m_engine_get_by_handle(&handle, &value,
+						 sizeof(value)), 0,
+		      "Cannot get by handle");
+	zassert_equal(value.val1, 204, "Stale instance used by handle");
+
+	/* Deleted instances are not reachable through their handle */
+	zassert_equal(lwm2m_delete_obj_inst(TEMP_SENSOR_ID, 4), 0,
+		      "Cannot delete instance");
+
+	zassert_equal(lwm2m_engine_get_by_handle(&handle, &value,
+						 sizeof(value)), -ENOENT,
+		      "Deleted instance got by handle");
+	zassert_equal(lwm2m_engine_set_by_handle(&handle, &value,
+						 sizeof(value)), -ENOENT,
+		      "Deleted instance set by handle");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lwm2m_engine,
+			 ztest_unit_test(test_index),
+			 ztest_unit_test(test_path_handle),
+			 ztest_unit_test(test_path_handle_generation),
+			 ztest_unit_test(test_server_start),
+			 ztest_unit_test(test_senml_cbor_write),
+			 ztest_unit_test(test_senml_cbor_write_errors),
+			 ztest_unit_test(test_notify_window),
+			 ztest_unit_test(test_server_stop));
+
+	ztest_run_test_suite(lwm2m_engine);
+}
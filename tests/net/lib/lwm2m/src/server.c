@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Tests going through the requests of an LwM2M server, the test being the
+ * server of a client context of the engine over the loopback interface.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_test, CONFIG_LWM2M_LOG_LEVEL);
+
+#include <ztest.h>
+
+#include <net/socket.h>
+#include <net/coap.h>
+#include <net/lwm2m.h>
+
+#include "lwm2m_engine.h"
+
+#define SERVER_ADDR "127.0.0.1"
+#define SERVER_PORT 5683
+#define SERVER_URL "coap://" SERVER_ADDR ":5683"
+
+#define LIGHT_CONTROL_ID 3311
+#define TEMP_SENSOR_ID 3303
+
+#define NOTIFY_WINDOW_MS CONFIG_LWM2M_ENGINE_NOTIFY_WINDOW_MS
+
+/* Engine service period, by which the notifications may be late */
+#define SERVICE_PERIOD_MS 500
+
+#define RESPONSE_WAIT_MS 2000
+#define MAX_OPTIONS 8
+
+static struct lwm2m_ctx client_ctx;
+static struct sockaddr_in client_addr;
+static int sock;
+
+static u8_t token[] = { 0x01, 0x02, 0x03, 0x04 };
+static u16_t next_id = 1U;
+
+static u8_t recv_buf[512];
+static struct coap_packet recv_pkt;
+
+/*
+ * [ { bn: "/3311/0/", n: "5850", vb: true },
+ *   { n: "5851", v: 42 },
+ *   { n: "5706", vs: "red" } ]
+ */
+static const u8_t light_pack[] = {
+	0x83,
+	0xa3, 0x21, 0x68, '/', '3', '3', '1', '1', '/', '0', '/',
+	0x00, 0x64, '5', '8', '5', '0', 0x04, 0xf5,
+	0xa2, 0x00, 0x64, '5', '8', '5', '1', 0x02, 0x18, 0x2a,
+	0xa2, 0x00, 0x64, '5', '7', '0', '6', 0x03, 0x63, 'r', 'e', 'd',
+};
+
+/* [ { bn: "/3311/0/", n: "5805", v: 1 } ] for a read-only resource */
+static const u8_t read_only_pack[] = {
+	0x81,
+	0xa3, 0x21, 0x68, '/', '3', '3', '1', '1', '/', '0', '/',
+	0x00, 0x64, '5', '8', '0', '5', 0x02, 0x01,
+};
+
+/* A record cut in the middle of its name */
+static const u8_t truncated_pack[] = {
+	0x81,
+	0xa2, 0x00, 0x64, '5', '8',
+};
+
+static void send_msg(struct coap_packet *cpkt)
+{
+	zassert_equal(send(sock, cpkt->data, cpkt->offset, 0), cpkt->offset,
+		      "send failed");
+}
+
+static int recv_msg(s32_t timeout)
+{
+	struct coap_option options[MAX_OPTIONS];
+	struct pollfd pfd = {
+		.fd = sock,
+		.events = POLLIN,
+	};
+	ssize_t len;
+
+	if (poll(&pfd, 1, timeout) != 1) {
+		return -EAGAIN;
+	}
+
+	len = recv(sock, recv_buf, sizeof(recv_buf), 0);
+	zassert_true(len > 0, "recv failed");
+
+	zassert_equal(coap_packet_parse(&recv_pkt, recv_buf, len, options,
+					MAX_OPTIONS), 0,
+		      "Invalid CoAP message");
+
+	return 0;
+}
+
+/* Send a request, the path being a string such as "3311/0", and return the
+ * response code.
+ */
+static u8_t request(u8_t method, char *path, int observe, const char *query,
+		    u16_t format, u16_t accept, const u8_t *payload,
+		    u16_t payload_len)
+{
+	struct coap_packet cpkt;
+	u8_t buf[256];
+	u16_t id = next_id++;
+	char *segment, *end;
+
+	zassert_equal(coap_packet_init(&cpkt, buf, sizeof(buf), 1,
+				       COAP_TYPE_CON, sizeof(token), token,
+				       method, id), 0,
+		      "Cannot init request");
+
+	if (observe >= 0) {
+		zassert_equal(coap_append_option_int(&cpkt,
+						     COAP_OPTION_OBSERVE,
+						     observe), 0,
+			      "Cannot append observe");
+	}
+
+	for (segment = path; *segment; segment = end) {
+		end = strchr(segment, '/');
+		if (!end) {
+			end = segment + strlen(segment);
+		}
+
+		zassert_equal(coap_packet_append_option(&cpkt,
+							COAP_OPTION_URI_PATH,
+							(u8_t *)segment,
+							end - segment), 0,
+			      "Cannot append path");
+
+		if (*end) {
+			end++;
+		}
+	}
+
+	if (format != LWM2M_FORMAT_NONE) {
+		zassert_equal(coap_append_option_int(&cpkt,
+						     COAP_OPTION_CONTENT_FORMAT,
+						     format), 0,
+			      "Cannot append content format");
+	}
+
+	if (query) {
+		zassert_equal(coap_packet_append_option(&cpkt,
+							COAP_OPTION_URI_QUERY,
+							(u8_t *)query,
+							strlen(query)), 0,
+			      "Cannot append query");
+	}
+
+	if (accept != LWM2M_FORMAT_NONE) {
+		zassert_equal(coap_append_option_int(&cpkt,
+						     COAP_OPTION_ACCEPT,
+						     accept), 0,
+			      "Cannot append accept");
+	}
+
+	if (payload_len > 0) {
+		zassert_equal(coap_packet_append_payload_marker(&cpkt), 0,
+			      "Cannot append payload marker");
+		zassert_equal(coap_packet_append_payload(&cpkt,
+							 (u8_t *)payload,
+							 payload_len), 0,
+			      "Cannot append payload");
+	}
+
+	send_msg(&cpkt);
+
+	zassert_equal(recv_msg(RESPONSE_WAIT_MS), 0, "No response");
+	zassert_equal(coap_header_get_type(&recv_pkt), COAP_TYPE_ACK,
+		      "Response is not piggybacked");
+	zassert_equal(coap_header_get_id(&recv_pkt), id,
+		      "Response to another request");
+
+	return coap_header_get_code(&recv_pkt);
+}
+
+static void send_ack(u16_t id)
+{
+	struct coap_packet cpkt;
+	u8_t buf[8];
+
+	zassert_equal(coap_packet_init(&cpkt, buf, sizeof(buf), 1,
+				       COAP_TYPE_ACK, 0, NULL,
+				       COAP_CODE_EMPTY, id), 0,
+		      "Cannot init ACK");
+
+	send_msg(&cpkt);
+}
+
+static void set_temperature(int obj_inst_id, s32_t val)
+{
+	float32_value_t value = { .val1 = val };
+	char path[MAX_RESOURCE_LEN];
+
+	snprintk(path, sizeof(path), "%u/%d/5700", TEMP_SENSOR_ID,
+		 obj_inst_id);
+
+	zassert_equal(lwm2m_engine_set_float32(path, &value), 0,
+		      "Cannot set temperature");
+}
+
+void test_server_start(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+	};
+	socklen_t addrlen = sizeof(client_addr);
+	char path[MAX_RESOURCE_LEN];
+
+	zassert_equal(inet_pton(AF_INET, SERVER_ADDR, &addr.sin_addr), 1,
+		      "inet_pton failed");
+
+	snprintk(path, sizeof(path), "%u/0", LIGHT_CONTROL_ID);
+	zassert_equal(lwm2m_engine_create_obj_inst(path), 0,
+		      "Cannot create light control");
+
+	zassert_equal(lwm2m_engine_set_string("0/0/0", SERVER_URL), 0,
+		      "Cannot set server URL");
+
+	sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(sock >= 0, "socket open failed");
+
+	zassert_equal(bind(sock, (struct sockaddr *)&addr, sizeof(addr)), 0,
+		      "bind failed");
+
+	(void)memset(&client_ctx, 0, sizeof(client_ctx));
+	client_ctx.sec_obj_inst = 0;
+
+	zassert_equal(lwm2m_engine_start(&client_ctx), 0,
+		      "Cannot start engine");
+
+	zassert_equal(getsockname(client_ctx.sock_fd,
+				  (struct sockaddr *)&client_addr, &addrlen),
+		      0, "getsockname failed");
+	client_addr.sin_addr = addr.sin_addr;
+
+	zassert_equal(connect(sock, (struct sockaddr *)&client_addr,
+			      sizeof(client_addr)), 0,
+		      "connect failed");
+}
+
+void test_senml_cbor_write(void)
+{
+	char colour[8];
+	bool on_off;
+	u8_t dimmer;
+	u8_t code;
+
+	code = request(COAP_METHOD_PUT, "3311/0", -1, NULL,
+		       LWM2M_FORMAT_APP_SENML_CBOR, LWM2M_FORMAT_NONE,
+		       light_pack, sizeof(light_pack));
+	zassert_equal(code, COAP_RESPONSE_CODE_CHANGED, "Write failed");
+
+	zassert_equal(lwm2m_engine_get_bool("3311/0/5850", &on_off), 0,
+		      "Cannot get on/off");
+	zassert_true(on_off, "Boolean value not written");
+
+	zassert_equal(lwm2m_engine_get_u8("3311/0/5851", &dimmer), 0,
+		      "Cannot get dimmer");
+	zassert_equal(dimmer, 42, "Numeric value not written");
+
+	zassert_equal(lwm2m_engine_get_string("3311/0/5706", colour,
+					      sizeof(colour)), 0,
+		      "Cannot get colour");
+	zassert_true(strcmp(colour, "red") == 0, "String value not written");
+}
+
+void test_senml_cbor_write_errors(void)
+{
+	u8_t code;
+
+	code = request(COAP_METHOD_PUT, "3311/0/5805", -1, NULL,
+		       LWM2M_FORMAT_APP_SENML_CBOR, LWM2M_FORMAT_NONE,
+		       read_only_pack, sizeof(read_only_pack));
+	zassert_equal(code, COAP_RESPONSE_CODE_NOT_ALLOWED,
+		      "Read-only resource written");
+
+	code = request(COAP_METHOD_PUT, "3311/0/5850", -1, NULL,
+		       LWM2M_FORMAT_APP_SENML_CBOR, LWM2M_FORMAT_NONE,
+		       truncated_pack, sizeof(truncated_pack));
+	zassert_not_equal(code, COAP_RESPONSE_CODE_CHANGED,
+			  "Truncated pack accepted");
+}
+
+/* Changes several sensors at once, and checks that a single notification
+ * is sent once the window is over.
+ */
+static void notify_burst(s32_t base)
+{
+	s64_t start, elapsed = 0;
+	int count = 0;
+	int i;
+
+	start = k_uptime_get();
+
+	for (i = 1; i <= 3; i++) {
+		set_temperature(i, base + i);
+	}
+
+	while (recv_msg(NOTIFY_WINDOW_MS + 2 * SERVICE_PERIOD_MS) == 0) {
+		zassert_equal(coap_header_get_code(&recv_pkt),
+			      COAP_RESPONSE_CODE_CONTENT,
+			      "Not a notification");
+
+		if (coap_header_get_type(&recv_pkt) == COAP_TYPE_CON) {
+			send_ack(coap_header_get_id(&recv_pkt));
+		}
+
+		if (count++ == 0) {
+			elapsed = k_uptime_get() - start;
+		}
+	}
+
+	zassert_equal(count, 1, "Changes not gathered in one notification");
+	zassert_true(elapsed >= NOTIFY_WINDOW_MS,
+		     "Notification sent before the end of the window");
+}
+
+void test_notify_window(void)
+{
+	u8_t code;
+
+	/* Notify as soon as the window allows it */
+	code = request(COAP_METHOD_PUT, "3303", -1, "pmin=0",
+		       LWM2M_FORMAT_NONE, LWM2M_FORMAT_NONE, NULL, 0);
+	zassert_equal(code, COAP_RESPONSE_CODE_CHANGED,
+		      "Cannot write attributes");
+
+	code = request(COAP_METHOD_GET, "3303", 0, NULL, LWM2M_FORMAT_NONE,
+		       LWM2M_FORMAT_APP_SENML_CBOR, NULL, 0);
+	zassert_equal(code, COAP_RESPONSE_CODE_CONTENT, "Cannot observe");
+
+	/* The window opens again with the next change */
+	notify_burst(10);
+	notify_burst(20);
+}
+
+void test_server_stop(void)
+{
+	zassert_equal(lwm2m_engine_context_close(&client_ctx), 0,
+		      "Cannot close engine context");
+	zassert_equal(close(sock), 0, "close failed");
+}
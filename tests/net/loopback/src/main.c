@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#include <net/net_core.h>
+#include <net/net_if.h>
+#include <net/net_ip.h>
+#include <net/net_pkt.h>
+#include <net/dummy.h>
+
+#define BURST_LEN 2
+
+static struct in_addr src_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr dst_addr = { { { 192, 0, 2, 2 } } };
+
+static struct net_if *lo_iface;
+
+static struct net_pkt *prepare_pkt(void)
+{
+	struct net_ipv4_hdr hdr = { 0 };
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(lo_iface, sizeof(hdr), AF_INET,
+					IPPROTO_UDP, K_NO_WAIT);
+	zassert_not_null(pkt, "Pkt not allocated");
+
+	hdr.vhl = 0x45;
+	hdr.ttl = 64U;
+	hdr.proto = IPPROTO_UDP;
+	hdr.len = htons(sizeof(hdr));
+	net_ipaddr_copy(&hdr.src, &src_addr);
+	net_ipaddr_copy(&hdr.dst, &dst_addr);
+
+	zassert_equal(net_pkt_write(pkt, &hdr, sizeof(hdr)), 0,
+		      "Cannot write header");
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
+static void check_untouched(struct net_pkt *pkt)
+{
+	zassert_true(net_ipv4_addr_cmp(&NET_IPV4_HDR(pkt)->src, &src_addr),
+		     "Source address modified");
+	zassert_true(net_ipv4_addr_cmp(&NET_IPV4_HDR(pkt)->dst, &dst_addr),
+		     "Destination address modified");
+}
+
+void test_burst_clone_failure(void)
+{
+	static struct net_pkt *held[CONFIG_NET_PKT_TX_COUNT];
+	struct net_pkt *pkts[BURST_LEN];
+	struct k_mem_slab *rx, *tx;
+	struct net_buf_pool *rx_data, *tx_data;
+	const struct dummy_api *api;
+	struct device *dev;
+	int i, count = 0;
+
+	lo_iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(lo_iface, "No loopback interface");
+
+	dev = net_if_get_device(lo_iface);
+	api = dev->driver_api;
+	zassert_not_null(api->send_burst, "No burst support");
+
+	for (i = 0; i < BURST_LEN; i++) {
+		pkts[i] = prepare_pkt();
+	}
+
+	/* Leave room for a single clone, so the second one of the burst
+	 * fails.
+	 */
+	net_pkt_get_info(&rx, &tx, &rx_data, &tx_data);
+
+	while (k_mem_slab_num_free_get(tx) > 1) {
+		held[count] = net_pkt_alloc(K_NO_WAIT);
+		zassert_not_null(held[count], "Pkt not allocated");
+		count++;
+	}
+
+	zassert_equal(api->send_burst(dev, pkts, BURST_LEN), 1,
+		      "Wrong number of packets sent");
+
+	/* The L2 sends the rest of the burst again, one by one, so none of
+	 * the packets may have been modified.
+	 */
+	for (i = 0; i < BURST_LEN; i++) {
+		check_untouched(pkts[i]);
+	}
+
+	for (i = 0; i < count; i++) {
+		net_pkt_unref(held[i]);
+	}
+
+	/* Let the clone of the first packet go through the Rx path */
+	k_yield();
+
+	zassert_equal(api->send(dev, pkts[1]), 0, "Packet not sent");
+	check_untouched(pkts[1]);
+
+	for (i = 0; i < BURST_LEN; i++) {
+		net_pkt_unref(pkts[i]);
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_loopback,
+			 ztest_unit_test(test_burst_clone_failure));
+
+	ztest_run_test_suite(net_loopback);
+}
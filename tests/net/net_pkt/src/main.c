@@ -12,6 +12,7 @@
 #include <net/net_if.h>
 #include <net/net_ip.h>
 #include <net/ethernet.h>
+#include <net/net_context.h>
 
 #include <ztest.h>
 
@@ -629,6 +630,181 @@ void test_net_pkt_copy(void)
 		     "Pkt not properly unreferenced");
 }
 
+#if defined(CONFIG_NET_BUF_SIZE_CLASSES)
+struct class_check {
+	struct net_buf_pool *pool;
+	u16_t data_size;
+};
+
+static void find_data_size(struct net_pkt_pool_stats *stats, void *user_data)
+{
+	struct class_check *check = user_data;
+
+	if (stats->pool == check->pool) {
+		check->data_size = stats->data_size;
+	}
+}
+
+static u16_t buf_class_size(struct net_buf *buf)
+{
+	struct class_check check = {
+		.pool = net_buf_pool_get(buf->pool_id),
+	};
+
+	net_pkt_pool_stats_foreach(find_data_size, &check);
+
+	return check.data_size;
+}
+#endif /* CONFIG_NET_BUF_SIZE_CLASSES */
+
+void test_net_pkt_size_classes(void)
+{
+#if defined(CONFIG_NET_BUF_SIZE_CLASSES)
+	struct net_pkt *pkt;
+	struct net_buf *buf;
+
+	/* A small packet takes a small buffer */
+	pkt = net_pkt_alloc_with_buffer(eth_if, 40, AF_UNSPEC, 0, K_NO_WAIT);
+	zassert_true(pkt != NULL, "Pkt not allocated");
+	zassert_true(pkt_is_of_size(pkt, 40), "Pkt size is not right");
+	zassert_equal(buf_class_size(pkt->buffer),
+		      CONFIG_NET_BUF_SMALL_DATA_SIZE, "Wrong size class");
+	zassert_is_null(pkt->buffer->frags, "Too many buffers");
+
+	net_pkt_unref(pkt);
+
+	/* One regular buffer takes less memory than two small ones */
+	pkt = net_pkt_alloc_with_buffer(eth_if, CONFIG_NET_BUF_DATA_SIZE - 8,
+					AF_UNSPEC, 0, K_NO_WAIT);
+	zassert_true(pkt != NULL, "Pkt not allocated");
+	zassert_equal(buf_class_size(pkt->buffer), CONFIG_NET_BUF_DATA_SIZE,
+		      "Wrong size class");
+	zassert_is_null(pkt->buffer->frags, "Too many buffers");
+
+	net_pkt_unref(pkt);
+
+	/* A big packet fills large buffers, the rest goes to the best
+	 * fitting class.
+	 */
+	pkt = net_pkt_alloc_with_buffer(eth_if,
+					CONFIG_NET_BUF_LARGE_DATA_SIZE + 20,
+					AF_UNSPEC, 0, K_NO_WAIT);
+	zassert_true(pkt != NULL, "Pkt not allocated");
+	zassert_true(pkt_is_of_size(pkt, CONFIG_NET_BUF_LARGE_DATA_SIZE + 20),
+		     "Pkt size is not right");
+
+	buf = pkt->buffer;
+	zassert_equal(buf_class_size(buf), CONFIG_NET_BUF_LARGE_DATA_SIZE,
+		      "Wrong size class");
+	buf = buf->frags;
+	zassert_not_null(buf, "Missing buffer");
+	zassert_equal(buf_class_size(buf), CONFIG_NET_BUF_SMALL_DATA_SIZE,
+		      "Wrong size class");
+	zassert_is_null(buf->frags, "Too many buffers");
+
+	net_pkt_unref(pkt);
+#else
+	ztest_test_skip();
+#endif /* CONFIG_NET_BUF_SIZE_CLASSES */
+}
+
+#if defined(CONFIG_NET_PKT_QUOTA)
+static int quota_writable_called;
+
+static void quota_writable_cb(struct net_context *context)
+{
+	quota_writable_called++;
+}
+#endif
+
+void test_net_pkt_quota(void)
+{
+#if defined(CONFIG_NET_PKT_QUOTA)
+	struct net_pkt_quota *quota = &eth_if->mem_quota;
+	u32_t limit = quota->limit;
+	struct net_context *ctx;
+	struct net_pkt *pkt1, *pkt2;
+	u32_t sndbuf = 100U;
+	int ret;
+
+	net_pkt_quota_set_limit(quota, 300);
+
+	/* The interface quota is charged with the allocated data */
+	pkt1 = net_pkt_alloc_with_buffer(eth_if, 200, AF_UNSPEC, 0,
+					 K_NO_WAIT);
+	zassert_true(pkt1 != NULL, "Pkt not allocated");
+	zassert_equal(net_pkt_quota_used(quota), 200, "Wrong quota usage");
+
+	/* And the allocations over the limit are refused */
+	pkt2 = net_pkt_alloc_with_buffer(eth_if, 200, AF_UNSPEC, 0,
+					 K_NO_WAIT);
+	zassert_is_null(pkt2, "Pkt allocated over the quota");
+	zassert_equal(atomic_get(&quota->exceeded), 1,
+		      "Quota excess not counted");
+
+	pkt2 = net_pkt_alloc_with_buffer(eth_if, 100, AF_UNSPEC, 0,
+					 K_NO_WAIT);
+	zassert_true(pkt2 != NULL, "Pkt not allocated");
+
+	net_pkt_unref(pkt1);
+	zassert_equal(net_pkt_quota_used(quota), 100, "Quota not released");
+
+	net_pkt_unref(pkt2);
+	zassert_equal(net_pkt_quota_used(quota), 0, "Quota not released");
+
+	net_pkt_quota_set_limit(quota, limit);
+
+	/* The data sent via a context is charged to the context too */
+	ret = net_context_get(AF_INET, SOCK_DGRAM, IPPROTO_UDP, &ctx);
+	zassert_equal(ret, 0, "Context not allocated");
+
+	ret = net_context_set_option(ctx, NET_OPT_SNDBUF, &sndbuf,
+				     sizeof(sndbuf));
+	zassert_equal(ret, 0, "Cannot set the send quota");
+
+	pkt1 = net_pkt_alloc_on_iface(eth_if, K_NO_WAIT);
+	zassert_true(pkt1 != NULL, "Pkt not allocated");
+	net_pkt_set_context(pkt1, ctx);
+
+	ret = net_pkt_alloc_buffer(pkt1, 80, 0, K_NO_WAIT);
+	zassert_equal(ret, 0, "Buffer not allocated");
+	zassert_equal(net_pkt_quota_used(&ctx->tx_quota), 80,
+		      "Wrong quota usage");
+
+	pkt2 = net_pkt_alloc_on_iface(eth_if, K_NO_WAIT);
+	zassert_true(pkt2 != NULL, "Pkt not allocated");
+	net_pkt_set_context(pkt2, ctx);
+
+	net_context_set_writable_cb(ctx, quota_writable_cb);
+
+	/* Even with a timeout, as the sender holds the context lock */
+	ret = net_pkt_alloc_buffer(pkt2, 80, 0, K_SECONDS(1));
+	zassert_equal(ret, -ENOBUFS, "Buffer allocated over the quota");
+	zassert_equal(net_pkt_quota_used(quota), 80,
+		      "Interface charged for a refused allocation");
+	zassert_true(net_pkt_quota_is_full(&ctx->tx_quota),
+		     "Refused allocation not recorded");
+	zassert_false(net_context_is_writable(ctx), "Context writable");
+
+	/* Freeing the charged data wakes up the sender */
+	net_pkt_unref(pkt1);
+	zassert_equal(quota_writable_called, 1, "Writable cb not called");
+	zassert_false(net_pkt_quota_is_full(&ctx->tx_quota),
+		      "Quota still full");
+
+	ret = net_pkt_alloc_buffer(pkt2, 80, 0, K_NO_WAIT);
+	zassert_equal(ret, 0, "Buffer not allocated");
+
+	net_pkt_unref(pkt2);
+	zassert_equal(net_pkt_quota_used(&ctx->tx_quota), 0,
+		      "Quota not released");
+
+	net_context_put(ctx);
+#else
+	ztest_test_skip();
+#endif /* CONFIG_NET_PKT_QUOTA */
+}
+
 void test_main(void)
 {
 	eth_if = net_if_get_default();
@@ -639,7 +815,9 @@ void test_main(void)
 			 ztest_unit_test(test_net_pkt_basics_of_rw),
 			 ztest_unit_test(test_net_pkt_advanced_basics),
 			 ztest_unit_test(test_net_pkt_easier_rw_usage),
-			 ztest_unit_test(test_net_pkt_copy)
+			 ztest_unit_test(test_net_pkt_copy),
+			 ztest_unit_test(test_net_pkt_size_classes),
+			 ztest_unit_test(test_net_pkt_quota)
 		);
 
 	ztest_run_test_suite(net_pkt_tests);
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <errno.h>
+#include <device.h>
+#include <ptp_clock.h>
+#include <net/gptp.h>
+
+#include "gptp_messages.h"
+#include "gptp_data_set.h"
+#include "gptp_state.h"
+#include "gptp_private.h"
+
+#include <ztest.h>
+
+/* The simulated grandmaster runs 50 ppm faster than the cycle counter,
+ * 10 s ahead of the local clock.
+ */
+#define GM_PPB 50000
+#define GM_START (10ULL * NSEC_PER_SEC)
+
+#define SYNC_INTERVAL K_MSEC(125)
+
+static struct device *clk;
+
+/* Reference time derived from the cycle counter */
+static u32_t ref_cycles;
+static double ref_ns;
+
+static void ref_start(void)
+{
+	ref_cycles = k_cycle_get_32();
+	ref_ns = 0;
+}
+
+static double ref_update(void)
+{
+	u32_t now = k_cycle_get_32();
+
+	ref_ns += (double)(now - ref_cycles) * NSEC_PER_SEC /
+		  sys_clock_hw_cycles_per_sec();
+	ref_cycles = now;
+
+	return ref_ns;
+}
+
+static u64_t clk_ns(void)
+{
+	struct net_ptp_time tm;
+
+	zassert_equal(ptp_clock_get(clk, &tm), 0, "Cannot get time");
+
+	return gptp_timestamp_to_nsec(&tm);
+}
+
+static void test_setup(void)
+{
+	clk = device_get_binding(CONFIG_PTP_CLOCK_SOFT_NAME);
+	zassert_not_null(clk, "No software PTP clock");
+}
+
+static void test_set_get(void)
+{
+	struct net_ptp_time tm = {
+		.second = 1000,
+		.nanosecond = 500,
+	};
+	s64_t elapsed;
+	u64_t start;
+
+	zassert_equal(ptp_clock_set(clk, &tm), 0, "Cannot set time");
+
+	start = clk_ns();
+	zassert_true(start >= 1000ULL * NSEC_PER_SEC + 500,
+		     "Time not set");
+
+	ref_start();
+	k_sleep(K_MSEC(100));
+
+	elapsed = clk_ns() - start - (s64_t)ref_update();
+	zassert_true(elapsed > -NSEC_PER_USEC && elapsed < NSEC_PER_USEC,
+		     "Clock does not follow the cycle counter (%d ns)",
+		     (int)elapsed);
+
+	tm.nanosecond = NSEC_PER_SEC;
+	zassert_equal(ptp_clock_set(clk, &tm), -EINVAL,
+		      "Invalid time accepted");
+}
+
+static void test_adjust(void)
+{
+	struct net_ptp_time tm = { 0 };
+	s64_t diff;
+	u64_t start;
+
+	start = clk_ns();
+	ref_start();
+
+	zassert_equal(ptp_clock_adjust(clk, 5000), 0, "Cannot adjust");
+	zassert_equal(ptp_clock_adjust(clk, -2000), 0, "Cannot adjust");
+
+	diff = clk_ns() - start - (s64_t)ref_update();
+	zassert_true(diff >= 3000 - NSEC_PER_USEC &&
+		     diff <= 3000 + NSEC_PER_USEC,
+		     "Wrong adjustment (%d ns)", (int)diff);
+
+	zassert_equal(ptp_clock_set(clk, &tm), 0, "Cannot set time");
+	zassert_equal(ptp_clock_adjust(clk, -NSEC_PER_SEC), -EINVAL,
+		      "Time set before 0");
+}
+
+static void test_rate_adjust(void)
+{
+	s64_t drift;
+	u64_t start;
+
+	zassert_equal(ptp_clock_rate_adjust(clk, 1.01f), -EINVAL,
+		      "Too large rate accepted");
+
+	/* 100 ppm faster */
+	zassert_equal(ptp_clock_rate_adjust(clk, 1.0001f), 0,
+		      "Cannot adjust rate");
+
+	start = clk_ns();
+	ref_start();
+
+	k_sleep(K_SECONDS(1));
+
+	drift = clk_ns() - start - (s64_t)ref_update();
+	zassert_true(drift > 95 * NSEC_PER_USEC && drift < 105 * NSEC_PER_USEC,
+		     "Wrong drift %d ns", (int)drift);
+
+	zassert_equal(ptp_clock_rate_adjust(clk, 1.0f / 1.0001f), 0,
+		      "Cannot adjust rate");
+}
+
+static void test_servo_sync(void)
+{
+	struct gptp_servo_stats stats;
+	s64_t offset;
+	u64_t local;
+	double gm;
+	int i;
+
+	gptp_servo_reset();
+	ref_start();
+
+	/* 2 samples to measure the frequency, then enough to fill two
+	 * statistics windows.
+	 */
+	for (i = 0; i < 2 + 3 * GPTP_SERVO_STATS_WINDOW; i++) {
+		k_sleep(SYNC_INTERVAL);
+
+		gm = GM_START + ref_update() * (1.0 + GM_PPB / 1e9);
+		local = clk_ns();
+		offset = (s64_t)(local - (u64_t)gm);
+
+		gptp_servo_sample(clk, offset, local, 1000);
+	}
+
+	zassert_equal(gptp_servo_get_stats(&stats), 0, "Cannot get stats");
+
+	zassert_equal(stats.state, GPTP_SERVO_LOCKED, "Servo not locked");
+	zassert_equal(stats.samples, 2 + 3 * GPTP_SERVO_STATS_WINDOW,
+		      "Wrong sample count");
+	zassert_equal(stats.path_delay, 1000, "Wrong path delay");
+	zassert_true(stats.offset > -NSEC_PER_USEC &&
+		     stats.offset < NSEC_PER_USEC,
+		     "Offset %d ns", (int)stats.offset);
+	zassert_true(stats.offset_rms < NSEC_PER_USEC, "Offset RMS %u ns",
+		     stats.offset_rms);
+	zassert_true(stats.offset_max < NSEC_PER_USEC, "Offset max %u ns",
+		     stats.offset_max);
+	zassert_true(stats.freq > GM_PPB - 1000 && stats.freq < GM_PPB + 1000,
+		     "Frequency %d ppb", stats.freq);
+}
+
+static void test_servo_step(void)
+{
+	struct gptp_servo_stats stats;
+	u64_t local;
+
+	/* An offset above the threshold resets the servo */
+	local = clk_ns();
+	gptp_servo_sample(clk, CONFIG_NET_GPTP_SERVO_STEP_THRESHOLD + 1,
+			  local, 1000);
+
+	zassert_equal(gptp_servo_get_stats(&stats), 0, "Cannot get stats");
+	zassert_equal(stats.state, GPTP_SERVO_UNLOCKED, "Servo not reset");
+	zassert_equal(stats.samples, 1, "Wrong sample count");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(ptp_servo,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_set_get),
+			 ztest_unit_test(test_adjust),
+			 ztest_unit_test(test_rate_adjust),
+			 ztest_unit_test(test_servo_sync),
+			 ztest_unit_test(test_servo_step));
+
+	ztest_run_test_suite(ptp_servo);
+}
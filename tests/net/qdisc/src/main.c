@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+#include <net/net_ip.h>
+#include <net/net_mgmt.h>
+#include <net/net_stats.h>
+#include <net/dummy.h>
+#include <net/qdisc.h>
+
+#include <ztest.h>
+
+#define PKT_LEN 200
+#define MAX_SENT 48
+
+/* Bytes per second, a packet takes 20 ms to be sent */
+#define RATE 10000
+
+struct sent_pkt {
+	s64_t time;
+	enum net_priority priority;
+};
+
+static struct net_if *iface;
+
+static struct sent_pkt sent[MAX_SENT];
+static int sent_count;
+
+/* IPv6 UDP header of 2001:db8::1 -> 2001:db8::2, the source port being
+ * set per flow.
+ */
+static const u8_t ipv6_udp[] = {
+	0x60, 0x00, 0x00, 0x00, 0x00, 0xa0, 0x11, 0x40,
+	0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+	0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+	0x00, 0x00, 0x00, 0x35, 0x00, 0xa0, 0x00, 0x00,
+};
+
+#define SRC_PORT_OFFSET 40
+
+static void fake_iface_init(struct net_if *netif)
+{
+	static u8_t mac[] = { 0x00, 0x00, 0x5e, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(netif, mac, sizeof(mac), NET_LINK_DUMMY);
+}
+
+static int fake_send(struct device *dev, struct net_pkt *pkt)
+{
+	if (sent_count < MAX_SENT) {
+		sent[sent_count].time = k_uptime_get();
+		sent[sent_count].priority = net_pkt_priority(pkt);
+		sent_count++;
+	}
+
+	return 0;
+}
+
+static int fake_init(struct device *dev)
+{
+	return 0;
+}
+
+static const struct dummy_api fake_api = {
+	.iface_api.init = fake_iface_init,
+	.send = fake_send,
+};
+
+NET_DEVICE_INIT(qdisc_fake, "qdisc_fake", fake_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &fake_api,
+		DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 1280);
+
+/* Queues a packet of flow port, tagged with priority */
+static void queue_pkt(u16_t port, enum net_priority priority)
+{
+	struct net_pkt *pkt;
+	u8_t hdr[sizeof(ipv6_udp)];
+
+	pkt = net_pkt_alloc_with_buffer(iface, PKT_LEN, AF_UNSPEC, 0,
+					K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate packet");
+
+	memcpy(hdr, ipv6_udp, sizeof(hdr));
+	UNALIGNED_PUT(htons(port), (u16_t *)&hdr[SRC_PORT_OFFSET]);
+
+	zassert_equal(net_pkt_write(pkt, hdr, sizeof(hdr)), 0,
+		      "Cannot write header");
+	zassert_equal(net_pkt_memset(pkt, 0, PKT_LEN - sizeof(hdr)), 0,
+		      "Cannot write payload");
+
+	net_pkt_set_priority(pkt, priority);
+
+	net_if_queue_tx(iface, pkt);
+}
+
+static void set_qdisc(enum net_qdisc_type type, u32_t rate)
+{
+	struct net_qdisc_config config = {
+		.type = type,
+		.rate = rate,
+	};
+
+	zassert_equal(net_qdisc_set(iface, &config), 0,
+		      "Cannot set queueing discipline");
+
+	sent_count = 0;
+}
+
+static void get_stats(struct net_stats_qdisc *stats)
+{
+	zassert_equal(net_mgmt(NET_REQUEST_STATS_GET_QDISC, iface, stats,
+			       sizeof(struct net_stats_qdisc) *
+			       NET_QDISC_PRIO_BANDS), 0,
+		      "Cannot get statistics");
+}
+
+static int find_sent(enum net_priority priority)
+{
+	int i;
+
+	for (i = 0; i < sent_count; i++) {
+		if (sent[i].priority == priority) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void test_setup(void)
+{
+	iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(iface, "No dummy interface");
+}
+
+static void test_config(void)
+{
+	struct net_qdisc_config config;
+	u16_t mtu = net_if_get_mtu(iface);
+
+	zassert_equal(net_qdisc_get(iface, &config), 0, "Cannot get qdisc");
+	zassert_equal(config.type, NET_QDISC_NONE, "Qdisc set by default");
+
+	(void)memset(&config, 0, sizeof(config));
+
+	config.type = NET_QDISC_TBF;
+	zassert_equal(net_qdisc_set(iface, &config), -EINVAL,
+		      "TBF accepted without rate");
+
+	config.rate = RATE;
+	config.burst = mtu - 1;
+	zassert_equal(net_qdisc_set(iface, &config), -EINVAL,
+		      "Burst smaller than the MTU accepted");
+
+	config.type = (enum net_qdisc_type)42;
+	config.burst = 0U;
+	zassert_equal(net_qdisc_set(iface, &config), -EINVAL,
+		      "Unknown type accepted");
+
+	(void)memset(&config, 0, sizeof(config));
+
+	config.type = NET_QDISC_FQ_CODEL;
+	zassert_equal(net_mgmt(NET_REQUEST_QDISC_SET, iface, &config,
+			       sizeof(config)), 0,
+		      "Cannot set fq_codel");
+	zassert_true(net_if_flag_is_set(iface, NET_IF_QDISC),
+		     "Qdisc flag not set");
+
+	(void)memset(&config, 0, sizeof(config));
+
+	zassert_equal(net_mgmt(NET_REQUEST_QDISC_GET, iface, &config,
+			       sizeof(config)), 0,
+		      "Cannot get fq_codel");
+	zassert_equal(config.type, NET_QDISC_FQ_CODEL, "Wrong type");
+	zassert_equal(config.rate, 0, "Wrong rate");
+	zassert_equal(config.burst, mtu, "Wrong default burst");
+	zassert_equal(config.limit, CONFIG_NET_QDISC_LIMIT,
+		      "Wrong default limit");
+	zassert_equal(config.quantum, mtu, "Wrong default quantum");
+	zassert_equal(config.target, 5 * USEC_PER_MSEC,
+		      "Wrong default target");
+	zassert_equal(config.interval, 100 * USEC_PER_MSEC,
+		      "Wrong default interval");
+
+	config.type = NET_QDISC_NONE;
+	zassert_equal(net_qdisc_set(iface, &config), 0,
+		      "Cannot remove qdisc");
+	zassert_false(net_if_flag_is_set(iface, NET_IF_QDISC),
+		      "Qdisc flag still set");
+
+	zassert_equal(net_qdisc_get(iface, &config), 0, "Cannot get qdisc");
+	zassert_equal(config.type, NET_QDISC_NONE, "Qdisc not removed");
+}
+
+static void test_prio_order(void)
+{
+	static const enum net_priority expected[] = {
+		NET_PRIORITY_VO, NET_PRIORITY_NC, NET_PRIORITY_BE,
+		NET_PRIORITY_BK, NET_PRIORITY_BK,
+	};
+	int i;
+
+	set_qdisc(NET_QDISC_PRIO, 0);
+
+	/* Queue all the packets before the Tx thread runs */
+	k_sched_lock();
+
+	queue_pkt(1000, NET_PRIORITY_BK);
+	queue_pkt(1000, NET_PRIORITY_BE);
+	queue_pkt(1000, NET_PRIORITY_VO);
+	queue_pkt(1000, NET_PRIORITY_BK);
+	queue_pkt(1000, NET_PRIORITY_NC);
+
+	k_sched_unlock();
+
+	k_sleep(K_MSEC(100));
+
+	zassert_equal(sent_count, ARRAY_SIZE(expected),
+		      "Wrong number of packets sent");
+
+	for (i = 0; i < ARRAY_SIZE(expected); i++) {
+		zassert_equal(sent[i].priority, expected[i],
+			      "Packet %d sent out of order", i);
+	}
+}
+
+static void test_tbf_rate(void)
+{
+	s64_t start;
+	int i;
+
+	set_qdisc(NET_QDISC_TBF, RATE);
+
+	start = k_uptime_get();
+
+	/* 4000 bytes, of which the 1280 bytes of the burst are sent right
+	 * away and the others at the rate, in 280 ms.
+	 */
+	for (i = 0; i < 20; i++) {
+		queue_pkt(1000, NET_PRIORITY_BE);
+	}
+
+	k_sleep(K_MSEC(100));
+
+	zassert_true(sent_count >= 6, "Burst not sent (%d)", sent_count);
+	zassert_true(sent_count < 20, "Rate not enforced");
+
+	k_sleep(K_MSEC(500));
+
+	zassert_equal(sent_count, 20, "Packets not sent");
+	zassert_true(sent[19].time - start >= 250,
+		     "Sent too fast (%d ms)", (int)(sent[19].time - start));
+}
+
+static void test_prio_bounded_latency(void)
+{
+	struct net_stats_qdisc stats[NET_QDISC_PRIO_BANDS];
+	s64_t queued;
+	int i;
+
+	set_qdisc(NET_QDISC_PRIO, RATE);
+
+	/* Saturate the link with 600 ms of best effort traffic */
+	for (i = 0; i < 30; i++) {
+		queue_pkt(1000, NET_PRIORITY_BE);
+	}
+
+	k_sleep(K_MSEC(50));
+
+	queued = k_uptime_get();
+	queue_pkt(2000, NET_PRIORITY_VO);
+
+	k_sleep(K_MSEC(700));
+
+	zassert_equal(sent_count, 31, "Packets not sent");
+
+	/* Only waits for the packet holding the link and for its own
+	 * transmission time.
+	 */
+	i = find_sent(NET_PRIORITY_VO);
+	zassert_true(i >= 0, "Voice packet not sent");
+	zassert_true(sent[i].time - queued < 100, "Voice delayed %d ms",
+		     (int)(sent[i].time - queued));
+	zassert_true(i < 30, "Voice not sent before best effort");
+
+	get_stats(stats);
+
+	zassert_true(stats[1].delay_max >= 300 * USEC_PER_MSEC,
+		     "Best effort delay not accounted");
+	zassert_true(stats[0].delay_max < 100 * USEC_PER_MSEC,
+		     "Voice delay not bounded");
+}
+
+static void test_fq_codel(void)
+{
+	struct net_stats_qdisc before[NET_QDISC_PRIO_BANDS];
+	struct net_stats_qdisc after[NET_QDISC_PRIO_BANDS];
+	struct net_qdisc_config config = {
+		.type = NET_QDISC_FQ_CODEL,
+		.rate = RATE,
+		.target = 5 * USEC_PER_MSEC,
+		.interval = 20 * USEC_PER_MSEC,
+	};
+	s64_t queued;
+	int dropped;
+	int i;
+
+	zassert_equal(net_qdisc_set(iface, &config), 0,
+		      "Cannot set fq_codel");
+
+	sent_count = 0;
+	get_stats(before);
+
+	/* A bulk flow building a standing queue */
+	for (i = 0; i < 30; i++) {
+		queue_pkt(1000, NET_PRIORITY_BE);
+	}
+
+	k_sleep(K_MSEC(50));
+
+	/* A sparse flow, tagged to be found among the sent packets */
+	queued = k_uptime_get();
+	queue_pkt(2000, NET_PRIORITY_VO);
+
+	k_sleep(K_MSEC(800));
+
+	get_stats(after);
+
+	dropped = after[0].dropped - before[0].dropped;
+
+	zassert_true(dropped > 0, "CoDel did not drop");
+	zassert_equal(sent_count + dropped, 31, "Packets lost");
+
+	i = find_sent(NET_PRIORITY_VO);
+	zassert_true(i >= 0, "Sparse flow packet not sent");
+	zassert_true(sent[i].time - queued < 100, "Sparse flow delayed %d ms",
+		     (int)(sent[i].time - queued));
+
+	config.type = NET_QDISC_NONE;
+	zassert_equal(net_qdisc_set(iface, &config), 0,
+		      "Cannot remove qdisc");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_qdisc,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_config),
+			 ztest_unit_test(test_prio_order),
+			 ztest_unit_test(test_tbf_rate),
+			 ztest_unit_test(test_prio_bounded_latency),
+			 ztest_unit_test(test_fq_codel));
+
+	ztest_run_test_suite(net_qdisc);
+}
@@ -33,6 +33,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_ROUTE_LOG_LEVEL);
 #include "ipv6.h"
 #include "nbr.h"
 #include "route.h"
+#include "arp.h"
 
 #if defined(CONFIG_NET_ROUTE_LOG_LEVEL_DBG)
 #define DBG(fmt, ...) printk(fmt, ##__VA_ARGS__)
@@ -442,6 +443,47 @@ static void route_del_nexthop_again(void)
 	zassert_false((ret >= 0), "Route del again nexthop failed");
 }
 
+static void route_longest_prefix(void)
+{
+	struct net_route_entry *net_route, *host_route;
+	struct in6_addr addr;
+
+	net_route = net_route_add(my_iface, &generic_addr, 64, &peer_addr);
+	zassert_not_null(net_route, "Prefix route add failed");
+
+	host_route = net_route_add(my_iface, &dest_addr, 128, &peer_addr);
+	zassert_not_null(host_route, "Host route add failed");
+	zassert_not_equal(net_route, host_route, "Prefix route replaced");
+
+	zassert_equal_ptr(net_route_lookup(my_iface, &dest_addr), host_route,
+			  "Host route not selected");
+	zassert_equal_ptr(net_route_lookup(NULL, &dest_addr), host_route,
+			  "Host route not selected on any interface");
+	zassert_is_null(net_route_lookup(peer_iface, &dest_addr),
+			"Route found on wrong interface");
+
+	net_ipaddr_copy(&addr, &dest_addr);
+	addr.s6_addr[15]++;
+
+	zassert_equal_ptr(net_route_lookup(my_iface, &addr), net_route,
+			  "Prefix route not selected");
+
+	addr.s6_addr[7]++;
+
+	zassert_is_null(net_route_lookup(my_iface, &addr),
+			"Route found outside of the prefix");
+
+	zassert_false(net_route_del(host_route), "Host route del failed");
+
+	zassert_equal_ptr(net_route_lookup(my_iface, &dest_addr), net_route,
+			  "Prefix route not selected after host route del");
+
+	zassert_false(net_route_del(net_route), "Prefix route del failed");
+
+	zassert_is_null(net_route_lookup(my_iface, &dest_addr),
+			"Route found after del");
+}
+
 static void route_add_many(void)
 {
 	int i;
@@ -468,6 +510,145 @@ static void route_del_many(void)
 	}
 }
 
+static void route_ipv4_longest_prefix(void)
+{
+	struct in_addr net8 = { { { 10, 0, 0, 0 } } };
+	struct in_addr net16 = { { { 10, 1, 0, 0 } } };
+	struct in_addr host = { { { 10, 1, 2, 3 } } };
+	struct in_addr in_net16 = { { { 10, 1, 9, 9 } } };
+	struct in_addr in_net8 = { { { 10, 9, 9, 9 } } };
+	struct in_addr outside = { { { 11, 0, 0, 1 } } };
+	struct in_addr gw1 = { { { 192, 0, 2, 1 } } };
+	struct in_addr gw2 = { { { 192, 0, 2, 2 } } };
+	struct net_route_entry_ipv4 *route8, *route16, *host_route;
+	struct in_addr nexthop;
+
+	route8 = net_route_ipv4_add(my_iface, &net8, 8, &gw1);
+	zassert_not_null(route8, "IPv4 /8 route add failed");
+
+	route16 = net_route_ipv4_add(my_iface, &net16, 16, &gw1);
+	zassert_not_null(route16, "IPv4 /16 route add failed");
+	zassert_not_equal(route8, route16, "IPv4 /8 route replaced");
+
+	/* Adding the same prefix again updates the gateway */
+	zassert_equal_ptr(net_route_ipv4_add(my_iface, &net16, 16, &gw2),
+			  route16, "IPv4 /16 route not updated");
+
+	host_route = net_route_ipv4_add(my_iface, &host, 32, NULL);
+	zassert_not_null(host_route, "IPv4 host route add failed");
+
+	zassert_equal_ptr(net_route_ipv4_lookup(my_iface, &host), host_route,
+			  "IPv4 host route not selected");
+	zassert_equal_ptr(net_route_ipv4_lookup(my_iface, &in_net16), route16,
+			  "IPv4 /16 route not selected");
+	zassert_equal_ptr(net_route_ipv4_lookup(my_iface, &in_net8), route8,
+			  "IPv4 /8 route not selected");
+	zassert_is_null(net_route_ipv4_lookup(my_iface, &outside),
+			"IPv4 route found outside of the prefixes");
+	zassert_is_null(net_route_ipv4_lookup(peer_iface, &host),
+			"IPv4 route found on wrong interface");
+
+	zassert_true(net_route_ipv4_get_nexthop(my_iface, &host, &nexthop),
+		     "No IPv4 nexthop for the host");
+	zassert_true(net_ipv4_addr_cmp(&nexthop, &host),
+		     "On link IPv4 nexthop is not the destination");
+
+	zassert_true(net_route_ipv4_get_nexthop(my_iface, &in_net16,
+						&nexthop),
+		     "No IPv4 nexthop in the /16 prefix");
+	zassert_true(net_ipv4_addr_cmp(&nexthop, &gw2),
+		     "IPv4 nexthop is not the updated gateway");
+
+	zassert_false(net_route_ipv4_get_nexthop(my_iface, &outside,
+						 &nexthop),
+		      "IPv4 nexthop found outside of the prefixes");
+
+	zassert_false(net_route_ipv4_del(route16), "IPv4 route del failed");
+	zassert_equal(net_route_ipv4_del(route16), -ENOENT,
+		      "IPv4 route deleted twice");
+
+	zassert_true(net_route_ipv4_get_nexthop(my_iface, &in_net16,
+						&nexthop),
+		     "No IPv4 nexthop after /16 route del");
+	zassert_true(net_ipv4_addr_cmp(&nexthop, &gw1),
+		     "IPv4 /8 route not selected after /16 route del");
+
+	zassert_false(net_route_ipv4_del(host_route), "IPv4 route del failed");
+	zassert_false(net_route_ipv4_del(route8), "IPv4 route del failed");
+
+	zassert_is_null(net_route_ipv4_lookup(my_iface, &host),
+			"IPv4 route found after del");
+}
+
+/* Checks the address asked for by the ARP request prepared for a packet
+ * to dst.
+ */
+static void arp_check_nexthop(struct in_addr *src, struct in_addr *dst,
+			      struct in_addr *expected)
+{
+	struct net_ipv4_hdr *ipv4;
+	struct net_pkt *pkt, *req;
+
+	pkt = net_pkt_alloc_with_buffer(my_iface, 0, AF_INET, 0, K_SECONDS(1));
+	zassert_not_null(pkt, "out of mem");
+
+	ipv4 = (struct net_ipv4_hdr *)net_buf_add(pkt->buffer,
+						  sizeof(struct net_ipv4_hdr));
+	net_ipaddr_copy(&ipv4->src, src);
+	net_ipaddr_copy(&ipv4->dst, dst);
+
+	req = net_arp_prepare(pkt, &NET_IPV4_HDR(pkt)->dst, NULL);
+	zassert_not_null(req, "No ARP request");
+	zassert_not_equal(req, pkt, "ARP request not prepared");
+
+	zassert_true(net_ipv4_addr_cmp(&NET_ARP_HDR(req)->dst_ipaddr,
+				       expected),
+		     "ARP request for the wrong nexthop");
+
+	net_pkt_unref(req);
+	net_pkt_unref(pkt);
+}
+
+static void route_ipv4_arp_nexthop(void)
+{
+	struct in_addr my_addr4 = { { { 192, 0, 2, 10 } } };
+	struct in_addr netmask = { { { 255, 255, 255, 0 } } };
+	struct in_addr iface_gw = { { { 192, 0, 2, 254 } } };
+	struct in_addr route_gw = { { { 192, 0, 2, 1 } } };
+	struct in_addr net = { { { 198, 51, 100, 0 } } };
+	struct in_addr routed = { { { 198, 51, 100, 7 } } };
+	struct in_addr unrouted = { { { 203, 0, 113, 5 } } };
+	struct in_addr on_link = { { { 192, 0, 2, 20 } } };
+	struct net_route_entry_ipv4 *route;
+	struct net_if_addr *ifaddr;
+
+	net_arp_init();
+
+	ifaddr = net_if_ipv4_addr_add(my_iface, &my_addr4, NET_ADDR_MANUAL,
+				      0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+	ifaddr->addr_state = NET_ADDR_PREFERRED;
+
+	net_if_ipv4_set_netmask(my_iface, &netmask);
+	net_if_ipv4_set_gw(my_iface, &iface_gw);
+
+	route = net_route_ipv4_add(my_iface, &net, 24, &route_gw);
+	zassert_not_null(route, "IPv4 route add failed");
+
+	/* The gateway of the route, then of the interface, is asked for
+	 * off link destinations, the destination itself on link.
+	 */
+	arp_check_nexthop(&my_addr4, &routed, &route_gw);
+	arp_check_nexthop(&my_addr4, &unrouted, &iface_gw);
+	arp_check_nexthop(&my_addr4, &on_link, &on_link);
+
+	net_arp_clear_cache(my_iface);
+
+	zassert_false(net_route_ipv4_del(route), "IPv4 route del failed");
+	zassert_true(net_if_ipv4_addr_rm(my_iface, &my_addr4),
+		     "Cannot remove IPv4 address");
+}
+
 /*test case main entry*/
 void test_main(void)
 {
@@ -486,7 +667,10 @@ void test_main(void)
 			ztest_unit_test(route_del_again),
 			ztest_unit_test(route_del_nexthop_again),
 			ztest_unit_test(populate_nbr_cache),
+			ztest_unit_test(route_longest_prefix),
 			ztest_unit_test(route_add_many),
-			ztest_unit_test(route_del_many));
+			ztest_unit_test(route_del_many),
+			ztest_unit_test(route_ipv4_longest_prefix),
+			ztest_unit_test(route_ipv4_arp_nexthop));
 	ztest_run_test_suite(test_route);
 }
@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+#include <net/net_context.h>
+#include <net/net_pkt.h>
+
+/* The same echo workload over the Zephyr stack and, when offloaded, over
+ * the sockets of the host. Both variants print their round trip rate.
+ *
+ * The Zephyr sockets are not built when they are offloaded, so the host
+ * variant also runs the UDP echo over network contexts of the Zephyr
+ * stack, and reports both rates of that run next to each other.
+ */
+
+#if defined(CONFIG_NET_NATIVE_POSIX_SOCKETS)
+#define STACK_NAME "host sockets"
+#define SERVER_ADDR "127.0.0.1"
+#else
+#define STACK_NAME "Zephyr stack"
+#define SERVER_ADDR CONFIG_NET_CONFIG_MY_IPV4_ADDR
+#endif
+
+#define SERVER_PORT 4242
+#define CONTEXT_SERVER_PORT 4243
+
+#define ECHO_LEN 512
+#define ECHO_ROUNDS 500
+
+#define SERVER_STACK_SIZE 2048
+#define SERVER_PRIORITY 7
+
+static K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+static K_SEM_DEFINE(server_done, 0, 1);
+static int server_error;
+
+static u8_t server_buf[ECHO_LEN];
+static u8_t tx_buf[ECHO_LEN];
+static u8_t rx_buf[ECHO_LEN];
+
+static u8_t pattern(u32_t round, u32_t offset)
+{
+	return (u8_t)(round * 13U + offset * 7U + (offset >> 8));
+}
+
+static void fill_pattern(u32_t round)
+{
+	int i;
+
+	for (i = 0; i < ECHO_LEN; i++) {
+		tx_buf[i] = pattern(round, i);
+	}
+}
+
+static int send_all(int sock, const u8_t *buf, size_t len)
+{
+	ssize_t ret;
+
+	while (len) {
+		ret = send(sock, buf, len, 0);
+		if (ret < 0) {
+			return -errno;
+		}
+
+		buf += ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+static int prepare_server(int type, int proto, struct sockaddr_in *addr)
+{
+	int reuse = 1;
+	int sock, ret;
+
+	(void)memset(addr, 0, sizeof(*addr));
+	addr->sin_family = AF_INET;
+	addr->sin_port = htons(SERVER_PORT);
+	ret = net_addr_pton(AF_INET, SERVER_ADDR, &addr->sin_addr);
+	zassert_equal(ret, 0, "Invalid server address");
+
+	sock = socket(AF_INET, type, proto);
+	zassert_true(sock >= 0, "socket open failed (%d)", errno);
+
+	/* Not supported by all stacks, a left over connection on the host
+	 * would otherwise prevent binding.
+	 */
+	(void)setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse,
+			 sizeof(reuse));
+
+	ret = bind(sock, (struct sockaddr *)addr, sizeof(*addr));
+	zassert_equal(ret, 0, "bind failed (%d)", errno);
+
+	return sock;
+}
+
+/* Print the rate of the echo started at the given uptime, and return it
+ * in round trips per second.
+ */
+static u32_t print_rate(const char *proto, const char *stack, u32_t start)
+{
+	u32_t elapsed = k_uptime_get_32() - start;
+
+	if (elapsed == 0U) {
+		elapsed = 1U;
+	}
+
+	TC_PRINT("%s echo over %s: %u round trips of %u bytes in %u ms, "
+		 "%u round trips/s, %u B/s\n", proto, stack,
+		 ECHO_ROUNDS, ECHO_LEN, elapsed,
+		 ECHO_ROUNDS * MSEC_PER_SEC / elapsed,
+		 (u32_t)((u64_t)2 * ECHO_ROUNDS * ECHO_LEN * MSEC_PER_SEC /
+			 elapsed));
+
+	return ECHO_ROUNDS * MSEC_PER_SEC / elapsed;
+}
+
+static void tcp_server(void *p1, void *p2, void *p3)
+{
+	int sock = POINTER_TO_INT(p1);
+	ssize_t len;
+	int conn;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	conn = accept(sock, NULL, NULL);
+	if (conn < 0) {
+		server_error = errno;
+		goto out;
+	}
+
+	while (true) {
+		len = recv(conn, server_buf, sizeof(server_buf), 0);
+		if (len <= 0) {
+			if (len < 0) {
+				server_error = errno;
+			}
+
+			break;
+		}
+
+		server_error = -send_all(conn, server_buf, len);
+		if (server_error) {
+			break;
+		}
+	}
+
+	close(conn);
+
+out:
+	k_sem_give(&server_done);
+}
+
+static void udp_server(void *p1, void *p2, void *p3)
+{
+	int sock = POINTER_TO_INT(p1);
+	struct sockaddr peer;
+	socklen_t peer_len;
+	ssize_t len;
+	int i;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (i = 0; i < ECHO_ROUNDS; i++) {
+		peer_len = sizeof(peer);
+		len = recvfrom(sock, server_buf, sizeof(server_buf), 0,
+			       &peer, &peer_len);
+		if (len < 0) {
+			server_error = errno;
+			break;
+		}
+
+		if (sendto(sock, server_buf, len, 0, &peer, peer_len) < 0) {
+			server_error = errno;
+			break;
+		}
+	}
+
+	k_sem_give(&server_done);
+}
+
+static void start_server(k_thread_entry_t entry, int sock)
+{
+	server_error = 0;
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack), entry,
+			INT_TO_POINTER(sock), NULL, NULL,
+			K_PRIO_PREEMPT(SERVER_PRIORITY), 0, K_NO_WAIT);
+}
+
+void test_tcp_echo(void)
+{
+	struct sockaddr_in addr;
+	int s_sock, c_sock;
+	u32_t start, round;
+	size_t received;
+	ssize_t len;
+	int ret;
+
+	s_sock = prepare_server(SOCK_STREAM, IPPROTO_TCP, &addr);
+
+	ret = listen(s_sock, 1);
+	zassert_equal(ret, 0, "listen failed (%d)", errno);
+
+	start_server(tcp_server, s_sock);
+
+	c_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(c_sock >= 0, "socket open failed (%d)", errno);
+
+	ret = connect(c_sock, (struct sockaddr *)&addr, sizeof(addr));
+	zassert_equal(ret, 0, "connect failed (%d)", errno);
+
+	start = k_uptime_get_32();
+
+	for (round = 0U; round < ECHO_ROUNDS; round++) {
+		fill_pattern(round);
+
+		ret = send_all(c_sock, tx_buf, sizeof(tx_buf));
+		zassert_equal(ret, 0, "send failed (%d)", -ret);
+
+		for (received = 0; received < sizeof(rx_buf);
+		     received += len) {
+			len = recv(c_sock, rx_buf + received,
+				   sizeof(rx_buf) - received, 0);
+			zassert_true(len > 0, "recv failed (%d)", errno);
+		}
+
+		zassert_mem_equal(rx_buf, tx_buf, sizeof(rx_buf),
+				  "data mismatch in round %u", round);
+	}
+
+	print_rate("TCP", STACK_NAME, start);
+
+	ret = close(c_sock);
+	zassert_equal(ret, 0, "close failed");
+
+	k_sem_take(&server_done, K_FOREVER);
+	zassert_equal(server_error, 0, "server failed (%d)", server_error);
+
+	ret = close(s_sock);
+	zassert_equal(ret, 0, "close failed");
+
+	/* Let the connections go away */
+	k_sleep(K_MSEC(100));
+}
+
+#if defined(CONFIG_NET_NATIVE_POSIX_SOCKETS)
+static struct k_sem context_echoed;
+static ssize_t context_len;
+
+/* Replies to the client from the callback of the server context */
+static void context_server_cb(struct net_context *context,
+			      struct net_pkt *pkt,
+			      union net_ip_header *ip_hdr,
+			      union net_proto_header *proto_hdr,
+			      int status, void *user_data)
+{
+	struct sockaddr_in peer = {
+		.sin_family = AF_INET,
+	};
+	size_t len;
+
+	if (!pkt) {
+		return;
+	}
+
+	len = MIN(net_pkt_remaining_data(pkt), sizeof(server_buf));
+	if (net_pkt_read(pkt, server_buf, len)) {
+		server_error = EIO;
+		goto out;
+	}
+
+	net_ipaddr_copy(&peer.sin_addr, &ip_hdr->ipv4->src);
+	peer.sin_port = proto_hdr->udp->src_port;
+
+	if (net_context_sendto(context, server_buf, len,
+			       (struct sockaddr *)&peer, sizeof(peer), NULL,
+			       K_NO_WAIT, NULL) < 0) {
+		server_error = EIO;
+	}
+
+out:
+	net_pkt_unref(pkt);
+}
+
+static void context_client_cb(struct net_context *context,
+			      struct net_pkt *pkt,
+			      union net_ip_header *ip_hdr,
+			      union net_proto_header *proto_hdr,
+			      int status, void *user_data)
+{
+	if (!pkt) {
+		return;
+	}
+
+	context_len = MIN(net_pkt_remaining_data(pkt), sizeof(rx_buf));
+	if (net_pkt_read(pkt, rx_buf, context_len)) {
+		context_len = -EIO;
+	}
+
+	net_pkt_unref(pkt);
+
+	k_sem_give(&context_echoed);
+}
+
+/* The UDP echo of test_udp_echo() over the Zephyr stack */
+static u32_t context_udp_echo(void)
+{
+	struct net_context *server, *client;
+	struct sockaddr_in addr;
+	u32_t start, round, rate;
+	int ret;
+
+	(void)memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(CONTEXT_SERVER_PORT);
+	ret = net_addr_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			    &addr.sin_addr);
+	zassert_equal(ret, 0, "Invalid server address");
+
+	k_sem_init(&context_echoed, 0, 1);
+	server_error = 0;
+
+	ret = net_context_get(AF_INET, SOCK_DGRAM, IPPROTO_UDP, &server);
+	zassert_equal(ret, 0, "Cannot get server context (%d)", ret);
+
+	ret = net_context_bind(server, (struct sockaddr *)&addr,
+			       sizeof(addr));
+	zassert_equal(ret, 0, "Cannot bind server context (%d)", ret);
+
+	ret = net_context_recv(server, context_server_cb, K_NO_WAIT, NULL);
+	zassert_equal(ret, 0, "Cannot receive on server context (%d)", ret);
+
+	ret = net_context_get(AF_INET, SOCK_DGRAM, IPPROTO_UDP, &client);
+	zassert_equal(ret, 0, "Cannot get client context (%d)", ret);
+
+	ret = net_context_recv(client, context_client_cb, K_NO_WAIT, NULL);
+	zassert_equal(ret, 0, "Cannot receive on client context (%d)", ret);
+
+	start = k_uptime_get_32();
+
+	for (round = 0U; round < ECHO_ROUNDS; round++) {
+		fill_pattern(round);
+
+		ret = net_context_sendto(client, tx_buf, sizeof(tx_buf),
+					 (struct sockaddr *)&addr,
+					 sizeof(addr), NULL, K_NO_WAIT, NULL);
+		zassert_true(ret >= 0, "Cannot send (%d)", ret);
+
+		zassert_equal(k_sem_take(&context_echoed, K_SECONDS(1)), 0,
+			      "No echo in round %u", round);
+		zassert_equal(context_len, sizeof(rx_buf), "Short echo");
+
+		zassert_mem_equal(rx_buf, tx_buf, sizeof(rx_buf),
+				  "data mismatch in round %u", round);
+	}
+
+	rate = print_rate("UDP", "Zephyr stack", start);
+
+	zassert_equal(server_error, 0, "server failed (%d)", server_error);
+
+	net_context_put(client);
+	net_context_put(server);
+
+	return rate;
+}
+#endif
+
+void test_udp_echo(void)
+{
+	struct sockaddr_in addr;
+	int s_sock, c_sock;
+	u32_t start, round, rate;
+#if defined(CONFIG_NET_NATIVE_POSIX_SOCKETS)
+	u32_t context_rate;
+#endif
+	ssize_t len;
+	int ret;
+
+	s_sock = prepare_server(SOCK_DGRAM, IPPROTO_UDP, &addr);
+
+	start_server(udp_server, s_sock);
+
+	c_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(c_sock >= 0, "socket open failed (%d)", errno);
+
+	ret = connect(c_sock, (struct sockaddr *)&addr, sizeof(addr));
+	zassert_equal(ret, 0, "connect failed (%d)", errno);
+
+	start = k_uptime_get_32();
+
+	for (round = 0U; round < ECHO_ROUNDS; round++) {
+		fill_pattern(round);
+
+		len = send(c_sock, tx_buf, sizeof(tx_buf), 0);
+		zassert_equal(len, sizeof(tx_buf), "send failed (%d)", errno);
+
+		len = recv(c_sock, rx_buf, sizeof(rx_buf), 0);
+		zassert_equal(len, sizeof(rx_buf), "recv failed (%d)", errno);
+
+		zassert_mem_equal(rx_buf, tx_buf, sizeof(rx_buf),
+				  "data mismatch in round %u", round);
+	}
+
+	rate = print_rate("UDP", STACK_NAME, start);
+
+	k_sem_take(&server_done, K_FOREVER);
+	zassert_equal(server_error, 0, "server failed (%d)", server_error);
+
+	ret = close(c_sock);
+	zassert_equal(ret, 0, "close failed");
+	ret = close(s_sock);
+	zassert_equal(ret, 0, "close failed");
+
+#if defined(CONFIG_NET_NATIVE_POSIX_SOCKETS)
+	context_rate = context_udp_echo();
+
+	TC_PRINT("UDP round trips/s: host sockets %u, Zephyr stack %u\n",
+		 rate, context_rate);
+#else
+	ARG_UNUSED(rate);
+#endif
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_offload_echo,
+			 ztest_unit_test(test_tcp_echo),
+			 ztest_unit_test(test_udp_echo));
+
+	ztest_run_test_suite(socket_offload_echo);
+}
@@ -106,6 +106,23 @@ void test_poll(void)
 	zassert_equal(pollfds[1].revents, 0, "");
 
 
+	/* Poll writable fd's, which does not use up the
+	 * CONFIG_NET_SOCKETS_POLL_MAX entries
+	 */
+	pollfds[0].events = POLLIN | POLLOUT;
+	pollfds[1].events = POLLIN | POLLOUT;
+
+	tstamp = k_uptime_get_32();
+	res = poll(pollfds, ARRAY_SIZE(pollfds), 30);
+	zassert_true(k_uptime_get_32() - tstamp <= FUZZ, "");
+	zassert_equal(res, 2, "");
+	zassert_equal(pollfds[0].revents, POLLOUT, "");
+	zassert_equal(pollfds[1].revents, POLLOUT, "");
+
+	pollfds[0].events = POLLIN;
+	pollfds[1].events = POLLIN;
+
+
 	/* Close one socket and ensure POLLNVAL happens */
 	res = close(c_sock);
 	zassert_equal(res, 0, "close failed");
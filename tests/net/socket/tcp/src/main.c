@@ -21,6 +21,10 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
 
 #define TCP_TEARDOWN_TIMEOUT K_SECONDS(1)
 
+#define SEND_CHUNK_LEN 256
+#define SEND_QUEUE_WAIT_MS 1000
+#define SEND_QUOTA 512
+
 static void test_bind(int sock, struct sockaddr *addr, socklen_t addrlen)
 {
 	zassert_equal(bind(sock, addr, addrlen),
@@ -352,6 +356,158 @@ void test_v6_sendto_recvfrom_null_dest(void)
 	k_sleep(TCP_TEARDOWN_TIMEOUT);
 }
 
+void test_v4_send_queue_full(void)
+{
+	/* Test that a full send queue makes a non-blocking send() fail with
+	 * EAGAIN, and that poll() reports POLLOUT once the peer reads.
+	 */
+	static char buf[SEND_CHUNK_LEN];
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	struct pollfd pfd;
+	size_t queued = 0;
+	ssize_t len;
+	int res;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	/* The server does not read, so its window closes and the data
+	 * stays in the send queue of the client.
+	 */
+	while (1) {
+		len = send(c_sock, buf, sizeof(buf), MSG_DONTWAIT);
+		if (len < 0) {
+			break;
+		}
+
+		queued += len;
+		zassert_true(queued <= CONFIG_NET_TCP_RECV_WINDOW_SIZE +
+			     CONFIG_NET_TCP_SEND_QUEUE_SIZE + sizeof(buf),
+			     "send queue not limited");
+	}
+
+	zassert_equal(errno, EAGAIN, "unexpected errno %d", errno);
+
+	pfd.fd = c_sock;
+	pfd.events = POLLOUT;
+	res = poll(&pfd, 1, 0);
+	zassert_equal(res, 0, "socket with a full queue is writable");
+
+	while (queued > 0) {
+		len = recv(new_sock, buf, sizeof(buf), 0);
+		zassert_true(len > 0, "recv failed");
+		queued -= len;
+	}
+
+	res = poll(&pfd, 1, SEND_QUEUE_WAIT_MS);
+	zassert_equal(res, 1, "poll timed out");
+	zassert_equal(pfd.revents, POLLOUT, "POLLOUT not reported");
+
+	test_close(c_sock);
+	test_eof(new_sock);
+
+	test_close(new_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_v4_send_quota(void)
+{
+	/* Test that a socket over its send quota fails with EAGAIN, without
+	 * blocking the connection, and can send again once its data is
+	 * acknowledged.
+	 */
+	static char buf[SEND_CHUNK_LEN];
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	int sndbuf = SEND_QUOTA;
+	struct pollfd pfd;
+	size_t queued = 0;
+	ssize_t len;
+	int res;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	res = setsockopt(c_sock, SOL_SOCKET, SO_SNDBUF, &sndbuf,
+			 sizeof(sndbuf));
+	zassert_equal(res, 0, "setsockopt failed");
+
+	test_bind(s_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_listen(s_sock);
+
+	test_connect(c_sock, (struct sockaddr *)&s_saddr, sizeof(s_saddr));
+	test_accept(s_sock, &new_sock, &addr, &addrlen);
+
+	/* Once the window of the server is closed, the queued data stays
+	 * charged to the quota, which is smaller than the send queue.
+	 */
+	while (1) {
+		len = send(c_sock, buf, sizeof(buf), MSG_DONTWAIT);
+		if (len < 0) {
+			break;
+		}
+
+		queued += len;
+		zassert_true(queued <= CONFIG_NET_TCP_RECV_WINDOW_SIZE +
+			     SEND_QUOTA + sizeof(buf),
+			     "send quota not applied");
+	}
+
+	zassert_equal(errno, EAGAIN, "unexpected errno %d", errno);
+
+	pfd.fd = c_sock;
+	pfd.events = POLLOUT;
+	res = poll(&pfd, 1, 0);
+	zassert_equal(res, 0, "socket over its quota is writable");
+
+	/* The connection still makes progress */
+	while (queued > 0) {
+		len = recv(new_sock, buf, sizeof(buf), 0);
+		zassert_true(len > 0, "recv failed");
+		queued -= len;
+	}
+
+	res = poll(&pfd, 1, SEND_QUEUE_WAIT_MS);
+	zassert_equal(res, 1, "poll timed out");
+	zassert_equal(pfd.revents, POLLOUT, "POLLOUT not reported");
+
+	test_send(c_sock, buf, sizeof(buf), 0);
+
+	len = recv(new_sock, buf, sizeof(buf), 0);
+	zassert_equal(len, sizeof(buf), "recv failed");
+
+	test_close(c_sock);
+	test_eof(new_sock);
+
+	test_close(new_sock);
+	test_close(s_sock);
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(socket_tcp,
@@ -360,7 +516,9 @@ void test_main(void)
 			 ztest_user_unit_test(test_v4_sendto_recvfrom),
 			 ztest_user_unit_test(test_v6_sendto_recvfrom),
 			 ztest_user_unit_test(test_v4_sendto_recvfrom_null_dest),
-			 ztest_user_unit_test(test_v6_sendto_recvfrom_null_dest));
+			 ztest_user_unit_test(test_v6_sendto_recvfrom_null_dest),
+			 ztest_user_unit_test(test_v4_send_queue_full),
+			 ztest_user_unit_test(test_v4_send_quota));
 
 	ztest_run_test_suite(socket_tcp);
 }
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <net/dummy.h>
+
+#include "tcp_internal.h"
+#include "../../tcp_transfer.h"
+
+/* A TCP bulk transfer over a dummy link that deterministically drops a
+ * fixed percentage of the data segments, reporting the goodput for the
+ * configured congestion control algorithm. SYN, FIN and pure ACK
+ * segments are never dropped.
+ *
+ * The link MTU is kept small so that the 1280 byte receive window holds
+ * enough segments in flight for duplicate ACKs to trigger fast
+ * retransmit.
+ */
+
+#define LINK_MTU 296
+
+#define TRANSFER_LEN (64 * 1024)
+#define CHUNK_LEN 512
+
+static u8_t tx_chunk[CHUNK_LEN];
+static u8_t rx_chunk[CHUNK_LEN];
+
+static int drop_percent;
+static u32_t data_segments;
+static u32_t dropped_segments;
+
+static size_t tcp_payload_len(struct net_pkt *pkt)
+{
+	u8_t ip_hdr_len = net_pkt_ip_hdr_len(pkt);
+	u16_t len = ntohs(NET_IPV4_HDR(pkt)->len);
+	u8_t offset;
+
+	if (NET_IPV4_HDR(pkt)->proto != IPPROTO_TCP) {
+		return 0;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_skip(pkt, ip_hdr_len +
+			 offsetof(struct net_tcp_hdr, offset)) ||
+	    net_pkt_read_u8(pkt, &offset)) {
+		return 0;
+	}
+
+	return len - ip_hdr_len - (offset >> 4) * 4;
+}
+
+static bool drop_segment(struct net_pkt *pkt)
+{
+	if (!drop_percent || !tcp_payload_len(pkt)) {
+		return false;
+	}
+
+	data_segments++;
+
+	if ((data_segments * drop_percent) % 100U < drop_percent) {
+		dropped_segments++;
+		return true;
+	}
+
+	return false;
+}
+
+static int lossy_send(struct device *dev, struct net_pkt *pkt)
+{
+	struct net_pkt *cloned;
+	int res = 0;
+
+	ARG_UNUSED(dev);
+
+	if (!pkt->frags) {
+		return -ENODATA;
+	}
+
+	if (drop_segment(pkt)) {
+		goto out;
+	}
+
+	cloned = tcp_transfer_reflect(pkt);
+	if (!cloned) {
+		res = -ENOMEM;
+		goto out;
+	}
+
+	res = net_recv_data(net_pkt_iface(cloned), cloned);
+	if (res < 0) {
+		net_pkt_unref(cloned);
+	}
+
+out:
+	k_yield();
+
+	return res;
+}
+
+static struct dummy_api lossy_api = {
+	.iface_api.init = tcp_transfer_iface_init,
+
+	.send = lossy_send,
+};
+
+NET_DEVICE_INIT(lossy, "lossy",
+		tcp_transfer_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&lossy_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), LINK_MTU);
+
+static void run_transfer(int percent)
+{
+	struct tcp_transfer transfer = {
+		.tx_chunk = tx_chunk,
+		.rx_chunk = rx_chunk,
+		.chunk_len = CHUNK_LEN,
+		.len = TRANSFER_LEN,
+	};
+	u32_t goodput;
+
+	drop_percent = percent;
+	data_segments = 0U;
+	dropped_segments = 0U;
+
+	goodput = tcp_transfer_run(&transfer);
+
+	TC_PRINT("%s: loss %d%% segments %u dropped %u goodput %u B/s\n",
+		 NET_TCP_CC_DEFAULT->name, percent, data_segments,
+		 dropped_segments, goodput);
+}
+
+void test_no_loss(void)
+{
+	run_transfer(0);
+}
+
+void test_loss_2_percent(void)
+{
+	run_transfer(2);
+}
+
+void test_loss_5_percent(void)
+{
+	run_transfer(5);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_tcp_lossy,
+			 ztest_unit_test(test_no_loss),
+			 ztest_unit_test(test_loss_2_percent),
+			 ztest_unit_test(test_loss_5_percent));
+
+	ztest_run_test_suite(socket_tcp_lossy);
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <net/dummy.h>
+
+#include "tcp_internal.h"
+#include "../../tcp_transfer.h"
+
+/* A TCP bulk transfer over a dummy link that delays every packet by
+ * half of the configured round trip time. The goodput of a window
+ * limited connection is at most the receive window divided by the RTT,
+ * so with window scaling the transfer must be faster than what a 16 bit
+ * window allows.
+ */
+
+#define LINK_MTU 1500
+#define LINK_RTT_MS 50
+#define LINK_QUEUE_LEN 256
+
+#define TRANSFER_LEN (4 * 1024 * 1024)
+#define CHUNK_LEN 4096
+
+#define LINK_STACK_SIZE 2048
+#define LINK_PRIORITY 7
+
+struct link_entry {
+	struct net_pkt *pkt;
+	u32_t due;
+};
+
+static struct link_entry link_queue[LINK_QUEUE_LEN];
+static u16_t link_head;
+static u16_t link_tail;
+static struct k_spinlock link_lock;
+static K_SEM_DEFINE(link_sem, 0, LINK_QUEUE_LEN);
+static u32_t link_overruns;
+
+static u8_t tx_chunk[CHUNK_LEN];
+static u8_t rx_chunk[CHUNK_LEN];
+
+static int delay_send(struct device *dev, struct net_pkt *pkt)
+{
+	struct net_pkt *cloned;
+	k_spinlock_key_t key;
+
+	ARG_UNUSED(dev);
+
+	if (!pkt->frags) {
+		return -ENODATA;
+	}
+
+	cloned = tcp_transfer_reflect(pkt);
+	if (!cloned) {
+		return -ENOMEM;
+	}
+
+	key = k_spin_lock(&link_lock);
+
+	if ((u16_t)(link_head + 1U) % LINK_QUEUE_LEN == link_tail) {
+		/* Lost on the wire */
+		link_overruns++;
+		k_spin_unlock(&link_lock, key);
+		net_pkt_unref(cloned);
+
+		return 0;
+	}
+
+	link_queue[link_head].pkt = cloned;
+	link_queue[link_head].due = k_uptime_get_32() + LINK_RTT_MS / 2;
+	link_head = (link_head + 1U) % LINK_QUEUE_LEN;
+
+	k_spin_unlock(&link_lock, key);
+
+	k_sem_give(&link_sem);
+
+	return 0;
+}
+
+/* Deliver the packets in the order they were sent, each one after the
+ * one way delay of the link has elapsed.
+ */
+static void link_thread(void *p1, void *p2, void *p3)
+{
+	struct link_entry entry;
+	k_spinlock_key_t key;
+	s32_t wait;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		k_sem_take(&link_sem, K_FOREVER);
+
+		key = k_spin_lock(&link_lock);
+		entry = link_queue[link_tail];
+		link_tail = (link_tail + 1U) % LINK_QUEUE_LEN;
+		k_spin_unlock(&link_lock, key);
+
+		wait = (s32_t)(entry.due - k_uptime_get_32());
+		if (wait > 0) {
+			k_sleep(K_MSEC(wait));
+		}
+
+		if (net_recv_data(net_pkt_iface(entry.pkt), entry.pkt) < 0) {
+			net_pkt_unref(entry.pkt);
+		}
+	}
+}
+
+K_THREAD_DEFINE(link, LINK_STACK_SIZE, link_thread, NULL, NULL, NULL,
+		K_PRIO_COOP(LINK_PRIORITY), 0, K_NO_WAIT);
+
+static struct dummy_api delay_api = {
+	.iface_api.init = tcp_transfer_iface_init,
+
+	.send = delay_send,
+};
+
+NET_DEVICE_INIT(delay, "delay",
+		tcp_transfer_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&delay_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), LINK_MTU);
+
+static u32_t run_transfer(void)
+{
+	struct tcp_transfer transfer = {
+		.tx_chunk = tx_chunk,
+		.rx_chunk = rx_chunk,
+		.chunk_len = CHUNK_LEN,
+		.len = TRANSFER_LEN,
+	};
+	u32_t goodput;
+
+	link_overruns = 0U;
+
+	goodput = tcp_transfer_run(&transfer);
+
+	TC_PRINT("rtt %u ms window %u goodput %u B/s (limit %u B/s) "
+		 "overruns %u\n", LINK_RTT_MS, NET_TCP_BUF_MAX_LEN, goodput,
+		 (u32_t)((u64_t)NET_TCP_BUF_MAX_LEN * MSEC_PER_SEC /
+			 LINK_RTT_MS), link_overruns);
+
+	return goodput;
+}
+
+void test_throughput(void)
+{
+	u32_t goodput;
+
+	goodput = run_transfer();
+
+#if CONFIG_NET_TCP_RECV_WINDOW_SIZE > 65535
+	zassert_true(goodput > (u32_t)UINT16_MAX * MSEC_PER_SEC / LINK_RTT_MS,
+		     "window scaling not effective");
+#else
+	ARG_UNUSED(goodput);
+#endif
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_tcp_throughput,
+			 ztest_unit_test(test_throughput));
+
+	ztest_run_test_suite(socket_tcp_throughput);
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Bulk TCP transfer from a client thread to a server socket, over a
+ * dummy link of the test which hands every sent packet back to the
+ * stack, with its addresses swapped by tcp_transfer_reflect().
+ */
+
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+
+#define TCP_TRANSFER_PORT 4242
+
+#define TCP_TRANSFER_STACK_SIZE 2048
+#define TCP_TRANSFER_PRIORITY 7
+
+/* Retry interval when the Tx packet pool is used up */
+#define TCP_TRANSFER_SEND_RETRY_MS 10
+
+struct tcp_transfer {
+	u8_t *tx_chunk;
+	u8_t *rx_chunk;
+	size_t chunk_len;
+	u32_t len;
+	u32_t sent;
+};
+
+static K_THREAD_STACK_DEFINE(tcp_transfer_stack, TCP_TRANSFER_STACK_SIZE);
+static struct k_thread tcp_transfer_thread;
+static K_SEM_DEFINE(tcp_transfer_done, 0, 1);
+
+static inline u8_t tcp_transfer_pattern(u32_t offset)
+{
+	return (u8_t)(offset * 7U + (offset >> 8));
+}
+
+static inline int tcp_transfer_dev_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 0;
+}
+
+static inline void tcp_transfer_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, "\x00\x00\x5e\x00\x53\x01", 6,
+			     NET_LINK_DUMMY);
+}
+
+/* Return a copy of an IPv4 packet sent on the link, to be received as
+ * coming from its destination.
+ */
+static inline struct net_pkt *tcp_transfer_reflect(struct net_pkt *pkt)
+{
+	struct in_addr addr;
+
+	net_ipaddr_copy(&addr, &NET_IPV4_HDR(pkt)->src);
+	net_ipaddr_copy(&NET_IPV4_HDR(pkt)->src, &NET_IPV4_HDR(pkt)->dst);
+	net_ipaddr_copy(&NET_IPV4_HDR(pkt)->dst, &addr);
+
+	return net_pkt_clone(pkt, K_MSEC(100));
+}
+
+static inline void tcp_transfer_client(void *p1, void *p2, void *p3)
+{
+	struct tcp_transfer *transfer = p1;
+	int sock = POINTER_TO_INT(p2);
+	u8_t *chunk = transfer->tx_chunk;
+	u32_t offset = 0U;
+	ssize_t len;
+	int i;
+
+	ARG_UNUSED(p3);
+
+	while (offset < transfer->len) {
+		for (i = 0; i < transfer->chunk_len; i++) {
+			chunk[i] = tcp_transfer_pattern(offset + i);
+		}
+
+		len = send(sock, chunk,
+			   MIN(transfer->chunk_len, transfer->len - offset), 0);
+		if (len < 0) {
+			if (errno == ENOMEM) {
+				k_sleep(TCP_TRANSFER_SEND_RETRY_MS);
+				continue;
+			}
+
+			break;
+		}
+
+		offset += len;
+	}
+
+	transfer->sent = offset;
+	k_sem_give(&tcp_transfer_done);
+}
+
+/* Send transfer->len bytes over a new connection, check that they are
+ * all received in order, and return the goodput in bytes per second.
+ */
+static inline u32_t tcp_transfer_run(struct tcp_transfer *transfer)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(TCP_TRANSFER_PORT),
+	};
+	int s_sock, c_sock, new_sock;
+	u32_t received = 0U;
+	u32_t start, elapsed;
+	ssize_t len;
+	int res, i;
+
+	res = inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+			&addr.sin_addr);
+	zassert_equal(res, 1, "inet_pton failed");
+
+	s_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(s_sock >= 0, "socket open failed");
+	c_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(c_sock >= 0, "socket open failed");
+
+	res = bind(s_sock, (struct sockaddr *)&addr, sizeof(addr));
+	zassert_equal(res, 0, "bind failed");
+
+	res = listen(s_sock, 1);
+	zassert_equal(res, 0, "listen failed");
+
+	res = connect(c_sock, (struct sockaddr *)&addr, sizeof(addr));
+	zassert_equal(res, 0, "connect failed");
+
+	new_sock = accept(s_sock, NULL, NULL);
+	zassert_true(new_sock >= 0, "accept failed");
+
+	start = k_uptime_get_32();
+
+	k_thread_create(&tcp_transfer_thread, tcp_transfer_stack,
+			K_THREAD_STACK_SIZEOF(tcp_transfer_stack),
+			tcp_transfer_client, transfer, INT_TO_POINTER(c_sock),
+			NULL, K_PRIO_PREEMPT(TCP_TRANSFER_PRIORITY), 0,
+			K_NO_WAIT);
+
+	while (received < transfer->len) {
+		len = recv(new_sock, transfer->rx_chunk, transfer->chunk_len,
+			   0);
+		zassert_true(len > 0, "recv failed (%d)", errno);
+
+		for (i = 0; i < len; i++) {
+			zassert_equal(transfer->rx_chunk[i],
+				      tcp_transfer_pattern(received + i),
+				      "data mismatch at %u", received + i);
+		}
+
+		received += len;
+	}
+
+	elapsed = k_uptime_get_32() - start;
+	if (elapsed == 0U) {
+		elapsed = 1U;
+	}
+
+	k_sem_take(&tcp_transfer_done, K_FOREVER);
+	zassert_equal(transfer->sent, transfer->len, "short send");
+
+	res = close(new_sock);
+	zassert_equal(res, 0, "close failed");
+	res = close(c_sock);
+	zassert_equal(res, 0, "close failed");
+	res = close(s_sock);
+	zassert_equal(res, 0, "close failed");
+
+	/* Let the connections go away before the next transfer */
+	k_sleep(K_MSEC(100));
+
+	return (u64_t)received * MSEC_PER_SEC / elapsed;
+}
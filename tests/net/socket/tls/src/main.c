@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <string.h>
+#include <ztest_assert.h>
+
+#include <net/socket.h>
+#include <net/tls_credentials.h>
+
+#define SERVER_PORT 4242
+#define SESSION_SERVER_PORT 4243
+
+#define PSK_TAG 1
+#define SERVER_PSK_TAG 2
+
+#define CLIENT_COUNT 2
+/* Each client is echoed twice, the first client again after the second
+ * one connected.
+ */
+#define ECHO_COUNT (2 * CLIENT_COUNT)
+
+#define ECHO_WAIT_MS 5000
+
+/* A full handshake, a resumed one, and a full one after the purge */
+#define SESSION_CONNECT_COUNT 3
+
+#define SERVER_STACK_SIZE 4096
+#define SERVER_PRIORITY K_PRIO_PREEMPT(8)
+
+static const unsigned char psk[] = {
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+	0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+};
+
+/* Replaces the PSK of the server once a session is cached, so that only
+ * resumed handshakes, which do not use the PSK, succeed.
+ */
+static const unsigned char other_psk[] = {
+	0x10, 0x0f, 0x0e, 0x0d, 0x0c, 0x0b, 0x0a, 0x09,
+	0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,
+};
+
+static const char psk_id[] = "test_identity";
+
+static const sec_tag_t sec_tags[] = {
+	PSK_TAG,
+};
+
+static const sec_tag_t server_sec_tags[] = {
+	SERVER_PSK_TAG,
+};
+
+K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+static K_SEM_DEFINE(server_done, 0, 1);
+
+static int server_echoed;
+
+static void dtls_echo_server(void *p1, void *p2, void *p3)
+{
+	int sock = POINTER_TO_INT(p1);
+	struct sockaddr addr;
+	socklen_t addrlen;
+	char buf[32];
+	ssize_t len;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (server_echoed < ECHO_COUNT) {
+		addrlen = sizeof(addr);
+		len = recvfrom(sock, buf, sizeof(buf), 0, &addr, &addrlen);
+		if (len < 0) {
+			/* Handshakes in progress, datagrams dropped */
+			if (errno == EAGAIN || errno == ECONNRESET) {
+				continue;
+			}
+
+			break;
+		}
+
+		/* Replies go to the peer given as destination */
+		if (sendto(sock, buf, len, 0, &addr, addrlen) != len) {
+			break;
+		}
+
+		server_echoed++;
+	}
+
+	k_sem_give(&server_done);
+}
+
+static int prepare_dtls_sock(void)
+{
+	int sock;
+	int ret;
+
+	sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_DTLS_1_2);
+	zassert_true(sock >= 0, "socket open failed");
+
+	ret = setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST, sec_tags,
+			 sizeof(sec_tags));
+	zassert_equal(ret, 0, "setsockopt TLS_SEC_TAG_LIST failed");
+
+	return sock;
+}
+
+static void test_echo(int sock, const char *msg)
+{
+	struct pollfd pfd;
+	char buf[32];
+	ssize_t len;
+
+	len = send(sock, msg, strlen(msg), 0);
+	zassert_equal(len, strlen(msg), "send failed");
+
+	pfd.fd = sock;
+	pfd.events = POLLIN;
+	zassert_equal(poll(&pfd, 1, ECHO_WAIT_MS), 1, "no echo");
+
+	len = recv(sock, buf, sizeof(buf), 0);
+	zassert_equal(len, strlen(msg), "recv failed");
+	zassert_mem_equal(buf, msg, len, "wrong echo");
+}
+
+void test_credentials_add(void)
+{
+	int ret;
+
+	ret = tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK, psk,
+				 sizeof(psk));
+	zassert_equal(ret, 0, "Cannot add the PSK");
+
+	ret = tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK_ID, psk_id,
+				 sizeof(psk_id) - 1);
+	zassert_equal(ret, 0, "Cannot add the PSK identity");
+
+	ret = tls_credential_add(SERVER_PSK_TAG, TLS_CREDENTIAL_PSK, psk,
+				 sizeof(psk));
+	zassert_equal(ret, 0, "Cannot add the server PSK");
+
+	ret = tls_credential_add(SERVER_PSK_TAG, TLS_CREDENTIAL_PSK_ID, psk_id,
+				 sizeof(psk_id) - 1);
+	zassert_equal(ret, 0, "Cannot add the server PSK identity");
+}
+
+void test_dtls_multi_peer(void)
+{
+	struct sockaddr_in s_addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SERVER_PORT),
+	};
+	int c_sock[CLIENT_COUNT];
+	int role = 1;
+	int multi_peer = 1;
+	int s_sock;
+	int ret, i;
+
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&s_addr.sin_addr), 1, "inet_pton failed");
+
+	s_sock = prepare_dtls_sock();
+
+	ret = setsockopt(s_sock, SOL_TLS, TLS_DTLS_ROLE, &role, sizeof(role));
+	zassert_equal(ret, 0, "setsockopt TLS_DTLS_ROLE failed");
+
+	ret = setsockopt(s_sock, SOL_TLS, TLS_DTLS_MULTI_PEER, &multi_peer,
+			 sizeof(multi_peer));
+	zassert_equal(ret, 0, "setsockopt TLS_DTLS_MULTI_PEER failed");
+
+	ret = bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(ret, 0, "bind failed");
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack),
+			dtls_echo_server, INT_TO_POINTER(s_sock), NULL, NULL,
+			SERVER_PRIORITY, 0, K_NO_WAIT);
+
+	for (i = 0; i < CLIENT_COUNT; i++) {
+		c_sock[i] = prepare_dtls_sock();
+
+		ret = connect(c_sock[i], (struct sockaddr *)&s_addr,
+			      sizeof(s_addr));
+		zassert_equal(ret, 0, "connect failed");
+	}
+
+	/* Both sessions stay served by the single server socket */
+	test_echo(c_sock[0], "first client");
+	test_echo(c_sock[1], "second client");
+	test_echo(c_sock[0], "first client again");
+	test_echo(c_sock[1], "second client again");
+
+	zassert_equal(k_sem_take(&server_done, K_MSEC(ECHO_WAIT_MS)), 0,
+		      "server did not finish");
+	zassert_equal(server_echoed, ECHO_COUNT, "server failed");
+
+	for (i = 0; i < CLIENT_COUNT; i++) {
+		zassert_equal(close(c_sock[i]), 0, "close failed");
+	}
+
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+static void tls_session_server(void *p1, void *p2, void *p3)
+{
+	int sock = POINTER_TO_INT(p1);
+	char buf[32];
+	ssize_t len;
+	int i, c_sock;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	/* Handshakes failing in accept() count as a connection too */
+	for (i = 0; i < SESSION_CONNECT_COUNT; i++) {
+		c_sock = accept(sock, NULL, NULL);
+		if (c_sock < 0) {
+			continue;
+		}
+
+		len = recv(c_sock, buf, sizeof(buf), 0);
+		if (len > 0) {
+			(void)send(c_sock, buf, len, 0);
+		}
+
+		(void)close(c_sock);
+	}
+
+	k_sem_give(&server_done);
+}
+
+/* Connects to the server, and checks the connection with an echo, which also
+ * makes sure the server cached the session before returning.
+ */
+static int tls_session_connect(struct sockaddr_in *addr)
+{
+	int cache = 1;
+	int sock;
+	int ret;
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	zassert_true(sock >= 0, "socket open failed");
+
+	ret = setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST, sec_tags,
+			 sizeof(sec_tags));
+	zassert_equal(ret, 0, "setsockopt TLS_SEC_TAG_LIST failed");
+
+	ret = setsockopt(sock, SOL_TLS, TLS_SESSION_CACHE, &cache,
+			 sizeof(cache));
+	zassert_equal(ret, 0, "setsockopt TLS_SESSION_CACHE failed");
+
+	ret = connect(sock, (struct sockaddr *)addr, sizeof(*addr));
+	if (ret == 0) {
+		test_echo(sock, "session");
+	}
+
+	zassert_equal(close(sock), 0, "close failed");
+
+	return ret;
+}
+
+void test_tls_session_cache(void)
+{
+	struct sockaddr_in s_addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(SESSION_SERVER_PORT),
+	};
+	socklen_t optlen = sizeof(int);
+	int cache = 1;
+	int s_sock;
+	int ret;
+
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&s_addr.sin_addr), 1, "inet_pton failed");
+
+	s_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	zassert_true(s_sock >= 0, "socket open failed");
+
+	ret = setsockopt(s_sock, SOL_TLS, TLS_SEC_TAG_LIST, server_sec_tags,
+			 sizeof(server_sec_tags));
+	zassert_equal(ret, 0, "setsockopt TLS_SEC_TAG_LIST failed");
+
+	ret = setsockopt(s_sock, SOL_TLS, TLS_SESSION_CACHE, &cache,
+			 sizeof(cache));
+	zassert_equal(ret, 0, "setsockopt TLS_SESSION_CACHE failed");
+
+	cache = 0;
+	ret = getsockopt(s_sock, SOL_TLS, TLS_SESSION_CACHE, &cache, &optlen);
+	zassert_equal(ret, 0, "getsockopt TLS_SESSION_CACHE failed");
+	zassert_equal(cache, 1, "session cache not enabled");
+
+	ret = bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr));
+	zassert_equal(ret, 0, "bind failed");
+
+	ret = listen(s_sock, 1);
+	zassert_equal(ret, 0, "listen failed");
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack),
+			tls_session_server, INT_TO_POINTER(s_sock), NULL, NULL,
+			SERVER_PRIORITY, 0, K_NO_WAIT);
+
+	zassert_equal(tls_session_connect(&s_addr), 0,
+		      "full handshake failed");
+
+	ret = tls_credential_delete(SERVER_PSK_TAG, TLS_CREDENTIAL_PSK);
+	zassert_equal(ret, 0, "Cannot delete the server PSK");
+
+	ret = tls_credential_add(SERVER_PSK_TAG, TLS_CREDENTIAL_PSK,
+				 other_psk, sizeof(other_psk));
+	zassert_equal(ret, 0, "Cannot replace the server PSK");
+
+	zassert_equal(tls_session_connect(&s_addr), 0,
+		      "session not resumed");
+
+	ret = setsockopt(s_sock, SOL_TLS, TLS_SESSION_CACHE_PURGE, NULL, 0);
+	zassert_equal(ret, 0, "setsockopt TLS_SESSION_CACHE_PURGE failed");
+
+	zassert_not_equal(tls_session_connect(&s_addr), 0,
+			  "purged session resumed");
+
+	zassert_equal(k_sem_take(&server_done, K_MSEC(ECHO_WAIT_MS)), 0,
+		      "server did not finish");
+
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_tls,
+			 ztest_unit_test(test_credentials_add),
+			 ztest_unit_test(test_dtls_multi_peer),
+			 ztest_unit_test(test_tls_session_cache));
+
+	ztest_run_test_suite(socket_tls);
+}